@@ -3,20 +3,29 @@ import struct
 import random
 import enum
 
-CURRENT_REQUEST_VERSION = 1
-MAX_REQUEST_DATA_SIZE = 32
+CURRENT_REQUEST_VERSION = 2
+MAX_REQUEST_DATA_SIZE = 1024 * 1024
 
 class RequestType(enum.IntEnum):
     ReadMemory = 1,
-    WriteMemory = 2
+    WriteMemory = 2,
+    ReadMemoryBatch = 3,
+    WriteMemoryBatch = 4,
+    SetSubscription = 5,
+    SubscriptionData = 6
 
 CITRA_PORT = "45987"
+CITRA_PUBLISH_PORT = "45988"
 
 class Citra:
-    def __init__(self, address="127.0.0.1", port=CITRA_PORT):
+    def __init__(self, address="127.0.0.1", port=CITRA_PORT, publish_port=CITRA_PUBLISH_PORT):
+        self.address = address
+        self.publish_port = publish_port
         self.context = zmq.Context()
         self.socket = self.context.socket(zmq.REQ)
         self.socket.connect("tcp://" + address + ":" + port)
+        self.subscriber = None
+        self.subscribed_ranges = []
 
     def is_connected(self):
         return self.socket is not None
@@ -25,6 +34,11 @@ class Citra:
         request_id = random.getrandbits(32)
         return (struct.pack("IIII", CURRENT_REQUEST_VERSION, request_id, request_type, data_size), request_id)
 
+    def _request(self, request_type, request_data):
+        request, request_id = self._generate_header(request_type, len(request_data))
+        self.socket.send(request + request_data)
+        return self._read_and_validate_header(self.socket.recv(), request_id, request_type)
+
     def _read_and_validate_header(self, raw_reply, expected_id, expected_type):
         reply_version, reply_id, reply_type, reply_data_size = struct.unpack("IIII", raw_reply[:4*4])
         if (CURRENT_REQUEST_VERSION == reply_version and
@@ -90,6 +104,128 @@ class Citra:
                 return False
         return True
 
+    def read_memory_batch(self, ranges):
+        """
+        Reads several (address, size) ranges with a single request, and returns a list holding the
+        contents of each range.
+        >>> c.read_memory_batch([(0x100000, 2), (0x100002, 2)])
+        [b'\\x07\\x00', b'\\x00\\xeb']
+        """
+        result = []
+        start = 0
+        while start < len(ranges):
+            # Gather as many ranges as fit in one request and its reply
+            end = start
+            total_size = 0
+            while (end < len(ranges) and 4 + 8 * (end - start + 1) <= MAX_REQUEST_DATA_SIZE and
+                   total_size + ranges[end][1] <= MAX_REQUEST_DATA_SIZE):
+                total_size += ranges[end][1]
+                end += 1
+
+            if end == start:
+                # The range does not fit in a single reply
+                data = self.read_memory(*ranges[start])
+                if data is None:
+                    return None
+                result.append(data)
+                start += 1
+                continue
+
+            request_data = struct.pack("I", end - start)
+            for address, size in ranges[start:end]:
+                request_data += struct.pack("II", address, size)
+            reply_data = self._request(RequestType.ReadMemoryBatch, request_data)
+            if reply_data is None or len(reply_data) != total_size:
+                return None
+
+            offset = 0
+            for _, size in ranges[start:end]:
+                result.append(reply_data[offset:offset + size])
+                offset += size
+            start = end
+        return result
+
+    def write_memory_batch(self, writes):
+        """
+        Writes several (address, contents) pairs with as few requests as possible.
+        >>> c.write_memory_batch([(0x100000, b"\\xff\\xff"), (0x100002, b"\\xff\\xff")])
+        True
+        >>> c.read_memory(0x100000, 4)
+        b'\\xff\\xff\\xff\\xff'
+        >>> c.write_memory_batch([(0x100000, b"\\x07\\x00\\x00\\xeb")])
+        True
+        """
+        request_data = b""
+        count = 0
+        for address, contents in writes:
+            entry = struct.pack("II", address, len(contents)) + contents
+            if 4 + len(request_data) + len(entry) > MAX_REQUEST_DATA_SIZE:
+                if count > 0:
+                    if self._request(RequestType.WriteMemoryBatch,
+                                     struct.pack("I", count) + request_data) is None:
+                        return False
+                    request_data = b""
+                    count = 0
+                if 4 + len(entry) > MAX_REQUEST_DATA_SIZE:
+                    if not self.write_memory(address, contents):
+                        return False
+                    continue
+            request_data += entry
+            count += 1
+        if count > 0:
+            return self._request(RequestType.WriteMemoryBatch,
+                                 struct.pack("I", count) + request_data) is not None
+        return True
+
+    def subscribe(self, ranges):
+        """
+        Makes Citra publish the contents of the (address, size) ranges every frame, replacing the
+        previous subscription. An empty list stops publishing. Use receive_subscription to get
+        the data.
+        """
+        request_data = struct.pack("I", len(ranges))
+        for address, size in ranges:
+            request_data += struct.pack("II", address, size)
+        if self.subscriber is None and ranges:
+            self.subscriber = self.context.socket(zmq.SUB)
+            self.subscriber.setsockopt(zmq.SUBSCRIBE, b"")
+            self.subscriber.connect("tcp://" + self.address + ":" + self.publish_port)
+        if self._request(RequestType.SetSubscription, request_data) is None:
+            return False
+        self.subscribed_ranges = list(ranges)
+        return True
+
+    def receive_subscription(self, timeout_ms=None):
+        """
+        Waits for the next frame of subscribed data, and returns the frame number and a list
+        holding the contents of each subscribed range, or None on timeout.
+        >>> c.subscribe([(0x100000, 4)])
+        True
+        >>> frame, data = c.receive_subscription()
+        >>> data
+        [b'\\x07\\x00\\x00\\xeb']
+        >>> c.subscribe([])
+        True
+        """
+        while self.subscriber is not None:
+            if timeout_ms is not None and not self.subscriber.poll(timeout_ms):
+                return None
+            raw_data = self.subscriber.recv()
+            version, frame, data_type, data_size = struct.unpack("IIII", raw_data[:4*4])
+            data = raw_data[4*4:]
+            if data_type != RequestType.SubscriptionData or data_size != len(data):
+                continue
+            # Frames published before the subscription changed have a different size
+            if data_size != sum(size for _, size in self.subscribed_ranges):
+                continue
+            result = []
+            offset = 0
+            for _, size in self.subscribed_ranges:
+                result.append(data[offset:offset + size])
+                offset += size
+            return frame, result
+        return None
+
 if "__main__" == __name__:
     import doctest
     doctest.testmod(extraglobs={'c': Citra()})
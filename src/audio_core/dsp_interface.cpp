@@ -7,6 +7,7 @@
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
 #include "common/assert.h"
+#include "common/counters.h"
 #include "core/settings.h"
 
 namespace AudioCore {
@@ -44,6 +45,11 @@ void DspInterface::OutputFrame(StereoFrame16& frame) {
     fifo.Push(frame.data(), frame.size());
 }
 
+static const Common::Counters::Counter underruns = Common::Counters::Register(
+    "citra_audio_underruns_total", "Audio callbacks that ran out of samples to play");
+static const Common::Counters::Counter underrun_frames = Common::Counters::Register(
+    "citra_audio_underrun_frames_total", "Frames of silence played because of underruns");
+
 void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
     std::size_t frames_written;
     if (perform_time_stretching) {
@@ -63,6 +69,11 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
         std::memcpy(&last_frame[0], buffer + 2 * (frames_written - 1), 2 * sizeof(s16));
     }
 
+    if (frames_written < num_frames) {
+        underruns.Add();
+        underrun_frames.Add(num_frames - frames_written);
+    }
+
     // Hold last emitted frame; this prevents popping.
     for (std::size_t i = frames_written; i < num_frames; i++) {
         std::memcpy(buffer + 2 * i, &last_frame[0], 2 * sizeof(s16));
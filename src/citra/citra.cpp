@@ -43,6 +43,8 @@
 #include "core/movie.h"
 #include "core/settings.h"
 #include "network/network.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
 
 #ifdef _WIN32
 extern "C" {
@@ -60,11 +62,32 @@ static void PrintHelp(const char* argv0) {
                  " Nickname, password, address and port for multiplayer\n"
                  "-r, --movie-record=[file]  Record a movie (game inputs) to the given file\n"
                  "-p, --movie-play=[file]    Playback the movie (game inputs) from the given file\n"
+                 "-c, --counters=FILE  Periodically write event counters to FILE, as JSON if it\n"
+                 "                     ends in .json and in the Prometheus text format otherwise\n"
+                 "-s, --save-state=FRAME:FILE  Save the emulation state to FILE at frame FRAME\n"
+                 "-l, --load-state=FRAME:FILE  Load the emulation state from FILE at frame FRAME,\n"
+                 "                             exiting with an error if it is refused\n"
                  "-f, --fullscreen     Start in fullscreen mode\n"
                  "-h, --help           Display this help and exit\n"
                  "-v, --version        Output version information and exit\n";
 }
 
+/// A save state to save or load once the emulation reaches a frame
+struct StateAtFrame {
+    int frame = -1;
+    std::string path;
+};
+
+static bool ParseStateAtFrame(const std::string& str_arg, StateAtFrame& state) {
+    std::smatch match;
+    if (!std::regex_match(str_arg, match, std::regex("^([0-9]+):(.+)$"))) {
+        return false;
+    }
+    state.frame = std::stoi(match[1]);
+    state.path = match[2];
+    return true;
+}
+
 static void PrintVersion() {
     std::cout << "Citra " << Common::g_scm_branch << " " << Common::g_scm_desc << std::endl;
 }
@@ -125,7 +148,11 @@ static void InitializeLogging() {
 
     const std::string& log_dir = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
     FileUtil::CreateFullPath(log_dir);
-    Log::AddBackend(std::make_unique<Log::FileBackend>(log_dir + LOG_FILE));
+    if (Settings::values.log_binary) {
+        Log::AddBackend(std::make_unique<Log::BinaryFileBackend>(log_dir + LOG_BINARY_FILE));
+    } else {
+        Log::AddBackend(std::make_unique<Log::FileBackend>(log_dir + LOG_FILE));
+    }
 #ifdef _WIN32
     Log::AddBackend(std::make_unique<Log::DebuggerBackend>());
 #endif
@@ -140,6 +167,9 @@ int main(int argc, char** argv) {
     u32 gdb_port = static_cast<u32>(Settings::values.gdbstub_port);
     std::string movie_record;
     std::string movie_play;
+    std::string counters_dump_path = Settings::values.counters_dump_path;
+    StateAtFrame save_state;
+    StateAtFrame load_state;
 
     InitializeLogging();
 
@@ -168,6 +198,9 @@ int main(int argc, char** argv) {
         {"multiplayer", required_argument, 0, 'm'},
         {"movie-record", required_argument, 0, 'r'},
         {"movie-play", required_argument, 0, 'p'},
+        {"counters", required_argument, 0, 'c'},
+        {"save-state", required_argument, 0, 's'},
+        {"load-state", required_argument, 0, 'l'},
         {"fullscreen", no_argument, 0, 'f'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
@@ -175,7 +208,7 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        char arg = getopt_long(argc, argv, "g:i:m:r:p:fhv", long_options, &option_index);
+        char arg = getopt_long(argc, argv, "g:i:m:r:p:c:s:l:fhv", long_options, &option_index);
         if (arg != -1) {
             switch (arg) {
             case 'g':
@@ -238,6 +271,23 @@ int main(int argc, char** argv) {
             case 'p':
                 movie_play = optarg;
                 break;
+            case 'c':
+                counters_dump_path = optarg;
+                break;
+            case 's':
+                if (!ParseStateAtFrame(optarg, save_state)) {
+                    std::cout << "Wrong format for option --save-state\n";
+                    PrintHelp(argv[0]);
+                    return 0;
+                }
+                break;
+            case 'l':
+                if (!ParseStateAtFrame(optarg, load_state)) {
+                    std::cout << "Wrong format for option --load-state\n";
+                    PrintHelp(argv[0]);
+                    return 0;
+                }
+                break;
             case 'f':
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
@@ -286,6 +336,7 @@ int main(int argc, char** argv) {
     // Apply the command line arguments
     Settings::values.gdbstub_port = gdb_port;
     Settings::values.use_gdbstub = use_gdbstub;
+    Settings::values.counters_dump_path = counters_dump_path;
     Settings::Apply();
 
     // Register frontend applets
@@ -350,12 +401,27 @@ int main(int argc, char** argv) {
         Core::Movie::GetInstance().StartRecording(movie_record);
     }
 
+    int exit_code = 0;
     while (emu_window->IsOpen()) {
         system.RunLoop();
+
+        const int frame = VideoCore::g_renderer->GetCurrentFrame();
+        if (save_state.frame >= 0 && frame >= save_state.frame) {
+            save_state.frame = -1;
+            system.SaveState(save_state.path);
+        }
+        if (load_state.frame >= 0 && frame >= load_state.frame) {
+            load_state.frame = -1;
+            if (!system.LoadState(load_state.path)) {
+                LOG_CRITICAL(Frontend, "Failed to load state from {}", load_state.path);
+                exit_code = -1;
+                break;
+            }
+        }
     }
 
     Core::Movie::GetInstance().Shutdown();
 
     detached_tasks.WaitForAllTasks();
-    return 0;
+    return exit_code;
 }
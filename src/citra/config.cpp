@@ -116,6 +116,12 @@ void Config::ReadValues() {
         sdl2_config->GetBoolean("Renderer", "shaders_accurate_gs", true);
     Settings::values.shaders_accurate_mul =
         sdl2_config->GetBoolean("Renderer", "shaders_accurate_mul", false);
+    Settings::values.use_disk_shader_cache =
+        sdl2_config->GetBoolean("Renderer", "use_disk_shader_cache", true);
+    Settings::values.use_async_shader_compilation =
+        sdl2_config->GetBoolean("Renderer", "use_async_shader_compilation", false);
+    Settings::values.surface_cache_budget =
+        static_cast<u32>(sdl2_config->GetInteger("Renderer", "surface_cache_budget", 1024));
     Settings::values.use_shader_jit = sdl2_config->GetBoolean("Renderer", "use_shader_jit", true);
     Settings::values.resolution_factor =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "resolution_factor", 1));
@@ -164,6 +170,8 @@ void Config::ReadValues() {
     // Data Storage
     Settings::values.use_virtual_sd =
         sdl2_config->GetBoolean("Data Storage", "use_virtual_sd", true);
+    Settings::values.use_buffered_save_writes =
+        sdl2_config->GetBoolean("Data Storage", "use_buffered_save_writes", false);
 
     // System
     Settings::values.is_new_3ds = sdl2_config->GetBoolean("System", "is_new_3ds", false);
@@ -215,6 +223,11 @@ void Config::ReadValues() {
 
     // Miscellaneous
     Settings::values.log_filter = sdl2_config->GetString("Miscellaneous", "log_filter", "*:Info");
+    Settings::values.log_binary = sdl2_config->GetBoolean("Miscellaneous", "log_binary", false);
+    Settings::values.counters_dump_path =
+        sdl2_config->GetString("Miscellaneous", "counters_dump_path", "");
+    Settings::values.counters_dump_interval = static_cast<u32>(
+        sdl2_config->GetInteger("Miscellaneous", "counters_dump_interval", 10));
 
     // Debugging
     Settings::values.use_gdbstub = sdl2_config->GetBoolean("Debugging", "use_gdbstub", false);
@@ -102,6 +102,19 @@ use_hw_shader =
 # 0: Off (Default. Faster, but causes issues in some games) 1: On (Slower, but correct)
 shaders_accurate_mul =
 
+# Whether to store the generated shaders on disk and build them at boot to reduce stuttering
+# 0: Off, 1 (default): On
+use_disk_shader_cache =
+
+# Whether to compile new fragment shaders on a separate thread, drawing with a slower generic shader
+# until they are ready. This avoids stuttering when new shaders are used.
+# 0 (default): Off, 1: On
+use_async_shader_compilation =
+
+# Amount of memory in MiB that cached textures and framebuffers may use before the ones that have
+# not been used for the longest time are freed. 0: Unlimited, 1024 (default)
+surface_cache_budget =
+
 # Whether to fallback to software for geometry shaders
 # 0: Off (Faster, but causes issues in some games) 1: On (Default. Slower, but correct)
 shaders_accurate_gs =
@@ -190,6 +203,11 @@ volume =
 # 1 (default): Yes, 0: No
 use_virtual_sd =
 
+# Whether to keep save data files in memory while they are open and commit them to disk in batches.
+# Reduces host I/O for games that write and flush their saves in many small steps.
+# 0 (default): No, 1: Yes
+use_buffered_save_writes =
+
 [System]
 # The system model that Citra will try to emulate
 # 0: Old 3DS (default), 1: New 3DS
@@ -235,6 +253,19 @@ camera_inner_flip =
 # Examples: *:Debug Kernel.SVC:Trace Service.*:Critical
 log_filter = *:Info
 
+# Whether to write the log file in a compact binary format instead of text, which is faster when
+# logging a lot. citra-log-decoder converts it to text.
+# 0 (default): Text (citra_log.txt), 1: Binary (citra_log.bin)
+log_binary =
+
+# File to which event counters (draws, SVCs, IPC requests, surface transfers, ...) are written
+# while a game runs. Written as JSON if the name ends in .json, and in the Prometheus text format
+# otherwise. Empty (default): Disabled
+counters_dump_path =
+
+# Seconds between two writes of the counters file. Default: 10
+counters_dump_interval =
+
 [Debugging]
 # Port for listening to GDB connections.
 use_gdbstub=false
@@ -27,6 +27,9 @@ public:
     /// Releases the GL context from the caller thread
     void DoneCurrent() override;
 
+    /// Creates a GL context sharing its objects with the one of the window
+    std::unique_ptr<GraphicsContext> CreateSharedContext() const override;
+
     /// Whether the window is still open, and a close request hasn't yet been sent
     bool IsOpen() const;
 
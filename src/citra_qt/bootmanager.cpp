@@ -1,6 +1,8 @@
 #include <QApplication>
 #include <QHBoxLayout>
 #include <QKeyEvent>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
 #include <QScreen>
 #include <QWindow>
 #include <fmt/format.h>
@@ -107,6 +109,38 @@ private:
     bool do_painting;
 };
 
+/// A GL context sharing its objects with the one of the render window
+class GGLSharedContext : public GraphicsContext {
+public:
+    GGLSharedContext(QOpenGLContext* share_context, QOffscreenSurface* surface)
+        : share_context(share_context), surface(surface) {}
+
+    void MakeCurrent() override {
+        // Qt only allows making a context current on the thread it belongs to, so it is created by
+        // the first thread using it rather than by the one requesting it
+        if (!context) {
+            context = std::make_unique<QOpenGLContext>();
+            context->setShareContext(share_context);
+            context->setFormat(share_context->format());
+            if (!context->create()) {
+                LOG_ERROR(Frontend, "Failed to create shared GL context");
+                return;
+            }
+        }
+        context->makeCurrent(surface);
+    }
+
+    void DoneCurrent() override {
+        if (context)
+            context->doneCurrent();
+    }
+
+private:
+    QOpenGLContext* share_context;
+    QOffscreenSurface* surface;
+    std::unique_ptr<QOpenGLContext> context;
+};
+
 GRenderWindow::GRenderWindow(QWidget* parent, EmuThread* emu_thread)
     : QWidget(parent), child(nullptr), emu_thread(emu_thread) {
 
@@ -154,6 +188,13 @@ void GRenderWindow::DoneCurrent() {
 
 void GRenderWindow::PollEvents() {}
 
+std::unique_ptr<GraphicsContext> GRenderWindow::CreateSharedContext() const {
+    if (!shared_surface || !shared_surface->isValid())
+        return nullptr;
+    return std::make_unique<GGLSharedContext>(child->context()->contextHandle(),
+                                              shared_surface.get());
+}
+
 // On Qt 5.0+, this correctly gets the size of the framebuffer (pixels).
 //
 // Older versions get the window size (density independent pixels),
@@ -321,6 +362,11 @@ void GRenderWindow::InitRenderTarget() {
     fmt.setOption(QGL::NoDeprecatedFunctions);
 
     child = new GGLWidgetInternal(fmt, this);
+
+    shared_surface = std::make_unique<QOffscreenSurface>();
+    shared_surface->setFormat(child->context()->contextHandle()->format());
+    shared_surface->create();
+
     QBoxLayout* layout = new QHBoxLayout(this);
 
     resize(Core::kScreenTopWidth, Core::kScreenTopHeight + Core::kScreenBottomHeight);
@@ -6,6 +6,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <QGLWidget>
 #include <QImage>
@@ -15,6 +16,7 @@
 #include "core/frontend/emu_window.h"
 
 class QKeyEvent;
+class QOffscreenSurface;
 class QScreen;
 class QTouchEvent;
 
@@ -115,6 +117,7 @@ public:
     void MakeCurrent() override;
     void DoneCurrent() override;
     void PollEvents() override;
+    std::unique_ptr<GraphicsContext> CreateSharedContext() const override;
 
     void BackupGeometry();
     void RestoreGeometry();
@@ -164,6 +167,9 @@ private:
 
     GGLWidgetInternal* child;
 
+    /// Surface the shared contexts are made current on, it has to be created on the GUI thread
+    std::unique_ptr<QOffscreenSurface> shared_surface;
+
     QByteArray geometry;
 
     EmuThread* emu_thread;
@@ -106,6 +106,10 @@ void Config::ReadValues() {
 #endif
     Settings::values.shaders_accurate_gs = ReadSetting("shaders_accurate_gs", true).toBool();
     Settings::values.shaders_accurate_mul = ReadSetting("shaders_accurate_mul", false).toBool();
+    Settings::values.use_disk_shader_cache = ReadSetting("use_disk_shader_cache", true).toBool();
+    Settings::values.use_async_shader_compilation =
+        ReadSetting("use_async_shader_compilation", false).toBool();
+    Settings::values.surface_cache_budget = ReadSetting("surface_cache_budget", 1024).toUInt();
     Settings::values.use_shader_jit = ReadSetting("use_shader_jit", true).toBool();
     Settings::values.resolution_factor =
         static_cast<u16>(ReadSetting("resolution_factor", 1).toInt());
@@ -167,6 +171,8 @@ void Config::ReadValues() {
 
     qt_config->beginGroup("Data Storage");
     Settings::values.use_virtual_sd = ReadSetting("use_virtual_sd", true).toBool();
+    Settings::values.use_buffered_save_writes =
+        ReadSetting("use_buffered_save_writes", false).toBool();
     qt_config->endGroup();
 
     qt_config->beginGroup("System");
@@ -180,6 +186,10 @@ void Config::ReadValues() {
 
     qt_config->beginGroup("Miscellaneous");
     Settings::values.log_filter = ReadSetting("log_filter", "*:Info").toString().toStdString();
+    Settings::values.log_binary = ReadSetting("log_binary", false).toBool();
+    Settings::values.counters_dump_path =
+        ReadSetting("counters_dump_path", "").toString().toStdString();
+    Settings::values.counters_dump_interval = ReadSetting("counters_dump_interval", 10).toUInt();
     qt_config->endGroup();
 
     qt_config->beginGroup("Debugging");
@@ -370,6 +380,10 @@ void Config::SaveValues() {
     WriteSetting("use_hw_shader", Settings::values.use_hw_shader, true);
     WriteSetting("shaders_accurate_gs", Settings::values.shaders_accurate_gs, true);
     WriteSetting("shaders_accurate_mul", Settings::values.shaders_accurate_mul, false);
+    WriteSetting("use_disk_shader_cache", Settings::values.use_disk_shader_cache, true);
+    WriteSetting("use_async_shader_compilation", Settings::values.use_async_shader_compilation,
+                 false);
+    WriteSetting("surface_cache_budget", Settings::values.surface_cache_budget, 1024);
     WriteSetting("use_shader_jit", Settings::values.use_shader_jit, true);
     WriteSetting("resolution_factor", Settings::values.resolution_factor, 1);
     WriteSetting("use_vsync", Settings::values.use_vsync, false);
@@ -426,6 +440,7 @@ void Config::SaveValues() {
 
     qt_config->beginGroup("Data Storage");
     WriteSetting("use_virtual_sd", Settings::values.use_virtual_sd, true);
+    WriteSetting("use_buffered_save_writes", Settings::values.use_buffered_save_writes, false);
     qt_config->endGroup();
 
     qt_config->beginGroup("System");
@@ -439,6 +454,10 @@ void Config::SaveValues() {
 
     qt_config->beginGroup("Miscellaneous");
     WriteSetting("log_filter", QString::fromStdString(Settings::values.log_filter), "*:Info");
+    WriteSetting("log_binary", Settings::values.log_binary, false);
+    WriteSetting("counters_dump_path", QString::fromStdString(Settings::values.counters_dump_path),
+                 "");
+    WriteSetting("counters_dump_interval", Settings::values.counters_dump_interval, 10);
     qt_config->endGroup();
 
     qt_config->beginGroup("Debugging");
@@ -0,0 +1,131 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include "citra_qt/game_list_cache.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+
+namespace {
+constexpr u32 CacheMagic = 0x434C4743; // "CGLC"
+// Bump this whenever the layout of the file or the meaning of an entry changes
+constexpr u32 CacheVersion = 2;
+// SMDH files are 0x36C0 bytes, anything larger means the index is corrupted
+constexpr u32 MaxSMDHSize = 0x4000;
+constexpr u32 MaxPathSize = 0x1000;
+
+template <typename T>
+bool ReadValue(FileUtil::IOFile& file, T& value) {
+    return file.ReadBytes(&value, sizeof(T)) == sizeof(T);
+}
+} // Anonymous namespace
+
+GameListCache::GameListCache(std::string path) : path(std::move(path)) {}
+
+bool GameListCache::Load() {
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen())
+        return false;
+
+    u32 magic, version, count;
+    if (!ReadValue(file, magic) || !ReadValue(file, version) || !ReadValue(file, count) ||
+        magic != CacheMagic || version != CacheVersion) {
+        LOG_WARNING(Frontend, "Game list cache {} is invalid or outdated, ignoring it", path);
+        return false;
+    }
+
+    std::unordered_map<std::string, Slot> loaded;
+    for (u32 i = 0; i < count; ++i) {
+        u32 path_size, smdh_size;
+        std::string file_path;
+        GameListCacheEntry entry;
+        u8 is_valid;
+
+        if (!ReadValue(file, path_size) || path_size > MaxPathSize)
+            return false;
+        file_path.resize(path_size);
+        if (file.ReadBytes(file_path.data(), path_size) != path_size)
+            return false;
+
+        if (!ReadValue(file, entry.file_size) || !ReadValue(file, entry.modified_time) ||
+            !ReadValue(file, is_valid) || !ReadValue(file, entry.file_type) ||
+            !ReadValue(file, entry.program_id) || !ReadValue(file, entry.extdata_id) ||
+            !ReadValue(file, smdh_size) || smdh_size > MaxSMDHSize)
+            return false;
+        entry.is_valid = is_valid != 0;
+
+        entry.smdh.resize(smdh_size);
+        if (file.ReadBytes(entry.smdh.data(), smdh_size) != smdh_size)
+            return false;
+
+        loaded[std::move(file_path)].entry = std::move(entry);
+    }
+
+    std::lock_guard lock(mutex);
+    entries = std::move(loaded);
+    return true;
+}
+
+bool GameListCache::Save() const {
+    const std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+    if (!directory.empty() && !FileUtil::CreateFullPath(directory))
+        return false;
+
+    // Write to a temporary file first so that an interrupted save doesn't leave a broken index
+    const std::string temp_path = path + ".tmp";
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        if (!file.IsOpen())
+            return false;
+
+        std::lock_guard lock(mutex);
+        u32 count = 0;
+        for (const auto& [file_path, slot] : entries)
+            count += slot.used ? 1 : 0;
+
+        file.WriteObject(CacheMagic);
+        file.WriteObject(CacheVersion);
+        file.WriteObject(count);
+        for (const auto& [file_path, slot] : entries) {
+            if (!slot.used)
+                continue;
+            const GameListCacheEntry& entry = slot.entry;
+            file.WriteObject(static_cast<u32>(file_path.size()));
+            file.WriteString(file_path);
+            file.WriteObject(entry.file_size);
+            file.WriteObject(entry.modified_time);
+            file.WriteObject(static_cast<u8>(entry.is_valid));
+            file.WriteObject(entry.file_type);
+            file.WriteObject(entry.program_id);
+            file.WriteObject(entry.extdata_id);
+            file.WriteObject(static_cast<u32>(entry.smdh.size()));
+            file.WriteBytes(entry.smdh.data(), entry.smdh.size());
+        }
+
+        if (!file.IsGood())
+            return false;
+    }
+
+    FileUtil::Delete(path);
+    return FileUtil::Rename(temp_path, path);
+}
+
+std::optional<GameListCacheEntry> GameListCache::Find(const std::string& file_path, u64 file_size,
+                                                      s64 modified_time) {
+    std::lock_guard lock(mutex);
+    auto itr = entries.find(file_path);
+    if (itr == entries.end() || itr->second.entry.file_size != file_size ||
+        itr->second.entry.modified_time != modified_time)
+        return std::nullopt;
+
+    itr->second.used = true;
+    return itr->second.entry;
+}
+
+void GameListCache::Insert(const std::string& file_path, GameListCacheEntry entry) {
+    std::lock_guard lock(mutex);
+    Slot& slot = entries[file_path];
+    slot.entry = std::move(entry);
+    slot.used = true;
+}
@@ -0,0 +1,55 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+
+/// Information extracted from a game file, as shown in the game list.
+struct GameListCacheEntry {
+    u64 file_size = 0;
+    s64 modified_time = 0; ///< Last modification time in ms since epoch
+    bool is_valid = false; ///< Whether a loader could be found for the file
+    u32 file_type = 0;     ///< Loader::FileType
+    u64 program_id = 0;
+    u64 extdata_id = 0;
+    std::vector<u8> smdh;
+};
+
+/**
+ * Persistent index of the scanned game files, keyed by their path. An entry is only returned
+ * while the size and modification time of the file still match, so that only files which changed
+ * since the previous scan need to be opened again. All functions are thread-safe.
+ */
+class GameListCache {
+public:
+    explicit GameListCache(std::string path);
+
+    /// Loads the index from disk, discarding it if it is missing or was written by another version.
+    bool Load();
+
+    /// Saves the entries that were looked up or added since the index was loaded.
+    bool Save() const;
+
+    /// Returns the entry of the given file, if it is still up to date.
+    std::optional<GameListCacheEntry> Find(const std::string& file_path, u64 file_size,
+                                           s64 modified_time);
+
+    void Insert(const std::string& file_path, GameListCacheEntry entry);
+
+private:
+    struct Slot {
+        GameListCacheEntry entry;
+        bool used = false; ///< Entries not seen during the current scan are pruned on save
+    };
+
+    std::string path;
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Slot> entries;
+};
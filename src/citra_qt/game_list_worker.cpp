@@ -2,10 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
 #include "citra_qt/compatibility_list.h"
@@ -15,8 +19,10 @@
 #include "citra_qt/ui_settings.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/logging/log.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/fs/archive.h"
+#include "core/hw/aes/key.h"
 #include "core/loader/loader.h"
 
 namespace {
@@ -24,19 +30,109 @@ bool HasSupportedFileExtension(const std::string& file_name) {
     const QFileInfo file = QFileInfo(QString::fromStdString(file_name));
     return GameList::supported_file_extensions.contains(file.suffix(), Qt::CaseInsensitive);
 }
+
+/// Whether a read succeeded or the file type just doesn't have that information.
+bool IsReadSuccessful(Loader::ResultStatus result) {
+    return result == Loader::ResultStatus::Success ||
+           result == Loader::ResultStatus::ErrorNotUsed ||
+           result == Loader::ResultStatus::ErrorNotImplemented;
+}
 } // Anonymous namespace
 
 GameListWorker::GameListWorker(QList<UISettings::GameDir>& game_dirs,
                                const CompatibilityList& compatibility_list)
-    : game_dirs(game_dirs), compatibility_list(compatibility_list) {}
+    : cache(FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "game_list" DIR_SEP
+            "game_list_cache.bin"),
+      game_dirs(game_dirs), compatibility_list(compatibility_list) {}
 
 GameListWorker::~GameListWorker() = default;
 
-void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
-                                             GameListDir* parent_dir) {
-    const auto callback = [this, recursion, parent_dir](u64* num_entries_out,
-                                                        const std::string& directory,
-                                                        const std::string& virtual_name) -> bool {
+std::optional<GameListCacheEntry> GameListWorker::ScanFile(const std::string& physical_name) {
+    const QFileInfo file_info(QString::fromStdString(physical_name));
+    if (!file_info.exists())
+        return std::nullopt;
+
+    const u64 file_size = static_cast<u64>(file_info.size());
+    const s64 modified_time = file_info.lastModified().toMSecsSinceEpoch();
+    if (auto cached = cache.Find(physical_name, file_size, modified_time))
+        return cached;
+
+    GameListCacheEntry entry;
+    entry.file_size = file_size;
+    entry.modified_time = modified_time;
+
+    std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
+    if (!loader)
+        return entry;
+
+    entry.is_valid = true;
+    entry.file_type = static_cast<u32>(loader->GetFileType());
+    const auto program_id_result = loader->ReadProgramId(entry.program_id);
+    loader->ReadExtdataId(entry.extdata_id);
+    const auto icon_result = loader->ReadIcon(entry.smdh);
+
+    // Don't remember files that failed to load (e.g. missing keys), they'd never be retried
+    const bool loaded = IsReadSuccessful(program_id_result) && IsReadSuccessful(icon_result) &&
+                        (icon_result != Loader::ResultStatus::Success ||
+                         Loader::IsValidSMDH(entry.smdh));
+    if (loaded)
+        cache.Insert(physical_name, entry);
+    return entry;
+}
+
+void GameListWorker::AddGameFile(const std::string& physical_name, GameListDir* parent_dir) {
+    const auto entry = ScanFile(physical_name);
+    if (!entry || !entry->is_valid)
+        return;
+
+    const u64 program_id = entry->program_id;
+    std::vector<u8> smdh = [this, program_id, &entry]() -> std::vector<u8> {
+        if (program_id < 0x0004000000000000 || program_id > 0x00040000FFFFFFFF)
+            return entry->smdh;
+
+        std::string update_path = Service::AM::GetTitleContentPath(
+            Service::FS::MediaType::SDMC, program_id + 0x0000000E00000000);
+
+        if (!FileUtil::Exists(update_path))
+            return entry->smdh;
+
+        const auto update_entry = ScanFile(update_path);
+        if (!update_entry || !update_entry->is_valid)
+            return entry->smdh;
+
+        return update_entry->smdh;
+    }();
+
+    if (!Loader::IsValidSMDH(smdh) && UISettings::values.game_list_hide_no_icon) {
+        // Skip this invalid entry
+        return;
+    }
+
+    auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
+
+    // The game list uses this as compatibility number for untested games
+    QString compatibility("99");
+    if (it != compatibility_list.end())
+        compatibility = it->second.first;
+
+    const auto file_type = static_cast<Loader::FileType>(entry->file_type);
+    emit EntryReady(
+        {
+            new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id,
+                                 entry->extdata_id),
+            new GameListItemCompat(compatibility),
+            new GameListItemRegion(smdh),
+            new GameListItem(QString::fromStdString(Loader::GetFileTypeString(file_type))),
+            new GameListItemSize(entry->file_size),
+        },
+        parent_dir);
+}
+
+void GameListWorker::CollectGameFiles(const std::string& dir_path, unsigned int recursion,
+                                      std::vector<std::string>& files) {
+    const auto callback = [this, recursion, &files](u64* num_entries_out,
+                                                    const std::string& directory,
+                                                    const std::string& virtual_name) -> bool {
         std::string physical_name = directory + DIR_SEP + virtual_name;
 
         if (stop_processing)
@@ -44,66 +140,10 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
 
         bool is_dir = FileUtil::IsDirectory(physical_name);
         if (!is_dir && HasSupportedFileExtension(physical_name)) {
-            std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
-            if (!loader)
-                return true;
-
-            u64 program_id = 0;
-            loader->ReadProgramId(program_id);
-
-            u64 extdata_id = 0;
-            loader->ReadExtdataId(extdata_id);
-
-            std::vector<u8> smdh = [program_id, &loader]() -> std::vector<u8> {
-                std::vector<u8> original_smdh;
-                loader->ReadIcon(original_smdh);
-
-                if (program_id < 0x0004000000000000 || program_id > 0x00040000FFFFFFFF)
-                    return original_smdh;
-
-                std::string update_path = Service::AM::GetTitleContentPath(
-                    Service::FS::MediaType::SDMC, program_id + 0x0000000E00000000);
-
-                if (!FileUtil::Exists(update_path))
-                    return original_smdh;
-
-                std::unique_ptr<Loader::AppLoader> update_loader = Loader::GetLoader(update_path);
-
-                if (!update_loader)
-                    return original_smdh;
-
-                std::vector<u8> update_smdh;
-                update_loader->ReadIcon(update_smdh);
-                return update_smdh;
-            }();
-
-            if (!Loader::IsValidSMDH(smdh) && UISettings::values.game_list_hide_no_icon) {
-                // Skip this invalid entry
-                return true;
-            }
-
-            auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
-
-            // The game list uses this as compatibility number for untested games
-            QString compatibility("99");
-            if (it != compatibility_list.end())
-                compatibility = it->second.first;
-
-            emit EntryReady(
-                {
-                    new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id,
-                                         extdata_id),
-                    new GameListItemCompat(compatibility),
-                    new GameListItemRegion(smdh),
-                    new GameListItem(
-                        QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                    new GameListItemSize(FileUtil::GetSize(physical_name)),
-                },
-                parent_dir);
-
+            files.push_back(std::move(physical_name));
         } else if (is_dir && recursion > 0) {
             watch_list.append(QString::fromStdString(physical_name));
-            AddFstEntriesToGameList(physical_name, recursion - 1, parent_dir);
+            CollectGameFiles(physical_name, recursion - 1, files);
         }
 
         return true;
@@ -112,8 +152,34 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
     FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
 }
 
+void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
+                                             GameListDir* parent_dir) {
+    std::vector<std::string> files;
+    CollectGameFiles(dir_path, recursion, files);
+
+    // Opening the files is mostly waiting on I/O (especially on network storage), so fan out
+    // across a few more threads than there are cores.
+    const std::size_t num_threads =
+        std::min<std::size_t>(files.size(), std::max(4u, std::thread::hardware_concurrency()));
+    std::atomic<std::size_t> next_file{0};
+    const auto scan = [this, &files, &next_file, parent_dir] {
+        for (std::size_t i = next_file++; i < files.size() && !stop_processing; i = next_file++)
+            AddGameFile(files[i], parent_dir);
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < num_threads; ++i)
+        threads.emplace_back(scan);
+    scan();
+    for (auto& thread : threads)
+        thread.join();
+}
+
 void GameListWorker::run() {
     stop_processing = false;
+    cache.Load();
+    // Load the keys up front, so that the scanner threads only derive keys under the key slot lock
+    HW::AES::InitKeys();
     for (UISettings::GameDir& game_dir : game_dirs) {
         if (game_dir.path == "INSTALLED") {
             QString path =
@@ -141,6 +207,11 @@ void GameListWorker::run() {
                                     game_list_dir);
         }
     };
+
+    // Only save complete scans, otherwise the entries that weren't reached would be pruned
+    if (!stop_processing && !cache.Save())
+        LOG_WARNING(Frontend, "Failed to save the game list cache");
+
     emit Finished(watch_list);
 }
 
@@ -7,13 +7,16 @@
 #include <atomic>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <QList>
 #include <QObject>
 #include <QRunnable>
 #include <QString>
 #include "citra_qt/compatibility_list.h"
+#include "citra_qt/game_list_cache.h"
 #include "common/common_types.h"
 
 class QStandardItem;
@@ -55,7 +58,18 @@ private:
     void AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
                                  GameListDir* parent_dir);
 
+    /// Recursively collects the game files of a directory, adding subdirectories to the watch list.
+    void CollectGameFiles(const std::string& dir_path, unsigned int recursion,
+                          std::vector<std::string>& files);
+
+    /// Adds the entry of a single game file to the game list. Called from the scanner threads.
+    void AddGameFile(const std::string& physical_name, GameListDir* parent_dir);
+
+    /// Returns the information of a game file, from the cache if the file didn't change.
+    std::optional<GameListCacheEntry> ScanFile(const std::string& physical_name);
+
     QStringList watch_list;
+    GameListCache cache;
     const CompatibilityList& compatibility_list;
     QList<UISettings::GameDir>& game_dirs;
     std::atomic_bool stop_processing;
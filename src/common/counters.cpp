@@ -0,0 +1,274 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <fmt/format.h>
+#include "common/counters.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+#include "common/thread.h"
+
+namespace Common::Counters {
+
+namespace Detail {
+thread_local Block* current_block = nullptr;
+} // namespace Detail
+
+namespace {
+
+struct CounterInfo {
+    std::string name;
+    Labels labels;
+};
+
+struct Registry {
+    std::mutex mutex;
+    /// Registered counters, indexed like the values of a block. Index 0 is the overflow counter.
+    std::vector<CounterInfo> counters{CounterInfo{}};
+    std::map<std::pair<std::string, Labels>, u32> indices;
+    /// Help text of each metric, set by the first registration of its name
+    std::map<std::string, std::string> help_texts;
+    std::vector<std::unique_ptr<Detail::Block>> blocks;
+    /// Shared by threads that count while their thread-local storage is being destroyed. As more
+    /// than one thread may write to it, a few of these late counts may get lost.
+    Detail::Block exiting_threads_block;
+};
+
+Registry& GetRegistry() {
+    // Never destroyed, as threads may still count while static objects are being destroyed
+    static Registry* registry = new Registry;
+    return *registry;
+}
+
+/// Returns the block of a thread to the registry once the thread exits
+struct BlockOwner {
+    Detail::Block* block = nullptr;
+
+    ~BlockOwner() {
+        block->in_use.store(false, std::memory_order_release);
+        Detail::current_block = &GetRegistry().exiting_threads_block;
+    }
+};
+
+std::string EscapeJson(const std::string& str) {
+    std::string escaped;
+    escaped.reserve(str.size());
+    for (const char c : str) {
+        switch (c) {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                escaped += fmt::format("\\u{:04x}", static_cast<int>(c));
+            } else {
+                escaped += c;
+            }
+            break;
+        }
+    }
+    return escaped;
+}
+
+/// Escapes a help text, or a label value if escape_quotes is set, for the Prometheus text format
+std::string EscapePrometheus(const std::string& str, bool escape_quotes) {
+    std::string escaped;
+    escaped.reserve(str.size());
+    for (const char c : str) {
+        if (c == '\\') {
+            escaped += "\\\\";
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else if (c == '"' && escape_quotes) {
+            escaped += "\\\"";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // Anonymous namespace
+
+Detail::Block* Detail::AcquireBlock() {
+    thread_local BlockOwner owner;
+
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    // Blocks of exited threads are reused. Their values are totals, so it does not matter which
+    // thread keeps adding to them.
+    for (const auto& block : registry.blocks) {
+        if (!block->in_use.load(std::memory_order_acquire)) {
+            owner.block = block.get();
+            break;
+        }
+    }
+    if (owner.block == nullptr) {
+        owner.block = registry.blocks.emplace_back(std::make_unique<Block>()).get();
+    }
+    owner.block->in_use.store(true, std::memory_order_relaxed);
+    current_block = owner.block;
+    return owner.block;
+}
+
+Counter Register(std::string name, std::string help, Labels labels) {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    auto key = std::make_pair(name, labels);
+    const auto it = registry.indices.find(key);
+    if (it != registry.indices.end()) {
+        return Counter{it->second};
+    }
+
+    if (registry.counters.size() == MaxCounters) {
+        LOG_ERROR(Common, "Too many counters, {} is not counted", name);
+        return Counter{};
+    }
+
+    registry.help_texts.emplace(name, std::move(help));
+    const auto index = static_cast<u32>(registry.counters.size());
+    registry.counters.push_back({std::move(name), std::move(labels)});
+    registry.indices.emplace(std::move(key), index);
+    return Counter{index};
+}
+
+std::vector<Sample> Snapshot() {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    std::vector<Sample> samples;
+    samples.reserve(registry.counters.size() - 1);
+    for (std::size_t i = 1; i < registry.counters.size(); ++i) {
+        u64 value = registry.exiting_threads_block.values[i].load(std::memory_order_relaxed);
+        for (const auto& block : registry.blocks) {
+            value += block->values[i].load(std::memory_order_relaxed);
+        }
+        const CounterInfo& info = registry.counters[i];
+        samples.push_back({info.name, registry.help_texts.at(info.name), info.labels, value});
+    }
+
+    // Keep the counters of a metric together, as the Prometheus format requires
+    std::stable_sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) {
+        return std::tie(a.name, a.labels) < std::tie(b.name, b.labels);
+    });
+    return samples;
+}
+
+std::string FormatJson(const std::vector<Sample>& samples) {
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    std::string out = fmt::format(
+        "{{\"timestamp_ms\":{},\"counters\":[",
+        std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+
+    bool first_sample = true;
+    for (const Sample& sample : samples) {
+        if (!first_sample) {
+            out += ',';
+        }
+        first_sample = false;
+
+        out += fmt::format("{{\"name\":\"{}\",\"labels\":{{", EscapeJson(sample.name));
+        bool first_label = true;
+        for (const auto& [label, value] : sample.labels) {
+            if (!first_label) {
+                out += ',';
+            }
+            first_label = false;
+            out += fmt::format("\"{}\":\"{}\"", EscapeJson(label), EscapeJson(value));
+        }
+        out += fmt::format("}},\"value\":{}}}", sample.value);
+    }
+    out += "]}\n";
+    return out;
+}
+
+std::string FormatPrometheus(const std::vector<Sample>& samples) {
+    std::string out;
+    const std::string* previous_name = nullptr;
+    for (const Sample& sample : samples) {
+        if (previous_name == nullptr || *previous_name != sample.name) {
+            out += fmt::format("# HELP {} {}\n# TYPE {} counter\n", sample.name,
+                               EscapePrometheus(sample.help, false), sample.name);
+            previous_name = &sample.name;
+        }
+
+        out += sample.name;
+        if (!sample.labels.empty()) {
+            out += '{';
+            bool first_label = true;
+            for (const auto& [label, value] : sample.labels) {
+                if (!first_label) {
+                    out += ',';
+                }
+                first_label = false;
+                out += fmt::format("{}=\"{}\"", label, EscapePrometheus(value, true));
+            }
+            out += '}';
+        }
+        out += fmt::format(" {}\n", sample.value);
+    }
+    return out;
+}
+
+struct PeriodicDumper::Impl {
+    std::string path;
+    bool json;
+    std::chrono::milliseconds interval;
+    Common::Event stop_event;
+    std::thread thread;
+};
+
+PeriodicDumper::PeriodicDumper(std::string path, std::chrono::milliseconds interval)
+    : impl(std::make_unique<Impl>()) {
+    const std::string extension = ".json";
+    const std::string lower_path = Common::ToLower(path);
+    impl->json = lower_path.size() >= extension.size() &&
+                 lower_path.compare(lower_path.size() - extension.size(), extension.size(),
+                                    extension) == 0;
+    impl->path = std::move(path);
+    impl->interval = interval;
+    impl->thread = std::thread([this] {
+        Common::SetCurrentThreadName("CounterDumper");
+        auto next_dump = std::chrono::steady_clock::now() + impl->interval;
+        while (!impl->stop_event.WaitUntil(next_dump)) {
+            Dump();
+            next_dump += impl->interval;
+        }
+    });
+}
+
+PeriodicDumper::~PeriodicDumper() {
+    impl->stop_event.Set();
+    impl->thread.join();
+    Dump();
+}
+
+void PeriodicDumper::Dump() const {
+    const std::vector<Sample> samples = Snapshot();
+    const std::string contents = impl->json ? FormatJson(samples) : FormatPrometheus(samples);
+
+    // Write to a temporary file first so that collectors never read a partial dump
+    const std::string temp_path = impl->path + ".tmp";
+    if (FileUtil::WriteStringToFile(true, contents, temp_path.c_str()) != contents.size()) {
+        LOG_ERROR(Common, "Could not write counters to {}", temp_path);
+        return;
+    }
+    if (!FileUtil::Replace(temp_path, impl->path)) {
+        LOG_ERROR(Common, "Could not replace {}", impl->path);
+    }
+}
+
+} // namespace Common::Counters
@@ -0,0 +1,113 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+/**
+ * Always-on event counters for hot paths, meant to be collected by external tools without a GUI
+ * attached. Every thread adds to its own block of counters, so counting is a plain add to a cache
+ * line no other thread writes to. Readers sum the blocks of all threads.
+ */
+namespace Common::Counters {
+
+/// Maximum number of counters that can be registered, including the one reserved for overflow
+constexpr std::size_t MaxCounters = 1024;
+
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+namespace Detail {
+
+struct alignas(64) Block {
+    std::array<std::atomic<u64>, MaxCounters> values{};
+    std::atomic<bool> in_use{false};
+};
+
+extern thread_local Block* current_block;
+
+/// Assigns a block to the calling thread
+Block* AcquireBlock();
+
+} // namespace Detail
+
+/// Handle to a registered counter. Handles are cheap to copy and stay valid forever.
+class Counter {
+public:
+    /// Creates a handle to the overflow counter, which is never reported
+    Counter() = default;
+
+    void Add(u64 amount = 1) const {
+        Detail::Block* block = Detail::current_block;
+        if (block == nullptr) {
+            block = Detail::AcquireBlock();
+        }
+        // Only the owning thread writes to the block, so the increment does not need to be atomic
+        std::atomic<u64>& value = block->values[index];
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+private:
+    friend Counter Register(std::string name, std::string help, Labels labels);
+    explicit Counter(u32 index) : index(index) {}
+
+    u32 index = 0;
+};
+
+/**
+ * Registers a counter. Registering the same name and labels again returns the same counter, which
+ * lets objects that are recreated for every emulation session keep counting where they left off.
+ * @param name Metric name, following the Prometheus conventions ("citra_gpu_draws_total")
+ * @param help Description of the metric; only the first registration of a name sets it
+ * @param labels Label names and values distinguishing this counter from others with the same name
+ */
+Counter Register(std::string name, std::string help, Labels labels = {});
+
+struct Sample {
+    std::string name;
+    std::string help;
+    Labels labels;
+    u64 value;
+};
+
+/// Returns the current value of every registered counter, ordered by name
+std::vector<Sample> Snapshot();
+
+/// Formats samples as a JSON object
+std::string FormatJson(const std::vector<Sample>& samples);
+
+/// Formats samples in the Prometheus text exposition format
+std::string FormatPrometheus(const std::vector<Sample>& samples);
+
+/**
+ * Writes all counters to a file at a fixed interval and once more on destruction. The file is
+ * written as JSON if its name ends in ".json", and in the Prometheus text format otherwise, which
+ * suits the textfile collector of node_exporter. The file is replaced atomically, so readers never
+ * see a partial dump.
+ */
+class PeriodicDumper {
+public:
+    PeriodicDumper(std::string path, std::chrono::milliseconds interval);
+    ~PeriodicDumper();
+
+    PeriodicDumper(const PeriodicDumper&) = delete;
+    PeriodicDumper& operator=(const PeriodicDumper&) = delete;
+
+    /// Writes the current counters to the file
+    void Dump() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace Common::Counters
@@ -41,7 +41,9 @@
 #include <cstdlib>
 #include <cstring>
 #include <dirent.h>
+#include <fcntl.h>
 #include <pwd.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -267,6 +269,23 @@ bool Rename(const std::string& srcFilename, const std::string& destFilename) {
     return false;
 }
 
+bool Replace(const std::string& srcFilename, const std::string& destFilename) {
+    LOG_TRACE(Common_Filesystem, "{} --> {}", srcFilename, destFilename);
+#ifdef _WIN32
+    // Unlike _wrename, this replaces an existing destination
+    if (MoveFileExW(Common::UTF8ToUTF16W(srcFilename).c_str(),
+                    Common::UTF8ToUTF16W(destFilename).c_str(),
+                    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        return true;
+#else
+    if (rename(srcFilename.c_str(), destFilename.c_str()) == 0)
+        return true;
+#endif
+    LOG_ERROR(Common_Filesystem, "failed {} --> {}: {}", srcFilename, destFilename,
+              GetLastErrorMsg());
+    return false;
+}
+
 // copies file srcFilename to destFilename, returns true on success
 bool Copy(const std::string& srcFilename, const std::string& destFilename) {
     LOG_TRACE(Common_Filesystem, "{} --> {}", srcFilename, destFilename);
@@ -873,6 +892,20 @@ bool IOFile::Flush() {
     return m_good;
 }
 
+bool IOFile::Sync() {
+    if (!Flush())
+        return false;
+
+#ifdef _WIN32
+    if (0 != _commit(_fileno(m_file)))
+#else
+    if (0 != fsync(fileno(m_file)))
+#endif
+        m_good = false;
+
+    return m_good;
+}
+
 bool IOFile::Resize(u64 size) {
     if (!IsOpen() || 0 !=
 #ifdef _WIN32
@@ -889,4 +922,98 @@ bool IOFile::Resize(u64 size) {
     return m_good;
 }
 
+MappedFile::MappedFile() {}
+
+MappedFile::MappedFile(const std::string& filename) {
+    Open(filename);
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) {
+    Swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+    Swap(other);
+    return *this;
+}
+
+void MappedFile::Swap(MappedFile& other) {
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+#ifdef _WIN32
+    std::swap(m_mapping, other.m_mapping);
+#endif
+}
+
+bool MappedFile::Open(const std::string& filename) {
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileW(Common::UTF8ToUTF16W(filename).c_str(), GENERIC_READ,
+                              FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // The mapping object keeps its own reference to the file
+    m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (m_mapping == nullptr)
+        return false;
+
+    m_data = static_cast<const u8*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+        return false;
+    }
+    m_size = static_cast<u64>(size.QuadPart);
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    struct stat file_info;
+    if (fstat(fd, &file_info) != 0 || file_info.st_size == 0 ||
+        static_cast<u64>(file_info.st_size) > std::numeric_limits<std::size_t>::max()) {
+        close(fd);
+        return false;
+    }
+
+    const std::size_t size = static_cast<std::size_t>(file_info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    m_data = static_cast<const u8*>(data);
+    m_size = size;
+#endif
+    return true;
+}
+
+void MappedFile::Close() {
+    if (!IsOpen())
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+#else
+    munmap(const_cast<u8*>(m_data), static_cast<std::size_t>(m_size));
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
 } // namespace FileUtil
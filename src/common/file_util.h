@@ -72,6 +72,9 @@ bool DeleteDir(const std::string& filename);
 // renames file srcFilename to destFilename, returns true on success
 bool Rename(const std::string& srcFilename, const std::string& destFilename);
 
+// moves file srcFilename over an existing destFilename in one step, returns true on success
+bool Replace(const std::string& srcFilename, const std::string& destFilename);
+
 // copies file srcFilename to destFilename, returns true on success
 bool Copy(const std::string& srcFilename, const std::string& destFilename);
 
@@ -246,6 +249,8 @@ public:
     u64 GetSize() const;
     bool Resize(u64 size);
     bool Flush();
+    // Flushes and asks the OS to write the file contents through to the storage device
+    bool Sync();
 
     // clear error state
     void Clear() {
@@ -258,6 +263,44 @@ private:
     bool m_good = true;
 };
 
+// Read-only memory mapping of a whole file, used to access large files (e.g. ROM images) without
+// copying them through stdio buffers. Mapping can fail (e.g. address space exhaustion on 32-bit
+// hosts), callers are expected to fall back to IOFile in that case.
+class MappedFile : public NonCopyable {
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& filename);
+
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+
+    void Swap(MappedFile& other);
+
+    bool Open(const std::string& filename);
+    void Close();
+
+    bool IsOpen() const {
+        return nullptr != m_data;
+    }
+
+    const u8* Data() const {
+        return m_data;
+    }
+
+    u64 GetSize() const {
+        return m_size;
+    }
+
+private:
+    const u8* m_data = nullptr;
+    u64 m_size = 0;
+#ifdef _WIN32
+    void* m_mapping = nullptr;
+#endif
+};
+
 } // namespace FileUtil
 
 // To deal with Windows being dumb at unicode:
@@ -3,9 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -18,6 +20,7 @@
 #endif
 #include "common/assert.h"
 #include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
 #include "common/logging/log.h"
 #include "common/logging/text_formatter.h"
 #include "common/string_util.h"
@@ -25,6 +28,90 @@
 
 namespace Log {
 
+namespace {
+
+using std::chrono::steady_clock;
+
+std::chrono::microseconds GetTimestamp() {
+    static const steady_clock::time_point time_origin = steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(steady_clock::now() -
+                                                                 time_origin);
+}
+
+/**
+ * Ring of messages logged by one thread, which only that thread writes to and only the logging
+ * thread reads from. The messages are constructed in preallocated storage, so logging doesn't
+ * allocate unless an argument is a string.
+ */
+class MessageRing {
+public:
+    static constexpr u32 Capacity = 512;
+
+    struct Slot {
+        alignas(std::max_align_t) std::array<u8, Detail::DeferredMessageSize> storage;
+        Detail::DeferredMessage* message;
+        std::chrono::microseconds timestamp;
+        Class log_class;
+        Level log_level;
+        const char* filename;
+        unsigned int line_num;
+        const char* function;
+    };
+
+    /// Returns the slot to construct the next message in, or nullptr if the ring is full
+    Slot* Reserve() {
+        const u32 head = write_index.load(std::memory_order_relaxed);
+        if (head - read_index.load(std::memory_order_acquire) == Capacity)
+            return nullptr;
+        return &slots[head % Capacity];
+    }
+
+    /// Makes the reserved slot visible to the logging thread
+    /// @returns the number of messages in the ring
+    u32 Push() {
+        const u32 head = write_index.fetch_add(1, std::memory_order_release) + 1;
+        return head - read_index.load(std::memory_order_relaxed);
+    }
+
+    /// Formats and removes the queued messages, appending them to entries
+    void Drain(std::vector<Entry>& entries) {
+        const u32 head = write_index.load(std::memory_order_acquire);
+        u32 tail = read_index.load(std::memory_order_relaxed);
+        for (; tail != head; ++tail) {
+            Slot& slot = slots[tail % Capacity];
+            Entry entry;
+            entry.timestamp = slot.timestamp;
+            entry.log_class = slot.log_class;
+            entry.log_level = slot.log_level;
+            entry.filename = Common::TrimSourcePath(slot.filename);
+            entry.line_num = slot.line_num;
+            entry.function = slot.function;
+            entry.message = slot.message->Format();
+            slot.message->~DeferredMessage();
+            entries.push_back(std::move(entry));
+        }
+        read_index.store(tail, std::memory_order_release);
+    }
+
+    bool Empty() const {
+        return read_index.load(std::memory_order_acquire) ==
+               write_index.load(std::memory_order_acquire);
+    }
+
+    /// Set when the thread owning the ring exits, after which it can be dropped once drained
+    std::atomic<bool> closed{false};
+
+private:
+    std::array<Slot, Capacity> slots;
+    std::atomic<u32> write_index{0};
+    std::atomic<u32> read_index{0};
+};
+
+/// Set while the thread writes entries to the backends, which may log errors themselves
+thread_local bool writing_entries = false;
+
+} // Anonymous namespace
+
 /**
  * Static state as a singleton.
  */
@@ -40,6 +127,40 @@ public:
 
     void PushEntry(Entry e) {
         message_queue.Push(std::move(e));
+        Notify();
+    }
+
+    /// Returns the ring of the calling thread, creating it on the thread's first message
+    MessageRing& GetThreadRing() {
+        struct RingOwner {
+            std::shared_ptr<MessageRing> ring;
+            ~RingOwner() {
+                if (ring)
+                    ring->closed = true;
+            }
+        };
+        thread_local RingOwner owner;
+        if (!owner.ring) {
+            owner.ring = std::make_shared<MessageRing>();
+            std::lock_guard lock{rings_mutex};
+            rings.push_back(owner.ring);
+        }
+        return *owner.ring;
+    }
+
+    /// Wakes up the logging thread if it is waiting for messages
+    void Notify() {
+        if (backend_waiting.load(std::memory_order_relaxed)) {
+            wake_up.notify_one();
+        }
+    }
+
+    /// Writes the queued messages of all threads before returning. Errors are flushed this way, as
+    /// they are often followed by a crash that would lose them.
+    void Flush() {
+        if (writing_entries)
+            return;
+        WriteQueuedEntries(std::numeric_limits<std::size_t>::max());
     }
 
     void AddBackend(std::unique_ptr<Backend> backend) {
@@ -75,42 +196,88 @@ public:
 private:
     Impl() {
         backend_thread = std::thread([&] {
-            Entry entry;
-            auto write_logs = [&](Entry& e) {
-                std::lock_guard<std::mutex> lock(writing_mutex);
-                for (const auto& backend : backends) {
-                    backend->Write(e);
+            while (!stop) {
+                if (!WriteQueuedEntries(std::numeric_limits<std::size_t>::max())) {
+                    // Messages pushed to rings usually don't notify, so check them periodically
+                    std::unique_lock lock{wait_mutex};
+                    backend_waiting = true;
+                    wake_up.wait_for(lock, std::chrono::milliseconds(10));
+                    backend_waiting = false;
                 }
-            };
-            while (true) {
-                entry = message_queue.PopWait();
-                if (entry.final_entry) {
-                    break;
-                }
-                write_logs(entry);
             }
 
-            // Drain the logging queue. Only writes out up to MAX_LOGS_TO_WRITE to prevent a case
-            // where a system is repeatedly spamming logs even on close.
-            constexpr int MAX_LOGS_TO_WRITE = 100;
-            int logs_written = 0;
-            while (logs_written++ < MAX_LOGS_TO_WRITE && message_queue.Pop(entry)) {
-                write_logs(entry);
-            }
+            // Drain the logging queue. Only writes out up to MAX_LOGS_TO_WRITE of the queued
+            // entries to prevent a case where a system is repeatedly spamming logs even on close.
+            constexpr std::size_t MAX_LOGS_TO_WRITE = 100;
+            WriteQueuedEntries(MAX_LOGS_TO_WRITE);
         });
     }
 
     ~Impl() {
-        Entry entry;
-        entry.final_entry = true;
-        message_queue.Push(entry);
+        stop = true;
+        wake_up.notify_one();
         backend_thread.join();
     }
 
+    /**
+     * Formats and writes the messages of all threads. Collecting and writing happen under the same
+     * lock, so that messages flushed by a logging thread can't overtake earlier ones.
+     * @returns whether there were any messages
+     */
+    bool WriteQueuedEntries(std::size_t max_queued) {
+        std::lock_guard<std::mutex> lock(writing_mutex);
+        CollectEntries(entries, max_queued);
+        if (entries.empty())
+            return false;
+        // Messages of different threads are drained separately, so restore their order
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const auto& a, const auto& b) { return a.timestamp < b.timestamp; });
+        writing_entries = true;
+        for (const auto& entry : entries) {
+            for (const auto& backend : backends) {
+                backend->Write(entry);
+            }
+        }
+        writing_entries = false;
+        entries.clear();
+        return true;
+    }
+
+    /// Moves the messages of all threads into entries, formatting the deferred ones
+    void CollectEntries(std::vector<Entry>& entries, std::size_t max_queued) {
+        std::lock_guard lock{rings_mutex};
+        for (auto it = rings.begin(); it != rings.end();) {
+            MessageRing& ring = **it;
+            // Check closed first, as the thread may push messages until it sets it
+            const bool closed = ring.closed.load();
+            ring.Drain(entries);
+            if (closed && ring.Empty()) {
+                it = rings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        Entry entry;
+        for (std::size_t i = 0; i < max_queued && message_queue.Pop(entry); ++i) {
+            entries.push_back(std::move(entry));
+        }
+    }
+
     std::mutex writing_mutex;
     std::thread backend_thread;
     std::vector<std::unique_ptr<Backend>> backends;
+    /// Messages being written, guarded by writing_mutex
+    std::vector<Entry> entries;
+    /// Entries that were formatted when logged, because their ring was full or their arguments
+    /// can't be copied
     Common::MPSCQueue<Log::Entry> message_queue;
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<MessageRing>> rings;
+    std::mutex wait_mutex;
+    std::condition_variable wake_up;
+    std::atomic<bool> backend_waiting{false};
+    std::atomic<bool> stop{false};
     Filter filter;
 };
 
@@ -140,6 +307,30 @@ void FileBackend::Write(const Entry& entry) {
     }
 }
 
+BinaryFileBackend::BinaryFileBackend(const std::string& filename)
+    : file(filename, "wb", _SH_DENYWR), writer(std::make_unique<BinaryLogWriter>()) {
+    std::vector<u8> header;
+    BinaryLogWriter::WriteHeader(header);
+    bytes_written += file.WriteBytes(header.data(), header.size());
+}
+
+BinaryFileBackend::~BinaryFileBackend() = default;
+
+void BinaryFileBackend::Write(const Entry& entry) {
+    // prevent logs from going over the maximum size (in case its spamming and the user doesn't
+    // know)
+    constexpr std::size_t MAX_BYTES_WRITTEN = 50 * 1024L * 1024L;
+    if (!file.IsOpen() || bytes_written > MAX_BYTES_WRITTEN) {
+        return;
+    }
+    std::vector<u8> record;
+    writer->Write(entry, record);
+    bytes_written += file.WriteBytes(record.data(), record.size());
+    if (entry.log_level >= Level::Error) {
+        file.Flush();
+    }
+}
+
 void DebuggerBackend::Write(const Entry& entry) {
 #ifdef _WIN32
     ::OutputDebugStringW(Common::UTF8ToUTF16W(FormatLogMessage(entry).append(1, '\n')).c_str());
@@ -250,13 +441,8 @@ const char* GetLevelName(Level log_level) {
 
 Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
                   const char* function, std::string message) {
-    using std::chrono::duration_cast;
-    using std::chrono::steady_clock;
-
-    static steady_clock::time_point time_origin = steady_clock::now();
-
     Entry entry;
-    entry.timestamp = duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+    entry.timestamp = GetTimestamp();
     entry.log_class = log_class;
     entry.log_level = log_level;
     entry.filename = Common::TrimSourcePath(filename);
@@ -295,5 +481,44 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
         CreateEntry(log_class, log_level, filename, line_num, function, fmt::vformat(format, args));
 
     instance.PushEntry(std::move(entry));
+    if (log_level >= Level::Error) {
+        instance.Flush();
+    }
 }
+
+namespace Detail {
+
+bool CheckFilter(Class log_class, Level log_level) {
+    return Impl::Instance().GetGlobalFilter().CheckMessage(log_class, log_level);
+}
+
+void* ReserveDeferredMessage() {
+    MessageRing::Slot* slot = Impl::Instance().GetThreadRing().Reserve();
+    return slot != nullptr ? slot->storage.data() : nullptr;
+}
+
+void PushDeferredMessage(Class log_class, Level log_level, const char* filename,
+                         unsigned int line_num, const char* function, DeferredMessage* message) {
+    auto& instance = Impl::Instance();
+    MessageRing& ring = instance.GetThreadRing();
+    // ReserveDeferredMessage returned the storage of this slot
+    MessageRing::Slot* slot = ring.Reserve();
+    slot->message = message;
+    slot->timestamp = GetTimestamp();
+    slot->log_class = log_class;
+    slot->log_level = log_level;
+    slot->filename = filename;
+    slot->line_num = line_num;
+    slot->function = function;
+    const u32 queued = ring.Push();
+    if (log_level >= Level::Error) {
+        instance.Flush();
+    } else if (queued >= MessageRing::Capacity / 2) {
+        // The logging thread checks the rings periodically, only wake it up early if this one is
+        // filling up
+        instance.Notify();
+    }
+}
+
+} // namespace Detail
 } // namespace Log
@@ -14,21 +14,22 @@
 
 namespace Log {
 
+class BinaryLogWriter;
 class Filter;
 
 /**
  * A log entry. Log entries are store in a structured format to permit more varied output
  * formatting on different frontends, as well as facilitating filtering and aggregation.
+ * The filename and function point to static strings, so that entries don't have to copy them.
  */
 struct Entry {
     std::chrono::microseconds timestamp;
     Class log_class;
     Level log_level;
-    std::string filename;
+    const char* filename = "";
     unsigned int line_num;
-    std::string function;
+    const char* function = "";
     std::string message;
-    bool final_entry = false;
 
     Entry() = default;
     Entry(Entry&& o) = default;
@@ -105,6 +106,31 @@ private:
     std::size_t bytes_written;
 };
 
+/**
+ * Backend that writes to a file in the compact binary format of BinaryLogWriter, which
+ * citra-log-decoder converts to text
+ */
+class BinaryFileBackend : public Backend {
+public:
+    explicit BinaryFileBackend(const std::string& filename);
+    ~BinaryFileBackend() override;
+
+    static const char* Name() {
+        return "binary_file";
+    }
+
+    const char* GetName() const override {
+        return Name();
+    }
+
+    void Write(const Entry& entry) override;
+
+private:
+    FileUtil::IOFile file;
+    std::unique_ptr<BinaryLogWriter> writer;
+    std::size_t bytes_written = 0;
+};
+
 /**
  * Backend that writes to Visual Studio's output window
  */
@@ -136,7 +162,8 @@ const char* GetLogClassName(Class log_class);
  */
 const char* GetLevelName(Level log_level);
 
-/// Creates a log entry by formatting the given source location, and message.
+/// Creates a log entry by formatting the given source location, and message. The source location
+/// strings must be static.
 Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
                   const char* function, std::string message);
 
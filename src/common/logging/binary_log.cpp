@@ -0,0 +1,135 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+#include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
+
+namespace Log {
+
+namespace {
+
+void WriteVarint(u64 value, std::vector<u8>& out) {
+    do {
+        u8 byte = value & 0x7F;
+        value >>= 7;
+        if (value != 0)
+            byte |= 0x80;
+        out.push_back(byte);
+    } while (value != 0);
+}
+
+void WriteString(std::string_view string, std::vector<u8>& out) {
+    WriteVarint(string.size(), out);
+    out.insert(out.end(), string.begin(), string.end());
+}
+
+} // Anonymous namespace
+
+void BinaryLogWriter::WriteHeader(std::vector<u8>& out) {
+    out.insert(out.end(), BinaryLog::Magic.begin(), BinaryLog::Magic.end());
+    out.push_back(BinaryLog::Version);
+}
+
+void BinaryLogWriter::Write(const Entry& entry, std::vector<u8>& out) {
+    const u32 filename_index = GetStringIndex(entry.filename, out);
+    const u32 function_index = GetStringIndex(entry.function, out);
+
+    out.push_back(static_cast<u8>(BinaryLog::RecordType::Entry));
+    WriteVarint(static_cast<u64>(entry.timestamp.count()), out);
+    out.push_back(static_cast<u8>(entry.log_class));
+    out.push_back(static_cast<u8>(entry.log_level));
+    WriteVarint(filename_index, out);
+    WriteVarint(function_index, out);
+    WriteVarint(entry.line_num, out);
+    WriteString(entry.message, out);
+}
+
+u32 BinaryLogWriter::GetStringIndex(const char* string, std::vector<u8>& out) {
+    const auto [it, inserted] =
+        string_indices.emplace(string, static_cast<u32>(string_indices.size()));
+    if (inserted) {
+        out.push_back(static_cast<u8>(BinaryLog::RecordType::String));
+        WriteString(string, out);
+    }
+    return it->second;
+}
+
+BinaryLogReader::BinaryLogReader(std::vector<u8> data_) : data(std::move(data_)) {
+    constexpr std::size_t header_size = BinaryLog::Magic.size() + 1;
+    valid = data.size() >= header_size &&
+            std::equal(BinaryLog::Magic.begin(), BinaryLog::Magic.end(), data.begin()) &&
+            data[BinaryLog::Magic.size()] == BinaryLog::Version;
+    position = header_size;
+}
+
+bool BinaryLogReader::IsValid() const {
+    return valid;
+}
+
+bool BinaryLogReader::Read(Entry& entry) {
+    if (!valid)
+        return false;
+
+    while (position < data.size()) {
+        const auto type = static_cast<BinaryLog::RecordType>(data[position++]);
+        if (type == BinaryLog::RecordType::String) {
+            if (!ReadString(strings.emplace_back()))
+                return false;
+            continue;
+        }
+        if (type != BinaryLog::RecordType::Entry)
+            return false;
+
+        u64 timestamp, filename_index, function_index, line_num;
+        if (!ReadVarint(timestamp) || data.size() - position < 2)
+            return false;
+        const u8 log_class = data[position++];
+        const u8 log_level = data[position++];
+        if (!ReadVarint(filename_index) || !ReadVarint(function_index) || !ReadVarint(line_num) ||
+            !ReadString(entry.message)) {
+            return false;
+        }
+        if (log_class >= static_cast<u8>(Class::Count) ||
+            log_level >= static_cast<u8>(Level::Count) || filename_index >= strings.size() ||
+            function_index >= strings.size()) {
+            return false;
+        }
+
+        entry.timestamp = std::chrono::microseconds(timestamp);
+        entry.log_class = static_cast<Class>(log_class);
+        entry.log_level = static_cast<Level>(log_level);
+        entry.filename = strings[filename_index].c_str();
+        entry.function = strings[function_index].c_str();
+        entry.line_num = static_cast<unsigned int>(line_num);
+        return true;
+    }
+    return false;
+}
+
+bool BinaryLogReader::ReadVarint(u64& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (position >= data.size())
+            return false;
+        const u8 byte = data[position++];
+        value |= static_cast<u64>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool BinaryLogReader::ReadString(std::string& string) {
+    u64 size;
+    if (!ReadVarint(size) || size > data.size() - position)
+        return false;
+    string.assign(reinterpret_cast<const char*>(data.data() + position), size);
+    position += size;
+    return true;
+}
+
+} // namespace Log
@@ -0,0 +1,76 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Log {
+
+struct Entry;
+
+/**
+ * Compact binary log format. A log starts with a header, followed by records that either define a
+ * string or hold an entry. Source filenames and function names are only written the first time
+ * they are used and referred to by index afterwards. Numbers are stored as LEB128 varints.
+ */
+namespace BinaryLog {
+
+constexpr std::array<u8, 4> Magic = {{'C', 'L', 'O', 'G'}};
+constexpr u8 Version = 1;
+
+enum class RecordType : u8 {
+    String = 0, ///< Defines the string with the next index
+    Entry = 1,  ///< A log entry
+};
+
+} // namespace BinaryLog
+
+class BinaryLogWriter {
+public:
+    /// Appends the header that starts a log
+    static void WriteHeader(std::vector<u8>& out);
+
+    /// Appends the entry, preceded by definitions of the strings it is the first to use
+    void Write(const Entry& entry, std::vector<u8>& out);
+
+private:
+    u32 GetStringIndex(const char* string, std::vector<u8>& out);
+
+    /// Index of the static strings that have been defined, by address
+    std::unordered_map<const char*, u32> string_indices;
+};
+
+class BinaryLogReader {
+public:
+    explicit BinaryLogReader(std::vector<u8> data);
+
+    /// Returns whether the data starts with a header of a supported version
+    bool IsValid() const;
+
+    /**
+     * Reads the next entry of the log. The filename and function of the entry point to strings
+     * owned by the reader.
+     * @returns false at the end of the log, or if the rest of the log is truncated or corrupted
+     */
+    bool Read(Entry& entry);
+
+private:
+    bool ReadVarint(u64& value);
+    bool ReadString(std::string& string);
+
+    std::vector<u8> data;
+    std::size_t position = 0;
+    bool valid = false;
+    /// Strings defined so far, by index. A deque keeps them in place while more are added.
+    std::deque<std::string> strings;
+};
+
+} // namespace Log
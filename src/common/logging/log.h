@@ -4,6 +4,12 @@
 
 #pragma once
 
+#include <cstddef>
+#include <new>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <fmt/format.h>
 #include "common/common_types.h"
 
@@ -108,9 +114,79 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args);
 
+namespace Detail {
+
+/// Type an argument is copied as so that the message can be formatted after the call returns.
+/// Strings are copied, as only their address would be kept otherwise.
+template <typename T>
+using StoredArg =
+    std::conditional_t<std::is_convertible_v<const T&, std::string_view>, std::string, T>;
+
+/// A message whose arguments have been copied, to be formatted by the logging thread
+class DeferredMessage {
+public:
+    virtual ~DeferredMessage() = default;
+    virtual std::string Format() const = 0;
+};
+
+template <typename... Args>
+class DeferredMessageImpl final : public DeferredMessage {
+public:
+    explicit DeferredMessageImpl(const char* format, const Args&... args)
+        : format(format), args(args...) {}
+
+    std::string Format() const override {
+        return std::apply(
+            [this](const auto&... stored) {
+                return fmt::vformat(format, fmt::make_format_args(stored...));
+            },
+            args);
+    }
+
+private:
+    const char* format;
+    std::tuple<StoredArg<Args>...> args;
+};
+
+/// Storage reserved for each message in the per-thread rings
+constexpr std::size_t DeferredMessageSize = 192;
+
+template <typename... Args>
+constexpr bool CanDefer = (std::is_copy_constructible_v<StoredArg<Args>> && ...) &&
+                          sizeof(DeferredMessageImpl<Args...>) <= DeferredMessageSize &&
+                          alignof(DeferredMessageImpl<Args...>) <= alignof(std::max_align_t);
+
+/// Returns whether the global filter lets messages of the given class and level through
+bool CheckFilter(Class log_class, Level log_level);
+
+/// Returns storage for a message in the calling thread's ring, or nullptr if the ring is full
+void* ReserveDeferredMessage();
+
+/// Queues the message constructed in the storage returned by ReserveDeferredMessage. The source
+/// location strings must be static.
+void PushDeferredMessage(Class log_class, Level log_level, const char* filename,
+                         unsigned int line_num, const char* function, DeferredMessage* message);
+
+} // namespace Detail
+
+/**
+ * Logs a message to the global logger, using fmt. The arguments are copied and formatted on the
+ * logging thread when they fit into the ring of the calling thread, and formatted right away
+ * otherwise.
+ */
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const Args&... args) {
+    if constexpr (Detail::CanDefer<Args...>) {
+        if (!Detail::CheckFilter(log_class, log_level))
+            return;
+        if (void* storage = Detail::ReserveDeferredMessage()) {
+            auto* message = new (storage) Detail::DeferredMessageImpl<Args...>(format, args...);
+            Detail::PushDeferredMessage(log_class, log_level, filename, line_num, function,
+                                        message);
+            return;
+        }
+    }
     FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
                       fmt::make_format_args(args...));
 }
@@ -0,0 +1,224 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <signal.h>
+#include <sys/mman.h>
+#endif
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/memory_snapshot.h"
+
+namespace Common {
+
+namespace {
+
+/// Snapshots whose blocks are write-protected, looked up by the fault handler
+std::array<std::atomic<CopyOnWriteSnapshot*>, CopyOnWriteSnapshot::MaxActiveSnapshots>
+    active_snapshots{};
+
+/// Number of fault handlers looking at active_snapshots, waited for before a snapshot goes away
+std::atomic<u32> handlers_in_flight{0};
+
+void SetWritable(u8* pointer, std::size_t size, bool writable) {
+#ifdef _WIN32
+    DWORD old_protection;
+    const BOOL result = VirtualProtect(pointer, size, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                       &old_protection);
+    ASSERT_MSG(result, "VirtualProtect failed with error {}", GetLastError());
+#else
+    const int result = mprotect(pointer, size, writable ? PROT_READ | PROT_WRITE : PROT_READ);
+    ASSERT_MSG(result == 0, "mprotect failed with errno {}", errno);
+#endif
+}
+
+#ifdef _WIN32
+
+LONG CALLBACK FaultHandler(PEXCEPTION_POINTERS pointers) {
+    const EXCEPTION_RECORD& record = *pointers->ExceptionRecord;
+    // The first parameter is 1 for writes, the second one the address
+    if (record.ExceptionCode == EXCEPTION_ACCESS_VIOLATION && record.NumberParameters >= 2 &&
+        record.ExceptionInformation[0] == 1 &&
+        CopyOnWriteSnapshot::HandleWriteFault(
+            reinterpret_cast<const void*>(record.ExceptionInformation[1]))) {
+        return EXCEPTION_CONTINUE_EXECUTION;
+    }
+    // Vectored handlers are chained by the OS
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+void InstallFaultHandler() {
+    static std::once_flag handler_installed;
+    std::call_once(handler_installed, [] { AddVectoredExceptionHandler(1, FaultHandler); });
+}
+
+#else
+
+struct sigaction previous_segv_action;
+struct sigaction previous_bus_action;
+
+void FaultHandler(int signal, siginfo_t* info, void* context) {
+    if (CopyOnWriteSnapshot::HandleWriteFault(info->si_addr)) {
+        return;
+    }
+
+    // Not ours, hand the fault to whoever handled it before
+    const struct sigaction& previous =
+        signal == SIGBUS ? previous_bus_action : previous_segv_action;
+    if (previous.sa_flags & SA_SIGINFO) {
+        previous.sa_sigaction(signal, info, context);
+    } else if (previous.sa_handler == SIG_DFL || previous.sa_handler == SIG_IGN) {
+        // The faulting instruction runs again and gets the previous disposition
+        sigaction(signal, &previous, nullptr);
+    } else {
+        previous.sa_handler(signal);
+    }
+}
+
+void InstallFaultHandler(int signal, struct sigaction& previous) {
+    struct sigaction current;
+    sigaction(signal, nullptr, &current);
+    if ((current.sa_flags & SA_SIGINFO) && current.sa_sigaction == FaultHandler) {
+        return;
+    }
+
+    struct sigaction action {};
+    action.sa_sigaction = FaultHandler;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    sigaction(signal, &action, &previous);
+}
+
+/// Called for every snapshot, as crash handlers installed later may have replaced ours
+void InstallFaultHandler() {
+    static std::mutex install_mutex;
+    std::lock_guard lock(install_mutex);
+    InstallFaultHandler(SIGSEGV, previous_segv_action);
+    // macOS reports writes to protected pages as SIGBUS
+    InstallFaultHandler(SIGBUS, previous_bus_action);
+}
+
+#endif
+
+} // Anonymous namespace
+
+PagedMemory::PagedMemory(std::size_t size) : allocated_size(size) {
+#ifdef _WIN32
+    pointer = static_cast<u8*>(VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT,
+                                            PAGE_READWRITE));
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+#else
+    void* const result =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (result == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    pointer = static_cast<u8*>(result);
+#endif
+}
+
+PagedMemory::~PagedMemory() {
+#ifdef _WIN32
+    VirtualFree(pointer, 0, MEM_RELEASE);
+#else
+    munmap(pointer, allocated_size);
+#endif
+}
+
+CopyOnWriteSnapshot::CopyOnWriteSnapshot(const PagedMemory& memory)
+    : block(memory.get()), size(memory.size()), copy(size),
+      chunk_states(new std::atomic<u8>[size / ChunkSize]) {
+    ASSERT(size % ChunkSize == 0);
+    for (std::size_t i = 0; i < size / ChunkSize; ++i) {
+        chunk_states[i].store(Pending, std::memory_order_relaxed);
+    }
+
+    InstallFaultHandler();
+
+    for (slot = 0; slot < MaxActiveSnapshots; ++slot) {
+        CopyOnWriteSnapshot* expected = nullptr;
+        if (active_snapshots[slot].compare_exchange_strong(expected, this)) {
+            break;
+        }
+    }
+    if (slot == MaxActiveSnapshots) {
+        LOG_WARNING(Common_Memory, "Too many snapshots in progress, copying the block right away");
+        std::memcpy(copy.get(), block, size);
+        for (std::size_t i = 0; i < size / ChunkSize; ++i) {
+            chunk_states[i].store(Copied, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    SetWritable(block, size, false);
+}
+
+CopyOnWriteSnapshot::~CopyOnWriteSnapshot() {
+    Finish();
+}
+
+const u8* CopyOnWriteSnapshot::Finish() {
+    if (slot == MaxActiveSnapshots) {
+        return copy.get();
+    }
+
+    for (std::size_t i = 0; i < size / ChunkSize; ++i) {
+        CopyChunk(i);
+    }
+
+    // Handlers that found this snapshot before it was removed may still be looking at it
+    active_snapshots[slot].store(nullptr);
+    while (handlers_in_flight.load() != 0) {
+        std::this_thread::yield();
+    }
+    slot = MaxActiveSnapshots;
+    return copy.get();
+}
+
+bool CopyOnWriteSnapshot::HandleWriteFault(const void* address) {
+    const u8* const byte = static_cast<const u8*>(address);
+    bool handled = false;
+
+    handlers_in_flight.fetch_add(1);
+    for (auto& active_snapshot : active_snapshots) {
+        CopyOnWriteSnapshot* const snapshot = active_snapshot.load();
+        if (snapshot != nullptr && byte >= snapshot->block &&
+            byte < snapshot->block + snapshot->size) {
+            snapshot->CopyChunk(static_cast<std::size_t>(byte - snapshot->block) / ChunkSize);
+            handled = true;
+            break;
+        }
+    }
+    handlers_in_flight.fetch_sub(1);
+
+    return handled;
+}
+
+void CopyOnWriteSnapshot::CopyChunk(std::size_t index) {
+    std::atomic<u8>& state = chunk_states[index];
+    u8 expected = Pending;
+    if (state.compare_exchange_strong(expected, Copying, std::memory_order_acquire)) {
+        const std::size_t offset = index * ChunkSize;
+        std::memcpy(copy.get() + offset, block + offset, ChunkSize);
+        SetWritable(block + offset, ChunkSize, true);
+        state.store(Copied, std::memory_order_release);
+        return;
+    }
+
+    // The chunk is unprotected once copied, which takes a few microseconds. This runs in fault
+    // handlers, so it can't wait on anything but the state.
+    while (state.load(std::memory_order_acquire) != Copied) {
+    }
+}
+
+} // namespace Common
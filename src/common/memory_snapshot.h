@@ -0,0 +1,97 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Zeroed memory allocated directly from the OS in whole pages, which can be snapshotted by a
+ * CopyOnWriteSnapshot. The pages are only backed once they are touched.
+ */
+class PagedMemory {
+public:
+    explicit PagedMemory(std::size_t size);
+    ~PagedMemory();
+
+    PagedMemory(const PagedMemory&) = delete;
+    PagedMemory& operator=(const PagedMemory&) = delete;
+
+    u8* get() const {
+        return pointer;
+    }
+
+    std::size_t size() const {
+        return allocated_size;
+    }
+
+private:
+    u8* pointer;
+    std::size_t allocated_size;
+};
+
+/**
+ * Copy of a block of PagedMemory taken without holding up its writers. The block is
+ * write-protected when the snapshot starts, and copied chunk by chunk by Finish. A write to a chunk
+ * that was not copied yet faults, and the fault handler copies the chunk before letting the write
+ * through, so the copy holds the contents of the block at the time the snapshot started.
+ */
+class CopyOnWriteSnapshot {
+public:
+    /// Granularity of the copies, a multiple of the host page size
+    static constexpr std::size_t ChunkSize = 0x10000;
+
+    /// Number of snapshots that can be in progress at the same time
+    static constexpr std::size_t MaxActiveSnapshots = 8;
+
+    /// Write-protects the block, whose size must be a multiple of ChunkSize
+    explicit CopyOnWriteSnapshot(const PagedMemory& block);
+
+    /// Finishes the copy if Finish was not called, so that the block is writable again
+    ~CopyOnWriteSnapshot();
+
+    CopyOnWriteSnapshot(const CopyOnWriteSnapshot&) = delete;
+    CopyOnWriteSnapshot& operator=(const CopyOnWriteSnapshot&) = delete;
+
+    /**
+     * Copies the chunks that were not written to since the snapshot started. Can be called from
+     * any thread, while the block is being written to.
+     * @returns The copy, which is valid as long as the snapshot
+     */
+    const u8* Finish();
+
+    std::size_t GetSize() const {
+        return size;
+    }
+
+    /**
+     * Copies the chunk containing the address if it belongs to an active snapshot. Called by the
+     * fault handler, but exposed for the handlers of hosts that have to be chained by hand.
+     * @returns True if the address belongs to an active snapshot, and the write can be retried
+     */
+    static bool HandleWriteFault(const void* address);
+
+private:
+    enum ChunkState : u8 {
+        Pending,
+        Copying,
+        Copied,
+    };
+
+    /// Copies the chunk if nobody else did, or waits for the thread copying it
+    void CopyChunk(std::size_t index);
+
+    u8* const block;
+    const std::size_t size;
+    PagedMemory copy;
+    std::unique_ptr<std::atomic<u8>[]> chunk_states;
+    std::size_t slot;
+};
+
+} // namespace Common
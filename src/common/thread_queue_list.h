@@ -118,6 +118,10 @@ struct ThreadQueueList {
         return cur->data.empty();
     }
 
+    const std::deque<T>& get_queue(Priority priority) const {
+        return queues[priority].data;
+    }
+
     void prepare(Priority priority) {
         Queue* cur = &queues[priority];
         if (cur->next_nonempty == UnlinkedTag())
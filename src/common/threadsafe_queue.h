@@ -141,7 +141,7 @@ public:
     template <typename Arg>
     void Push(Arg&& t) {
         std::lock_guard<std::mutex> lock(write_lock);
-        spsc_queue.Push(t);
+        spsc_queue.Push(std::forward<Arg>(t));
     }
 
     void Pop() {
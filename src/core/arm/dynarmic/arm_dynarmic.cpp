@@ -6,6 +6,7 @@
 #include <dynarmic/A32/a32.h>
 #include <dynarmic/A32/context.h>
 #include "common/assert.h"
+#include "common/counters.h"
 #include "common/microprofile.h"
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/arm/dynarmic/arm_dynarmic_cp15.h"
@@ -268,7 +269,12 @@ void ARM_Dynarmic::PrepareReschedule() {
     }
 }
 
+static const Common::Counters::Counter jit_invalidations = Common::Counters::Register(
+    "citra_cpu_jit_invalidations_total",
+    "Invalidations of JIT code, after which the affected blocks are compiled again");
+
 void ARM_Dynarmic::ClearInstructionCache() {
+    jit_invalidations.Add();
     // TODO: Clear interpreter cache when appropriate.
     for (const auto& j : jits) {
         j.second->ClearCache();
@@ -277,6 +283,7 @@ void ARM_Dynarmic::ClearInstructionCache() {
 }
 
 void ARM_Dynarmic::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    jit_invalidations.Add();
     jit->InvalidateCacheRange(start_address, length);
 }
 
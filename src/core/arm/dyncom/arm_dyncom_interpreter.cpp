@@ -8,6 +8,7 @@
 #include <cinttypes>
 #include <cstdio>
 #include "common/common_types.h"
+#include "common/counters.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "core/arm/dyncom/arm_dyncom_dec.h"
@@ -840,8 +841,12 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
     return inst_size;
 }
 
+static const Common::Counters::Counter blocks_translated = Common::Counters::Register(
+    "citra_cpu_blocks_translated_total", "Basic blocks decoded by the interpreter");
+
 static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u32 addr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
+    blocks_translated.Add();
 
     // Decode instruction, get index
     // Allocate memory and init InsCream
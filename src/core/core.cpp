@@ -2,11 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <memory>
 #include <utility>
 #include "audio_core/dsp_interface.h"
 #include "audio_core/hle/hle.h"
+#include "common/counters.h"
 #include "common/logging/log.h"
+#include "common/memory_snapshot.h"
 #include "core/arm/arm_interface.h"
 #ifdef ARCHITECTURE_x86_64
 #include "core/arm/dynarmic/arm_dynarmic.h"
@@ -15,22 +20,32 @@
 #include "core/cheats/cheats.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/file_sys/directory_backend.h"
+#include "core/file_sys/disk_archive.h"
+#include "core/file_sys/file_backend.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/hle/service/service.h"
 #include "core/hle/service/sm/sm.h"
+#include "core/hw/gpu.h"
 #include "core/hw/hw.h"
+#include "core/hw/lcd.h"
 #include "core/loader/loader.h"
 #include "core/movie.h"
 #ifdef ENABLE_SCRIPTING
 #include "core/rpc/rpc_server.h"
 #endif
+#include "core/savestate.h"
 #include "core/settings.h"
 #include "network/network.h"
+#include "video_core/pica_state.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
 namespace Core {
@@ -74,6 +89,7 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
     }
 
     if (GDBStub::IsServerEnabled()) {
+        GDBStub::ServeWatchpoint();
         GDBStub::SetCpuStepFlag(false);
     }
 
@@ -143,6 +159,14 @@ System::ResultStatus System::Load(EmuWindow& emu_window, const std::string& file
         }
     }
     memory->SetCurrentPageTable(&kernel->GetCurrentProcess()->vm_manager.page_table);
+
+    u64 title_id{0};
+    if (app_loader->ReadProgramId(title_id) == Loader::ResultStatus::Success) {
+        VideoCore::g_renderer->Rasterizer()->LoadDiskResources(title_id);
+    } else {
+        LOG_WARNING(Core, "Failed to read the title ID, disk resources are not loaded");
+    }
+
     cheat_engine = std::make_unique<Cheats::CheatEngine>(*this);
     status = ResultStatus::Success;
     m_emu_window = &emu_window;
@@ -155,6 +179,206 @@ void System::PrepareReschedule() {
     reschedule_pending = true;
 }
 
+namespace {
+
+void SaveCpuState(const ARM_Interface& cpu, StateWriter& writer) {
+    for (int i = 0; i < 16; ++i) {
+        writer.Write(cpu.GetReg(i));
+    }
+    for (int i = 0; i < 64; ++i) {
+        writer.Write(cpu.GetVFPReg(i));
+    }
+    writer.Write(cpu.GetCPSR());
+    writer.Write(cpu.GetVFPSystemReg(VFP_FPSCR));
+    writer.Write(cpu.GetVFPSystemReg(VFP_FPEXC));
+}
+
+bool LoadCpuState(ARM_Interface& cpu, StateReader& reader) {
+    std::array<u32, 16> regs;
+    std::array<u32, 64> vfp_regs;
+    u32 cpsr, fpscr, fpexc;
+    if (!reader.Read(regs) || !reader.Read(vfp_regs) || !reader.Read(cpsr) ||
+        !reader.Read(fpscr) || !reader.Read(fpexc)) {
+        return false;
+    }
+    for (int i = 0; i < 16; ++i) {
+        cpu.SetReg(i, regs[i]);
+    }
+    for (int i = 0; i < 64; ++i) {
+        cpu.SetVFPReg(i, vfp_regs[i]);
+    }
+    cpu.SetCPSR(cpsr);
+    cpu.SetVFPSystemReg(VFP_FPSCR, fpscr);
+    cpu.SetVFPSystemReg(VFP_FPEXC, fpexc);
+    return true;
+}
+
+} // Anonymous namespace
+
+bool System::SaveState(const std::string& path) {
+    u64 program_id = 0;
+    if (!IsPoweredOn() || app_loader->ReadProgramId(program_id) != Loader::ResultStatus::Success) {
+        LOG_ERROR(Core, "No program is running, not saving state");
+        return false;
+    }
+
+    // Only one state is written at a time, which also bounds the memory held by pending copies
+    if (save_state_result.valid()) {
+        save_state_result.wait();
+    }
+
+    // The kernel objects are reached from the kernel and from the registered services, whose
+    // handlers are written along with their sessions
+    Kernel::ObjectStateWriter object_writer(*kernel);
+    kernel->SaveState(object_writer);
+    service_manager->SaveState(object_writer);
+    archive_manager->SaveState(object_writer);
+    kernel->SaveMemoryState(object_writer);
+    auto kernel_state = object_writer.Finish();
+    if (!kernel_state) {
+        LOG_ERROR(Core, "The emulated system can't be saved right now, not saving state");
+        return false;
+    }
+
+    std::vector<SaveStateSection> sections;
+    const auto save_section = [&sections](std::string name, auto save) {
+        StateWriter writer;
+        save(writer);
+        sections.push_back({std::move(name), writer.TakeData()});
+    };
+    save_section("cpu", [this](StateWriter& writer) { SaveCpuState(*cpu_core, writer); });
+    save_section("dsp", [this](StateWriter& writer) {
+        const auto& dsp_memory = dsp_core->GetDspMemory();
+        writer.WriteBytes(dsp_memory.data(), dsp_memory.size());
+    });
+    save_section("timing", [this](StateWriter& writer) { timing->SaveState(writer); });
+    sections.push_back({"kernel", std::move(*kernel_state)});
+    save_section("gpu", [](StateWriter& writer) { Pica::g_state.SaveState(writer); });
+    save_section("hw", [](StateWriter& writer) {
+        writer.WriteBytes(&GPU::g_regs, sizeof(GPU::g_regs));
+        writer.WriteBytes(&LCD::g_regs, sizeof(LCD::g_regs));
+    });
+
+    // The memory is only write-protected here, and copied by the writer before it compresses it
+    auto memory_snapshots = memory->SaveState();
+
+    save_state_result = std::async(std::launch::async, [path, program_id,
+                                                        sections = std::move(sections),
+                                                        snapshots = std::move(memory_snapshots)] {
+        std::vector<SaveStateBlock> blocks;
+        for (std::size_t i = 0; i < snapshots.size(); ++i) {
+            blocks.push_back({Memory::MemorySystem::StateSectionNames[i], snapshots[i]->Finish(),
+                              snapshots[i]->GetSize()});
+        }
+        if (!WriteSaveState(path, program_id, sections, blocks)) {
+            return false;
+        }
+        LOG_INFO(Core, "Saved state to {}", path);
+        return true;
+    });
+    return true;
+}
+
+bool System::LoadState(const std::string& path) {
+    u64 program_id = 0;
+    if (!IsPoweredOn() || app_loader->ReadProgramId(program_id) != Loader::ResultStatus::Success) {
+        LOG_ERROR(Core, "No program is running, not loading state");
+        return false;
+    }
+
+    // The state may still be being written
+    if (save_state_result.valid()) {
+        save_state_result.wait();
+    }
+
+    const auto sections = ReadSaveState(path, program_id);
+    if (!sections) {
+        return false;
+    }
+
+    const auto find_section = [&sections](const std::string& name) -> const std::vector<u8>* {
+        const auto it = std::find_if(sections->begin(), sections->end(),
+                                     [&name](const auto& section) { return section.name == name; });
+        return it == sections->end() ? nullptr : &it->data;
+    };
+    const auto* cpu_data = find_section("cpu");
+    std::array<const std::vector<u8>*, 3> memory_data;
+    for (std::size_t i = 0; i < memory_data.size(); ++i) {
+        memory_data[i] = find_section(Memory::MemorySystem::StateSectionNames[i]);
+    }
+    const auto* dsp_data = find_section("dsp");
+    const auto* timing_data = find_section("timing");
+    const auto* gpu_data = find_section("gpu");
+    const auto* hw_data = find_section("hw");
+    const auto* kernel_data = find_section("kernel");
+    auto& dsp_memory = dsp_core->GetDspMemory();
+    if (!cpu_data ||
+        std::find(memory_data.begin(), memory_data.end(), nullptr) != memory_data.end() ||
+        !dsp_data || !timing_data || !gpu_data || !hw_data || !kernel_data ||
+        dsp_data->size() != dsp_memory.size() ||
+        hw_data->size() != sizeof(GPU::g_regs) + sizeof(LCD::g_regs)) {
+        LOG_ERROR(Core, "Save state {} is incomplete", path);
+        return false;
+    }
+
+    // The timer is checked first as it can be rejected for referring to events this build does not
+    // know, which leaves the running state alone
+    StateReader timing_check_reader(*timing_data);
+    if (!timing->LoadState(timing_check_reader)) {
+        LOG_ERROR(Core, "Save state {} has an invalid timer state", path);
+        return false;
+    }
+
+    // The handlers of the services are the running ones, given the state saved with them. Files
+    // and directories are opened again by the blank handlers they load into.
+    const auto handler_factory =
+        [this](const std::string& key) -> std::shared_ptr<Kernel::SessionRequestHandler> {
+        if (key == "FS::File") {
+            return std::make_shared<Service::FS::File>(*this, nullptr, FileSys::Path());
+        }
+        if (key == "FS::Directory") {
+            return std::make_shared<Service::FS::Directory>(*this, nullptr, FileSys::Path());
+        }
+        if (const auto it = kernel->named_ports.find(key); it != kernel->named_ports.end()) {
+            const auto server_port = it->second->GetServerPort();
+            return server_port != nullptr ? server_port->hle_handler : nullptr;
+        }
+        return service_manager->GetService<Kernel::SessionRequestHandler>(key);
+    };
+
+    // Once the objects are loaded, the running ones die as the roots are replaced. From there on a
+    // failure leaves the emulated system corrupted, so it is reset.
+    Kernel::ObjectStateReader object_reader(*kernel_data, *kernel, handler_factory);
+    // The threads and timers that die unschedule their events, so the timer is loaded again after
+    StateReader timing_reader(*timing_data);
+    StateReader gpu_reader(*gpu_data);
+    StateReader hw_reader(*hw_data);
+    StateReader cpu_reader(*cpu_data);
+    if (!object_reader.LoadObjects() || !kernel->LoadState(object_reader) ||
+        !service_manager->LoadState(object_reader) || !archive_manager->LoadState(object_reader) ||
+        !kernel->LoadMemoryState(object_reader) || !object_reader.AtEnd() ||
+        !timing->LoadState(timing_reader) || !memory->LoadState(memory_data) ||
+        !Pica::g_state.LoadState(gpu_reader) ||
+        !hw_reader.ReadBytes(&GPU::g_regs, sizeof(GPU::g_regs)) ||
+        !hw_reader.ReadBytes(&LCD::g_regs, sizeof(LCD::g_regs)) ||
+        !LoadCpuState(*cpu_core, cpu_reader)) {
+        LOG_CRITICAL(Core, "Save state {} is malformed, resetting the emulated system", path);
+        RequestReset();
+        return false;
+    }
+    std::copy(dsp_data->begin(), dsp_data->end(), dsp_memory.begin());
+
+    memory->SetCurrentPageTable(&kernel->GetCurrentProcess()->vm_manager.page_table);
+    if (const Kernel::Thread* thread = kernel->GetThreadManager().GetCurrentThread()) {
+        cpu_core->SetCP15Register(CP15_THREAD_URO, thread->GetTLSAddress());
+    }
+    // The code in memory changed
+    cpu_core->ClearInstructionCache();
+
+    LOG_INFO(Core, "Loaded state from {}", path);
+    return true;
+}
+
 PerfStats::Results System::GetAndResetPerfStats() {
     return perf_stats.GetAndResetStats(timing->GetGlobalTimeUs());
 }
@@ -210,6 +434,12 @@ System::ResultStatus System::Init(EmuWindow& emu_window, u32 system_mode) {
         return result;
     }
 
+    if (!Settings::values.counters_dump_path.empty()) {
+        counters_dumper = std::make_unique<Common::Counters::PeriodicDumper>(
+            Settings::values.counters_dump_path,
+            std::chrono::seconds(std::max<u32>(Settings::values.counters_dump_interval, 1)));
+    }
+
     LOG_DEBUG(Core, "Initialized OK");
 
     // Reset counters and set time origin to current frame
@@ -267,6 +497,12 @@ const Cheats::CheatEngine& System::CheatEngine() const {
     return *cheat_engine;
 }
 
+#ifdef ENABLE_SCRIPTING
+RPC::RPCServer& System::RPCServer() {
+    return *rpc_server;
+}
+#endif
+
 void System::RegisterSoftwareKeyboard(std::shared_ptr<Frontend::SoftwareKeyboard> swkbd) {
     registered_swkbd = std::move(swkbd);
 }
@@ -282,6 +518,10 @@ void System::Shutdown() {
                          perf_results.frametime * 1000.0);
 
     // Shutdown emulation session
+    if (save_state_result.valid()) {
+        save_state_result.wait();
+    }
+    counters_dumper.reset();
     GDBStub::Shutdown();
     VideoCore::Shutdown();
     kernel.reset();
@@ -292,6 +532,8 @@ void System::Shutdown() {
 #endif
     cheat_engine.reset();
     service_manager.reset();
+    // The files closed above are committed in the background, have them on the host by now
+    FileSys::CommitClosedDiskFiles();
     dsp_core.reset();
     cpu_core.reset();
     timing.reset();
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 #include <string>
 #include "common/common_types.h"
@@ -16,6 +17,10 @@
 class EmuWindow;
 class ARM_Interface;
 
+namespace Common::Counters {
+class PeriodicDumper;
+}
+
 namespace Memory {
 class MemorySystem;
 }
@@ -141,6 +146,27 @@ public:
         return *telemetry_session;
     }
 
+    /**
+     * Saves the state of the emulated system: the CPU registers, the memory, the DSP memory, the
+     * timer with its queued events, the GPU and LCD registers, the kernel objects and the state of
+     * the HLE services. The state is captured on the calling thread, which must be the emulation
+     * thread between two runs of the CPU loop; the memory is copied as it gets written or by a
+     * background thread, which also compresses and writes the state.
+     * @returns False if no program is running, or if something that can't be saved is in use, such
+     *          as a host socket or a thread paused by an HLE service
+     */
+    bool SaveState(const std::string& path);
+
+    /**
+     * Loads a state saved by SaveState into the running program, which must be the one the state
+     * was saved with. Must be called from the emulation thread between two runs of the CPU loop.
+     * The kernel objects are created anew, and the HLE services that are running take the state
+     * saved with them.
+     * @returns False if the state could not be read or belongs to another program. A state that
+     *          turns out to be malformed while it is being loaded also requests a reset.
+     */
+    bool LoadState(const std::string& path);
+
     /// Prepare the core emulation for a reschedule
     void PrepareReschedule();
 
@@ -204,6 +230,11 @@ public:
     /// Gets a const reference to the cheat engine
     const Cheats::CheatEngine& CheatEngine() const;
 
+#ifdef ENABLE_SCRIPTING
+    /// Gets a reference to the RPC server
+    RPC::RPCServer& RPCServer();
+#endif
+
     PerfStats perf_stats;
     FrameLimiter frame_limiter;
 
@@ -274,6 +305,12 @@ private:
 
     std::unique_ptr<Service::FS::ArchiveManager> archive_manager;
 
+    /// Result of the save state being written in the background
+    std::future<bool> save_state_result;
+
+    /// Writes the hot-path counters to a file while emulation runs, if enabled
+    std::unique_ptr<Common::Counters::PeriodicDumper> counters_dumper;
+
 public: // HACK: this is temporary exposed for tests,
         // due to WIP kernel refactor causing desync state in memory
     std::unique_ptr<Memory::MemorySystem> memory;
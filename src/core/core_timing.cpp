@@ -8,6 +8,7 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core_timing.h"
+#include "core/savestate.h"
 
 namespace Core {
 
@@ -156,4 +157,69 @@ s64 Timing::GetDowncount() const {
     return downcount;
 }
 
+void Timing::SaveState(StateWriter& writer) {
+    MoveEvents();
+
+    writer.Write(global_timer);
+    writer.Write(slice_length);
+    writer.Write(downcount);
+    writer.Write(idled_cycles);
+    writer.Write(event_fifo_id);
+    writer.Write(is_global_timer_sane);
+    // The queue is stored in heap order, so it does not need to be sorted again when loading
+    writer.Write(static_cast<u32>(event_queue.size()));
+    for (const Event& event : event_queue) {
+        writer.Write(event.time);
+        writer.Write(event.fifo_order);
+        writer.Write(event.userdata);
+        writer.WriteString(*event.type->name);
+    }
+}
+
+bool Timing::LoadState(StateReader& reader) {
+    s64 new_global_timer, new_slice_length, new_downcount, new_idled_cycles;
+    u64 new_event_fifo_id;
+    bool new_is_global_timer_sane;
+    u32 event_count;
+    if (!reader.Read(new_global_timer) || !reader.Read(new_slice_length) ||
+        !reader.Read(new_downcount) || !reader.Read(new_idled_cycles) ||
+        !reader.Read(new_event_fifo_id) || !reader.Read(new_is_global_timer_sane) ||
+        !reader.Read(event_count)) {
+        return false;
+    }
+
+    std::vector<Event> new_event_queue;
+    for (u32 i = 0; i < event_count; ++i) {
+        Event event;
+        std::string name;
+        if (!reader.Read(event.time) || !reader.Read(event.fifo_order) ||
+            !reader.Read(event.userdata) || !reader.ReadString(name)) {
+            return false;
+        }
+        const auto it = event_types.find(name);
+        if (it == event_types.end()) {
+            LOG_ERROR(Core_Timing, "Unknown event type {} in save state", name);
+            return false;
+        }
+        event.type = &it->second;
+        new_event_queue.push_back(event);
+    }
+    if (!std::is_heap(new_event_queue.begin(), new_event_queue.end(), std::greater<>())) {
+        return false;
+    }
+
+    // Drop the events other threads scheduled for the replaced state
+    for (Event event; ts_queue.Pop(event);) {
+    }
+
+    global_timer = new_global_timer;
+    slice_length = new_slice_length;
+    downcount = new_downcount;
+    idled_cycles = new_idled_cycles;
+    event_fifo_id = new_event_fifo_id;
+    is_global_timer_sane = new_is_global_timer_sane;
+    event_queue = std::move(new_event_queue);
+    return true;
+}
+
 } // namespace Core
@@ -125,6 +125,9 @@ inline u64 cyclesToMs(s64 cycles) {
 
 namespace Core {
 
+class StateReader;
+class StateWriter;
+
 using TimedCallback = std::function<void(u64 userdata, int cycles_late)>;
 
 struct TimingEventType {
@@ -189,6 +192,17 @@ public:
 
     s64 GetDowncount() const;
 
+    /// Saves the timer and the queued events, which are stored by the name of their type
+    void SaveState(StateWriter& writer);
+
+    /**
+     * Restores the state saved by SaveState. The event types of the saved events must be
+     * registered already.
+     * @returns False, leaving the events untouched, if the data is malformed or refers to an
+     *          unknown event type
+     */
+    bool LoadState(StateReader& reader);
+
 private:
     struct Event {
         s64 time;
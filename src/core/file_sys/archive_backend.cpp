@@ -9,6 +9,7 @@
 #include "common/string_util.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/memory.h"
+#include "core/savestate.h"
 
 namespace FileSys {
 
@@ -118,4 +119,21 @@ std::vector<u8> Path::AsBinary() const {
         return {};
     }
 }
+
+void Path::SaveState(Core::StateWriter& writer) const {
+    writer.Write(type);
+    writer.WriteVector(binary);
+    writer.WriteString(string);
+    writer.WriteVector(std::vector<char16_t>(u16str.begin(), u16str.end()));
+}
+
+bool Path::LoadState(Core::StateReader& reader) {
+    std::vector<char16_t> u16_chars;
+    if (!reader.Read(type) || !reader.ReadVector(binary) || !reader.ReadString(string) ||
+        !reader.ReadVector(u16_chars)) {
+        return false;
+    }
+    u16str.assign(u16_chars.begin(), u16_chars.end());
+    return true;
+}
 } // namespace FileSys
@@ -13,6 +13,11 @@
 #include "common/swap.h"
 #include "core/hle/result.h"
 
+namespace Core {
+class StateReader;
+class StateWriter;
+} // namespace Core
+
 namespace FileSys {
 
 class FileBackend;
@@ -55,6 +60,9 @@ public:
     std::u16string AsU16Str() const;
     std::vector<u8> AsBinary() const;
 
+    void SaveState(Core::StateWriter& writer) const;
+    bool LoadState(Core::StateReader& reader);
+
 private:
     LowPathType type;
     std::vector<u8> binary;
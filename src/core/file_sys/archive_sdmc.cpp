@@ -97,7 +97,7 @@ ResultVal<std::unique_ptr<FileBackend>> SDMCArchive::OpenFileBase(const Path& pa
     }
 
     std::unique_ptr<DelayGenerator> delay_generator = std::make_unique<SDMCDelayGenerator>();
-    auto disk_file = std::make_unique<DiskFile>(std::move(file), mode, std::move(delay_generator));
+    auto disk_file = OpenDiskFile(std::move(file), full_path, mode, std::move(delay_generator));
     return MakeResult<std::unique_ptr<FileBackend>>(std::move(disk_file));
 }
 
@@ -127,7 +127,7 @@ ResultCode SDMCArchive::DeleteFile(const Path& path) const {
         break; // Expected 'success' case
     }
 
-    if (FileUtil::Delete(full_path)) {
+    if (DeleteDiskFile(full_path)) {
         return RESULT_SUCCESS;
     }
 
@@ -154,7 +154,7 @@ ResultCode SDMCArchive::RenameFile(const Path& src_path, const Path& dest_path)
     const auto src_path_full = path_parser_src.BuildHostPath(mount_point);
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
-    if (FileUtil::Rename(src_path_full, dest_path_full)) {
+    if (RenameDiskPath(src_path_full, dest_path_full)) {
         return RESULT_SUCCESS;
     }
 
@@ -208,8 +208,7 @@ ResultCode SDMCArchive::DeleteDirectory(const Path& path) const {
 }
 
 ResultCode SDMCArchive::DeleteDirectoryRecursively(const Path& path) const {
-    return DeleteDirectoryHelper(
-        path, mount_point, [](const std::string& p) { return FileUtil::DeleteDirRecursively(p); });
+    return DeleteDirectoryHelper(path, mount_point, DeleteDiskDirectoryRecursively);
 }
 
 ResultCode SDMCArchive::CreateFile(const FileSys::Path& path, u64 size) const {
@@ -311,7 +310,7 @@ ResultCode SDMCArchive::RenameDirectory(const Path& src_path, const Path& dest_p
     const auto src_path_full = path_parser_src.BuildHostPath(mount_point);
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
-    if (FileUtil::Rename(src_path_full, dest_path_full)) {
+    if (RenameDiskPath(src_path_full, dest_path_full)) {
         return RESULT_SUCCESS;
     }
 
@@ -3,13 +3,23 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <fmt/format.h>
+#include "common/common_paths.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "core/file_sys/disk_archive.h"
 #include "core/file_sys/errors.h"
+#include "core/settings.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // FileSys namespace
@@ -53,6 +63,444 @@ bool DiskFile::Close() const {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/// Files larger than this are always written through, they would take too much memory otherwise.
+/// Buffered files growing past it switch to writing through.
+constexpr u64 MaxBufferedFileSize = 16 * 1024 * 1024;
+/// How often the background thread commits the buffers the guest asked to flush.
+constexpr std::chrono::milliseconds CommitInterval{500};
+
+/**
+ * Returns the host file the content of the given file is staged in before it replaces it. Staging
+ * files live in a host directory outside of every archive, so the guest can neither see nor name
+ * them. The name only depends on the path, a staging file left behind by a crash is reused.
+ */
+static std::string GetStagingPath(const std::string& path) {
+    return fmt::format("{}staging" DIR_SEP "{:016X}",
+                       FileUtil::GetUserPath(FileUtil::UserPath::UserDir),
+                       std::hash<std::string>{}(path));
+}
+
+struct WriteBackBuffer {
+    explicit WriteBackBuffer(std::string path) : path(std::move(path)) {}
+
+    /// Writes the buffer to the host file if it changed since the last commit.
+    bool Commit() {
+        std::lock_guard commit_lock(commit_mutex);
+        return CommitLocked();
+    }
+
+    /// Commit with commit_mutex already held
+    bool CommitLocked();
+
+    /**
+     * Writes the buffer to the host file and switches to writing through to it, for files growing
+     * past MaxBufferedFileSize. Handles sharing the buffer switch with it.
+     * @returns false if the host file couldn't be written, or was deleted
+     */
+    bool Spill();
+
+    std::mutex data_mutex; ///< Guards data, generation, commit_requested and direct
+    std::vector<u8> data;
+    /// Host file that reads and writes go to once the buffer was spilled, data is empty then
+    std::unique_ptr<FileUtil::IOFile> direct;
+    u64 generation = 0; ///< Incremented on every modification of data
+    bool commit_requested = false;
+
+    std::mutex commit_mutex; ///< Serializes commits, guards the members below
+    std::string path;        ///< Host file, changed when the file is renamed
+    u64 committed_generation = 0;
+    /// Set when the host file was deleted. Handles that are still open keep the data in memory.
+    bool detached = false;
+};
+
+/// Writes and syncs a whole host file
+static bool WriteHostFile(const std::string& path, const std::vector<u8>& content) {
+    FileUtil::IOFile file(path, "wb");
+    return file.IsOpen() && file.WriteBytes(content.data(), content.size()) == content.size() &&
+           file.Sync();
+}
+
+bool WriteBackBuffer::CommitLocked() {
+    if (detached)
+        return true;
+
+    // Work on a snapshot so that guest writes aren't blocked while the host file is written
+    std::vector<u8> snapshot;
+    u64 snapshot_generation;
+    {
+        std::lock_guard lock(data_mutex);
+        commit_requested = false;
+        if (direct || generation == committed_generation)
+            return true;
+        snapshot = data;
+        snapshot_generation = generation;
+    }
+
+    // Write the whole file to a staging file and swap it in, so that the host file is always
+    // either the previous or the new version even if citra crashes half-way
+    const std::string staging_path = GetStagingPath(path);
+    if (!FileUtil::CreateFullPath(staging_path) || !WriteHostFile(staging_path, snapshot)) {
+        LOG_ERROR(Service_FS, "Failed to write {}", staging_path);
+        return false;
+    }
+
+    if (!FileUtil::Replace(staging_path, path)) {
+        // The archive may be on another file system than the staging directory, fall back to
+        // writing in place
+        FileUtil::Delete(staging_path);
+        if (!WriteHostFile(path, snapshot)) {
+            LOG_ERROR(Service_FS, "Failed to commit {}", path);
+            return false;
+        }
+    }
+
+    committed_generation = snapshot_generation;
+    return true;
+}
+
+bool WriteBackBuffer::Spill() {
+    std::lock_guard commit_lock(commit_mutex);
+    std::lock_guard lock(data_mutex);
+    if (direct)
+        return true;
+    if (detached)
+        return false;
+
+    // Written in place rather than through a staging file, as plain DiskFiles are
+    auto file = std::make_unique<FileUtil::IOFile>(path, "r+b");
+    if (!file->IsOpen() || !file->Resize(data.size()) ||
+        file->WriteBytes(data.data(), data.size()) != data.size() || !file->Flush()) {
+        LOG_ERROR(Service_FS, "Failed to write {}", path);
+        return false;
+    }
+
+    LOG_DEBUG(Service_FS, "{} outgrew the write-back buffer, writing through", path);
+    direct = std::move(file);
+    data.clear();
+    data.shrink_to_fit();
+    committed_generation = generation;
+    return true;
+}
+
+namespace {
+
+/// Checks whether path is the given file or directory, or a file inside the directory.
+bool IsAtOrUnder(const std::string& path, const std::string& base) {
+    return path.compare(0, base.size(), base) == 0 &&
+           (path.size() == base.size() || path[base.size()] == '/');
+}
+
+/// Keeps track of the open write-back buffers and commits them periodically.
+class WriteBackWorker {
+public:
+    ~WriteBackWorker() {
+        {
+            std::lock_guard lock(mutex);
+            stop = true;
+        }
+        cv.notify_one();
+        if (thread.joinable())
+            thread.join();
+        for (const auto& buffer : closed)
+            buffer->Commit();
+    }
+
+    static WriteBackWorker& Instance() {
+        static WriteBackWorker instance;
+        return instance;
+    }
+
+    /// Returns the live buffer of the given file, if any.
+    std::shared_ptr<WriteBackBuffer> Find(const std::string& path) {
+        std::lock_guard lock(mutex);
+        auto itr = buffers.find(path);
+        return itr != buffers.end() ? itr->second.lock() : nullptr;
+    }
+
+    /// Returns the buffer of the given file, creating it from the host file if needed.
+    std::shared_ptr<WriteBackBuffer> Acquire(const std::string& path, FileUtil::IOFile& file) {
+        if (auto existing = Find(path))
+            return existing;
+
+        // The file is read without holding the lock, which the background thread needs
+        auto buffer = std::make_shared<WriteBackBuffer>(path);
+        buffer->data.resize(file.GetSize());
+        file.Seek(0, SEEK_SET);
+        if (file.ReadBytes(buffer->data.data(), buffer->data.size()) != buffer->data.size())
+            return nullptr;
+
+        std::lock_guard lock(mutex);
+        auto& entry = buffers[path];
+        if (auto existing = entry.lock())
+            return existing;
+        entry = buffer;
+        if (!thread.joinable())
+            thread = std::thread(&WriteBackWorker::Run, this);
+        return buffer;
+    }
+
+    /// Stops tracking the live buffers of the given file, or of the files in the given directory.
+    std::vector<std::shared_ptr<WriteBackBuffer>> Take(const std::string& path) {
+        std::vector<std::shared_ptr<WriteBackBuffer>> taken;
+        std::lock_guard lock(mutex);
+        for (auto itr = buffers.begin(); itr != buffers.end();) {
+            if (!IsAtOrUnder(itr->first, path)) {
+                ++itr;
+                continue;
+            }
+            if (auto buffer = itr->second.lock())
+                taken.push_back(std::move(buffer));
+            itr = buffers.erase(itr);
+        }
+        return taken;
+    }
+
+    /// Tracks a buffer taken by Take again, under its current path.
+    void Return(const std::shared_ptr<WriteBackBuffer>& buffer, const std::string& path) {
+        std::lock_guard lock(mutex);
+        buffers[path] = buffer;
+    }
+
+    /// Commits the buffer of a closed file on the background thread, keeping it alive until then.
+    void CommitClosed(std::shared_ptr<WriteBackBuffer> buffer) {
+        {
+            std::lock_guard lock(mutex);
+            closed.push_back(std::move(buffer));
+        }
+        cv.notify_one();
+    }
+
+    /// Commits the buffers of all closed files, including those the background thread is at.
+    void CommitAllClosed() {
+        std::vector<std::shared_ptr<WriteBackBuffer>> pending;
+        {
+            std::lock_guard lock(mutex);
+            pending.swap(closed);
+        }
+        for (const auto& buffer : pending)
+            buffer->Commit();
+        // Wait for the ones the background thread took before
+        std::lock_guard batch_lock(batch_mutex);
+    }
+
+private:
+    void Run() {
+        std::unique_lock lock(mutex);
+        while (!stop) {
+            cv.wait_for(lock, CommitInterval, [this] { return stop || !closed.empty(); });
+
+            std::vector<std::shared_ptr<WriteBackBuffer>> pending;
+            pending.swap(closed);
+            const std::size_t closed_count = pending.size();
+            for (auto itr = buffers.begin(); itr != buffers.end();) {
+                auto buffer = itr->second.lock();
+                if (!buffer) {
+                    itr = buffers.erase(itr);
+                    continue;
+                }
+                pending.push_back(std::move(buffer));
+                ++itr;
+            }
+
+            // Taken before the lock is released, so that CommitAllClosed can wait for the batch
+            std::unique_lock batch_lock(batch_mutex);
+            lock.unlock();
+            for (std::size_t i = 0; i < pending.size(); ++i) {
+                bool requested = i < closed_count;
+                if (!requested) {
+                    std::lock_guard buffer_lock(pending[i]->data_mutex);
+                    requested = pending[i]->commit_requested;
+                }
+                if (requested)
+                    pending[i]->Commit();
+            }
+            pending.clear();
+            batch_lock.unlock();
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stop = false;
+    std::unordered_map<std::string, std::weak_ptr<WriteBackBuffer>> buffers;
+    /// Buffers of closed files waiting for their commit
+    std::vector<std::shared_ptr<WriteBackBuffer>> closed;
+    std::mutex batch_mutex; ///< Held by the background thread while it commits
+    std::thread thread;
+};
+
+/// Drops the buffers of the given file or of the files in the given directory, which is replaced
+/// or deleted.
+void DetachBuffers(const std::string& path) {
+    for (const auto& buffer : WriteBackWorker::Instance().Take(path)) {
+        std::lock_guard commit_lock(buffer->commit_mutex);
+        buffer->detached = true;
+    }
+}
+
+} // Anonymous namespace
+
+BufferedDiskFile::BufferedDiskFile(std::shared_ptr<WriteBackBuffer> buffer_, const Mode& mode_,
+                                   std::unique_ptr<DelayGenerator> delay_generator_)
+    : buffer(std::move(buffer_)) {
+    delay_generator = std::move(delay_generator_);
+    mode.hex = mode_.hex;
+}
+
+BufferedDiskFile::~BufferedDiskFile() {
+    Close();
+}
+
+ResultVal<std::size_t> BufferedDiskFile::Read(const u64 offset, const std::size_t length,
+                                              u8* data) const {
+    if (!mode.read_flag)
+        return ERROR_INVALID_OPEN_FLAGS;
+
+    std::lock_guard lock(buffer->data_mutex);
+    if (buffer->direct) {
+        buffer->direct->Seek(offset, SEEK_SET);
+        return MakeResult<std::size_t>(buffer->direct->ReadBytes(data, length));
+    }
+    if (offset >= buffer->data.size())
+        return MakeResult<std::size_t>(0);
+
+    const std::size_t read_length =
+        static_cast<std::size_t>(std::min<u64>(length, buffer->data.size() - offset));
+    std::memcpy(data, buffer->data.data() + offset, read_length);
+    return MakeResult<std::size_t>(read_length);
+}
+
+ResultVal<std::size_t> BufferedDiskFile::Write(const u64 offset, const std::size_t length,
+                                               const bool flush, const u8* data) {
+    if (!mode.write_flag)
+        return ERROR_INVALID_OPEN_FLAGS;
+
+    std::unique_lock lock(buffer->data_mutex);
+    const bool too_large = offset > MaxBufferedFileSize || length > MaxBufferedFileSize - offset;
+    if (!buffer->direct && too_large) {
+        lock.unlock();
+        if (!buffer->Spill())
+            return ERROR_INSUFFICIENT_SPACE;
+        lock.lock();
+    }
+    if (buffer->direct) {
+        buffer->direct->Seek(offset, SEEK_SET);
+        const std::size_t written = buffer->direct->WriteBytes(data, length);
+        if (flush)
+            buffer->direct->Flush();
+        return MakeResult<std::size_t>(written);
+    }
+
+    if (offset + length > buffer->data.size())
+        buffer->data.resize(offset + length);
+    std::memcpy(buffer->data.data() + offset, data, length);
+    ++buffer->generation;
+    if (flush)
+        buffer->commit_requested = true;
+    return MakeResult<std::size_t>(length);
+}
+
+u64 BufferedDiskFile::GetSize() const {
+    std::lock_guard lock(buffer->data_mutex);
+    return buffer->direct ? buffer->direct->GetSize() : buffer->data.size();
+}
+
+bool BufferedDiskFile::SetSize(const u64 size) const {
+    std::unique_lock lock(buffer->data_mutex);
+    if (!buffer->direct && size > MaxBufferedFileSize) {
+        lock.unlock();
+        if (!buffer->Spill())
+            return false;
+        lock.lock();
+    }
+    if (buffer->direct) {
+        buffer->direct->Resize(size);
+        buffer->direct->Flush();
+        return true;
+    }
+
+    buffer->data.resize(size);
+    ++buffer->generation;
+    buffer->commit_requested = true;
+    return true;
+}
+
+bool BufferedDiskFile::Close() const {
+    // Committing writes the whole file, which is left to the background thread
+    WriteBackWorker::Instance().CommitClosed(buffer);
+    return true;
+}
+
+void BufferedDiskFile::Flush() const {
+    std::lock_guard lock(buffer->data_mutex);
+    if (buffer->direct) {
+        buffer->direct->Flush();
+        return;
+    }
+    buffer->commit_requested = true;
+}
+
+std::unique_ptr<FileBackend> OpenDiskFile(FileUtil::IOFile&& file, const std::string& path,
+                                          const Mode& mode,
+                                          std::unique_ptr<DelayGenerator> delay_generator) {
+    if (Settings::values.use_buffered_save_writes) {
+        auto& worker = WriteBackWorker::Instance();
+        // Every open of a buffered file must see its pending writes, even read-only ones. Read-only
+        // opens get a buffer too, as the file may be opened for writing while they are still open.
+        std::shared_ptr<WriteBackBuffer> buffer = worker.Find(path);
+        if (!buffer && file.GetSize() <= MaxBufferedFileSize)
+            buffer = worker.Acquire(path, file);
+
+        if (buffer) {
+            file.Close();
+            return std::make_unique<BufferedDiskFile>(std::move(buffer), mode,
+                                                      std::move(delay_generator));
+        }
+    }
+
+    return std::make_unique<DiskFile>(std::move(file), mode, std::move(delay_generator));
+}
+
+void CommitClosedDiskFiles() {
+    WriteBackWorker::Instance().CommitAllClosed();
+}
+
+bool DeleteDiskFile(const std::string& path) {
+    DetachBuffers(path);
+    return FileUtil::Delete(path);
+}
+
+bool DeleteDiskDirectoryRecursively(const std::string& path) {
+    DetachBuffers(path);
+    return FileUtil::DeleteDirRecursively(path);
+}
+
+bool RenameDiskPath(const std::string& src_path, const std::string& dest_path) {
+    auto& worker = WriteBackWorker::Instance();
+    const auto buffers = worker.Take(src_path);
+
+    // Commit the pending writes under the old name, and keep the buffers from committing again
+    // until they know the new one
+    std::vector<std::unique_lock<std::mutex>> commit_locks;
+    for (const auto& buffer : buffers) {
+        commit_locks.emplace_back(buffer->commit_mutex);
+        buffer->CommitLocked();
+    }
+
+    const bool renamed = FileUtil::Rename(src_path, dest_path);
+    if (renamed)
+        DetachBuffers(dest_path);
+    for (const auto& buffer : buffers) {
+        if (renamed)
+            buffer->path = dest_path + buffer->path.substr(src_path.size());
+        worker.Return(buffer, buffer->path);
+    }
+    return renamed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 DiskDirectory::DiskDirectory(const std::string& path) {
     unsigned size = FileUtil::ScanDirectoryTree(path, directory);
     directory.size = size;
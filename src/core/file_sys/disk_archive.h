@@ -45,6 +45,66 @@ protected:
     std::unique_ptr<FileUtil::IOFile> file;
 };
 
+struct WriteBackBuffer;
+
+/**
+ * Write-back variant of DiskFile. The whole file is kept in memory while it is open and guest
+ * writes only modify that copy. A background thread commits the content to the host, by writing a
+ * staging file outside of the archive and renaming it over the original, once the file was closed
+ * and in batches after the guest requested a flush. Files opened more than once share the same
+ * buffer. Archives must delete and rename their files with the functions below, which keep the
+ * buffers in sync. Files growing too large for the buffer are written to the host and written
+ * through from then on.
+ */
+class BufferedDiskFile : public FileBackend {
+public:
+    BufferedDiskFile(std::shared_ptr<WriteBackBuffer> buffer_, const Mode& mode_,
+                     std::unique_ptr<DelayGenerator> delay_generator_);
+    ~BufferedDiskFile() override;
+
+    ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const override;
+    ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
+                                 const u8* buffer) override;
+    u64 GetSize() const override;
+    bool SetSize(u64 size) const override;
+    bool Close() const override;
+    void Flush() const override;
+
+private:
+    Mode mode;
+    std::shared_ptr<WriteBackBuffer> buffer;
+};
+
+/**
+ * Creates the backend of a host file opened by a disk-backed archive. Depending on the settings and
+ * the file size, the returned file is either a plain DiskFile or a BufferedDiskFile.
+ * @param file The opened host file
+ * @param path Path of the host file, used to commit buffered writes
+ * @param mode Mode the file was opened with
+ * @param delay_generator Delay generator of the archive
+ */
+std::unique_ptr<FileBackend> OpenDiskFile(FileUtil::IOFile&& file, const std::string& path,
+                                          const Mode& mode,
+                                          std::unique_ptr<DelayGenerator> delay_generator);
+
+/// Waits until the buffered writes of all closed files are committed to the host.
+void CommitClosedDiskFiles();
+
+/**
+ * Deletes a host file of a disk-backed archive. Its buffered writes are dropped, open handles keep
+ * them in memory without recreating the file.
+ */
+bool DeleteDiskFile(const std::string& path);
+
+/// Deletes a host directory of a disk-backed archive, dropping the buffered writes of its files.
+bool DeleteDiskDirectoryRecursively(const std::string& path);
+
+/**
+ * Renames a host file or directory of a disk-backed archive. The buffered writes of the file, or
+ * of the files in the directory, are committed first, and later ones go to the new path.
+ */
+bool RenameDiskPath(const std::string& src_path, const std::string& dest_path);
+
 class DiskDirectory : public DirectoryBackend {
 public:
     explicit DiskDirectory(const std::string& path);
@@ -206,6 +206,7 @@ Loader::ResultStatus NCCHContainer::Load() {
                 secondary_key.fill(0);
             } else {
                 using namespace HW::AES;
+                const auto key_lock = LockKeySlots();
                 InitKeys();
                 std::array<u8, 16> key_y_primary, key_y_secondary;
 
@@ -371,6 +372,16 @@ Loader::ResultStatus NCCHContainer::Load() {
             has_exheader = true;
         }
 
+        // Unencrypted images can be served straight from a memory mapping of the file
+        if (!is_encrypted) {
+            auto mapping = std::make_shared<FileUtil::MappedFile>(filepath);
+            if (mapping->IsOpen()) {
+                mapped_file = std::move(mapping);
+            } else {
+                LOG_DEBUG(Service_FS, "Could not map {}, falling back to buffered reads", filepath);
+            }
+        }
+
         // DLC can have an ExeFS and a RomFS but no extended header
         if (ncch_header.exefs_size) {
             exefs_offset = ncch_header.exefs_offset * kBlockSize;
@@ -426,6 +437,7 @@ Loader::ResultStatus NCCHContainer::LoadOverrides() {
             exefs_offset = 0;
             is_tainted = true;
             has_exefs = true;
+            has_exefs_override = true;
         } else {
             exefs_file = FileUtil::IOFile(filepath, "rb");
         }
@@ -500,27 +512,42 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                                                               exefs_ctr.data());
             dec.Seek(section.offset + sizeof(ExeFs_Header));
 
+            // Sections of a mapped (thus unencrypted) image are used in place
+            const u8* mapped_section = nullptr;
+            if (mapped_file && !has_exefs_override) {
+                if (section_offset + section.size > mapped_file->GetSize())
+                    return Loader::ResultStatus::Error;
+                mapped_section = mapped_file->Data() + section_offset;
+            }
+
             if (strcmp(section.name, ".code") == 0 && is_compressed) {
                 // Section is compressed, read compressed .code section...
+                const u8* compressed = mapped_section;
                 std::unique_ptr<u8[]> temp_buffer;
-                try {
-                    temp_buffer.reset(new u8[section.size]);
-                } catch (std::bad_alloc&) {
-                    return Loader::ResultStatus::ErrorMemoryAllocationFailed;
-                }
+                if (compressed == nullptr) {
+                    try {
+                        temp_buffer.reset(new u8[section.size]);
+                    } catch (std::bad_alloc&) {
+                        return Loader::ResultStatus::ErrorMemoryAllocationFailed;
+                    }
 
-                if (exefs_file.ReadBytes(&temp_buffer[0], section.size) != section.size)
-                    return Loader::ResultStatus::Error;
+                    if (exefs_file.ReadBytes(&temp_buffer[0], section.size) != section.size)
+                        return Loader::ResultStatus::Error;
 
-                if (is_encrypted) {
-                    dec.ProcessData(&temp_buffer[0], &temp_buffer[0], section.size);
+                    if (is_encrypted) {
+                        dec.ProcessData(&temp_buffer[0], &temp_buffer[0], section.size);
+                    }
+                    compressed = temp_buffer.get();
                 }
 
                 // Decompress .code section...
-                u32 decompressed_size = LZSS_GetDecompressedSize(&temp_buffer[0], section.size);
+                u32 decompressed_size = LZSS_GetDecompressedSize(compressed, section.size);
                 buffer.resize(decompressed_size);
-                if (!LZSS_Decompress(&temp_buffer[0], section.size, &buffer[0], decompressed_size))
+                if (!LZSS_Decompress(compressed, section.size, &buffer[0], decompressed_size))
                     return Loader::ResultStatus::ErrorInvalidFormat;
+            } else if (mapped_section != nullptr) {
+                // Section is uncompressed and mapped...
+                buffer.assign(mapped_section, mapped_section + section.size);
             } else {
                 // Section is uncompressed...
                 buffer.resize(section.size);
@@ -608,6 +635,11 @@ Loader::ResultStatus NCCHContainer::ReadRomFS(std::shared_ptr<RomFSReader>& romf
     if (file.GetSize() < romfs_offset + romfs_size)
         return Loader::ResultStatus::Error;
 
+    if (mapped_file) {
+        romfs_file = std::make_shared<RomFSReader>(mapped_file, romfs_offset, romfs_size);
+        return Loader::ResultStatus::Success;
+    }
+
     // We reopen the file, to allow its position to be independent from file's
     FileUtil::IOFile romfs_file_inner(filepath, "rb");
     if (!romfs_file_inner.IsOpen())
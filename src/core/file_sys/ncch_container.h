@@ -299,6 +299,8 @@ private:
     bool has_exefs = false;
     bool has_romfs = false;
 
+    bool has_exefs_override = false;
+
     bool is_tainted = false; // Are there parts of this container being overridden?
     bool is_loaded = false;
     bool is_compressed = false;
@@ -317,6 +319,8 @@ private:
     std::string filepath;
     FileUtil::IOFile file;
     FileUtil::IOFile exefs_file;
+    // Mapping of the whole file, only present for unencrypted images
+    std::shared_ptr<FileUtil::MappedFile> mapped_file;
 };
 
 } // namespace FileSys
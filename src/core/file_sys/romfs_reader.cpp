@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstring>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include "core/file_sys/romfs_reader.h"
@@ -6,17 +7,106 @@
 namespace FileSys {
 
 std::size_t RomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
-    if (length == 0)
+    if (length == 0 || offset >= data_size)
         return 0; // Crypto++ does not like zero size buffer
-    file.Seek(file_offset + offset, SEEK_SET);
     std::size_t read_length = std::min(length, data_size - offset);
-    read_length = file.ReadBytes(buffer, read_length);
-    if (is_encrypted) {
-        CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-        d.Seek(crypto_offset + offset);
-        d.ProcessData(buffer, buffer, read_length);
+
+    if (mapped_file) {
+        std::memcpy(buffer, mapped_file->Data() + file_offset + offset, read_length);
+        return read_length;
+    }
+
+    const bool sequential = offset == next_sequential_offset;
+    next_sequential_offset = offset + read_length;
+
+    if (read_length >= DirectReadThreshold)
+        return ReadDirect(offset, read_length, buffer);
+
+    const std::size_t first_block = offset / CacheBlockSize;
+    const std::size_t last_block = (offset + read_length - 1) / CacheBlockSize;
+    const std::size_t blocks_needed = last_block - first_block + 1;
+    const std::size_t load_count = sequential ? std::max(blocks_needed, ReadAheadBlocks)
+                                              : blocks_needed;
+
+    std::size_t copied = 0;
+    for (std::size_t index = first_block; index <= last_block; ++index) {
+        const CachedBlock* block = GetBlock(index, load_count - (index - first_block));
+        const std::size_t block_offset = (offset + copied) - index * CacheBlockSize;
+        if (block == nullptr || block->data.size() <= block_offset)
+            break;
+
+        const std::size_t to_copy =
+            std::min(read_length - copied, block->data.size() - block_offset);
+        std::memcpy(buffer + copied, block->data.data() + block_offset, to_copy);
+        copied += to_copy;
+        if (block->data.size() < std::min(CacheBlockSize, data_size - index * CacheBlockSize))
+            break; // Short read from the host file
     }
+    return copied;
+}
+
+std::size_t RomFSReader::ReadDirect(std::size_t offset, std::size_t length, u8* buffer) {
+    file.Seek(file_offset + offset, SEEK_SET);
+    std::size_t read_length = file.ReadBytes(buffer, length);
+    if (is_encrypted && read_length != 0)
+        Decrypt(offset, read_length, buffer);
     return read_length;
 }
 
+const RomFSReader::CachedBlock* RomFSReader::GetBlock(std::size_t index, std::size_t count) {
+    auto itr = block_cache.find(index);
+    if (itr == block_cache.end()) {
+        LoadBlocks(index, count);
+        itr = block_cache.find(index);
+        if (itr == block_cache.end())
+            return nullptr;
+    } else {
+        lru_list.splice(lru_list.begin(), lru_list, itr->second.lru_position);
+    }
+    return &itr->second;
+}
+
+void RomFSReader::LoadBlocks(std::size_t index, std::size_t count) {
+    const std::size_t total_blocks = (data_size + CacheBlockSize - 1) / CacheBlockSize;
+    count = std::min({count, total_blocks - index, CacheMaxBlocks});
+
+    // Stop at the first block that is already cached so that no block is loaded twice
+    std::size_t load_count = 1;
+    while (load_count < count && block_cache.count(index + load_count) == 0)
+        ++load_count;
+
+    const std::size_t offset = index * CacheBlockSize;
+    const std::size_t length = std::min(load_count * CacheBlockSize, data_size - offset);
+    std::vector<u8> staging(length);
+    const std::size_t read_length = ReadDirect(offset, length, staging.data());
+
+    for (std::size_t i = 0; i < load_count && i * CacheBlockSize < read_length; ++i) {
+        while (block_cache.size() >= CacheMaxBlocks) {
+            block_cache.erase(lru_list.back());
+            lru_list.pop_back();
+        }
+
+        const std::size_t block_start = i * CacheBlockSize;
+        const std::size_t block_length = std::min(CacheBlockSize, read_length - block_start);
+        lru_list.push_front(index + i);
+        CachedBlock& block = block_cache[index + i];
+        block.data.assign(staging.begin() + block_start,
+                          staging.begin() + block_start + block_length);
+        block.lru_position = lru_list.begin();
+    }
+
+    // Keep the requested block as the most recently used one
+    auto itr = block_cache.find(index);
+    if (itr != block_cache.end())
+        lru_list.splice(lru_list.begin(), lru_list, itr->second.lru_position);
+}
+
+void RomFSReader::Decrypt(std::size_t offset, std::size_t length, u8* data) const {
+    // Crypto++ picks the AES-NI implementation at runtime when the host supports it, so
+    // decrypting whole runs of blocks here keeps the per-call setup cost off small reads.
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
+    d.Seek(crypto_offset + offset);
+    d.ProcessData(data, data, length);
+}
+
 } // namespace FileSys
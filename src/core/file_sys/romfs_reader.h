@@ -1,17 +1,32 @@
 #pragma once
 
 #include <array>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
 #include "common/file_util.h"
 
 namespace FileSys {
 
+/**
+ * Reads (and decrypts if needed) data from a RomFS image. Small reads are served from an LRU cache
+ * of decrypted blocks, and sequential access patterns read ahead a window of blocks in one go so
+ * that the AES-CTR keystream is generated in bulk instead of once per guest request. Unencrypted
+ * images can instead be backed by a memory mapping, in which case reads are plain copies.
+ */
 class RomFSReader {
 public:
     RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
         : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
           data_size(data_size) {}
 
+    RomFSReader(std::shared_ptr<FileUtil::MappedFile> mapped_file, std::size_t file_offset,
+                std::size_t data_size)
+        : is_encrypted(false), mapped_file(std::move(mapped_file)), file_offset(file_offset),
+          data_size(data_size) {}
+
     RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                 const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
                 std::size_t crypto_offset)
@@ -25,13 +40,46 @@ public:
     std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer);
 
 private:
+    /// Size of a cached block. Must be a multiple of the AES block size.
+    static constexpr std::size_t CacheBlockSize = 0x4000;
+    /// Maximum number of blocks kept in the cache (4 MiB).
+    static constexpr std::size_t CacheMaxBlocks = 256;
+    /// Number of blocks loaded at once when the reads are sequential.
+    static constexpr std::size_t ReadAheadBlocks = 8;
+    /// Reads at least this large bypass the cache and are decrypted directly in the caller buffer.
+    static constexpr std::size_t DirectReadThreshold = CacheBlockSize * ReadAheadBlocks;
+
+    struct CachedBlock {
+        std::vector<u8> data;
+        std::list<std::size_t>::iterator lru_position;
+    };
+
+    /// Reads and decrypts `length` bytes at `offset` straight into `buffer`, bypassing the cache.
+    std::size_t ReadDirect(std::size_t offset, std::size_t length, u8* buffer);
+
+    /// Returns the cached block at `index`. On a miss, loads up to `count` blocks starting from it.
+    const CachedBlock* GetBlock(std::size_t index, std::size_t count);
+
+    /// Loads up to `count` uncached blocks starting at `index` with a single read and decryption.
+    void LoadBlocks(std::size_t index, std::size_t count);
+
+    /// Decrypts `length` bytes in place, `offset` being relative to the start of the RomFS.
+    void Decrypt(std::size_t offset, std::size_t length, u8* data) const;
+
     bool is_encrypted;
     FileUtil::IOFile file;
+    std::shared_ptr<FileUtil::MappedFile> mapped_file;
     std::array<u8, 16> key;
     std::array<u8, 16> ctr;
     std::size_t file_offset;
     std::size_t crypto_offset;
     std::size_t data_size;
+
+    /// Offset right after the end of the previous read, used to detect sequential access
+    std::size_t next_sequential_offset = 0;
+    std::unordered_map<std::size_t, CachedBlock> block_cache;
+    /// Block indices in the cache, most recently used first
+    std::list<std::size_t> lru_list;
 };
 
 } // namespace FileSys
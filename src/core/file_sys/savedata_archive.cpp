@@ -82,7 +82,7 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& pa
     }
 
     std::unique_ptr<DelayGenerator> delay_generator = std::make_unique<SaveDataDelayGenerator>();
-    auto disk_file = std::make_unique<DiskFile>(std::move(file), mode, std::move(delay_generator));
+    auto disk_file = OpenDiskFile(std::move(file), full_path, mode, std::move(delay_generator));
     return MakeResult<std::unique_ptr<FileBackend>>(std::move(disk_file));
 }
 
@@ -112,7 +112,7 @@ ResultCode SaveDataArchive::DeleteFile(const Path& path) const {
         break; // Expected 'success' case
     }
 
-    if (FileUtil::Delete(full_path)) {
+    if (DeleteDiskFile(full_path)) {
         return RESULT_SUCCESS;
     }
 
@@ -139,7 +139,7 @@ ResultCode SaveDataArchive::RenameFile(const Path& src_path, const Path& dest_pa
     const auto src_path_full = path_parser_src.BuildHostPath(mount_point);
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
-    if (FileUtil::Rename(src_path_full, dest_path_full)) {
+    if (RenameDiskPath(src_path_full, dest_path_full)) {
         return RESULT_SUCCESS;
     }
 
@@ -193,8 +193,7 @@ ResultCode SaveDataArchive::DeleteDirectory(const Path& path) const {
 }
 
 ResultCode SaveDataArchive::DeleteDirectoryRecursively(const Path& path) const {
-    return DeleteDirectoryHelper(
-        path, mount_point, [](const std::string& p) { return FileUtil::DeleteDirRecursively(p); });
+    return DeleteDirectoryHelper(path, mount_point, DeleteDiskDirectoryRecursively);
 }
 
 ResultCode SaveDataArchive::CreateFile(const FileSys::Path& path, u64 size) const {
@@ -298,7 +297,7 @@ ResultCode SaveDataArchive::RenameDirectory(const Path& src_path, const Path& de
     const auto src_path_full = path_parser_src.BuildHostPath(mount_point);
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
-    if (FileUtil::Rename(src_path_full, dest_path_full)) {
+    if (RenameDiskPath(src_path_full, dest_path_full)) {
         return RESULT_SUCCESS;
     }
 
@@ -42,6 +42,7 @@ Loader::ResultStatus Ticket::Load(const std::vector<u8> file_data, std::size_t o
 }
 
 std::optional<std::array<u8, 16>> Ticket::GetTitleKey() const {
+    const auto key_lock = HW::AES::LockKeySlots();
     HW::AES::InitKeys();
     std::array<u8, 16> ctr{};
     std::memcpy(ctr.data(), &ticket_body.title_id, sizeof(u64));
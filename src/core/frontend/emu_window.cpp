@@ -39,6 +39,8 @@ private:
     };
 };
 
+GraphicsContext::~GraphicsContext() = default;
+
 EmuWindow::EmuWindow() {
     // TODO: Find a better place to set this.
     config.min_client_area_size = std::make_pair(400u, 480u);
@@ -10,6 +10,31 @@
 #include "common/common_types.h"
 #include "core/frontend/framebuffer_layout.h"
 
+/**
+ * Represents a graphics context that can be made current on a thread. Besides the one used to
+ * render, frontends can provide contexts sharing their objects with it, so that work such as
+ * shader compilation can be done on other threads.
+ */
+class GraphicsContext {
+public:
+    virtual ~GraphicsContext();
+
+    /// Makes the graphics context current for the caller thread
+    virtual void MakeCurrent() = 0;
+
+    /// Releases the context from the caller thread
+    virtual void DoneCurrent() = 0;
+
+    /**
+     * Creates a context sharing its objects with this one, to be made current on another thread.
+     * Must be called from the thread this context is current on.
+     * @returns nullptr if the frontend doesn't support shared contexts
+     */
+    virtual std::unique_ptr<GraphicsContext> CreateSharedContext() const {
+        return nullptr;
+    }
+};
+
 /**
  * Abstraction class used to provide an interface between emulation code and the frontend
  * (e.g. SDL, QGLWidget, GLFW, etc...).
@@ -28,7 +53,7 @@
  * - DO NOT TREAT THIS CLASS AS A GUI TOOLKIT ABSTRACTION LAYER. That's not what it is. Please
  *   re-read the upper points again and think about it if you don't see this.
  */
-class EmuWindow {
+class EmuWindow : public GraphicsContext {
 public:
     /// Data structure to store emuwindow configuration
     struct WindowConfig {
@@ -44,12 +69,6 @@ public:
     /// Polls window events
     virtual void PollEvents() = 0;
 
-    /// Makes the graphics context current for the caller thread
-    virtual void MakeCurrent() = 0;
-
-    /// Releases (dunno if this is the "right" word) the GLFW context from the caller thread
-    virtual void DoneCurrent() = 0;
-
     /**
      * Signal that a touch pressed event has occurred (e.g. mouse click pressed)
      * @param framebuffer_x Framebuffer x-coordinate that was pressed
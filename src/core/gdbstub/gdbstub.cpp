@@ -5,14 +5,21 @@
 // Originally written by Sven Peter <sven@fail0verflow.com> for anergistic.
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <climits>
+#include <condition_variable>
 #include <csignal>
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
 #include <map>
+#include <mutex>
 #include <numeric>
+#include <optional>
+#include <thread>
+#include <vector>
 #include <fcntl.h>
 #include <fmt/format.h>
 
@@ -24,7 +31,9 @@
 #include <ws2tcpip.h>
 #define SHUT_RDWR 2
 #else
+#include <cerrno>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/un.h>
@@ -41,12 +50,14 @@
 
 namespace GDBStub {
 namespace {
-constexpr int GDB_BUFFER_SIZE = 10000;
+/// Size of the largest packet accepted from the client, which is advertised as PacketSize
+constexpr int GDB_BUFFER_SIZE = 0x10000;
 
 constexpr char GDB_STUB_START = '$';
 constexpr char GDB_STUB_END = '#';
 constexpr char GDB_STUB_ACK = '+';
 constexpr char GDB_STUB_NACK = '-';
+constexpr char GDB_STUB_ESCAPE = '}';
 
 #ifndef SIGTRAP
 constexpr u32 SIGTRAP = 5;
@@ -125,9 +136,31 @@ int gdbserver_socket = -1;
 u8 command_buffer[GDB_BUFFER_SIZE];
 u32 command_length;
 
+/// Data received from the client that has not been read yet
+std::array<u8, GDB_BUFFER_SIZE> receive_buffer;
+std::size_t receive_begin = 0;
+std::size_t receive_end = 0;
+
+/// Packet being sent to the client
+std::vector<u8> send_buffer;
+
+/**
+ * Set by the watcher thread when the client has sent data. This lets the emulation thread check
+ * for packets without a system call. The watcher waits for the flag to be cleared before looking
+ * at the socket again.
+ */
+std::atomic<bool> data_pending{false};
+bool watcher_stop = false;
+std::mutex watcher_mutex;
+std::condition_variable watcher_cv;
+std::thread watcher_thread;
+
 u32 latest_signal = 0;
 bool memory_break = false;
 
+/// Watchpoint hit during the current CPU slice, reported with the next stop signal
+std::optional<BreakpointAddress> watchpoint_hit;
+
 static Kernel::Thread* current_thread = nullptr;
 
 // Binding to a port within the reserved ports range (0-1023) requires root permissions,
@@ -157,6 +190,8 @@ using BreakpointMap = std::map<VAddr, Breakpoint>;
 BreakpointMap breakpoints_execute;
 BreakpointMap breakpoints_read;
 BreakpointMap breakpoints_write;
+/// Watchpoints stopping on both reads and writes, reported to the client as access watchpoints
+BreakpointMap breakpoints_access;
 } // Anonymous namespace
 
 static Kernel::Thread* FindThreadById(int id) {
@@ -358,16 +393,101 @@ static u64 GdbHexToLong(const u8* src) {
     return output;
 }
 
+/// Returns whether the last socket operation failed because it would have blocked.
+static bool WouldBlock() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+/// Blocks until the socket can be read from, or written to if write is set.
+static bool WaitForSocket(int socket, bool write) {
+    fd_set fd_socket;
+    FD_ZERO(&fd_socket);
+    FD_SET(socket, &fd_socket);
+    const int result = write ? select(socket + 1, nullptr, &fd_socket, nullptr, nullptr)
+                             : select(socket + 1, &fd_socket, nullptr, nullptr, nullptr);
+    return result > 0;
+}
+
+/// Waits for the client to send data without blocking the emulation thread.
+static void WatchSocket(int socket) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(watcher_mutex);
+            watcher_cv.wait(lock, [] { return watcher_stop || !data_pending; });
+            if (watcher_stop) {
+                return;
+            }
+        }
+
+        fd_set fd_socket;
+        FD_ZERO(&fd_socket);
+        FD_SET(socket, &fd_socket);
+        // Time out regularly, so that the thread notices when it has to stop
+        timeval timeout{0, 100000};
+        if (select(socket + 1, &fd_socket, nullptr, nullptr, &timeout) != 0) {
+            // Errors are left for the emulation thread to notice when it reads from the socket
+            std::lock_guard<std::mutex> lock(watcher_mutex);
+            data_pending = true;
+            watcher_cv.notify_all();
+        }
+    }
+}
+
+/**
+ * Moves all data the client has sent into the receive buffer, without blocking.
+ * @return False if the connection has failed
+ */
+static bool ReceiveData() {
+    if (receive_begin == receive_end) {
+        receive_begin = receive_end = 0;
+    } else if (receive_begin > 0) {
+        std::memmove(receive_buffer.data(), receive_buffer.data() + receive_begin,
+                     receive_end - receive_begin);
+        receive_end -= receive_begin;
+        receive_begin = 0;
+    }
+
+    while (receive_end < receive_buffer.size()) {
+        const int received_size =
+            recv(gdbserver_socket, reinterpret_cast<char*>(receive_buffer.data() + receive_end),
+                 static_cast<int>(receive_buffer.size() - receive_end), 0);
+        if (received_size > 0) {
+            receive_end += received_size;
+            continue;
+        }
+        if (received_size < 0 && WouldBlock()) {
+            break;
+        }
+        LOG_ERROR(Debug_GDBStub, "recv failed : {}", received_size);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(watcher_mutex);
+        data_pending = false;
+    }
+    watcher_cv.notify_all();
+    return true;
+}
+
 /// Read a byte from the gdb client.
 static u8 ReadByte() {
-    u8 c;
-    std::size_t received_size = recv(gdbserver_socket, reinterpret_cast<char*>(&c), 1, MSG_WAITALL);
-    if (received_size != 1) {
-        LOG_ERROR(Debug_GDBStub, "recv failed : {}", received_size);
-        Shutdown();
+    while (receive_begin == receive_end) {
+        if (!IsConnected()) {
+            return 0;
+        }
+        // Wait for the rest of the packet
+        if (!WaitForSocket(gdbserver_socket, false) || !ReceiveData()) {
+            Shutdown();
+            return 0;
+        }
     }
 
-    return c;
+    return receive_buffer[receive_begin++];
 }
 
 /// Calculate the checksum of the current command buffer.
@@ -388,6 +508,8 @@ static BreakpointMap& GetBreakpointMap(BreakpointType type) {
         return breakpoints_read;
     case BreakpointType::Write:
         return breakpoints_write;
+    case BreakpointType::Access:
+        return breakpoints_access;
     default:
         return breakpoints_read;
     }
@@ -409,10 +531,16 @@ static void RemoveBreakpoint(BreakpointType type, VAddr addr) {
 
     LOG_DEBUG(Debug_GDBStub, "gdb: removed a breakpoint: {:08x} bytes at {:08x} of type {}",
               bp->second.len, bp->second.addr, static_cast<int>(type));
-    Core::System::GetInstance().Memory().WriteBlock(
-        *Core::System::GetInstance().Kernel().GetCurrentProcess(), bp->second.addr,
-        bp->second.inst.data(), bp->second.inst.size());
-    Core::CPU().ClearInstructionCache();
+    auto& process = *Core::System::GetInstance().Kernel().GetCurrentProcess();
+    if (type == BreakpointType::Execute) {
+        Core::System::GetInstance().Memory().WriteBlock(process, bp->second.addr,
+                                                        bp->second.inst.data(),
+                                                        bp->second.inst.size());
+        Core::CPU().ClearInstructionCache();
+    } else {
+        Core::System::GetInstance().Memory().UnwatchRegion(process.vm_manager.page_table,
+                                                           bp->second.addr, bp->second.len);
+    }
     p.erase(addr);
 }
 
@@ -469,14 +597,67 @@ bool CheckBreakpoint(VAddr addr, BreakpointType type) {
     return false;
 }
 
+/// Returns whether an access overlaps one of the watchpoints of the given type.
+static bool HitsWatchpoint(VAddr addr, u32 size, BreakpointType type) {
+    const u64 end = static_cast<u64>(addr) + size;
+    for (const auto& [start, watchpoint] : GetBreakpointMap(type)) {
+        if (start >= end) {
+            break;
+        }
+        if (watchpoint.active && addr < static_cast<u64>(start) + watchpoint.len) {
+            LOG_DEBUG(Debug_GDBStub, "Hit watchpoint type {} @ {:08x} ({:x} bytes), access {:08x}",
+                      static_cast<int>(type), start, watchpoint.len, addr);
+            return true;
+        }
+    }
+    return false;
+}
+
+void CheckWatchpoint(VAddr addr, u32 size, BreakpointType type) {
+    if (!IsConnected() || watchpoint_hit) {
+        return;
+    }
+
+    if (HitsWatchpoint(addr, size, type)) {
+        watchpoint_hit = BreakpointAddress{addr, type};
+    } else if (HitsWatchpoint(addr, size, BreakpointType::Access)) {
+        watchpoint_hit = BreakpointAddress{addr, BreakpointType::Access};
+    } else {
+        return;
+    }
+
+    // Memory is also accessed while no CPU is running, the hit is then reported at the next stop
+    if (Core::System::GetInstance().IsPoweredOn()) {
+        Core::CPU().PrepareReschedule();
+    }
+}
+
 /**
  * Send packet to gdb client.
  *
  * @param packet Packet to be sent to client.
  */
+static void SendPacket(const char packet);
+
+/// Send data to the gdb client, waiting whenever the socket buffer is full.
+static bool SendData(const u8* data, std::size_t size) {
+    while (size > 0) {
+        const int sent_size = send(gdbserver_socket, reinterpret_cast<const char*>(data),
+                                   static_cast<int>(size), 0);
+        if (sent_size < 0) {
+            if (WouldBlock() && WaitForSocket(gdbserver_socket, true)) {
+                continue;
+            }
+            return false;
+        }
+        data += sent_size;
+        size -= sent_size;
+    }
+    return true;
+}
+
 static void SendPacket(const char packet) {
-    std::size_t sent_size = send(gdbserver_socket, &packet, 1, 0);
-    if (sent_size != 1) {
+    if (!SendData(reinterpret_cast<const u8*>(&packet), 1)) {
         LOG_ERROR(Debug_GDBStub, "send failed");
     }
 }
@@ -485,40 +666,55 @@ static void SendPacket(const char packet) {
  * Send reply to gdb client.
  *
  * @param reply Reply to be sent to client.
+ * @param size Size of the reply in bytes.
  */
-static void SendReply(const char* reply) {
+static void SendReply(const u8* reply, std::size_t size) {
     if (!IsConnected()) {
         return;
     }
 
-    memset(command_buffer, 0, sizeof(command_buffer));
+    const u8 checksum = CalculateChecksum(reply, size);
+    send_buffer.resize(size + 4);
+    send_buffer[0] = GDB_STUB_START;
+    std::memcpy(send_buffer.data() + 1, reply, size);
+    send_buffer[size + 1] = GDB_STUB_END;
+    send_buffer[size + 2] = NibbleToHex(checksum >> 4);
+    send_buffer[size + 3] = NibbleToHex(checksum);
 
-    command_length = static_cast<u32>(strlen(reply));
-    if (command_length + 4 > sizeof(command_buffer)) {
-        LOG_ERROR(Debug_GDBStub, "command_buffer overflow in SendReply");
-        return;
+    if (!SendData(send_buffer.data(), send_buffer.size())) {
+        LOG_ERROR(Debug_GDBStub, "gdb: send failed");
+        return Shutdown();
     }
+}
 
-    memcpy(command_buffer + 1, reply, command_length);
-
-    u8 checksum = CalculateChecksum(command_buffer, command_length + 1);
-    command_buffer[0] = GDB_STUB_START;
-    command_buffer[command_length + 1] = GDB_STUB_END;
-    command_buffer[command_length + 2] = NibbleToHex(checksum >> 4);
-    command_buffer[command_length + 3] = NibbleToHex(checksum);
+static void SendReply(const char* reply) {
+    SendReply(reinterpret_cast<const u8*>(reply), std::strlen(reply));
+}
 
-    u8* ptr = command_buffer;
-    u32 left = command_length + 4;
-    while (left > 0) {
-        int sent_size = send(gdbserver_socket, reinterpret_cast<char*>(ptr), left, 0);
-        if (sent_size < 0) {
-            LOG_ERROR(Debug_GDBStub, "gdb: send failed");
-            return Shutdown();
+/// Appends binary data to a reply, escaping the bytes that have a meaning in the protocol.
+static void AppendEscaped(std::vector<u8>& reply, const u8* data, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+        const u8 c = data[i];
+        if (c == GDB_STUB_START || c == GDB_STUB_END || c == GDB_STUB_ESCAPE || c == '*') {
+            reply.push_back(GDB_STUB_ESCAPE);
+            reply.push_back(c ^ 0x20);
+        } else {
+            reply.push_back(c);
         }
+    }
+}
 
-        left -= sent_size;
-        ptr += sent_size;
+/// Removes the escaping of binary data received from the client in place, returning its size.
+static std::size_t UnescapeBinary(u8* data, std::size_t size) {
+    std::size_t out = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (data[i] == GDB_STUB_ESCAPE && i + 1 < size) {
+            data[out++] = data[++i] ^ 0x20;
+        } else {
+            data[out++] = data[i];
+        }
     }
+    return out;
 }
 
 /// Handle query command from gdb client.
@@ -531,7 +727,10 @@ static void HandleQuery() {
         SendReply("T0");
     } else if (strncmp(query, "Supported", strlen("Supported")) == 0) {
         // PacketSize needs to be large enough for target xml
-        SendReply("PacketSize=2000;qXfer:features:read+;qXfer:threads:read+");
+        SendReply(fmt::format("PacketSize={:x};qXfer:features:read+;qXfer:threads:read+;"
+                              "binary-upload+",
+                              GDB_BUFFER_SIZE - 1)
+                      .c_str());
     } else if (strncmp(query, "Xfer:features:read:target.xml:",
                        strlen("Xfer:features:read:target.xml:")) == 0) {
         SendReply(target_xml);
@@ -612,10 +811,11 @@ static void SendSignal(Kernel::Thread* thread, u32 signal, bool full = true) {
         full = false;
     }
 
+    // Every key:value pair of the stop reply is terminated by a semicolon
     std::string buffer;
     if (full) {
 
-        buffer = fmt::format("T{:02x}{:02x}:{:08x};{:02x}:{:08x};{:02x}:{:08x}", latest_signal,
+        buffer = fmt::format("T{:02x}{:02x}:{:08x};{:02x}:{:08x};{:02x}:{:08x};", latest_signal,
                              PC_REGISTER, htonl(Core::CPU().GetPC()), SP_REGISTER,
                              htonl(Core::CPU().GetReg(SP_REGISTER)), LR_REGISTER,
                              htonl(Core::CPU().GetReg(LR_REGISTER)));
@@ -623,8 +823,19 @@ static void SendSignal(Kernel::Thread* thread, u32 signal, bool full = true) {
         buffer = fmt::format("T{:02x}", latest_signal);
     }
 
+    if (watchpoint_hit) {
+        const char* reason = "watch";
+        if (watchpoint_hit->type == BreakpointType::Read) {
+            reason = "rwatch";
+        } else if (watchpoint_hit->type == BreakpointType::Access) {
+            reason = "awatch";
+        }
+        buffer += fmt::format("{}:{:08x};", reason, watchpoint_hit->address);
+        watchpoint_hit.reset();
+    }
+
     if (thread) {
-        buffer += fmt::format(";thread:{:x};", thread->GetThreadId());
+        buffer += fmt::format("thread:{:x};", thread->GetThreadId());
     }
 
     LOG_DEBUG(Debug_GDBStub, "Response: {}", buffer);
@@ -651,7 +862,12 @@ static void ReadCommand() {
     }
 
     while ((c = ReadByte()) != GDB_STUB_END) {
-        if (command_length >= sizeof(command_buffer)) {
+        if (!IsConnected()) {
+            command_length = 0;
+            return;
+        }
+        // Keep the command null-terminated
+        if (command_length >= sizeof(command_buffer) - 1) {
             LOG_ERROR(Debug_GDBStub, "gdb: command_buffer overflow\n");
             SendPacket(GDB_STUB_NACK);
             return;
@@ -685,21 +901,27 @@ static bool IsDataAvailable() {
         return false;
     }
 
-    fd_set fd_socket;
-
-    FD_ZERO(&fd_socket);
-    FD_SET(gdbserver_socket, &fd_socket);
+    if (receive_begin != receive_end) {
+        return true;
+    }
 
-    struct timeval t;
-    t.tv_sec = 0;
-    t.tv_usec = 0;
+    if (!data_pending.load(std::memory_order_relaxed)) {
+        if (!halt_loop || step_loop) {
+            return false;
+        }
+        // The CPU is halted, so wait for the client for a while instead of spinning
+        std::unique_lock<std::mutex> lock(watcher_mutex);
+        if (!watcher_cv.wait_for(lock, std::chrono::milliseconds(10),
+                                 [] { return data_pending.load(); })) {
+            return false;
+        }
+    }
 
-    if (select(gdbserver_socket + 1, &fd_socket, nullptr, nullptr, &t) < 0) {
-        LOG_ERROR(Debug_GDBStub, "select failed");
+    if (!ReceiveData()) {
+        Shutdown();
         return false;
     }
-
-    return FD_ISSET(gdbserver_socket, &fd_socket) != 0;
+    return receive_begin != receive_end;
 }
 
 /// Send requested register to gdb client.
@@ -814,9 +1036,9 @@ static void WriteRegisters() {
     SendReply("OK");
 }
 
-/// Read location in memory specified by gdb client.
+/// Read location in memory specified by gdb client, as hex digits or as binary data.
 static void ReadMemory() {
-    static u8 reply[GDB_BUFFER_SIZE - 4];
+    const bool binary = command_buffer[0] == 'x';
 
     auto start_offset = command_buffer + 1;
     auto addr_pos = std::find(start_offset, command_buffer + command_length, ',');
@@ -828,8 +1050,8 @@ static void ReadMemory() {
 
     LOG_DEBUG(Debug_GDBStub, "gdb: addr: {:08x} len: {:08x}\n", addr, len);
 
-    if (len * 2 > sizeof(reply)) {
-        SendReply("E01");
+    if (static_cast<u64>(len) * 2 > GDB_BUFFER_SIZE - 4) {
+        return SendReply("E01");
     }
 
     if (!Memory::IsValidVirtualAddress(*Core::System::GetInstance().Kernel().GetCurrentProcess(),
@@ -841,13 +1063,22 @@ static void ReadMemory() {
     Core::System::GetInstance().Memory().ReadBlock(
         *Core::System::GetInstance().Kernel().GetCurrentProcess(), addr, data.data(), len);
 
-    MemToGdbHex(reply, data.data(), len);
-    reply[len * 2] = '\0';
-    SendReply(reinterpret_cast<char*>(reply));
+    std::vector<u8> reply;
+    if (binary) {
+        reply.reserve(len + 1);
+        reply.push_back('b');
+        AppendEscaped(reply, data.data(), len);
+    } else {
+        reply.resize(len * 2);
+        MemToGdbHex(reply.data(), data.data(), len);
+    }
+    SendReply(reply.data(), reply.size());
 }
 
-/// Modify location in memory with data received from the gdb client.
+/// Modify location in memory with data received from the gdb client, as hex digits or as binary.
 static void WriteMemory() {
+    const bool binary = command_buffer[0] == 'X';
+
     auto start_offset = command_buffer + 1;
     auto addr_pos = std::find(start_offset, command_buffer + command_length, ',');
     VAddr addr = HexToInt(start_offset, static_cast<u32>(addr_pos - start_offset));
@@ -862,8 +1093,21 @@ static void WriteMemory() {
     }
 
     std::vector<u8> data(len);
-
-    GdbHexToMem(data.data(), len_pos + 1, len);
+    if (binary) {
+        u8* const binary_data = len_pos + 1;
+        const std::size_t binary_size = UnescapeBinary(
+            binary_data, static_cast<std::size_t>(command_buffer + command_length - binary_data));
+        if (binary_size != len) {
+            return SendReply("E01");
+        }
+        // GDB probes for support of binary writes with empty ones
+        if (len == 0) {
+            return SendReply("OK");
+        }
+        std::memcpy(data.data(), binary_data, len);
+    } else {
+        GdbHexToMem(data.data(), len_pos + 1, len);
+    }
     Core::System::GetInstance().Memory().WriteBlock(
         *Core::System::GetInstance().Kernel().GetCurrentProcess(), addr, data.data(), len);
     Core::CPU().ClearInstructionCache();
@@ -888,6 +1132,21 @@ static void Step() {
     Core::CPU().ClearInstructionCache();
 }
 
+void ServeWatchpoint() {
+    if (!watchpoint_hit) {
+        return;
+    }
+
+    Kernel::Thread* thread =
+        Core::System::GetInstance().Kernel().GetThreadManager().GetCurrentThread();
+    if (thread != nullptr) {
+        Core::CPU().SaveContext(thread->context);
+    }
+    Break();
+    SendTrap(thread, 5);
+    watchpoint_hit.reset();
+}
+
 bool IsMemoryBreak() {
     if (IsConnected()) {
         return false;
@@ -913,19 +1172,28 @@ static void Continue() {
  */
 static bool CommitBreakpoint(BreakpointType type, VAddr addr, u32 len) {
     BreakpointMap& p = GetBreakpointMap(type);
+    if (p.count(addr) != 0) {
+        // GDB may insert the same breakpoint again, which must not overwrite the saved instruction
+        return true;
+    }
 
     Breakpoint breakpoint;
     breakpoint.active = true;
     breakpoint.addr = addr;
     breakpoint.len = len;
-    Core::System::GetInstance().Memory().ReadBlock(
-        *Core::System::GetInstance().Kernel().GetCurrentProcess(), addr, breakpoint.inst.data(),
-        breakpoint.inst.size());
-    static constexpr std::array<u8, 4> btrap{0x70, 0x00, 0x20, 0xe1};
-    Core::System::GetInstance().Memory().WriteBlock(
-        *Core::System::GetInstance().Kernel().GetCurrentProcess(), addr, btrap.data(),
-        btrap.size());
-    Core::CPU().ClearInstructionCache();
+    auto& process = *Core::System::GetInstance().Kernel().GetCurrentProcess();
+    if (type == BreakpointType::Execute) {
+        Core::System::GetInstance().Memory().ReadBlock(process, addr, breakpoint.inst.data(),
+                                                       breakpoint.inst.size());
+        static constexpr std::array<u8, 4> btrap{0x70, 0x00, 0x20, 0xe1};
+        Core::System::GetInstance().Memory().WriteBlock(process, addr, btrap.data(),
+                                                        btrap.size());
+        Core::CPU().ClearInstructionCache();
+    } else if (!Core::System::GetInstance().Memory().WatchRegion(process.vm_manager.page_table,
+                                                                 addr, len)) {
+        // Watchpoints are checked by the memory system on the pages they touch
+        return false;
+    }
     p.insert({addr, breakpoint});
 
     LOG_DEBUG(Debug_GDBStub, "gdb: added {} breakpoint: {:08x} bytes at {:08x}\n",
@@ -965,17 +1233,6 @@ static void AddBreakpoint() {
     u32 len =
         HexToInt(start_offset, static_cast<u32>((command_buffer + command_length) - start_offset));
 
-    if (type == BreakpointType::Access) {
-        // Access is made up of Read and Write types, so add both breakpoints
-        type = BreakpointType::Read;
-
-        if (!CommitBreakpoint(type, addr, len)) {
-            return SendReply("E02");
-        }
-
-        type = BreakpointType::Write;
-    }
-
     if (!CommitBreakpoint(type, addr, len)) {
         return SendReply("E02");
     }
@@ -1010,14 +1267,6 @@ static void RemoveBreakpoint() {
     auto addr_pos = std::find(start_offset, command_buffer + command_length, ',');
     VAddr addr = HexToInt(start_offset, static_cast<u32>(addr_pos - start_offset));
 
-    if (type == BreakpointType::Access) {
-        // Access is made up of Read and Write types, so add both breakpoints
-        type = BreakpointType::Read;
-        RemoveBreakpoint(type, addr);
-
-        type = BreakpointType::Write;
-    }
-
     RemoveBreakpoint(type, addr);
     SendReply("OK");
 }
@@ -1065,9 +1314,11 @@ void HandlePacket() {
         WriteRegister();
         break;
     case 'm':
+    case 'x':
         ReadMemory();
         break;
     case 'M':
+    case 'X':
         WriteMemory();
         break;
     case 's':
@@ -1130,6 +1381,7 @@ static void Init(u16 port) {
     breakpoints_execute.clear();
     breakpoints_read.clear();
     breakpoints_write.clear();
+    breakpoints_access.clear();
 
     // Start gdb server
     LOG_INFO(Debug_GDBStub, "Starting GDB server on port {}...", port);
@@ -1181,6 +1433,23 @@ static void Init(u16 port) {
     } else {
         LOG_INFO(Debug_GDBStub, "Client connected.\n");
         saddr_client.sin_addr.s_addr = ntohl(saddr_client.sin_addr.s_addr);
+
+        // Replies are sent as soon as they are ready, and the socket is only read from when
+        // the watcher thread has seen data arrive
+        int no_delay = 1;
+        setsockopt(gdbserver_socket, IPPROTO_TCP, TCP_NODELAY,
+                   reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+#ifdef _WIN32
+        u_long non_blocking = 1;
+        ioctlsocket(gdbserver_socket, FIONBIO, &non_blocking);
+#else
+        fcntl(gdbserver_socket, F_SETFL, fcntl(gdbserver_socket, F_GETFL) | O_NONBLOCK);
+#endif
+
+        receive_begin = receive_end = 0;
+        data_pending = false;
+        watcher_stop = false;
+        watcher_thread = std::thread(WatchSocket, gdbserver_socket);
     }
 
     // Clean up temporary socket if it's still alive at this point.
@@ -1200,8 +1469,17 @@ void Shutdown() {
 
     LOG_INFO(Debug_GDBStub, "Stopping GDB ...");
     if (gdbserver_socket != -1) {
+        {
+            std::lock_guard<std::mutex> lock(watcher_mutex);
+            watcher_stop = true;
+        }
+        watcher_cv.notify_all();
         shutdown(gdbserver_socket, SHUT_RDWR);
+        if (watcher_thread.joinable()) {
+            watcher_thread.join();
+        }
         gdbserver_socket = -1;
+        receive_begin = receive_end = 0;
     }
 
 #ifdef _WIN32
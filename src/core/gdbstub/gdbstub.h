@@ -80,6 +80,19 @@ BreakpointAddress GetNextBreakpointFromAddress(VAddr addr, GDBStub::BreakpointTy
  */
 bool CheckBreakpoint(VAddr addr, GDBStub::BreakpointType type);
 
+/**
+ * Check if an access overlaps a watchpoint, and if so stop the CPU at the end of the current
+ * block. Called by the memory system for accesses to pages of type `Watched`.
+ *
+ * @param addr Address of the access.
+ * @param size Size of the access in bytes.
+ * @param type Type of the access, either Read or Write. Access watchpoints match both.
+ */
+void CheckWatchpoint(VAddr addr, u32 size, GDBStub::BreakpointType type);
+
+/// Report a watchpoint hit during the last CPU slice to the gdb client.
+void ServeWatchpoint();
+
 // If set to true, the CPU will halt at the beginning of the next CPU loop.
 bool GetCpuHaltFlag();
 
@@ -8,6 +8,7 @@
 #include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/thread.h"
 #include "core/memory.h"
 
@@ -65,6 +66,16 @@ SharedPtr<Thread> AddressArbiter::ResumeHighestPriorityThread(VAddr address) {
     return thread;
 }
 
+void AddressArbiter::SetTimeoutCallback(Thread& thread) {
+    thread.wakeup_callback = [this](ThreadWakeupReason reason, SharedPtr<Thread> thread,
+                                    SharedPtr<WaitObject> object) {
+        ASSERT(reason == ThreadWakeupReason::Timeout);
+        // Remove the newly-awakened thread from the Arbiter's waiting list.
+        waiting_threads.erase(std::remove(waiting_threads.begin(), waiting_threads.end(), thread),
+                              waiting_threads.end());
+    };
+}
+
 AddressArbiter::AddressArbiter(KernelSystem& kernel) : Object(kernel), kernel(kernel) {}
 AddressArbiter::~AddressArbiter() {}
 
@@ -79,14 +90,6 @@ SharedPtr<AddressArbiter> KernelSystem::CreateAddressArbiter(std::string name) {
 ResultCode AddressArbiter::ArbitrateAddress(SharedPtr<Thread> thread, ArbitrationType type,
                                             VAddr address, s32 value, u64 nanoseconds) {
 
-    auto timeout_callback = [this](ThreadWakeupReason reason, SharedPtr<Thread> thread,
-                                   SharedPtr<WaitObject> object) {
-        ASSERT(reason == ThreadWakeupReason::Timeout);
-        // Remove the newly-awakened thread from the Arbiter's waiting list.
-        waiting_threads.erase(std::remove(waiting_threads.begin(), waiting_threads.end(), thread),
-                              waiting_threads.end());
-    };
-
     switch (type) {
 
     // Signal thread(s) waiting for arbitrate address...
@@ -109,7 +112,7 @@ ResultCode AddressArbiter::ArbitrateAddress(SharedPtr<Thread> thread, Arbitratio
         break;
     case ArbitrationType::WaitIfLessThanWithTimeout:
         if ((s32)kernel.memory.Read32(address) < value) {
-            thread->wakeup_callback = timeout_callback;
+            SetTimeoutCallback(*thread);
             thread->WakeAfterDelay(nanoseconds);
             WaitThread(std::move(thread), address);
         }
@@ -128,7 +131,7 @@ ResultCode AddressArbiter::ArbitrateAddress(SharedPtr<Thread> thread, Arbitratio
         if (memory_value < value) {
             // Only change the memory value if the thread should wait
             kernel.memory.Write32(address, (s32)memory_value - 1);
-            thread->wakeup_callback = timeout_callback;
+            SetTimeoutCallback(*thread);
             thread->WakeAfterDelay(nanoseconds);
             WaitThread(std::move(thread), address);
         }
@@ -150,4 +153,34 @@ ResultCode AddressArbiter::ArbitrateAddress(SharedPtr<Thread> thread, Arbitratio
     return RESULT_SUCCESS;
 }
 
+void AddressArbiter::SaveState(ObjectStateWriter& writer) const {
+    writer.WriteString(name);
+    writer.Write(static_cast<u32>(waiting_threads.size()));
+    for (const auto& thread : waiting_threads) {
+        writer.WriteObject(thread);
+        // Only the waits with a timeout have a callback, which Thread leaves to the arbiter
+        writer.Write(static_cast<bool>(thread->wakeup_callback));
+    }
+}
+
+bool AddressArbiter::LoadState(ObjectStateReader& reader) {
+    u32 count;
+    if (!reader.ReadString(name) || !reader.Read(count)) {
+        return false;
+    }
+    waiting_threads.clear();
+    for (u32 i = 0; i < count; ++i) {
+        SharedPtr<Thread> thread;
+        bool has_timeout;
+        if (!reader.ReadObject(thread) || thread == nullptr || !reader.Read(has_timeout)) {
+            return false;
+        }
+        if (has_timeout) {
+            SetTimeoutCallback(*thread);
+        }
+        waiting_threads.push_back(std::move(thread));
+    }
+    return true;
+}
+
 } // namespace Kernel
@@ -48,6 +48,9 @@ public:
     ResultCode ArbitrateAddress(SharedPtr<Thread> thread, ArbitrationType type, VAddr address,
                                 s32 value, u64 nanoseconds);
 
+    void SaveState(ObjectStateWriter& writer) const override;
+    bool LoadState(ObjectStateReader& reader) override;
+
 private:
     explicit AddressArbiter(KernelSystem& kernel);
     ~AddressArbiter() override;
@@ -57,6 +60,10 @@ private:
     /// Puts the thread to wait on the specified arbitration address under this address arbiter.
     void WaitThread(SharedPtr<Thread> thread, VAddr wait_address);
 
+    /// Sets the wakeup callback of a thread waiting with a timeout, which removes the thread from
+    /// the waiting threads when the timeout expires.
+    void SetTimeoutCallback(Thread& thread);
+
     /// Resume all threads found to be waiting on the address under this address arbiter
     void ResumeAllThreads(VAddr address);
 
@@ -8,6 +8,7 @@
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/server_port.h"
 #include "core/hle/kernel/server_session.h"
 
@@ -45,4 +46,16 @@ void ClientPort::ConnectionClosed() {
     --active_sessions;
 }
 
+void ClientPort::SaveState(ObjectStateWriter& writer) const {
+    writer.WriteObject(server_port);
+    writer.Write(max_sessions);
+    writer.Write(active_sessions);
+    writer.WriteString(name);
+}
+
+bool ClientPort::LoadState(ObjectStateReader& reader) {
+    return reader.ReadObject(server_port) && reader.Read(max_sessions) &&
+           reader.Read(active_sessions) && reader.ReadString(name);
+}
+
 } // namespace Kernel
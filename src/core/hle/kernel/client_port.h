@@ -47,6 +47,9 @@ public:
      */
     void ConnectionClosed();
 
+    void SaveState(ObjectStateWriter& writer) const override;
+    bool LoadState(ObjectStateReader& reader) override;
+
 private:
     explicit ClientPort(KernelSystem& kernel);
     ~ClientPort() override;
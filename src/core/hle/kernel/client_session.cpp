@@ -7,6 +7,7 @@
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/kernel/session.h"
 #include "core/hle/kernel/thread.h"
@@ -18,6 +19,11 @@ ClientSession::~ClientSession() {
     // This destructor will be called automatically when the last ClientSession handle is closed by
     // the emulated application.
 
+    // Blank sessions that a save state failed to load have no parent
+    if (parent == nullptr) {
+        return;
+    }
+
     // Local references to ServerSession and SessionRequestHandler are necessary to guarantee they
     // will be kept alive until after ClientDisconnected() returns.
     SharedPtr<ServerSession> server = parent->server;
@@ -52,4 +58,13 @@ ResultCode ClientSession::SendSyncRequest(SharedPtr<Thread> thread) {
     return server->HandleSyncRequest(std::move(thread));
 }
 
+void ClientSession::SaveState(ObjectStateWriter& writer) const {
+    writer.WriteString(name);
+    writer.WriteSession(parent);
+}
+
+bool ClientSession::LoadState(ObjectStateReader& reader) {
+    return reader.ReadString(name) && reader.ReadSession(parent) && parent != nullptr;
+}
+
 } // namespace Kernel
@@ -39,6 +39,9 @@ public:
      */
     ResultCode SendSyncRequest(SharedPtr<Thread> thread);
 
+    void SaveState(ObjectStateWriter& writer) const override;
+    bool LoadState(ObjectStateReader& reader) override;
+
     std::string name; ///< Name of client port (optional)
 
     /// The parent session, which links to the server endpoint.
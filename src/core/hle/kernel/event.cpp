@@ -8,6 +8,7 @@
 #include "common/assert.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -52,4 +53,16 @@ void Event::WakeupAllWaitingThreads() {
         signaled = false;
 }
 
+void Event::SaveState(ObjectStateWriter& writer) const {
+    WaitObject::SaveState(writer);
+    writer.Write(reset_type);
+    writer.Write(signaled);
+    writer.WriteString(name);
+}
+
+bool Event::LoadState(ObjectStateReader& reader) {
+    return WaitObject::LoadState(reader) && reader.Read(reset_type) && reader.Read(signaled) &&
+           reader.ReadString(name);
+}
+
 } // namespace Kernel
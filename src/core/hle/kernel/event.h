@@ -39,6 +39,9 @@ public:
     void Signal();
     void Clear();
 
+    void SaveState(ObjectStateWriter& writer) const override;
+    bool LoadState(ObjectStateReader& reader) override;
+
 private:
     explicit Event(KernelSystem& kernel);
     ~Event() override;
@@ -7,6 +7,7 @@
 #include "common/logging/log.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/thread.h"
 
@@ -102,4 +103,26 @@ void HandleTable::Clear() {
     next_free_slot = 0;
 }
 
+void HandleTable::SaveState(ObjectStateWriter& writer) const {
+    writer.Write(generations);
+    writer.Write(next_generation);
+    writer.Write(next_free_slot);
+    for (const auto& object : objects) {
+        writer.WriteObject(object);
+    }
+}
+
+bool HandleTable::LoadState(ObjectStateReader& reader) {
+    if (!reader.Read(generations) || !reader.Read(next_generation) ||
+        !reader.Read(next_free_slot)) {
+        return false;
+    }
+    for (auto& object : objects) {
+        if (!reader.ReadObject(object)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 } // namespace Kernel
@@ -89,6 +89,10 @@ public:
     /// Closes all handles held in this table.
     void Clear();
 
+    /// Writes the handles along with the objects they refer to
+    void SaveState(ObjectStateWriter& writer) const;
+    bool LoadState(ObjectStateReader& reader);
+
 private:
     /**
      * This is the maximum limit of handles allowed per process in CTR-OS. It can be further
@@ -11,6 +11,7 @@
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/process.h"
 
 namespace Kernel {
@@ -32,6 +33,40 @@ void SessionRequestHandler::ClientDisconnected(SharedPtr<ServerSession> server_s
         connected_sessions.end());
 }
 
+std::string SessionRequestHandler::GetStateKey() const {
+    return "";
+}
+
+void SessionRequestHandler::SaveState(ObjectStateWriter& writer) const {
+    writer.Write(static_cast<u32>(connected_sessions.size()));
+    for (const SessionInfo& info : connected_sessions) {
+        writer.WriteObject(info.session);
+        info.data->SaveState(writer);
+    }
+    SaveHandlerState(writer);
+}
+
+bool SessionRequestHandler::LoadState(ObjectStateReader& reader) {
+    u32 session_count;
+    if (!reader.Read(session_count)) {
+        return false;
+    }
+    // The sessions being replaced are disconnected by their client endpoints when they die
+    std::vector<SessionInfo> sessions;
+    for (u32 i = 0; i < session_count; ++i) {
+        SharedPtr<ServerSession> session;
+        if (!reader.ReadObject(session) || session == nullptr) {
+            return false;
+        }
+        sessions.emplace_back(std::move(session), MakeSessionData());
+        if (!sessions.back().data->LoadState(reader)) {
+            return false;
+        }
+    }
+    connected_sessions = std::move(sessions);
+    return LoadHandlerState(reader);
+}
+
 SharedPtr<Event> HLERequestContext::SleepClientThread(SharedPtr<Thread> thread,
                                                       const std::string& reason,
                                                       std::chrono::nanoseconds timeout,
@@ -24,6 +24,8 @@ class ServiceFrameworkBase;
 namespace Kernel {
 
 class HandleTable;
+class ObjectStateReader;
+class ObjectStateWriter;
 class Process;
 class Thread;
 class Event;
@@ -61,13 +63,36 @@ public:
      */
     virtual void ClientDisconnected(SharedPtr<ServerSession> server_session);
 
+    /**
+     * Returns the key that save states refer to the handler with, which the handler factory of an
+     * ObjectStateReader maps back to a handler. Handlers that can't be saved return an empty key.
+     */
+    virtual std::string GetStateKey() const;
+
+    /// Saves the connected sessions along with their data, and the state of the handler
+    void SaveState(ObjectStateWriter& writer) const;
+
+    /// Loads the state saved by SaveState, replacing the connected sessions
+    bool LoadState(ObjectStateReader& reader);
+
     /// Empty placeholder structure for services with no per-session data. The session data classes
     /// in each service must inherit from this.
     struct SessionDataBase {
         virtual ~SessionDataBase() = default;
+
+        virtual void SaveState(ObjectStateWriter& writer) const {}
+        virtual bool LoadState(ObjectStateReader& reader) {
+            return true;
+        }
     };
 
 protected:
+    /// Saves the state of the handler other than its sessions
+    virtual void SaveHandlerState(ObjectStateWriter& writer) const {}
+    virtual bool LoadHandlerState(ObjectStateReader& reader) {
+        return true;
+    }
+
     /// Creates the storage for the session data of the service.
     virtual std::unique_ptr<SessionDataBase> MakeSessionData() const = 0;
 
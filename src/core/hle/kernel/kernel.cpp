@@ -2,13 +2,23 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "common/logging/log.h"
+#include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/client_port.h"
+#include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/config_mem.h"
+#include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/mutex.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/semaphore.h"
+#include "core/hle/kernel/server_port.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/shared_memory.h"
 #include "core/hle/kernel/shared_page.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/timer.h"
@@ -71,8 +81,110 @@ const SharedPage::Handler& KernelSystem::GetSharedPageHandler() const {
     return *shared_page_handler;
 }
 
+ConfigMem::Handler& KernelSystem::GetConfigMemHandler() {
+    return *config_mem_handler;
+}
+
+const ConfigMem::Handler& KernelSystem::GetConfigMemHandler() const {
+    return *config_mem_handler;
+}
+
 void KernelSystem::AddNamedPort(std::string name, SharedPtr<ClientPort> port) {
     named_ports.emplace(std::move(name), std::move(port));
 }
 
+SharedPtr<Object> KernelSystem::CreateBlankObject(HandleType type) {
+    switch (type) {
+    case HandleType::Event:
+        return SharedPtr<Event>(new Event(*this));
+    case HandleType::Mutex:
+        return SharedPtr<Mutex>(new Mutex(*this));
+    case HandleType::SharedMemory:
+        return SharedPtr<SharedMemory>(new SharedMemory(*this));
+    case HandleType::Thread:
+        return SharedPtr<Thread>(new Thread(*this));
+    case HandleType::Process:
+        return SharedPtr<Process>(new Process(*this));
+    case HandleType::AddressArbiter:
+        return SharedPtr<AddressArbiter>(new AddressArbiter(*this));
+    case HandleType::Semaphore:
+        return SharedPtr<Semaphore>(new Semaphore(*this));
+    case HandleType::Timer:
+        return SharedPtr<Timer>(new Timer(*this));
+    case HandleType::ResourceLimit:
+        return SharedPtr<Kernel::ResourceLimit>(new Kernel::ResourceLimit(*this));
+    case HandleType::CodeSet:
+        return SharedPtr<CodeSet>(new CodeSet(*this));
+    case HandleType::ClientPort:
+        return SharedPtr<ClientPort>(new ClientPort(*this));
+    case HandleType::ServerPort:
+        return SharedPtr<ServerPort>(new ServerPort(*this));
+    case HandleType::ClientSession:
+        return SharedPtr<ClientSession>(new ClientSession(*this));
+    case HandleType::ServerSession:
+        return SharedPtr<ServerSession>(new ServerSession(*this));
+    default:
+        LOG_ERROR(Kernel, "Unknown object type {} in save state", static_cast<u32>(type));
+        return nullptr;
+    }
+}
+
+void KernelSystem::SaveState(ObjectStateWriter& writer) const {
+    // The threads go first, as they have to be stopped while the processes they belong to live
+    thread_manager->SaveState(writer);
+    writer.Write(next_process_id);
+    writer.WriteObjects(process_list);
+    writer.WriteObject(current_process);
+    writer.Write(static_cast<u32>(named_ports.size()));
+    for (const auto& [name, port] : named_ports) {
+        writer.WriteString(name);
+        writer.WriteObject(port);
+    }
+    timer_manager->SaveState(writer);
+    resource_limits->SaveState(writer);
+}
+
+bool KernelSystem::LoadState(ObjectStateReader& reader) {
+    u32 named_port_count;
+    if (!thread_manager->LoadState(reader) || !reader.Read(next_process_id) ||
+        !reader.ReadObjects(process_list) || !reader.ReadObject(current_process) ||
+        current_process == nullptr || !reader.Read(named_port_count)) {
+        return false;
+    }
+    named_ports.clear();
+    for (u32 i = 0; i < named_port_count; ++i) {
+        std::string name;
+        SharedPtr<ClientPort> port;
+        if (!reader.ReadString(name) || !reader.ReadObject(port) || port == nullptr) {
+            return false;
+        }
+        named_ports.emplace(std::move(name), std::move(port));
+    }
+    return timer_manager->LoadState(reader) && resource_limits->LoadState(reader);
+}
+
+void KernelSystem::SaveMemoryState(ObjectStateWriter& writer) const {
+    for (const MemoryRegionInfo& region : memory_regions) {
+        writer.Write(region.base);
+        writer.Write(region.size);
+        writer.Write(region.used);
+        writer.WriteIntervalSet(region.free_blocks);
+    }
+    writer.Write(config_mem_handler->GetConfigMem());
+    writer.Write(shared_page_handler->GetSharedPage());
+}
+
+bool KernelSystem::LoadMemoryState(ObjectStateReader& reader) {
+    for (MemoryRegionInfo& region : memory_regions) {
+        u32 base, size;
+        if (!reader.Read(base) || !reader.Read(size) || base != region.base ||
+            size != region.size || !reader.Read(region.used) ||
+            !reader.ReadIntervalSet(region.free_blocks)) {
+            return false;
+        }
+    }
+    return reader.Read(config_mem_handler->GetConfigMem()) &&
+           reader.Read(shared_page_handler->GetSharedPage());
+}
+
 } // namespace Kernel
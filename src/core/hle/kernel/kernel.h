@@ -30,6 +30,7 @@ class MemorySystem;
 namespace Kernel {
 
 class AddressArbiter;
+class Object;
 class Event;
 class Mutex;
 class CodeSet;
@@ -41,6 +42,8 @@ class ClientPort;
 class ServerPort;
 class ClientSession;
 class ServerSession;
+class ObjectStateReader;
+class ObjectStateWriter;
 class ResourceLimitList;
 class SharedMemory;
 class ThreadManager;
@@ -48,6 +51,8 @@ class TimerManager;
 class VMManager;
 struct AddressMapping;
 
+enum class HandleType : u32;
+
 enum class ResetType {
     OneShot,
     Sticky,
@@ -198,6 +203,9 @@ public:
 
     u32 GenerateObjectID();
 
+    /// Creates an object of the type to be loaded from a save state, or null for unknown types
+    SharedPtr<Object> CreateBlankObject(HandleType type);
+
     /// Retrieves a process from the current list of processes.
     SharedPtr<Process> GetProcessById(u32 process_id) const;
 
@@ -215,6 +223,9 @@ public:
     SharedPage::Handler& GetSharedPageHandler();
     const SharedPage::Handler& GetSharedPageHandler() const;
 
+    ConfigMem::Handler& GetConfigMemHandler();
+    const ConfigMem::Handler& GetConfigMemHandler() const;
+
     MemoryRegionInfo* GetMemoryRegion(MemoryRegion region);
 
     void HandleSpecialMapping(VMManager& address_space, const AddressMapping& mapping);
@@ -224,6 +235,28 @@ public:
     /// Adds a port to the named port table
     void AddNamedPort(std::string name, SharedPtr<ClientPort> port);
 
+    /**
+     * Saves what the kernel objects are reached from: the processes, the threads and the scheduler
+     * state, the named ports, the timers and the resource limits. The objects themselves are
+     * written by the writer.
+     */
+    void SaveState(ObjectStateWriter& writer) const;
+
+    /**
+     * Loads the state saved by SaveState, once the reader loaded the objects. The threads that
+     * exist now are stopped, and the other objects die with the last references to them.
+     */
+    bool LoadState(ObjectStateReader& reader);
+
+    /// Saves the allocators of the memory regions, along with the config memory and shared page
+    void SaveMemoryState(ObjectStateWriter& writer) const;
+
+    /**
+     * Loads the state saved by SaveMemoryState. Objects give their memory back to the regions when
+     * they die, so this is loaded once the objects that LoadState replaced are gone.
+     */
+    bool LoadMemoryState(ObjectStateReader& reader);
+
     /// Map of named ports managed by the kernel, which can be retrieved using the ConnectToPort
     std::unordered_map<std::string, SharedPtr<ClientPort>> named_ports;
 
@@ -11,6 +11,7 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/mutex.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -121,4 +122,17 @@ void Mutex::UpdatePriority() {
     }
 }
 
+void Mutex::SaveState(ObjectStateWriter& writer) const {
+    WaitObject::SaveState(writer);
+    writer.Write(lock_count);
+    writer.Write(priority);
+    writer.WriteString(name);
+    writer.WriteObject(holding_thread);
+}
+
+bool Mutex::LoadState(ObjectStateReader& reader) {
+    return WaitObject::LoadState(reader) && reader.Read(lock_count) && reader.Read(priority) &&
+           reader.ReadString(name) && reader.ReadObject(holding_thread);
+}
+
 } // namespace Kernel
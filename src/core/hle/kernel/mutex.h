@@ -52,6 +52,9 @@ public:
      */
     ResultCode Release(Thread* thread);
 
+    void SaveState(ObjectStateWriter& writer) const override;
+    bool LoadState(ObjectStateReader& reader) override;
+
 private:
     explicit Mutex(KernelSystem& kernel);
     ~Mutex() override;
@@ -12,6 +12,8 @@
 namespace Kernel {
 
 class KernelSystem;
+class ObjectStateReader;
+class ObjectStateWriter;
 
 using Handle = u32;
 
@@ -61,6 +63,12 @@ public:
      */
     bool IsWaitable() const;
 
+    /// Writes the contents of the object, the objects it refers to are saved along with it
+    virtual void SaveState(ObjectStateWriter& writer) const = 0;
+
+    /// Restores the contents written by SaveState into a blank object
+    virtual bool LoadState(ObjectStateReader& reader) = 0;
+
 private:
     friend void intrusive_ptr_add_ref(Object*);
     friend void intrusive_ptr_release(Object*);
@@ -0,0 +1,285 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/logging/log.h"
+#include "core/hle/kernel/client_port.h"
+#include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/config_mem.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/object_state.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/session.h"
+#include "core/hle/kernel/shared_page.h"
+#include "core/memory.h"
+
+namespace Kernel {
+
+namespace {
+
+enum class EntryKind : u8 {
+    Object,
+    Handler,
+};
+
+enum class MemoryPointerKind : u8 {
+    Null,
+    Physical,
+    ConfigMem,
+    SharedPage,
+};
+
+template <typename T>
+const u8* BytesOf(T& value) {
+    return reinterpret_cast<const u8*>(&value);
+}
+
+} // Anonymous namespace
+
+ObjectStateWriter::ObjectStateWriter(KernelSystem& kernel) : kernel(kernel) {}
+
+u32 ObjectStateWriter::AddEntry(const Object* object, const SessionRequestHandler* handler) {
+    const void* const key = object != nullptr ? static_cast<const void*>(object) : handler;
+    const auto [it, inserted] = indices.emplace(key, static_cast<u32>(entries.size() + 1));
+    if (inserted) {
+        entries.push_back({object, handler});
+    }
+    return it->second;
+}
+
+void ObjectStateWriter::WriteObject(const Object* object) {
+    Write(object == nullptr ? 0 : AddEntry(object, nullptr));
+}
+
+void ObjectStateWriter::WriteHandler(const SessionRequestHandler* handler) {
+    Write(handler == nullptr ? 0 : AddEntry(nullptr, handler));
+}
+
+void ObjectStateWriter::WriteSession(const std::shared_ptr<Session>& session) {
+    if (session == nullptr) {
+        Write<u32>(0);
+        return;
+    }
+    const auto it =
+        session_indices.emplace(session.get(), static_cast<u32>(session_indices.size() + 1)).first;
+    Write(it->second);
+    // Both endpoints write the whole session, as the roots are written before the objects but
+    // loaded after them
+    WriteObject(session->client);
+    WriteObject(session->server);
+    WriteObject(session->port);
+}
+
+void ObjectStateWriter::WriteMemoryPointer(const u8* pointer) {
+    const u8* const config_mem = BytesOf(kernel.GetConfigMemHandler().GetConfigMem());
+    const u8* const shared_page = BytesOf(kernel.GetSharedPageHandler().GetSharedPage());
+    if (pointer == nullptr) {
+        Write(MemoryPointerKind::Null);
+    } else if (pointer >= config_mem && pointer <= config_mem + sizeof(ConfigMem::ConfigMemDef)) {
+        Write(MemoryPointerKind::ConfigMem);
+        Write(static_cast<u32>(pointer - config_mem));
+    } else if (pointer >= shared_page &&
+               pointer <= shared_page + sizeof(SharedPage::SharedPageDef)) {
+        Write(MemoryPointerKind::SharedPage);
+        Write(static_cast<u32>(pointer - shared_page));
+    } else if (const auto address = kernel.memory.GetPhysicalAddress(pointer)) {
+        Write(MemoryPointerKind::Physical);
+        Write(*address);
+    } else {
+        Refuse("memory outside of the emulated RAM is mapped");
+        Write(MemoryPointerKind::Null);
+    }
+}
+
+void ObjectStateWriter::WriteIntervalSet(const MemoryRegionInfo::IntervalSet& intervals) {
+    Write(static_cast<u32>(intervals.iterative_size()));
+    for (const auto& interval : intervals) {
+        Write(interval.lower());
+        Write(interval.upper());
+    }
+}
+
+bool ObjectStateWriter::MarkSharedState(const void* state) {
+    const bool first = saved_shared_states.insert(state).second;
+    Write(first);
+    return first;
+}
+
+void ObjectStateWriter::Refuse(const std::string& reason) {
+    LOG_ERROR(Kernel, "Unable to save the kernel objects: {}", reason);
+    refused = true;
+}
+
+std::optional<std::vector<u8>> ObjectStateWriter::Finish() {
+    std::vector<u8> roots = TakeData();
+    // Saving an entry may queue more of them
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].object != nullptr) {
+            entries[i].object->SaveState(*this);
+        } else {
+            entries[i].handler->SaveState(*this);
+        }
+    }
+    std::vector<u8> contents = TakeData();
+
+    Write(static_cast<u32>(entries.size()));
+    for (const Entry& entry : entries) {
+        if (entry.object != nullptr) {
+            Write(EntryKind::Object);
+            Write(entry.object->GetHandleType());
+            continue;
+        }
+        const std::string key = entry.handler->GetStateKey();
+        if (key.empty()) {
+            Refuse("a session to an HLE handler that can't be saved is open");
+        }
+        Write(EntryKind::Handler);
+        WriteString(key);
+    }
+    WriteBytes(contents.data(), contents.size());
+    WriteBytes(roots.data(), roots.size());
+
+    if (refused) {
+        return {};
+    }
+    return TakeData();
+}
+
+ObjectStateReader::ObjectStateReader(const std::vector<u8>& data, KernelSystem& kernel,
+                                     HandlerFactory handler_factory)
+    : StateReader(data), kernel(kernel), handler_factory(std::move(handler_factory)) {}
+
+bool ObjectStateReader::LoadObjects() {
+    u32 count;
+    if (!Read(count)) {
+        return false;
+    }
+    objects.resize(count);
+    handlers.resize(count);
+    for (u32 i = 0; i < count; ++i) {
+        EntryKind kind;
+        if (!Read(kind)) {
+            return false;
+        }
+        if (kind == EntryKind::Object) {
+            HandleType type;
+            if (!Read(type) || (objects[i] = kernel.CreateBlankObject(type)) == nullptr) {
+                return false;
+            }
+            continue;
+        }
+        std::string key;
+        if (kind != EntryKind::Handler || !ReadString(key)) {
+            return false;
+        }
+        handlers[i] = handler_factory(key);
+        if (handlers[i] == nullptr) {
+            LOG_ERROR(Kernel, "Unknown HLE handler {} in save state", key);
+            return false;
+        }
+    }
+
+    for (u32 i = 0; i < count; ++i) {
+        if (objects[i] != nullptr ? !objects[i]->LoadState(*this)
+                                  : !handlers[i]->LoadState(*this)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ObjectStateReader::ReadObject(SharedPtr<Object>& object) {
+    u32 index;
+    if (!Read(index) || index > objects.size() ||
+        (index != 0 && objects[index - 1] == nullptr)) {
+        return false;
+    }
+    object = index == 0 ? nullptr : objects[index - 1];
+    return true;
+}
+
+bool ObjectStateReader::ReadHandler(std::shared_ptr<SessionRequestHandler>& handler) {
+    u32 index;
+    if (!Read(index) || index > handlers.size() ||
+        (index != 0 && handlers[index - 1] == nullptr)) {
+        return false;
+    }
+    handler = index == 0 ? nullptr : handlers[index - 1];
+    return true;
+}
+
+bool ObjectStateReader::ReadSession(std::shared_ptr<Session>& session) {
+    u32 index;
+    if (!Read(index) || index > sessions.size() + 1) {
+        return false;
+    }
+    if (index == 0) {
+        session = nullptr;
+        return true;
+    }
+
+    ClientSession* client;
+    ServerSession* server;
+    SharedPtr<ClientPort> port;
+    if (!ReadObject(client) || !ReadObject(server) || !ReadObject(port)) {
+        return false;
+    }
+    if (index == sessions.size() + 1) {
+        sessions.push_back(std::make_shared<Session>());
+        sessions.back()->client = client;
+        sessions.back()->server = server;
+        sessions.back()->port = std::move(port);
+    }
+    session = sessions[index - 1];
+    return true;
+}
+
+bool ObjectStateReader::ReadMemoryPointer(u8*& pointer) {
+    MemoryPointerKind kind;
+    u32 offset;
+    if (!Read(kind)) {
+        return false;
+    }
+    switch (kind) {
+    case MemoryPointerKind::Null:
+        pointer = nullptr;
+        return true;
+    case MemoryPointerKind::Physical:
+        if (!Read(offset)) {
+            return false;
+        }
+        pointer = kernel.memory.GetPhysicalPointer(offset);
+        return pointer != nullptr;
+    case MemoryPointerKind::ConfigMem:
+        if (!Read(offset) || offset > sizeof(ConfigMem::ConfigMemDef)) {
+            return false;
+        }
+        pointer = reinterpret_cast<u8*>(&kernel.GetConfigMemHandler().GetConfigMem()) + offset;
+        return true;
+    case MemoryPointerKind::SharedPage:
+        if (!Read(offset) || offset > sizeof(SharedPage::SharedPageDef)) {
+            return false;
+        }
+        pointer = reinterpret_cast<u8*>(&kernel.GetSharedPageHandler().GetSharedPage()) + offset;
+        return true;
+    }
+    return false;
+}
+
+bool ObjectStateReader::ReadIntervalSet(MemoryRegionInfo::IntervalSet& intervals) {
+    u32 count;
+    if (!Read(count)) {
+        return false;
+    }
+    intervals.clear();
+    for (u32 i = 0; i < count; ++i) {
+        u32 lower, upper;
+        if (!Read(lower) || !Read(upper) || lower >= upper) {
+            return false;
+        }
+        intervals += MemoryRegionInfo::Interval(lower, upper);
+    }
+    return true;
+}
+
+} // namespace Kernel
@@ -0,0 +1,201 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "common/common_types.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/object.h"
+#include "core/savestate.h"
+
+namespace Kernel {
+
+class Session;
+class SessionRequestHandler;
+
+/**
+ * Writes the kernel objects and the HLE handlers of their sessions along with the values that
+ * refer to them. References are written as indices: the objects and handlers they point to are
+ * queued, and each one of them is written once by Finish, which in turn may queue more. The
+ * values the caller writes before calling Finish are the roots that the objects are reached from.
+ *
+ * Anything that can't be saved, such as a thread paused by an HLE handler, refuses the whole state.
+ */
+class ObjectStateWriter : public Core::StateWriter {
+public:
+    explicit ObjectStateWriter(KernelSystem& kernel);
+
+    /// Writes a reference to an object, which may be null
+    void WriteObject(const Object* object);
+
+    template <typename T>
+    void WriteObject(const SharedPtr<T>& object) {
+        WriteObject(object.get());
+    }
+
+    template <typename Objects>
+    void WriteObjects(const Objects& objects) {
+        Write(static_cast<u32>(objects.size()));
+        for (const auto& object : objects) {
+            WriteObject(object);
+        }
+    }
+
+    /// Writes a reference to an HLE handler, which may be null
+    void WriteHandler(const SessionRequestHandler* handler);
+
+    template <typename T>
+    void WriteHandler(const std::shared_ptr<T>& handler) {
+        WriteHandler(handler.get());
+    }
+
+    /// Writes the parent of a session endpoint, along with the endpoints the first time
+    void WriteSession(const std::shared_ptr<Session>& session);
+
+    /**
+     * Writes a pointer into emulated memory: FCRAM, VRAM, DSP RAM, the N3DS extra RAM, the config
+     * memory or the shared page. Other pointers refuse the state.
+     */
+    void WriteMemoryPointer(const u8* pointer);
+
+    void WriteIntervalSet(const MemoryRegionInfo::IntervalSet& intervals);
+
+    /**
+     * Writes whether state shared by several handlers, such as the module behind the interfaces of
+     * a service, follows. That is only the case for the first handler that writes it.
+     * @returns True if the caller must write the state
+     */
+    bool MarkSharedState(const void* state);
+
+    /// Refuses the state, the reason is logged
+    void Refuse(const std::string& reason);
+
+    /**
+     * Writes the queued objects and handlers, then assembles the state: the table of the objects
+     * and handlers, their contents, and the roots.
+     * @returns Nothing if the state was refused
+     */
+    std::optional<std::vector<u8>> Finish();
+
+private:
+    struct Entry {
+        const Object* object;
+        const SessionRequestHandler* handler;
+    };
+
+    u32 AddEntry(const Object* object, const SessionRequestHandler* handler);
+
+    KernelSystem& kernel;
+    std::vector<Entry> entries;
+    /// Indices are shared by objects and handlers, and start at 1 as 0 is a null reference
+    std::unordered_map<const void*, u32> indices;
+    std::unordered_map<const Session*, u32> session_indices;
+    std::unordered_set<const void*> saved_shared_states;
+    bool refused = false;
+};
+
+/**
+ * Reads the state assembled by an ObjectStateWriter. LoadObjects creates an object or looks up a
+ * handler for every entry of the table, then loads them, after which the roots can be read.
+ */
+class ObjectStateReader : public Core::StateReader {
+public:
+    /// Returns the handler saved with the key, or null if there is none
+    using HandlerFactory =
+        std::function<std::shared_ptr<SessionRequestHandler>(const std::string& key)>;
+
+    ObjectStateReader(const std::vector<u8>& data, KernelSystem& kernel,
+                      HandlerFactory handler_factory);
+
+    /// Creates and loads the objects and handlers of the state
+    bool LoadObjects();
+
+    bool ReadObject(SharedPtr<Object>& object);
+
+    /// Reads a reference to an object, which must be of type T if it is not null
+    template <typename T>
+    bool ReadObject(SharedPtr<T>& object) {
+        SharedPtr<Object> generic;
+        if (!ReadObject(generic)) {
+            return false;
+        }
+        object = DynamicObjectCast<T>(generic);
+        return object != nullptr || generic == nullptr;
+    }
+
+    template <typename T>
+    bool ReadObject(T*& object) {
+        SharedPtr<T> shared;
+        if (!ReadObject(shared)) {
+            return false;
+        }
+        object = shared.get();
+        return true;
+    }
+
+    /// Reads the references written by WriteObjects
+    template <typename Objects>
+    bool ReadObjects(Objects& objects) {
+        u32 count;
+        if (!Read(count)) {
+            return false;
+        }
+        objects.clear();
+        for (u32 i = 0; i < count; ++i) {
+            typename Objects::value_type object;
+            if (!ReadObject(object)) {
+                return false;
+            }
+            objects.insert(objects.end(), std::move(object));
+        }
+        return true;
+    }
+
+    /// Reads the mark written by MarkSharedState, then loads the state with the callback if set
+    template <typename Load>
+    bool ReadSharedState(Load&& load) {
+        bool saved;
+        return Read(saved) && (!saved || load());
+    }
+
+    bool ReadHandler(std::shared_ptr<SessionRequestHandler>& handler);
+
+    /// Reads a reference to a handler, which must be of type T if it is not null
+    template <typename T>
+    bool ReadHandler(std::shared_ptr<T>& handler) {
+        std::shared_ptr<SessionRequestHandler> generic;
+        if (!ReadHandler(generic)) {
+            return false;
+        }
+        handler = std::dynamic_pointer_cast<T>(generic);
+        return handler != nullptr || generic == nullptr;
+    }
+
+    bool ReadSession(std::shared_ptr<Session>& session);
+
+    bool ReadMemoryPointer(u8*& pointer);
+
+    bool ReadIntervalSet(MemoryRegionInfo::IntervalSet& intervals);
+
+    KernelSystem& GetKernel() {
+        return kernel;
+    }
+
+private:
+    KernelSystem& kernel;
+    HandlerFactory handler_factory;
+    std::vector<SharedPtr<Object>> objects;
+    std::vector<std::shared_ptr<SessionRequestHandler>> handlers;
+    std::vector<std::shared_ptr<Session>> sessions;
+};
+
+} // namespace Kernel
@@ -9,6 +9,7 @@
 #include "common/logging/log.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
 #include "core/hle/kernel/thread.h"
@@ -420,4 +421,98 @@ SharedPtr<Process> KernelSystem::GetProcessById(u32 process_id) const {
 
     return *itr;
 }
+void CodeSet::SaveState(ObjectStateWriter& writer) const {
+    // The code itself is only needed to start the process
+    writer.Write(segments);
+    writer.Write(entrypoint);
+    writer.WriteString(name);
+    writer.Write(program_id);
+}
+
+bool CodeSet::LoadState(ObjectStateReader& reader) {
+    return reader.Read(segments) && reader.Read(entrypoint) && reader.ReadString(name) &&
+           reader.Read(program_id);
+}
+
+namespace {
+
+/// Saved instead of the index of the memory region of a process that has none
+constexpr u8 NoMemoryRegion = 0xFF;
+
+} // Anonymous namespace
+
+void Process::SaveState(ObjectStateWriter& writer) const {
+    handle_table.SaveState(writer);
+    writer.WriteObject(codeset);
+    writer.WriteObject(resource_limit);
+    std::array<u8, 0x80 / 8> svc_access_bits{};
+    for (std::size_t i = 0; i < svc_access_mask.size(); ++i) {
+        svc_access_bits[i / 8] |= svc_access_mask[i] << (i % 8);
+    }
+    writer.Write(svc_access_bits);
+    writer.Write(handle_table_size);
+    writer.Write(static_cast<u32>(address_mappings.size()));
+    for (const AddressMapping& mapping : address_mappings) {
+        writer.Write(mapping);
+    }
+    writer.Write(flags.raw);
+    writer.Write(kernel_version);
+    writer.Write(ideal_processor);
+    writer.Write(status);
+    writer.Write(process_id);
+    vm_manager.SaveState(writer);
+    writer.Write(memory_used);
+    writer.Write(memory_region == nullptr
+                     ? NoMemoryRegion
+                     : static_cast<u8>(memory_region - kernel.memory_regions.data()));
+    writer.Write(static_cast<u32>(tls_slots.size()));
+    for (const auto& slots : tls_slots) {
+        writer.Write(static_cast<u8>(slots.to_ulong()));
+    }
+}
+
+bool Process::LoadState(ObjectStateReader& reader) {
+    std::array<u8, 0x80 / 8> svc_access_bits;
+    u32 mapping_count;
+    if (!handle_table.LoadState(reader) || !reader.ReadObject(codeset) || codeset == nullptr ||
+        !reader.ReadObject(resource_limit) || !reader.Read(svc_access_bits) ||
+        !reader.Read(handle_table_size) || !reader.Read(mapping_count) ||
+        mapping_count > address_mappings.capacity()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < svc_access_mask.size(); ++i) {
+        svc_access_mask[i] = (svc_access_bits[i / 8] >> (i % 8)) & 1;
+    }
+    address_mappings.clear();
+    for (u32 i = 0; i < mapping_count; ++i) {
+        AddressMapping mapping;
+        if (!reader.Read(mapping)) {
+            return false;
+        }
+        address_mappings.push_back(mapping);
+    }
+
+    u8 region_index;
+    u32 tls_page_count;
+    if (!reader.Read(flags.raw) || !reader.Read(kernel_version) ||
+        !reader.Read(ideal_processor) || !reader.Read(status) || !reader.Read(process_id) ||
+        !vm_manager.LoadState(reader) || !reader.Read(memory_used) ||
+        !reader.Read(region_index) ||
+        (region_index != NoMemoryRegion && region_index >= kernel.memory_regions.size()) ||
+        !reader.Read(tls_page_count)) {
+        return false;
+    }
+    memory_region =
+        region_index == NoMemoryRegion ? nullptr : &kernel.memory_regions[region_index];
+    tls_slots.clear();
+    for (u32 i = 0; i < tls_page_count; ++i) {
+        u8 slots;
+        if (!reader.Read(slots)) {
+            return false;
+        }
+        tls_slots.emplace_back(slots);
+    }
+    return true;
+}
+
 } // namespace Kernel
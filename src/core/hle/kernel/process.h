@@ -104,6 +104,9 @@ public:
     /// Title ID corresponding to the process
     u64 program_id;
 
+    void SaveState(ObjectStateWriter& writer) const override;
+    bool LoadState(ObjectStateReader& reader) override;
+
 private:
     explicit CodeSet(KernelSystem& kernel);
     ~CodeSet() override;
@@ -193,6 +196,9 @@ public:
     ResultCode Unmap(VAddr target, VAddr source, u32 size, VMAPermission perms,
                      bool privileged = false);
 
+    void SaveState(ObjectStateWriter& writer) const override;
+    bool LoadState(ObjectStateReader& reader) override;
+
 private:
     explicit Process(Kernel::KernelSystem& kernel);
     ~Process() override;
@@ -5,6 +5,7 @@
 #include <cstring>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/resource_limit.h"
 
 namespace Kernel {
@@ -149,4 +150,65 @@ ResourceLimitList::ResourceLimitList(KernelSystem& kernel) {
 
 ResourceLimitList::~ResourceLimitList() = default;
 
+namespace {
+
+/// The values of a resource limit, in the order they are saved
+constexpr std::array<s32 ResourceLimit::*, 19> StateValues{{
+    &ResourceLimit::max_priority,
+    &ResourceLimit::max_commit,
+    &ResourceLimit::max_threads,
+    &ResourceLimit::max_events,
+    &ResourceLimit::max_mutexes,
+    &ResourceLimit::max_semaphores,
+    &ResourceLimit::max_timers,
+    &ResourceLimit::max_shared_mems,
+    &ResourceLimit::max_address_arbiters,
+    &ResourceLimit::max_cpu_time,
+    &ResourceLimit::current_commit,
+    &ResourceLimit::current_threads,
+    &ResourceLimit::current_events,
+    &ResourceLimit::current_mutexes,
+    &ResourceLimit::current_semaphores,
+    &ResourceLimit::current_timers,
+    &ResourceLimit::current_shared_mems,
+    &ResourceLimit::current_address_arbiters,
+    &ResourceLimit::current_cpu_time,
+}};
+
+} // Anonymous namespace
+
+void ResourceLimit::SaveState(ObjectStateWriter& writer) const {
+    writer.WriteString(name);
+    for (const auto value : StateValues) {
+        writer.Write(this->*value);
+    }
+}
+
+bool ResourceLimit::LoadState(ObjectStateReader& reader) {
+    if (!reader.ReadString(name)) {
+        return false;
+    }
+    for (const auto value : StateValues) {
+        if (!reader.Read(this->*value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ResourceLimitList::SaveState(ObjectStateWriter& writer) const {
+    for (const auto& resource_limit : resource_limits) {
+        writer.WriteObject(resource_limit);
+    }
+}
+
+bool ResourceLimitList::LoadState(ObjectStateReader& reader) {
+    for (auto& resource_limit : resource_limits) {
+        if (!reader.ReadObject(resource_limit) || resource_limit == nullptr) {
+            return false;
+        }
+    }
+    return true;
+}
+
 } // namespace Kernel
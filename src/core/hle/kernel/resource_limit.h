@@ -63,6 +63,9 @@ public:
      */
     u32 GetMaxResourceValue(u32 resource) const;
 
+    void SaveState(ObjectStateWriter& writer) const override;
+    bool LoadState(ObjectStateReader& reader) override;
+
     /// Name of resource limit object.
     std::string name;
 
@@ -109,6 +112,8 @@ public:
 private:
     explicit ResourceLimit(KernelSystem& kernel);
     ~ResourceLimit() override;
+
+    friend class KernelSystem;
 };
 
 class ResourceLimitList {
@@ -123,6 +128,9 @@ public:
      */
     SharedPtr<ResourceLimit> GetForCategory(ResourceLimitCategory category);
 
+    void SaveState(ObjectStateWriter& writer) const;
+    bool LoadState(ObjectStateReader& reader);
+
 private:
     std::array<SharedPtr<ResourceLimit>, 4> resource_limits;
 };
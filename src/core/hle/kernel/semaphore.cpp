@@ -5,6 +5,7 @@
 #include "common/assert.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/semaphore.h"
 #include "core/hle/kernel/thread.h"
 
@@ -52,4 +53,16 @@ ResultVal<s32> Semaphore::Release(s32 release_count) {
     return MakeResult<s32>(previous_count);
 }
 
+void Semaphore::SaveState(ObjectStateWriter& writer) const {
+    WaitObject::SaveState(writer);
+    writer.Write(max_count);
+    writer.Write(available_count);
+    writer.WriteString(name);
+}
+
+bool Semaphore::LoadState(ObjectStateReader& reader) {
+    return WaitObject::LoadState(reader) && reader.Read(max_count) &&
+           reader.Read(available_count) && reader.ReadString(name);
+}
+
 } // namespace Kernel
@@ -41,6 +41,9 @@ public:
      */
     ResultVal<s32> Release(s32 release_count);
 
+    void SaveState(ObjectStateWriter& writer) const override;
+    bool LoadState(ObjectStateReader& reader) override;
+
 private:
     explicit Semaphore(KernelSystem& kernel);
     ~Semaphore() override;
@@ -7,6 +7,7 @@
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/server_port.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/kernel/thread.h"
@@ -50,4 +51,16 @@ std::tuple<SharedPtr<ServerPort>, SharedPtr<ClientPort>> KernelSystem::CreatePor
     return std::make_tuple(std::move(server_port), std::move(client_port));
 }
 
+void ServerPort::SaveState(ObjectStateWriter& writer) const {
+    WaitObject::SaveState(writer);
+    writer.WriteString(name);
+    writer.WriteObjects(pending_sessions);
+    writer.WriteHandler(hle_handler);
+}
+
+bool ServerPort::LoadState(ObjectStateReader& reader) {
+    return WaitObject::LoadState(reader) && reader.ReadString(name) &&
+           reader.ReadObjects(pending_sessions) && reader.ReadHandler(hle_handler);
+}
+
 } // namespace Kernel
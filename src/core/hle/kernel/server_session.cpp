@@ -7,6 +7,7 @@
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/kernel/session.h"
 #include "core/hle/kernel/thread.h"
@@ -18,6 +19,11 @@ ServerSession::~ServerSession() {
     // This destructor will be called automatically when the last ServerSession handle is closed by
     // the emulated application.
 
+    // Blank sessions that a save state failed to load have no parent
+    if (parent == nullptr) {
+        return;
+    }
+
     // Decrease the port's connection count.
     if (parent->port)
         parent->port->ConnectionClosed();
@@ -117,4 +123,22 @@ std::tuple<SharedPtr<ServerSession>, SharedPtr<ClientSession>> KernelSystem::Cre
     return std::make_tuple(std::move(server_session), std::move(client_session));
 }
 
+void ServerSession::SaveState(ObjectStateWriter& writer) const {
+    if (!mapped_buffer_context.empty()) {
+        writer.Refuse("an IPC request with mapped buffers is being handled");
+    }
+    WaitObject::SaveState(writer);
+    writer.WriteString(name);
+    writer.WriteSession(parent);
+    writer.WriteHandler(hle_handler);
+    writer.WriteObjects(pending_requesting_threads);
+    writer.WriteObject(currently_handling);
+}
+
+bool ServerSession::LoadState(ObjectStateReader& reader) {
+    return WaitObject::LoadState(reader) && reader.ReadString(name) &&
+           reader.ReadSession(parent) && parent != nullptr && reader.ReadHandler(hle_handler) &&
+           reader.ReadObjects(pending_requesting_threads) && reader.ReadObject(currently_handling);
+}
+
 } // namespace Kernel
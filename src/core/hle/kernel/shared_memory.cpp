@@ -6,6 +6,7 @@
 #include "common/logging/log.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/memory.h"
 
@@ -203,4 +204,39 @@ const u8* SharedMemory::GetPointer(u32 offset) const {
     return backing_blocks[0].first + offset;
 }
 
+void SharedMemory::SaveState(ObjectStateWriter& writer) const {
+    writer.Write(linear_heap_phys_offset);
+    writer.Write(static_cast<u32>(backing_blocks.size()));
+    for (const auto& [pointer, block_size] : backing_blocks) {
+        writer.WriteMemoryPointer(pointer);
+        writer.Write(block_size);
+    }
+    writer.Write(size);
+    writer.Write(permissions);
+    writer.Write(other_permissions);
+    writer.WriteObject(owner_process);
+    writer.Write(base_address);
+    writer.WriteString(name);
+    writer.WriteIntervalSet(holding_memory);
+}
+
+bool SharedMemory::LoadState(ObjectStateReader& reader) {
+    u32 block_count;
+    if (!reader.Read(linear_heap_phys_offset) || !reader.Read(block_count)) {
+        return false;
+    }
+    backing_blocks.clear();
+    for (u32 i = 0; i < block_count; ++i) {
+        u8* pointer;
+        u32 block_size;
+        if (!reader.ReadMemoryPointer(pointer) || !reader.Read(block_size)) {
+            return false;
+        }
+        backing_blocks.emplace_back(pointer, block_size);
+    }
+    return reader.Read(size) && reader.Read(permissions) && reader.Read(other_permissions) &&
+           reader.ReadObject(owner_process) && reader.Read(base_address) &&
+           reader.ReadString(name) && reader.ReadIntervalSet(holding_memory);
+}
+
 } // namespace Kernel
@@ -64,6 +64,9 @@ public:
      */
     ResultCode Unmap(Process& target_process, VAddr address);
 
+    void SaveState(ObjectStateWriter& writer) const override;
+    bool LoadState(ObjectStateReader& reader) override;
+
     /**
      * Gets a pointer to the shared memory block
      * @param offset Offset from the start of the shared memory block to get pointer
@@ -3,9 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <cinttypes>
 #include <map>
 #include <fmt/format.h>
+#include "common/counters.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
@@ -395,6 +397,103 @@ ResultCode SVC::CloseHandle(Handle handle) {
     return kernel.GetCurrentProcess()->handle_table.Close(handle);
 }
 
+static ResultCode ReceiveIPCRequest(SharedPtr<ServerSession> server_session,
+                                    SharedPtr<Thread> thread) {
+    if (server_session->parent->client == nullptr) {
+        return ERR_SESSION_CLOSED_BY_REMOTE;
+    }
+
+    VAddr target_address = thread->GetCommandBufferAddress();
+    VAddr source_address = server_session->currently_handling->GetCommandBufferAddress();
+
+    ResultCode translation_result =
+        TranslateCommandBuffer(server_session->currently_handling, thread, source_address,
+                               target_address, server_session->mapped_buffer_context, false);
+
+    // If a translation error occurred, immediately resume the client thread.
+    if (translation_result.IsError()) {
+        // Set the output of SendSyncRequest in the client thread to the translation output.
+        server_session->currently_handling->SetWaitSynchronizationResult(translation_result);
+
+        server_session->currently_handling->ResumeFromWait();
+        server_session->currently_handling = nullptr;
+
+        // TODO(Subv): This path should try to wait again on the same objects.
+        ASSERT_MSG(false, "ReplyAndReceive translation error behavior unimplemented");
+    }
+
+    return translation_result;
+}
+
+static void WaitSynchronization1Wakeup(ThreadWakeupReason reason, SharedPtr<Thread> thread,
+                                        SharedPtr<WaitObject> object) {
+    ASSERT(thread->status == ThreadStatus::WaitSynchAny);
+
+    if (reason == ThreadWakeupReason::Timeout) {
+        thread->SetWaitSynchronizationResult(RESULT_TIMEOUT);
+        return;
+    }
+
+    ASSERT(reason == ThreadWakeupReason::Signal);
+    thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
+
+    // WaitSynchronization1 doesn't have an output index like WaitSynchronizationN, so we
+    // don't have to do anything else here.
+}
+
+static void WaitSynchronizationAllWakeup(ThreadWakeupReason reason, SharedPtr<Thread> thread,
+                                          SharedPtr<WaitObject> object) {
+    ASSERT(thread->status == ThreadStatus::WaitSynchAll);
+
+    if (reason == ThreadWakeupReason::Timeout) {
+        thread->SetWaitSynchronizationResult(RESULT_TIMEOUT);
+        return;
+    }
+
+    ASSERT(reason == ThreadWakeupReason::Signal);
+
+    thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
+    // The wait_all case does not update the output index.
+}
+
+static void WaitSynchronizationAnyWakeup(ThreadWakeupReason reason, SharedPtr<Thread> thread,
+                                          SharedPtr<WaitObject> object) {
+    ASSERT(thread->status == ThreadStatus::WaitSynchAny);
+
+    if (reason == ThreadWakeupReason::Timeout) {
+        thread->SetWaitSynchronizationResult(RESULT_TIMEOUT);
+        return;
+    }
+
+    ASSERT(reason == ThreadWakeupReason::Signal);
+
+    thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
+    thread->SetWaitSynchronizationOutput(thread->GetWaitObjectIndex(object.get()));
+}
+
+static void ReplyAndReceiveWakeup(ThreadWakeupReason reason, SharedPtr<Thread> thread,
+                                   SharedPtr<WaitObject> object) {
+    ASSERT(thread->status == ThreadStatus::WaitSynchAny);
+    ASSERT(reason == ThreadWakeupReason::Signal);
+
+    ResultCode result = RESULT_SUCCESS;
+
+    if (object->GetHandleType() == HandleType::ServerSession) {
+        auto server_session = DynamicObjectCast<ServerSession>(object);
+        result = ReceiveIPCRequest(server_session, thread);
+    }
+
+    thread->SetWaitSynchronizationResult(result);
+    thread->SetWaitSynchronizationOutput(thread->GetWaitObjectIndex(object.get()));
+}
+
+const std::array<Thread::WakeupCallback*, 4>& GetSvcWakeupCallbacks() {
+    static constexpr std::array<Thread::WakeupCallback*, 4> callbacks{
+        WaitSynchronization1Wakeup, WaitSynchronizationAllWakeup, WaitSynchronizationAnyWakeup,
+        ReplyAndReceiveWakeup};
+    return callbacks;
+}
+
 /// Wait for a handle to synchronize, timeout after the specified nanoseconds
 ResultCode SVC::WaitSynchronization1(Handle handle, s64 nano_seconds) {
     auto object = kernel.GetCurrentProcess()->handle_table.Get<WaitObject>(handle);
@@ -418,21 +517,7 @@ ResultCode SVC::WaitSynchronization1(Handle handle, s64 nano_seconds) {
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
 
-        thread->wakeup_callback = [](ThreadWakeupReason reason, SharedPtr<Thread> thread,
-                                     SharedPtr<WaitObject> object) {
-            ASSERT(thread->status == ThreadStatus::WaitSynchAny);
-
-            if (reason == ThreadWakeupReason::Timeout) {
-                thread->SetWaitSynchronizationResult(RESULT_TIMEOUT);
-                return;
-            }
-
-            ASSERT(reason == ThreadWakeupReason::Signal);
-            thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
-
-            // WaitSynchronization1 doesn't have an output index like WaitSynchronizationN, so we
-            // don't have to do anything else here.
-        };
+        thread->wakeup_callback = WaitSynchronization1Wakeup;
 
         system.PrepareReschedule();
 
@@ -507,20 +592,7 @@ ResultCode SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
 
-        thread->wakeup_callback = [](ThreadWakeupReason reason, SharedPtr<Thread> thread,
-                                     SharedPtr<WaitObject> object) {
-            ASSERT(thread->status == ThreadStatus::WaitSynchAll);
-
-            if (reason == ThreadWakeupReason::Timeout) {
-                thread->SetWaitSynchronizationResult(RESULT_TIMEOUT);
-                return;
-            }
-
-            ASSERT(reason == ThreadWakeupReason::Signal);
-
-            thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
-            // The wait_all case does not update the output index.
-        };
+        thread->wakeup_callback = WaitSynchronizationAllWakeup;
 
         system.PrepareReschedule();
 
@@ -567,20 +639,7 @@ ResultCode SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
 
-        thread->wakeup_callback = [](ThreadWakeupReason reason, SharedPtr<Thread> thread,
-                                     SharedPtr<WaitObject> object) {
-            ASSERT(thread->status == ThreadStatus::WaitSynchAny);
-
-            if (reason == ThreadWakeupReason::Timeout) {
-                thread->SetWaitSynchronizationResult(RESULT_TIMEOUT);
-                return;
-            }
-
-            ASSERT(reason == ThreadWakeupReason::Signal);
-
-            thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
-            thread->SetWaitSynchronizationOutput(thread->GetWaitObjectIndex(object.get()));
-        };
+        thread->wakeup_callback = WaitSynchronizationAnyWakeup;
 
         system.PrepareReschedule();
 
@@ -592,34 +651,6 @@ ResultCode SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle
     }
 }
 
-static ResultCode ReceiveIPCRequest(SharedPtr<ServerSession> server_session,
-                                    SharedPtr<Thread> thread) {
-    if (server_session->parent->client == nullptr) {
-        return ERR_SESSION_CLOSED_BY_REMOTE;
-    }
-
-    VAddr target_address = thread->GetCommandBufferAddress();
-    VAddr source_address = server_session->currently_handling->GetCommandBufferAddress();
-
-    ResultCode translation_result =
-        TranslateCommandBuffer(server_session->currently_handling, thread, source_address,
-                               target_address, server_session->mapped_buffer_context, false);
-
-    // If a translation error occurred, immediately resume the client thread.
-    if (translation_result.IsError()) {
-        // Set the output of SendSyncRequest in the client thread to the translation output.
-        server_session->currently_handling->SetWaitSynchronizationResult(translation_result);
-
-        server_session->currently_handling->ResumeFromWait();
-        server_session->currently_handling = nullptr;
-
-        // TODO(Subv): This path should try to wait again on the same objects.
-        ASSERT_MSG(false, "ReplyAndReceive translation error behavior unimplemented");
-    }
-
-    return translation_result;
-}
-
 /// In a single operation, sends a IPC reply and waits for a new request.
 ResultCode SVC::ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_count,
                                 Handle reply_target) {
@@ -721,21 +752,7 @@ ResultCode SVC::ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_co
 
     thread->wait_objects = std::move(objects);
 
-    thread->wakeup_callback = [](ThreadWakeupReason reason, SharedPtr<Thread> thread,
-                                 SharedPtr<WaitObject> object) {
-        ASSERT(thread->status == ThreadStatus::WaitSynchAny);
-        ASSERT(reason == ThreadWakeupReason::Signal);
-
-        ResultCode result = RESULT_SUCCESS;
-
-        if (object->GetHandleType() == HandleType::ServerSession) {
-            auto server_session = DynamicObjectCast<ServerSession>(object);
-            result = ReceiveIPCRequest(server_session, thread);
-        }
-
-        thread->SetWaitSynchronizationResult(result);
-        thread->SetWaitSynchronizationOutput(thread->GetWaitObjectIndex(object.get()));
-    };
+    thread->wakeup_callback = ReplyAndReceiveWakeup;
 
     system.PrepareReschedule();
 
@@ -1575,8 +1592,19 @@ void SVC::CallSVC(u32 immediate) {
     DEBUG_ASSERT_MSG(kernel.GetCurrentProcess()->status == ProcessStatus::Running,
                      "Running threads from exiting processes is unimplemented");
 
+    static const auto svc_counters = [] {
+        std::array<Common::Counters::Counter, ARRAY_SIZE(SVC_Table)> counters;
+        for (std::size_t i = 0; i < counters.size(); ++i) {
+            counters[i] = Common::Counters::Register(
+                "citra_svc_calls_total", "Supervisor calls made by the emulated application",
+                {{"svc", SVC_Table[i].name}});
+        }
+        return counters;
+    }();
+
     const FunctionDef* info = GetSVCInfo(immediate);
     if (info) {
+        svc_counters[immediate].Add();
         if (info->func) {
             (this->*(info->func))();
         } else {
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include "common/common_types.h"
+#include "core/hle/kernel/thread.h"
 
 namespace Core {
 class System;
@@ -25,4 +27,7 @@ private:
     std::unique_ptr<SVC> impl;
 };
 
+/// Wakeup callbacks of the threads waiting in SVCs, which save states refer to by their index
+const std::array<Thread::WakeupCallback*, 4>& GetSvcWakeupCallbacks();
+
 } // namespace Kernel
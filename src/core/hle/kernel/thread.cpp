@@ -3,9 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <list>
 #include <unordered_map>
 #include <vector>
+#include <fmt/format.h>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
@@ -18,7 +20,9 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/mutex.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/svc.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/result.h"
 #include "core/memory.h"
@@ -477,4 +481,171 @@ const std::vector<SharedPtr<Thread>>& ThreadManager::GetThreadList() {
     return thread_list;
 }
 
+namespace {
+
+constexpr std::size_t CpuRegisterCount = 16;
+constexpr std::size_t FpuRegisterCount = 64;
+
+enum class WakeupCallbackKind : u8 {
+    None,
+    /// One of GetSvcWakeupCallbacks, whose index follows
+    Svc,
+    /// Set by the address arbiter the thread waits on, which restores it
+    AddressArbiter,
+};
+
+} // Anonymous namespace
+
+void ThreadManager::SaveState(ObjectStateWriter& writer) const {
+    writer.Write(next_thread_id);
+    writer.WriteObjects(thread_list);
+    writer.WriteObject(current_thread);
+    for (u32 priority = ThreadPrioHighest; priority <= ThreadPrioLowest; ++priority) {
+        writer.WriteObjects(ready_queue.get_queue(priority));
+    }
+}
+
+bool ThreadManager::LoadState(ObjectStateReader& reader) {
+    // The threads being replaced release what they hold, as they do on shutdown
+    for (auto& thread : thread_list) {
+        thread->Stop();
+    }
+
+    if (!reader.Read(next_thread_id) || !reader.ReadObjects(thread_list) ||
+        !reader.ReadObject(current_thread)) {
+        return false;
+    }
+
+    ready_queue.clear();
+    wakeup_callback_table.clear();
+    for (const auto& thread : thread_list) {
+        if (thread == nullptr) {
+            return false;
+        }
+        ready_queue.prepare(thread->current_priority);
+        // Threads leave the table when they are stopped
+        if (thread->status != ThreadStatus::Dead) {
+            wakeup_callback_table[thread->thread_id] = thread.get();
+        }
+    }
+    for (u32 priority = ThreadPrioHighest; priority <= ThreadPrioLowest; ++priority) {
+        std::vector<Thread*> ready_threads;
+        if (!reader.ReadObjects(ready_threads)) {
+            return false;
+        }
+        if (!ready_threads.empty()) {
+            ready_queue.prepare(priority);
+        }
+        for (Thread* thread : ready_threads) {
+            if (thread == nullptr) {
+                return false;
+            }
+            ready_queue.push_back(priority, thread);
+        }
+    }
+    return true;
+}
+
+void Thread::SaveState(ObjectStateWriter& writer) const {
+    WaitObject::SaveState(writer);
+    writer.Write(thread_id);
+    writer.Write(status);
+    writer.Write(entry_point);
+    writer.Write(stack_top);
+    writer.Write(nominal_priority);
+    writer.Write(current_priority);
+    writer.Write(last_running_ticks);
+    writer.Write(processor_id);
+    writer.Write(tls_address);
+    writer.WriteObjects(held_mutexes);
+    writer.WriteObjects(pending_mutexes);
+    writer.WriteObject(owner_process);
+    writer.WriteObjects(wait_objects);
+    writer.Write(wait_address);
+    writer.WriteString(name);
+
+    // The context of the current thread is stale, the CPU state holds its registers
+    for (std::size_t i = 0; i < CpuRegisterCount; ++i) {
+        writer.Write(context->GetCpuRegister(i));
+    }
+    for (std::size_t i = 0; i < FpuRegisterCount; ++i) {
+        writer.Write(context->GetFpuRegister(i));
+    }
+    writer.Write(context->GetCpsr());
+    writer.Write(context->GetFpscr());
+    writer.Write(context->GetFpexc());
+
+    if (!wakeup_callback) {
+        writer.Write(WakeupCallbackKind::None);
+        return;
+    }
+    const auto& svc_callbacks = GetSvcWakeupCallbacks();
+    const auto* const callback = wakeup_callback.target<WakeupCallback*>();
+    const auto svc_callback =
+        callback != nullptr ? std::find(svc_callbacks.begin(), svc_callbacks.end(), *callback)
+                            : svc_callbacks.end();
+    if (svc_callback != svc_callbacks.end()) {
+        writer.Write(WakeupCallbackKind::Svc);
+        writer.Write(static_cast<u8>(svc_callback - svc_callbacks.begin()));
+    } else if (status == ThreadStatus::WaitArb) {
+        writer.Write(WakeupCallbackKind::AddressArbiter);
+    } else {
+        writer.Refuse(fmt::format("thread {} is paused by an HLE handler", name));
+        writer.Write(WakeupCallbackKind::None);
+    }
+}
+
+bool Thread::LoadState(ObjectStateReader& reader) {
+    if (!WaitObject::LoadState(reader) || !reader.Read(thread_id) || !reader.Read(status) ||
+        !reader.Read(entry_point) || !reader.Read(stack_top) || !reader.Read(nominal_priority) ||
+        !reader.Read(current_priority) || nominal_priority > ThreadPrioLowest ||
+        current_priority > ThreadPrioLowest || !reader.Read(last_running_ticks) ||
+        !reader.Read(processor_id) || !reader.Read(tls_address) ||
+        !reader.ReadObjects(held_mutexes) || !reader.ReadObjects(pending_mutexes) ||
+        !reader.ReadObject(owner_process) || owner_process == nullptr ||
+        !reader.ReadObjects(wait_objects) || !reader.Read(wait_address) ||
+        !reader.ReadString(name)) {
+        return false;
+    }
+
+    std::array<u32, CpuRegisterCount> cpu_registers;
+    std::array<u32, FpuRegisterCount> fpu_registers;
+    u32 cpsr, fpscr, fpexc;
+    if (!reader.Read(cpu_registers) || !reader.Read(fpu_registers) || !reader.Read(cpsr) ||
+        !reader.Read(fpscr) || !reader.Read(fpexc)) {
+        return false;
+    }
+    for (std::size_t i = 0; i < CpuRegisterCount; ++i) {
+        context->SetCpuRegister(i, cpu_registers[i]);
+    }
+    for (std::size_t i = 0; i < FpuRegisterCount; ++i) {
+        context->SetFpuRegister(i, fpu_registers[i]);
+    }
+    context->SetCpsr(cpsr);
+    context->SetFpscr(fpscr);
+    context->SetFpexc(fpexc);
+
+    WakeupCallbackKind callback_kind;
+    if (!reader.Read(callback_kind)) {
+        return false;
+    }
+    switch (callback_kind) {
+    case WakeupCallbackKind::None:
+        wakeup_callback = nullptr;
+        return true;
+    case WakeupCallbackKind::Svc: {
+        u8 index;
+        if (!reader.Read(index) || index >= GetSvcWakeupCallbacks().size()) {
+            return false;
+        }
+        wakeup_callback = GetSvcWakeupCallbacks()[index];
+        return true;
+    }
+    case WakeupCallbackKind::AddressArbiter:
+        // The arbiter may have been loaded already
+        return status == ThreadStatus::WaitArb;
+    }
+    return false;
+}
+
 } // namespace Kernel
@@ -101,6 +101,12 @@ public:
      */
     const std::vector<SharedPtr<Thread>>& GetThreadList();
 
+    /// Saves the list of the threads and the scheduler state
+    void SaveState(ObjectStateWriter& writer) const;
+
+    /// Loads the list of the threads and the scheduler state, stopping the current threads
+    bool LoadState(ObjectStateReader& reader);
+
 private:
     /**
      * Switches the CPU's active thread context to that of the specified thread
@@ -155,6 +161,9 @@ public:
     bool ShouldWait(Thread* thread) const override;
     void Acquire(Thread* thread) override;
 
+    void SaveState(ObjectStateWriter& writer) const override;
+    bool LoadState(ObjectStateReader& reader) override;
+
     /**
      * Gets the thread's current priority
      * @return The current thread's priority
@@ -4,11 +4,13 @@
 
 #include <cinttypes>
 #include <unordered_map>
+#include <vector>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/timer.h"
 
@@ -111,4 +113,49 @@ TimerManager::TimerManager() {
         [this](u64 thread_id, s64 cycle_late) { TimerCallback(thread_id, cycle_late); });
 }
 
+void TimerManager::SaveState(ObjectStateWriter& writer) const {
+    writer.Write(next_timer_callback_id);
+    writer.Write(static_cast<u32>(timer_callback_table.size()));
+    for (const auto& [callback_id, timer] : timer_callback_table) {
+        writer.WriteObject(timer);
+    }
+}
+
+bool TimerManager::LoadState(ObjectStateReader& reader) {
+    // The timers being replaced erase their callback ids from the table when they die, and the
+    // loaded timers reuse them
+    for (auto& [callback_id, timer] : timer_callback_table) {
+        timer->callback_id = 0;
+    }
+    timer_callback_table.clear();
+
+    std::vector<SharedPtr<Timer>> timers;
+    if (!reader.Read(next_timer_callback_id) || !reader.ReadObjects(timers)) {
+        return false;
+    }
+    for (const auto& timer : timers) {
+        if (timer == nullptr || timer->callback_id == 0) {
+            return false;
+        }
+        timer_callback_table[timer->callback_id] = timer.get();
+    }
+    return true;
+}
+
+void Timer::SaveState(ObjectStateWriter& writer) const {
+    WaitObject::SaveState(writer);
+    writer.Write(reset_type);
+    writer.Write(initial_delay);
+    writer.Write(interval_delay);
+    writer.Write(signaled);
+    writer.WriteString(name);
+    writer.Write(callback_id);
+}
+
+bool Timer::LoadState(ObjectStateReader& reader) {
+    return WaitObject::LoadState(reader) && reader.Read(reset_type) &&
+           reader.Read(initial_delay) && reader.Read(interval_delay) && reader.Read(signaled) &&
+           reader.ReadString(name) && reader.Read(callback_id);
+}
+
 } // namespace Kernel
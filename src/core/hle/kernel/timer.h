@@ -15,6 +15,12 @@ class TimerManager {
 public:
     TimerManager();
 
+    /// Saves the table of the timers, which the timer events of a save state refer to
+    void SaveState(ObjectStateWriter& writer) const;
+
+    /// Loads the table of the timers, replacing the current ones
+    bool LoadState(ObjectStateReader& reader);
+
 private:
     /// The timer callback event, called when a timer is fired
     void TimerCallback(u64 callback_id, s64 cycles_late);
@@ -78,6 +84,9 @@ public:
      */
     void Signal(s64 cycles_late);
 
+    void SaveState(ObjectStateWriter& writer) const override;
+    bool LoadState(ObjectStateReader& reader) override;
+
 private:
     explicit Timer(KernelSystem& kernel);
     ~Timer() override;
@@ -91,11 +100,12 @@ private:
     std::string name; ///< Name of timer (optional)
 
     /// ID used as userdata to reference this object when inserting into the CoreTiming queue.
-    u64 callback_id;
+    u64 callback_id = 0;
 
     TimerManager& timer_manager;
 
     friend class KernelSystem;
+    friend class TimerManager;
 };
 
 } // namespace Kernel
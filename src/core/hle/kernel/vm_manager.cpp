@@ -6,6 +6,7 @@
 #include <iterator>
 #include "common/assert.h"
 #include "core/hle/kernel/errors.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/memory.h"
 #include "core/mmio.h"
@@ -54,6 +55,7 @@ void VMManager::Reset() {
 
     page_table.pointers.fill(nullptr);
     page_table.attributes.fill(Memory::PageType::Unmapped);
+    page_table.watched_pages.clear();
 
     UpdatePageTableForVMA(initial_vma);
 }
@@ -381,4 +383,53 @@ ResultVal<std::vector<std::pair<u8*, u32>>> VMManager::GetBackingBlocksForRange(
     }
     return MakeResult(backing_blocks);
 }
+void VMManager::SaveState(ObjectStateWriter& writer) const {
+    writer.Write(static_cast<u32>(vma_map.size()));
+    for (const auto& [base, vma] : vma_map) {
+        if (vma.type == VMAType::MMIO) {
+            writer.Refuse("MMIO is mapped");
+        }
+        writer.Write(vma.base);
+        writer.Write(vma.size);
+        writer.Write(vma.type);
+        writer.Write(vma.permissions);
+        writer.Write(vma.meminfo_state);
+        writer.WriteMemoryPointer(vma.backing_memory);
+    }
+}
+
+bool VMManager::LoadState(ObjectStateReader& reader) {
+    u32 count;
+    if (!reader.Read(count)) {
+        return false;
+    }
+    decltype(vma_map) new_vma_map;
+    VAddr next_base = 0;
+    for (u32 i = 0; i < count; ++i) {
+        VirtualMemoryArea vma;
+        if (!reader.Read(vma.base) || !reader.Read(vma.size) || !reader.Read(vma.type) ||
+            !reader.Read(vma.permissions) || !reader.Read(vma.meminfo_state) ||
+            !reader.ReadMemoryPointer(vma.backing_memory)) {
+            return false;
+        }
+        // The areas must cover the address space without overlapping, as Reset makes them
+        if (vma.base != next_base || vma.type == VMAType::MMIO ||
+            (vma.type == VMAType::BackingMemory) == (vma.backing_memory == nullptr)) {
+            return false;
+        }
+        next_base = vma.base + vma.size;
+        new_vma_map.emplace(vma.base, vma);
+    }
+    if (next_base != MAX_ADDRESS) {
+        return false;
+    }
+
+    Reset();
+    vma_map = std::move(new_vma_map);
+    for (const auto& [base, vma] : vma_map) {
+        UpdatePageTableForVMA(vma);
+    }
+    return true;
+}
+
 } // namespace Kernel
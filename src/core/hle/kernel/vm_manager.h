@@ -15,6 +15,9 @@
 
 namespace Kernel {
 
+class ObjectStateReader;
+class ObjectStateWriter;
+
 enum class VMAType : u8 {
     /// VMA represents an unmapped region of the address space.
     Free,
@@ -188,6 +191,12 @@ public:
     /// Gets a list of backing memory blocks for the specified range
     ResultVal<std::vector<std::pair<u8*, u32>>> GetBackingBlocksForRange(VAddr address, u32 size);
 
+    /// Writes the memory areas, MMIO areas can't be saved
+    void SaveState(ObjectStateWriter& writer) const;
+
+    /// Restores the memory areas written by SaveState and rebuilds the page table from them
+    bool LoadState(ObjectStateReader& reader);
+
     /// Each VMManager has its own page table, which is set as the main one when the owning process
     /// is scheduled.
     Memory::PageTable page_table;
@@ -8,6 +8,7 @@
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
 #include "core/hle/kernel/thread.h"
@@ -92,4 +93,12 @@ const std::vector<SharedPtr<Thread>>& WaitObject::GetWaitingThreads() const {
     return waiting_threads;
 }
 
+void WaitObject::SaveState(ObjectStateWriter& writer) const {
+    writer.WriteObjects(waiting_threads);
+}
+
+bool WaitObject::LoadState(ObjectStateReader& reader) {
+    return reader.ReadObjects(waiting_threads);
+}
+
 } // namespace Kernel
@@ -10,6 +10,7 @@
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/result.h"
 #include "core/hle/service/ac/ac.h"
 #include "core/hle/service/ac/ac_i.h"
@@ -172,6 +173,30 @@ void Module::Interface::SetClientVersion(Kernel::HLERequestContext& ctx) {
 Module::Interface::Interface(std::shared_ptr<Module> ac, const char* name, u32 max_session)
     : ServiceFramework(name, max_session), ac(std::move(ac)) {}
 
+void Module::Interface::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    if (writer.MarkSharedState(ac.get())) {
+        ac->SaveState(writer);
+    }
+}
+
+bool Module::Interface::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadSharedState([&] { return ac->LoadState(reader); });
+}
+
+void Module::SaveState(Kernel::ObjectStateWriter& writer) const {
+    writer.Write(default_config);
+    writer.Write(ac_connected);
+    writer.WriteObject(close_event);
+    writer.WriteObject(connect_event);
+    writer.WriteObject(disconnect_event);
+}
+
+bool Module::LoadState(Kernel::ObjectStateReader& reader) {
+    return reader.Read(default_config) && reader.Read(ac_connected) &&
+           reader.ReadObject(close_event) && reader.ReadObject(connect_event) &&
+           reader.ReadObject(disconnect_event);
+}
+
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
     auto ac = std::make_shared<Module>();
@@ -139,9 +139,15 @@ public:
         void SetClientVersion(Kernel::HLERequestContext& ctx);
 
     protected:
+        void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+        bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
         std::shared_ptr<Module> ac;
     };
 
+    void SaveState(Kernel::ObjectStateWriter& writer) const;
+    bool LoadState(Kernel::ObjectStateReader& reader);
+
 protected:
     struct ACConfig {
         std::array<u8, 0x200> data;
@@ -3,9 +3,15 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <cinttypes>
+#include <condition_variable>
 #include <cstddef>
 #include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include <fmt/format.h>
@@ -22,6 +28,7 @@
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/kernel/session.h"
 #include "core/hle/service/am/am.h"
@@ -78,7 +85,154 @@ static_assert(sizeof(TicketInfo) == 0x18, "Ticket info structure size is wrong")
 
 class CIAFile::DecryptionState {
 public:
-    std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> content;
+    std::optional<std::array<u8, 16>> title_key;
+    // CBC chaining value of the next block of each content: the content CTR at first, then the
+    // last ciphertext block that was received. This makes each chunk decryptable on its own.
+    std::vector<std::array<u8, 16>> content_iv;
+    // Trailing bytes of each content which don't make up a full AES block yet
+    std::vector<std::vector<u8>> content_remainder;
+};
+
+/**
+ * Three-stage pipeline for content data: chunks are submitted in order by CIAFile::Write, decrypted
+ * in parallel by a few worker threads (chunks carry their own CBC IV, so chunks of the same or of
+ * different contents are independent), and written out in submission order by a writer thread.
+ * The number of chunks in flight is bounded so that memory usage stays constant.
+ */
+class CIAFile::ContentPipeline {
+public:
+    struct Chunk {
+        std::size_t content_index;
+        std::string open_path; ///< Set on the first chunk of a content, which creates the file
+        bool encrypted;
+        std::array<u8, 16> key;
+        std::array<u8, 16> iv;
+        std::vector<u8> data;
+        bool taken = false; ///< Picked up by a decryption worker
+        bool ready = false; ///< Decrypted (or plain) and ready to be written
+    };
+
+    explicit ContentPipeline(std::size_t content_count) : content_files(content_count) {
+        const unsigned hardware_threads = std::thread::hardware_concurrency();
+        const std::size_t num_workers = std::clamp(hardware_threads > 2 ? hardware_threads - 2 : 1u,
+                                                   1u, MaxDecryptionWorkers);
+        for (std::size_t i = 0; i < num_workers; ++i)
+            decrypt_workers.emplace_back(&ContentPipeline::DecryptLoop, this);
+        writer = std::thread(&ContentPipeline::WriteLoop, this);
+    }
+
+    ~ContentPipeline() {
+        Finish();
+    }
+
+    /// Queues a chunk, blocking while too many chunks are in flight. Returns false on a write
+    /// error of a previous chunk.
+    bool Submit(std::unique_ptr<Chunk> chunk) {
+        std::unique_lock lock(mutex);
+        space_available.wait(lock, [this] { return chunks.size() < MaxChunksInFlight || failed; });
+        if (failed || stopping)
+            return false;
+        chunks.push_back(std::move(chunk));
+        work_available.notify_all();
+        return true;
+    }
+
+    /// Waits for all queued chunks to be written and stops the threads. Returns false if any
+    /// chunk could not be written.
+    bool Finish() {
+        {
+            std::unique_lock lock(mutex);
+            if (!stopping) {
+                stopping = true;
+                work_available.notify_all();
+            }
+        }
+        for (auto& worker : decrypt_workers) {
+            if (worker.joinable())
+                worker.join();
+        }
+        if (writer.joinable())
+            writer.join();
+        content_files.clear();
+
+        std::lock_guard lock(mutex);
+        return !failed;
+    }
+
+private:
+    static constexpr std::size_t MaxChunksInFlight = 16;
+    static constexpr unsigned MaxDecryptionWorkers = 4;
+
+    void DecryptLoop() {
+        std::unique_lock lock(mutex);
+        while (true) {
+            auto itr = std::find_if(chunks.begin(), chunks.end(),
+                                    [](const auto& chunk) { return !chunk->taken; });
+            if (itr == chunks.end()) {
+                if (stopping)
+                    return;
+                work_available.wait(lock);
+                continue;
+            }
+
+            Chunk& chunk = **itr;
+            chunk.taken = true;
+            lock.unlock();
+            if (chunk.encrypted && !chunk.data.empty()) {
+                CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption d(chunk.key.data(), chunk.key.size(),
+                                                                chunk.iv.data());
+                d.ProcessData(chunk.data.data(), chunk.data.data(), chunk.data.size());
+            }
+            lock.lock();
+            chunk.ready = true;
+            chunk_ready.notify_all();
+        }
+    }
+
+    void WriteLoop() {
+        std::unique_lock lock(mutex);
+        while (true) {
+            if (chunks.empty()) {
+                if (stopping)
+                    return;
+                work_available.wait(lock);
+                continue;
+            }
+            if (!chunks.front()->ready) {
+                chunk_ready.wait(lock);
+                continue;
+            }
+
+            // Chunks are only removed by this thread, so the front chunk stays valid unlocked
+            Chunk& chunk = *chunks.front();
+            lock.unlock();
+            FileUtil::IOFile& file = content_files[chunk.content_index];
+            if (!chunk.open_path.empty())
+                file = FileUtil::IOFile(chunk.open_path, "wb");
+            const std::size_t size = chunk.data.size();
+            const bool written = file.IsOpen() && file.WriteBytes(chunk.data.data(), size) == size;
+            lock.lock();
+
+            if (!written) {
+                LOG_ERROR(Service_AM, "Failed to write content {}", chunk.content_index);
+                failed = true;
+            }
+            chunks.pop_front();
+            space_available.notify_all();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable work_available;  ///< A chunk was queued or the pipeline is stopping
+    std::condition_variable chunk_ready;     ///< A chunk finished decrypting
+    std::condition_variable space_available; ///< A chunk was written out
+    std::deque<std::unique_ptr<Chunk>> chunks;
+    bool stopping = false;
+    bool failed = false;
+
+    std::vector<FileUtil::IOFile> content_files; ///< Only accessed by the writer thread
+    std::vector<std::thread> decrypt_workers;
+    std::thread writer;
 };
 
 CIAFile::CIAFile(Service::FS::MediaType media_type)
@@ -132,14 +286,13 @@ ResultCode CIAFile::WriteTitleMetadata() {
     auto content_count = container.GetTitleMetadata().GetContentCount();
     content_written.resize(content_count);
 
-    if (auto title_key = container.GetTicket().GetTitleKey()) {
-        decryption_state->content.resize(content_count);
-        for (std::size_t i = 0; i < content_count; ++i) {
-            auto ctr = tmd.GetContentCTRByIndex(i);
-            decryption_state->content[i].SetKeyWithIV(title_key->data(), title_key->size(),
-                                                      ctr.data());
-        }
-    }
+    decryption_state->title_key = container.GetTicket().GetTitleKey();
+    decryption_state->content_iv.resize(content_count);
+    decryption_state->content_remainder.resize(content_count);
+    for (std::size_t i = 0; i < content_count; ++i)
+        decryption_state->content_iv[i] = tmd.GetContentCTRByIndex(i);
+
+    content_pipeline = std::make_unique<ContentPipeline>(content_count);
 
     install_state = CIAInstallState::TMDLoaded;
 
@@ -166,25 +319,60 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
             // Figure out how much of this content ID we have just recieved/can write out
             u64 available_to_write = std::min(offset_max, range_max) - range_min;
 
+            const FileSys::TitleMetadata& tmd = container.GetTitleMetadata();
+            const u8* chunk_start = buffer + (range_min - offset);
+
+            auto chunk = std::make_unique<ContentPipeline::Chunk>();
+            chunk->content_index = i;
+            chunk->encrypted = (tmd.GetContentTypeByIndex(static_cast<u16>(i)) &
+                                FileSys::TMDContentTypeFlag::Encrypted) != 0;
             // Since the incoming TMD has already been written, we can use GetTitleContentPath
             // to get the content paths to write to.
-            FileSys::TitleMetadata tmd = container.GetTitleMetadata();
-            FileUtil::IOFile file(GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update),
-                                  content_written[i] ? "ab" : "wb");
+            if (content_written[i] == 0)
+                chunk->open_path = GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update);
+
+            if (chunk->encrypted && decryption_state->title_key) {
+                // Only whole AES blocks can be decrypted, keep the rest for the next chunk
+                std::vector<u8>& remainder = decryption_state->content_remainder[i];
+                chunk->data.reserve(remainder.size() + available_to_write);
+                chunk->data.assign(remainder.begin(), remainder.end());
+                chunk->data.insert(chunk->data.end(), chunk_start,
+                                   chunk_start + available_to_write);
+                const std::size_t aligned_size = chunk->data.size() & ~std::size_t(0xF);
+                remainder.assign(chunk->data.begin() + aligned_size, chunk->data.end());
+                chunk->data.resize(aligned_size);
+
+                chunk->key = *decryption_state->title_key;
+                chunk->iv = decryption_state->content_iv[i];
+                if (aligned_size != 0) {
+                    std::copy(chunk->data.end() - 16, chunk->data.end(),
+                              decryption_state->content_iv[i].begin());
+                }
+            } else {
+                chunk->encrypted = false;
+                chunk->data.assign(chunk_start, chunk_start + available_to_write);
+            }
 
-            if (!file.IsOpen())
+            if (!content_pipeline->Submit(std::move(chunk)))
                 return FileSys::ERROR_INSUFFICIENT_SPACE;
 
-            std::vector<u8> temp(buffer + (range_min - offset),
-                                 buffer + (range_min - offset) + available_to_write);
-
-            if (tmd.GetContentTypeByIndex(static_cast<u16>(i)) &
-                FileSys::TMDContentTypeFlag::Encrypted) {
-                decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
+            // A content that doesn't end on an AES block can't be fully decrypted, its last bytes
+            // are written as they are so that the file keeps its size
+            std::vector<u8>& remainder = decryption_state->content_remainder[i];
+            if (content_written[i] + available_to_write == size && !remainder.empty()) {
+                LOG_WARNING(Service_AM,
+                            "Content {} size is not a multiple of the AES block size, "
+                            "writing its last {} bytes undecrypted",
+                            i, remainder.size());
+                auto tail = std::make_unique<ContentPipeline::Chunk>();
+                tail->content_index = i;
+                tail->encrypted = false;
+                tail->data = std::move(remainder);
+                remainder.clear();
+                if (!content_pipeline->Submit(std::move(tail)))
+                    return FileSys::ERROR_INSUFFICIENT_SPACE;
             }
 
-            file.WriteBytes(temp.data(), temp.size());
-
             // Keep tabs on how much of this content ID has been written so new range_min
             // values can be calculated.
             content_written[i] += available_to_write;
@@ -276,7 +464,8 @@ bool CIAFile::SetSize(u64 size) const {
 }
 
 bool CIAFile::Close() const {
-    bool complete = true;
+    // Wait for the content data still in flight
+    bool complete = content_pipeline ? content_pipeline->Finish() : true;
     for (std::size_t i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(static_cast<u16>(i)))
             complete = false;
@@ -354,25 +543,86 @@ InstallStatus InstallCIA(const std::string& path,
         if (!file.IsOpen())
             return InstallStatus::ErrorFailedToOpenFile;
 
-        std::array<u8, 0x10000> buffer;
+        // Read the CIA on a separate thread so that reading overlaps with the decryption and
+        // writing done by CIAFile. Chunks are handed over through a small bounded queue.
+        constexpr std::size_t ReadChunkSize = 0x100000;
+        constexpr std::size_t MaxChunksRead = 4;
+        const std::size_t file_size = file.GetSize();
+        std::mutex read_mutex;
+        std::condition_variable read_cv;
+        std::deque<std::vector<u8>> read_chunks;
+        bool read_done = false;
+        bool read_cancel = false;
+
+        std::thread reader([&] {
+            std::size_t total = 0;
+            while (total != file_size) {
+                std::vector<u8> chunk(std::min(ReadChunkSize, file_size - total));
+                chunk.resize(file.ReadBytes(chunk.data(), chunk.size()));
+                total += chunk.size();
+
+                std::unique_lock lock(read_mutex);
+                read_cv.wait(lock,
+                             [&] { return read_chunks.size() < MaxChunksRead || read_cancel; });
+                if (read_cancel || chunk.empty())
+                    break;
+                read_chunks.push_back(std::move(chunk));
+                read_cv.notify_all();
+            }
+            std::lock_guard lock(read_mutex);
+            read_done = true;
+            read_cv.notify_all();
+        });
+
+        const auto start_time = std::chrono::steady_clock::now();
         std::size_t total_bytes_read = 0;
-        while (total_bytes_read != file.GetSize()) {
-            std::size_t bytes_read = file.ReadBytes(buffer.data(), buffer.size());
-            auto result = installFile.Write(static_cast<u64>(total_bytes_read), bytes_read, true,
-                                            static_cast<u8*>(buffer.data()));
+        bool aborted = false;
+        while (true) {
+            std::vector<u8> chunk;
+            {
+                std::unique_lock lock(read_mutex);
+                read_cv.wait(lock, [&] { return !read_chunks.empty() || read_done; });
+                if (read_chunks.empty())
+                    break;
+                chunk = std::move(read_chunks.front());
+                read_chunks.pop_front();
+                read_cv.notify_all();
+            }
 
+            auto result = installFile.Write(static_cast<u64>(total_bytes_read), chunk.size(),
+                                            true, chunk.data());
             if (update_callback)
-                update_callback(total_bytes_read, file.GetSize());
+                update_callback(total_bytes_read, file_size);
             if (result.Failed()) {
                 LOG_ERROR(Service_AM, "CIA file installation aborted with error code {:08x}",
                           result.Code().raw);
-                return InstallStatus::ErrorAborted;
+                aborted = true;
+                break;
             }
-            total_bytes_read += bytes_read;
+            total_bytes_read += chunk.size();
         }
-        installFile.Close();
 
-        LOG_INFO(Service_AM, "Installed {} successfully.", path);
+        {
+            std::lock_guard lock(read_mutex);
+            read_cancel = true;
+            read_cv.notify_all();
+        }
+        reader.join();
+
+        if (!aborted && total_bytes_read != file_size) {
+            LOG_ERROR(Service_AM, "Failed to read {}", path);
+            aborted = true;
+        }
+        // Close waits for the pending content data, and deletes the title if it is incomplete
+        installFile.Close();
+        if (aborted)
+            return InstallStatus::ErrorAborted;
+
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        const double mib = static_cast<double>(file_size) / (1024 * 1024);
+        LOG_INFO(Service_AM, "Installed {} successfully ({:.1f} MiB in {:.2f}s, {:.1f} MiB/s).",
+                 path, mib, seconds, seconds > 0 ? mib / seconds : 0.0);
         return InstallStatus::Success;
     }
 
@@ -1455,6 +1705,25 @@ void Module::Interface::GetMetaDataFromCia(Kernel::HLERequestContext& ctx) {
     rb.PushMappedBuffer(output_buffer);
 }
 
+void Module::Interface::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    if (writer.MarkSharedState(am.get())) {
+        am->SaveState(writer);
+    }
+}
+
+bool Module::Interface::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadSharedState([&] { return am->LoadState(reader); });
+}
+
+void Module::SaveState(Kernel::ObjectStateWriter& writer) const {
+    writer.Write(cia_installing);
+    writer.WriteObject(system_updater_mutex);
+}
+
+bool Module::LoadState(Kernel::ObjectStateReader& reader) {
+    return reader.Read(cia_installing) && reader.ReadObject(system_updater_mutex);
+}
+
 Module::Module(Core::System& system) : system(system) {
     ScanForAllTitles();
     system_updater_mutex = system.Kernel().CreateMutex(false, "AM::SystemUpdaterMutex");
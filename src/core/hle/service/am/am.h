@@ -94,6 +94,10 @@ private:
 
     class DecryptionState;
     std::unique_ptr<DecryptionState> decryption_state;
+
+    // Decrypts and writes out content data on worker threads
+    class ContentPipeline;
+    std::unique_ptr<ContentPipeline> content_pipeline;
 };
 
 /**
@@ -558,9 +562,15 @@ public:
         void GetMetaDataFromCia(Kernel::HLERequestContext& ctx);
 
     private:
+        void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+        bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
         std::shared_ptr<Module> am;
     };
 
+    void SaveState(Kernel::ObjectStateWriter& writer) const;
+    bool LoadState(Kernel::ObjectStateReader& reader);
+
 private:
     /**
      * Scans the for titles in a storage medium for listing.
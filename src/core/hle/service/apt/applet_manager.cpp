@@ -5,6 +5,7 @@
 #include "common/common_paths.h"
 #include "core/core.h"
 #include "core/hle/applets/applet.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/service/apt/applet_manager.h"
 #include "core/hle/service/apt/errors.h"
 #include "core/hle/service/cfg/cfg.h"
@@ -569,6 +570,59 @@ void AppletManager::EnsureHomeMenuLoaded() {
     }
 }
 
+void AppletManager::SaveState(Kernel::ObjectStateWriter& writer) const {
+    writer.Write(next_parameter.has_value());
+    if (next_parameter) {
+        writer.Write(next_parameter->sender_id);
+        writer.Write(next_parameter->destination_id);
+        writer.Write(next_parameter->signal);
+        writer.WriteObject(next_parameter->object);
+        writer.WriteVector(next_parameter->buffer);
+    }
+    writer.Write(app_jump_parameters);
+    for (const AppletSlotData& slot_data : applet_slots) {
+        writer.Write(slot_data.applet_id);
+        writer.Write(slot_data.slot);
+        writer.Write(slot_data.title_id);
+        writer.Write(slot_data.registered);
+        writer.Write(slot_data.loaded);
+        writer.Write(slot_data.attributes.raw);
+        writer.WriteObject(slot_data.notification_event);
+        writer.WriteObject(slot_data.parameter_event);
+    }
+    writer.Write(library_applet_closing_command);
+}
+
+bool AppletManager::LoadState(Kernel::ObjectStateReader& reader) {
+    bool has_next_parameter;
+    if (!reader.Read(has_next_parameter)) {
+        return false;
+    }
+    next_parameter.reset();
+    if (has_next_parameter) {
+        MessageParameter parameter;
+        if (!reader.Read(parameter.sender_id) || !reader.Read(parameter.destination_id) ||
+            !reader.Read(parameter.signal) || !reader.ReadObject(parameter.object) ||
+            !reader.ReadVector(parameter.buffer)) {
+            return false;
+        }
+        next_parameter = std::move(parameter);
+    }
+    if (!reader.Read(app_jump_parameters)) {
+        return false;
+    }
+    for (AppletSlotData& slot_data : applet_slots) {
+        if (!reader.Read(slot_data.applet_id) || !reader.Read(slot_data.slot) ||
+            !reader.Read(slot_data.title_id) || !reader.Read(slot_data.registered) ||
+            !reader.Read(slot_data.loaded) || !reader.Read(slot_data.attributes.raw) ||
+            !reader.ReadObject(slot_data.notification_event) ||
+            !reader.ReadObject(slot_data.parameter_event)) {
+            return false;
+        }
+    }
+    return reader.Read(library_applet_closing_command);
+}
+
 AppletManager::AppletManager(Core::System& system) : system(system) {
     for (std::size_t slot = 0; slot < applet_slots.size(); ++slot) {
         auto& slot_data = applet_slots[slot];
@@ -166,6 +166,9 @@ public:
         return app_jump_parameters;
     }
 
+    void SaveState(Kernel::ObjectStateWriter& writer) const;
+    bool LoadState(Kernel::ObjectStateReader& reader);
+
 private:
     /// Parameter data to be returned in the next call to Glance/ReceiveParameter.
     std::optional<MessageParameter> next_parameter;
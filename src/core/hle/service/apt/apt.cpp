@@ -10,6 +10,7 @@
 #include "core/file_sys/file_backend.h"
 #include "core/hle/applets/applet.h"
 #include "core/hle/kernel/mutex.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/romfs.h"
 #include "core/hle/service/apt/applet_manager.h"
@@ -857,6 +858,42 @@ Module::Interface::Interface(std::shared_ptr<Module> apt, const char* name, u32
 
 Module::Interface::~Interface() = default;
 
+void Module::Interface::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    writer.Write(application_reset_prepared);
+    if (writer.MarkSharedState(apt.get())) {
+        apt->SaveState(writer);
+    }
+}
+
+bool Module::Interface::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.Read(application_reset_prepared) &&
+           reader.ReadSharedState([&] { return apt->LoadState(reader); });
+}
+
+void Module::SaveState(Kernel::ObjectStateWriter& writer) const {
+    // HLE applets keep their own state and threads
+    if (HLE::Applets::IsLibraryAppletRunning()) {
+        writer.Refuse("a library applet is running");
+    }
+    writer.WriteObject(shared_font_mem);
+    writer.Write(shared_font_loaded);
+    writer.Write(shared_font_relocated);
+    writer.WriteObject(lock);
+    writer.Write(cpu_percent);
+    writer.Write(unknown_ns_state_field);
+    writer.WriteVector(screen_capture_buffer);
+    writer.Write(screen_capture_post_permission);
+    applet_manager->SaveState(writer);
+}
+
+bool Module::LoadState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadObject(shared_font_mem) && reader.Read(shared_font_loaded) &&
+           reader.Read(shared_font_relocated) && reader.ReadObject(lock) &&
+           reader.Read(cpu_percent) && reader.Read(unknown_ns_state_field) &&
+           reader.ReadVector(screen_capture_buffer) &&
+           reader.Read(screen_capture_post_permission) && applet_manager->LoadState(reader);
+}
+
 Module::Module(Core::System& system) : system(system) {
     applet_manager = std::make_shared<AppletManager>(system);
 
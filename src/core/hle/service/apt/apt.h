@@ -592,10 +592,16 @@ public:
         void CheckNew3DS(Kernel::HLERequestContext& ctx);
 
     private:
+        void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+        bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
         std::shared_ptr<Module> apt;
         bool application_reset_prepared{};
     };
 
+    void SaveState(Kernel::ObjectStateWriter& writer) const;
+    bool LoadState(Kernel::ObjectStateReader& reader);
+
 private:
     bool LoadSharedFont();
     bool LoadLegacySharedFont();
@@ -5,6 +5,7 @@
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/result.h"
 #include "core/hle/service/boss/boss.h"
 #include "core/hle/service/boss/boss_p.h"
@@ -903,6 +904,22 @@ void Module::Interface::GetNsDataNewFlagPrivileged(Kernel::HLERequestContext& ct
 Module::Interface::Interface(std::shared_ptr<Module> boss, const char* name, u32 max_session)
     : ServiceFramework(name, max_session), boss(std::move(boss)) {}
 
+void Module::Interface::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    writer.Write(new_arrival_flag);
+    writer.Write(ns_data_new_flag);
+    writer.Write(ns_data_new_flag_privileged);
+    writer.Write(output_flag);
+    if (writer.MarkSharedState(boss.get())) {
+        writer.WriteObject(boss->task_finish_event);
+    }
+}
+
+bool Module::Interface::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.Read(new_arrival_flag) && reader.Read(ns_data_new_flag) &&
+           reader.Read(ns_data_new_flag_privileged) && reader.Read(output_flag) &&
+           reader.ReadSharedState([&] { return reader.ReadObject(boss->task_finish_event); });
+}
+
 Module::Module(Core::System& system) {
     using namespace Kernel;
     // TODO: verify ResetType
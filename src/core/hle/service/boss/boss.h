@@ -952,6 +952,9 @@ public:
         void GetNsDataNewFlagPrivileged(Kernel::HLERequestContext& ctx);
 
     private:
+        void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+        bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
         std::shared_ptr<Module> boss;
 
         u8 new_arrival_flag;
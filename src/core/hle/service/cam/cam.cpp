@@ -11,6 +11,7 @@
 #include "core/hle/ipc.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/event.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/service/cam/cam.h"
 #include "core/hle/service/cam/cam_c.h"
@@ -1019,6 +1020,61 @@ void Module::Interface::DriverFinalize(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_CAM, "called");
 }
 
+void Module::Interface::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    if (writer.MarkSharedState(cam.get())) {
+        cam->SaveState(writer);
+    }
+}
+
+bool Module::Interface::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadSharedState([&] { return cam->LoadState(reader); });
+}
+
+void Module::SaveState(Kernel::ObjectStateWriter& writer) const {
+    for (const CameraConfig& camera : cameras) {
+        writer.Write(camera.contexts);
+        writer.Write(camera.current_context);
+        writer.Write(camera.frame_rate);
+    }
+    for (const PortConfig& port : ports) {
+        // The camera implementations and the frames being received can't be saved
+        if (port.is_active) {
+            writer.Refuse("a camera is active");
+        }
+        writer.Write(port.camera_id);
+        writer.Write(port.is_pending_receiving);
+        writer.Write(port.is_trimming);
+        writer.Write(port.x0);
+        writer.Write(port.y0);
+        writer.Write(port.x1);
+        writer.Write(port.y1);
+        writer.Write(port.transfer_bytes);
+        writer.WriteObject(port.completion_event);
+        writer.WriteObject(port.buffer_error_interrupt_event);
+        writer.WriteObject(port.vsync_interrupt_event);
+    }
+}
+
+bool Module::LoadState(Kernel::ObjectStateReader& reader) {
+    for (CameraConfig& camera : cameras) {
+        if (!reader.Read(camera.contexts) || !reader.Read(camera.current_context) ||
+            !reader.Read(camera.frame_rate)) {
+            return false;
+        }
+    }
+    for (PortConfig& port : ports) {
+        if (!reader.Read(port.camera_id) || !reader.Read(port.is_pending_receiving) ||
+            !reader.Read(port.is_trimming) || !reader.Read(port.x0) || !reader.Read(port.y0) ||
+            !reader.Read(port.x1) || !reader.Read(port.y1) || !reader.Read(port.transfer_bytes) ||
+            !reader.ReadObject(port.completion_event) ||
+            !reader.ReadObject(port.buffer_error_interrupt_event) ||
+            !reader.ReadObject(port.vsync_interrupt_event)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 Module::Module(Core::System& system) : system(system) {
     using namespace Kernel;
     for (PortConfig& port : ports) {
@@ -711,9 +711,15 @@ public:
         void DriverFinalize(Kernel::HLERequestContext& ctx);
 
     private:
+        void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+        bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
         std::shared_ptr<Module> cam;
     };
 
+    void SaveState(Kernel::ObjectStateWriter& writer) const;
+    bool LoadState(Kernel::ObjectStateReader& reader);
+
 private:
     void CompletionEventCallBack(u64 port_id, s64);
 
@@ -15,6 +15,7 @@
 #include "core/file_sys/errors.h"
 #include "core/file_sys/file_backend.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/result.h"
 #include "core/hle/service/cecd/cecd.h"
@@ -1348,9 +1349,43 @@ Module::SessionData::~SessionData() {
         file->Close();
 }
 
+void Module::SessionData::SaveState(Kernel::ObjectStateWriter& writer) const {
+    if (file != nullptr) {
+        writer.Refuse("a CECD file is open");
+    }
+    writer.Write(ncch_program_id);
+    writer.Write(data_path_type);
+    writer.Write(open_mode.raw);
+    path.SaveState(writer);
+}
+
+bool Module::SessionData::LoadState(Kernel::ObjectStateReader& reader) {
+    return reader.Read(ncch_program_id) && reader.Read(data_path_type) &&
+           reader.Read(open_mode.raw) && path.LoadState(reader);
+}
+
 Module::Interface::Interface(std::shared_ptr<Module> cecd, const char* name, u32 max_session)
     : ServiceFramework(name, max_session), cecd(std::move(cecd)) {}
 
+void Module::Interface::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    if (writer.MarkSharedState(cecd.get())) {
+        cecd->SaveState(writer);
+    }
+}
+
+bool Module::Interface::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadSharedState([&] { return cecd->LoadState(reader); });
+}
+
+void Module::SaveState(Kernel::ObjectStateWriter& writer) const {
+    writer.WriteObject(cecinfo_event);
+    writer.WriteObject(change_state_event);
+}
+
+bool Module::LoadState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadObject(cecinfo_event) && reader.ReadObject(change_state_event);
+}
+
 Module::Module(Core::System& system) : system(system) {
     using namespace Kernel;
     cecinfo_event = system.Kernel().CreateEvent(Kernel::ResetType::OneShot, "CECD::cecinfo_event");
@@ -241,6 +241,9 @@ public:
         SessionData();
         ~SessionData();
 
+        void SaveState(Kernel::ObjectStateWriter& writer) const override;
+        bool LoadState(Kernel::ObjectStateReader& reader) override;
+
         u32 ncch_program_id;
         CecDataPathType data_path_type;
         CecOpenMode open_mode;
@@ -584,9 +587,15 @@ public:
         void GetCecInfoEventHandleSys(Kernel::HLERequestContext& ctx);
 
     private:
+        void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+        bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
         std::shared_ptr<Module> cecd;
     };
 
+    void SaveState(Kernel::ObjectStateWriter& writer) const;
+    bool LoadState(Kernel::ObjectStateReader& reader);
+
 private:
     /// String used by cecd for base64 encoding found in the sysmodule disassembly
     const std::string base64_dict =
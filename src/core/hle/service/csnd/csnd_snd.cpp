@@ -5,6 +5,7 @@
 #include "common/alignment.h"
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/result.h"
 #include "core/hle/service/csnd/csnd_snd.h"
 
@@ -175,6 +176,17 @@ void CSND_SND::Reset(Kernel::HLERequestContext& ctx) {
     LOG_WARNING(Service_CSND, "(STUBBED) called");
 }
 
+void CSND_SND::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    writer.WriteObject(mutex);
+    writer.WriteObject(shared_memory);
+    writer.Write(capture_units);
+}
+
+bool CSND_SND::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadObject(mutex) && reader.ReadObject(shared_memory) &&
+           reader.Read(capture_units);
+}
+
 CSND_SND::CSND_SND(Core::System& system) : ServiceFramework("csnd:SND", 4), system(system) {
     static const FunctionInfo functions[] = {
         // clang-format off
@@ -20,6 +20,9 @@ public:
     ~CSND_SND() = default;
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
     /**
      * CSND_SND::Initialize service function
      *  Inputs:
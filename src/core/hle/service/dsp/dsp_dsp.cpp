@@ -8,6 +8,7 @@
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/service/dsp/dsp_dsp.h"
 
@@ -350,6 +351,28 @@ bool DSP_DSP::HasTooManyEventsRegistered() const {
     return number >= max_number_of_interrupt_events;
 }
 
+void DSP_DSP::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    writer.WriteObject(semaphore_event);
+    writer.WriteObject(interrupt_zero);
+    writer.WriteObject(interrupt_one);
+    for (const auto& pipe : pipes) {
+        writer.WriteObject(pipe);
+    }
+}
+
+bool DSP_DSP::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    if (!reader.ReadObject(semaphore_event) || !reader.ReadObject(interrupt_zero) ||
+        !reader.ReadObject(interrupt_one)) {
+        return false;
+    }
+    for (auto& pipe : pipes) {
+        if (!reader.ReadObject(pipe)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 DSP_DSP::DSP_DSP(Core::System& system) : ServiceFramework("dsp::DSP", DefaultMaxSessions) {
     static const FunctionInfo functions[] = {
         // clang-format off
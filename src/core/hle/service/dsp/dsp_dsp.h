@@ -31,6 +31,9 @@ public:
     void SignalInterrupt(InterruptType type, AudioCore::DspPipe pipe);
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
     /**
      * DSP_DSP::RecvData service function
      *      This function reads a value out of a DSP register.
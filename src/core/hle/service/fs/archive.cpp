@@ -27,6 +27,7 @@
 #include "core/file_sys/file_backend.h"
 #include "core/hle/result.h"
 #include "core/hle/service/fs/archive.h"
+#include "core/savestate.h"
 
 namespace Service::FS {
 
@@ -39,26 +40,33 @@ ResultVal<ArchiveHandle> ArchiveManager::OpenArchive(ArchiveIdCode id_code,
                                                      FileSys::Path& archive_path) {
     LOG_TRACE(Service_FS, "Opening archive with id code 0x{:08X}", static_cast<u32>(id_code));
 
-    auto itr = id_code_map.find(id_code);
-    if (itr == id_code_map.end()) {
-        return FileSys::ERROR_NOT_FOUND;
-    }
-
-    CASCADE_RESULT(std::unique_ptr<ArchiveBackend> res, itr->second->Open(archive_path));
+    ArchiveOrigin origin{id_code, archive_path};
+    CASCADE_RESULT(std::unique_ptr<ArchiveBackend> res, OpenArchiveBackend(origin));
 
     // This should never even happen in the first place with 64-bit handles,
     while (handle_map.count(next_handle) != 0) {
         ++next_handle;
     }
     handle_map.emplace(next_handle, std::move(res));
+    handle_origins.emplace(next_handle, std::move(origin));
     return MakeResult<ArchiveHandle>(next_handle++);
 }
 
+ResultVal<std::unique_ptr<ArchiveBackend>> ArchiveManager::OpenArchiveBackend(
+    const ArchiveOrigin& origin) {
+    auto itr = id_code_map.find(origin.id_code);
+    if (itr == id_code_map.end()) {
+        return FileSys::ERROR_NOT_FOUND;
+    }
+    return itr->second->Open(origin.archive_path);
+}
+
 ResultCode ArchiveManager::CloseArchive(ArchiveHandle handle) {
     if (handle_map.erase(handle) == 0)
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
-    else
-        return RESULT_SUCCESS;
+
+    handle_origins.erase(handle);
+    return RESULT_SUCCESS;
 }
 
 // TODO(yuriks): This might be what the fs:REG service is for. See the Register/Unregister calls in
@@ -88,6 +96,8 @@ ResultVal<std::shared_ptr<File>> ArchiveManager::OpenFileFromArchive(ArchiveHand
         return backend.Code();
 
     auto file = std::shared_ptr<File>(new File(system, std::move(backend).Unwrap(), path));
+    file->origin = handle_origins.at(archive_handle);
+    file->mode = mode;
     return MakeResult<std::shared_ptr<File>>(std::move(file));
 }
 
@@ -180,7 +190,9 @@ ResultVal<std::shared_ptr<Directory>> ArchiveManager::OpenDirectoryFromArchive(
     if (backend.Failed())
         return backend.Code();
 
-    auto directory = std::shared_ptr<Directory>(new Directory(std::move(backend).Unwrap(), path));
+    auto directory =
+        std::shared_ptr<Directory>(new Directory(system, std::move(backend).Unwrap(), path));
+    directory->origin = handle_origins.at(archive_handle);
     return MakeResult<std::shared_ptr<Directory>>(std::move(directory));
 }
 
@@ -348,6 +360,54 @@ void ArchiveManager::RegisterSelfNCCH(Loader::AppLoader& app_loader) {
     factory->Register(app_loader);
 }
 
+ResultVal<std::unique_ptr<FileSys::FileBackend>> ArchiveManager::OpenFileBackend(
+    const ArchiveOrigin& origin, const FileSys::Path& path, FileSys::Mode mode) {
+    CASCADE_RESULT(std::unique_ptr<ArchiveBackend> archive, OpenArchiveBackend(origin));
+    return archive->OpenFile(path, mode);
+}
+
+ResultVal<std::unique_ptr<FileSys::DirectoryBackend>> ArchiveManager::OpenDirectoryBackend(
+    const ArchiveOrigin& origin, const FileSys::Path& path) {
+    CASCADE_RESULT(std::unique_ptr<ArchiveBackend> archive, OpenArchiveBackend(origin));
+    return archive->OpenDirectory(path);
+}
+
+void ArchiveManager::SaveState(Core::StateWriter& writer) const {
+    writer.Write(next_handle);
+    writer.Write(static_cast<u32>(handle_origins.size()));
+    for (const auto& [handle, origin] : handle_origins) {
+        writer.Write(handle);
+        writer.Write(origin.id_code);
+        origin.archive_path.SaveState(writer);
+    }
+}
+
+bool ArchiveManager::LoadState(Core::StateReader& reader) {
+    u32 archive_count;
+    if (!reader.Read(next_handle) || !reader.Read(archive_count)) {
+        return false;
+    }
+    handle_map.clear();
+    handle_origins.clear();
+    for (u32 i = 0; i < archive_count; ++i) {
+        ArchiveHandle handle;
+        ArchiveOrigin origin;
+        if (!reader.Read(handle) || !reader.Read(origin.id_code) ||
+            !origin.archive_path.LoadState(reader)) {
+            return false;
+        }
+        auto archive = OpenArchiveBackend(origin);
+        if (archive.Failed()) {
+            LOG_ERROR(Service_FS, "Unable to open the archive with id code 0x{:08X} again",
+                      static_cast<u32>(origin.id_code));
+            return false;
+        }
+        handle_map.emplace(handle, std::move(archive).Unwrap());
+        handle_origins.emplace(handle, std::move(origin));
+    }
+    return true;
+}
+
 ArchiveManager::ArchiveManager(Core::System& system) : system(system) {
     RegisterArchiveTypes();
 }
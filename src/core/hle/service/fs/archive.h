@@ -25,6 +25,8 @@ class AppLoader;
 }
 
 namespace Core {
+class StateReader;
+class StateWriter;
 class System;
 }
 
@@ -228,6 +230,32 @@ public:
     /// Registers a new NCCH file with the SelfNCCH archive factory
     void RegisterSelfNCCH(Loader::AppLoader& app_loader);
 
+    /**
+     * Opens a file again from the archive it was opened from, which is opened on its own
+     * @param origin The archive the file was opened from
+     * @param path Path to the file
+     * @param mode Mode the file was opened with
+     * @return The file backend, or the corresponding error code if failed
+     */
+    ResultVal<std::unique_ptr<FileSys::FileBackend>> OpenFileBackend(const ArchiveOrigin& origin,
+                                                                     const FileSys::Path& path,
+                                                                     FileSys::Mode mode);
+
+    /**
+     * Opens a directory again from the archive it was opened from, which is opened on its own
+     * @param origin The archive the directory was opened from
+     * @param path Path to the directory
+     * @return The directory backend, or the corresponding error code if failed
+     */
+    ResultVal<std::unique_ptr<FileSys::DirectoryBackend>> OpenDirectoryBackend(
+        const ArchiveOrigin& origin, const FileSys::Path& path);
+
+    /// Saves the handles of the open archives, along with where they were opened from
+    void SaveState(Core::StateWriter& writer) const;
+
+    /// Closes the open archives and opens the ones saved by SaveState
+    bool LoadState(Core::StateReader& reader);
+
 private:
     Core::System& system;
 
@@ -244,6 +272,9 @@ private:
 
     ArchiveBackend* GetArchive(ArchiveHandle handle);
 
+    /// Opens an archive that isn't given a handle
+    ResultVal<std::unique_ptr<ArchiveBackend>> OpenArchiveBackend(const ArchiveOrigin& origin);
+
     /**
      * Map of registered archives, identified by id code. Once an archive is registered here, it is
      * never removed until UnregisterArchiveTypes is called.
@@ -254,6 +285,8 @@ private:
      * Map of active archive handles to archive objects
      */
     std::unordered_map<ArchiveHandle, std::unique_ptr<ArchiveBackend>> handle_map;
+    /// Where the archives of the active handles were opened from
+    std::unordered_map<ArchiveHandle, ArchiveOrigin> handle_origins;
     ArchiveHandle next_handle = 1;
 };
 
@@ -3,15 +3,18 @@
 // Refer to the license.txt file included.
 
 #include "common/logging/log.h"
+#include "core/core.h"
 #include "core/file_sys/directory_backend.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/object_state.h"
+#include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/directory.h"
 
 namespace Service::FS {
 
-Directory::Directory(std::unique_ptr<FileSys::DirectoryBackend>&& backend,
+Directory::Directory(Core::System& system, std::unique_ptr<FileSys::DirectoryBackend>&& backend,
                      const FileSys::Path& path)
-    : ServiceFramework("", 1), path(path), backend(std::move(backend)) {
+    : ServiceFramework("", 1), path(path), backend(std::move(backend)), system(system) {
     static const FunctionInfo functions[] = {
         // clang-format off
         {0x08010042, &Directory::Read, "Read"},
@@ -23,6 +26,40 @@ Directory::Directory(std::unique_ptr<FileSys::DirectoryBackend>&& backend,
 
 Directory::~Directory() {}
 
+std::string Directory::GetStateKey() const {
+    return "FS::Directory";
+}
+
+void Directory::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    if (!origin) {
+        writer.Refuse("a directory that wasn't opened from an archive is open");
+        return;
+    }
+    writer.Write(origin->id_code);
+    origin->archive_path.SaveState(writer);
+    path.SaveState(writer);
+    writer.Write(entries_read);
+}
+
+bool Directory::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    ArchiveOrigin loaded_origin;
+    if (!reader.Read(loaded_origin.id_code) || !loaded_origin.archive_path.LoadState(reader) ||
+        !path.LoadState(reader) || !reader.Read(entries_read)) {
+        return false;
+    }
+    auto backend_result = system.ArchiveManager().OpenDirectoryBackend(loaded_origin, path);
+    if (backend_result.Failed()) {
+        LOG_ERROR(Service_FS, "Unable to open {} again", GetName());
+        return false;
+    }
+    backend = std::move(backend_result).Unwrap();
+    origin = std::move(loaded_origin);
+
+    // Skip the entries the guest has already read
+    std::vector<FileSys::Entry> entries(entries_read);
+    return backend->Read(entries_read, entries.data()) == entries_read;
+}
+
 void Directory::Read(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0801, 1, 2);
     u32 count = rp.Pop<u32>();
@@ -31,6 +68,7 @@ void Directory::Read(Kernel::HLERequestContext& ctx) {
     LOG_TRACE(Service_FS, "Read {}: count={}", GetName(), count);
     // Number of entries actually read
     u32 read = backend->Read(static_cast<u32>(entries.size()), entries.data());
+    entries_read += read;
     buffer.Write(entries.data(), 0, read * sizeof(FileSys::Entry));
 
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
@@ -4,15 +4,22 @@
 
 #pragma once
 
+#include <optional>
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/service/fs/file.h"
 #include "core/hle/service/service.h"
 
+namespace Core {
+class System;
+}
+
 namespace Service::FS {
 
 class Directory final : public ServiceFramework<Directory> {
 public:
-    Directory(std::unique_ptr<FileSys::DirectoryBackend>&& backend, const FileSys::Path& path);
+    Directory(Core::System& system, std::unique_ptr<FileSys::DirectoryBackend>&& backend,
+              const FileSys::Path& path);
     ~Directory();
 
     std::string GetName() const {
@@ -21,10 +28,21 @@ public:
 
     FileSys::Path path;                                 ///< Path of the directory
     std::unique_ptr<FileSys::DirectoryBackend> backend; ///< File backend interface
+    std::optional<ArchiveOrigin> origin;                ///< Archive of the directory
+
+    std::string GetStateKey() const override;
 
 protected:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
     void Read(Kernel::HLERequestContext& ctx);
     void Close(Kernel::HLERequestContext& ctx);
+
+private:
+    Core::System& system;
+    /// Number of entries read so far, which are skipped when the directory is opened again
+    u32 entries_read = 0;
 };
 
 } // namespace Service::FS
@@ -10,7 +10,9 @@
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/event.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/file.h"
 
 namespace Service::FS {
@@ -33,6 +35,38 @@ File::File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend
     RegisterHandlers(functions);
 }
 
+std::string File::GetStateKey() const {
+    return "FS::File";
+}
+
+void File::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    // Files such as the CIA being installed by AM only exist in memory
+    if (!origin) {
+        writer.Refuse("a file that wasn't opened from an archive is open");
+        return;
+    }
+    writer.Write(origin->id_code);
+    origin->archive_path.SaveState(writer);
+    path.SaveState(writer);
+    writer.Write(mode.hex);
+}
+
+bool File::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    ArchiveOrigin loaded_origin;
+    if (!reader.Read(loaded_origin.id_code) || !loaded_origin.archive_path.LoadState(reader) ||
+        !path.LoadState(reader) || !reader.Read(mode.hex)) {
+        return false;
+    }
+    auto backend_result = system.ArchiveManager().OpenFileBackend(loaded_origin, path, mode);
+    if (backend_result.Failed()) {
+        LOG_ERROR(Service_FS, "Unable to open {} again", GetName());
+        return false;
+    }
+    backend = std::move(backend_result).Unwrap();
+    origin = std::move(loaded_origin);
+    return true;
+}
+
 void File::Read(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0802, 3, 2);
     u64 offset = rp.Pop<u64>();
@@ -286,4 +320,16 @@ std::size_t File::GetSessionFileSize(Kernel::SharedPtr<Kernel::ServerSession> se
     return slot->size;
 }
 
+void FileSessionSlot::SaveState(Kernel::ObjectStateWriter& writer) const {
+    writer.Write(priority);
+    writer.Write(offset);
+    writer.Write(size);
+    writer.Write(subfile);
+}
+
+bool FileSessionSlot::LoadState(Kernel::ObjectStateReader& reader) {
+    return reader.Read(priority) && reader.Read(offset) && reader.Read(size) &&
+           reader.Read(subfile);
+}
+
 } // namespace Service::FS
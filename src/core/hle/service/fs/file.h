@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <optional>
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/service/service.h"
@@ -14,11 +15,22 @@ class System;
 
 namespace Service::FS {
 
+enum class ArchiveIdCode : u32;
+
+/// The archive a file or directory was opened from, which save states open it again from
+struct ArchiveOrigin {
+    ArchiveIdCode id_code;
+    FileSys::Path archive_path;
+};
+
 struct FileSessionSlot : public Kernel::SessionRequestHandler::SessionDataBase {
     u32 priority; ///< Priority of the file. TODO(Subv): Find out what this means
     u64 offset;   ///< Offset that this session will start reading from.
     u64 size;     ///< Max size of the file that this session is allowed to access
     bool subfile; ///< Whether this file was opened via OpenSubFile or not.
+
+    void SaveState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadState(Kernel::ObjectStateReader& reader) override;
 };
 
 // TODO: File is not a real service, but it can still utilize ServiceFramework::RegisterHandlers.
@@ -35,6 +47,10 @@ public:
 
     FileSys::Path path;                            ///< Path of the file
     std::unique_ptr<FileSys::FileBackend> backend; ///< File backend interface
+    std::optional<ArchiveOrigin> origin; ///< Archive of the file, unset if it isn't in one
+    FileSys::Mode mode{};                ///< Mode the file was opened with
+
+    std::string GetStateKey() const override;
 
     /// Creates a new session to this File and returns the ClientSession part of the connection.
     Kernel::SharedPtr<Kernel::ClientSession> Connect();
@@ -48,6 +64,9 @@ public:
     std::size_t GetSessionFileSize(Kernel::SharedPtr<Kernel::ServerSession> session);
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
     void Read(Kernel::HLERequestContext& ctx);
     void Write(Kernel::HLERequestContext& ctx);
     void GetSize(Kernel::HLERequestContext& ctx);
@@ -10,6 +10,7 @@
 #include "core/hle/ipc.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/kernel/shared_page.h"
 #include "core/hle/result.h"
@@ -775,6 +776,25 @@ SessionData* GSP_GPU::FindRegisteredThreadData(u32 thread_id) {
     return nullptr;
 }
 
+void GSP_GPU::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    writer.WriteObject(shared_memory);
+    writer.Write(active_thread_id);
+    writer.Write(first_initialization);
+}
+
+bool GSP_GPU::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    if (!reader.ReadObject(shared_memory) || shared_memory == nullptr ||
+        !reader.Read(active_thread_id) || !reader.Read(first_initialization)) {
+        return false;
+    }
+    // The sessions that were replaced have freed their thread ids, which may have been loaded
+    used_thread_ids.fill(false);
+    for (const auto& info : connected_sessions) {
+        used_thread_ids[static_cast<const SessionData*>(info.data.get())->thread_id] = true;
+    }
+    return true;
+}
+
 GSP_GPU::GSP_GPU(Core::System& system) : ServiceFramework("gsp::Gpu", 2), system(system) {
     static const FunctionInfo functions[] = {
         {0x00010082, &GSP_GPU::WriteHWRegs, "WriteHWRegs"},
@@ -834,4 +854,20 @@ SessionData::~SessionData() {
     used_thread_ids[thread_id] = false;
 }
 
+void SessionData::SaveState(Kernel::ObjectStateWriter& writer) const {
+    writer.WriteObject(interrupt_event);
+    writer.Write(thread_id);
+    writer.Write(registered);
+}
+
+bool SessionData::LoadState(Kernel::ObjectStateReader& reader) {
+    used_thread_ids[thread_id] = false;
+    if (!reader.ReadObject(interrupt_event) || !reader.Read(thread_id) ||
+        thread_id >= MaxGSPThreads || !reader.Read(registered)) {
+        return false;
+    }
+    used_thread_ids[thread_id] = true;
+    return true;
+}
+
 } // namespace Service::GSP
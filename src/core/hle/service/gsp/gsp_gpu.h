@@ -192,6 +192,9 @@ struct SessionData : public Kernel::SessionRequestHandler::SessionDataBase {
     u32 thread_id;
     /// Whether RegisterInterruptRelayQueue was called for this session
     bool registered = false;
+
+    void SaveState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadState(Kernel::ObjectStateReader& reader) override;
 };
 
 class GSP_GPU final : public ServiceFramework<GSP_GPU, SessionData> {
@@ -218,6 +221,9 @@ public:
     FrameBufferUpdate* GetFrameBufferInfo(u32 thread_id, u32 screen_index);
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
     /**
      * Signals that the specified interrupt type has occurred to userland code for the specified GSP
      * thread id.
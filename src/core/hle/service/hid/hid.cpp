@@ -11,6 +11,7 @@
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/service/hid/hid.h"
 #include "core/hle/service/hid/hid_spvr.h"
@@ -357,6 +358,42 @@ std::shared_ptr<Module> Module::Interface::GetModule() const {
     return hid;
 }
 
+void Module::Interface::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    if (writer.MarkSharedState(hid.get())) {
+        hid->SaveState(writer);
+    }
+}
+
+bool Module::Interface::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadSharedState([&] { return hid->LoadState(reader); });
+}
+
+void Module::SaveState(Kernel::ObjectStateWriter& writer) const {
+    writer.WriteObject(shared_mem);
+    writer.WriteObject(event_pad_or_touch_1);
+    writer.WriteObject(event_pad_or_touch_2);
+    writer.WriteObject(event_accelerometer);
+    writer.WriteObject(event_gyroscope);
+    writer.WriteObject(event_debug_pad);
+    writer.Write(state.hex);
+    writer.Write(next_pad_index);
+    writer.Write(next_touch_index);
+    writer.Write(next_accelerometer_index);
+    writer.Write(next_gyroscope_index);
+    writer.Write(enable_accelerometer_count);
+    writer.Write(enable_gyroscope_count);
+}
+
+bool Module::LoadState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadObject(shared_mem) && shared_mem != nullptr &&
+           reader.ReadObject(event_pad_or_touch_1) && reader.ReadObject(event_pad_or_touch_2) &&
+           reader.ReadObject(event_accelerometer) && reader.ReadObject(event_gyroscope) &&
+           reader.ReadObject(event_debug_pad) && reader.Read(state.hex) &&
+           reader.Read(next_pad_index) && reader.Read(next_touch_index) &&
+           reader.Read(next_accelerometer_index) && reader.Read(next_gyroscope_index) &&
+           reader.Read(enable_accelerometer_count) && reader.Read(enable_gyroscope_count);
+}
+
 Module::Module(Core::System& system) : system(system) {
     using namespace Kernel;
 
@@ -4,11 +4,14 @@
 
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include "common/string_util.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/file_sys/archive_ncch.h"
 #include "core/file_sys/file_backend.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/ipc.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/romfs.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/hle/service/http_c.h"
@@ -21,12 +24,16 @@ enum {
     InvalidRequestState = 22,
     TooManyContexts = 26,
     InvalidRequestMethod = 32,
+    HeaderNotFound = 40,
+    DownloadPending = 43,
+    ConnectionFailed = 70,
     ContextNotFound = 100,
 
     /// This error is returned in multiple situations: when trying to initialize an
     /// already-initialized session, or when using the wrong context handle in a context-bound
     /// session
     SessionStateError = 102,
+    Timeout = 105,
     TooManyClientCerts = 203,
     NotImplemented = 1012,
 };
@@ -43,6 +50,236 @@ const ResultCode ERROR_TOO_MANY_CLIENT_CERTS = // 0xD8A0A0CB
                ErrorLevel::Permanent);
 const ResultCode ERROR_WRONG_CERT_ID = // 0xD8E0B839
     ResultCode(57, ErrorModule::SSL, ErrorSummary::InvalidArgument, ErrorLevel::Permanent);
+const ResultCode ERROR_CONTEXT_NOT_FOUND = // 0xD8A0A064
+    ResultCode(ErrCodes::ContextNotFound, ErrorModule::HTTP, ErrorSummary::InvalidState,
+               ErrorLevel::Permanent);
+const ResultCode ERROR_INVALID_REQUEST_STATE = // 0xD8A0A016
+    ResultCode(ErrCodes::InvalidRequestState, ErrorModule::HTTP, ErrorSummary::InvalidState,
+               ErrorLevel::Permanent);
+const ResultCode ERROR_HEADER_NOT_FOUND = // 0xD8A0A028
+    ResultCode(ErrCodes::HeaderNotFound, ErrorModule::HTTP, ErrorSummary::InvalidState,
+               ErrorLevel::Permanent);
+const ResultCode ERROR_DOWNLOAD_PENDING = // 0xD840A02B
+    ResultCode(ErrCodes::DownloadPending, ErrorModule::HTTP, ErrorSummary::WouldBlock,
+               ErrorLevel::Permanent);
+const ResultCode ERROR_CONNECTION_FAILED = // 0xD8A0A046
+    ResultCode(ErrCodes::ConnectionFailed, ErrorModule::HTTP, ErrorSummary::InvalidState,
+               ErrorLevel::Permanent);
+const ResultCode ERROR_TIMEOUT = // 0xD820A069
+    ResultCode(ErrCodes::Timeout, ErrorModule::HTTP, ErrorSummary::NothingHappened,
+               ErrorLevel::Permanent);
+
+namespace {
+
+std::string GetMethodName(RequestMethod method) {
+    switch (method) {
+    case RequestMethod::Get:
+        return "GET";
+    case RequestMethod::Post:
+    case RequestMethod::PostEmpty:
+        return "POST";
+    case RequestMethod::Head:
+        return "HEAD";
+    case RequestMethod::Put:
+    case RequestMethod::PutEmpty:
+        return "PUT";
+    case RequestMethod::Delete:
+        return "DELETE";
+    default:
+        UNREACHABLE_MSG("Invalid request method {}", static_cast<u32>(method));
+        return "";
+    }
+}
+
+/// Percent-encodes everything but the unreserved characters of RFC 3986
+std::string EncodeFormComponent(const std::string& component) {
+    static constexpr char hex_digits[] = "0123456789ABCDEF";
+    std::string encoded;
+    for (const char c : component) {
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+            c == '-' || c == '.' || c == '_' || c == '~') {
+            encoded += c;
+        } else {
+            encoded += '%';
+            encoded += hex_digits[static_cast<u8>(c) >> 4];
+            encoded += hex_digits[static_cast<u8>(c) & 0xF];
+        }
+    }
+    return encoded;
+}
+
+/// Whether a transfer will make no more progress visible to the guest. Must be called locked.
+bool IsStopped(const Transfer& transfer) {
+    return transfer.IsDone() || transfer.cancelled;
+}
+
+bool HasResponseHeaders(Transfer& transfer) {
+    std::lock_guard lock(transfer.mutex);
+    return transfer.HasHeaders() || IsStopped(transfer);
+}
+
+ResultCode GetTransferResult(Transfer& transfer) {
+    std::lock_guard lock(transfer.mutex);
+    if (transfer.cancelled || transfer.stage == Transfer::Stage::Failed) {
+        return ERROR_CONNECTION_FAILED;
+    }
+    return RESULT_SUCCESS;
+}
+
+RequestState ComputeRequestState(const Context& context) {
+    if (!context.transfer) {
+        return context.state;
+    }
+    std::lock_guard lock(context.transfer->mutex);
+    switch (context.transfer->stage) {
+    case Transfer::Stage::Queued:
+    case Transfer::Stage::Connecting:
+        return RequestState::InProgress;
+    case Transfer::Stage::ReceivingBody:
+    case Transfer::Stage::Finished:
+        return RequestState::ReadyToDownloadContent;
+    case Transfer::Stage::Failed:
+    default:
+        return RequestState::TimedOut;
+    }
+}
+
+/// Copies the next part of the response body into a buffer. The transfer must be locked.
+std::size_t CopyResponseBody(Context& context, Kernel::MappedBuffer& buffer, std::size_t offset,
+                             std::size_t size) {
+    const std::string& body = context.transfer->body;
+    const std::size_t available = body.size() - static_cast<std::size_t>(context.read_offset);
+    const std::size_t copied = std::min(size, available);
+    if (copied != 0) {
+        buffer.Write(body.data() + context.read_offset, offset, copied);
+        context.read_offset += copied;
+    }
+    return copied;
+}
+
+} // Anonymous namespace
+
+ResultCode HTTP_C::StartTransfer(Context& context) {
+    if (context.state != RequestState::NotStarted) {
+        LOG_ERROR(Service_HTTP,
+                  "Tried to begin a request on a context that has already been started.");
+        return ERROR_INVALID_REQUEST_STATE;
+    }
+
+    RequestDescription request;
+    request.method = GetMethodName(context.method);
+    request.url = context.url;
+    for (const Context::RequestHeader& header : context.headers) {
+        request.headers.emplace_back(header.name, header.value);
+    }
+
+    if (!context.post_data.empty()) {
+        for (const Context::PostData& post_data : context.post_data) {
+            if (!request.body.empty()) {
+                request.body += '&';
+            }
+            request.body += EncodeFormComponent(post_data.name) + '=' +
+                            EncodeFormComponent(post_data.value);
+        }
+        const bool has_content_type =
+            std::any_of(request.headers.begin(), request.headers.end(), [](const auto& header) {
+                return Common::ToLower(header.first) == "content-type";
+            });
+        if (!has_content_type) {
+            request.headers.emplace_back("Content-Type", "application/x-www-form-urlencoded");
+        }
+    }
+
+    context.transfer = request_engine.Start(
+        std::move(request), [&timing = system.CoreTiming(), event_type = transfer_updated_event,
+                             context_handle = context.handle] {
+            timing.ScheduleEventThreadsafe(0, event_type, context_handle);
+        });
+    context.state = RequestState::InProgress;
+    return RESULT_SUCCESS;
+}
+
+ResultCode HTTP_C::ValidateBoundContext(Kernel::HLERequestContext& ctx,
+                                        Context::Handle context_handle) {
+    auto* session_data = GetSessionData(ctx.Session());
+    ASSERT(session_data);
+
+    if (!session_data->initialized) {
+        LOG_ERROR(Service_HTTP, "Command called on an uninitialized session");
+        return ERROR_STATE_ERROR;
+    }
+
+    // These commands can only be called with a bound context
+    if (!session_data->current_http_context) {
+        LOG_ERROR(Service_HTTP, "Command called without a bound context");
+        return ERROR_NOT_IMPLEMENTED;
+    }
+
+    if (session_data->current_http_context != context_handle) {
+        LOG_ERROR(Service_HTTP, "Command called on a mismatched session input context={} session "
+                                "context={}",
+                  context_handle, *session_data->current_http_context);
+        return ERROR_STATE_ERROR;
+    }
+
+    if (contexts.find(context_handle) == contexts.end()) {
+        return ERROR_CONTEXT_NOT_FOUND;
+    }
+    return RESULT_SUCCESS;
+}
+
+void HTTP_C::WaitForTransfer(Kernel::HLERequestContext& ctx, Context::Handle context_handle,
+                             const std::string& reason, std::chrono::nanoseconds timeout,
+                             std::function<bool()> is_ready, ReplyCallback reply) {
+    if (is_ready()) {
+        reply(ctx, Kernel::ThreadWakeupReason::Signal);
+        return;
+    }
+
+    const u64 waiter_id = next_waiter_id++;
+    auto event = ctx.SleepClientThread(
+        system.Kernel().GetThreadManager().GetCurrentThread(), reason, timeout,
+        [this, waiter_id, reply](Kernel::SharedPtr<Kernel::Thread> thread,
+                                 Kernel::HLERequestContext& ctx,
+                                 Kernel::ThreadWakeupReason reason) {
+            transfer_waiters.erase(waiter_id);
+            reply(ctx, reason);
+        });
+    transfer_waiters.emplace(waiter_id,
+                             TransferWaiter{context_handle, std::move(event), std::move(is_ready)});
+}
+
+void HTTP_C::TransferUpdated(Context::Handle context_handle) {
+    const auto itr = contexts.find(context_handle);
+    if (itr == contexts.end() || !itr->second.transfer) {
+        return;
+    }
+    // Cleared first, so that any progress made from now on schedules another update
+    itr->second.transfer->update_pending = false;
+
+    std::vector<Kernel::SharedPtr<Kernel::Event>> ready;
+    for (const auto& [waiter_id, waiter] : transfer_waiters) {
+        if (waiter.context_handle == context_handle && waiter.is_ready()) {
+            ready.push_back(waiter.event);
+        }
+    }
+    // Signalling runs the wakeup callbacks, which remove the waiters
+    for (const auto& event : ready) {
+        event->Signal();
+    }
+}
+
+void HTTP_C::WakeTransferWaiters(Context::Handle context_handle) {
+    std::vector<Kernel::SharedPtr<Kernel::Event>> waiting;
+    for (const auto& [waiter_id, waiter] : transfer_waiters) {
+        if (waiter.context_handle == context_handle) {
+            waiting.push_back(waiter.event);
+        }
+    }
+    for (const auto& event : waiting) {
+        event->Signal();
+    }
+}
 
 void HTTP_C::Initialize(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x1, 1, 4);
@@ -211,8 +448,11 @@ void HTTP_C::CloseContext(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    // TODO(Subv): What happens if you try to close a context that's currently being used?
-    ASSERT(itr->second.state == RequestState::NotStarted);
+    // Threads still waiting for the request get their reply before the context goes away
+    if (itr->second.transfer) {
+        request_engine.Cancel(*itr->second.transfer);
+        WakeTransferWaiters(context_handle);
+    }
 
     // TODO(Subv): Make sure that only the session that created the context can close it.
 
@@ -374,6 +614,343 @@ void HTTP_C::AddPostDataAscii(Kernel::HLERequestContext& ctx) {
               context_handle);
 }
 
+void HTTP_C::CancelConnection(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x4, 1, 0);
+    const Context::Handle context_handle = rp.Pop<u32>();
+
+    LOG_DEBUG(Service_HTTP, "called, context_handle={}", context_handle);
+
+    const ResultCode result = ValidateBoundContext(ctx, context_handle);
+    if (result.IsSuccess()) {
+        const std::shared_ptr<Transfer>& transfer = contexts[context_handle].transfer;
+        if (transfer) {
+            request_engine.Cancel(*transfer);
+            WakeTransferWaiters(context_handle);
+        }
+    }
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+    rb.Push(result);
+}
+
+void HTTP_C::GetRequestState(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x5, 1, 0);
+    const Context::Handle context_handle = rp.Pop<u32>();
+
+    LOG_DEBUG(Service_HTTP, "called, context_handle={}", context_handle);
+
+    const ResultCode result = ValidateBoundContext(ctx, context_handle);
+    if (result.IsError()) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+        rb.Push(result);
+        return;
+    }
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
+    rb.Push(RESULT_SUCCESS);
+    rb.PushEnum(ComputeRequestState(contexts[context_handle]));
+}
+
+void HTTP_C::GetDownloadSizeState(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x6, 1, 0);
+    const Context::Handle context_handle = rp.Pop<u32>();
+
+    LOG_DEBUG(Service_HTTP, "called, context_handle={}", context_handle);
+
+    const ResultCode result = ValidateBoundContext(ctx, context_handle);
+    if (result.IsError()) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+        rb.Push(result);
+        return;
+    }
+
+    u32 received_size = 0;
+    u32 content_length = 0;
+    if (const std::shared_ptr<Transfer>& transfer = contexts[context_handle].transfer) {
+        std::lock_guard lock(transfer->mutex);
+        received_size = static_cast<u32>(transfer->body.size());
+        content_length = static_cast<u32>(transfer->content_length);
+    }
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(3, 0);
+    rb.Push(RESULT_SUCCESS);
+    rb.Push(received_size);
+    rb.Push(content_length);
+}
+
+void HTTP_C::BeginRequest(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x9, 1, 0);
+    const Context::Handle context_handle = rp.Pop<u32>();
+
+    LOG_DEBUG(Service_HTTP, "called, context_handle={}", context_handle);
+
+    ResultCode result = ValidateBoundContext(ctx, context_handle);
+    if (result.IsSuccess()) {
+        result = StartTransfer(contexts[context_handle]);
+    }
+    if (result.IsError()) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+        rb.Push(result);
+        return;
+    }
+
+    std::shared_ptr<Transfer> transfer = contexts[context_handle].transfer;
+    WaitForTransfer(ctx, context_handle, "http:BeginRequest", std::chrono::nanoseconds(0),
+                    [transfer] { return HasResponseHeaders(*transfer); },
+                    [transfer](Kernel::HLERequestContext& ctx, Kernel::ThreadWakeupReason reason) {
+                        IPC::RequestBuilder rb(ctx, 0x9, 1, 0);
+                        rb.Push(GetTransferResult(*transfer));
+                    });
+}
+
+void HTTP_C::BeginRequestAsync(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0xA, 1, 0);
+    const Context::Handle context_handle = rp.Pop<u32>();
+
+    LOG_DEBUG(Service_HTTP, "called, context_handle={}", context_handle);
+
+    ResultCode result = ValidateBoundContext(ctx, context_handle);
+    if (result.IsSuccess()) {
+        result = StartTransfer(contexts[context_handle]);
+    }
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+    rb.Push(result);
+}
+
+void HTTP_C::ReceiveData(Kernel::HLERequestContext& ctx) {
+    ReceiveDataImpl(ctx, false);
+}
+
+void HTTP_C::ReceiveDataTimeout(Kernel::HLERequestContext& ctx) {
+    ReceiveDataImpl(ctx, true);
+}
+
+void HTTP_C::ReceiveDataImpl(Kernel::HLERequestContext& ctx, bool timeout) {
+    const u16 command_id = timeout ? 0xC : 0xB;
+    IPC::RequestParser rp(ctx, command_id, timeout ? 4 : 2, 2);
+    const Context::Handle context_handle = rp.Pop<u32>();
+    const u32 buffer_size = rp.Pop<u32>();
+    u64 timeout_nanos = 0;
+    if (timeout) {
+        timeout_nanos = rp.Pop<u64>();
+    }
+    Kernel::MappedBuffer& buffer = rp.PopMappedBuffer();
+
+    LOG_DEBUG(Service_HTTP, "called, context_handle={}, buffer_size={}, timeout={}",
+              context_handle, buffer_size, timeout_nanos);
+
+    ResultCode result = ValidateBoundContext(ctx, context_handle);
+    if (result.IsSuccess() && !contexts[context_handle].transfer) {
+        LOG_ERROR(Service_HTTP, "Tried to receive data before the request was started");
+        result = ERROR_INVALID_REQUEST_STATE;
+    }
+    if (result.IsError()) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
+        rb.Push(result);
+        rb.PushMappedBuffer(buffer);
+        return;
+    }
+
+    // The guest buffer is filled as the body arrives, so that no copy of a chunk outlives it
+    struct Receive {
+        Kernel::MappedBuffer buffer;
+        std::size_t size;
+        std::size_t written;
+    };
+    auto receive = std::make_shared<Receive>(
+        Receive{buffer, std::min<std::size_t>(buffer_size, buffer.GetSize()), 0});
+
+    const auto is_ready = [this, context_handle, receive] {
+        const auto itr = contexts.find(context_handle);
+        if (itr == contexts.end()) {
+            return true;
+        }
+        Context& context = itr->second;
+        std::lock_guard lock(context.transfer->mutex);
+        receive->written += CopyResponseBody(context, receive->buffer, receive->written,
+                                             receive->size - receive->written);
+        return receive->written == receive->size || IsStopped(*context.transfer);
+    };
+
+    const auto reply = [this, context_handle, receive, command_id](
+                           Kernel::HLERequestContext& ctx, Kernel::ThreadWakeupReason reason) {
+        ResultCode result = ERROR_CONTEXT_NOT_FOUND;
+        const auto itr = contexts.find(context_handle);
+        if (itr != contexts.end()) {
+            Transfer& transfer = *itr->second.transfer;
+            result = GetTransferResult(transfer);
+            std::lock_guard lock(transfer.mutex);
+            if (result.IsSuccess() &&
+                (!transfer.IsDone() || itr->second.read_offset < transfer.body.size())) {
+                const bool timed_out = reason == Kernel::ThreadWakeupReason::Timeout;
+                result = timed_out && receive->written == 0 ? ERROR_TIMEOUT
+                                                            : ERROR_DOWNLOAD_PENDING;
+            }
+        }
+
+        IPC::RequestBuilder rb(ctx, command_id, 1, 2);
+        rb.Push(result);
+        rb.PushMappedBuffer(receive->buffer);
+    };
+
+    WaitForTransfer(ctx, context_handle, "http:ReceiveData",
+                    std::chrono::nanoseconds(timeout_nanos), is_ready, reply);
+}
+
+void HTTP_C::GetResponseHeader(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x1E, 3, 4);
+    const Context::Handle context_handle = rp.Pop<u32>();
+    const u32 name_size = rp.Pop<u32>();
+    const u32 value_size = rp.Pop<u32>();
+    const std::vector<u8> name_buffer = rp.PopStaticBuffer();
+    Kernel::MappedBuffer& value_buffer = rp.PopMappedBuffer();
+
+    // Copy the name_buffer into a string without the \0 at the end
+    const std::string name(name_buffer.begin(), name_buffer.end() - 1);
+
+    LOG_DEBUG(Service_HTTP, "called, name={}, name_size={}, value_size={}, context_handle={}",
+              name, name_size, value_size, context_handle);
+
+    ResultCode result = ValidateBoundContext(ctx, context_handle);
+    if (result.IsSuccess() && !contexts[context_handle].transfer) {
+        LOG_ERROR(Service_HTTP, "Tried to get a response header before the request was started");
+        result = ERROR_INVALID_REQUEST_STATE;
+    }
+    if (result.IsError()) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
+        rb.Push(result);
+        rb.PushMappedBuffer(value_buffer);
+        return;
+    }
+
+    std::shared_ptr<Transfer> transfer = contexts[context_handle].transfer;
+    const std::size_t size = std::min<std::size_t>(value_size, value_buffer.GetSize());
+    const auto reply = [transfer, name = Common::ToLower(name), value_buffer,
+                        size](Kernel::HLERequestContext& ctx,
+                              Kernel::ThreadWakeupReason reason) mutable {
+        ResultCode result = GetTransferResult(*transfer);
+        u32 written = 0;
+        if (result.IsSuccess()) {
+            std::lock_guard lock(transfer->mutex);
+            const auto header = std::find_if(
+                transfer->headers.begin(), transfer->headers.end(),
+                [&name](const auto& header) { return Common::ToLower(header.first) == name; });
+            if (header == transfer->headers.end()) {
+                result = ERROR_HEADER_NOT_FOUND;
+            } else if (size != 0) {
+                // The value is truncated to the buffer, which always gets a null-terminator
+                const std::string value = header->second.substr(0, size - 1);
+                value_buffer.Write(value.c_str(), 0, value.size() + 1);
+                written = static_cast<u32>(value.size() + 1);
+            }
+        }
+
+        IPC::RequestBuilder rb(ctx, 0x1E, 2, 2);
+        rb.Push(result);
+        rb.Push(written);
+        rb.PushMappedBuffer(value_buffer);
+    };
+
+    WaitForTransfer(ctx, context_handle, "http:GetResponseHeader", std::chrono::nanoseconds(0),
+                    [transfer] { return HasResponseHeaders(*transfer); }, reply);
+}
+
+void HTTP_C::GetResponseData(Kernel::HLERequestContext& ctx) {
+    GetResponseDataImpl(ctx, false);
+}
+
+void HTTP_C::GetResponseDataTimeout(Kernel::HLERequestContext& ctx) {
+    GetResponseDataImpl(ctx, true);
+}
+
+void HTTP_C::GetResponseDataImpl(Kernel::HLERequestContext& ctx, bool timeout) {
+    const u16 command_id = timeout ? 0x21 : 0x20;
+    IPC::RequestParser rp(ctx, command_id, timeout ? 4 : 2, 2);
+    const Context::Handle context_handle = rp.Pop<u32>();
+    const u32 buffer_size = rp.Pop<u32>();
+    u64 timeout_nanos = 0;
+    if (timeout) {
+        timeout_nanos = rp.Pop<u64>();
+    }
+    Kernel::MappedBuffer& buffer = rp.PopMappedBuffer();
+
+    LOG_DEBUG(Service_HTTP, "called, context_handle={}, buffer_size={}, timeout={}",
+              context_handle, buffer_size, timeout_nanos);
+
+    ResultCode result = ValidateBoundContext(ctx, context_handle);
+    if (result.IsSuccess() && !contexts[context_handle].transfer) {
+        LOG_ERROR(Service_HTTP, "Tried to get the response headers before the request was started");
+        result = ERROR_INVALID_REQUEST_STATE;
+    }
+    if (result.IsError()) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
+        rb.Push(result);
+        rb.PushMappedBuffer(buffer);
+        return;
+    }
+
+    std::shared_ptr<Transfer> transfer = contexts[context_handle].transfer;
+    const std::size_t size = std::min<std::size_t>(buffer_size, buffer.GetSize());
+    const auto reply = [transfer, buffer, size, command_id](
+                           Kernel::HLERequestContext& ctx,
+                           Kernel::ThreadWakeupReason reason) mutable {
+        ResultCode result = GetTransferResult(*transfer);
+        if (result.IsSuccess() && !HasResponseHeaders(*transfer)) {
+            result = ERROR_TIMEOUT;
+        }
+        if (result.IsSuccess() && size != 0) {
+            std::string data;
+            {
+                std::lock_guard lock(transfer->mutex);
+                for (const auto& [name, value] : transfer->headers) {
+                    data += name + ": " + value + "\r\n";
+                }
+            }
+            // The data is truncated to the buffer, which always gets a null-terminator
+            data.resize(std::min(data.size(), size - 1));
+            buffer.Write(data.c_str(), 0, data.size() + 1);
+        }
+
+        IPC::RequestBuilder rb(ctx, command_id, 1, 2);
+        rb.Push(result);
+        rb.PushMappedBuffer(buffer);
+    };
+
+    WaitForTransfer(ctx, context_handle, "http:GetResponseData",
+                    std::chrono::nanoseconds(timeout_nanos),
+                    [transfer] { return HasResponseHeaders(*transfer); }, reply);
+}
+
+void HTTP_C::GetResponseStatusCode(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x22, 1, 0);
+    const Context::Handle context_handle = rp.Pop<u32>();
+
+    LOG_DEBUG(Service_HTTP, "called, context_handle={}", context_handle);
+
+    ResultCode result = ValidateBoundContext(ctx, context_handle);
+    if (result.IsSuccess() && !contexts[context_handle].transfer) {
+        LOG_ERROR(Service_HTTP, "Tried to get the status code before the request was started");
+        result = ERROR_INVALID_REQUEST_STATE;
+    }
+    if (result.IsError()) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+        rb.Push(result);
+        return;
+    }
+
+    std::shared_ptr<Transfer> transfer = contexts[context_handle].transfer;
+    WaitForTransfer(ctx, context_handle, "http:GetResponseStatusCode", std::chrono::nanoseconds(0),
+                    [transfer] { return HasResponseHeaders(*transfer); },
+                    [transfer](Kernel::HLERequestContext& ctx, Kernel::ThreadWakeupReason reason) {
+                        const ResultCode result = GetTransferResult(*transfer);
+                        std::lock_guard lock(transfer->mutex);
+                        IPC::RequestBuilder rb(ctx, 0x22, 2, 0);
+                        rb.Push(result);
+                        rb.Push<u32>(result.IsSuccess() ? transfer->status_code : 0);
+                    });
+}
+
 void HTTP_C::OpenClientCertContext(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x32, 2, 4);
     u32 cert_size = rp.Pop<u32>();
@@ -604,20 +1181,60 @@ void HTTP_C::DecryptClCertA() {
     ClCertA.init = true;
 }
 
-HTTP_C::HTTP_C() : ServiceFramework("http:C", 32) {
+void SessionData::SaveState(Kernel::ObjectStateWriter& writer) const {
+    writer.Write(current_http_context.has_value());
+    writer.Write(current_http_context.value_or(0));
+    writer.Write(session_id);
+    writer.Write(num_http_contexts);
+    writer.Write(num_client_certs);
+    writer.Write(initialized);
+}
+
+bool SessionData::LoadState(Kernel::ObjectStateReader& reader) {
+    bool has_context;
+    Context::Handle context_handle;
+    if (!reader.Read(has_context) || !reader.Read(context_handle) || !reader.Read(session_id) ||
+        !reader.Read(num_http_contexts) || !reader.Read(num_client_certs) ||
+        !reader.Read(initialized)) {
+        return false;
+    }
+    current_http_context.reset();
+    if (has_context) {
+        current_http_context = context_handle;
+    }
+    return true;
+}
+
+void HTTP_C::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    // The contexts hold connections to the host
+    if (!contexts.empty() || !client_certs.empty() || !transfer_waiters.empty()) {
+        writer.Refuse("HTTP contexts are open");
+    }
+    writer.WriteObject(shared_memory);
+    writer.Write(session_counter);
+    writer.Write(context_counter);
+    writer.Write(client_certs_counter);
+}
+
+bool HTTP_C::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadObject(shared_memory) && reader.Read(session_counter) &&
+           reader.Read(context_counter) && reader.Read(client_certs_counter);
+}
+
+HTTP_C::HTTP_C(Core::System& system) : ServiceFramework("http:C", 32), system(system) {
     static const FunctionInfo functions[] = {
         {0x00010044, &HTTP_C::Initialize, "Initialize"},
         {0x00020082, &HTTP_C::CreateContext, "CreateContext"},
         {0x00030040, &HTTP_C::CloseContext, "CloseContext"},
-        {0x00040040, nullptr, "CancelConnection"},
-        {0x00050040, nullptr, "GetRequestState"},
-        {0x00060040, nullptr, "GetDownloadSizeState"},
+        {0x00040040, &HTTP_C::CancelConnection, "CancelConnection"},
+        {0x00050040, &HTTP_C::GetRequestState, "GetRequestState"},
+        {0x00060040, &HTTP_C::GetDownloadSizeState, "GetDownloadSizeState"},
         {0x00070040, nullptr, "GetRequestError"},
         {0x00080042, &HTTP_C::InitializeConnectionSession, "InitializeConnectionSession"},
-        {0x00090040, nullptr, "BeginRequest"},
-        {0x000A0040, nullptr, "BeginRequestAsync"},
-        {0x000B0082, nullptr, "ReceiveData"},
-        {0x000C0102, nullptr, "ReceiveDataTimeout"},
+        {0x00090040, &HTTP_C::BeginRequest, "BeginRequest"},
+        {0x000A0040, &HTTP_C::BeginRequestAsync, "BeginRequestAsync"},
+        {0x000B0082, &HTTP_C::ReceiveData, "ReceiveData"},
+        {0x000C0102, &HTTP_C::ReceiveDataTimeout, "ReceiveDataTimeout"},
         {0x000D0146, nullptr, "SetProxy"},
         {0x000E0040, nullptr, "SetProxyDefault"},
         {0x000F00C4, nullptr, "SetBasicAuthorization"},
@@ -635,11 +1252,11 @@ HTTP_C::HTTP_C() : ServiceFramework("http:C", 32) {
         {0x001B0102, nullptr, "SendPOSTDataRawTimeout"},
         {0x001C0080, nullptr, "SetPostDataEncoding"},
         {0x001D0040, nullptr, "NotifyFinishSendPostData"},
-        {0x001E00C4, nullptr, "GetResponseHeader"},
+        {0x001E00C4, &HTTP_C::GetResponseHeader, "GetResponseHeader"},
         {0x001F0144, nullptr, "GetResponseHeaderTimeout"},
-        {0x00200082, nullptr, "GetResponseData"},
-        {0x00210102, nullptr, "GetResponseDataTimeout"},
-        {0x00220040, nullptr, "GetResponseStatusCode"},
+        {0x00200082, &HTTP_C::GetResponseData, "GetResponseData"},
+        {0x00210102, &HTTP_C::GetResponseDataTimeout, "GetResponseDataTimeout"},
+        {0x00220040, &HTTP_C::GetResponseStatusCode, "GetResponseStatusCode"},
         {0x002300C0, nullptr, "GetResponseStatusCodeTimeout"},
         {0x00240082, nullptr, "AddTrustedRootCA"},
         {0x00250080, nullptr, "AddDefaultCert"},
@@ -665,11 +1282,15 @@ HTTP_C::HTTP_C() : ServiceFramework("http:C", 32) {
     };
     RegisterHandlers(functions);
 
+    transfer_updated_event = system.CoreTiming().RegisterEvent(
+        "HTTP_C::TransferUpdated",
+        [this](u64 context_handle, int cycles_late) { TransferUpdated(context_handle); });
+
     DecryptClCertA();
 }
 
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
-    std::make_shared<HTTP_C>()->InstallAsService(service_manager);
+    std::make_shared<HTTP_C>(system)->InstallAsService(service_manager);
 }
 } // namespace Service::HTTP
@@ -4,17 +4,22 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "core/hle/kernel/event.h"
 #include "core/hle/kernel/shared_memory.h"
+#include "core/hle/service/http_engine.h"
 #include "core/hle/service/service.h"
 
 namespace Core {
 class System;
-}
+struct TimingEventType;
+} // namespace Core
 
 namespace Service::HTTP {
 
@@ -123,6 +128,11 @@ public:
     u32 socket_buffer_size;
     std::vector<RequestHeader> headers;
     std::vector<PostData> post_data;
+
+    /// The request sent by BeginRequest, or nullptr if it has not been started
+    std::shared_ptr<Transfer> transfer;
+    /// Number of bytes of the response body already received by the application
+    u64 read_offset = 0;
 };
 
 struct SessionData : public Kernel::SessionRequestHandler::SessionDataBase {
@@ -140,13 +150,19 @@ struct SessionData : public Kernel::SessionRequestHandler::SessionDataBase {
     /// Whether this session has been initialized in some way, be it via Initialize or
     /// InitializeConnectionSession.
     bool initialized = false;
+
+    void SaveState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadState(Kernel::ObjectStateReader& reader) override;
 };
 
 class HTTP_C final : public ServiceFramework<HTTP_C, SessionData> {
 public:
-    HTTP_C();
+    explicit HTTP_C(Core::System& system);
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
     /**
      * HTTP_C::Initialize service function
      *  Inputs:
@@ -193,6 +209,80 @@ private:
      */
     void InitializeConnectionSession(Kernel::HLERequestContext& ctx);
 
+    /**
+     * HTTP_C::CancelConnection service function
+     *  Inputs:
+     *      1 : Context handle
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     */
+    void CancelConnection(Kernel::HLERequestContext& ctx);
+
+    /**
+     * HTTP_C::GetRequestState service function
+     *  Inputs:
+     *      1 : Context handle
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     *      2 : RequestState
+     */
+    void GetRequestState(Kernel::HLERequestContext& ctx);
+
+    /**
+     * HTTP_C::GetDownloadSizeState service function
+     *  Inputs:
+     *      1 : Context handle
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     *      2 : Size of the response body received so far
+     *      3 : Size of the response body from the Content-Length header, or 0 if unknown
+     */
+    void GetDownloadSizeState(Kernel::HLERequestContext& ctx);
+
+    /**
+     * HTTP_C::BeginRequest service function. Waits for the response headers.
+     *  Inputs:
+     *      1 : Context handle
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     */
+    void BeginRequest(Kernel::HLERequestContext& ctx);
+
+    /**
+     * HTTP_C::BeginRequestAsync service function
+     *  Inputs:
+     *      1 : Context handle
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     */
+    void BeginRequestAsync(Kernel::HLERequestContext& ctx);
+
+    /**
+     * HTTP_C::ReceiveData service function. Waits until the buffer is full or the whole response
+     * body was received.
+     *  Inputs:
+     *      1 : Context handle
+     *      2 : Buffer size
+     *      3 : (BufferSize<<4) | 12
+     *      4 : Buffer data pointer
+     *  Outputs:
+     *      1 : Result of function, 0 if the whole body was received, 0xD840A02B if data remains
+     */
+    void ReceiveData(Kernel::HLERequestContext& ctx);
+
+    /**
+     * HTTP_C::ReceiveDataTimeout service function
+     *  Inputs:
+     *      1 : Context handle
+     *      2 : Buffer size
+     *    3-4 : Timeout in nanoseconds
+     *      5 : (BufferSize<<4) | 12
+     *      6 : Buffer data pointer
+     *  Outputs:
+     *      1 : Result of function, as for ReceiveData, or 0xD820A069 on timeout
+     */
+    void ReceiveDataTimeout(Kernel::HLERequestContext& ctx);
+
     /**
      * HTTP_C::AddRequestHeader service function
      *  Inputs:
@@ -223,6 +313,58 @@ private:
      */
     void AddPostDataAscii(Kernel::HLERequestContext& ctx);
 
+    /**
+     * HTTP_C::GetResponseHeader service function. Waits for the response headers.
+     *  Inputs:
+     *      1 : Context handle
+     *      2 : Header name buffer size, including null-terminator.
+     *      3 : Header value buffer size
+     *      4 : (HeaderNameSize<<14) | 0xC02
+     *      5 : Header name data pointer
+     *      6 : (HeaderValueSize<<4) | 12
+     *      7 : Header value data pointer
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     *      2 : Size of the header value written, including null-terminator
+     */
+    void GetResponseHeader(Kernel::HLERequestContext& ctx);
+
+    /**
+     * HTTP_C::GetResponseData service function. Waits for the response headers and writes all of
+     * them, one "Name: value\r\n" line each, rebuilt from the parsed response.
+     *  Inputs:
+     *      1 : Context handle
+     *      2 : Buffer size
+     *      3 : (BufferSize<<4) | 12
+     *      4 : Buffer data pointer
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     */
+    void GetResponseData(Kernel::HLERequestContext& ctx);
+
+    /**
+     * HTTP_C::GetResponseDataTimeout service function
+     *  Inputs:
+     *      1 : Context handle
+     *      2 : Buffer size
+     *    3-4 : Timeout in nanoseconds
+     *      5 : (BufferSize<<4) | 12
+     *      6 : Buffer data pointer
+     *  Outputs:
+     *      1 : Result of function, as for GetResponseData, or 0xD820A069 on timeout
+     */
+    void GetResponseDataTimeout(Kernel::HLERequestContext& ctx);
+
+    /**
+     * HTTP_C::GetResponseStatusCode service function. Waits for the response headers.
+     *  Inputs:
+     *      1 : Context handle
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     *      2 : HTTP status code of the response
+     */
+    void GetResponseStatusCode(Kernel::HLERequestContext& ctx);
+
     /**
      * HTTP_C::OpenClientCertContext service function
      *  Inputs:
@@ -265,6 +407,37 @@ private:
 
     void DecryptClCertA();
 
+    void ReceiveDataImpl(Kernel::HLERequestContext& ctx, bool timeout);
+
+    void GetResponseDataImpl(Kernel::HLERequestContext& ctx, bool timeout);
+
+    /// Sends the request of a context to the request engine
+    ResultCode StartTransfer(Context& context);
+
+    /// Checks that the session is initialized and bound to the given context
+    ResultCode ValidateBoundContext(Kernel::HLERequestContext& ctx, Context::Handle context_handle);
+
+    using ReplyCallback =
+        std::function<void(Kernel::HLERequestContext& ctx, Kernel::ThreadWakeupReason reason)>;
+
+    /**
+     * Replies once the transfer of a context made enough progress. The guest thread is put to sleep
+     * if it has to wait.
+     * @param is_ready Returns whether the reply can be written, called on every update
+     * @param timeout How long to wait at most, or 0 to wait forever
+     */
+    void WaitForTransfer(Kernel::HLERequestContext& ctx, Context::Handle context_handle,
+                         const std::string& reason, std::chrono::nanoseconds timeout,
+                         std::function<bool()> is_ready, ReplyCallback reply);
+
+    /// Wakes the threads waiting for the transfer of a context whose wait is over
+    void TransferUpdated(Context::Handle context_handle);
+
+    /// Wakes all threads waiting for the transfer of a context, whatever its progress
+    void WakeTransferWaiters(Context::Handle context_handle);
+
+    Core::System& system;
+
     Kernel::SharedPtr<Kernel::SharedMemory> shared_memory = nullptr;
 
     /// The next number to use when a new HTTP session is initalized.
@@ -287,6 +460,21 @@ private:
         std::vector<u8> private_key;
         bool init = false;
     } ClCertA;
+
+    struct TransferWaiter {
+        Context::Handle context_handle;
+        Kernel::SharedPtr<Kernel::Event> event;
+        std::function<bool()> is_ready;
+    };
+
+    /// Guest threads waiting for transfers, indexed by an increasing ID
+    std::unordered_map<u64, TransferWaiter> transfer_waiters;
+    u64 next_waiter_id = 0;
+
+    /// Scheduled by the request engine with the handle of the context that made progress
+    Core::TimingEventType* transfer_updated_event;
+
+    RequestEngine request_engine;
 };
 
 void InstallInterfaces(Core::System& system);
@@ -0,0 +1,302 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <optional>
+#include <httplib.h>
+#include "common/logging/log.h"
+#include "common/string_util.h"
+#include "common/thread.h"
+#include "core/hle/service/http_engine.h"
+
+namespace Service::HTTP {
+
+namespace {
+
+struct ParsedUrl {
+    std::string host;
+    int port;
+    std::string path;
+};
+
+/// Splits an http:// URL, returning nothing for other schemes and malformed URLs
+std::optional<ParsedUrl> ParseUrl(const std::string& url) {
+    const std::string scheme_separator = "://";
+    const std::size_t scheme_end = url.find(scheme_separator);
+    if (scheme_end == std::string::npos ||
+        Common::ToLower(url.substr(0, scheme_end)) != "http") {
+        return {};
+    }
+
+    const std::size_t authority_begin = scheme_end + scheme_separator.size();
+    const std::size_t path_begin = url.find('/', authority_begin);
+    const std::string authority = url.substr(authority_begin, path_begin - authority_begin);
+
+    ParsedUrl parsed;
+    parsed.path = path_begin == std::string::npos ? "/" : url.substr(path_begin);
+    const std::size_t port_begin = authority.find(':');
+    parsed.host = authority.substr(0, port_begin);
+    parsed.port = 80;
+    if (port_begin != std::string::npos) {
+        const std::string port = authority.substr(port_begin + 1);
+        if (port.empty() || port.size() > 5 ||
+            !std::all_of(port.begin(), port.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            return {};
+        }
+        parsed.port = std::stoi(port);
+    }
+    if (parsed.host.empty()) {
+        return {};
+    }
+    return parsed;
+}
+
+void Notify(Transfer& transfer, const std::function<void()>& on_update) {
+    if (!transfer.update_pending.exchange(true)) {
+        on_update();
+    }
+}
+
+} // Anonymous namespace
+
+/**
+ * Sets the timeout of the client on its sockets, so that a server that stops responding fails the
+ * request, and shuts down the socket of the request in progress when stopped. httplib itself only
+ * bounds connecting, and has no way to abort a request.
+ */
+class RequestEngine::StoppableClient final : public httplib::Client {
+public:
+    StoppableClient(const std::string& host, int port, std::size_t timeout_seconds)
+        : httplib::Client(host.c_str(), port, timeout_seconds) {}
+
+    /// Aborts the request in progress and fails all later requests
+    void Stop() {
+        std::lock_guard lock(socket_mutex);
+        stopped = true;
+        if (socket != INVALID_SOCKET) {
+            httplib::detail::shutdown_socket(socket);
+        }
+    }
+
+private:
+    bool read_and_close_socket(socket_t sock, httplib::Request& req,
+                               httplib::Response& res) override {
+        {
+            std::lock_guard lock(socket_mutex);
+            if (stopped) {
+                httplib::detail::close_socket(sock);
+                return false;
+            }
+            socket = sock;
+        }
+        SetTimeouts(sock);
+
+        httplib::SocketStream stream(sock);
+        bool connection_close = false;
+        const bool success = process_request(stream, req, res, connection_close);
+
+        // Forget the socket before closing it, so that Stop can't shut down a reused descriptor
+        {
+            std::lock_guard lock(socket_mutex);
+            socket = INVALID_SOCKET;
+        }
+        httplib::detail::close_socket(sock);
+        return success;
+    }
+
+    void SetTimeouts(socket_t sock) const {
+#ifdef _WIN32
+        const auto timeout = static_cast<DWORD>(timeout_sec_ * 1000);
+#else
+        timeval timeout{};
+        timeout.tv_sec = static_cast<long>(timeout_sec_);
+#endif
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout),
+                   sizeof(timeout));
+        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout),
+                   sizeof(timeout));
+    }
+
+    std::mutex socket_mutex;
+    socket_t socket = INVALID_SOCKET;
+    bool stopped = false;
+};
+
+RequestEngine::RequestEngine(std::size_t worker_count, std::size_t max_connections_per_host,
+                             std::size_t timeout_seconds)
+    : worker_count(worker_count), max_connections_per_host(max_connections_per_host),
+      timeout_seconds(timeout_seconds) {}
+
+RequestEngine::~RequestEngine() {
+    {
+        std::lock_guard lock(mutex);
+        stop_requested = true;
+        // Abort the running requests instead of waiting for them
+        for (const auto& [transfer, client] : running) {
+            client->Stop();
+        }
+    }
+    job_available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::shared_ptr<Transfer> RequestEngine::Start(RequestDescription request,
+                                               std::function<void()> on_update) {
+    auto transfer = std::make_shared<Transfer>();
+
+    const std::optional<ParsedUrl> url = ParseUrl(request.url);
+    if (!url) {
+        LOG_ERROR(Service_HTTP, "Unsupported URL {}", request.url);
+        {
+            std::lock_guard lock(transfer->mutex);
+            transfer->stage = Transfer::Stage::Failed;
+        }
+        Notify(*transfer, on_update);
+        return transfer;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        queue.push_back(
+            {url->host, url->port, url->path, std::move(request), transfer, std::move(on_update)});
+        if (workers.empty()) {
+            for (std::size_t i = 0; i < worker_count; ++i) {
+                workers.emplace_back(&RequestEngine::WorkerLoop, this);
+            }
+        }
+    }
+    job_available.notify_one();
+    return transfer;
+}
+
+void RequestEngine::Cancel(Transfer& transfer) {
+    std::lock_guard lock(mutex);
+    transfer.cancelled = true;
+    const auto it = running.find(&transfer);
+    if (it != running.end()) {
+        it->second->Stop();
+    }
+}
+
+void RequestEngine::WorkerLoop() {
+    Common::SetCurrentThreadName("HTTPWorker");
+
+    std::unique_lock lock(mutex);
+    while (true) {
+        // Take the oldest job whose host has a free connection
+        auto job_it = queue.end();
+        job_available.wait(lock, [this, &job_it] {
+            job_it = std::find_if(queue.begin(), queue.end(), [this](const Job& job) {
+                const auto host_it = hosts.find(job.host + ':' + std::to_string(job.port));
+                return job.transfer->cancelled ||
+                       host_it == hosts.end() ||
+                       host_it->second.active_connections < max_connections_per_host;
+            });
+            return stop_requested || job_it != queue.end();
+        });
+        if (stop_requested) {
+            return;
+        }
+
+        Job job = std::move(*job_it);
+        queue.erase(job_it);
+        if (job.transfer->cancelled) {
+            continue;
+        }
+
+        Host& host = hosts[job.host + ':' + std::to_string(job.port)];
+        ++host.active_connections;
+        std::unique_ptr<StoppableClient> client;
+        if (host.idle_clients.empty()) {
+            client = std::make_unique<StoppableClient>(job.host, job.port, timeout_seconds);
+        } else {
+            client = std::move(host.idle_clients.back());
+            host.idle_clients.pop_back();
+        }
+
+        running.emplace(job.transfer.get(), client.get());
+
+        lock.unlock();
+        Run(job, *client);
+        lock.lock();
+
+        running.erase(job.transfer.get());
+        // Stopped clients fail all requests, so they are dropped
+        if (!job.transfer->cancelled && !stop_requested) {
+            host.idle_clients.push_back(std::move(client));
+        }
+        --host.active_connections;
+        // Jobs for this host may be runnable now
+        job_available.notify_all();
+    }
+}
+
+void RequestEngine::Run(Job& job, StoppableClient& client) {
+    Transfer& transfer = *job.transfer;
+    {
+        std::lock_guard lock(transfer.mutex);
+        transfer.stage = Transfer::Stage::Connecting;
+    }
+    Notify(transfer, job.on_update);
+
+    httplib::Request request;
+    httplib::Response response;
+    request.method = job.request.method;
+    request.path = job.path;
+    for (const auto& [name, value] : job.request.headers) {
+        request.headers.emplace(name, value);
+    }
+    request.body = std::move(job.request.body);
+
+    const auto publish_headers = [&transfer, &response] {
+        transfer.status_code = response.status;
+        transfer.headers.assign(response.headers.begin(), response.headers.end());
+        transfer.stage = Transfer::Stage::ReceivingBody;
+    };
+
+    // Called after every read of a body with a known length, with the headers already parsed and
+    // the received part of the body at the start of response.body
+    request.progress = [&](u64 current, u64 total) {
+        if (transfer.cancelled) {
+            return;
+        }
+        {
+            std::lock_guard lock(transfer.mutex);
+            if (!transfer.HasHeaders()) {
+                publish_headers();
+                transfer.content_length = total;
+            }
+            transfer.body.append(response.body, transfer.body.size(),
+                                 static_cast<std::size_t>(current) - transfer.body.size());
+        }
+        Notify(transfer, job.on_update);
+    };
+
+    const bool success = client.send(request, response);
+    if (!success && !transfer.cancelled) {
+        LOG_ERROR(Service_HTTP, "Request to {} failed", job.request.url);
+    }
+
+    {
+        std::lock_guard lock(transfer.mutex);
+        if (success) {
+            if (!transfer.HasHeaders()) {
+                publish_headers();
+            }
+            // Bodies without a known length only arrive here
+            if (transfer.body.size() < response.body.size()) {
+                transfer.body.append(response.body, transfer.body.size(), std::string::npos);
+            }
+            transfer.content_length = transfer.body.size();
+            transfer.stage = Transfer::Stage::Finished;
+        } else {
+            transfer.stage = Transfer::Stage::Failed;
+        }
+    }
+    Notify(transfer, job.on_update);
+}
+
+} // namespace Service::HTTP
@@ -0,0 +1,138 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Service::HTTP {
+
+using HeaderList = std::vector<std::pair<std::string, std::string>>;
+
+/// Everything needed to send a request
+struct RequestDescription {
+    std::string method;
+    std::string url;
+    HeaderList headers;
+    std::string body;
+};
+
+/// Progress of a request, filled in by the workers of the RequestEngine
+struct Transfer {
+    enum class Stage {
+        Queued,        ///< Waiting for a worker and a free connection to the host
+        Connecting,    ///< Sending the request and waiting for the response headers
+        ReceivingBody, ///< The response headers are known and the body is arriving
+        Finished,      ///< The whole response was received
+        Failed,        ///< The request could not be sent or the response was malformed
+    };
+
+    /// Guards all members below. Only the workers write to them.
+    std::mutex mutex;
+
+    Stage stage = Stage::Queued;
+    int status_code = 0;
+    HeaderList headers;
+    /// Value of Content-Length, or 0 if the length is unknown until the body was received
+    u64 content_length = 0;
+    /// The part of the body received so far
+    std::string body;
+
+    /// Set by RequestEngine::Cancel. Data that is still arriving is dropped.
+    std::atomic<bool> cancelled{false};
+
+    /// Set by the engine while a call to on_update is pending, cleared by its handler
+    std::atomic<bool> update_pending{false};
+
+    bool HasHeaders() const {
+        return stage >= Stage::ReceivingBody;
+    }
+
+    bool IsDone() const {
+        return stage == Stage::Finished || stage == Stage::Failed;
+    }
+};
+
+/**
+ * Runs HTTP requests on worker threads, so that the emulation thread never waits for the network.
+ * Response bodies with a known length are made available chunk by chunk as they arrive. The
+ * number of connections to a single host is limited, and the clients of a host are reused.
+ */
+class RequestEngine {
+public:
+    /**
+     * @param worker_count Number of requests run in parallel
+     * @param max_connections_per_host Number of requests run in parallel against the same host
+     * @param timeout_seconds Seconds connecting, sending or receiving may take before the request
+     *                        fails
+     */
+    explicit RequestEngine(std::size_t worker_count = 4, std::size_t max_connections_per_host = 2,
+                           std::size_t timeout_seconds = 30);
+    ~RequestEngine();
+
+    RequestEngine(const RequestEngine&) = delete;
+    RequestEngine& operator=(const RequestEngine&) = delete;
+
+    /**
+     * Queues a request. Only plain HTTP URLs are supported, other requests fail right away.
+     * @param on_update Called whenever the transfer made progress, on a worker thread, or on the
+     *                  calling thread if the request fails right away. Calls are coalesced until
+     *                  the handler clears update_pending.
+     */
+    std::shared_ptr<Transfer> Start(RequestDescription request, std::function<void()> on_update);
+
+    /// Abandons a transfer. A request in progress is aborted and fails right away.
+    void Cancel(Transfer& transfer);
+
+private:
+    /// httplib client whose request in progress can be aborted
+    class StoppableClient;
+
+    struct Job {
+        std::string host;
+        int port;
+        std::string path;
+        RequestDescription request;
+        std::shared_ptr<Transfer> transfer;
+        std::function<void()> on_update;
+    };
+
+    struct Host {
+        /// Clients not used by a worker right now
+        std::vector<std::unique_ptr<StoppableClient>> idle_clients;
+        std::size_t active_connections = 0;
+    };
+
+    void WorkerLoop();
+    void Run(Job& job, StoppableClient& client);
+
+    const std::size_t worker_count;
+    const std::size_t max_connections_per_host;
+    const std::size_t timeout_seconds;
+
+    std::mutex mutex;
+    std::condition_variable job_available;
+    std::deque<Job> queue;
+    /// Indexed by "host:port"
+    std::map<std::string, Host> hosts;
+    /// Clients of the requests being run, stopped to abort them
+    std::map<const Transfer*, StoppableClient*> running;
+    bool stop_requested = false;
+    /// Started with the first request
+    std::vector<std::thread> workers;
+};
+
+} // namespace Service::HTTP
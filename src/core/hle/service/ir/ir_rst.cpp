@@ -6,6 +6,7 @@
 #include "core/core_timing.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/event.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/service/hid/hid.h"
 #include "core/hle/service/ir/ir_rst.h"
@@ -145,6 +146,20 @@ void IR_RST::Shutdown(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_IR, "called");
 }
 
+void IR_RST::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    writer.WriteObject(update_event);
+    writer.WriteObject(shared_memory);
+    writer.Write(next_pad_index);
+    writer.Write(raw_c_stick);
+    writer.Write(update_period);
+}
+
+bool IR_RST::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadObject(update_event) && update_event != nullptr &&
+           reader.ReadObject(shared_memory) && shared_memory != nullptr &&
+           reader.Read(next_pad_index) && reader.Read(raw_c_stick) && reader.Read(update_period);
+}
+
 IR_RST::IR_RST(Core::System& system) : ServiceFramework("ir:rst", 1), system(system) {
     using namespace Kernel;
     // Note: these two kernel objects are even available before Initialize service function is
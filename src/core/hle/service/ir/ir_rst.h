@@ -44,6 +44,9 @@ public:
     void ReloadInputDevices();
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
     /**
      * GetHandles service function
      *  No input
@@ -9,6 +9,7 @@
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/event.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/service/ir/extra_hid.h"
 #include "core/hle/service/ir/ir_user.h"
@@ -381,6 +382,20 @@ void IR_USER::ReleaseReceivedData(Kernel::HLERequestContext& ctx) {
     LOG_TRACE(Service_IR, "called, count={}", count);
 }
 
+void IR_USER::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    if (shared_memory != nullptr) {
+        writer.Refuse("ir:USER is initialized");
+    }
+    writer.WriteObject(conn_status_event);
+    writer.WriteObject(send_event);
+    writer.WriteObject(receive_event);
+}
+
+bool IR_USER::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadObject(conn_status_event) && reader.ReadObject(send_event) &&
+           reader.ReadObject(receive_event);
+}
+
 IR_USER::IR_USER(Core::System& system) : ServiceFramework("ir:USER", 1) {
     const FunctionInfo functions[] = {
         {0x00010182, nullptr, "InitializeIrNop"},
@@ -57,6 +57,9 @@ public:
     void ReloadInputDevices();
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
     /**
      * InitializeIrNopShared service function
      * Initializes ir:USER service with a user provided shared memory. The shared memory is
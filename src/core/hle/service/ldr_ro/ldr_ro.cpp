@@ -8,6 +8,7 @@
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/service/ldr_ro/cro_helper.h"
 #include "core/hle/service/ldr_ro/ldr_ro.h"
@@ -502,6 +503,14 @@ void RO::Shutdown(Kernel::HLERequestContext& ctx) {
     rb.Push(result);
 }
 
+void ClientSlot::SaveState(Kernel::ObjectStateWriter& writer) const {
+    writer.Write(loaded_crs);
+}
+
+bool ClientSlot::LoadState(Kernel::ObjectStateReader& reader) {
+    return reader.Read(loaded_crs);
+}
+
 RO::RO(Core::System& system) : ServiceFramework("ldr:ro", 2), system(system) {
     static const FunctionInfo functions[] = {
         {0x000100C2, &RO::Initialize, "Initialize"},
@@ -14,6 +14,9 @@ namespace Service::LDR {
 
 struct ClientSlot : public Kernel::SessionRequestHandler::SessionDataBase {
     VAddr loaded_crs = 0; ///< the virtual address of the static module
+
+    void SaveState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadState(Kernel::ObjectStateReader& reader) override;
 };
 
 class RO final : public ServiceFramework<RO, ClientSlot> {
@@ -9,6 +9,7 @@
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/service/mic_u.h"
 
@@ -192,6 +193,31 @@ struct MIC_U::Impl {
         rb.Push(RESULT_SUCCESS);
     }
 
+    void SaveState(Kernel::ObjectStateWriter& writer) const {
+        writer.Write(client_version);
+        writer.WriteObject(buffer_full_event);
+        writer.WriteObject(shared_memory);
+        writer.Write(mic_gain);
+        writer.Write(mic_power);
+        writer.Write(is_sampling);
+        writer.Write(allow_shell_closed);
+        writer.Write(clamp);
+        writer.Write(encoding);
+        writer.Write(sample_rate);
+        writer.Write(audio_buffer_offset);
+        writer.Write(audio_buffer_size);
+        writer.Write(audio_buffer_loop);
+    }
+
+    bool LoadState(Kernel::ObjectStateReader& reader) {
+        return reader.Read(client_version) && reader.ReadObject(buffer_full_event) &&
+               reader.ReadObject(shared_memory) && reader.Read(mic_gain) &&
+               reader.Read(mic_power) && reader.Read(is_sampling) &&
+               reader.Read(allow_shell_closed) && reader.Read(clamp) && reader.Read(encoding) &&
+               reader.Read(sample_rate) && reader.Read(audio_buffer_offset) &&
+               reader.Read(audio_buffer_size) && reader.Read(audio_buffer_loop);
+    }
+
     u32 client_version = 0;
     Kernel::SharedPtr<Kernel::Event> buffer_full_event;
     Kernel::SharedPtr<Kernel::SharedMemory> shared_memory;
@@ -271,6 +297,14 @@ void MIC_U::SetClientVersion(Kernel::HLERequestContext& ctx) {
     impl->SetClientVersion(ctx);
 }
 
+void MIC_U::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    impl->SaveState(writer);
+}
+
+bool MIC_U::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return impl->LoadState(reader);
+}
+
 MIC_U::MIC_U(Core::System& system)
     : ServiceFramework{"mic:u", 1}, impl{std::make_unique<Impl>(system)} {
     static const FunctionInfo functions[] = {
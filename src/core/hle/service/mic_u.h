@@ -20,6 +20,9 @@ public:
     ~MIC_U();
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
     /**
      * MIC::MapSharedMem service function
      *  Inputs:
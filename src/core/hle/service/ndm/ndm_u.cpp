@@ -4,6 +4,7 @@
 
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/service/ndm/ndm_u.h"
 
 namespace Service::NDM {
@@ -208,6 +209,23 @@ void NDM_U::ClearHalfAwakeMacFilter(Kernel::HLERequestContext& ctx) {
     LOG_WARNING(Service_NDM, "(STUBBED)");
 }
 
+void NDM_U::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    writer.Write(exclusive_state);
+    writer.Write(daemon_bit_mask);
+    writer.Write(default_daemon_bit_mask);
+    writer.Write(daemon_status);
+    writer.Write(scan_interval);
+    writer.Write(retry_interval);
+    writer.Write(daemon_lock_enabled);
+}
+
+bool NDM_U::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.Read(exclusive_state) && reader.Read(daemon_bit_mask) &&
+           reader.Read(default_daemon_bit_mask) && reader.Read(daemon_status) &&
+           reader.Read(scan_interval) && reader.Read(retry_interval) &&
+           reader.Read(daemon_lock_enabled);
+}
+
 NDM_U::NDM_U() : ServiceFramework("ndm:u", 6) {
     static const FunctionInfo functions[] = {
         {0x00010042, &NDM_U::EnterExclusiveState, "EnterExclusiveState"},
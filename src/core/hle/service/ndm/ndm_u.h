@@ -18,6 +18,9 @@ public:
     NDM_U();
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
     /**
      *  NDM::EnterExclusiveState service function
      *  Inputs:
@@ -5,6 +5,7 @@
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/event.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/lock.h"
 #include "core/hle/service/nfc/nfc.h"
 #include "core/hle/service/nfc/nfc_m.h"
@@ -312,6 +313,34 @@ Module::Interface::Interface(std::shared_ptr<Module> nfc, const char* name, u32
 
 Module::Interface::~Interface() = default;
 
+void Module::Interface::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    if (writer.MarkSharedState(nfc.get())) {
+        nfc->SaveState(writer);
+    }
+}
+
+bool Module::Interface::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadSharedState([&] { return nfc->LoadState(reader); });
+}
+
+void Module::SaveState(Kernel::ObjectStateWriter& writer) const {
+    writer.WriteObject(tag_in_range_event);
+    writer.WriteObject(tag_out_of_range_event);
+    writer.Write(nfc_tag_state.load());
+    writer.Write(nfc_status);
+    writer.Write(amiibo_data);
+}
+
+bool Module::LoadState(Kernel::ObjectStateReader& reader) {
+    TagState tag_state;
+    if (!reader.ReadObject(tag_in_range_event) || !reader.ReadObject(tag_out_of_range_event) ||
+        !reader.Read(tag_state) || !reader.Read(nfc_status) || !reader.Read(amiibo_data)) {
+        return false;
+    }
+    nfc_tag_state = tag_state;
+    return true;
+}
+
 Module::Module(Core::System& system) {
     tag_in_range_event =
         system.Kernel().CreateEvent(Kernel::ResetType::OneShot, "NFC::tag_in_range_event");
@@ -5,10 +5,19 @@
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/event.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/service/nim/nim_u.h"
 
 namespace Service::NIM {
 
+void NIM_U::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    writer.WriteObject(nim_system_update_event);
+}
+
+bool NIM_U::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadObject(nim_system_update_event);
+}
+
 NIM_U::NIM_U(Core::System& system) : ServiceFramework("nim:u", 2) {
     const FunctionInfo functions[] = {
         {0x00010000, nullptr, "StartSysUpdate"},
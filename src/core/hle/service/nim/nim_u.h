@@ -18,6 +18,9 @@ public:
     ~NIM_U();
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
     /**
      * NIM::CheckForSysUpdateEvent service function
      *  Inputs:
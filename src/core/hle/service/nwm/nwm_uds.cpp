@@ -19,6 +19,7 @@
 #include "core/core_timing.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/event.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/kernel/shared_page.h"
 #include "core/hle/lock.h"
@@ -1358,6 +1359,13 @@ void NWM_UDS::BeaconBroadcastCallback(u64 userdata, s64 cycles_late) {
                                       beacon_broadcast_event, 0);
 }
 
+void NWM_UDS::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    // The connection state lives in the room the console is connected to
+    if (initialized) {
+        writer.Refuse("nwm::UDS is initialized");
+    }
+}
+
 NWM_UDS::NWM_UDS(Core::System& system) : ServiceFramework("nwm::UDS"), system(system) {
     static const FunctionInfo functions[] = {
         {0x000102C2, nullptr, "Initialize (deprecated)"},
@@ -112,6 +112,8 @@ public:
     ~NWM_UDS();
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+
     Core::System& system;
 
     void UpdateNetworkAttribute(Kernel::HLERequestContext& ctx);
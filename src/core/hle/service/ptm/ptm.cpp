@@ -10,6 +10,7 @@
 #include "core/file_sys/archive_extsavedata.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/file_backend.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/service/ptm/ptm.h"
 #include "core/hle/service/ptm/ptm_gets.h"
 #include "core/hle/service/ptm/ptm_play.h"
@@ -227,6 +228,27 @@ void Module::SetPlayCoins(u16 play_coins) {
 Module::Interface::Interface(std::shared_ptr<Module> ptm, const char* name, u32 max_session)
     : ServiceFramework(name, max_session), ptm(std::move(ptm)) {}
 
+void Module::Interface::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    if (writer.MarkSharedState(ptm.get())) {
+        ptm->SaveState(writer);
+    }
+}
+
+bool Module::Interface::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadSharedState([&] { return ptm->LoadState(reader); });
+}
+
+void Module::SaveState(Kernel::ObjectStateWriter& writer) const {
+    writer.Write(shell_open);
+    writer.Write(battery_is_charging);
+    writer.Write(pedometer_is_counting);
+}
+
+bool Module::LoadState(Kernel::ObjectStateReader& reader) {
+    return reader.Read(shell_open) && reader.Read(battery_is_charging) &&
+           reader.Read(pedometer_is_counting);
+}
+
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
     auto ptm = std::make_shared<Module>();
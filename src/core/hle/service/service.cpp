@@ -126,7 +126,11 @@ const std::array<ServiceModuleInfo, 40> service_module_map{
 
 ServiceFrameworkBase::ServiceFrameworkBase(const char* service_name, u32 max_sessions,
                                            InvokerFn* handler_invoker)
-    : service_name(service_name), max_sessions(max_sessions), handler_invoker(handler_invoker) {}
+    : service_name(service_name), max_sessions(max_sessions),
+      request_counter(Common::Counters::Register("citra_ipc_requests_total",
+                                                 "IPC requests handled by HLE services",
+                                                 {{"service", service_name}})),
+      handler_invoker(handler_invoker) {}
 
 ServiceFrameworkBase::~ServiceFrameworkBase() = default;
 
@@ -171,6 +175,8 @@ void ServiceFrameworkBase::ReportUnimplementedFunction(u32* cmd_buf, const Funct
 
 void ServiceFrameworkBase::HandleSyncRequest(
     Kernel::SharedPtr<Kernel::ServerSession> server_session) {
+    request_counter.Add();
+
     Kernel::KernelSystem& kernel = Core::System::GetInstance().Kernel();
     auto thread = kernel.GetThreadManager().GetCurrentThread();
     // TODO(wwylele): avoid GetPointer
@@ -204,6 +210,10 @@ void ServiceFrameworkBase::HandleSyncRequest(
     }
 }
 
+std::string ServiceFrameworkBase::GetStateKey() const {
+    return service_name;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Module interface
 
@@ -10,6 +10,7 @@
 #include <string>
 #include <boost/container/flat_map.hpp>
 #include "common/common_types.h"
+#include "common/counters.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/service/sm/sm.h"
@@ -63,6 +64,9 @@ public:
 
     void HandleSyncRequest(Kernel::SharedPtr<Kernel::ServerSession> server_session) override;
 
+    /// Services are saved with their name
+    std::string GetStateKey() const override;
+
 protected:
     /// Member-function pointer type of SyncRequest handlers.
     template <typename Self>
@@ -91,6 +95,8 @@ private:
     std::string service_name;
     /// Maximum number of concurrent sessions that this service can handle.
     u32 max_sessions;
+    /// Counts the requests made to this service.
+    Common::Counters::Counter request_counter;
 
     /**
      * Port where incoming connections will be received. Only created when InstallAsService() or
@@ -6,6 +6,7 @@
 #include "common/assert.h"
 #include "core/core.h"
 #include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/result.h"
 #include "core/hle/service/sm/sm.h"
 #include "core/hle/service/sm/srv.h"
@@ -65,4 +66,29 @@ ResultVal<Kernel::SharedPtr<Kernel::ClientSession>> ServiceManager::ConnectToSer
     return client_port->Connect();
 }
 
+void ServiceManager::SaveState(Kernel::ObjectStateWriter& writer) const {
+    writer.Write(static_cast<u32>(registered_services.size()));
+    for (const auto& [name, port] : registered_services) {
+        writer.WriteString(name);
+        writer.WriteObject(port);
+    }
+}
+
+bool ServiceManager::LoadState(Kernel::ObjectStateReader& reader) {
+    u32 service_count;
+    if (!reader.Read(service_count)) {
+        return false;
+    }
+    registered_services.clear();
+    for (u32 i = 0; i < service_count; ++i) {
+        std::string name;
+        Kernel::SharedPtr<Kernel::ClientPort> port;
+        if (!reader.ReadString(name) || !reader.ReadObject(port) || port == nullptr) {
+            return false;
+        }
+        registered_services.emplace(std::move(name), std::move(port));
+    }
+    return true;
+}
+
 } // namespace Service::SM
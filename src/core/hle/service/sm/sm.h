@@ -20,6 +20,8 @@ class System;
 
 namespace Kernel {
 class ClientSession;
+class ObjectStateReader;
+class ObjectStateWriter;
 class SessionRequestHandler;
 } // namespace Kernel
 
@@ -52,6 +54,12 @@ public:
     ResultVal<Kernel::SharedPtr<Kernel::ClientPort>> GetServicePort(const std::string& name);
     ResultVal<Kernel::SharedPtr<Kernel::ClientSession>> ConnectToService(const std::string& name);
 
+    /// Saves the ports of the registered services, through which their handlers are saved
+    void SaveState(Kernel::ObjectStateWriter& writer) const;
+
+    /// Loads the state saved by SaveState, once the reader loaded the objects and handlers
+    bool LoadState(Kernel::ObjectStateReader& reader);
+
     template <typename T>
     std::shared_ptr<T> GetService(const std::string& service_name) const {
         static_assert(std::is_base_of_v<Kernel::SessionRequestHandler, T>,
@@ -13,6 +13,7 @@
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/semaphore.h"
 #include "core/hle/kernel/server_port.h"
 #include "core/hle/kernel/server_session.h"
@@ -244,6 +245,32 @@ void SRV::RegisterService(Kernel::HLERequestContext& ctx) {
     rb.PushMoveObjects(port.Unwrap());
 }
 
+void SRV::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    writer.WriteObject(notification_semaphore);
+    writer.Write(static_cast<u32>(get_service_handle_delayed_map.size()));
+    for (const auto& [name, event] : get_service_handle_delayed_map) {
+        writer.WriteString(name);
+        writer.WriteObject(event);
+    }
+}
+
+bool SRV::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    u32 delayed_count;
+    if (!reader.ReadObject(notification_semaphore) || !reader.Read(delayed_count)) {
+        return false;
+    }
+    get_service_handle_delayed_map.clear();
+    for (u32 i = 0; i < delayed_count; ++i) {
+        std::string name;
+        Kernel::SharedPtr<Kernel::Event> event;
+        if (!reader.ReadString(name) || !reader.ReadObject(event) || event == nullptr) {
+            return false;
+        }
+        get_service_handle_delayed_map.emplace(std::move(name), std::move(event));
+    }
+    return true;
+}
+
 SRV::SRV(Core::System& system) : ServiceFramework("srv:", 4), system(system) {
     static const FunctionInfo functions[] = {
         {0x00010002, &SRV::RegisterClient, "RegisterClient"},
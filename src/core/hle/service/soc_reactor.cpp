@@ -0,0 +1,357 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/hle/service/soc_reactor.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#define ERRNO(x) WSA##x
+#define GET_ERRNO WSAGetLastError()
+#define poll(x, y, z) WSAPoll(x, y, z)
+#else
+#define ERRNO(x) x
+#define GET_ERRNO errno
+#define closesocket(x) close(x)
+#endif
+
+namespace Service::SOC {
+
+namespace {
+
+constexpr u32 INVALID_SOCKET_VALUE = static_cast<u32>(-1);
+
+/// How long the reactor waits at most when it has no wake socket to be woken up with
+constexpr int FALLBACK_WAKE_INTERVAL_MS = 10;
+
+bool IsWouldBlock(int error) {
+    return error == ERRNO(EWOULDBLOCK) || error == ERRNO(EAGAIN);
+}
+
+bool SetBlocking(u32 socket, bool blocking) {
+#ifdef _WIN32
+    unsigned long non_blocking = blocking ? 0 : 1;
+    return ioctlsocket(socket, FIONBIO, &non_blocking) == 0;
+#else
+    const int flags = ::fcntl(socket, F_GETFL, 0);
+    return flags != -1 &&
+           ::fcntl(socket, F_SETFL, blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK) == 0;
+#endif
+}
+
+/// Switches a blocking socket to non-blocking mode for the lifetime of the object
+class NonBlockingScope {
+public:
+    NonBlockingScope(u32 socket, bool blocking)
+        : socket(socket), restore(blocking && SetBlocking(socket, false)) {}
+
+    ~NonBlockingScope() {
+        if (restore) {
+            SetBlocking(socket, true);
+        }
+    }
+
+private:
+    u32 socket;
+    bool restore;
+};
+
+std::vector<pollfd> ToPollFds(const SocketOperation& operation) {
+    std::vector<pollfd> fds(operation.sockets.size());
+    std::transform(operation.sockets.begin(), operation.sockets.end(), fds.begin(),
+                   [](const SocketOperation::WaitedSocket& socket) {
+                       pollfd fd{};
+                       fd.fd = socket.socket;
+                       fd.events = socket.events;
+                       return fd;
+                   });
+    return fds;
+}
+
+u32 CreateWakeSocket() {
+    const auto wake_socket = static_cast<u32>(::socket(AF_INET, SOCK_DGRAM, 0));
+    if (wake_socket == INVALID_SOCKET_VALUE) {
+        return INVALID_SOCKET_VALUE;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    bool success = ::bind(wake_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 &&
+                   ::getsockname(wake_socket, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0 &&
+                   ::connect(wake_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    success = success && SetBlocking(wake_socket, false);
+    if (!success) {
+        closesocket(wake_socket);
+        return INVALID_SOCKET_VALUE;
+    }
+    return wake_socket;
+}
+
+} // Anonymous namespace
+
+SocketReactor::SocketReactor() : wake_socket(CreateWakeSocket()) {
+    if (wake_socket == INVALID_SOCKET_VALUE) {
+        LOG_ERROR(Service_SOC, "Could not create the wake socket of the socket reactor");
+    }
+    thread = std::thread(&SocketReactor::Loop, this);
+}
+
+SocketReactor::~SocketReactor() {
+    {
+        std::lock_guard lock(mutex);
+        stop_requested = true;
+    }
+    Wake();
+    thread.join();
+    if (wake_socket != INVALID_SOCKET_VALUE) {
+        closesocket(wake_socket);
+    }
+}
+
+void SocketReactor::Perform(SocketOperation& operation) {
+    operation.error = 0;
+    switch (operation.type) {
+    case SocketOperation::Type::Poll: {
+        std::vector<pollfd> fds = ToPollFds(operation);
+        operation.result = ::poll(fds.data(), static_cast<u32>(fds.size()), 0);
+        if (operation.result == -1) {
+            operation.error = GET_ERRNO;
+        }
+        for (std::size_t i = 0; i < fds.size(); ++i) {
+            operation.sockets[i].revents = fds[i].revents;
+        }
+        break;
+    }
+    case SocketOperation::Type::Accept: {
+        const u32 socket = operation.sockets[0].socket;
+        sockaddr_storage addr;
+        socklen_t addr_len = sizeof(addr);
+        {
+            // There is no flag making a single accept non-blocking
+            const NonBlockingScope non_blocking(socket, operation.blocking);
+            operation.result = static_cast<s32>(
+                ::accept(socket, reinterpret_cast<sockaddr*>(&addr), &addr_len));
+            if (operation.result == -1) {
+                operation.error = GET_ERRNO;
+            }
+        }
+        if (operation.result != -1) {
+            // Some hosts let the new socket inherit the temporary mode of the listening socket
+            SetBlocking(static_cast<u32>(operation.result), true);
+        }
+        operation.address_length = operation.result == -1 ? 0 : addr_len;
+        std::memcpy(operation.address.data(), &addr, operation.address_length);
+        break;
+    }
+    case SocketOperation::Type::RecvFrom: {
+        const u32 socket = operation.sockets[0].socket;
+        // Keeps the capacity of a reused buffer
+        operation.data.resize(operation.length);
+        char* data = reinterpret_cast<char*>(operation.data.data());
+        sockaddr_storage addr;
+        socklen_t addr_len = sizeof(addr);
+        sockaddr* addr_ptr = operation.want_address ? reinterpret_cast<sockaddr*>(&addr) : nullptr;
+        socklen_t* addr_len_ptr = operation.want_address ? &addr_len : nullptr;
+        {
+#ifdef _WIN32
+            const NonBlockingScope non_blocking(socket, operation.blocking);
+            const int flags = operation.flags;
+#else
+            const int flags = operation.flags | MSG_DONTWAIT;
+#endif
+            operation.result = ::recvfrom(socket, data, operation.length, flags, addr_ptr,
+                                          addr_len_ptr);
+            if (operation.result == -1) {
+                operation.error = GET_ERRNO;
+            }
+        }
+        operation.address_length =
+            operation.result == -1 || !operation.want_address ? 0 : addr_len;
+        std::memcpy(operation.address.data(), &addr, operation.address_length);
+        operation.data.resize(std::max(operation.result, 0));
+        break;
+    }
+    }
+}
+
+bool SocketReactor::IsReady(SocketOperation& operation) {
+    std::vector<pollfd> fds = ToPollFds(operation);
+    // Errors are ready as well, the operation reports them
+    return ::poll(fds.data(), static_cast<u32>(fds.size()), 0) != 0;
+}
+
+bool SocketReactor::IsWouldBlock(const SocketOperation& operation) {
+    return operation.type != SocketOperation::Type::Poll && operation.result == -1 &&
+           Service::SOC::IsWouldBlock(operation.error);
+}
+
+void SocketReactor::Submit(std::shared_ptr<SocketOperation> operation) {
+    {
+        std::lock_guard lock(mutex);
+        operations.push_back(std::move(operation));
+    }
+    Wake();
+}
+
+void SocketReactor::CancelSocket(u32 socket) {
+    std::vector<std::shared_ptr<SocketOperation>> cancelled;
+    {
+        std::unique_lock lock(mutex);
+        // The operations being performed are put back or completed first, so that none of them
+        // still uses the socket once it gets closed
+        performing_finished.wait(lock, [this] { return performing.empty(); });
+        // Polls waiting on other sockets as well are completed too, as the host may reuse the
+        // descriptor for a new socket, which the reactor would then watch in place of this one
+        const auto waits_on_socket = [socket](const auto& waited) {
+            return waited.socket == socket;
+        };
+        const auto it = std::stable_partition(
+            operations.begin(), operations.end(), [&waits_on_socket](const auto& operation) {
+                return std::none_of(operation->sockets.begin(), operation->sockets.end(),
+                                    waits_on_socket);
+            });
+        cancelled.assign(std::make_move_iterator(it), std::make_move_iterator(operations.end()));
+        operations.erase(it, operations.end());
+    }
+    // Stop polling the socket before it gets closed
+    Wake();
+
+    for (const auto& operation : cancelled) {
+        if (operation->type == SocketOperation::Type::Poll) {
+            // The socket is still open, so the other sockets can be checked as usual
+            Perform(*operation);
+            if (operation->result != -1) {
+                operation->result = 0;
+                for (auto& waited : operation->sockets) {
+                    if (waited.socket == socket) {
+                        waited.revents = POLLNVAL;
+                    }
+                    operation->result += waited.revents != 0 ? 1 : 0;
+                }
+            }
+        } else {
+            operation->result = -1;
+            operation->error = ERRNO(EBADF);
+            operation->data.clear();
+        }
+        operation->on_complete(*operation);
+    }
+}
+
+void SocketReactor::Wake() {
+    if (wake_socket != INVALID_SOCKET_VALUE) {
+        const char byte = 0;
+        ::send(wake_socket, &byte, 1, 0);
+    }
+}
+
+void SocketReactor::Loop() {
+    Common::SetCurrentThreadName("SocketReactor");
+
+    std::vector<std::shared_ptr<SocketOperation>> waiting;
+    std::vector<std::shared_ptr<SocketOperation>> completed;
+    std::vector<pollfd> fds;
+
+    std::unique_lock lock(mutex);
+    while (!stop_requested) {
+        waiting = operations;
+
+        fds.clear();
+        fds.push_back(pollfd{});
+        fds[0].fd = wake_socket;
+        fds[0].events = wake_socket == INVALID_SOCKET_VALUE ? 0 : POLLIN;
+
+        int timeout = wake_socket == INVALID_SOCKET_VALUE ? FALLBACK_WAKE_INTERVAL_MS : -1;
+        const auto now = std::chrono::steady_clock::now();
+        for (const auto& operation : waiting) {
+            const std::vector<pollfd> operation_fds = ToPollFds(*operation);
+            fds.insert(fds.end(), operation_fds.begin(), operation_fds.end());
+            if (operation->deadline) {
+                // Round up, so that the deadline has passed once the poll times out
+                const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+                    std::max(*operation->deadline - now, std::chrono::steady_clock::duration{}));
+                const int remaining_ms = static_cast<int>(remaining.count());
+                timeout = timeout == -1 ? remaining_ms : std::min(timeout, remaining_ms);
+            }
+        }
+
+        lock.unlock();
+        ::poll(fds.data(), static_cast<u32>(fds.size()), timeout);
+        if (fds[0].revents != 0) {
+            char buffer[64];
+            while (::recv(wake_socket, buffer, sizeof(buffer), 0) > 0) {
+            }
+        }
+        lock.lock();
+
+        const auto poll_end = std::chrono::steady_clock::now();
+        const auto is_expired = [poll_end](const SocketOperation& operation) {
+            return operation.deadline && poll_end >= *operation.deadline;
+        };
+
+        std::size_t fd_index = 1;
+        for (const auto& operation : waiting) {
+            bool fired = false;
+            for (std::size_t i = 0; i < operation->sockets.size(); ++i) {
+                fired |= fds[fd_index++].revents != 0;
+            }
+
+            // The operation may have been cancelled while polling
+            const auto it = std::find(operations.begin(), operations.end(), operation);
+            if (it == operations.end() || (!fired && !is_expired(*operation))) {
+                continue;
+            }
+            operations.erase(it);
+            performing.push_back(operation);
+        }
+
+        // Performing never blocks, but is done without the lock so that submitting and
+        // cancelling are not held up by the host
+        lock.unlock();
+        for (const auto& operation : performing) {
+            Perform(*operation);
+        }
+        lock.lock();
+
+        for (const auto& operation : performing) {
+            const bool retry = operation->type == SocketOperation::Type::Poll
+                                   ? operation->result == 0 && !is_expired(*operation)
+                                   // Another reader got to the data first
+                                   : IsWouldBlock(*operation);
+            if (retry) {
+                operations.push_back(operation);
+            } else {
+                completed.push_back(operation);
+            }
+        }
+        performing.clear();
+        performing_finished.notify_all();
+
+        lock.unlock();
+        for (const auto& operation : completed) {
+            operation->on_complete(*operation);
+        }
+        completed.clear();
+        waiting.clear();
+        lock.lock();
+    }
+}
+
+} // namespace Service::SOC
@@ -0,0 +1,115 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Service::SOC {
+
+/// A host socket operation that may have to wait for its sockets to become ready
+struct SocketOperation {
+    enum class Type {
+        Poll,     ///< Waits for any of the sockets to report one of their events
+        Accept,   ///< Accepts a connection on the socket
+        RecvFrom, ///< Receives data from the socket
+    };
+
+    /// A socket to wait for, using the event flags of the host's poll
+    struct WaitedSocket {
+        u32 socket;
+        s16 events;
+        s16 revents = 0;
+    };
+
+    Type type;
+    /// Sockets to wait for. Accept and RecvFrom use a single one.
+    std::vector<WaitedSocket> sockets;
+    /// When a Poll gives up waiting, or nothing if it waits forever
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+
+    /// Maximum length and host flags of a RecvFrom
+    u32 length = 0;
+    u32 flags = 0;
+    /// Whether RecvFrom and Accept store the peer address
+    bool want_address = false;
+    /// Whether the host socket of Accept and RecvFrom is in blocking mode. It is switched to
+    /// non-blocking while the operation is performed.
+    bool blocking = true;
+
+    /// Return value of the host function, or -1 with the host error number in error
+    s32 result = -1;
+    int error = 0;
+    /// Data received by RecvFrom. Its capacity is kept so that the buffer can be reused.
+    std::vector<u8> data;
+    /// Host sockaddr of the peer, if requested
+    std::array<u8, 128> address{};
+    u32 address_length = 0;
+
+    /// Called once the operation completed, on the reactor thread or on the thread cancelling it
+    std::function<void(SocketOperation&)> on_complete;
+};
+
+/**
+ * Waits for the sockets of blocking operations on a host thread, so that the emulation thread does
+ * not block in the host's socket functions while the guest waits for the network.
+ */
+class SocketReactor {
+public:
+    SocketReactor();
+    ~SocketReactor();
+
+    SocketReactor(const SocketReactor&) = delete;
+    SocketReactor& operator=(const SocketReactor&) = delete;
+
+    /**
+     * Performs an operation without waiting, even on blocking sockets. Accept and RecvFrom fail
+     * with the would-block error if the socket is not ready, while Poll polls with a timeout of
+     * zero.
+     */
+    static void Perform(SocketOperation& operation);
+
+    /// Returns whether the sockets of an operation have any of the events it waits for
+    static bool IsReady(SocketOperation& operation);
+
+    /// Returns whether a performed Accept or RecvFrom failed because its socket was not ready
+    static bool IsWouldBlock(const SocketOperation& operation);
+
+    /// Waits for the sockets of the operation to become ready, then performs it
+    void Submit(std::shared_ptr<SocketOperation> operation);
+
+    /**
+     * Completes the pending operations on a socket, so that the reactor doesn't watch its
+     * descriptor once the host reuses it. Accept and RecvFrom fail with EBADF, while Poll
+     * operations report the socket as invalid. Must be called before closing the socket, it waits
+     * for the reactor to stop using the socket.
+     */
+    void CancelSocket(u32 socket);
+
+private:
+    void Wake();
+    void Loop();
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<SocketOperation>> operations;
+    /// Operations taken out of operations while the reactor performs them without the lock
+    std::vector<std::shared_ptr<SocketOperation>> performing;
+    std::condition_variable performing_finished;
+    bool stop_requested = false;
+
+    /// UDP socket connected to itself on loopback, written to wake the reactor from its poll
+    u32 wake_socket;
+    std::thread thread;
+};
+
+} // namespace Service::SOC
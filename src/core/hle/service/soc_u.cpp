@@ -11,9 +11,14 @@
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/shared_memory.h"
+#include "core/hle/kernel/thread.h"
 #include "core/hle/result.h"
+#include "core/hle/service/soc_reactor.h"
 #include "core/hle/service/soc_u.h"
 
 #ifdef _WIN32
@@ -321,11 +326,73 @@ union CTRSockAddr {
 };
 
 void SOC_U::CleanupSockets() {
-    for (auto sock : open_sockets)
+    for (auto sock : open_sockets) {
+        reactor->CancelSocket(sock.second.socket_fd);
         closesocket(sock.second.socket_fd);
+    }
     open_sockets.clear();
 }
 
+bool SOC_U::IsBlocking(u32 socket_handle) const {
+    const auto iter = open_sockets.find(socket_handle);
+    return iter != open_sockets.end() && iter->second.blocking;
+}
+
+bool SOC_U::ShouldWait(const SocketOperation& operation) const {
+    return operation.blocking && SocketReactor::IsWouldBlock(operation);
+}
+
+void SOC_U::WaitForOperation(Kernel::HLERequestContext& ctx,
+                             std::shared_ptr<SocketOperation> operation,
+                             const std::string& reason, ReplyCallback reply) {
+    const u64 operation_id = next_operation_id++;
+    auto event = ctx.SleepClientThread(
+        system.Kernel().GetThreadManager().GetCurrentThread(), reason, std::chrono::nanoseconds(0),
+        [this, operation_id, reply](Kernel::SharedPtr<Kernel::Thread> thread,
+                                    Kernel::HLERequestContext& ctx,
+                                    Kernel::ThreadWakeupReason reason) {
+            const auto iter = pending_operations.find(operation_id);
+            ASSERT(iter != pending_operations.end());
+            const std::shared_ptr<SocketOperation> operation = std::move(iter->second.operation);
+            pending_operations.erase(iter);
+
+            reply(*operation, ctx);
+            ReleaseBuffer(std::move(operation->data));
+        });
+    pending_operations.emplace(operation_id, PendingOperation{operation, std::move(event)});
+
+    operation->on_complete = [&timing = system.CoreTiming(), event_type = operation_completed_event,
+                              operation_id](SocketOperation&) {
+        timing.ScheduleEventThreadsafe(0, event_type, operation_id);
+    };
+    reactor->Submit(std::move(operation));
+}
+
+void SOC_U::OperationCompleted(u64 operation_id) {
+    const auto iter = pending_operations.find(operation_id);
+    if (iter != pending_operations.end()) {
+        // Wakes the guest thread, whose wakeup callback writes the reply
+        iter->second.event->Signal();
+    }
+}
+
+std::vector<u8> SOC_U::AcquireBuffer() {
+    if (free_buffers.empty()) {
+        return {};
+    }
+    std::vector<u8> buffer = std::move(free_buffers.back());
+    free_buffers.pop_back();
+    return buffer;
+}
+
+void SOC_U::ReleaseBuffer(std::vector<u8> buffer) {
+    // Enough for the receives of a few threads at once
+    constexpr std::size_t MaxFreeBuffers = 8;
+    if (free_buffers.size() < MaxFreeBuffers && buffer.capacity() != 0) {
+        free_buffers.push_back(std::move(buffer));
+    }
+}
+
 void SOC_U::Socket(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x02, 3, 2);
     u32 domain = rp.Pop<u32>(); // Address family
@@ -445,6 +512,9 @@ void SOC_U::Fcntl(Kernel::HLERequestContext& ctx) {
             posix_ret = TranslateError(GET_ERRNO);
             return;
         }
+        auto iter = open_sockets.find(socket_handle);
+        if (iter != open_sockets.end())
+            iter->second.blocking = (flags & O_NONBLOCK) == 0;
 #endif
     } else {
         LOG_ERROR(Service_SOC, "Unsupported command ({}) in fcntl call", ctr_cmd);
@@ -469,33 +539,46 @@ void SOC_U::Listen(Kernel::HLERequestContext& ctx) {
 }
 
 void SOC_U::Accept(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x04, 2, 2);
     u32 socket_handle = rp.Pop<u32>();
     socklen_t max_addr_len = static_cast<socklen_t>(rp.Pop<u32>());
     rp.PopPID();
-    sockaddr addr;
-    socklen_t addr_len = sizeof(addr);
-    u32 ret = static_cast<u32>(::accept(socket_handle, &addr, &addr_len));
 
-    if ((s32)ret != SOCKET_ERROR_VALUE)
-        open_sockets[ret] = {ret, true};
+    auto operation = std::make_shared<SocketOperation>();
+    operation->type = SocketOperation::Type::Accept;
+    operation->sockets = {{socket_handle, POLLIN}};
+    operation->blocking = IsBlocking(socket_handle);
+    operation->want_address = true;
+
+    const auto reply = [this](SocketOperation& operation, Kernel::HLERequestContext& ctx) {
+        u32 ret = static_cast<u32>(operation.result);
+        if ((s32)ret != SOCKET_ERROR_VALUE)
+            open_sockets[ret] = {ret, true};
+
+        CTRSockAddr ctr_addr;
+        std::vector<u8> ctr_addr_buf(sizeof(ctr_addr));
+        if ((s32)ret == SOCKET_ERROR_VALUE) {
+            ret = TranslateError(operation.error);
+        } else {
+            sockaddr addr;
+            std::memcpy(&addr, operation.address.data(), sizeof(addr));
+            ctr_addr = CTRSockAddr::FromPlatform(addr);
+            std::memcpy(ctr_addr_buf.data(), &ctr_addr, sizeof(ctr_addr));
+        }
 
-    CTRSockAddr ctr_addr;
-    std::vector<u8> ctr_addr_buf(sizeof(ctr_addr));
-    if ((s32)ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-    } else {
-        ctr_addr = CTRSockAddr::FromPlatform(addr);
-        std::memcpy(ctr_addr_buf.data(), &ctr_addr, sizeof(ctr_addr));
-    }
+        IPC::RequestBuilder rb(ctx, 0x04, 2, 2);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(ret);
+        rb.PushStaticBuffer(ctr_addr_buf, 0);
+    };
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.PushStaticBuffer(ctr_addr_buf, 0);
+    // Blocking sockets that are not ready yet are left to the reactor
+    SocketReactor::Perform(*operation);
+    if (ShouldWait(*operation)) {
+        WaitForOperation(ctx, std::move(operation), "soc::Accept", reply);
+        return;
+    }
+    reply(*operation, ctx);
 }
 
 void SOC_U::GetHostId(Kernel::HLERequestContext& ctx) {
@@ -525,6 +608,8 @@ void SOC_U::Close(Kernel::HLERequestContext& ctx) {
     s32 ret = 0;
     open_sockets.erase(socket_handle);
 
+    // Threads blocked on the socket fail, as they would on the console
+    reactor->CancelSocket(socket_handle);
     ret = closesocket(socket_handle);
 
     if (ret != 0)
@@ -572,45 +657,59 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
     u32 flags = rp.Pop<u32>();
     u32 addr_len = rp.Pop<u32>();
     rp.PopPID();
-    auto& buffer = rp.PopMappedBuffer();
 
-    CTRSockAddr ctr_src_addr;
-    std::vector<u8> output_buff(len);
-    std::vector<u8> addr_buff(sizeof(ctr_src_addr));
-    sockaddr src_addr;
-    socklen_t src_addr_len = sizeof(src_addr);
+    auto operation = std::make_shared<SocketOperation>();
+    operation->type = SocketOperation::Type::RecvFrom;
+    operation->sockets = {{socket_handle, POLLIN}};
+    operation->blocking = IsBlocking(socket_handle);
+    operation->length = len;
+    operation->flags = flags;
+    operation->want_address = addr_len > 0;
+    operation->data = AcquireBuffer();
+
+    const auto reply = [](SocketOperation& operation, Kernel::HLERequestContext& ctx) {
+        // The mapped buffer is popped again from the context the reply is written to
+        IPC::RequestParser rp(ctx, 0x7, 4, 4);
+        rp.Skip(4, false);
+        rp.PopPID();
+        auto& buffer = rp.PopMappedBuffer();
+
+        std::vector<u8> addr_buff;
+        if (operation.want_address) {
+            addr_buff.resize(sizeof(CTRSockAddr));
+            if (operation.result >= 0 && operation.address_length > 0) {
+                sockaddr src_addr;
+                std::memcpy(&src_addr, operation.address.data(), sizeof(src_addr));
+                CTRSockAddr ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
+                std::memcpy(addr_buff.data(), &ctr_src_addr, sizeof(ctr_src_addr));
+            }
+        }
 
-    s32 ret = -1;
-    if (addr_len > 0) {
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         &src_addr, &src_addr_len);
-        if (ret >= 0 && src_addr_len > 0) {
-            ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
-            std::memcpy(addr_buff.data(), &ctr_src_addr, sizeof(ctr_src_addr));
+        s32 ret = operation.result;
+        if (ret == SOCKET_ERROR_VALUE) {
+            ret = TranslateError(operation.error);
+        } else {
+            buffer.Write(operation.data.data(), 0, ret);
         }
-    } else {
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         NULL, 0);
-        addr_buff.resize(0);
-    }
 
-    if (ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-    } else {
-        buffer.Write(output_buff.data(), 0, ret);
-    }
+        IPC::RequestBuilder rb = rp.MakeBuilder(2, 4);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(ret);
+        rb.PushStaticBuffer(addr_buff, 0);
+        rb.PushMappedBuffer(buffer);
+    };
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 4);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.PushStaticBuffer(addr_buff, 0);
-    rb.PushMappedBuffer(buffer);
+    // Blocking sockets that are not ready yet are left to the reactor
+    SocketReactor::Perform(*operation);
+    if (ShouldWait(*operation)) {
+        WaitForOperation(ctx, std::move(operation), "soc::RecvFromOther", reply);
+        return;
+    }
+    reply(*operation, ctx);
+    ReleaseBuffer(std::move(operation->data));
 }
 
 void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x08, 4, 2);
     u32 socket_handle = rp.Pop<u32>();
     u32 len = rp.Pop<u32>();
@@ -618,42 +717,53 @@ void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
     u32 addr_len = rp.Pop<u32>();
     rp.PopPID();
 
-    CTRSockAddr ctr_src_addr;
-    std::vector<u8> output_buff(len);
-    std::vector<u8> addr_buff(sizeof(ctr_src_addr));
-    sockaddr src_addr;
-    socklen_t src_addr_len = sizeof(src_addr);
-
-    s32 ret = -1;
-    if (addr_len > 0) {
-        // Only get src adr if input adr available
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         &src_addr, &src_addr_len);
-        if (ret >= 0 && src_addr_len > 0) {
-            ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
-            std::memcpy(addr_buff.data(), &ctr_src_addr, sizeof(ctr_src_addr));
+    auto operation = std::make_shared<SocketOperation>();
+    operation->type = SocketOperation::Type::RecvFrom;
+    operation->sockets = {{socket_handle, POLLIN}};
+    operation->blocking = IsBlocking(socket_handle);
+    operation->length = len;
+    operation->flags = flags;
+    // Only get src adr if input adr available
+    operation->want_address = addr_len > 0;
+    operation->data = AcquireBuffer();
+
+    const auto reply = [](SocketOperation& operation, Kernel::HLERequestContext& ctx) {
+        std::vector<u8> addr_buff;
+        if (operation.want_address) {
+            addr_buff.resize(sizeof(CTRSockAddr));
+            if (operation.result >= 0 && operation.address_length > 0) {
+                sockaddr src_addr;
+                std::memcpy(&src_addr, operation.address.data(), sizeof(src_addr));
+                CTRSockAddr ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
+                std::memcpy(addr_buff.data(), &ctr_src_addr, sizeof(ctr_src_addr));
+            }
         }
-    } else {
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         NULL, 0);
-        addr_buff.resize(0);
-    }
 
-    s32 total_received = ret;
-    if (ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-        total_received = 0;
-    }
+        s32 ret = operation.result;
+        s32 total_received = ret;
+        if (ret == SOCKET_ERROR_VALUE) {
+            ret = TranslateError(operation.error);
+            total_received = 0;
+        }
 
-    // Write only the data we received to avoid overwriting parts of the buffer with zeros
-    output_buff.resize(total_received);
+        // Only the data we received is written, to avoid overwriting parts of the buffer with
+        // zeros. The data was already trimmed to the received size.
+        IPC::RequestBuilder rb(ctx, 0x08, 3, 4);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(ret);
+        rb.Push(total_received);
+        rb.PushStaticBuffer(operation.data, 0);
+        rb.PushStaticBuffer(addr_buff, 1);
+    };
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(3, 4);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.Push(total_received);
-    rb.PushStaticBuffer(output_buff, 0);
-    rb.PushStaticBuffer(addr_buff, 1);
+    // Blocking sockets that are not ready yet are left to the reactor
+    SocketReactor::Perform(*operation);
+    if (ShouldWait(*operation)) {
+        WaitForOperation(ctx, std::move(operation), "soc::RecvFrom", reply);
+        return;
+    }
+    reply(*operation, ctx);
+    ReleaseBuffer(std::move(operation->data));
 }
 
 void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
@@ -669,25 +779,47 @@ void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
     // The 3ds_pollfd and the pollfd structures may be different (Windows/Linux have different
     // sizes)
     // so we have to copy the data
-    std::vector<pollfd> platform_pollfd(nfds);
-    std::transform(ctr_fds.begin(), ctr_fds.end(), platform_pollfd.begin(), CTRPollFD::ToPlatform);
-
-    s32 ret = ::poll(platform_pollfd.data(), nfds, timeout);
+    auto operation = std::make_shared<SocketOperation>();
+    operation->type = SocketOperation::Type::Poll;
+    operation->sockets.resize(nfds);
+    std::transform(ctr_fds.begin(), ctr_fds.end(), operation->sockets.begin(),
+                   [](const CTRPollFD& fd) {
+                       const pollfd platform_fd = CTRPollFD::ToPlatform(fd);
+                       return SocketOperation::WaitedSocket{fd.fd, platform_fd.events};
+                   });
+
+    const auto reply = [ctr_fds](SocketOperation& operation, Kernel::HLERequestContext& ctx) {
+        // Now update the output pollfd structure
+        std::vector<CTRPollFD> result_fds = ctr_fds;
+        for (std::size_t i = 0; i < result_fds.size(); ++i) {
+            result_fds[i].revents =
+                CTRPollFD::Events::TranslateTo3DS(operation.sockets[i].revents);
+        }
 
-    // Now update the output pollfd structure
-    std::transform(platform_pollfd.begin(), platform_pollfd.end(), ctr_fds.begin(),
-                   CTRPollFD::FromPlatform);
+        std::vector<u8> output_fds(result_fds.size() * sizeof(CTRPollFD));
+        std::memcpy(output_fds.data(), result_fds.data(), output_fds.size());
 
-    std::vector<u8> output_fds(nfds * sizeof(CTRPollFD));
-    std::memcpy(output_fds.data(), ctr_fds.data(), nfds * sizeof(CTRPollFD));
+        s32 ret = operation.result;
+        if (ret == SOCKET_ERROR_VALUE)
+            ret = TranslateError(operation.error);
 
-    if (ret == SOCKET_ERROR_VALUE)
-        ret = TranslateError(GET_ERRNO);
+        IPC::RequestBuilder rb(ctx, 0x14, 2, 2);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(ret);
+        rb.PushStaticBuffer(output_fds, 0);
+    };
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.PushStaticBuffer(output_fds, 0);
+    // Check the sockets right away, only waiting on the reactor when none of them is ready
+    SocketReactor::Perform(*operation);
+    if (operation->result == 0 && timeout != 0) {
+        if (timeout > 0) {
+            operation->deadline =
+                std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+        }
+        WaitForOperation(ctx, std::move(operation), "soc::Poll", reply);
+        return;
+    }
+    reply(*operation, ctx);
 }
 
 void SOC_U::GetSockName(Kernel::HLERequestContext& ctx) {
@@ -858,7 +990,14 @@ void SOC_U::SetSockOpt(Kernel::HLERequestContext& ctx) {
     rb.Push(err);
 }
 
-SOC_U::SOC_U() : ServiceFramework("soc:U") {
+void SOC_U::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    // The sockets are host sockets
+    if (!open_sockets.empty() || !pending_operations.empty()) {
+        writer.Refuse("sockets are open");
+    }
+}
+
+SOC_U::SOC_U(Core::System& system) : ServiceFramework("soc:U"), system(system) {
     static const FunctionInfo functions[] = {
         {0x00010044, &SOC_U::InitializeSockets, "InitializeSockets"},
         {0x000200C2, &SOC_U::Socket, "Socket"},
@@ -901,10 +1040,16 @@ SOC_U::SOC_U() : ServiceFramework("soc:U") {
     WSADATA data;
     WSAStartup(MAKEWORD(2, 2), &data);
 #endif
+
+    reactor = std::make_unique<SocketReactor>();
+    operation_completed_event = system.CoreTiming().RegisterEvent(
+        "SOC_U::OperationCompleted",
+        [this](u64 operation_id, int cycles_late) { OperationCompleted(operation_id); });
 }
 
 SOC_U::~SOC_U() {
     CleanupSockets();
+    reactor.reset();
 #ifdef _WIN32
     WSACleanup();
 #endif
@@ -912,7 +1057,7 @@ SOC_U::~SOC_U() {
 
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
-    std::make_shared<SOC_U>()->InstallAsService(service_manager);
+    std::make_shared<SOC_U>(system)->InstallAsService(service_manager);
 }
 
 } // namespace Service::SOC
@@ -4,11 +4,18 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_map>
+#include <vector>
 #include "core/hle/service/service.h"
 
 namespace Core {
 class System;
+struct TimingEventType;
+} // namespace Core
+
+namespace Kernel {
+class Event;
 }
 
 namespace Service::SOC {
@@ -16,15 +23,29 @@ namespace Service::SOC {
 /// Holds information about a particular socket
 struct SocketHolder {
     u32 socket_fd; ///< The socket descriptor
-    bool blocking; ///< Whether the socket is blocking or not, it is only read on Windows.
+    bool blocking; ///< Whether the socket is blocking or not
 };
 
+class SocketReactor;
+struct SocketOperation;
+
 class SOC_U final : public ServiceFramework<SOC_U> {
 public:
-    SOC_U();
+    explicit SOC_U(Core::System& system);
     ~SOC_U();
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+
+    /// An operation of a guest thread that sleeps until the reactor completed it
+    struct PendingOperation {
+        std::shared_ptr<SocketOperation> operation;
+        Kernel::SharedPtr<Kernel::Event> event;
+    };
+
+    using ReplyCallback = std::function<void(SocketOperation& operation,
+                                             Kernel::HLERequestContext& ctx)>;
+
     void Socket(Kernel::HLERequestContext& ctx);
     void Bind(Kernel::HLERequestContext& ctx);
     void Fcntl(Kernel::HLERequestContext& ctx);
@@ -48,8 +69,42 @@ private:
     /// Close all open sockets
     void CleanupSockets();
 
+    /// Whether the guest put a socket in blocking mode
+    bool IsBlocking(u32 socket_handle) const;
+
+    /**
+     * Whether a performed operation should be handed to the reactor, as its socket is blocking
+     * but was not ready yet.
+     */
+    bool ShouldWait(const SocketOperation& operation) const;
+
+    /**
+     * Puts the requesting guest thread to sleep until the reactor completed the operation, then
+     * calls the reply callback to write the response.
+     */
+    void WaitForOperation(Kernel::HLERequestContext& ctx,
+                          std::shared_ptr<SocketOperation> operation, const std::string& reason,
+                          ReplyCallback reply);
+
+    /// Called on the emulation thread for operations completed by the reactor
+    void OperationCompleted(u64 operation_id);
+
+    /// Takes a receive buffer from the pool of reusable buffers
+    std::vector<u8> AcquireBuffer();
+    void ReleaseBuffer(std::vector<u8> buffer);
+
+    Core::System& system;
+
     /// Holds info about the currently open sockets
     std::unordered_map<u32, SocketHolder> open_sockets;
+
+    std::unique_ptr<SocketReactor> reactor;
+    Core::TimingEventType* operation_completed_event;
+    std::unordered_map<u64, PendingOperation> pending_operations;
+    u64 next_operation_id = 0;
+
+    /// Receive buffers of completed operations, kept to avoid an allocation per receive
+    std::vector<std::vector<u8>> free_buffers;
 };
 
 void InstallInterfaces(Core::System& system);
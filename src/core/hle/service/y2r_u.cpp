@@ -8,6 +8,7 @@
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/event.h"
+#include "core/hle/kernel/object_state.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/service/y2r_u.h"
 #include "core/hw/y2r.h"
@@ -632,6 +633,21 @@ void Y2R_U::GetPackageParameter(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_Y2R, "called");
 }
 
+void Y2R_U::SaveHandlerState(Kernel::ObjectStateWriter& writer) const {
+    writer.WriteObject(completion_event);
+    writer.Write(conversion);
+    writer.Write(dithering_weight_params);
+    writer.Write(temporal_dithering_enabled);
+    writer.Write(transfer_end_interrupt_enabled);
+    writer.Write(spacial_dithering_enabled);
+}
+
+bool Y2R_U::LoadHandlerState(Kernel::ObjectStateReader& reader) {
+    return reader.ReadObject(completion_event) && reader.Read(conversion) &&
+           reader.Read(dithering_weight_params) && reader.Read(temporal_dithering_enabled) &&
+           reader.Read(transfer_end_interrupt_enabled) && reader.Read(spacial_dithering_enabled);
+}
+
 Y2R_U::Y2R_U(Core::System& system) : ServiceFramework("y2r:u", 1) {
     static const FunctionInfo functions[] = {
         {0x00010040, &Y2R_U::SetInputFormat, "SetInputFormat"},
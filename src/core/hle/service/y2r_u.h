@@ -153,6 +153,9 @@ public:
     ~Y2R_U() override;
 
 private:
+    void SaveHandlerState(Kernel::ObjectStateWriter& writer) const override;
+    bool LoadHandlerState(Kernel::ObjectStateReader& reader) override;
+
     void SetInputFormat(Kernel::HLERequestContext& ctx);
     void GetInputFormat(Kernel::HLERequestContext& ctx);
     void SetOutputFormat(Kernel::HLERequestContext& ctx);
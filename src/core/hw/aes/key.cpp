@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <exception>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <cryptopp/aes.h>
@@ -87,6 +88,7 @@ struct KeySlot {
 };
 
 std::array<KeySlot, KeySlotID::MaxKeySlotID> key_slots;
+std::mutex key_slots_mutex;
 std::array<std::optional<AESKey>, 6> common_key_y_slots;
 
 enum class FirmwareType : u32 {
@@ -451,6 +453,10 @@ void InitKeys() {
     initialized = true;
 }
 
+std::unique_lock<std::mutex> LockKeySlots() {
+    return std::unique_lock{key_slots_mutex};
+}
+
 void SetKeyX(std::size_t slot_id, const AESKey& key) {
     key_slots.at(slot_id).SetKeyX(key);
 }
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <cstddef>
+#include <mutex>
 #include "common/common_types.h"
 
 namespace HW {
@@ -40,6 +41,12 @@ using AESKey = std::array<u8, AES_BLOCK_SIZE>;
 
 void InitKeys();
 
+/**
+ * Locks the key slots. Hold the lock from setting a KeyY until the normal key derived from it has
+ * been read back, as the loaders may run on several threads at once (e.g. the game list scanner).
+ */
+std::unique_lock<std::mutex> LockKeySlots();
+
 void SetGeneratorConstant(const AESKey& key);
 void SetKeyX(std::size_t slot_id, const AESKey& key);
 void SetKeyY(std::size_t slot_id, const AESKey& key);
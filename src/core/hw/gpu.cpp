@@ -16,6 +16,9 @@
 #include "core/hw/gpu.h"
 #include "core/hw/hw.h"
 #include "core/memory.h"
+#ifdef ENABLE_SCRIPTING
+#include "core/rpc/rpc_server.h"
+#endif
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
@@ -514,6 +517,10 @@ template void Write<u8>(u32 addr, const u8 data);
 static void VBlankCallback(u64 userdata, s64 cycles_late) {
     VideoCore::g_renderer->SwapBuffers();
 
+#ifdef ENABLE_SCRIPTING
+    Core::System::GetInstance().RPCServer().PublishSubscription();
+#endif
+
     // Signal to GSP that GPU interrupt has occurred
     // TODO(yuriks): hwtest to determine if PDC0 is for the Top screen and PDC1 for the Sub
     // screen, or if both use the same interrupts and these two instead determine the
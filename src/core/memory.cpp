@@ -8,9 +8,11 @@
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/memory_snapshot.h"
 #include "common/swap.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
+#include "core/gdbstub/gdbstub.h"
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/lock.h"
@@ -56,17 +58,10 @@ private:
 
 class MemorySystem::Impl {
 public:
-    Impl() {
-        std::fill(fcram.get(), fcram.get() + Memory::FCRAM_N3DS_SIZE, 0);
-        std::fill(vram.get(), vram.get() + Memory::VRAM_SIZE, 0);
-        std::fill(n3ds_extra_ram.get(), n3ds_extra_ram.get() + Memory::N3DS_EXTRA_RAM_SIZE, 0);
-    }
-
-    // Visual Studio would try to allocate these on compile time if they are std::array, which would
-    // exceed the memory limit.
-    std::unique_ptr<u8[]> fcram = std::make_unique<u8[]>(Memory::FCRAM_N3DS_SIZE);
-    std::unique_ptr<u8[]> vram = std::make_unique<u8[]>(Memory::VRAM_SIZE);
-    std::unique_ptr<u8[]> n3ds_extra_ram = std::make_unique<u8[]>(Memory::N3DS_EXTRA_RAM_SIZE);
+    // Zeroed pages straight from the OS, which save states write-protect while snapshotting them
+    Common::PagedMemory fcram{Memory::FCRAM_N3DS_SIZE};
+    Common::PagedMemory vram{Memory::VRAM_SIZE};
+    Common::PagedMemory n3ds_extra_ram{Memory::N3DS_EXTRA_RAM_SIZE};
 
     PageTable* current_page_table = nullptr;
     RasterizerCacheMarker cache_marker;
@@ -107,6 +102,22 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, u8* memor
             page_table.pointers[base] = nullptr;
         }
 
+        // Keep watchpoints on remapped memory, as they would otherwise silently stop working
+        if (!page_table.watched_pages.empty()) {
+            const auto watched = page_table.watched_pages.find(base);
+            if (watched != page_table.watched_pages.end()) {
+                if (page_table.attributes[base] == PageType::Memory ||
+                    page_table.attributes[base] == PageType::RasterizerCachedMemory) {
+                    watched->second.type = page_table.attributes[base];
+                    watched->second.pointer = page_table.pointers[base];
+                    page_table.attributes[base] = PageType::Watched;
+                    page_table.pointers[base] = nullptr;
+                } else {
+                    page_table.watched_pages.erase(watched);
+                }
+            }
+        }
+
         base += 1;
         if (memory != nullptr)
             memory += PAGE_SIZE;
@@ -134,6 +145,59 @@ void MemorySystem::UnmapRegion(PageTable& page_table, VAddr base, u32 size) {
     MapPages(page_table, base / PAGE_SIZE, size / PAGE_SIZE, nullptr, PageType::Unmapped);
 }
 
+bool MemorySystem::WatchRegion(PageTable& page_table, VAddr base, u32 size) {
+    const u32 first_page = base >> PAGE_BITS;
+    const u32 last_page = (base + std::max(size, 1u) - 1) >> PAGE_BITS;
+
+    for (u32 page = first_page; page <= last_page; ++page) {
+        const PageType type = page_table.attributes[page];
+        if (type != PageType::Memory && type != PageType::RasterizerCachedMemory &&
+            type != PageType::Watched) {
+            LOG_ERROR(HW_Memory, "Cannot watch page @ 0x{:08X} of type {}", page << PAGE_BITS,
+                      static_cast<int>(type));
+            return false;
+        }
+    }
+
+    for (u32 page = first_page; page <= last_page; ++page) {
+        PageType& type = page_table.attributes[page];
+        if (type == PageType::Watched) {
+            ++page_table.watched_pages.at(page).watchpoint_count;
+            continue;
+        }
+        page_table.watched_pages.emplace(page, WatchedPage{type, page_table.pointers[page], 1});
+        type = PageType::Watched;
+        page_table.pointers[page] = nullptr;
+    }
+    return true;
+}
+
+void MemorySystem::UnwatchRegion(PageTable& page_table, VAddr base, u32 size) {
+    const u32 first_page = base >> PAGE_BITS;
+    const u32 last_page = (base + std::max(size, 1u) - 1) >> PAGE_BITS;
+
+    for (u32 page = first_page; page <= last_page; ++page) {
+        // The page may have been unmapped since it was watched
+        const auto watched = page_table.watched_pages.find(page);
+        if (watched == page_table.watched_pages.end() || --watched->second.watchpoint_count > 0) {
+            continue;
+        }
+        page_table.attributes[page] = watched->second.type;
+        page_table.pointers[page] = watched->second.pointer;
+        page_table.watched_pages.erase(watched);
+    }
+}
+
+u8* MemorySystem::GetPointerForWatchedPage(const PageTable& page_table, VAddr addr, u32 size,
+                                           FlushMode mode) {
+    const WatchedPage& watched = page_table.watched_pages.at(addr >> PAGE_BITS);
+    if (watched.type == PageType::RasterizerCachedMemory) {
+        RasterizerFlushVirtualRegion(addr, size, mode);
+        return GetPointerForRasterizerCache(addr);
+    }
+    return watched.pointer + (addr & PAGE_MASK);
+}
+
 u8* MemorySystem::GetPointerForRasterizerCache(VAddr addr) {
     if (addr >= LINEAR_HEAP_VADDR && addr < LINEAR_HEAP_VADDR_END) {
         return impl->fcram.get() + (addr - LINEAR_HEAP_VADDR);
@@ -202,6 +266,16 @@ T MemorySystem::Read(const VAddr vaddr) {
     }
     case PageType::Special:
         return ReadMMIO<T>(GetMMIOHandler(*impl->current_page_table, vaddr), vaddr);
+    case PageType::Watched: {
+        GDBStub::CheckWatchpoint(vaddr, sizeof(T), GDBStub::BreakpointType::Read);
+
+        T value;
+        std::memcpy(&value,
+                    GetPointerForWatchedPage(*impl->current_page_table, vaddr, sizeof(T),
+                                             FlushMode::Flush),
+                    sizeof(T));
+        return value;
+    }
     default:
         UNREACHABLE();
     }
@@ -239,6 +313,12 @@ void MemorySystem::Write(const VAddr vaddr, const T data) {
     case PageType::Special:
         WriteMMIO<T>(GetMMIOHandler(*impl->current_page_table, vaddr), vaddr, data);
         break;
+    case PageType::Watched:
+        GDBStub::CheckWatchpoint(vaddr, sizeof(T), GDBStub::BreakpointType::Write);
+        std::memcpy(GetPointerForWatchedPage(*impl->current_page_table, vaddr, sizeof(T),
+                                             FlushMode::Invalidate),
+                    &data, sizeof(T));
+        break;
     default:
         UNREACHABLE();
     }
@@ -251,7 +331,8 @@ bool IsValidVirtualAddress(const Kernel::Process& process, const VAddr vaddr) {
     if (page_pointer)
         return true;
 
-    if (page_table.attributes[vaddr >> PAGE_BITS] == PageType::RasterizerCachedMemory)
+    if (page_table.attributes[vaddr >> PAGE_BITS] == PageType::RasterizerCachedMemory ||
+        page_table.attributes[vaddr >> PAGE_BITS] == PageType::Watched)
         return true;
 
     if (page_table.attributes[vaddr >> PAGE_BITS] != PageType::Special)
@@ -280,6 +361,15 @@ u8* MemorySystem::GetPointer(const VAddr vaddr) {
         return GetPointerForRasterizerCache(vaddr);
     }
 
+    // Accesses through the pointer bypass the watchpoints
+    if (impl->current_page_table->attributes[vaddr >> PAGE_BITS] == PageType::Watched) {
+        const WatchedPage& watched = impl->current_page_table->watched_pages.at(vaddr >> PAGE_BITS);
+        if (watched.type == PageType::RasterizerCachedMemory) {
+            return GetPointerForRasterizerCache(vaddr);
+        }
+        return watched.pointer + (vaddr & PAGE_MASK);
+    }
+
     LOG_ERROR(HW_Memory, "unknown GetPointer @ 0x{:08x}", vaddr);
     return nullptr;
 }
@@ -346,6 +436,33 @@ u8* MemorySystem::GetPhysicalPointer(PAddr address) {
     return target_pointer;
 }
 
+std::optional<PAddr> MemorySystem::GetPhysicalAddress(const u8* pointer) {
+    struct MemoryArea {
+        const u8* base;
+        PAddr paddr_base;
+        u32 size;
+    };
+
+    // DSP RAM goes last, as the DSP does not exist outside of a running system
+    const std::array<MemoryArea, 3> memory_areas{{
+        {impl->fcram.get(), FCRAM_PADDR, FCRAM_N3DS_SIZE},
+        {impl->vram.get(), VRAM_PADDR, VRAM_SIZE},
+        {impl->n3ds_extra_ram.get(), N3DS_EXTRA_RAM_PADDR, N3DS_EXTRA_RAM_SIZE},
+    }};
+    for (const MemoryArea& area : memory_areas) {
+        // Inclusive like GetPhysicalPointer, for open right bounds
+        if (pointer >= area.base && pointer <= area.base + area.size) {
+            return area.paddr_base + static_cast<u32>(pointer - area.base);
+        }
+    }
+
+    const u8* const dsp_ram = Core::DSP().GetDspMemory().data();
+    if (pointer >= dsp_ram && pointer <= dsp_ram + DSP_RAM_SIZE) {
+        return DSP_RAM_PADDR + static_cast<u32>(pointer - dsp_ram);
+    }
+    return {};
+}
+
 /// For a rasterizer-accessible PAddr, gets a list of all possible VAddr
 static std::vector<VAddr> PhysicalToVirtualAddressForRasterizer(PAddr addr) {
     if (addr >= VRAM_PADDR && addr < VRAM_PADDR_END) {
@@ -390,6 +507,12 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                         page_type = PageType::RasterizerCachedMemory;
                         page_table->pointers[vaddr >> PAGE_BITS] = nullptr;
                         break;
+                    case PageType::Watched: {
+                        WatchedPage& watched = page_table->watched_pages.at(vaddr >> PAGE_BITS);
+                        watched.type = PageType::RasterizerCachedMemory;
+                        watched.pointer = nullptr;
+                        break;
+                    }
                     default:
                         UNREACHABLE();
                     }
@@ -406,6 +529,12 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                             GetPointerForRasterizerCache(vaddr & ~PAGE_MASK);
                         break;
                     }
+                    case PageType::Watched: {
+                        WatchedPage& watched = page_table->watched_pages.at(vaddr >> PAGE_BITS);
+                        watched.type = PageType::Memory;
+                        watched.pointer = GetPointerForRasterizerCache(vaddr & ~PAGE_MASK);
+                        break;
+                    }
                     default:
                         UNREACHABLE();
                     }
@@ -535,6 +664,13 @@ void MemorySystem::ReadBlock(const Kernel::Process& process, const VAddr src_add
             std::memcpy(dest_buffer, GetPointerForRasterizerCache(current_vaddr), copy_amount);
             break;
         }
+        case PageType::Watched: {
+            std::memcpy(dest_buffer,
+                        GetPointerForWatchedPage(page_table, current_vaddr,
+                                                 static_cast<u32>(copy_amount), FlushMode::Flush),
+                        copy_amount);
+            break;
+        }
         default:
             UNREACHABLE();
         }
@@ -599,6 +735,13 @@ void MemorySystem::WriteBlock(const Kernel::Process& process, const VAddr dest_a
             std::memcpy(GetPointerForRasterizerCache(current_vaddr), src_buffer, copy_amount);
             break;
         }
+        case PageType::Watched: {
+            std::memcpy(GetPointerForWatchedPage(page_table, current_vaddr,
+                                                 static_cast<u32>(copy_amount),
+                                                 FlushMode::Invalidate),
+                        src_buffer, copy_amount);
+            break;
+        }
         default:
             UNREACHABLE();
         }
@@ -649,6 +792,13 @@ void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_ad
             std::memset(GetPointerForRasterizerCache(current_vaddr), 0, copy_amount);
             break;
         }
+        case PageType::Watched: {
+            std::memset(GetPointerForWatchedPage(page_table, current_vaddr,
+                                                 static_cast<u32>(copy_amount),
+                                                 FlushMode::Invalidate),
+                        0, copy_amount);
+            break;
+        }
         default:
             UNREACHABLE();
         }
@@ -699,6 +849,13 @@ void MemorySystem::CopyBlock(const Kernel::Process& process, VAddr dest_addr, VA
                        copy_amount);
             break;
         }
+        case PageType::Watched: {
+            WriteBlock(process, dest_addr,
+                       GetPointerForWatchedPage(page_table, current_vaddr,
+                                                static_cast<u32>(copy_amount), FlushMode::Flush),
+                       copy_amount);
+            break;
+        }
         default:
             UNREACHABLE();
         }
@@ -752,6 +909,13 @@ void MemorySystem::CopyBlock(const Kernel::Process& src_process,
                        copy_amount);
             break;
         }
+        case PageType::Watched: {
+            WriteBlock(dest_process, dest_addr,
+                       GetPointerForWatchedPage(page_table, current_vaddr,
+                                                static_cast<u32>(copy_amount), FlushMode::Flush),
+                       copy_amount);
+            break;
+        }
         default:
             UNREACHABLE();
         }
@@ -814,4 +978,32 @@ u8* MemorySystem::GetFCRAMPointer(u32 offset) {
     return impl->fcram.get() + offset;
 }
 
+std::array<std::unique_ptr<Common::CopyOnWriteSnapshot>, 3> MemorySystem::SaveState() {
+    // Surfaces that were rendered to are only written back to memory on flush
+    RasterizerFlushRegion(FCRAM_PADDR, FCRAM_N3DS_SIZE);
+    RasterizerFlushRegion(VRAM_PADDR, VRAM_SIZE);
+
+    return {std::make_unique<Common::CopyOnWriteSnapshot>(impl->fcram),
+            std::make_unique<Common::CopyOnWriteSnapshot>(impl->vram),
+            std::make_unique<Common::CopyOnWriteSnapshot>(impl->n3ds_extra_ram)};
+}
+
+bool MemorySystem::LoadState(const std::array<const std::vector<u8>*, 3>& sections) {
+    const std::array<Common::PagedMemory*, 3> blocks{&impl->fcram, &impl->vram,
+                                                      &impl->n3ds_extra_ram};
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        if (sections[i]->size() != blocks[i]->size()) {
+            return false;
+        }
+    }
+
+    RasterizerFlushAndInvalidateRegion(FCRAM_PADDR, FCRAM_N3DS_SIZE);
+    RasterizerFlushAndInvalidateRegion(VRAM_PADDR, VRAM_SIZE);
+
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        std::memcpy(blocks[i]->get(), sections[i]->data(), sections[i]->size());
+    }
+    return true;
+}
+
 } // namespace Memory
@@ -6,12 +6,18 @@
 
 #include <array>
 #include <cstddef>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include "common/common_types.h"
 #include "core/mmio.h"
 
+namespace Common {
+class CopyOnWriteSnapshot;
+}
+
 namespace Kernel {
 class Process;
 }
@@ -40,6 +46,9 @@ enum class PageType {
     RasterizerCachedMemory,
     /// Page is mapped to a I/O region. Writing and reading to this page is handled by functions.
     Special,
+    /// Page is mapped to regular memory that contains debugger watchpoints. Reads and writes are
+    /// checked against the watched ranges before accessing the memory.
+    Watched,
 };
 
 struct SpecialRegion {
@@ -48,6 +57,15 @@ struct SpecialRegion {
     MMIORegionPointer handler;
 };
 
+struct WatchedPage {
+    /// Type the page would have without watchpoints, either `Memory` or `RasterizerCachedMemory`
+    PageType type;
+    /// Memory backing the page if `type` is `Memory`
+    u8* pointer;
+    /// Number of watchpoints touching the page
+    u32 watchpoint_count;
+};
+
 /**
  * A (reasonably) fast way of allowing switchable and remappable process address spaces. It loosely
  * mimics the way a real CPU page table works, but instead is optimized for minimal decoding and
@@ -67,6 +85,12 @@ struct PageTable {
      */
     std::vector<SpecialRegion> special_regions;
 
+    /**
+     * State of the pages whose entries in the `attributes` array are of type `Watched`, indexed by
+     * page number.
+     */
+    std::map<u32, WatchedPage> watched_pages;
+
     /**
      * Array of fine grained page attributes. If it is set to any value other than `Memory`, then
      * the corresponding entry in `pointers` MUST be set to null.
@@ -235,6 +259,17 @@ public:
 
     void UnmapRegion(PageTable& page_table, VAddr base, u32 size);
 
+    /**
+     * Switches the pages touching a region to `PageType::Watched`, so that every access to them
+     * goes through the slow path and is checked against the debugger watchpoints. Other pages keep
+     * their fast path.
+     * @returns False, without watching anything, if part of the region is not mapped to memory
+     */
+    bool WatchRegion(PageTable& page_table, VAddr base, u32 size);
+
+    /// Undoes a call to WatchRegion. Pages stay watched while other watchpoints touch them.
+    void UnwatchRegion(PageTable& page_table, VAddr base, u32 size);
+
     /// Currently active page table
     void SetCurrentPageTable(PageTable* page_table);
     PageTable* GetCurrentPageTable() const;
@@ -266,6 +301,13 @@ public:
      */
     u8* GetPhysicalPointer(PAddr address);
 
+    /**
+     * Gets the physical address of a pointer into FCRAM, VRAM, DSP RAM or the N3DS extra RAM, the
+     * inverse of GetPhysicalPointer.
+     * @returns Nothing if the pointer points elsewhere
+     */
+    std::optional<PAddr> GetPhysicalAddress(const u8* pointer);
+
     u8* GetPointer(VAddr vaddr);
 
     bool IsValidPhysicalAddress(PAddr paddr);
@@ -287,6 +329,19 @@ public:
     /// Unregisters page table for rasterizer cache marking
     void UnregisterPageTable(PageTable* page_table);
 
+    /// Names of the save state sections of FCRAM, VRAM and the N3DS extra RAM, in this order
+    static constexpr std::array<const char*, 3> StateSectionNames{{"fcram", "vram", "n3ds_ram"}};
+
+    /**
+     * Starts copy-on-write snapshots of FCRAM, VRAM and the N3DS extra RAM, in the order of
+     * StateSectionNames. Cached rasterizer surfaces are flushed first. The snapshots are finished
+     * by another thread while emulation goes on, writes only copy the chunk they hit.
+     */
+    std::array<std::unique_ptr<Common::CopyOnWriteSnapshot>, 3> SaveState();
+
+    /// Restores the memory saved by SaveState, invalidating the rasterizer cache
+    bool LoadState(const std::array<const std::vector<u8>*, 3>& sections);
+
 private:
     template <typename T>
     T Read(const VAddr vaddr);
@@ -302,6 +357,13 @@ private:
      */
     u8* GetPointerForRasterizerCache(VAddr addr);
 
+    /**
+     * Gets the pointer to the memory backing a page marked as Watched. If the memory is rasterizer
+     * cached, the accessed region is flushed or invalidated first.
+     */
+    u8* GetPointerForWatchedPage(const PageTable& page_table, VAddr addr, u32 size,
+                                 FlushMode mode);
+
     void MapPages(PageTable& page_table, u32 base, u32 size, u8* memory, PageType type);
 
     class Impl;
@@ -2,11 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <string>
 #include <vector>
 #include <boost/optional.hpp>
 #include <cryptopp/hex.h>
+#include <cryptopp/zdeflate.h>
+#include <cryptopp/zinflate.h>
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
@@ -109,18 +113,57 @@ static_assert(sizeof(ControllerState) == 7, "ControllerState should be 7 bytes")
 
 constexpr std::array<u8, 4> header_magic_bytes{{'C', 'T', 'M', 0x1B}};
 
+/// Number of input states in a chunk. Chunks are compressed separately and are the seek points.
+constexpr std::size_t inputs_per_chunk = 4096;
+
+enum class CTMFormat : u8 {
+    /// The input states directly follow the header
+    Raw,
+    /// The input states are stored in chunks, followed by an index of the chunks
+    Chunked,
+};
+
 #pragma pack(push, 1)
 struct CTMHeader {
     std::array<u8, 4> filetype;  /// Unique Identifier to check the file type (always "CTM"0x1B)
     u64_le program_id;           /// ID of the ROM being executed. Also called title_id
     std::array<u8, 20> revision; /// Git hash of the revision this movie was created with
     u64_le clock_init_time;      /// The init time of the system clock
+    CTMFormat format;            /// Layout of the input states following the header
+    u8 compressed;               /// Whether the chunks are compressed with Deflate
+    std::array<u8, 6> padding;
+    u64_le index_offset; /// Offset of the chunk index, 0 if the recording was interrupted
 
-    std::array<u8, 216> reserved; /// Make heading 256 bytes so it has consistent size
+    std::array<u8, 200> reserved; /// Make heading 256 bytes so it has consistent size
 };
 static_assert(sizeof(CTMHeader) == 256, "CTMHeader should be 256 bytes");
+
+struct CTMChunkHeader {
+    u32_le input_count; /// Number of input states in the chunk
+    u32_le data_size;   /// Size of the chunk data following this header
+};
+static_assert(sizeof(CTMChunkHeader) == 8, "CTMChunkHeader should be 8 bytes");
+
+struct CTMIndexEntry {
+    u64_le first_input; /// Index of the first input state of the chunk
+    u64_le offset;      /// Offset of the chunk header in the file
+};
+static_assert(sizeof(CTMIndexEntry) == 16, "CTMIndexEntry should be 16 bytes");
 #pragma pack(pop)
 
+/// Returns the program ID of the running title, 0 while no title is loaded
+static u64 GetRunningProgramId() {
+    const Core::System& system = Core::System::GetInstance();
+    u64 program_id = 0;
+    if (system.IsPoweredOn()) {
+        system.GetAppLoader().ReadProgramId(program_id);
+    }
+    return program_id;
+}
+
+Movie::Movie() = default;
+Movie::~Movie() = default;
+
 bool Movie::IsPlayingInput() const {
     return play_mode == PlayMode::Playing;
 }
@@ -129,14 +172,19 @@ bool Movie::IsRecordingInput() const {
 }
 
 void Movie::CheckInputEnd() {
-    if (current_byte + sizeof(ControllerState) > recorded_input.size()) {
-        LOG_INFO(Movie, "Playback finished");
-        play_mode = PlayMode::None;
-        init_time = 0;
-        playback_completion_callback();
+    if (current_byte + sizeof(ControllerState) > recorded_input.size() && !ReadNextChunk()) {
+        EndPlayback();
     }
 }
 
+void Movie::EndPlayback() {
+    LOG_INFO(Movie, "Playback finished");
+    play_mode = PlayMode::None;
+    init_time = 0;
+    open_movie_file.reset();
+    playback_completion_callback();
+}
+
 void Movie::Play(Service::HID::PadState& pad_state, s16& circle_pad_x, s16& circle_pad_y) {
     ControllerState s;
     std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
@@ -262,6 +310,10 @@ void Movie::Record(const ControllerState& controller_state) {
     recorded_input.resize(current_byte + sizeof(ControllerState));
     std::memcpy(&recorded_input[current_byte], &controller_state, sizeof(ControllerState));
     current_byte += sizeof(ControllerState);
+
+    if (recorded_input.size() == inputs_per_chunk * sizeof(ControllerState)) {
+        WriteChunk();
+    }
 }
 
 void Movie::Record(const Service::HID::PadState& pad_state, const s16& circle_pad_x,
@@ -358,10 +410,15 @@ Movie::ValidationResult Movie::ValidateHeader(const CTMHeader& header, u64 progr
         return ValidationResult::Invalid;
     }
 
+    if (header.format != CTMFormat::Raw && header.format != CTMFormat::Chunked) {
+        LOG_ERROR(Movie, "Playback file was created by a newer version of Citra");
+        return ValidationResult::Invalid;
+    }
+
     std::string revision = fmt::format("{:02x}", fmt::join(header.revision, ""));
 
     if (!program_id)
-        Core::System::GetInstance().GetAppLoader().ReadProgramId(program_id);
+        program_id = GetRunningProgramId();
     if (program_id != header.program_id) {
         LOG_WARNING(Movie, "This movie was recorded using a ROM with a different program id");
         return ValidationResult::GameDismatch;
@@ -376,48 +433,198 @@ Movie::ValidationResult Movie::ValidateHeader(const CTMHeader& header, u64 progr
     return ValidationResult::OK;
 }
 
-void Movie::SaveMovie() {
-    LOG_INFO(Movie, "Saving recorded movie to '{}'", record_movie_file);
-    FileUtil::IOFile save_record(record_movie_file, "wb");
-
-    if (!save_record.IsGood()) {
-        LOG_ERROR(Movie, "Unable to open file to save movie");
-        return;
-    }
-
+void Movie::WriteHeader(u64 index_offset) {
     CTMHeader header = {};
     header.filetype = header_magic_bytes;
     header.clock_init_time = init_time;
+    header.format = CTMFormat::Chunked;
+    header.compressed = compress_chunks ? 1 : 0;
+    header.index_offset = index_offset;
 
-    Core::System::GetInstance().GetAppLoader().ReadProgramId(header.program_id);
+    header.program_id = record_program_id;
 
     std::string rev_bytes;
     CryptoPP::StringSource(Common::g_scm_rev, true,
                            new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
     std::memcpy(header.revision.data(), rev_bytes.data(), sizeof(CTMHeader::revision));
 
-    save_record.WriteBytes(&header, sizeof(CTMHeader));
-    save_record.WriteBytes(recorded_input.data(), recorded_input.size());
+    open_movie_file->Seek(0, SEEK_SET);
+    open_movie_file->WriteBytes(&header, sizeof(CTMHeader));
+}
+
+void Movie::WriteChunk() {
+    if (recorded_input.empty()) {
+        return;
+    }
+
+    const u8* data = recorded_input.data();
+    std::size_t data_size = recorded_input.size();
+    std::string compressed_input;
+    if (compress_chunks) {
+        CryptoPP::ArraySource(recorded_input.data(), recorded_input.size(), true,
+                              new CryptoPP::Deflator(new CryptoPP::StringSink(compressed_input)));
+        data = reinterpret_cast<const u8*>(compressed_input.data());
+        data_size = compressed_input.size();
+    }
+
+    const std::size_t input_count = recorded_input.size() / sizeof(ControllerState);
+    chunk_index.emplace_back(chunk_first_input, open_movie_file->Tell());
 
-    if (!save_record.IsGood()) {
+    CTMChunkHeader chunk_header;
+    chunk_header.input_count = static_cast<u32>(input_count);
+    chunk_header.data_size = static_cast<u32>(data_size);
+    open_movie_file->WriteObject(chunk_header);
+    open_movie_file->WriteBytes(data, data_size);
+    // Push the chunk to the disk, so that it is not lost if the emulator crashes
+    open_movie_file->Flush();
+
+    if (!open_movie_file->IsGood()) {
+        LOG_ERROR(Movie, "Error writing movie to '{}'", record_movie_file);
+    }
+
+    chunk_first_input += input_count;
+    recorded_input.clear();
+    current_byte = 0;
+}
+
+void Movie::SaveMovie() {
+    LOG_INFO(Movie, "Saving recorded movie to '{}'", record_movie_file);
+    WriteChunk();
+
+    const u64 index_offset = open_movie_file->Tell();
+    for (const auto& [first_input, offset] : chunk_index) {
+        CTMIndexEntry entry;
+        entry.first_input = first_input;
+        entry.offset = offset;
+        open_movie_file->WriteObject(entry);
+    }
+    WriteHeader(index_offset);
+
+    if (!open_movie_file->IsGood()) {
         LOG_ERROR(Movie, "Error saving movie");
     }
+    open_movie_file.reset();
+}
+
+bool Movie::ReadChunkIndex(const CTMHeader& header) {
+    chunk_index.clear();
+    const u64 size = open_movie_file->GetSize();
+
+    if (header.format == CTMFormat::Raw) {
+        // Split the inputs into chunks of the usual size, so that they are read the same way
+        const u64 input_count = (size - sizeof(CTMHeader)) / sizeof(ControllerState);
+        for (u64 input = 0; input < input_count; input += inputs_per_chunk) {
+            chunk_index.emplace_back(input, sizeof(CTMHeader) + input * sizeof(ControllerState));
+        }
+        return true;
+    }
+
+    if (header.index_offset != 0 && header.index_offset <= size) {
+        std::vector<CTMIndexEntry> entries((size - header.index_offset) / sizeof(CTMIndexEntry));
+        open_movie_file->Seek(header.index_offset, SEEK_SET);
+        if (open_movie_file->ReadArray(entries.data(), entries.size()) == entries.size()) {
+            for (const CTMIndexEntry& entry : entries) {
+                chunk_index.emplace_back(entry.first_input, entry.offset);
+            }
+            return true;
+        }
+        LOG_WARNING(Movie, "Unable to read the chunk index, rebuilding it");
+        chunk_index.clear();
+        open_movie_file->Clear();
+    }
+
+    // The recording was interrupted before the index was written, so walk the chunks. A chunk cut
+    // short by the interruption is left out.
+    const u64 end = header.index_offset != 0 ? std::min<u64>(header.index_offset, size) : size;
+    u64 offset = sizeof(CTMHeader);
+    u64 input = 0;
+    while (offset + sizeof(CTMChunkHeader) <= end) {
+        CTMChunkHeader chunk_header;
+        open_movie_file->Seek(offset, SEEK_SET);
+        if (open_movie_file->ReadArray(&chunk_header, 1) != 1 ||
+            offset + sizeof(CTMChunkHeader) + chunk_header.data_size > end) {
+            break;
+        }
+        chunk_index.emplace_back(input, offset);
+        input += chunk_header.input_count;
+        offset += sizeof(CTMChunkHeader) + chunk_header.data_size;
+    }
+    open_movie_file->Clear();
+    return !chunk_index.empty();
+}
+
+bool Movie::ReadNextChunk() {
+    recorded_input.clear();
+    current_byte = 0;
+    if (next_chunk >= chunk_index.size()) {
+        return false;
+    }
+
+    const auto [first_input, offset] = chunk_index[next_chunk++];
+    chunk_first_input = first_input;
+    open_movie_file->Seek(offset, SEEK_SET);
+
+    if (raw_format) {
+        const u64 input_count = std::min<u64>(
+            inputs_per_chunk, (open_movie_file->GetSize() - offset) / sizeof(ControllerState));
+        recorded_input.resize(input_count * sizeof(ControllerState));
+        return open_movie_file->ReadBytes(recorded_input.data(), recorded_input.size()) ==
+               recorded_input.size();
+    }
+
+    CTMChunkHeader chunk_header;
+    if (open_movie_file->ReadArray(&chunk_header, 1) != 1) {
+        LOG_ERROR(Movie, "Unable to read movie chunk at offset {}", offset);
+        return false;
+    }
+    std::vector<u8> data(chunk_header.data_size);
+    if (open_movie_file->ReadBytes(data.data(), data.size()) != data.size()) {
+        LOG_ERROR(Movie, "Unable to read movie chunk at offset {}", offset);
+        return false;
+    }
+
+    if (compress_chunks) {
+        std::string input;
+        try {
+            CryptoPP::ArraySource(data.data(), data.size(), true,
+                                  new CryptoPP::Inflator(new CryptoPP::StringSink(input)));
+        } catch (const CryptoPP::Exception& e) {
+            LOG_ERROR(Movie, "Corrupted movie chunk at offset {}: {}", offset, e.what());
+            return false;
+        }
+        recorded_input.assign(input.begin(), input.end());
+    } else {
+        recorded_input = std::move(data);
+    }
+
+    if (recorded_input.size() != chunk_header.input_count * sizeof(ControllerState)) {
+        LOG_ERROR(Movie, "Movie chunk at offset {} has the wrong size", offset);
+        recorded_input.clear();
+        return false;
+    }
+    return true;
 }
 
 void Movie::StartPlayback(const std::string& movie_file,
                           std::function<void()> completion_callback) {
     LOG_INFO(Movie, "Loading Movie for playback");
-    FileUtil::IOFile save_record(movie_file, "rb");
-    const u64 size = save_record.GetSize();
+    std::lock_guard lock(mutex);
+    auto save_record = std::make_unique<FileUtil::IOFile>(movie_file, "rb");
+    const u64 size = save_record->GetSize();
 
-    if (save_record.IsGood() && size > sizeof(CTMHeader)) {
+    if (save_record->IsGood() && size > sizeof(CTMHeader)) {
         CTMHeader header;
-        save_record.ReadArray(&header, 1);
+        save_record->ReadArray(&header, 1);
         if (ValidateHeader(header) != ValidationResult::Invalid) {
+            open_movie_file = std::move(save_record);
+            raw_format = header.format == CTMFormat::Raw;
+            compress_chunks = header.compressed != 0;
+            if (!ReadChunkIndex(header) || !SeekPlaybackLocked(0)) {
+                LOG_ERROR(Movie, "Failed to playback movie: '{}' has no inputs", movie_file);
+                open_movie_file.reset();
+                return;
+            }
             play_mode = PlayMode::Playing;
-            recorded_input.resize(size - sizeof(CTMHeader));
-            save_record.ReadArray(recorded_input.data(), recorded_input.size());
-            current_byte = 0;
             playback_completion_callback = completion_callback;
         }
     } else {
@@ -425,10 +632,58 @@ void Movie::StartPlayback(const std::string& movie_file,
     }
 }
 
-void Movie::StartRecording(const std::string& movie_file) {
+bool Movie::SeekPlayback(u64 input) {
+    std::lock_guard lock(mutex);
+    return SeekPlaybackLocked(input);
+}
+
+bool Movie::SeekPlaybackLocked(u64 input) {
+    if (!open_movie_file) {
+        return false;
+    }
+
+    // Find the last chunk starting at or before the input
+    const auto chunk =
+        std::upper_bound(chunk_index.begin(), chunk_index.end(), input,
+                         [](u64 input, const auto& entry) { return input < entry.first; });
+    if (chunk != chunk_index.begin()) {
+        next_chunk = static_cast<std::size_t>(std::prev(chunk) - chunk_index.begin());
+        if (ReadNextChunk() &&
+            (input - chunk_first_input) * sizeof(ControllerState) < recorded_input.size()) {
+            current_byte = static_cast<std::size_t>(input - chunk_first_input) *
+                           sizeof(ControllerState);
+            return true;
+        }
+    }
+
+    LOG_ERROR(Movie, "Unable to seek to input {}", input);
+    if (IsPlayingInput()) {
+        EndPlayback();
+    }
+    return false;
+}
+
+void Movie::StartRecording(const std::string& movie_file, bool compress,
+                           std::optional<u64> program_id) {
     LOG_INFO(Movie, "Enabling Movie recording");
+    std::lock_guard lock(mutex);
+    open_movie_file = std::make_unique<FileUtil::IOFile>(movie_file, "wb");
+    if (!open_movie_file->IsGood()) {
+        LOG_ERROR(Movie, "Unable to open file to save movie");
+        open_movie_file.reset();
+        return;
+    }
+
     play_mode = PlayMode::Recording;
     record_movie_file = movie_file;
+    record_program_id = program_id ? *program_id : GetRunningProgramId();
+    compress_chunks = compress;
+    recorded_input.reserve(inputs_per_chunk * sizeof(ControllerState));
+    chunk_index.clear();
+    chunk_first_input = 0;
+    current_byte = 0;
+    // Written again with the offset of the index when the recording is saved
+    WriteHeader(0);
 }
 
 static boost::optional<CTMHeader> ReadHeader(const std::string& movie_file) {
@@ -481,19 +736,26 @@ u64 Movie::GetMovieProgramID(const std::string& movie_file) const {
 }
 
 void Movie::Shutdown() {
+    std::lock_guard lock(mutex);
     if (IsRecordingInput()) {
         SaveMovie();
     }
 
     play_mode = PlayMode::None;
+    open_movie_file.reset();
     recorded_input.resize(0);
+    chunk_index.clear();
     record_movie_file.clear();
+    record_program_id = 0;
+    chunk_first_input = 0;
+    next_chunk = 0;
     current_byte = 0;
     init_time = 0;
 }
 
 template <typename... Targs>
 void Movie::Handle(Targs&... Fargs) {
+    std::lock_guard lock(mutex);
     if (IsPlayingInput()) {
         ASSERT(current_byte + sizeof(ControllerState) <= recorded_input.size());
         Play(Fargs...);
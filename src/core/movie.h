@@ -5,8 +5,18 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 #include "common/common_types.h"
 
+namespace FileUtil {
+class IOFile;
+}
+
 namespace Service {
 namespace HID {
 struct AccelerometerDataEntry;
@@ -41,9 +51,26 @@ public:
         return s_instance;
     }
 
+    Movie();
+    ~Movie();
+
     void StartPlayback(const std::string& movie_file,
                        std::function<void()> completion_callback = [] {});
-    void StartRecording(const std::string& movie_file);
+
+    /**
+     * Starts recording. The inputs are written to the file in chunks while recording, so memory
+     * use does not grow with the length of the recording.
+     * @param compress Whether to compress the chunks
+     * @param program_id Program ID stored in the movie, that of the running application if not set
+     */
+    void StartRecording(const std::string& movie_file, bool compress = true,
+                        std::optional<u64> program_id = std::nullopt);
+
+    /**
+     * Moves playback to the given input state, counting from the start of the movie.
+     * @returns False if the movie has fewer input states
+     */
+    bool SeekPlayback(u64 input);
 
     /// Prepare to override the clock before playing back movies
     void PrepareForPlayback(const std::string& movie_file);
@@ -103,6 +130,9 @@ private:
 
     void CheckInputEnd();
 
+    /// SeekPlayback with mutex already held
+    bool SeekPlaybackLocked(u64 input);
+
     template <typename... Targs>
     void Handle(Targs&... Fargs);
 
@@ -124,13 +154,42 @@ private:
 
     ValidationResult ValidateHeader(const CTMHeader& header, u64 program_id = 0) const;
 
+    /// Writes the header of the recording, at the start of the movie file
+    void WriteHeader(u64 index_offset);
+
+    /// Writes the recorded inputs to the movie file as a chunk
+    void WriteChunk();
+
+    /// Writes the remaining inputs and the chunk index, and closes the movie file
     void SaveMovie();
 
-    PlayMode play_mode;
+    /// Reads the chunk index of the movie being played, rebuilding it if it was not saved
+    bool ReadChunkIndex(const CTMHeader& header);
+
+    /// Loads the next chunk of the movie being played into recorded_input
+    bool ReadNextChunk();
+
+    void EndPlayback();
+
+    PlayMode play_mode{};
     std::string record_movie_file;
+    /// Program ID of the application being recorded, which may be shut down when saving
+    u64 record_program_id = 0;
+    std::unique_ptr<FileUtil::IOFile> open_movie_file;
+    bool compress_chunks = false;
+    bool raw_format = false;
+    /// Inputs of the current chunk
     std::vector<u8> recorded_input;
-    u64 init_time;
+    /// Index of the first input of the current chunk, counting from the start of the movie
+    u64 chunk_first_input = 0;
+    /// Index of the first input and file offset of every chunk
+    std::vector<std::pair<u64, u64>> chunk_index;
+    /// Position in chunk_index of the chunk to play after the current one
+    std::size_t next_chunk = 0;
+    u64 init_time = 0;
     std::function<void()> playback_completion_callback;
     std::size_t current_byte = 0;
+    /// Guards the state above, which the frontend changes while the emulation thread handles input
+    std::mutex mutex;
 };
 } // namespace Core
\ No newline at end of file
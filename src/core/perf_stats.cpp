@@ -6,6 +6,7 @@
 #include <chrono>
 #include <mutex>
 #include <thread>
+#include "common/counters.h"
 #include "core/hw/gpu.h"
 #include "core/perf_stats.h"
 #include "core/settings.h"
@@ -23,7 +24,13 @@ void PerfStats::BeginSystemFrame() {
     frame_begin = Clock::now();
 }
 
+static const Common::Counters::Counter system_frames_counter = Common::Counters::Register(
+    "citra_system_frames_total", "Frames presented by the emulated LCD (VBlanks)");
+static const Common::Counters::Counter game_frames_counter = Common::Counters::Register(
+    "citra_game_frames_total", "Frames submitted by the game through GSP");
+
 void PerfStats::EndSystemFrame() {
+    system_frames_counter.Add();
     std::lock_guard<std::mutex> lock(object_mutex);
 
     auto frame_end = Clock::now();
@@ -35,6 +42,7 @@ void PerfStats::EndSystemFrame() {
 }
 
 void PerfStats::EndGameFrame() {
+    game_frames_counter.Add();
     std::lock_guard<std::mutex> lock(object_mutex);
 
     game_frames += 1;
@@ -4,8 +4,8 @@
 
 #pragma once
 
-#include <array>
 #include <functional>
+#include <vector>
 #include "common/common_types.h"
 
 namespace RPC {
@@ -14,6 +14,18 @@ enum class PacketType {
     Undefined = 0,
     ReadMemory,
     WriteMemory,
+    // Version 2. Failed requests of this version are answered with an empty Undefined packet.
+    /// Reads a list of ranges. The data is a count followed by that many (address, size) pairs, and
+    /// the reply holds the memory of every range, one after the other.
+    ReadMemoryBatch,
+    /// Writes a list of ranges. The data is a count followed by that many (address, size) pairs,
+    /// each directly followed by size bytes to write.
+    WriteMemoryBatch,
+    /// Replaces the ranges published to subscribers every frame, using the format of
+    /// ReadMemoryBatch. A count of 0 stops publishing.
+    SetSubscription,
+    /// Published every frame with the memory of the subscribed ranges. The id is the frame number.
+    SubscriptionData,
 };
 
 struct PacketHeader {
@@ -23,15 +35,16 @@ struct PacketHeader {
     u32 packet_size;
 };
 
-constexpr u32 CURRENT_VERSION = 1;
+constexpr u32 CURRENT_VERSION = 2;
 constexpr u32 MIN_PACKET_SIZE = sizeof(PacketHeader);
-constexpr u32 MAX_PACKET_DATA_SIZE = 32;
+constexpr u32 MAX_PACKET_DATA_SIZE = 1024 * 1024;
 constexpr u32 MAX_PACKET_SIZE = MIN_PACKET_SIZE + MAX_PACKET_DATA_SIZE;
 constexpr u32 MAX_READ_SIZE = MAX_PACKET_DATA_SIZE;
 
 class Packet {
 public:
-    Packet(const PacketHeader& header, u8* data, std::function<void(Packet&)> send_reply_callback);
+    Packet(const PacketHeader& header, const u8* data,
+           std::function<void(Packet&)> send_reply_callback);
 
     u32 GetVersion() const {
         return header.version;
@@ -53,12 +66,21 @@ public:
         return header;
     }
 
-    std::array<u8, MAX_PACKET_DATA_SIZE>& GetPacketData() {
+    std::vector<u8>& GetPacketData() {
         return packet_data;
     }
 
+    const std::vector<u8>& GetPacketData() const {
+        return packet_data;
+    }
+
+    void SetPacketType(PacketType type) {
+        header.packet_type = type;
+    }
+
     void SetPacketDataSize(u32 size) {
         header.packet_size = size;
+        packet_data.resize(size);
     }
 
     void SendReply() {
@@ -66,11 +88,8 @@ public:
     }
 
 private:
-    void HandleReadMemory(u32 address, u32 data_size);
-    void HandleWriteMemory(u32 address, const u8* data, u32 data_size);
-
     struct PacketHeader header;
-    std::array<u8, MAX_PACKET_DATA_SIZE> packet_data;
+    std::vector<u8> packet_data;
 
     std::function<void(Packet&)> send_reply_callback;
 };
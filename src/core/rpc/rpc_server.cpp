@@ -1,3 +1,4 @@
+#include <cstring>
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
@@ -8,6 +9,19 @@
 
 namespace RPC {
 
+namespace {
+/// Whether [address, address + size) lies within a single region that clients may write to
+bool IsWritableRange(u32 address, u32 size) {
+    const u64 end = static_cast<u64>(address) + size;
+    const auto in_region = [address, end](u32 region_start, u32 region_end) {
+        return address >= region_start && end <= region_end;
+    };
+    return in_region(Memory::PROCESS_IMAGE_VADDR, Memory::PROCESS_IMAGE_VADDR_END) ||
+           in_region(Memory::HEAP_VADDR, Memory::HEAP_VADDR_END) ||
+           in_region(Memory::N3DS_EXTRA_RAM_VADDR, Memory::N3DS_EXTRA_RAM_VADDR_END);
+}
+} // Anonymous namespace
+
 RPCServer::RPCServer() : server(*this) {
     LOG_INFO(RPC_Server, "Starting RPC server ...");
 
@@ -30,26 +44,144 @@ void RPCServer::HandleReadMemory(Packet& packet, u32 address, u32 data_size) {
     }
 
     // Note: Memory read occurs asynchronously from the state of the emulator
+    packet.SetPacketDataSize(data_size);
     Core::System::GetInstance().Memory().ReadBlock(
         *Core::System::GetInstance().Kernel().GetCurrentProcess(), address,
         packet.GetPacketData().data(), data_size);
-    packet.SetPacketDataSize(data_size);
     packet.SendReply();
 }
 
 void RPCServer::HandleWriteMemory(Packet& packet, u32 address, const u8* data, u32 data_size) {
+    WriteMemory(address, data, data_size);
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+}
+
+void RPCServer::HandleReadMemoryBatch(Packet& packet, const std::vector<MemoryRange>& ranges) {
+    u32 total_size = 0;
+    for (const MemoryRange& range : ranges) {
+        total_size += range.size;
+    }
+
+    // Note: Memory reads occur asynchronously from the state of the emulator
+    Memory::MemorySystem& memory = Core::System::GetInstance().Memory();
+    const Kernel::Process& process = *Core::System::GetInstance().Kernel().GetCurrentProcess();
+    packet.SetPacketDataSize(total_size);
+    u8* data = packet.GetPacketData().data();
+    for (const MemoryRange& range : ranges) {
+        memory.ReadBlock(process, range.address, data, range.size);
+        data += range.size;
+    }
+    packet.SendReply();
+}
+
+bool RPCServer::HandleWriteMemoryBatch(Packet& packet) {
+    const std::vector<u8>& data = packet.GetPacketData();
+    u32 count = 0;
+    std::memcpy(&count, data.data(), sizeof(count));
+
+    // Validate the whole request first, so that a malformed request or one reaching outside the
+    // writable regions writes nothing
+    std::size_t offset = sizeof(count);
+    for (u32 i = 0; i < count; ++i) {
+        MemoryRange range;
+        if (data.size() - offset < sizeof(range)) {
+            return false;
+        }
+        std::memcpy(&range, data.data() + offset, sizeof(range));
+        offset += sizeof(range);
+        if (data.size() - offset < range.size || !IsWritableRange(range.address, range.size)) {
+            return false;
+        }
+        offset += range.size;
+    }
+    if (offset != data.size()) {
+        return false;
+    }
+
+    offset = sizeof(count);
+    for (u32 i = 0; i < count; ++i) {
+        MemoryRange range;
+        std::memcpy(&range, data.data() + offset, sizeof(range));
+        offset += sizeof(range);
+        WriteMemory(range.address, data.data() + offset, range.size);
+        offset += range.size;
+    }
+
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+    return true;
+}
+
+void RPCServer::HandleSetSubscription(Packet& packet, std::vector<MemoryRange> ranges) {
+    u32 total_size = 0;
+    for (const MemoryRange& range : ranges) {
+        total_size += range.size;
+    }
+
+    {
+        std::lock_guard lock(subscription_mutex);
+        subscription = std::move(ranges);
+        subscription_size = total_size;
+    }
+
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+}
+
+void RPCServer::PublishSubscription() {
+    std::lock_guard lock(subscription_mutex);
+    ++frame_number;
+    if (subscription.empty()) {
+        return;
+    }
+
+    const PacketHeader header{CURRENT_VERSION, frame_number, PacketType::SubscriptionData, 0};
+    auto packet = std::make_unique<Packet>(header, nullptr, nullptr);
+
+    // Unlike requests, this runs on the emulation thread, so all ranges are from the same frame
+    Memory::MemorySystem& memory = Core::System::GetInstance().Memory();
+    const Kernel::Process& process = *Core::System::GetInstance().Kernel().GetCurrentProcess();
+    packet->SetPacketDataSize(subscription_size);
+    u8* data = packet->GetPacketData().data();
+    for (const MemoryRange& range : subscription) {
+        memory.ReadBlock(process, range.address, data, range.size);
+        data += range.size;
+    }
+    server.Publish(std::move(packet));
+}
+
+std::optional<std::vector<RPCServer::MemoryRange>> RPCServer::ParseMemoryRanges(
+    const Packet& packet) {
+    const std::vector<u8>& data = packet.GetPacketData();
+    u32 count = 0;
+    std::memcpy(&count, data.data(), sizeof(count));
+    if (data.size() != sizeof(count) + static_cast<u64>(count) * sizeof(MemoryRange)) {
+        return std::nullopt;
+    }
+
+    std::vector<MemoryRange> ranges(count);
+    std::memcpy(ranges.data(), data.data() + sizeof(count), count * sizeof(MemoryRange));
+
+    u64 total_size = 0;
+    for (const MemoryRange& range : ranges) {
+        total_size += range.size;
+    }
+    if (total_size > MAX_READ_SIZE) {
+        return std::nullopt;
+    }
+    return ranges;
+}
+
+void RPCServer::WriteMemory(u32 address, const u8* data, u32 data_size) {
     // Only allow writing to certain memory regions
-    if ((address >= Memory::PROCESS_IMAGE_VADDR && address <= Memory::PROCESS_IMAGE_VADDR_END) ||
-        (address >= Memory::HEAP_VADDR && address <= Memory::HEAP_VADDR_END) ||
-        (address >= Memory::N3DS_EXTRA_RAM_VADDR && address <= Memory::N3DS_EXTRA_RAM_VADDR_END)) {
+    if (IsWritableRange(address, data_size)) {
         // Note: Memory write occurs asynchronously from the state of the emulator
         Core::System::GetInstance().Memory().WriteBlock(
             *Core::System::GetInstance().Kernel().GetCurrentProcess(), address, data, data_size);
         // If the memory happens to be executable code, make sure the changes become visible
         Core::CPU().InvalidateCacheRange(address, data_size);
     }
-    packet.SetPacketDataSize(0);
-    packet.SendReply();
 }
 
 bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
@@ -61,6 +193,13 @@ bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
                 return true;
             }
             break;
+        case PacketType::ReadMemoryBatch:
+        case PacketType::WriteMemoryBatch:
+        case PacketType::SetSubscription:
+            if (packet_header.version >= 2 && packet_header.packet_size >= sizeof(u32)) {
+                return true;
+            }
+            break;
         default:
             break;
         }
@@ -72,34 +211,55 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     bool success = false;
 
     if (ValidatePacket(request_packet->GetHeader())) {
-        // Currently, all request types use the address/data_size wire format
+        const u8* request_data = request_packet->GetPacketData().data();
         u32 address = 0;
         u32 data_size = 0;
-        std::memcpy(&address, request_packet->GetPacketData().data(), sizeof(address));
-        std::memcpy(&data_size, request_packet->GetPacketData().data() + sizeof(address),
-                    sizeof(data_size));
 
         switch (request_packet->GetPacketType()) {
         case PacketType::ReadMemory:
+            std::memcpy(&address, request_data, sizeof(address));
+            std::memcpy(&data_size, request_data + sizeof(address), sizeof(data_size));
             if (data_size > 0 && data_size <= MAX_READ_SIZE) {
                 HandleReadMemory(*request_packet, address, data_size);
                 success = true;
             }
             break;
         case PacketType::WriteMemory:
-            if (data_size > 0 && data_size <= MAX_PACKET_DATA_SIZE - (sizeof(u32) * 2)) {
-                const u8* data = request_packet->GetPacketData().data() + (sizeof(u32) * 2);
+            std::memcpy(&address, request_data, sizeof(address));
+            std::memcpy(&data_size, request_data + sizeof(address), sizeof(data_size));
+            if (data_size > 0 &&
+                data_size <= request_packet->GetPacketDataSize() - (sizeof(u32) * 2)) {
+                const u8* data = request_data + (sizeof(u32) * 2);
                 HandleWriteMemory(*request_packet, address, data, data_size);
                 success = true;
             }
             break;
+        case PacketType::ReadMemoryBatch:
+            if (auto ranges = ParseMemoryRanges(*request_packet)) {
+                HandleReadMemoryBatch(*request_packet, *ranges);
+                success = true;
+            }
+            break;
+        case PacketType::WriteMemoryBatch:
+            success = HandleWriteMemoryBatch(*request_packet);
+            break;
+        case PacketType::SetSubscription:
+            if (auto ranges = ParseMemoryRanges(*request_packet)) {
+                HandleSetSubscription(*request_packet, std::move(*ranges));
+                success = true;
+            }
+            break;
         default:
             break;
         }
     }
 
     if (!success) {
-        // Send an empty reply, so as not to hang the client
+        // Send an empty reply, so as not to hang the client. From version 2 on, its type tells
+        // clients that the request failed, as successful writes are answered with empty replies.
+        if (request_packet->GetVersion() >= 2) {
+            request_packet->SetPacketType(PacketType::Undefined);
+        }
         request_packet->SetPacketDataSize(0);
         request_packet->SendReply();
     }
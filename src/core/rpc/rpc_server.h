@@ -7,7 +7,9 @@
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <vector>
 #include "common/threadsafe_queue.h"
 #include "core/rpc/server.h"
 
@@ -20,11 +22,28 @@ public:
 
     void QueueRequest(std::unique_ptr<RPC::Packet> request);
 
+    /// Publishes the subscribed memory ranges. Called by the emulation thread at every VBlank.
+    void PublishSubscription();
+
 private:
+    struct MemoryRange {
+        u32 address;
+        u32 size;
+    };
+
     void Start();
     void Stop();
     void HandleReadMemory(Packet& packet, u32 address, u32 data_size);
     void HandleWriteMemory(Packet& packet, u32 address, const u8* data, u32 data_size);
+    void HandleReadMemoryBatch(Packet& packet, const std::vector<MemoryRange>& ranges);
+    bool HandleWriteMemoryBatch(Packet& packet);
+    void HandleSetSubscription(Packet& packet, std::vector<MemoryRange> ranges);
+    /**
+     * Parses a count followed by that many (address, size) pairs, which must fill the packet.
+     * Returns nothing if the list is malformed or the ranges add up to more than a reply can hold.
+     */
+    std::optional<std::vector<MemoryRange>> ParseMemoryRanges(const Packet& packet);
+    void WriteMemory(u32 address, const u8* data, u32 data_size);
     bool ValidatePacket(const PacketHeader& packet_header);
     void HandleSingleRequest(std::unique_ptr<Packet> request);
     void HandleRequestsLoop();
@@ -32,6 +51,11 @@ private:
     Server server;
     Common::SPSCQueue<std::unique_ptr<Packet>> request_queue;
     std::thread request_handler_thread;
+
+    std::mutex subscription_mutex;
+    std::vector<MemoryRange> subscription;
+    u32 subscription_size = 0;
+    u32 frame_number = 0;
 };
 
 } // namespace RPC
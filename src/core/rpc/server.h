@@ -18,6 +18,8 @@ public:
     void Start();
     void Stop();
     void NewRequestCallback(std::unique_ptr<RPC::Packet> new_request);
+    /// Sends a packet to all subscribers
+    void Publish(std::unique_ptr<RPC::Packet> packet);
 
 private:
     RPCServer& rpc_server;
@@ -5,24 +5,46 @@
 
 namespace RPC {
 
+/// Maximum number of published frames queued for a slow subscriber before frames are dropped
+constexpr int PUBLISHER_HIGH_WATER_MARK = 60;
+
+static zmq::message_t MakeMessage(Packet& packet) {
+    zmq::message_t message(MIN_PACKET_SIZE + packet.GetPacketDataSize());
+    u8* buffer = static_cast<u8*>(message.data());
+    const PacketHeader& header = packet.GetHeader();
+    std::memcpy(buffer, &header, sizeof(header));
+    std::memcpy(buffer + MIN_PACKET_SIZE, packet.GetPacketData().data(),
+                packet.GetPacketDataSize());
+    return message;
+}
+
 ZMQServer::ZMQServer(std::function<void(std::unique_ptr<Packet>)> new_request_callback)
     : zmq_context(std::move(std::make_unique<zmq::context_t>(1))),
       zmq_socket(std::move(std::make_unique<zmq::socket_t>(*zmq_context, ZMQ_REP))),
+      zmq_publisher(std::make_unique<zmq::socket_t>(*zmq_context, ZMQ_PUB)),
       new_request_callback(std::move(new_request_callback)) {
     // Use a random high port
     // TODO: Make configurable or increment port number on failure
     zmq_socket->bind("tcp://127.0.0.1:45987");
     LOG_INFO(RPC_Server, "ZeroMQ listening on port 45987");
 
+    zmq_publisher->setsockopt(ZMQ_SNDHWM, PUBLISHER_HIGH_WATER_MARK);
+    zmq_publisher->bind("tcp://127.0.0.1:45988");
+    LOG_INFO(RPC_Server, "ZeroMQ publishing on port 45988");
+
     worker_thread = std::thread(&ZMQServer::WorkerLoop, this);
+    publisher_thread = std::thread(&ZMQServer::PublisherLoop, this);
 }
 
 ZMQServer::~ZMQServer() {
     // Triggering the zmq_context destructor will cancel
     // any blocking calls to zmq_socket->recv()
     running = false;
+    // The publisher must close its socket first, as the zmq_context destructor waits for it
+    publish_queue.Push(nullptr);
     zmq_context.reset();
     worker_thread.join();
+    publisher_thread.join();
 
     LOG_INFO(RPC_Server, "ZeroMQ stopped");
 }
@@ -58,21 +80,35 @@ void ZMQServer::WorkerLoop() {
     zmq_socket.reset();
 }
 
-void ZMQServer::SendReply(Packet& reply_packet) {
-    if (running) {
-        auto reply_buffer =
-            std::make_unique<u8[]>(MIN_PACKET_SIZE + reply_packet.GetPacketDataSize());
-        auto reply_header = reply_packet.GetHeader();
+void ZMQServer::PublisherLoop() {
+    std::unique_ptr<Packet> packet;
+    while ((packet = publish_queue.PopWait())) {
+        try {
+            zmq::message_t message = MakeMessage(*packet);
+            // Frames are dropped rather than queued without bound if subscribers fall behind
+            zmq_publisher->send(message, ZMQ_DONTWAIT);
+        } catch (...) {
+            LOG_WARNING(RPC_Server, "Failed to publish data on ZeroMQ socket");
+        }
+    }
+    // Destroying the socket must be done by this thread.
+    zmq_publisher.reset();
+}
 
-        std::memcpy(reply_buffer.get(), &reply_header, sizeof(reply_header));
-        std::memcpy(reply_buffer.get() + (4 * sizeof(u32)), reply_packet.GetPacketData().data(),
-                    reply_packet.GetPacketDataSize());
+void ZMQServer::Publish(std::unique_ptr<Packet> packet) {
+    if (running) {
+        publish_queue.Push(std::move(packet));
+    }
+}
 
-        zmq_socket->send(reply_buffer.get(), MIN_PACKET_SIZE + reply_packet.GetPacketDataSize());
+void ZMQServer::SendReply(Packet& reply_packet) {
+    if (running) {
+        zmq::message_t reply = MakeMessage(reply_packet);
+        zmq_socket->send(reply);
 
-        LOG_INFO(RPC_Server, "Sent reply version({}) id=({}) type=({}) size=({})",
-                 reply_packet.GetVersion(), reply_packet.GetId(),
-                 static_cast<u32>(reply_packet.GetPacketType()), reply_packet.GetPacketDataSize());
+        LOG_TRACE(RPC_Server, "Sent reply version({}) id=({}) type=({}) size=({})",
+                  reply_packet.GetVersion(), reply_packet.GetId(),
+                  static_cast<u32>(reply_packet.GetPacketType()), reply_packet.GetPacketDataSize());
     }
 }
 
@@ -8,6 +8,7 @@
 #include <thread>
 #define ZMQ_STATIC
 #include <zmq.hpp>
+#include "common/threadsafe_queue.h"
 
 namespace RPC {
 
@@ -18,15 +19,23 @@ public:
     explicit ZMQServer(std::function<void(std::unique_ptr<Packet>)> new_request_callback);
     ~ZMQServer();
 
+    /// Queues a packet to be sent to all subscribers
+    void Publish(std::unique_ptr<Packet> packet);
+
 private:
     void WorkerLoop();
+    void PublisherLoop();
     void SendReply(Packet& request);
 
     std::thread worker_thread;
+    std::thread publisher_thread;
     std::atomic_bool running = true;
 
     std::unique_ptr<zmq::context_t> zmq_context;
     std::unique_ptr<zmq::socket_t> zmq_socket;
+    /// Subscription data is published on a separate socket, as REP sockets can only reply
+    std::unique_ptr<zmq::socket_t> zmq_publisher;
+    Common::MPSCQueue<std::unique_ptr<Packet>> publish_queue;
 
     std::function<void(std::unique_ptr<Packet>)> new_request_callback;
 };
@@ -0,0 +1,170 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cryptopp/filters.h>
+#include <cryptopp/hex.h>
+#include <cryptopp/zdeflate.h>
+#include <cryptopp/zinflate.h>
+#include <fmt/format.h>
+#include "common/assert.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/swap.h"
+#include "core/savestate.h"
+
+namespace Core {
+
+namespace {
+
+constexpr std::array<u8, 4> SaveStateMagic = {'C', 'S', 'T', 0x1B};
+
+#pragma pack(push, 1)
+struct SaveStateHeader {
+    std::array<u8, 4> filetype;  /// Unique Identifier to check the file type (always "CST"0x1B)
+    u32_le version;              /// Version of the layout, see SaveStateVersion
+    u64_le program_id;           /// ID of the ROM being executed. Also called title_id
+    std::array<u8, 20> revision; /// Git hash of the revision this state was created with
+    u32_le section_count;        /// Number of sections following the header
+
+    std::array<u8, 24> reserved; /// Make heading 64 bytes so it has consistent size
+};
+static_assert(sizeof(SaveStateHeader) == 64, "SaveStateHeader should be 64 bytes");
+
+struct SaveStateSectionHeader {
+    std::array<char, 16> name; /// Name of the section, padded with zeroes
+    u64_le size;               /// Size of the section data once decompressed
+    u64_le compressed_size;    /// Size of the compressed data following this header
+};
+static_assert(sizeof(SaveStateSectionHeader) == 32, "SaveStateSectionHeader should be 32 bytes");
+#pragma pack(pop)
+
+} // Anonymous namespace
+
+bool WriteSaveState(const std::string& path, u64 program_id,
+                    const std::vector<SaveStateSection>& sections,
+                    const std::vector<SaveStateBlock>& blocks) {
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Unable to open {} for writing", path);
+        return false;
+    }
+
+    SaveStateHeader header{};
+    header.filetype = SaveStateMagic;
+    header.version = SaveStateVersion;
+    header.program_id = program_id;
+    header.section_count = static_cast<u32>(sections.size() + blocks.size());
+
+    std::string rev_bytes;
+    CryptoPP::StringSource(Common::g_scm_rev, true,
+                           new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
+    std::memcpy(header.revision.data(), rev_bytes.data(),
+                std::min(rev_bytes.size(), header.revision.size()));
+
+    if (!file.WriteObject(header)) {
+        LOG_ERROR(Core, "Unable to write save state header to {}", path);
+        return false;
+    }
+
+    const auto write_section = [&file, &path](const std::string& name, const u8* data,
+                                              std::size_t size) {
+        ASSERT(name.size() < sizeof(SaveStateSectionHeader::name));
+
+        // The fastest level still shrinks the mostly empty memory a lot
+        std::string compressed;
+        CryptoPP::ArraySource(data, size, true,
+                              new CryptoPP::Deflator(new CryptoPP::StringSink(compressed), 1));
+
+        SaveStateSectionHeader section_header{};
+        std::copy(name.begin(), name.end(), section_header.name.begin());
+        section_header.size = size;
+        section_header.compressed_size = compressed.size();
+        if (!file.WriteObject(section_header) ||
+            file.WriteBytes(compressed.data(), compressed.size()) != compressed.size()) {
+            LOG_ERROR(Core, "Unable to write save state section {} to {}", name, path);
+            return false;
+        }
+        return true;
+    };
+
+    for (const SaveStateSection& section : sections) {
+        if (!write_section(section.name, section.data.data(), section.data.size())) {
+            return false;
+        }
+    }
+    for (const SaveStateBlock& block : blocks) {
+        if (!write_section(block.name, block.data, block.size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<std::vector<SaveStateSection>> ReadSaveState(const std::string& path,
+                                                           u64 program_id) {
+    FileUtil::IOFile file(path, "rb");
+    SaveStateHeader header;
+    if (!file.IsOpen() || !file.ReadArray(&header, 1)) {
+        LOG_ERROR(Core, "Unable to read save state {}", path);
+        return {};
+    }
+
+    if (header.filetype != SaveStateMagic) {
+        LOG_ERROR(Core, "{} is not a save state", path);
+        return {};
+    }
+    if (header.version != SaveStateVersion) {
+        LOG_ERROR(Core, "Save state {} has version {}, expected {}", path,
+                  static_cast<u32>(header.version), SaveStateVersion);
+        return {};
+    }
+    if (header.program_id != program_id) {
+        LOG_ERROR(Core, "Save state {} was made with program {:016X}, not {:016X}", path,
+                  static_cast<u64>(header.program_id), program_id);
+        return {};
+    }
+
+    const std::string revision = fmt::format("{:02x}", fmt::join(header.revision, ""));
+    if (revision != Common::g_scm_rev) {
+        LOG_WARNING(Core, "Save state {} was created on a different version of Citra", path);
+    }
+
+    std::vector<SaveStateSection> sections(header.section_count);
+    for (SaveStateSection& section : sections) {
+        SaveStateSectionHeader section_header;
+        if (!file.ReadArray(&section_header, 1)) {
+            LOG_ERROR(Core, "Save state {} is truncated", path);
+            return {};
+        }
+        section_header.name.back() = '\0';
+        section.name = section_header.name.data();
+
+        std::vector<u8> compressed(section_header.compressed_size);
+        if (file.ReadBytes(compressed.data(), compressed.size()) != compressed.size()) {
+            LOG_ERROR(Core, "Save state {} is truncated in section {}", path, section.name);
+            return {};
+        }
+
+        std::string data;
+        try {
+            CryptoPP::ArraySource(compressed.data(), compressed.size(), true,
+                                  new CryptoPP::Inflator(new CryptoPP::StringSink(data)));
+        } catch (const CryptoPP::Exception& e) {
+            LOG_ERROR(Core, "Corrupted section {} in save state {}: {}", section.name, path,
+                      e.what());
+            return {};
+        }
+        if (data.size() != section_header.size) {
+            LOG_ERROR(Core, "Section {} in save state {} has the wrong size", section.name, path);
+            return {};
+        }
+        section.data.assign(data.begin(), data.end());
+    }
+    return sections;
+}
+
+} // namespace Core
@@ -0,0 +1,135 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+
+/// Bumped whenever the layout of the file or of any section changes. Older states are refused.
+constexpr u32 SaveStateVersion = 5;
+
+/// State of one subsystem, stored in the subsystem's own layout
+struct SaveStateSection {
+    std::string name;
+    std::vector<u8> data;
+};
+
+/// Section whose data is written straight from memory owned by someone else, such as a snapshot
+struct SaveStateBlock {
+    std::string name;
+    const u8* data;
+    std::size_t size;
+};
+
+/// Appends plain values to the data of a section
+class StateWriter {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+        WriteBytes(&value, sizeof(T));
+    }
+
+    void WriteBytes(const void* source, std::size_t size) {
+        const std::size_t offset = data.size();
+        data.resize(offset + size);
+        std::memcpy(data.data() + offset, source, size);
+    }
+
+    void WriteString(const std::string& str) {
+        Write(static_cast<u32>(str.size()));
+        WriteBytes(str.data(), str.size());
+    }
+
+    template <typename T>
+    void WriteVector(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+        Write(static_cast<u32>(values.size()));
+        WriteBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    std::vector<u8> TakeData() {
+        return std::move(data);
+    }
+
+private:
+    std::vector<u8> data;
+};
+
+/// Reads back the values written by a StateWriter. Every read fails once the data runs out.
+class StateReader {
+public:
+    explicit StateReader(const std::vector<u8>& data) : data(data) {}
+
+    template <typename T>
+    bool Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+        return ReadBytes(&value, sizeof(T));
+    }
+
+    bool ReadBytes(void* dest, std::size_t size) {
+        if (data.size() - offset < size) {
+            return false;
+        }
+        std::memcpy(dest, data.data() + offset, size);
+        offset += size;
+        return true;
+    }
+
+    bool ReadString(std::string& str) {
+        u32 size;
+        if (!Read(size) || data.size() - offset < size) {
+            return false;
+        }
+        str.assign(reinterpret_cast<const char*>(data.data() + offset), size);
+        offset += size;
+        return true;
+    }
+
+    template <typename T>
+    bool ReadVector(std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+        u32 size;
+        if (!Read(size) || (data.size() - offset) / sizeof(T) < size) {
+            return false;
+        }
+        values.resize(size);
+        return ReadBytes(values.data(), size * sizeof(T));
+    }
+
+    bool AtEnd() const {
+        return offset == data.size();
+    }
+
+private:
+    const std::vector<u8>& data;
+    std::size_t offset = 0;
+};
+
+/**
+ * Writes a save state file. Every section is compressed with Deflate, so this is slow for the
+ * memory sections and should be called off the emulation thread. The blocks are written as
+ * sections after the other sections.
+ * @returns False if the file could not be written
+ */
+bool WriteSaveState(const std::string& path, u64 program_id,
+                    const std::vector<SaveStateSection>& sections,
+                    const std::vector<SaveStateBlock>& blocks = {});
+
+/**
+ * Reads a save state file written by WriteSaveState.
+ * @returns Nothing if the file is unreadable, of another version or of another program
+ */
+std::optional<std::vector<SaveStateSection>> ReadSaveState(const std::string& path,
+                                                           u64 program_id);
+
+} // namespace Core
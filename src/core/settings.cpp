@@ -70,6 +70,10 @@ void LogSettings() {
     LogSetting("Renderer_UseHwShader", Settings::values.use_hw_shader);
     LogSetting("Renderer_ShadersAccurateGs", Settings::values.shaders_accurate_gs);
     LogSetting("Renderer_ShadersAccurateMul", Settings::values.shaders_accurate_mul);
+    LogSetting("Renderer_UseDiskShaderCache", Settings::values.use_disk_shader_cache);
+    LogSetting("Renderer_UseAsyncShaderCompilation",
+               Settings::values.use_async_shader_compilation);
+    LogSetting("Renderer_SurfaceCacheBudget", Settings::values.surface_cache_budget);
     LogSetting("Renderer_UseShaderJit", Settings::values.use_shader_jit);
     LogSetting("Renderer_UseResolutionFactor", Settings::values.resolution_factor);
     LogSetting("Renderer_UseVsync", Settings::values.use_vsync);
@@ -93,6 +97,7 @@ void LogSettings() {
     LogSetting("Camera_OuterLeftConfig", Settings::values.camera_config[OuterLeftCamera]);
     LogSetting("Camera_OuterLeftFlip", Settings::values.camera_flip[OuterLeftCamera]);
     LogSetting("DataStorage_UseVirtualSd", Settings::values.use_virtual_sd);
+    LogSetting("DataStorage_UseBufferedSaveWrites", Settings::values.use_buffered_save_writes);
     LogSetting("System_IsNew3ds", Settings::values.is_new_3ds);
     LogSetting("System_RegionValue", Settings::values.region_value);
     LogSetting("Debugging_UseGdbstub", Settings::values.use_gdbstub);
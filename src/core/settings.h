@@ -110,6 +110,7 @@ struct Values {
 
     // Data Storage
     bool use_virtual_sd;
+    bool use_buffered_save_writes;
 
     // System
     int region_value;
@@ -121,6 +122,9 @@ struct Values {
     bool use_hw_shader;
     bool shaders_accurate_gs;
     bool shaders_accurate_mul;
+    bool use_disk_shader_cache;
+    bool use_async_shader_compilation;
+    u32 surface_cache_budget;
     bool use_shader_jit;
     u16 resolution_factor;
     bool use_vsync;
@@ -161,6 +165,9 @@ struct Values {
     bool use_gdbstub;
     u16 gdbstub_port;
     std::string log_filter;
+    bool log_binary;
+    std::string counters_dump_path;
+    u32 counters_dump_interval;
     std::unordered_map<std::string, bool> lle_modules;
 
     // WebService
@@ -0,0 +1,57 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
+#include "common/logging/filter.h"
+#include "common/logging/text_formatter.h"
+
+static void PrintHelp(const char* argv0) {
+    std::fprintf(stderr,
+                 "Usage: %s <log file> [filter]\n"
+                 "Converts a binary log written with log_binary enabled to text. The optional "
+                 "filter uses the syntax of log_filter, for example \"*:Info HW.GPU:Trace\".\n",
+                 argv0);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        PrintHelp(argv[0]);
+        return 1;
+    }
+
+    FileUtil::IOFile file(argv[1], "rb");
+    if (!file.IsOpen()) {
+        std::fprintf(stderr, "Could not open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+        std::fprintf(stderr, "Could not read %s\n", argv[1]);
+        return 1;
+    }
+
+    Log::Filter filter(Log::Level::Trace);
+    if (argc == 3) {
+        filter.ParseFilterString(argv[2]);
+    }
+
+    Log::BinaryLogReader reader(std::move(data));
+    if (!reader.IsValid()) {
+        std::fprintf(stderr, "%s is not a binary log\n", argv[1]);
+        return 1;
+    }
+
+    Log::Entry entry;
+    while (reader.Read(entry)) {
+        if (filter.CheckMessage(entry.log_class, entry.log_level)) {
+            std::fputs(Log::FormatLogMessage(entry).append(1, '\n').c_str(), stdout);
+        }
+    }
+    return 0;
+}
@@ -4,11 +4,13 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <iomanip>
 #include <mutex>
 #include <random>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
 #include "common/logging/log.h"
 #include "enet/enet.h"
 #include "network/packet.h"
@@ -40,13 +42,26 @@ public:
     mutable std::mutex member_mutex; ///< Mutex for locking the members list
     /// This should be a std::shared_mutex as soon as C++17 is supported
 
+    struct MacAddressHash {
+        std::size_t operator()(const MacAddress& address) const {
+            u64 value = 0;
+            std::memcpy(&value, address.data(), address.size());
+            return std::hash<u64>()(value);
+        }
+    };
+    /// The peers of the members by their MAC address, guarded by member_mutex as well
+    std::unordered_map<MacAddress, ENetPeer*, MacAddressHash> peers_by_mac;
+
     RoomImpl()
         : random_gen(std::random_device()()), NintendoOUI{0x00, 0x1F, 0x32, 0x00, 0x00, 0x00} {}
 
     /// Thread that receives and dispatches network packets
     std::unique_ptr<std::thread> room_thread;
 
-    /// Thread function that will receive and dispatch messages until the room is destroyed.
+    /**
+     * Thread function that will receive and dispatch messages until the room is destroyed.
+     * The packets sent while handling the messages received at once are flushed together.
+     */
     void ServerLoop();
     void StartLoop();
 
@@ -123,7 +138,8 @@ public:
     MacAddress GenerateMacAddress();
 
     /**
-     * Broadcasts this packet to all members except the sender.
+     * Forwards this packet to its destination, or to all members except the sender if it is a
+     * broadcast. The received packet is sent as is, without copying it.
      * @param event The ENet event containing the data
      */
     void HandleWifiPacket(const ENetEvent* event);
@@ -157,31 +173,38 @@ void Room::RoomImpl::ServerLoop() {
     while (state != State::Closed) {
         ENetEvent event;
         if (enet_host_service(server, &event, 50) > 0) {
-            switch (event.type) {
-            case ENET_EVENT_TYPE_RECEIVE:
-                switch (event.packet->data[0]) {
-                case IdJoinRequest:
-                    HandleJoinRequest(&event);
-                    break;
-                case IdSetGameInfo:
-                    HandleGameNamePacket(&event);
+            do {
+                switch (event.type) {
+                case ENET_EVENT_TYPE_RECEIVE:
+                    switch (event.packet->data[0]) {
+                    case IdJoinRequest:
+                        HandleJoinRequest(&event);
+                        break;
+                    case IdSetGameInfo:
+                        HandleGameNamePacket(&event);
+                        break;
+                    case IdWifiPacket:
+                        HandleWifiPacket(&event);
+                        break;
+                    case IdChatMessage:
+                        HandleChatPacket(&event);
+                        break;
+                    }
+                    // Forwarded packets are destroyed by ENet once they were sent to every peer
+                    if (event.packet->referenceCount == 0) {
+                        enet_packet_destroy(event.packet);
+                    }
                     break;
-                case IdWifiPacket:
-                    HandleWifiPacket(&event);
+                case ENET_EVENT_TYPE_DISCONNECT:
+                    HandleClientDisconnection(event.peer);
                     break;
-                case IdChatMessage:
-                    HandleChatPacket(&event);
+                case ENET_EVENT_TYPE_NONE:
+                case ENET_EVENT_TYPE_CONNECT:
                     break;
                 }
-                enet_packet_destroy(event.packet);
-                break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                HandleClientDisconnection(event.peer);
-                break;
-            case ENET_EVENT_TYPE_NONE:
-            case ENET_EVENT_TYPE_CONNECT:
-                break;
-            }
+                // Handle the other messages received by the same service call without waiting
+            } while (enet_host_check_events(server, &event) > 0);
+            enet_host_flush(server);
         }
     }
     // Close the connection to all members:
@@ -242,6 +265,7 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
 
     {
         std::lock_guard<std::mutex> lock(member_mutex);
+        peers_by_mac.emplace(member.mac_address, member.peer);
         members.push_back(std::move(member));
     }
 
@@ -261,8 +285,7 @@ bool Room::RoomImpl::IsValidNickname(const std::string& nickname) const {
 bool Room::RoomImpl::IsValidMacAddress(const MacAddress& address) const {
     // A MAC address is valid if it is not already taken by anybody else in the room.
     std::lock_guard<std::mutex> lock(member_mutex);
-    return std::all_of(members.begin(), members.end(),
-                       [&address](const auto& member) { return member.mac_address != address; });
+    return peers_by_mac.find(address) == peers_by_mac.end();
 }
 
 void Room::RoomImpl::SendNameCollision(ENetPeer* client) {
@@ -272,7 +295,6 @@ void Room::RoomImpl::SendNameCollision(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendMacCollision(ENetPeer* client) {
@@ -282,7 +304,6 @@ void Room::RoomImpl::SendMacCollision(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendWrongPassword(ENetPeer* client) {
@@ -292,7 +313,6 @@ void Room::RoomImpl::SendWrongPassword(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendVersionMismatch(ENetPeer* client) {
@@ -303,7 +323,6 @@ void Room::RoomImpl::SendVersionMismatch(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendJoinSuccess(ENetPeer* client, MacAddress mac_address) {
@@ -313,7 +332,6 @@ void Room::RoomImpl::SendJoinSuccess(ENetPeer* client, MacAddress mac_address) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendCloseMessage() {
@@ -356,7 +374,6 @@ void Room::RoomImpl::BroadcastRoomInformation() {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_host_broadcast(server, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 MacAddress Room::RoomImpl::GenerateMacAddress() {
@@ -372,51 +389,39 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
 }
 
 void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
-    in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
+    // Message type, WifiPacket type and channel, followed by the transmitter address
+    constexpr std::size_t DestinationOffset = 3 * sizeof(u8) + sizeof(MacAddress);
+    if (event->packet->dataLength < DestinationOffset + sizeof(MacAddress)) {
+        LOG_ERROR(Network, "Received a truncated WifiPacket");
+        return;
+    }
     MacAddress destination_address;
-    in_packet >> destination_address;
+    std::memcpy(destination_address.data(), event->packet->data + DestinationOffset,
+                destination_address.size());
 
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    // ENet keeps the packet alive while it is referenced by the peers it is sent to
+    ENetPacket* enet_packet = event->packet;
+    enet_packet->flags |= ENET_PACKET_FLAG_RELIABLE;
 
+    std::lock_guard<std::mutex> lock(member_mutex);
     if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
-        std::lock_guard<std::mutex> lock(member_mutex);
-        bool sent_packet = false;
         for (const auto& member : members) {
             if (member.peer != event->peer) {
-                sent_packet = true;
                 enet_peer_send(member.peer, 0, enet_packet);
             }
         }
-
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
-        }
     } else { // Send the data only to the destination client
-        std::lock_guard<std::mutex> lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(),
-                                   [destination_address](const Member& member) -> bool {
-                                       return member.mac_address == destination_address;
-                                   });
-        if (member != members.end()) {
-            enet_peer_send(member->peer, 0, enet_packet);
+        const auto peer = peers_by_mac.find(destination_address);
+        if (peer != peers_by_mac.end()) {
+            enet_peer_send(peer->second, 0, enet_packet);
         } else {
             LOG_ERROR(Network,
                       "Attempting to send to unknown MAC address: "
                       "{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}",
                       destination_address[0], destination_address[1], destination_address[2],
                       destination_address[3], destination_address[4], destination_address[5]);
-            enet_packet_destroy(enet_packet);
         }
     }
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
@@ -457,8 +462,6 @@ void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
     if (!sent_packet) {
         enet_packet_destroy(enet_packet);
     }
-
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::HandleGameNamePacket(const ENetEvent* event) {
@@ -487,10 +490,13 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
     // Remove the client from the members list.
     {
         std::lock_guard<std::mutex> lock(member_mutex);
-        members.erase(
-            std::remove_if(members.begin(), members.end(),
-                           [client](const Member& member) { return member.peer == client; }),
-            members.end());
+        const auto member =
+            std::find_if(members.begin(), members.end(),
+                         [client](const Member& member) { return member.peer == client; });
+        if (member != members.end()) {
+            peers_by_mac.erase(member->mac_address);
+            members.erase(member);
+        }
     }
 
     // Announce the change to all clients.
@@ -583,6 +589,7 @@ void Room::Destroy() {
     {
         std::lock_guard<std::mutex> lock(room_impl->member_mutex);
         room_impl->members.clear();
+        room_impl->peers_by_mac.clear();
     }
     room_impl->room_information.member_slots = 0;
     room_impl->room_information.name.clear();
@@ -0,0 +1,84 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
+
+namespace Log {
+
+namespace {
+
+Entry MakeEntry(const char* function, unsigned int line_num, std::string message) {
+    Entry entry;
+    entry.timestamp = std::chrono::microseconds(1234567 + line_num);
+    entry.log_class = Class::Service_GSP;
+    entry.log_level = Level::Warning;
+    entry.filename = "core/hle/service/gsp/gsp_gpu.cpp";
+    entry.line_num = line_num;
+    entry.function = function;
+    entry.message = std::move(message);
+    return entry;
+}
+
+void RequireEqual(const Entry& a, const Entry& b) {
+    REQUIRE(a.timestamp == b.timestamp);
+    REQUIRE(a.log_class == b.log_class);
+    REQUIRE(a.log_level == b.log_level);
+    REQUIRE(std::string(a.filename) == b.filename);
+    REQUIRE(a.line_num == b.line_num);
+    REQUIRE(std::string(a.function) == b.function);
+    REQUIRE(a.message == b.message);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("BinaryLog round trip", "[common][logging]") {
+    std::vector<Entry> entries;
+    entries.push_back(MakeEntry("WriteHWRegs", 100, "address 0x1EF00000, size 4"));
+    entries.push_back(MakeEntry("WriteHWRegs", 100, ""));
+    entries.push_back(MakeEntry("FlushDataCache", 300, std::string(300, 'x')));
+
+    std::vector<u8> data;
+    BinaryLogWriter::WriteHeader(data);
+    BinaryLogWriter writer;
+    for (const auto& entry : entries) {
+        writer.Write(entry, data);
+    }
+
+    BinaryLogReader reader(data);
+    REQUIRE(reader.IsValid());
+    for (const auto& expected : entries) {
+        Entry entry;
+        REQUIRE(reader.Read(entry));
+        RequireEqual(entry, expected);
+    }
+    Entry entry;
+    REQUIRE(!reader.Read(entry));
+
+    SECTION("source locations are only stored once") {
+        std::vector<u8> repeated_data;
+        writer.Write(entries[0], repeated_data);
+        REQUIRE(repeated_data.size() < entries[0].message.size() + 16);
+    }
+
+    SECTION("truncated logs stop at the last complete entry") {
+        data.pop_back();
+        BinaryLogReader truncated_reader(data);
+        REQUIRE(truncated_reader.Read(entry));
+        REQUIRE(truncated_reader.Read(entry));
+        REQUIRE(!truncated_reader.Read(entry));
+    }
+}
+
+TEST_CASE("BinaryLog rejects other files", "[common][logging]") {
+    BinaryLogReader reader({'[', ' ', ' ', ' ', '0', '.'});
+    REQUIRE(!reader.IsValid());
+    Entry entry;
+    REQUIRE(!reader.Read(entry));
+}
+
+} // namespace Log
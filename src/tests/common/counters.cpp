@@ -0,0 +1,83 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/counters.h"
+
+namespace Common::Counters {
+
+namespace {
+
+u64 GetValue(const std::string& name, const Labels& labels = {}) {
+    const std::vector<Sample> samples = Snapshot();
+    const auto it = std::find_if(samples.begin(), samples.end(), [&](const Sample& sample) {
+        return sample.name == name && sample.labels == labels;
+    });
+    REQUIRE(it != samples.end());
+    return it->value;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Counters sum the counts of all threads", "[common][counters]") {
+    const Counter counter = Register("test_threads_total", "Counted from several threads");
+    counter.Add(5);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([counter] {
+            for (int j = 0; j < 10000; ++j) {
+                counter.Add();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // The blocks of the exited threads are reused, without losing their counts
+    std::thread([counter] { counter.Add(3); }).join();
+
+    REQUIRE(GetValue("test_threads_total") == 40008);
+}
+
+TEST_CASE("Counters registered twice are shared", "[common][counters]") {
+    const Counter a = Register("test_shared_total", "Help", {{"service", "fs:USER"}});
+    const Counter b = Register("test_shared_total", "Other help", {{"service", "fs:USER"}});
+    const Counter c = Register("test_shared_total", "Other help", {{"service", "srv:"}});
+    a.Add(2);
+    b.Add(3);
+    c.Add(7);
+
+    REQUIRE(GetValue("test_shared_total", {{"service", "fs:USER"}}) == 5);
+    REQUIRE(GetValue("test_shared_total", {{"service", "srv:"}}) == 7);
+}
+
+TEST_CASE("Counters are formatted for Prometheus and as JSON", "[common][counters]") {
+    const std::vector<Sample> samples{
+        {"test_calls_total", "Calls \\ by service", {{"service", "a\"b"}}, 12},
+        {"test_calls_total", "Calls \\ by service", {{"service", "c"}}, 3},
+        {"test_draws_total", "Draws", {}, 42},
+    };
+
+    REQUIRE(FormatPrometheus(samples) == "# HELP test_calls_total Calls \\\\ by service\n"
+                                         "# TYPE test_calls_total counter\n"
+                                         "test_calls_total{service=\"a\\\"b\"} 12\n"
+                                         "test_calls_total{service=\"c\"} 3\n"
+                                         "# HELP test_draws_total Draws\n"
+                                         "# TYPE test_draws_total counter\n"
+                                         "test_draws_total 42\n");
+
+    const std::string json = FormatJson(samples);
+    REQUIRE(json.find("\"counters\":[{\"name\":\"test_calls_total\","
+                      "\"labels\":{\"service\":\"a\\\"b\"},\"value\":12},") != std::string::npos);
+    REQUIRE(json.find("{\"name\":\"test_draws_total\",\"labels\":{},\"value\":42}]}") !=
+            std::string::npos);
+}
+
+} // namespace Common::Counters
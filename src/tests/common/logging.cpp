@@ -0,0 +1,98 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/logging/backend.h"
+#include "common/logging/filter.h"
+#include "common/logging/log.h"
+
+namespace Log {
+
+namespace {
+
+/// Backend keeping the messages written to it
+class RecordingBackend : public Backend {
+public:
+    static const char* Name() {
+        return "test";
+    }
+
+    const char* GetName() const override {
+        return Name();
+    }
+
+    void Write(const Entry& entry) override {
+        std::lock_guard lock(mutex);
+        messages.push_back(entry.message);
+    }
+
+    bool HasMessage(const std::string& message) {
+        std::lock_guard lock(mutex);
+        return std::find(messages.begin(), messages.end(), message) != messages.end();
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::string> messages;
+};
+
+/// Adds a RecordingBackend for the duration of a test
+class ScopedRecordingBackend {
+public:
+    ScopedRecordingBackend() {
+        SetGlobalFilter(Filter(Level::Info));
+        auto owned_backend = std::make_unique<RecordingBackend>();
+        backend = owned_backend.get();
+        AddBackend(std::move(owned_backend));
+    }
+
+    ~ScopedRecordingBackend() {
+        RemoveBackend(RecordingBackend::Name());
+    }
+
+    RecordingBackend& operator*() {
+        return *backend;
+    }
+
+private:
+    RecordingBackend* backend;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("Logging writes deferred messages", "[common][logging]") {
+    ScopedRecordingBackend backend;
+
+    LOG_INFO(Common, "deferred {} {}", 1, 2.5);
+
+    // Written by the logging thread once it checks the rings
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!(*backend).HasMessage("deferred 1 2.5") &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE((*backend).HasMessage("deferred 1 2.5"));
+}
+
+TEST_CASE("Logging writes errors before returning", "[common][logging]") {
+    ScopedRecordingBackend backend;
+
+    LOG_INFO(Common, "before critical {}", 1);
+    LOG_CRITICAL(Common, "critical {}", 2);
+    // Both are visible without waiting for the logging thread
+    REQUIRE((*backend).HasMessage("before critical 1"));
+    REQUIRE((*backend).HasMessage("critical 2"));
+
+    LOG_ERROR(Common, "error {}", std::string("with string"));
+    REQUIRE((*backend).HasMessage("error with string"));
+}
+
+} // namespace Log
@@ -0,0 +1,97 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <thread>
+#include <catch2/catch.hpp>
+#include "common/memory_snapshot.h"
+
+namespace Common {
+
+namespace {
+
+constexpr std::size_t ChunkCount = 64;
+constexpr std::size_t BlockSize = ChunkCount * CopyOnWriteSnapshot::ChunkSize;
+
+/// Fills every chunk with its index
+void FillChunks(PagedMemory& memory) {
+    for (std::size_t i = 0; i < BlockSize; ++i) {
+        memory.get()[i] = static_cast<u8>(i / CopyOnWriteSnapshot::ChunkSize);
+    }
+}
+
+bool HasChunkIndices(const u8* data) {
+    for (std::size_t i = 0; i < BlockSize; ++i) {
+        if (data[i] != static_cast<u8>(i / CopyOnWriteSnapshot::ChunkSize)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("PagedMemory is zeroed", "[common]") {
+    PagedMemory memory(BlockSize);
+    for (std::size_t i = 0; i < BlockSize; i += 0x1000) {
+        REQUIRE(memory.get()[i] == 0);
+    }
+}
+
+TEST_CASE("CopyOnWriteSnapshot copies the block as it was when it started", "[common]") {
+    PagedMemory memory(BlockSize);
+    FillChunks(memory);
+
+    SECTION("with writes before Finish") {
+        CopyOnWriteSnapshot snapshot(memory);
+        // Both ends of a chunk, and a chunk written twice
+        memory.get()[0] = 0xFF;
+        memory.get()[CopyOnWriteSnapshot::ChunkSize - 1] = 0xFF;
+        memory.get()[5 * CopyOnWriteSnapshot::ChunkSize + 3] = 0xFF;
+        memory.get()[5 * CopyOnWriteSnapshot::ChunkSize + 4] = 0xFF;
+        memory.get()[BlockSize - 1] = 0xFF;
+
+        REQUIRE(HasChunkIndices(snapshot.Finish()));
+        REQUIRE(memory.get()[0] == 0xFF);
+        REQUIRE(memory.get()[5 * CopyOnWriteSnapshot::ChunkSize + 4] == 0xFF);
+        REQUIRE(memory.get()[BlockSize - 1] == 0xFF);
+
+        // The block is writable again
+        memory.get()[1] = 0xFF;
+        REQUIRE(memory.get()[1] == 0xFF);
+    }
+
+    SECTION("with a thread writing while Finish copies") {
+        CopyOnWriteSnapshot snapshot(memory);
+        std::atomic<bool> started{false};
+        std::thread writer([&memory, &started] {
+            started = true;
+            for (std::size_t i = BlockSize; i-- > 0;) {
+                memory.get()[i] = 0xFF;
+            }
+        });
+        while (!started) {
+        }
+
+        REQUIRE(HasChunkIndices(snapshot.Finish()));
+        writer.join();
+        for (std::size_t i = 0; i < BlockSize; ++i) {
+            REQUIRE(memory.get()[i] == 0xFF);
+        }
+    }
+
+    SECTION("with two blocks at once") {
+        PagedMemory other(BlockSize);
+        FillChunks(other);
+        CopyOnWriteSnapshot snapshot(memory);
+        CopyOnWriteSnapshot other_snapshot(other);
+        other.get()[7] = 0xFF;
+        memory.get()[7] = 0xFF;
+
+        REQUIRE(HasChunkIndices(other_snapshot.Finish()));
+        REQUIRE(HasChunkIndices(snapshot.Finish()));
+    }
+}
+
+} // namespace Common
@@ -10,6 +10,7 @@
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/savestate.h"
 
 // Numbers are chosen randomly to make sure the correct one is given.
 static constexpr std::array<u64, 5> CB_IDS{{42, 144, 93, 1026, UINT64_C(0xFFFF7FFFF7FFFF)}};
@@ -226,3 +227,38 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(0 == reschedules);
     REQUIRE(MAX_SLICE_LENGTH == timing.GetDowncount());
 }
+
+TEST_CASE("CoreTiming[SaveState]", "[core]") {
+    Core::Timing timing;
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+
+    // Enter slice 0
+    timing.Advance();
+
+    timing.ScheduleEvent(500, cb_a, CB_IDS[0]);
+    timing.ScheduleEvent(1000, cb_b, CB_IDS[1]);
+
+    Core::StateWriter writer;
+    timing.SaveState(writer);
+    const std::vector<u8> state = writer.TakeData();
+
+    AdvanceAndCheck(timing, 0, 500);
+    AdvanceAndCheck(timing, 1, MAX_SLICE_LENGTH);
+
+    // The events run again, at the same times, after loading the state
+    Core::StateReader reader(state);
+    REQUIRE(timing.LoadState(reader));
+    REQUIRE(reader.AtEnd());
+    REQUIRE(500 == timing.GetDowncount());
+    AdvanceAndCheck(timing, 0, 500);
+    AdvanceAndCheck(timing, 1, MAX_SLICE_LENGTH);
+    REQUIRE(1000 == timing.GetTicks());
+
+    // Types unknown to the loading side are rejected
+    Core::Timing other_timing;
+    other_timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::StateReader other_reader(state);
+    REQUIRE_FALSE(other_timing.LoadState(other_reader));
+}
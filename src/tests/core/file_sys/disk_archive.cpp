@@ -0,0 +1,142 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <catch2/catch.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/disk_archive.h"
+#include "core/file_sys/errors.h"
+#include "core/settings.h"
+
+namespace FileSys {
+
+namespace {
+
+std::unique_ptr<FileBackend> Open(const std::string& path, bool write) {
+    FileUtil::IOFile file(path, write ? "r+b" : "rb");
+    REQUIRE(file.IsOpen());
+    Mode mode{};
+    mode.read_flag.Assign(1);
+    mode.write_flag.Assign(write ? 1 : 0);
+    return OpenDiskFile(std::move(file), path, mode, nullptr);
+}
+
+std::string Read(const FileBackend& file) {
+    std::string content(static_cast<std::size_t>(file.GetSize()), '\0');
+    const auto read = file.Read(0, content.size(), reinterpret_cast<u8*>(content.data()));
+    REQUIRE(read.Succeeded());
+    REQUIRE(*read == content.size());
+    return content;
+}
+
+void Write(FileBackend& file, const std::string& content) {
+    const auto written =
+        file.Write(0, content.size(), false, reinterpret_cast<const u8*>(content.data()));
+    REQUIRE(written.Succeeded());
+    REQUIRE(*written == content.size());
+}
+
+std::string ReadHostFile(const std::string& path) {
+    std::string content;
+    REQUIRE(FileUtil::ReadFileToString(true, path.c_str(), content) == FileUtil::GetSize(path));
+    return content;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("BufferedDiskFile", "[core][file_sys]") {
+    Settings::values.use_buffered_save_writes = true;
+    const std::string test_dir = "./test_buffered";
+    const std::string path = test_dir + "/file";
+    FileUtil::DeleteDirRecursively(test_dir);
+    FileUtil::CreateDir(test_dir);
+    FileUtil::WriteStringToFile(true, "old", path.c_str());
+
+    SECTION("reads back pending writes, also through files opened before") {
+        auto reader = Open(path, false);
+        auto writer = Open(path, true);
+        Write(*writer, "new");
+        REQUIRE(Read(*writer) == "new");
+        REQUIRE(Read(*reader) == "new");
+        REQUIRE(ReadHostFile(path) == "old");
+
+        writer->Close();
+        CommitClosedDiskFiles();
+        REQUIRE(ReadHostFile(path) == "new");
+
+        // The staging file isn't left in the archive
+        FileUtil::FSTEntry entry{};
+        REQUIRE(FileUtil::ScanDirectoryTree(test_dir, entry) == 1);
+    }
+
+    SECTION("drops pending writes of deleted files") {
+        auto writer = Open(path, true);
+        Write(*writer, "new");
+        REQUIRE(DeleteDiskFile(path));
+        REQUIRE(!FileUtil::Exists(path));
+
+        // The open file keeps its content, but doesn't bring the host file back
+        REQUIRE(Read(*writer) == "new");
+        writer->Close();
+        writer.reset();
+        CommitClosedDiskFiles();
+        REQUIRE(!FileUtil::Exists(path));
+    }
+
+    SECTION("moves pending writes along with renamed files") {
+        const std::string new_path = test_dir + "/renamed";
+        auto writer = Open(path, true);
+        Write(*writer, "new");
+        REQUIRE(RenameDiskPath(path, new_path));
+        REQUIRE(!FileUtil::Exists(path));
+        REQUIRE(ReadHostFile(new_path) == "new");
+
+        Write(*writer, "abc");
+        writer->Close();
+        writer.reset();
+        CommitClosedDiskFiles();
+        REQUIRE(!FileUtil::Exists(path));
+        REQUIRE(ReadHostFile(new_path) == "abc");
+    }
+
+    SECTION("writes through once the file outgrows the buffer") {
+        auto reader = Open(path, false);
+        auto writer = Open(path, true);
+        Write(*writer, "new");
+        // Just past the 16 MiB that are buffered at most
+        const u64 offset = 17 * 1024 * 1024;
+        const auto written = writer->Write(offset, 3, true, reinterpret_cast<const u8*>("end"));
+        REQUIRE(written.Succeeded());
+        REQUIRE(*written == 3);
+        REQUIRE(FileUtil::GetSize(path) == offset + 3);
+
+        std::string content(3, '\0');
+        REQUIRE(*reader->Read(offset, 3, reinterpret_cast<u8*>(content.data())) == 3);
+        REQUIRE(content == "end");
+        REQUIRE(*reader->Read(0, 3, reinterpret_cast<u8*>(content.data())) == 3);
+        REQUIRE(content == "new");
+        REQUIRE(reader->GetSize() == offset + 3);
+
+        REQUIRE(writer->SetSize(3));
+        writer->Close();
+        REQUIRE(ReadHostFile(path) == "new");
+    }
+
+    SECTION("refuses to grow deleted files past the buffer") {
+        auto writer = Open(path, true);
+        REQUIRE(DeleteDiskFile(path));
+        const u64 offset = 17 * 1024 * 1024;
+        REQUIRE(writer->Write(offset, 3, false, reinterpret_cast<const u8*>("end")).Code() ==
+                ERROR_INSUFFICIENT_SPACE);
+        REQUIRE(!writer->SetSize(offset));
+        REQUIRE(!FileUtil::Exists(path));
+    }
+
+    // Deleted as archives do, the buffers of closed files may still be waiting for their commit
+    DeleteDiskDirectoryRecursively(test_dir);
+    Settings::values.use_buffered_save_writes = false;
+}
+
+} // namespace FileSys
@@ -0,0 +1,216 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <httplib.h>
+#include "core/hle/service/http_engine.h"
+
+namespace Service::HTTP {
+
+namespace {
+
+/// HTTP server on loopback standing in for the servers titles talk to
+class TestServer {
+public:
+    TestServer() {
+        server.Get("/data", [](const httplib::Request& request, httplib::Response& response) {
+            response.set_header("X-Test", "value");
+            response.set_content(std::string(100000, 'x'), "application/octet-stream");
+        });
+        server.Post("/echo", [](const httplib::Request& request, httplib::Response& response) {
+            response.status = 201;
+            response.set_content(request.get_header_value("Content-Type") + ";" + request.body,
+                                 "text/plain");
+        });
+        // Accepts the request, but doesn't respond until the server is destroyed
+        server.Get("/stall", [this](const httplib::Request& request, httplib::Response& response) {
+            std::unique_lock lock(stall_mutex);
+            stall_released.wait(lock, [this] { return released; });
+        });
+        port = server.bind_to_any_port("127.0.0.1");
+        REQUIRE(port > 0);
+        thread = std::thread([this] { server.listen_after_bind(); });
+    }
+
+    ~TestServer() {
+        {
+            std::lock_guard lock(stall_mutex);
+            released = true;
+        }
+        stall_released.notify_all();
+        // The server may not be listening yet
+        while (!server.is_running()) {
+            std::this_thread::yield();
+        }
+        server.stop();
+        thread.join();
+    }
+
+    std::string Url(const std::string& path) const {
+        return "http://127.0.0.1:" + std::to_string(port) + path;
+    }
+
+private:
+    httplib::Server server;
+    int port;
+    std::thread thread;
+    std::mutex stall_mutex;
+    std::condition_variable stall_released;
+    bool released = false;
+};
+
+/// Collects the updates of a transfer, the way HTTP_C does on the emulation thread
+class UpdateWaiter {
+public:
+    std::function<void()> Callback() {
+        return [this] {
+            std::lock_guard lock(mutex);
+            ++update_count;
+            updated.notify_all();
+        };
+    }
+
+    /// Waits until the transfer is done, returning whether it finished in time
+    bool WaitUntilDone(Transfer& transfer) {
+        std::unique_lock lock(mutex);
+        return updated.wait_for(lock, std::chrono::seconds(10), [&transfer] {
+            // Cleared first, as the handler in HTTP_C does
+            transfer.update_pending = false;
+            std::lock_guard transfer_lock(transfer.mutex);
+            return transfer.IsDone();
+        });
+    }
+
+    /// Waits until a worker took the transfer
+    bool WaitUntilStarted(Transfer& transfer) {
+        std::unique_lock lock(mutex);
+        return updated.wait_for(lock, std::chrono::seconds(10), [&transfer] {
+            transfer.update_pending = false;
+            std::lock_guard transfer_lock(transfer.mutex);
+            return transfer.stage != Transfer::Stage::Queued;
+        });
+    }
+
+    int UpdateCount() {
+        std::lock_guard lock(mutex);
+        return update_count;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable updated;
+    int update_count = 0;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("RequestEngine[Get]", "[service]") {
+    TestServer server;
+    RequestEngine engine;
+    UpdateWaiter waiter;
+
+    auto transfer = engine.Start({"GET", server.Url("/data"), {}, {}}, waiter.Callback());
+    REQUIRE(waiter.WaitUntilDone(*transfer));
+
+    std::lock_guard lock(transfer->mutex);
+    REQUIRE(transfer->stage == Transfer::Stage::Finished);
+    REQUIRE(transfer->status_code == 200);
+    REQUIRE(transfer->content_length == 100000);
+    REQUIRE(transfer->body == std::string(100000, 'x'));
+    bool found_header = false;
+    for (const auto& [name, value] : transfer->headers) {
+        found_header |= name == "X-Test" && value == "value";
+    }
+    REQUIRE(found_header);
+    REQUIRE(waiter.UpdateCount() >= 2);
+}
+
+TEST_CASE("RequestEngine[Post]", "[service]") {
+    TestServer server;
+    RequestEngine engine;
+    UpdateWaiter waiter;
+
+    auto transfer = engine.Start(
+        {"POST", server.Url("/echo"), {{"Content-Type", "text/plain"}}, "posted"},
+        waiter.Callback());
+    REQUIRE(waiter.WaitUntilDone(*transfer));
+
+    std::lock_guard lock(transfer->mutex);
+    REQUIRE(transfer->stage == Transfer::Stage::Finished);
+    REQUIRE(transfer->status_code == 201);
+    REQUIRE(transfer->body == "text/plain;posted");
+}
+
+TEST_CASE("RequestEngine[ConnectionLimit]", "[service]") {
+    TestServer server;
+    // Requests to the same host run one after the other on a reused client
+    RequestEngine engine(4, 1);
+    UpdateWaiter waiter;
+
+    std::vector<std::shared_ptr<Transfer>> transfers;
+    for (int i = 0; i < 4; ++i) {
+        transfers.push_back(engine.Start({"GET", server.Url("/data"), {}, {}}, waiter.Callback()));
+    }
+    for (const auto& transfer : transfers) {
+        REQUIRE(waiter.WaitUntilDone(*transfer));
+        std::lock_guard lock(transfer->mutex);
+        REQUIRE(transfer->stage == Transfer::Stage::Finished);
+        REQUIRE(transfer->body.size() == 100000);
+    }
+}
+
+TEST_CASE("RequestEngine[StalledServer]", "[service]") {
+    TestServer server;
+    UpdateWaiter waiter;
+
+    SECTION("times out") {
+        RequestEngine engine(4, 2, 1);
+        auto transfer = engine.Start({"GET", server.Url("/stall"), {}, {}}, waiter.Callback());
+        REQUIRE(waiter.WaitUntilDone(*transfer));
+        std::lock_guard lock(transfer->mutex);
+        REQUIRE(transfer->stage == Transfer::Stage::Failed);
+    }
+
+    SECTION("is aborted by Cancel") {
+        RequestEngine engine;
+        auto transfer = engine.Start({"GET", server.Url("/stall"), {}, {}}, waiter.Callback());
+        REQUIRE(waiter.WaitUntilStarted(*transfer));
+        engine.Cancel(*transfer);
+        // Well before the 30 second timeout
+        REQUIRE(waiter.WaitUntilDone(*transfer));
+        std::lock_guard lock(transfer->mutex);
+        REQUIRE(transfer->stage == Transfer::Stage::Failed);
+    }
+
+    SECTION("doesn't block the destruction of the engine") {
+        const auto start = std::chrono::steady_clock::now();
+        {
+            RequestEngine engine;
+            auto transfer =
+                engine.Start({"GET", server.Url("/stall"), {}, {}}, waiter.Callback());
+            REQUIRE(waiter.WaitUntilStarted(*transfer));
+        }
+        REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+    }
+}
+
+TEST_CASE("RequestEngine[UnsupportedUrl]", "[service]") {
+    RequestEngine engine;
+    UpdateWaiter waiter;
+
+    auto transfer = engine.Start({"GET", "https://127.0.0.1/", {}, {}}, waiter.Callback());
+    // Fails before Start returns
+    REQUIRE(waiter.UpdateCount() == 1);
+    std::lock_guard lock(transfer->mutex);
+    REQUIRE(transfer->stage == Transfer::Stage::Failed);
+}
+
+} // namespace Service::HTTP
@@ -0,0 +1,211 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <catch2/catch.hpp>
+#include "core/hle/service/soc_reactor.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define closesocket_(x) closesocket(x)
+#else
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define closesocket_(x) close(x)
+#endif
+
+namespace Service::SOC {
+
+namespace {
+
+/// UDP echo server on loopback, answering every datagram with the same data
+class EchoServer {
+public:
+    EchoServer() {
+        server_socket = static_cast<u32>(::socket(AF_INET, SOCK_DGRAM, 0));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addr_len = sizeof(addr);
+        REQUIRE(::bind(server_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+        REQUIRE(::getsockname(server_socket, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0);
+        address = addr;
+
+        thread = std::thread([this] {
+            char buffer[256];
+            sockaddr_in peer;
+            socklen_t peer_len = sizeof(peer);
+            const int received = ::recvfrom(server_socket, buffer, sizeof(buffer), 0,
+                                            reinterpret_cast<sockaddr*>(&peer), &peer_len);
+            if (received > 0) {
+                ::sendto(server_socket, buffer, received, 0, reinterpret_cast<sockaddr*>(&peer),
+                         peer_len);
+            }
+        });
+    }
+
+    ~EchoServer() {
+        // Lets the server exit if it still waits for a datagram
+        const u32 client = Connect();
+        ::send(client, "", 1, 0);
+        closesocket_(client);
+
+        thread.join();
+        closesocket_(server_socket);
+    }
+
+    /// Returns a UDP socket connected to the server
+    u32 Connect() const {
+        const auto client = static_cast<u32>(::socket(AF_INET, SOCK_DGRAM, 0));
+        REQUIRE(::connect(client, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) ==
+                0);
+        return client;
+    }
+
+private:
+    u32 server_socket;
+    sockaddr_in address;
+    std::thread thread;
+};
+
+struct SocketLibrary {
+#ifdef _WIN32
+    SocketLibrary() {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+    }
+    ~SocketLibrary() {
+        WSACleanup();
+    }
+#endif
+};
+
+/// Submits an operation and returns a future that is set once it completed
+std::future<void> Submit(SocketReactor& reactor, std::shared_ptr<SocketOperation> operation) {
+    auto promise = std::make_shared<std::promise<void>>();
+    operation->on_complete = [promise](SocketOperation&) { promise->set_value(); };
+    reactor.Submit(std::move(operation));
+    return promise->get_future();
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SocketReactor receives from a loopback echo server", "[core][soc]") {
+    SocketLibrary library;
+    EchoServer server;
+    SocketReactor reactor;
+    const u32 client = server.Connect();
+
+    auto operation = std::make_shared<SocketOperation>();
+    operation->type = SocketOperation::Type::RecvFrom;
+    operation->sockets = {{client, POLLIN}};
+    operation->length = 64;
+    REQUIRE_FALSE(SocketReactor::IsReady(*operation));
+
+    std::future<void> done = Submit(reactor, operation);
+    REQUIRE(done.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+
+    // The reply arrives while the reactor waits
+    REQUIRE(::send(client, "ping", 4, 0) == 4);
+    REQUIRE(done.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(operation->result == 4);
+    REQUIRE(std::string(operation->data.begin(), operation->data.end()) == "ping");
+
+    closesocket_(client);
+}
+
+TEST_CASE("SocketReactor times out polls and cancels closed sockets", "[core][soc]") {
+    SocketLibrary library;
+    EchoServer server;
+    SocketReactor reactor;
+    const u32 client = server.Connect();
+
+    auto poll = std::make_shared<SocketOperation>();
+    poll->type = SocketOperation::Type::Poll;
+    poll->sockets = {{client, POLLIN}};
+    poll->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+    std::future<void> poll_done = Submit(reactor, poll);
+    REQUIRE(poll_done.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(poll->result == 0);
+    REQUIRE(std::chrono::steady_clock::now() >= *poll->deadline);
+
+    auto receive = std::make_shared<SocketOperation>();
+    receive->type = SocketOperation::Type::RecvFrom;
+    receive->sockets = {{client, POLLIN}};
+    receive->length = 64;
+    std::future<void> receive_done = Submit(reactor, receive);
+
+    // A poll without deadline doesn't keep watching the descriptor, which the host may reuse
+    const u32 other = server.Connect();
+    auto waiting_poll = std::make_shared<SocketOperation>();
+    waiting_poll->type = SocketOperation::Type::Poll;
+    waiting_poll->sockets = {{other, POLLIN}, {client, POLLIN}};
+    std::future<void> waiting_poll_done = Submit(reactor, waiting_poll);
+
+    reactor.CancelSocket(client);
+    REQUIRE(receive_done.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(receive->result == -1);
+    REQUIRE(receive->data.empty());
+    REQUIRE(waiting_poll_done.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(waiting_poll->result == 1);
+    REQUIRE(waiting_poll->sockets[0].revents == 0);
+    REQUIRE(waiting_poll->sockets[1].revents == POLLNVAL);
+
+    closesocket_(other);
+
+    closesocket_(client);
+}
+
+TEST_CASE("SocketReactor does not block when two readers share a socket", "[core][soc]") {
+    SocketLibrary library;
+    EchoServer server;
+    SocketReactor reactor;
+    const u32 client = server.Connect();
+
+    const auto make_receive = [client] {
+        auto receive = std::make_shared<SocketOperation>();
+        receive->type = SocketOperation::Type::RecvFrom;
+        receive->sockets = {{client, POLLIN}};
+        receive->length = 64;
+        return receive;
+    };
+    auto first = make_receive();
+    auto second = make_receive();
+    std::future<void> first_done = Submit(reactor, first);
+    std::future<void> second_done = Submit(reactor, second);
+
+    // Both readers are woken by the single echoed datagram, only one of them gets it
+    REQUIRE(::send(client, "ping", 4, 0) == 4);
+    const auto first_ready = first_done.wait_for(std::chrono::seconds(5));
+    const auto second_ready = second_done.wait_for(std::chrono::milliseconds(100));
+    REQUIRE((first_ready == std::future_status::ready) !=
+            (second_ready == std::future_status::ready));
+
+    // The reactor still takes new operations
+    auto poll = std::make_shared<SocketOperation>();
+    poll->type = SocketOperation::Type::Poll;
+    poll->sockets = {{client, POLLIN}};
+    poll->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+    std::future<void> poll_done = Submit(reactor, poll);
+    REQUIRE(poll_done.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+
+    // And the reader left waiting can be cancelled
+    reactor.CancelSocket(client);
+    REQUIRE(first_done.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(second_done.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    const bool first_received = first_ready == std::future_status::ready;
+    REQUIRE((first_received ? first : second)->result == 4);
+    REQUIRE((first_received ? second : first)->result == -1);
+
+    closesocket_(client);
+}
+
+} // namespace Service::SOC
@@ -2,14 +2,130 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
 #include <catch2/catch.hpp>
+#include <fmt/format.h>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/gdbstub/gdbstub.h"
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/shared_page.h"
 #include "core/memory.h"
 
+namespace {
+
+/// Away from the default gdbstub port, so that the test does not collide with a running stub
+constexpr u16 TestGdbPort = 24689 + 100;
+
+/// Minimal gdb client talking to the stub over loopback
+class GdbClient {
+public:
+    GdbClient() {
+#ifdef _WIN32
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(TestGdbPort);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        // The stub may not be listening yet
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::chrono::steady_clock::now() < deadline) {
+            socket_fd = static_cast<int>(socket(PF_INET, SOCK_STREAM, 0));
+            if (connect(socket_fd, reinterpret_cast<const sockaddr*>(&address),
+                        sizeof(address)) == 0) {
+                return;
+            }
+            Close();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    ~GdbClient() {
+        Close();
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    bool IsConnected() const {
+        return socket_fd != -1;
+    }
+
+    void Send(const std::string& payload) {
+        u8 checksum = 0;
+        for (const char c : payload) {
+            checksum += static_cast<u8>(c);
+        }
+        const std::string packet = fmt::format("${}#{:02x}", payload, checksum);
+        REQUIRE(send(socket_fd, packet.data(), static_cast<int>(packet.size()), 0) ==
+                static_cast<int>(packet.size()));
+    }
+
+    /// Lets the stub handle the packets sent to it until it replies, and returns the reply
+    std::string Receive() {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::chrono::steady_clock::now() < deadline) {
+            const std::size_t begin = received.find('$');
+            const std::size_t end = received.find('#', begin);
+            if (begin != std::string::npos && end != std::string::npos &&
+                end + 2 < received.size()) {
+                const std::string payload = received.substr(begin + 1, end - begin - 1);
+                received.erase(0, end + 3);
+                return payload;
+            }
+
+            GDBStub::HandlePacket();
+
+            fd_set fds;
+            FD_ZERO(&fds);
+            FD_SET(socket_fd, &fds);
+            timeval timeout{0, 1000};
+            if (select(socket_fd + 1, &fds, nullptr, nullptr, &timeout) > 0) {
+                char buffer[256];
+                const int size = recv(socket_fd, buffer, sizeof(buffer), 0);
+                REQUIRE(size > 0);
+                received.append(buffer, size);
+            }
+        }
+        FAIL("The gdbstub did not reply");
+        return {};
+    }
+
+private:
+    void Close() {
+        if (socket_fd == -1) {
+            return;
+        }
+#ifdef _WIN32
+        closesocket(socket_fd);
+#else
+        close(socket_fd);
+#endif
+        socket_fd = -1;
+    }
+
+    int socket_fd = -1;
+    std::string received;
+};
+
+} // Anonymous namespace
+
 TEST_CASE("Memory::IsValidVirtualAddress", "[core][memory]") {
     // HACK: see comments of member timing
     Core::System::GetInstance().timing = std::make_unique<Core::Timing>();
@@ -55,3 +171,130 @@ TEST_CASE("Memory::IsValidVirtualAddress", "[core][memory]") {
         CHECK(Memory::IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+TEST_CASE("Memory::MemorySystem::WatchRegion", "[core][memory]") {
+    // HACK: see comments of member timing
+    Core::System::GetInstance().timing = std::make_unique<Core::Timing>();
+    Core::System::GetInstance().memory = std::make_unique<Memory::MemorySystem>();
+    Memory::MemorySystem& memory = *Core::System::GetInstance().memory;
+    Kernel::KernelSystem kernel(memory, 0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.MapSharedPages(process->vm_manager);
+    Memory::PageTable& page_table = process->vm_manager.page_table;
+    const std::size_t page = Memory::SHARED_PAGE_VADDR >> Memory::PAGE_BITS;
+
+    SECTION("watched pages keep their contents") {
+        const u32 value = 0x12345678;
+        memory.WriteBlock(*process, Memory::SHARED_PAGE_VADDR + 0x10, &value, sizeof(value));
+        REQUIRE(memory.WatchRegion(page_table, Memory::SHARED_PAGE_VADDR + 0x10, 4));
+        CHECK(page_table.attributes[page] == Memory::PageType::Watched);
+        CHECK(page_table.pointers[page] == nullptr);
+
+        u32 read_value = 0;
+        memory.ReadBlock(*process, Memory::SHARED_PAGE_VADDR + 0x10, &read_value,
+                         sizeof(read_value));
+        CHECK(read_value == value);
+        CHECK(Memory::IsValidVirtualAddress(*process, Memory::SHARED_PAGE_VADDR));
+
+        memory.UnwatchRegion(page_table, Memory::SHARED_PAGE_VADDR + 0x10, 4);
+        CHECK(page_table.attributes[page] == Memory::PageType::Memory);
+        CHECK(page_table.pointers[page] != nullptr);
+    }
+
+    SECTION("pages stay watched while another watchpoint touches them") {
+        REQUIRE(memory.WatchRegion(page_table, Memory::SHARED_PAGE_VADDR, 4));
+        REQUIRE(memory.WatchRegion(page_table, Memory::SHARED_PAGE_VADDR + 8, 4));
+        memory.UnwatchRegion(page_table, Memory::SHARED_PAGE_VADDR, 4);
+        CHECK(page_table.attributes[page] == Memory::PageType::Watched);
+        memory.UnwatchRegion(page_table, Memory::SHARED_PAGE_VADDR + 8, 4);
+        CHECK(page_table.attributes[page] == Memory::PageType::Memory);
+    }
+
+    SECTION("unmapped pages cannot be watched") {
+        CHECK_FALSE(memory.WatchRegion(page_table, Memory::HEAP_VADDR, 4));
+        CHECK(page_table.attributes[Memory::HEAP_VADDR >> Memory::PAGE_BITS] ==
+              Memory::PageType::Unmapped);
+    }
+
+    SECTION("remapping a watched page keeps it watched") {
+        REQUIRE(memory.WatchRegion(page_table, Memory::SHARED_PAGE_VADDR, 4));
+        process->vm_manager.ReprotectRange(Memory::SHARED_PAGE_VADDR, Memory::SHARED_PAGE_SIZE,
+                                           Kernel::VMAPermission::ReadWrite);
+        CHECK(page_table.attributes[page] == Memory::PageType::Watched);
+        memory.UnwatchRegion(page_table, Memory::SHARED_PAGE_VADDR, 4);
+        CHECK(page_table.attributes[page] == Memory::PageType::Memory);
+    }
+
+    SECTION("unmapping a watched page removes the watch") {
+        REQUIRE(memory.WatchRegion(page_table, Memory::SHARED_PAGE_VADDR, 4));
+        process->vm_manager.UnmapRange(Memory::SHARED_PAGE_VADDR, Memory::SHARED_PAGE_SIZE);
+        CHECK(page_table.attributes[page] == Memory::PageType::Unmapped);
+        CHECK(page_table.watched_pages.empty());
+        memory.UnwatchRegion(page_table, Memory::SHARED_PAGE_VADDR, 4);
+        CHECK(page_table.attributes[page] == Memory::PageType::Unmapped);
+    }
+}
+
+TEST_CASE("Memory::MemorySystem watchpoints stop at the gdbstub", "[core][memory]") {
+    // HACK: see comments of member timing
+    Core::System::GetInstance().timing = std::make_unique<Core::Timing>();
+    Core::System::GetInstance().memory = std::make_unique<Memory::MemorySystem>();
+    Memory::MemorySystem& memory = *Core::System::GetInstance().memory;
+    Core::System::GetInstance().kernel = std::make_unique<Kernel::KernelSystem>(memory, 0);
+    Kernel::KernelSystem& kernel = *Core::System::GetInstance().kernel;
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.MapSharedPages(process->vm_manager);
+    kernel.SetCurrentProcess(process);
+    memory.SetCurrentPageTable(&process->vm_manager.page_table);
+
+    GDBStub::SetServerPort(TestGdbPort);
+    GDBStub::ToggleServer(true);
+    std::unique_ptr<GdbClient> client;
+    std::thread connect_thread([&client] { client = std::make_unique<GdbClient>(); });
+    GDBStub::Init();
+    connect_thread.join();
+    REQUIRE(client->IsConnected());
+    REQUIRE(GDBStub::IsConnected());
+
+    const VAddr address = Memory::SHARED_PAGE_VADDR + 0x10;
+    const std::string address_hex = fmt::format("{:08x}", address);
+
+    SECTION("access watchpoints stop on reads and writes") {
+        client->Send("Z4," + address_hex + ",4");
+        REQUIRE(client->Receive() == "OK");
+
+        memory.Read32(address);
+        GDBStub::ServeWatchpoint();
+        CHECK(client->Receive() == "T05awatch:" + address_hex + ";");
+
+        memory.Write32(address, 1);
+        GDBStub::ServeWatchpoint();
+        CHECK(client->Receive() == "T05awatch:" + address_hex + ";");
+
+        client->Send("z4," + address_hex + ",4");
+        REQUIRE(client->Receive() == "OK");
+    }
+
+    SECTION("read and write watchpoints only stop on their access type") {
+        client->Send("Z3," + address_hex + ",4");
+        REQUIRE(client->Receive() == "OK");
+        client->Send("Z2," + fmt::format("{:08x}", address + 4) + ",4");
+        REQUIRE(client->Receive() == "OK");
+
+        // Neither of these hits, so the next stop reports the access after them
+        memory.Write32(address, 1);
+        memory.Read32(address + 4);
+        memory.Read32(address + 2);
+        GDBStub::ServeWatchpoint();
+        CHECK(client->Receive() == fmt::format("T05rwatch:{:08x};", address + 2));
+
+        memory.Write32(address + 4, 1);
+        GDBStub::ServeWatchpoint();
+        CHECK(client->Receive() == fmt::format("T05watch:{:08x};", address + 4));
+    }
+
+    GDBStub::Shutdown();
+    GDBStub::ToggleServer(false);
+    client.reset();
+    Core::System::GetInstance().kernel.reset();
+}
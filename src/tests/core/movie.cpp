@@ -0,0 +1,160 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <catch2/catch.hpp>
+#include "common/file_util.h"
+#include "core/core.h"
+#include "core/hle/service/hid/hid.h"
+#include "core/movie.h"
+
+namespace Core {
+
+namespace {
+
+/// More than two chunks, so that the last one is only written when the movie is saved
+constexpr int InputCount = 10000;
+/// Inputs in the chunks that are written while recording, see inputs_per_chunk in movie.cpp
+constexpr int WrittenInputCount = 2 * 4096;
+
+/// Records InputCount pad states, each tagged with its index in circle_pad_x
+void RecordInputs(Movie& movie) {
+    for (int i = 0; i < InputCount; ++i) {
+        Service::HID::PadState pad_state;
+        pad_state.a.Assign(i % 2);
+        s16 circle_pad_x = static_cast<s16>(i);
+        s16 circle_pad_y = static_cast<s16>(-i);
+        movie.HandlePadAndCircleStatus(pad_state, circle_pad_x, circle_pad_y);
+    }
+}
+
+/// Plays the next input, returning the index it was tagged with
+int PlayInput(Movie& movie) {
+    REQUIRE(movie.IsPlayingInput());
+    Service::HID::PadState pad_state;
+    s16 circle_pad_x = -1;
+    s16 circle_pad_y = 0;
+    movie.HandlePadAndCircleStatus(pad_state, circle_pad_x, circle_pad_y);
+    REQUIRE(circle_pad_y == -circle_pad_x);
+    REQUIRE(pad_state.a == static_cast<u32>(circle_pad_x % 2));
+    return circle_pad_x;
+}
+
+void TestRoundTrip(bool compress) {
+    const std::string test_dir = "./test_movie";
+    const std::string path = test_dir + "/movie.ctm";
+    FileUtil::DeleteDirRecursively(test_dir);
+    FileUtil::CreateDir(test_dir);
+
+    Movie movie;
+    bool completed = false;
+
+    SECTION("plays back every recorded input") {
+        movie.StartRecording(path, compress);
+        REQUIRE(movie.IsRecordingInput());
+        RecordInputs(movie);
+        movie.Shutdown();
+
+        movie.StartPlayback(path, [&completed] { completed = true; });
+        for (int i = 0; i < InputCount; ++i) {
+            REQUIRE(!completed);
+            REQUIRE(PlayInput(movie) == i);
+        }
+        REQUIRE(completed);
+        REQUIRE(!movie.IsPlayingInput());
+    }
+
+    SECTION("seeks into the middle of a chunk") {
+        movie.StartRecording(path, compress);
+        RecordInputs(movie);
+        movie.Shutdown();
+
+        movie.StartPlayback(path, [&completed] { completed = true; });
+        REQUIRE(movie.SeekPlayback(5000));
+        REQUIRE(PlayInput(movie) == 5000);
+        REQUIRE(PlayInput(movie) == 5001);
+
+        // Back to an earlier chunk
+        REQUIRE(movie.SeekPlayback(4095));
+        REQUIRE(PlayInput(movie) == 4095);
+        REQUIRE(PlayInput(movie) == 4096);
+
+        REQUIRE(movie.SeekPlayback(InputCount - 1));
+        REQUIRE(PlayInput(movie) == InputCount - 1);
+        REQUIRE(completed);
+    }
+
+    SECTION("rejects seeks past the end") {
+        movie.StartRecording(path, compress);
+        RecordInputs(movie);
+        movie.Shutdown();
+
+        movie.StartPlayback(path, [&completed] { completed = true; });
+        REQUIRE(!movie.SeekPlayback(InputCount));
+        REQUIRE(completed);
+        REQUIRE(!movie.IsPlayingInput());
+    }
+
+    SECTION("plays back the chunks of an interrupted recording") {
+        const std::string interrupted_path = test_dir + "/interrupted.ctm";
+        movie.StartRecording(path, compress);
+        RecordInputs(movie);
+        // Copy of the file as left by a crash, without the last chunk and the index
+        REQUIRE(FileUtil::Copy(path, interrupted_path));
+        movie.Shutdown();
+
+        SECTION("with complete chunks") {}
+
+        SECTION("with a chunk cut short") {
+            FileUtil::IOFile file(interrupted_path, "ab");
+            const u32 chunk_header[2] = {4096, 1000};
+            REQUIRE(file.WriteArray(chunk_header, 2) == 2);
+            REQUIRE(file.WriteBytes(path.data(), path.size()) == path.size());
+        }
+
+        movie.StartPlayback(interrupted_path, [&completed] { completed = true; });
+        REQUIRE(movie.SeekPlayback(5000));
+        REQUIRE(PlayInput(movie) == 5000);
+        REQUIRE(movie.SeekPlayback(0));
+        for (int i = 0; i < WrittenInputCount; ++i) {
+            REQUIRE(!completed);
+            REQUIRE(PlayInput(movie) == i);
+        }
+        REQUIRE(completed);
+    }
+
+    movie.Shutdown();
+    FileUtil::DeleteDirRecursively(test_dir);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Movie round trip", "[core]") {
+    TestRoundTrip(false);
+}
+
+TEST_CASE("Movie round trip with compression", "[core]") {
+    TestRoundTrip(true);
+}
+
+TEST_CASE("Movie keeps the program ID of the recorded application", "[core]") {
+    const std::string test_dir = "./test_movie";
+    const std::string path = test_dir + "/movie.ctm";
+    FileUtil::DeleteDirRecursively(test_dir);
+    FileUtil::CreateDir(test_dir);
+    constexpr u64 TestProgramId = 0x0004000000123400;
+
+    // The system is not powered on, as when a frontend saves the movie after the game stopped
+    REQUIRE(!System::GetInstance().IsPoweredOn());
+    Movie movie;
+    movie.StartRecording(path, true, TestProgramId);
+    RecordInputs(movie);
+    movie.Shutdown();
+    REQUIRE(movie.GetMovieProgramID(path) == TestProgramId);
+    REQUIRE(movie.ValidateMovie(path, TestProgramId) == Movie::ValidationResult::OK);
+
+    FileUtil::DeleteDirRecursively(test_dir);
+}
+
+} // namespace Core
@@ -0,0 +1,196 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/file_util.h"
+#include "common/memory_snapshot.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/client_port.h"
+#include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/object_state.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/session.h"
+#include "core/hle/kernel/shared_memory.h"
+#include "core/memory.h"
+#include "core/savestate.h"
+#include "video_core/pica_state.h"
+
+namespace Core {
+
+namespace {
+
+constexpr u64 TestProgramId = 0x0004000000123400;
+
+const std::vector<u8>& FindSection(const std::vector<SaveStateSection>& sections,
+                                   const std::string& name) {
+    const auto it = std::find_if(sections.begin(), sections.end(),
+                                 [&name](const auto& section) { return section.name == name; });
+    REQUIRE(it != sections.end());
+    return it->data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SaveState round trip", "[core]") {
+    // HACK: see comments of member timing
+    System::GetInstance().timing = std::make_unique<Timing>();
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(memory, 0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", TestProgramId));
+    kernel.SetCurrentProcess(process);
+    auto event = kernel.CreateEvent(Kernel::ResetType::OneShot);
+    event->Signal();
+    auto [server, client] = kernel.CreateSessionPair();
+    constexpr auto ReadWrite = Kernel::MemoryPermission::ReadWrite;
+    auto shared_memory = kernel.CreateSharedMemory(nullptr, 0x1000, ReadWrite, ReadWrite).Unwrap();
+    shared_memory->GetPointer()[0] = 0x5A;
+    const Kernel::Handle event_handle = process->handle_table.Create(event).Unwrap();
+    const Kernel::Handle server_handle = process->handle_table.Create(server).Unwrap();
+    const Kernel::Handle client_handle = process->handle_table.Create(client).Unwrap();
+    const Kernel::Handle shared_memory_handle =
+        process->handle_table.Create(shared_memory).Unwrap();
+
+    u8* const fcram = memory.GetFCRAMPointer(0x1000);
+    fcram[0] = 0xAB;
+    fcram[1] = 0xCD;
+
+    std::vector<SaveStateSection> sections(1);
+    sections[0].name = "kernel";
+    {
+        Kernel::ObjectStateWriter kernel_writer(kernel);
+        kernel.SaveState(kernel_writer);
+        kernel.SaveMemoryState(kernel_writer);
+        auto kernel_state = kernel_writer.Finish();
+        REQUIRE(kernel_state);
+        sections[0].data = std::move(*kernel_state);
+    }
+
+    auto snapshots = memory.SaveState();
+    // Written while the snapshot is in progress, which must keep the old value
+    fcram[0] = 0x12;
+    std::vector<SaveStateBlock> blocks;
+    for (std::size_t i = 0; i < snapshots.size(); ++i) {
+        blocks.push_back({Memory::MemorySystem::StateSectionNames[i], snapshots[i]->Finish(),
+                          snapshots[i]->GetSize()});
+    }
+    REQUIRE(fcram[0] == 0x12);
+
+    const std::string path = "savestate_test.cst";
+    REQUIRE(WriteSaveState(path, TestProgramId, sections, blocks));
+    const auto loaded = ReadSaveState(path, TestProgramId);
+    REQUIRE(!ReadSaveState(path, TestProgramId + 1));
+    FileUtil::Delete(path);
+    REQUIRE(loaded);
+    REQUIRE(loaded->size() == sections.size() + blocks.size());
+
+    fcram[0] = 0;
+    fcram[1] = 0;
+
+    SECTION("restores the memory as it was when the snapshot started") {
+        std::array<const std::vector<u8>*, 3> memory_sections;
+        for (std::size_t i = 0; i < memory_sections.size(); ++i) {
+            memory_sections[i] =
+                &FindSection(*loaded, Memory::MemorySystem::StateSectionNames[i]);
+        }
+        REQUIRE(memory.LoadState(memory_sections));
+        REQUIRE(fcram[0] == 0xAB);
+        REQUIRE(fcram[1] == 0xCD);
+    }
+
+    SECTION("creates the kernel objects anew") {
+        Kernel::ObjectStateReader reader(
+            FindSection(*loaded, "kernel"), kernel,
+            [](const std::string&) -> std::shared_ptr<Kernel::SessionRequestHandler> {
+                return nullptr;
+            });
+        REQUIRE(reader.LoadObjects());
+        REQUIRE(kernel.LoadState(reader));
+
+        // The objects that were replaced give their memory back before the allocators are loaded
+        const auto old_process = process.get();
+        process = nullptr;
+        event = nullptr;
+        server = nullptr;
+        client = nullptr;
+        shared_memory = nullptr;
+        REQUIRE(kernel.LoadMemoryState(reader));
+        REQUIRE(reader.AtEnd());
+
+        const auto loaded_process = kernel.GetCurrentProcess();
+        REQUIRE(loaded_process != nullptr);
+        REQUIRE(loaded_process.get() != old_process);
+        REQUIRE(loaded_process->codeset->program_id == TestProgramId);
+        const auto& handle_table = loaded_process->handle_table;
+
+        const auto loaded_event = handle_table.Get<Kernel::Event>(event_handle);
+        REQUIRE(loaded_event != nullptr);
+        REQUIRE_FALSE(loaded_event->ShouldWait(nullptr));
+
+        const auto loaded_server = handle_table.Get<Kernel::ServerSession>(server_handle);
+        const auto loaded_client = handle_table.Get<Kernel::ClientSession>(client_handle);
+        REQUIRE(loaded_server != nullptr);
+        REQUIRE(loaded_client != nullptr);
+        REQUIRE(loaded_client->parent->server == loaded_server.get());
+        REQUIRE(loaded_server->parent->client == loaded_client.get());
+
+        const auto loaded_shared_memory =
+            handle_table.Get<Kernel::SharedMemory>(shared_memory_handle);
+        REQUIRE(loaded_shared_memory != nullptr);
+        REQUIRE(loaded_shared_memory->GetPointer()[0] == 0x5A);
+    }
+
+    SECTION("refuses a session to an HLE handler that can't be saved") {
+        class Handler final : public Kernel::SessionRequestHandler {
+            void HandleSyncRequest(Kernel::SharedPtr<Kernel::ServerSession>) override {}
+            std::unique_ptr<SessionDataBase> MakeSessionData() const override {
+                return std::make_unique<SessionDataBase>();
+            }
+        };
+        std::make_shared<Handler>()->ClientConnected(server);
+        Kernel::ObjectStateWriter kernel_writer(kernel);
+        kernel.SaveState(kernel_writer);
+        REQUIRE_FALSE(kernel_writer.Finish());
+    }
+}
+
+TEST_CASE("Pica state keeps the primitives in progress", "[core]") {
+    Pica::State& state = Pica::g_state;
+    state.Reset();
+    state.regs.pipeline.triangle_topology.Assign(Pica::PipelineRegs::TriangleTopology::Strip);
+    state.primitive_assembler.Reconfigure(state.regs.pipeline.triangle_topology);
+    const Pica::Shader::OutputVertex vertex{};
+    const auto ignore = [](const auto&, const auto&, const auto&) {};
+    state.primitive_assembler.SubmitVertex(vertex, ignore);
+    state.primitive_assembler.SubmitVertex(vertex, ignore);
+    state.gs_unit.registers.temporary[0].x = Pica::float24::FromFloat32(1.5f);
+
+    StateWriter writer;
+    state.SaveState(writer);
+    const std::vector<u8> data = writer.TakeData();
+
+    state.Reset();
+    state.gs_unit.registers.temporary[0].x = Pica::float24::Zero();
+    StateReader reader(data);
+    REQUIRE(state.LoadState(reader));
+    REQUIRE(reader.AtEnd());
+    REQUIRE(state.gs_unit.registers.temporary[0].x.ToFloat32() == 1.5f);
+
+    // The strip already has two vertices, so the next one completes a triangle
+    int triangles = 0;
+    state.primitive_assembler.SubmitVertex(
+        vertex, [&triangles](const auto&, const auto&, const auto&) { ++triangles; });
+    REQUIRE(triangles == 1);
+}
+
+} // namespace Core
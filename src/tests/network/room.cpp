@@ -0,0 +1,108 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "network/network.h"
+
+namespace Network {
+
+namespace {
+
+/// Away from DefaultRoomPort, so that the test does not collide with a room hosted on the machine
+constexpr u16 TestRoomPort = DefaultRoomPort + 100;
+
+template <typename Predicate>
+bool WaitFor(Predicate predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/**
+ * Lets member_count local members join a room, then has each of them broadcast packet_count
+ * packets of packet_size bytes, and waits until every member received the packets of all others.
+ * @returns How long the room took to relay all packets
+ */
+std::chrono::steady_clock::duration RunRelay(std::size_t member_count, std::size_t packet_count,
+                                             std::size_t packet_size) {
+    REQUIRE(Init());
+
+    Room room;
+    REQUIRE(room.Create("Test room", "127.0.0.1", TestRoomPort, "",
+                        static_cast<u32>(member_count)));
+
+    std::atomic<std::size_t> received_count{0};
+    std::vector<std::unique_ptr<RoomMember>> members;
+    for (std::size_t i = 0; i < member_count; ++i) {
+        auto member = std::make_unique<RoomMember>();
+        member->BindOnWifiPacketReceived(
+            [&received_count](const WifiPacket& packet) { ++received_count; });
+        member->Join("member" + std::to_string(i), "127.0.0.1", TestRoomPort);
+        members.push_back(std::move(member));
+    }
+    REQUIRE(WaitFor([&members] {
+        return std::all_of(members.begin(), members.end(), [](const auto& member) {
+            return member->GetState() == RoomMember::State::Joined;
+        });
+    }));
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < packet_count; ++i) {
+        for (const auto& member : members) {
+            WifiPacket packet{};
+            packet.type = WifiPacket::PacketType::Data;
+            packet.data.resize(packet_size);
+            packet.transmitter_address = member->GetMacAddress();
+            packet.destination_address = BroadcastMac;
+            packet.channel = 1;
+            member->SendWifiPacket(packet);
+        }
+    }
+    const std::size_t expected_count = member_count * (member_count - 1) * packet_count;
+    const bool relayed_all = WaitFor([&] { return received_count >= expected_count; });
+    const auto duration = std::chrono::steady_clock::now() - start;
+
+    for (const auto& member : members) {
+        member->Leave();
+    }
+    room.Destroy();
+    Shutdown();
+
+    REQUIRE(relayed_all);
+    REQUIRE(received_count == expected_count);
+    return duration;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Room[Relay]", "[network]") {
+    RunRelay(4, 20, 256);
+}
+
+// Hidden by default, run it with "tests [room-load]"
+TEST_CASE("Room[Load]", "[.][room-load]") {
+    constexpr std::size_t MemberCount = 16;
+    constexpr std::size_t PacketCount = 500;
+    const auto duration = RunRelay(MemberCount, PacketCount, 1024);
+
+    const auto milliseconds =
+        std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    const std::size_t relayed = MemberCount * (MemberCount - 1) * PacketCount;
+    WARN("Relayed " << relayed << " packets to " << MemberCount << " members in " << milliseconds
+                    << " ms");
+}
+
+} // namespace Network
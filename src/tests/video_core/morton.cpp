@@ -0,0 +1,132 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/morton.h"
+
+namespace {
+
+constexpr u32 Stride = 64;
+
+/// Pixel by pixel copy the tile kernels are checked against
+template <bool morton_to_linear, u32 bytes_per_pixel, u32 linear_bytes_per_pixel,
+          bool rotate_stencil>
+void ReferenceCopyTile(u32 stride, u8* tile_buffer, u8* linear_buffer) {
+    for (u32 y = 0; y < 8; ++y) {
+        for (u32 x = 0; x < 8; ++x) {
+            u8* tile_ptr = tile_buffer + VideoCore::MortonInterleave(x, y) * bytes_per_pixel;
+            u8* linear_ptr = linear_buffer + ((7 - y) * stride + x) * linear_bytes_per_pixel;
+            if (morton_to_linear) {
+                if (rotate_stencil) {
+                    linear_ptr[0] = tile_ptr[3];
+                    std::memcpy(linear_ptr + 1, tile_ptr, 3);
+                } else {
+                    std::memcpy(linear_ptr, tile_ptr, bytes_per_pixel);
+                }
+            } else {
+                if (rotate_stencil) {
+                    std::memcpy(tile_ptr, linear_ptr + 1, 3);
+                    tile_ptr[3] = linear_ptr[0];
+                } else {
+                    std::memcpy(tile_ptr, linear_ptr, bytes_per_pixel);
+                }
+            }
+        }
+    }
+}
+
+std::vector<u8> MakePattern(std::size_t size) {
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<u8>(i * 7 + i / 256);
+    }
+    return data;
+}
+
+template <u32 bytes_per_pixel, u32 linear_bytes_per_pixel = bytes_per_pixel,
+          bool rotate_stencil = false>
+void CheckTileCopy() {
+    constexpr u32 tile_size = bytes_per_pixel * 64;
+    // Place the tile in the middle of a wider image to check that the stride is honoured
+    const std::size_t linear_size = Stride * 8 * linear_bytes_per_pixel;
+    const auto linear_tile = [](std::vector<u8>& buffer) {
+        return buffer.data() + 8 * linear_bytes_per_pixel;
+    };
+
+    const std::vector<u8> tile = MakePattern(tile_size);
+    std::vector<u8> expected_linear(linear_size);
+    std::vector<u8> linear(linear_size);
+    std::vector<u8> tile_copy = tile;
+    ReferenceCopyTile<true, bytes_per_pixel, linear_bytes_per_pixel, rotate_stencil>(
+        Stride, tile_copy.data(), linear_tile(expected_linear));
+    VideoCore::MortonCopyTile<true, bytes_per_pixel, linear_bytes_per_pixel, rotate_stencil>(
+        Stride, tile_copy.data(), linear_tile(linear));
+    REQUIRE(linear == expected_linear);
+
+    const std::vector<u8> source_linear = MakePattern(linear_size);
+    std::vector<u8> expected_tile(tile_size);
+    std::vector<u8> tile_result(tile_size);
+    std::vector<u8> linear_copy = source_linear;
+    ReferenceCopyTile<false, bytes_per_pixel, linear_bytes_per_pixel, rotate_stencil>(
+        Stride, expected_tile.data(), linear_tile(linear_copy));
+    VideoCore::MortonCopyTile<false, bytes_per_pixel, linear_bytes_per_pixel, rotate_stencil>(
+        Stride, tile_result.data(), linear_tile(linear_copy));
+    REQUIRE(tile_result == expected_tile);
+    REQUIRE(linear_copy == source_linear);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MortonCopyTile matches the per-pixel copy", "[video_core][morton]") {
+    SECTION("16-bit formats") {
+        CheckTileCopy<2>();
+    }
+    SECTION("RGB8") {
+        CheckTileCopy<3>();
+    }
+    SECTION("RGBA8") {
+        CheckTileCopy<4>();
+    }
+    SECTION("D24") {
+        CheckTileCopy<3, 4>();
+    }
+    SECTION("D24S8") {
+        CheckTileCopy<4, 4, true>();
+    }
+}
+
+TEST_CASE("MortonCopyTile throughput", "[.][video_core][morton][benchmark]") {
+    // A 400x240 RGBA8 framebuffer, as read back when the CPU accesses the screen
+    constexpr u32 width = 400;
+    constexpr u32 height = 240;
+    constexpr u32 tile_size = 4 * 64;
+    constexpr int iterations = 200;
+
+    std::vector<u8> tiles = MakePattern(width * height * 4);
+    std::vector<u8> linear(width * height * 4);
+
+    const auto run = [&](auto copy_tile) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            u8* tile = tiles.data();
+            for (u32 y = 0; y < height; y += 8) {
+                for (u32 x = 0; x < width; x += 8) {
+                    copy_tile(width, tile, linear.data() + ((height - 8 - y) * width + x) * 4);
+                    tile += tile_size;
+                }
+            }
+        }
+        const std::chrono::duration<double, std::micro> elapsed =
+            std::chrono::steady_clock::now() - start;
+        return elapsed.count() / iterations;
+    };
+
+    const double reference_us = run(ReferenceCopyTile<true, 4, 4, false>);
+    const double kernel_us = run(VideoCore::MortonCopyTile<true, 4, 4, false>);
+    WARN("400x240 RGBA8 morton to linear: " << reference_us << " us per pixel copy, " << kernel_us
+                                            << " us with tile kernels");
+}
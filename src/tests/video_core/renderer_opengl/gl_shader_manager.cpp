@@ -0,0 +1,54 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "video_core/renderer_opengl/gl_shader_manager.h"
+
+namespace OpenGL {
+
+TEST_CASE("UberShaderBlock uploads new configs", "[video_core][opengl]") {
+    UberShaderBlock block;
+    PicaFSConfig config;
+    config.state.alpha_test_func = Pica::FramebufferRegs::CompareFunc::Always;
+
+    block.Use(&config);
+    REQUIRE(block.NeedsUpload(false));
+    REQUIRE(block.GetData().alpha_test_func ==
+            static_cast<GLint>(Pica::FramebufferRegs::CompareFunc::Always));
+    block.MarkUploaded();
+
+    block.Use(&config);
+    REQUIRE(!block.NeedsUpload(false));
+
+    config.state.alpha_test_func = Pica::FramebufferRegs::CompareFunc::Never;
+    block.Use(&config);
+    REQUIRE(block.NeedsUpload(false));
+    REQUIRE(block.GetData().alpha_test_func ==
+            static_cast<GLint>(Pica::FramebufferRegs::CompareFunc::Never));
+}
+
+TEST_CASE("UberShaderBlock is uploaded again after the buffer wraps", "[video_core][opengl]") {
+    UberShaderBlock block;
+    PicaFSConfig config;
+
+    block.Use(&config);
+    block.MarkUploaded();
+
+    SECTION("while the uber shader is used") {
+        block.Use(&config);
+        REQUIRE(block.NeedsUpload(true));
+    }
+
+    SECTION("while the generated shader is used") {
+        block.Use(nullptr);
+        REQUIRE(!block.NeedsUpload(true));
+
+        // The buffer wrapped during the draws with the generated shader, then a draw goes back to
+        // the uber shader with the same config
+        block.Use(&config);
+        REQUIRE(block.NeedsUpload(false));
+    }
+}
+
+} // namespace OpenGL
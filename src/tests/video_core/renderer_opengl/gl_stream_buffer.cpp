@@ -0,0 +1,187 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <tuple>
+#include <catch2/catch.hpp>
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include "common/counters.h"
+#include "common/scope_exit.h"
+#include "video_core/renderer_opengl/gl_stream_buffer.h"
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+namespace OpenGL {
+
+namespace {
+
+constexpr GLsizeiptr BufferSize = 4096;
+constexpr std::size_t NumSegments = 4;
+
+/// OpenGL context without a window, such as one on Mesa's llvmpipe, current while it lives
+class HeadlessContext {
+public:
+    HeadlessContext() {
+        const auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (get_platform_display != nullptr) {
+            display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY,
+                                           nullptr);
+        }
+        if (display == EGL_NO_DISPLAY) {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+            display = EGL_NO_DISPLAY;
+            return;
+        }
+
+        // Headless platforms have no window surfaces, which configs have by default
+        const EGLint config_attributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE,
+                                            EGL_OPENGL_BIT, EGL_NONE};
+        EGLConfig config;
+        EGLint num_configs = 0;
+        if (!eglBindAPI(EGL_OPENGL_API) ||
+            !eglChooseConfig(display, config_attributes, &config, 1, &num_configs) ||
+            num_configs == 0) {
+            return;
+        }
+
+        const EGLint context_attributes[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                             3,
+                                             EGL_CONTEXT_MINOR_VERSION,
+                                             3,
+                                             EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                             EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                             EGL_NONE};
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+        if (context == EGL_NO_CONTEXT ||
+            !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+            return;
+        }
+        current = gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress)) != 0;
+    }
+
+    ~HeadlessContext() {
+        if (context != EGL_NO_CONTEXT) {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+        }
+        if (display != EGL_NO_DISPLAY) {
+            eglTerminate(display);
+        }
+    }
+
+    bool IsCurrent() const {
+        return current;
+    }
+
+private:
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    bool current = false;
+};
+
+u64 GetCounter(const std::string& name) {
+    for (const auto& sample : Common::Counters::Snapshot()) {
+        if (sample.name == name && sample.labels == Common::Counters::Labels{{"buffer", "test"}}) {
+            return sample.value;
+        }
+    }
+    return 0;
+}
+
+/// Maps a chunk, fills it with the value and unmaps it, returning the offset and invalidation flag
+std::tuple<GLintptr, bool> Upload(OGLStreamBuffer& buffer, GLsizeiptr size, u8 value,
+                                  GLintptr alignment = 0) {
+    const auto [ptr, offset, invalidate] = buffer.Map(size, alignment);
+    std::fill_n(ptr, size, value);
+    buffer.Unmap(size);
+    return {offset, invalidate};
+}
+
+/// Checks that the buffer holds the value in the given range, as seen by the GL
+void CheckContents(const OGLStreamBuffer& buffer, GLintptr offset, GLsizeiptr size, u8 value) {
+    std::array<u8, BufferSize> contents{};
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.GetHandle());
+    glGetBufferSubData(GL_ARRAY_BUFFER, offset, size, contents.data());
+    REQUIRE(std::all_of(contents.begin(), contents.begin() + size,
+                        [value](u8 byte) { return byte == value; }));
+}
+
+void TestStreamBuffer(bool persistent) {
+    HeadlessContext context;
+    if (!context.IsCurrent()) {
+        WARN("No OpenGL context could be created, skipping");
+        return;
+    }
+    if (persistent && !GLAD_GL_ARB_buffer_storage) {
+        WARN("ARB_buffer_storage is not supported, skipping");
+        return;
+    }
+
+    // The buffer picks the mapping strategy when it is created
+    const auto create_buffer = [persistent] {
+        const int buffer_storage = GLAD_GL_ARB_buffer_storage;
+        SCOPE_EXIT({ GLAD_GL_ARB_buffer_storage = buffer_storage; });
+        GLAD_GL_ARB_buffer_storage = persistent ? buffer_storage : 0;
+        return OGLStreamBuffer("test", GL_ARRAY_BUFFER, BufferSize, false, true, NumSegments);
+    };
+    OGLStreamBuffer buffer = create_buffer();
+    REQUIRE(buffer.GetSize() == BufferSize);
+
+    SECTION("uploads land in the buffer") {
+        const u64 bytes_uploaded = GetCounter("citra_gpu_stream_buffer_upload_bytes_total");
+        REQUIRE(Upload(buffer, 256, 0x11) == std::make_tuple(GLintptr{0}, false));
+        REQUIRE(Upload(buffer, 100, 0x22) == std::make_tuple(GLintptr{256}, false));
+        CheckContents(buffer, 0, 256, 0x11);
+        CheckContents(buffer, 256, 100, 0x22);
+        REQUIRE(GetCounter("citra_gpu_stream_buffer_upload_bytes_total") - bytes_uploaded == 356);
+    }
+
+    SECTION("chunks are aligned") {
+        Upload(buffer, 100, 0x11);
+        REQUIRE(std::get<0>(Upload(buffer, 16, 0x22, 64)) == 128);
+    }
+
+    SECTION("wrapping around invalidates earlier chunks") {
+        Upload(buffer, 3000, 0x11);
+        REQUIRE(Upload(buffer, 2000, 0x22) == std::make_tuple(GLintptr{0}, true));
+        // The rest of the buffer may have been invalidated by the mapping, only the new chunk is
+        // defined
+        CheckContents(buffer, 0, 2000, 0x22);
+    }
+
+    if (persistent) {
+        SECTION("leaving a segment invalidates earlier chunks") {
+            REQUIRE(Upload(buffer, 1000, 0x11) == std::make_tuple(GLintptr{0}, false));
+            REQUIRE(Upload(buffer, 24, 0x22) == std::make_tuple(GLintptr{1000}, false));
+            REQUIRE(Upload(buffer, 20, 0x33) == std::make_tuple(GLintptr{1024}, true));
+
+            // Going around the ring again waits for the fences of the reused segments
+            Upload(buffer, 3000, 0x44);
+            glFinish();
+            REQUIRE(Upload(buffer, 2000, 0x55) == std::make_tuple(GLintptr{0}, true));
+            CheckContents(buffer, 0, 2000, 0x55);
+        }
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("OGLStreamBuffer with persistent mapping", "[video_core][opengl]") {
+    TestStreamBuffer(true);
+}
+
+TEST_CASE("OGLStreamBuffer with explicit mapping", "[video_core][opengl]") {
+    TestStreamBuffer(false);
+}
+
+} // namespace OpenGL
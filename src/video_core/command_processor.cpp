@@ -7,6 +7,7 @@
 #include <memory>
 #include <utility>
 #include "common/assert.h"
+#include "common/counters.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
@@ -49,6 +50,20 @@ static const u32 expand_bits_to_bytes[] = {
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
+static const Common::Counters::Counter draws =
+    Common::Counters::Register("citra_gpu_draws_total", "Draw calls triggered by the PICA");
+static const Common::Counters::Counter vertices_shaded_cpu =
+    Common::Counters::Register("citra_gpu_vertices_shaded_total",
+                               "Vertices processed by the vertex shader", {{"shader", "cpu"}});
+static const Common::Counters::Counter vertices_shaded_host =
+    Common::Counters::Register("citra_gpu_vertices_shaded_total",
+                               "Vertices processed by the vertex shader", {{"shader", "host"}});
+static const Common::Counters::Counter state_notifications = Common::Counters::Register(
+    "citra_gpu_state_notifications_total", "Register writes that marked a state group dirty");
+static const Common::Counters::Counter state_syncs_coalesced = Common::Counters::Register(
+    "citra_gpu_state_syncs_coalesced_total",
+    "Register writes to state groups that were already dirty, each of which used to be a sync");
+
 static const char* GetShaderSetupTypeName(Shader::ShaderSetup& setup) {
     if (&setup == &g_state.vs) {
         return "vertex shader";
@@ -119,544 +134,626 @@ static void WriteUniformFloatReg(ShaderRegs& config, Shader::ShaderSetup& setup,
     }
 }
 
-static void WritePicaReg(u32 id, u32 value, u32 mask) {
-    auto& regs = g_state.regs;
+// Handler of a register write with side effects, called after the register has been updated
+using RegWriteHandler = void (*)(u32 id, u32 value);
 
-    if (id >= Regs::NUM_REGS) {
-        LOG_ERROR(
-            HW_GPU,
-            "Commandlist tried to write to invalid register 0x{:03X} (value: {:08X}, mask: {:X})",
-            id, value, mask);
-        return;
-    }
+static void HandleTriggerIrq(u32 id, u32 value) {
+    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+}
 
-    // TODO: Figure out how register masking acts on e.g. vs.uniform_setup.set_value
-    u32 old_value = regs.reg_array[id];
+static void HandleTriangleTopology(u32 id, u32 value) {
+    g_state.primitive_assembler.Reconfigure(g_state.regs.pipeline.triangle_topology);
+}
 
-    const u32 write_mask = expand_bits_to_bytes[mask];
+static void HandleRestartPrimitive(u32 id, u32 value) {
+    g_state.primitive_assembler.Reset();
+}
 
-    regs.reg_array[id] = (old_value & ~write_mask) | (value & write_mask);
+static void HandleDefaultAttributeIndex(u32 id, u32 value) {
+    g_state.immediate.current_attribute = 0;
+    g_state.immediate.reset_geometry_pipeline = true;
+    default_attr_counter = 0;
+}
 
-    // Double check for is_pica_tracing to avoid call overhead
-    if (DebugUtils::IsPicaTracing()) {
-        DebugUtils::OnPicaRegWrite({(u16)id, (u16)mask, regs.reg_array[id]});
-    }
+// Load default vertex input attributes
+static void HandleDefaultAttributeValue(u32 id, u32 value) {
+    auto& regs = g_state.regs;
 
-    if (g_debug_context)
-        g_debug_context->OnEvent(DebugContext::Event::PicaCommandLoaded,
-                                 reinterpret_cast<void*>(&id));
+    // TODO: Does actual hardware indeed keep an intermediate buffer or does
+    //       it directly write the values?
+    default_attr_write_buffer[default_attr_counter++] = value;
 
-    switch (id) {
-    // Trigger IRQ
-    case PICA_REG_INDEX(trigger_irq):
-        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
-        break;
+    // Default attributes are written in a packed format such that four float24 values are
+    // encoded in
+    // three 32-bit numbers. We write to internal memory once a full such vector is
+    // written.
+    if (default_attr_counter >= 3) {
+        default_attr_counter = 0;
 
-    case PICA_REG_INDEX(pipeline.triangle_topology):
-        g_state.primitive_assembler.Reconfigure(regs.pipeline.triangle_topology);
-        break;
+        auto& setup = regs.pipeline.vs_default_attributes_setup;
 
-    case PICA_REG_INDEX(pipeline.restart_primitive):
-        g_state.primitive_assembler.Reset();
-        break;
+        if (setup.index >= 16) {
+            LOG_ERROR(HW_GPU, "Invalid VS default attribute index {}", (int)setup.index);
+            return;
+        }
 
-    case PICA_REG_INDEX(pipeline.vs_default_attributes_setup.index):
-        g_state.immediate.current_attribute = 0;
-        g_state.immediate.reset_geometry_pipeline = true;
-        default_attr_counter = 0;
-        break;
+        Math::Vec4<float24> attribute;
 
-    // Load default vertex input attributes
-    case PICA_REG_INDEX_WORKAROUND(pipeline.vs_default_attributes_setup.set_value[0], 0x233):
-    case PICA_REG_INDEX_WORKAROUND(pipeline.vs_default_attributes_setup.set_value[1], 0x234):
-    case PICA_REG_INDEX_WORKAROUND(pipeline.vs_default_attributes_setup.set_value[2], 0x235): {
-        // TODO: Does actual hardware indeed keep an intermediate buffer or does
-        //       it directly write the values?
-        default_attr_write_buffer[default_attr_counter++] = value;
-
-        // Default attributes are written in a packed format such that four float24 values are
-        // encoded in
-        // three 32-bit numbers. We write to internal memory once a full such vector is
-        // written.
-        if (default_attr_counter >= 3) {
-            default_attr_counter = 0;
-
-            auto& setup = regs.pipeline.vs_default_attributes_setup;
-
-            if (setup.index >= 16) {
-                LOG_ERROR(HW_GPU, "Invalid VS default attribute index {}", (int)setup.index);
-                break;
-            }
+        // NOTE: The destination component order indeed is "backwards"
+        attribute.w = float24::FromRaw(default_attr_write_buffer[0] >> 8);
+        attribute.z = float24::FromRaw(((default_attr_write_buffer[0] & 0xFF) << 16) |
+                                       ((default_attr_write_buffer[1] >> 16) & 0xFFFF));
+        attribute.y = float24::FromRaw(((default_attr_write_buffer[1] & 0xFFFF) << 8) |
+                                       ((default_attr_write_buffer[2] >> 24) & 0xFF));
+        attribute.x = float24::FromRaw(default_attr_write_buffer[2] & 0xFFFFFF);
 
-            Math::Vec4<float24> attribute;
+        LOG_TRACE(HW_GPU, "Set default VS attribute {:x} to ({} {} {} {})", (int)setup.index,
+                  attribute.x.ToFloat32(), attribute.y.ToFloat32(), attribute.z.ToFloat32(),
+                  attribute.w.ToFloat32());
 
-            // NOTE: The destination component order indeed is "backwards"
-            attribute.w = float24::FromRaw(default_attr_write_buffer[0] >> 8);
-            attribute.z = float24::FromRaw(((default_attr_write_buffer[0] & 0xFF) << 16) |
-                                           ((default_attr_write_buffer[1] >> 16) & 0xFFFF));
-            attribute.y = float24::FromRaw(((default_attr_write_buffer[1] & 0xFFFF) << 8) |
-                                           ((default_attr_write_buffer[2] >> 24) & 0xFF));
-            attribute.x = float24::FromRaw(default_attr_write_buffer[2] & 0xFFFFFF);
+        // TODO: Verify that this actually modifies the register!
+        if (setup.index < 15) {
+            g_state.input_default_attributes.attr[setup.index] = attribute;
+            setup.index++;
+        } else {
+            // Put each attribute into an immediate input buffer.  When all specified immediate
+            // attributes are present, the Vertex Shader is invoked and everything is sent to
+            // the primitive assembler.
 
-            LOG_TRACE(HW_GPU, "Set default VS attribute {:x} to ({} {} {} {})", (int)setup.index,
-                      attribute.x.ToFloat32(), attribute.y.ToFloat32(), attribute.z.ToFloat32(),
-                      attribute.w.ToFloat32());
+            auto& immediate_input = g_state.immediate.input_vertex;
+            auto& immediate_attribute_id = g_state.immediate.current_attribute;
 
-            // TODO: Verify that this actually modifies the register!
-            if (setup.index < 15) {
-                g_state.input_default_attributes.attr[setup.index] = attribute;
-                setup.index++;
+            immediate_input.attr[immediate_attribute_id] = attribute;
+
+            if (immediate_attribute_id < regs.pipeline.max_input_attrib_index) {
+                immediate_attribute_id += 1;
             } else {
-                // Put each attribute into an immediate input buffer.  When all specified immediate
-                // attributes are present, the Vertex Shader is invoked and everything is sent to
-                // the primitive assembler.
-
-                auto& immediate_input = g_state.immediate.input_vertex;
-                auto& immediate_attribute_id = g_state.immediate.current_attribute;
-
-                immediate_input.attr[immediate_attribute_id] = attribute;
-
-                if (immediate_attribute_id < regs.pipeline.max_input_attrib_index) {
-                    immediate_attribute_id += 1;
-                } else {
-                    MICROPROFILE_SCOPE(GPU_Drawing);
-                    immediate_attribute_id = 0;
-
-                    Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
-
-                    auto* shader_engine = Shader::GetEngine();
-                    shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
-
-                    // Send to vertex shader
-                    if (g_debug_context)
-                        g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
-                                                 static_cast<void*>(&immediate_input));
-                    Shader::UnitState shader_unit;
-                    Shader::AttributeBuffer output{};
-
-                    shader_unit.LoadInput(regs.vs, immediate_input);
-                    shader_engine->Run(g_state.vs, shader_unit);
-                    shader_unit.WriteOutput(regs.vs, output);
-
-                    // Send to geometry pipeline
-                    if (g_state.immediate.reset_geometry_pipeline) {
-                        g_state.geometry_pipeline.Reconfigure();
-                        g_state.immediate.reset_geometry_pipeline = false;
-                    }
-                    ASSERT(!g_state.geometry_pipeline.NeedIndexInput());
-                    g_state.geometry_pipeline.Setup(shader_engine);
-                    g_state.geometry_pipeline.SubmitVertex(output);
-
-                    // TODO: If drawing after every immediate mode triangle kills performance,
-                    // change it to flush triangles whenever a drawing config register changes
-                    // See: https://github.com/citra-emu/citra/pull/2866#issuecomment-327011550
-                    VideoCore::g_renderer->Rasterizer()->DrawTriangles();
-                    if (g_debug_context) {
-                        g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch,
-                                                 nullptr);
-                    }
+                MICROPROFILE_SCOPE(GPU_Drawing);
+                immediate_attribute_id = 0;
+
+                Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
+
+                auto* shader_engine = Shader::GetEngine();
+                shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
+
+                // Send to vertex shader
+                if (g_debug_context)
+                    g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
+                                             static_cast<void*>(&immediate_input));
+                Shader::UnitState shader_unit;
+                Shader::AttributeBuffer output{};
+
+                shader_unit.LoadInput(regs.vs, immediate_input);
+                shader_engine->Run(g_state.vs, shader_unit);
+                vertices_shaded_cpu.Add();
+                shader_unit.WriteOutput(regs.vs, output);
+
+                // Send to geometry pipeline
+                if (g_state.immediate.reset_geometry_pipeline) {
+                    g_state.geometry_pipeline.Reconfigure();
+                    g_state.immediate.reset_geometry_pipeline = false;
+                }
+                ASSERT(!g_state.geometry_pipeline.NeedIndexInput());
+                g_state.geometry_pipeline.Setup(shader_engine);
+                g_state.geometry_pipeline.SubmitVertex(output);
+
+                // TODO: If drawing after every immediate mode triangle kills performance,
+                // change it to flush triangles whenever a drawing config register changes
+                // See: https://github.com/citra-emu/citra/pull/2866#issuecomment-327011550
+                VideoCore::g_renderer->Rasterizer()->DrawTriangles();
+                if (g_debug_context) {
+                    g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch,
+                                             nullptr);
                 }
             }
         }
-        break;
     }
+}
 
-    case PICA_REG_INDEX(pipeline.gpu_mode):
-        // This register likely just enables vertex processing and doesn't need any special handling
-        break;
+static void HandleCommandBufferTrigger(u32 id, u32 value) {
+    auto& regs = g_state.regs;
+    unsigned index = static_cast<unsigned>(id - PICA_REG_INDEX(pipeline.command_buffer.trigger[0]));
+    u32* head_ptr = (u32*)VideoCore::g_memory->GetPhysicalPointer(
+        regs.pipeline.command_buffer.GetPhysicalAddress(index));
+    g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = head_ptr;
+    g_state.cmd_list.length = regs.pipeline.command_buffer.GetSize(index) / sizeof(u32);
+}
 
-    case PICA_REG_INDEX_WORKAROUND(pipeline.command_buffer.trigger[0], 0x23c):
-    case PICA_REG_INDEX_WORKAROUND(pipeline.command_buffer.trigger[1], 0x23d): {
-        unsigned index =
-            static_cast<unsigned>(id - PICA_REG_INDEX(pipeline.command_buffer.trigger[0]));
-        u32* head_ptr = (u32*)VideoCore::g_memory->GetPhysicalPointer(
-            regs.pipeline.command_buffer.GetPhysicalAddress(index));
-        g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = head_ptr;
-        g_state.cmd_list.length = regs.pipeline.command_buffer.GetSize(index) / sizeof(u32);
-        break;
-    }
+// It seems like these trigger vertex rendering
+static void HandleDraw(u32 id, u32 value) {
+    auto& regs = g_state.regs;
 
-    // It seems like these trigger vertex rendering
-    case PICA_REG_INDEX(pipeline.trigger_draw):
-    case PICA_REG_INDEX(pipeline.trigger_draw_indexed): {
-        MICROPROFILE_SCOPE(GPU_Drawing);
+    MICROPROFILE_SCOPE(GPU_Drawing);
+    draws.Add();
 
 #if PICA_LOG_TEV
-        DebugUtils::DumpTevStageConfig(regs.GetTevStages());
+    DebugUtils::DumpTevStageConfig(regs.GetTevStages());
 #endif
-        if (g_debug_context)
-            g_debug_context->OnEvent(DebugContext::Event::IncomingPrimitiveBatch, nullptr);
+    if (g_debug_context)
+        g_debug_context->OnEvent(DebugContext::Event::IncomingPrimitiveBatch, nullptr);
 
-        PrimitiveAssembler<Shader::OutputVertex>& primitive_assembler = g_state.primitive_assembler;
+    PrimitiveAssembler<Shader::OutputVertex>& primitive_assembler = g_state.primitive_assembler;
 
-        bool accelerate_draw = VideoCore::g_hw_shader_enabled && primitive_assembler.IsEmpty();
+    bool accelerate_draw = VideoCore::g_hw_shader_enabled && primitive_assembler.IsEmpty();
 
-        if (regs.pipeline.use_gs == PipelineRegs::UseGS::No) {
-            auto topology = primitive_assembler.GetTopology();
-            if (topology == PipelineRegs::TriangleTopology::Shader ||
-                topology == PipelineRegs::TriangleTopology::List) {
-                accelerate_draw = accelerate_draw && (regs.pipeline.num_vertices % 3) == 0;
-            }
-            // TODO (wwylele): for Strip/Fan topology, if the primitive assember is not restarted
-            // after this draw call, the buffered vertex from this draw should "leak" to the next
-            // draw, in which case we should buffer the vertex into the software primitive assember,
-            // or disable accelerate draw completely. However, there is not game found yet that does
-            // this, so this is left unimplemented for now. Revisit this when an issue is found in
-            // games.
-        } else {
-            if (VideoCore::g_hw_shader_accurate_gs) {
-                accelerate_draw = false;
-            }
+    if (regs.pipeline.use_gs == PipelineRegs::UseGS::No) {
+        auto topology = primitive_assembler.GetTopology();
+        if (topology == PipelineRegs::TriangleTopology::Shader ||
+            topology == PipelineRegs::TriangleTopology::List) {
+            accelerate_draw = accelerate_draw && (regs.pipeline.num_vertices % 3) == 0;
         }
+        // TODO (wwylele): for Strip/Fan topology, if the primitive assember is not restarted
+        // after this draw call, the buffered vertex from this draw should "leak" to the next
+        // draw, in which case we should buffer the vertex into the software primitive assember,
+        // or disable accelerate draw completely. However, there is not game found yet that does
+        // this, so this is left unimplemented for now. Revisit this when an issue is found in
+        // games.
+    } else {
+        if (VideoCore::g_hw_shader_accurate_gs) {
+            accelerate_draw = false;
+        }
+    }
 
-        bool is_indexed = (id == PICA_REG_INDEX(pipeline.trigger_draw_indexed));
+    bool is_indexed = (id == PICA_REG_INDEX(pipeline.trigger_draw_indexed));
 
-        if (accelerate_draw &&
-            VideoCore::g_renderer->Rasterizer()->AccelerateDrawBatch(is_indexed)) {
-            if (g_debug_context) {
-                g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
-            }
-            break;
+    if (accelerate_draw &&
+        VideoCore::g_renderer->Rasterizer()->AccelerateDrawBatch(is_indexed)) {
+        vertices_shaded_host.Add(regs.pipeline.num_vertices);
+        if (g_debug_context) {
+            g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
         }
+        return;
+    }
 
-        // Processes information about internal vertex attributes to figure out how a vertex is
-        // loaded.
-        // Later, these can be compiled and cached.
-        const u32 base_address = regs.pipeline.vertex_attributes.GetPhysicalBaseAddress();
-        VertexLoader loader(regs.pipeline);
-        Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
-
-        // Load vertices
-        const auto& index_info = regs.pipeline.index_array;
-        const u8* index_address_8 =
-            VideoCore::g_memory->GetPhysicalPointer(base_address + index_info.offset);
-        const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
-        bool index_u16 = index_info.format != 0;
-
-        if (g_debug_context && g_debug_context->recorder) {
-            for (int i = 0; i < 3; ++i) {
-                const auto texture = regs.texturing.GetTextures()[i];
-                if (!texture.enabled)
-                    continue;
-
-                u8* texture_data =
-                    VideoCore::g_memory->GetPhysicalPointer(texture.config.GetPhysicalAddress());
-                g_debug_context->recorder->MemoryAccessed(
-                    texture_data,
-                    Pica::TexturingRegs::NibblesPerPixel(texture.format) * texture.config.width /
-                        2 * texture.config.height,
-                    texture.config.GetPhysicalAddress());
-            }
+    // Processes information about internal vertex attributes to figure out how a vertex is
+    // loaded.
+    // Later, these can be compiled and cached.
+    const u32 base_address = regs.pipeline.vertex_attributes.GetPhysicalBaseAddress();
+    VertexLoader loader(regs.pipeline);
+    Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
+
+    // Load vertices
+    const auto& index_info = regs.pipeline.index_array;
+    const u8* index_address_8 =
+        VideoCore::g_memory->GetPhysicalPointer(base_address + index_info.offset);
+    const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
+    bool index_u16 = index_info.format != 0;
+
+    if (g_debug_context && g_debug_context->recorder) {
+        for (int i = 0; i < 3; ++i) {
+            const auto texture = regs.texturing.GetTextures()[i];
+            if (!texture.enabled)
+                continue;
+
+            u8* texture_data =
+                VideoCore::g_memory->GetPhysicalPointer(texture.config.GetPhysicalAddress());
+            g_debug_context->recorder->MemoryAccessed(
+                texture_data,
+                Pica::TexturingRegs::NibblesPerPixel(texture.format) * texture.config.width /
+                    2 * texture.config.height,
+                texture.config.GetPhysicalAddress());
         }
+    }
 
-        DebugUtils::MemoryAccessTracker memory_accesses;
+    DebugUtils::MemoryAccessTracker memory_accesses;
 
-        // Simple circular-replacement vertex cache
-        // The size has been tuned for optimal balance between hit-rate and the cost of lookup
-        const std::size_t VERTEX_CACHE_SIZE = 32;
-        std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-        std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-        std::array<Shader::AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
-        Shader::AttributeBuffer vs_output;
+    // Simple circular-replacement vertex cache
+    // The size has been tuned for optimal balance between hit-rate and the cost of lookup
+    const std::size_t VERTEX_CACHE_SIZE = 32;
+    std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
+    std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
+    std::array<Shader::AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
+    Shader::AttributeBuffer vs_output;
 
-        unsigned int vertex_cache_pos = 0;
+    unsigned int vertex_cache_pos = 0;
 
-        auto* shader_engine = Shader::GetEngine();
-        Shader::UnitState shader_unit;
+    auto* shader_engine = Shader::GetEngine();
+    Shader::UnitState shader_unit;
 
-        shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
+    shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
 
-        g_state.geometry_pipeline.Reconfigure();
-        g_state.geometry_pipeline.Setup(shader_engine);
-        if (g_state.geometry_pipeline.NeedIndexInput())
-            ASSERT(is_indexed);
+    g_state.geometry_pipeline.Reconfigure();
+    g_state.geometry_pipeline.Setup(shader_engine);
+    if (g_state.geometry_pipeline.NeedIndexInput())
+        ASSERT(is_indexed);
 
-        for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
-            // Indexed rendering doesn't use the start offset
-            unsigned int vertex =
-                is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                           : (index + regs.pipeline.vertex_offset);
+    for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
+        // Indexed rendering doesn't use the start offset
+        unsigned int vertex =
+            is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                       : (index + regs.pipeline.vertex_offset);
 
-            bool vertex_cache_hit = false;
+        bool vertex_cache_hit = false;
 
-            if (is_indexed) {
-                if (g_state.geometry_pipeline.NeedIndexInput()) {
-                    g_state.geometry_pipeline.SubmitIndex(vertex);
-                    continue;
-                }
+        if (is_indexed) {
+            if (g_state.geometry_pipeline.NeedIndexInput()) {
+                g_state.geometry_pipeline.SubmitIndex(vertex);
+                continue;
+            }
 
-                if (g_debug_context && Pica::g_debug_context->recorder) {
-                    int size = index_u16 ? 2 : 1;
-                    memory_accesses.AddAccess(base_address + index_info.offset + size * index,
-                                              size);
-                }
+            if (g_debug_context && Pica::g_debug_context->recorder) {
+                int size = index_u16 ? 2 : 1;
+                memory_accesses.AddAccess(base_address + index_info.offset + size * index,
+                                          size);
+            }
 
-                for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                    if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                        vs_output = vertex_cache[i];
-                        vertex_cache_hit = true;
-                        break;
-                    }
+            for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
+                if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
+                    vs_output = vertex_cache[i];
+                    vertex_cache_hit = true;
+                    break;
                 }
             }
+        }
 
-            if (!vertex_cache_hit) {
-                // Initialize data for the current vertex
-                Shader::AttributeBuffer input;
-                loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
+        if (!vertex_cache_hit) {
+            // Initialize data for the current vertex
+            Shader::AttributeBuffer input;
+            loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
 
-                // Send to vertex shader
-                if (g_debug_context)
-                    g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
-                                             (void*)&input);
-                shader_unit.LoadInput(regs.vs, input);
-                shader_engine->Run(g_state.vs, shader_unit);
-                shader_unit.WriteOutput(regs.vs, vs_output);
+            // Send to vertex shader
+            if (g_debug_context)
+                g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
+                                         (void*)&input);
+            shader_unit.LoadInput(regs.vs, input);
+            shader_engine->Run(g_state.vs, shader_unit);
+            vertices_shaded_cpu.Add();
+            shader_unit.WriteOutput(regs.vs, vs_output);
 
-                if (is_indexed) {
-                    vertex_cache[vertex_cache_pos] = vs_output;
-                    vertex_cache_valid[vertex_cache_pos] = true;
-                    vertex_cache_ids[vertex_cache_pos] = vertex;
-                    vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
-                }
+            if (is_indexed) {
+                vertex_cache[vertex_cache_pos] = vs_output;
+                vertex_cache_valid[vertex_cache_pos] = true;
+                vertex_cache_ids[vertex_cache_pos] = vertex;
+                vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
             }
-
-            // Send to geometry pipeline
-            g_state.geometry_pipeline.SubmitVertex(vs_output);
         }
 
-        for (auto& range : memory_accesses.ranges) {
-            g_debug_context->recorder->MemoryAccessed(
-                VideoCore::g_memory->GetPhysicalPointer(range.first), range.second, range.first);
-        }
+        // Send to geometry pipeline
+        g_state.geometry_pipeline.SubmitVertex(vs_output);
+    }
 
-        VideoCore::g_renderer->Rasterizer()->DrawTriangles();
-        if (g_debug_context) {
-            g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
-        }
+    for (auto& range : memory_accesses.ranges) {
+        g_debug_context->recorder->MemoryAccessed(
+            VideoCore::g_memory->GetPhysicalPointer(range.first), range.second, range.first);
+    }
 
-        break;
+    VideoCore::g_renderer->Rasterizer()->DrawTriangles();
+    if (g_debug_context) {
+        g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
     }
+}
 
-    case PICA_REG_INDEX(gs.bool_uniforms):
-        WriteUniformBoolReg(g_state.gs, g_state.regs.gs.bool_uniforms.Value());
-        break;
+static void HandleGSBoolUniforms(u32 id, u32 value) {
+    WriteUniformBoolReg(g_state.gs, g_state.regs.gs.bool_uniforms.Value());
+}
 
-    case PICA_REG_INDEX_WORKAROUND(gs.int_uniforms[0], 0x281):
-    case PICA_REG_INDEX_WORKAROUND(gs.int_uniforms[1], 0x282):
-    case PICA_REG_INDEX_WORKAROUND(gs.int_uniforms[2], 0x283):
-    case PICA_REG_INDEX_WORKAROUND(gs.int_uniforms[3], 0x284): {
-        unsigned index = (id - PICA_REG_INDEX_WORKAROUND(gs.int_uniforms[0], 0x281));
-        auto values = regs.gs.int_uniforms[index];
-        WriteUniformIntReg(g_state.gs, index,
-                           Math::Vec4<u8>(values.x, values.y, values.z, values.w));
-        break;
+static void HandleGSIntUniforms(u32 id, u32 value) {
+    unsigned index = (id - PICA_REG_INDEX_WORKAROUND(gs.int_uniforms[0], 0x281));
+    auto values = g_state.regs.gs.int_uniforms[index];
+    WriteUniformIntReg(g_state.gs, index, Math::Vec4<u8>(values.x, values.y, values.z, values.w));
+}
+
+static void HandleGSFloatUniforms(u32 id, u32 value) {
+    WriteUniformFloatReg(g_state.regs.gs, g_state.gs, gs_float_regs_counter,
+                         gs_uniform_write_buffer, value);
+}
+
+static void HandleGSProgram(u32 id, u32 value) {
+    u32& offset = g_state.regs.gs.program.offset;
+    if (offset >= 4096) {
+        LOG_ERROR(HW_GPU, "Invalid GS program offset {}", offset);
+    } else {
+        g_state.gs.program_code[offset] = value;
+        g_state.gs.MarkProgramCodeDirty();
+        offset++;
     }
+}
 
-    case PICA_REG_INDEX_WORKAROUND(gs.uniform_setup.set_value[0], 0x291):
-    case PICA_REG_INDEX_WORKAROUND(gs.uniform_setup.set_value[1], 0x292):
-    case PICA_REG_INDEX_WORKAROUND(gs.uniform_setup.set_value[2], 0x293):
-    case PICA_REG_INDEX_WORKAROUND(gs.uniform_setup.set_value[3], 0x294):
-    case PICA_REG_INDEX_WORKAROUND(gs.uniform_setup.set_value[4], 0x295):
-    case PICA_REG_INDEX_WORKAROUND(gs.uniform_setup.set_value[5], 0x296):
-    case PICA_REG_INDEX_WORKAROUND(gs.uniform_setup.set_value[6], 0x297):
-    case PICA_REG_INDEX_WORKAROUND(gs.uniform_setup.set_value[7], 0x298): {
-        WriteUniformFloatReg(g_state.regs.gs, g_state.gs, gs_float_regs_counter,
-                             gs_uniform_write_buffer, value);
-        break;
+static void HandleGSSwizzlePatterns(u32 id, u32 value) {
+    u32& offset = g_state.regs.gs.swizzle_patterns.offset;
+    if (offset >= g_state.gs.swizzle_data.size()) {
+        LOG_ERROR(HW_GPU, "Invalid GS swizzle pattern offset {}", offset);
+    } else {
+        g_state.gs.swizzle_data[offset] = value;
+        g_state.gs.MarkSwizzleDataDirty();
+        offset++;
     }
+}
 
-    case PICA_REG_INDEX_WORKAROUND(gs.program.set_word[0], 0x29c):
-    case PICA_REG_INDEX_WORKAROUND(gs.program.set_word[1], 0x29d):
-    case PICA_REG_INDEX_WORKAROUND(gs.program.set_word[2], 0x29e):
-    case PICA_REG_INDEX_WORKAROUND(gs.program.set_word[3], 0x29f):
-    case PICA_REG_INDEX_WORKAROUND(gs.program.set_word[4], 0x2a0):
-    case PICA_REG_INDEX_WORKAROUND(gs.program.set_word[5], 0x2a1):
-    case PICA_REG_INDEX_WORKAROUND(gs.program.set_word[6], 0x2a2):
-    case PICA_REG_INDEX_WORKAROUND(gs.program.set_word[7], 0x2a3): {
-        u32& offset = g_state.regs.gs.program.offset;
-        if (offset >= 4096) {
-            LOG_ERROR(HW_GPU, "Invalid GS program offset {}", offset);
-        } else {
+static void HandleVSBoolUniforms(u32 id, u32 value) {
+    // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
+    WriteUniformBoolReg(g_state.vs, g_state.regs.vs.bool_uniforms.Value());
+}
+
+static void HandleVSIntUniforms(u32 id, u32 value) {
+    // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
+    unsigned index = (id - PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[0], 0x2b1));
+    auto values = g_state.regs.vs.int_uniforms[index];
+    WriteUniformIntReg(g_state.vs, index, Math::Vec4<u8>(values.x, values.y, values.z, values.w));
+}
+
+static void HandleVSFloatUniforms(u32 id, u32 value) {
+    // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
+    WriteUniformFloatReg(g_state.regs.vs, g_state.vs, vs_float_regs_counter,
+                         vs_uniform_write_buffer, value);
+}
+
+static void HandleVSProgram(u32 id, u32 value) {
+    u32& offset = g_state.regs.vs.program.offset;
+    if (offset >= 512) {
+        LOG_ERROR(HW_GPU, "Invalid VS program offset {}", offset);
+    } else {
+        g_state.vs.program_code[offset] = value;
+        g_state.vs.MarkProgramCodeDirty();
+        if (!g_state.regs.pipeline.gs_unit_exclusive_configuration) {
             g_state.gs.program_code[offset] = value;
             g_state.gs.MarkProgramCodeDirty();
-            offset++;
         }
-        break;
+        offset++;
     }
+}
 
-    case PICA_REG_INDEX_WORKAROUND(gs.swizzle_patterns.set_word[0], 0x2a6):
-    case PICA_REG_INDEX_WORKAROUND(gs.swizzle_patterns.set_word[1], 0x2a7):
-    case PICA_REG_INDEX_WORKAROUND(gs.swizzle_patterns.set_word[2], 0x2a8):
-    case PICA_REG_INDEX_WORKAROUND(gs.swizzle_patterns.set_word[3], 0x2a9):
-    case PICA_REG_INDEX_WORKAROUND(gs.swizzle_patterns.set_word[4], 0x2aa):
-    case PICA_REG_INDEX_WORKAROUND(gs.swizzle_patterns.set_word[5], 0x2ab):
-    case PICA_REG_INDEX_WORKAROUND(gs.swizzle_patterns.set_word[6], 0x2ac):
-    case PICA_REG_INDEX_WORKAROUND(gs.swizzle_patterns.set_word[7], 0x2ad): {
-        u32& offset = g_state.regs.gs.swizzle_patterns.offset;
-        if (offset >= g_state.gs.swizzle_data.size()) {
-            LOG_ERROR(HW_GPU, "Invalid GS swizzle pattern offset {}", offset);
-        } else {
+static void HandleVSSwizzlePatterns(u32 id, u32 value) {
+    u32& offset = g_state.regs.vs.swizzle_patterns.offset;
+    if (offset >= g_state.vs.swizzle_data.size()) {
+        LOG_ERROR(HW_GPU, "Invalid VS swizzle pattern offset {}", offset);
+    } else {
+        g_state.vs.swizzle_data[offset] = value;
+        g_state.vs.MarkSwizzleDataDirty();
+        if (!g_state.regs.pipeline.gs_unit_exclusive_configuration) {
             g_state.gs.swizzle_data[offset] = value;
             g_state.gs.MarkSwizzleDataDirty();
-            offset++;
         }
-        break;
+        offset++;
     }
+}
 
-    case PICA_REG_INDEX(vs.bool_uniforms):
-        // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
-        WriteUniformBoolReg(g_state.vs, g_state.regs.vs.bool_uniforms.Value());
-        break;
+static void HandleLightingLutData(u32 id, u32 value) {
+    auto& lut_config = g_state.regs.lighting.lut_config;
 
-    case PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[0], 0x2b1):
-    case PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[1], 0x2b2):
-    case PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[2], 0x2b3):
-    case PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[3], 0x2b4): {
-        // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
-        unsigned index = (id - PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[0], 0x2b1));
-        auto values = regs.vs.int_uniforms[index];
-        WriteUniformIntReg(g_state.vs, index,
-                           Math::Vec4<u8>(values.x, values.y, values.z, values.w));
-        break;
-    }
+    ASSERT_MSG(lut_config.index < 256, "lut_config.index exceeded maximum value of 255!");
 
-    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[0], 0x2c1):
-    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[1], 0x2c2):
-    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[2], 0x2c3):
-    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[3], 0x2c4):
-    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[4], 0x2c5):
-    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[5], 0x2c6):
-    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[6], 0x2c7):
-    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[7], 0x2c8): {
-        // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
-        WriteUniformFloatReg(g_state.regs.vs, g_state.vs, vs_float_regs_counter,
-                             vs_uniform_write_buffer, value);
-        break;
-    }
+    g_state.lighting.luts[lut_config.type][lut_config.index].raw = value;
+    lut_config.index.Assign(lut_config.index + 1);
+    g_state.dirty_lighting_luts |= 1U << lut_config.type;
+}
 
-    case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[0], 0x2cc):
-    case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[1], 0x2cd):
-    case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[2], 0x2ce):
-    case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[3], 0x2cf):
-    case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[4], 0x2d0):
-    case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[5], 0x2d1):
-    case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[6], 0x2d2):
-    case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[7], 0x2d3): {
-        u32& offset = g_state.regs.vs.program.offset;
-        if (offset >= 512) {
-            LOG_ERROR(HW_GPU, "Invalid VS program offset {}", offset);
-        } else {
-            g_state.vs.program_code[offset] = value;
-            g_state.vs.MarkProgramCodeDirty();
-            if (!g_state.regs.pipeline.gs_unit_exclusive_configuration) {
-                g_state.gs.program_code[offset] = value;
-                g_state.gs.MarkProgramCodeDirty();
-            }
-            offset++;
-        }
+static void HandleFogLutData(u32 id, u32 value) {
+    auto& regs = g_state.regs;
+    g_state.fog.lut[regs.texturing.fog_lut_offset % 128].raw = value;
+    regs.texturing.fog_lut_offset.Assign(regs.texturing.fog_lut_offset + 1);
+}
+
+static void HandleProcTexLutData(u32 id, u32 value) {
+    auto& regs = g_state.regs;
+    auto& index = regs.texturing.proctex_lut_config.index;
+    auto& pt = g_state.proctex;
+
+    switch (regs.texturing.proctex_lut_config.ref_table.Value()) {
+    case TexturingRegs::ProcTexLutTable::Noise:
+        pt.noise_table[index % pt.noise_table.size()].raw = value;
+        break;
+    case TexturingRegs::ProcTexLutTable::ColorMap:
+        pt.color_map_table[index % pt.color_map_table.size()].raw = value;
+        break;
+    case TexturingRegs::ProcTexLutTable::AlphaMap:
+        pt.alpha_map_table[index % pt.alpha_map_table.size()].raw = value;
+        break;
+    case TexturingRegs::ProcTexLutTable::Color:
+        pt.color_table[index % pt.color_table.size()].raw = value;
+        break;
+    case TexturingRegs::ProcTexLutTable::ColorDiff:
+        pt.color_diff_table[index % pt.color_diff_table.size()].raw = value;
         break;
     }
+    index.Assign(index + 1);
+    const auto table = static_cast<u32>(regs.texturing.proctex_lut_config.ref_table.Value());
+    g_state.dirty_groups |= DirtyState::ProcTexLut << table;
+}
 
-    case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[0], 0x2d6):
-    case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[1], 0x2d7):
-    case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[2], 0x2d8):
-    case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[3], 0x2d9):
-    case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[4], 0x2da):
-    case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[5], 0x2db):
-    case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[6], 0x2dc):
-    case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[7], 0x2dd): {
-        u32& offset = g_state.regs.vs.swizzle_patterns.offset;
-        if (offset >= g_state.vs.swizzle_data.size()) {
-            LOG_ERROR(HW_GPU, "Invalid VS swizzle pattern offset {}", offset);
-        } else {
-            g_state.vs.swizzle_data[offset] = value;
-            g_state.vs.MarkSwizzleDataDirty();
-            if (!g_state.regs.pipeline.gs_unit_exclusive_configuration) {
-                g_state.gs.swizzle_data[offset] = value;
-                g_state.gs.MarkSwizzleDataDirty();
-            }
-            offset++;
-        }
-        break;
+/// What a register write does besides updating the register
+struct RegWriteInfo {
+    /// Called after the register has been updated, nullptr for registers without side effects
+    RegWriteHandler handler = nullptr;
+    /// DirtyState groups the rasterizer has to resync before the next draw
+    u64 dirty_groups = 0;
+};
+
+/// Builds the table of side effects of register writes, indexed by register.
+static constexpr std::array<RegWriteInfo, Regs::NUM_REGS> MakeRegWriteTable() {
+    std::array<RegWriteInfo, Regs::NUM_REGS> table{};
+    const auto set_handler = [&table](std::size_t first_id, std::size_t count,
+                                      RegWriteHandler handler) {
+        for (std::size_t i = 0; i < count; ++i)
+            table[first_id + i].handler = handler;
+    };
+    const auto set_dirty = [&table](std::size_t first_id, std::size_t count, u64 groups) {
+        for (std::size_t i = 0; i < count; ++i)
+            table[first_id + i].dirty_groups |= groups;
+    };
+
+    set_handler(PICA_REG_INDEX(trigger_irq), 1, HandleTriggerIrq);
+    set_handler(PICA_REG_INDEX(pipeline.triangle_topology), 1, HandleTriangleTopology);
+    set_handler(PICA_REG_INDEX(pipeline.restart_primitive), 1, HandleRestartPrimitive);
+    set_handler(PICA_REG_INDEX(pipeline.vs_default_attributes_setup.index), 1,
+                HandleDefaultAttributeIndex);
+    set_handler(PICA_REG_INDEX_WORKAROUND(pipeline.vs_default_attributes_setup.set_value[0], 0x233),
+                3, HandleDefaultAttributeValue);
+    set_handler(PICA_REG_INDEX_WORKAROUND(pipeline.command_buffer.trigger[0], 0x23c), 2,
+                HandleCommandBufferTrigger);
+    set_handler(PICA_REG_INDEX(pipeline.trigger_draw), 1, HandleDraw);
+    set_handler(PICA_REG_INDEX(pipeline.trigger_draw_indexed), 1, HandleDraw);
+
+    set_handler(PICA_REG_INDEX(gs.bool_uniforms), 1, HandleGSBoolUniforms);
+    set_handler(PICA_REG_INDEX_WORKAROUND(gs.int_uniforms[0], 0x281), 4, HandleGSIntUniforms);
+    set_handler(PICA_REG_INDEX_WORKAROUND(gs.uniform_setup.set_value[0], 0x291), 8,
+                HandleGSFloatUniforms);
+    set_handler(PICA_REG_INDEX_WORKAROUND(gs.program.set_word[0], 0x29c), 8, HandleGSProgram);
+    set_handler(PICA_REG_INDEX_WORKAROUND(gs.swizzle_patterns.set_word[0], 0x2a6), 8,
+                HandleGSSwizzlePatterns);
+
+    set_handler(PICA_REG_INDEX(vs.bool_uniforms), 1, HandleVSBoolUniforms);
+    set_handler(PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[0], 0x2b1), 4, HandleVSIntUniforms);
+    set_handler(PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[0], 0x2c1), 8,
+                HandleVSFloatUniforms);
+    set_handler(PICA_REG_INDEX_WORKAROUND(vs.program.set_word[0], 0x2cc), 8, HandleVSProgram);
+    set_handler(PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[0], 0x2d6), 8,
+                HandleVSSwizzlePatterns);
+
+    set_handler(PICA_REG_INDEX_WORKAROUND(lighting.lut_data[0], 0x1c8), 8, HandleLightingLutData);
+    set_handler(PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[0], 0xe8), 8, HandleFogLutData);
+    set_handler(PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[0], 0xb0), 8,
+                HandleProcTexLutData);
+
+    // The lookup table handlers mark the written table dirty themselves
+
+    set_dirty(PICA_REG_INDEX(rasterizer.cull_mode), 1, DirtyState::CullMode);
+    set_dirty(PICA_REG_INDEX(rasterizer.clip_enable), 1, DirtyState::ClipEnabled);
+    set_dirty(PICA_REG_INDEX_WORKAROUND(rasterizer.clip_coef[0], 0x48), 4, DirtyState::ClipCoef);
+    set_dirty(PICA_REG_INDEX(rasterizer.viewport_depth_range), 1, DirtyState::DepthScale);
+    set_dirty(PICA_REG_INDEX(rasterizer.viewport_depth_near_plane), 1, DirtyState::DepthOffset);
+    set_dirty(PICA_REG_INDEX(rasterizer.depthmap_enable), 1, DirtyState::ShaderConfig);
+    set_dirty(PICA_REG_INDEX(rasterizer.scissor_test.mode), 1, DirtyState::ShaderConfig);
+
+    set_dirty(PICA_REG_INDEX(framebuffer.output_merger.alphablend_enable), 1,
+              DirtyState::BlendEnabled);
+    set_dirty(PICA_REG_INDEX(framebuffer.output_merger.alpha_blending), 1,
+              DirtyState::BlendFuncs);
+    set_dirty(PICA_REG_INDEX(framebuffer.output_merger.blend_const), 1, DirtyState::BlendColor);
+    set_dirty(PICA_REG_INDEX(framebuffer.output_merger.logic_op), 1, DirtyState::LogicOp);
+    set_dirty(PICA_REG_INDEX(framebuffer.output_merger.alpha_test), 1,
+              DirtyState::AlphaTest | DirtyState::ShaderConfig);
+    set_dirty(PICA_REG_INDEX(framebuffer.output_merger.stencil_test.raw_func), 1,
+              DirtyState::StencilTest | DirtyState::StencilWriteMask);
+    set_dirty(PICA_REG_INDEX(framebuffer.output_merger.stencil_test.raw_op), 1,
+              DirtyState::StencilTest);
+    set_dirty(PICA_REG_INDEX(framebuffer.output_merger.depth_test_enable), 1,
+              DirtyState::DepthTest | DirtyState::DepthWriteMask | DirtyState::ColorWriteMask);
+    set_dirty(PICA_REG_INDEX(framebuffer.framebuffer.depth_format), 1, DirtyState::StencilTest);
+    set_dirty(PICA_REG_INDEX(framebuffer.framebuffer.allow_depth_stencil_write), 1,
+              DirtyState::DepthWriteMask | DirtyState::StencilWriteMask);
+    set_dirty(PICA_REG_INDEX(framebuffer.framebuffer.allow_color_write), 1,
+              DirtyState::ColorWriteMask);
+    set_dirty(PICA_REG_INDEX(framebuffer.shadow), 1, DirtyState::ShadowBias);
+
+    set_dirty(PICA_REG_INDEX(texturing.main_config), 1, DirtyState::ShaderConfig);
+    set_dirty(PICA_REG_INDEX(texturing.texture0.type), 1, DirtyState::ShaderConfig);
+    set_dirty(PICA_REG_INDEX(texturing.fog_color), 1, DirtyState::FogColor);
+    set_dirty(PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[0], 0xe8), 8, DirtyState::FogLut);
+    set_dirty(PICA_REG_INDEX(texturing.proctex), 1,
+              DirtyState::ProcTexBias | DirtyState::ShaderConfig);
+    set_dirty(PICA_REG_INDEX(texturing.proctex_lut), 1,
+              DirtyState::ProcTexBias | DirtyState::ShaderConfig);
+    set_dirty(PICA_REG_INDEX(texturing.proctex_lut_offset), 1,
+              DirtyState::ProcTexBias | DirtyState::ShaderConfig);
+    set_dirty(PICA_REG_INDEX(texturing.proctex_noise_u), 1, DirtyState::ProcTexNoise);
+    set_dirty(PICA_REG_INDEX(texturing.proctex_noise_v), 1, DirtyState::ProcTexNoise);
+    set_dirty(PICA_REG_INDEX(texturing.proctex_noise_frequency), 1, DirtyState::ProcTexNoise);
+
+    constexpr std::array<std::size_t, 6> tev_stages{{
+        PICA_REG_INDEX(texturing.tev_stage0),
+        PICA_REG_INDEX(texturing.tev_stage1),
+        PICA_REG_INDEX(texturing.tev_stage2),
+        PICA_REG_INDEX(texturing.tev_stage3),
+        PICA_REG_INDEX(texturing.tev_stage4),
+        PICA_REG_INDEX(texturing.tev_stage5),
+    }};
+    for (std::size_t stage = 0; stage < tev_stages.size(); ++stage) {
+        // Sources, modifiers and operations, the constant color and the scales
+        set_dirty(tev_stages[stage], 3, DirtyState::ShaderConfig);
+        set_dirty(tev_stages[stage] + 3, 1, DirtyState::TevConstColor << stage);
+        set_dirty(tev_stages[stage] + 4, 1, DirtyState::ShaderConfig);
+    }
+    set_dirty(PICA_REG_INDEX(texturing.tev_combiner_buffer_input), 1, DirtyState::ShaderConfig);
+    set_dirty(PICA_REG_INDEX(texturing.tev_combiner_buffer_color), 1,
+              DirtyState::CombinerColor);
+
+    for (std::size_t light = 0; light < 8; ++light) {
+        const std::size_t light_id =
+            PICA_REG_INDEX_WORKAROUND(lighting.light[0].specular_0, 0x140) + light * 0x10;
+        // Colors, position and spot direction
+        set_dirty(light_id, 8, DirtyState::Light << light);
+        set_dirty(light_id + 0x9, 1, DirtyState::ShaderConfig);
+        // Distance attenuation
+        set_dirty(light_id + 0xa, 2, DirtyState::Light << light);
     }
+    set_dirty(PICA_REG_INDEX_WORKAROUND(lighting.global_ambient, 0x1c0), 1,
+              DirtyState::GlobalAmbient);
 
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[0], 0x1c8):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[1], 0x1c9):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[2], 0x1ca):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[3], 0x1cb):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[4], 0x1cc):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[5], 0x1cd):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[6], 0x1ce):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[7], 0x1cf): {
-        auto& lut_config = regs.lighting.lut_config;
+    // pipeline.gpu_mode likely just enables vertex processing and doesn't need any special
+    // handling, so it is left as a plain register.
+    return table;
+}
 
-        ASSERT_MSG(lut_config.index < 256, "lut_config.index exceeded maximum value of 255!");
+static constexpr std::array<RegWriteInfo, Regs::NUM_REGS> reg_write_table = MakeRegWriteTable();
 
-        g_state.lighting.luts[lut_config.type][lut_config.index].raw = value;
-        lut_config.index.Assign(lut_config.index + 1);
-        break;
-    }
+/**
+ * Writes a PICA register and marks the state groups it belongs to dirty. The debug variant
+ * additionally reports the write to the PICA tracer and the debug context, it is only used while
+ * one of them observes register writes.
+ */
+template <bool debug>
+static void WritePicaReg(u32 id, u32 value, u32 mask) {
+    auto& regs = g_state.regs;
 
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[0], 0xe8):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[1], 0xe9):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[2], 0xea):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[3], 0xeb):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[4], 0xec):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[5], 0xed):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[6], 0xee):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[7], 0xef): {
-        g_state.fog.lut[regs.texturing.fog_lut_offset % 128].raw = value;
-        regs.texturing.fog_lut_offset.Assign(regs.texturing.fog_lut_offset + 1);
-        break;
+    if (id >= Regs::NUM_REGS) {
+        LOG_ERROR(
+            HW_GPU,
+            "Commandlist tried to write to invalid register 0x{:03X} (value: {:08X}, mask: {:X})",
+            id, value, mask);
+        return;
     }
 
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[0], 0xb0):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[1], 0xb1):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[2], 0xb2):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[3], 0xb3):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[4], 0xb4):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[5], 0xb5):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[6], 0xb6):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[7], 0xb7): {
-        auto& index = regs.texturing.proctex_lut_config.index;
-        auto& pt = g_state.proctex;
-
-        switch (regs.texturing.proctex_lut_config.ref_table.Value()) {
-        case TexturingRegs::ProcTexLutTable::Noise:
-            pt.noise_table[index % pt.noise_table.size()].raw = value;
-            break;
-        case TexturingRegs::ProcTexLutTable::ColorMap:
-            pt.color_map_table[index % pt.color_map_table.size()].raw = value;
-            break;
-        case TexturingRegs::ProcTexLutTable::AlphaMap:
-            pt.alpha_map_table[index % pt.alpha_map_table.size()].raw = value;
-            break;
-        case TexturingRegs::ProcTexLutTable::Color:
-            pt.color_table[index % pt.color_table.size()].raw = value;
-            break;
-        case TexturingRegs::ProcTexLutTable::ColorDiff:
-            pt.color_diff_table[index % pt.color_diff_table.size()].raw = value;
-            break;
+    // TODO: Figure out how register masking acts on e.g. vs.uniform_setup.set_value
+    const u32 old_value = regs.reg_array[id];
+    const u32 write_mask = expand_bits_to_bytes[mask];
+    const u32 new_value = (old_value & ~write_mask) | (value & write_mask);
+    regs.reg_array[id] = new_value;
+
+    if constexpr (debug) {
+        // Double check for is_pica_tracing to avoid call overhead
+        if (DebugUtils::IsPicaTracing()) {
+            DebugUtils::OnPicaRegWrite({(u16)id, (u16)mask, regs.reg_array[id]});
         }
-        index.Assign(index + 1);
-        break;
+
+        if (g_debug_context)
+            g_debug_context->OnEvent(DebugContext::Event::PicaCommandLoaded,
+                                     reinterpret_cast<void*>(&id));
     }
-    default:
-        break;
+
+    const RegWriteInfo& info = reg_write_table[id];
+    if (info.handler != nullptr) {
+        info.handler(id, value);
     }
 
-    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+    if (info.dirty_groups != 0) {
+        state_notifications.Add();
+        if ((g_state.dirty_groups & info.dirty_groups) == info.dirty_groups)
+            state_syncs_coalesced.Add();
+        g_state.dirty_groups |= info.dirty_groups;
+    }
 
-    if (g_debug_context)
-        g_debug_context->OnEvent(DebugContext::Event::PicaCommandProcessed,
-                                 reinterpret_cast<void*>(&id));
+    if constexpr (debug) {
+        if (g_debug_context)
+            g_debug_context->OnEvent(DebugContext::Event::PicaCommandProcessed,
+                                     reinterpret_cast<void*>(&id));
+    }
 }
 
-void ProcessCommandList(const u32* list, u32 size) {
-    g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = list;
-    g_state.cmd_list.length = size / sizeof(u32);
+/// Whether the PICA tracer, a register breakpoint or a trace recording needs the debug variant
+static bool IsRegWriteObserved() {
+    if (DebugUtils::IsPicaTracing())
+        return true;
+    if (!g_debug_context)
+        return false;
+    const auto& breakpoints = g_debug_context->breakpoints;
+    return breakpoints[static_cast<int>(DebugContext::Event::PicaCommandLoaded)].enabled ||
+           breakpoints[static_cast<int>(DebugContext::Event::PicaCommandProcessed)].enabled ||
+           g_debug_context->recorder != nullptr;
+}
 
+template <bool debug>
+static void RunCommandList() {
     while (g_state.cmd_list.current_ptr < g_state.cmd_list.head_ptr + g_state.cmd_list.length) {
 
         // Align read pointer to 8 bytes
@@ -666,15 +763,26 @@ void ProcessCommandList(const u32* list, u32 size) {
         u32 value = *g_state.cmd_list.current_ptr++;
         const CommandHeader header = {*g_state.cmd_list.current_ptr++};
 
-        WritePicaReg(header.cmd_id, value, header.parameter_mask);
+        WritePicaReg<debug>(header.cmd_id, value, header.parameter_mask);
 
         for (unsigned i = 0; i < header.extra_data_length; ++i) {
             u32 cmd = header.cmd_id + (header.group_commands ? i + 1 : 0);
-            WritePicaReg(cmd, *g_state.cmd_list.current_ptr++, header.parameter_mask);
+            WritePicaReg<debug>(cmd, *g_state.cmd_list.current_ptr++, header.parameter_mask);
         }
     }
 }
 
+void ProcessCommandList(const u32* list, u32 size) {
+    g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = list;
+    g_state.cmd_list.length = size / sizeof(u32);
+
+    if (IsRegWriteObserved()) {
+        RunCommandList<true>();
+    } else {
+        RunCommandList<false>();
+    }
+}
+
 } // namespace CommandProcessor
 
 } // namespace Pica
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <iterator>
+#include "core/savestate.h"
 #include "video_core/geometry_pipeline.h"
 #include "video_core/pica_state.h"
 #include "video_core/regs.h"
@@ -30,6 +32,12 @@ public:
      * @return if the buffer is full and the geometry shader should be invoked
      */
     virtual bool SubmitVertex(const Shader::AttributeBuffer& input) = 0;
+
+    /// Saves the buffered attributes and the buffer positions
+    virtual void SaveState(Core::StateWriter& writer) const = 0;
+
+    /// Restores the state saved by SaveState into a backend built from the same registers
+    virtual bool LoadState(Core::StateReader& reader) = 0;
 };
 
 // In the Point mode, vertex attributes are sent to the input registers in the geometry shader unit.
@@ -72,6 +80,21 @@ public:
         return false;
     }
 
+    void SaveState(Core::StateWriter& writer) const override {
+        writer.WriteBytes(&attribute_buffer, sizeof(attribute_buffer));
+        writer.Write(static_cast<u32>(buffer_cur - attribute_buffer.attr));
+    }
+
+    bool LoadState(Core::StateReader& reader) override {
+        u32 offset;
+        if (!reader.ReadBytes(&attribute_buffer, sizeof(attribute_buffer)) ||
+            !reader.Read(offset) || offset > static_cast<u32>(buffer_end - attribute_buffer.attr)) {
+            return false;
+        }
+        buffer_cur = attribute_buffer.attr + offset;
+        return true;
+    }
+
 private:
     const Regs& regs;
     Shader::GSUnitState& unit;
@@ -136,6 +159,33 @@ public:
         return false;
     }
 
+    void SaveState(Core::StateWriter& writer) const override {
+        writer.Write(need_index);
+        if (need_index) {
+            return;
+        }
+        writer.Write(main_vertex_num);
+        writer.Write(total_vertex_num);
+        // The attributes themselves are in the uniforms, which are saved with the shader setup
+        writer.Write(static_cast<u32>(buffer_cur - setup.uniforms.f));
+    }
+
+    bool LoadState(Core::StateReader& reader) override {
+        if (!reader.Read(need_index)) {
+            return false;
+        }
+        if (need_index) {
+            return true;
+        }
+        u32 offset;
+        if (!reader.Read(main_vertex_num) || !reader.Read(total_vertex_num) ||
+            !reader.Read(offset) || offset > std::size(setup.uniforms.f)) {
+            return false;
+        }
+        buffer_cur = setup.uniforms.f + offset;
+        return true;
+    }
+
 private:
     bool need_index = true;
     const Regs& regs;
@@ -183,6 +233,20 @@ public:
         return false;
     }
 
+    void SaveState(Core::StateWriter& writer) const override {
+        // The attributes themselves are in the uniforms, which are saved with the shader setup
+        writer.Write(static_cast<u32>(buffer_cur - buffer_begin));
+    }
+
+    bool LoadState(Core::StateReader& reader) override {
+        u32 offset;
+        if (!reader.Read(offset) || offset > static_cast<u32>(buffer_end - buffer_begin)) {
+            return false;
+        }
+        buffer_cur = buffer_begin + offset;
+        return true;
+    }
+
 private:
     const Regs& regs;
     Shader::ShaderSetup& setup;
@@ -271,4 +335,25 @@ void GeometryPipeline::SubmitVertex(const Shader::AttributeBuffer& input) {
     }
 }
 
+void GeometryPipeline::SaveState(Core::StateWriter& writer) const {
+    writer.Write(backend != nullptr);
+    if (backend) {
+        backend->SaveState(writer);
+    }
+}
+
+bool GeometryPipeline::LoadState(Core::StateReader& reader) {
+    // The current backend may hold vertices that Reconfigure would assert on
+    backend = nullptr;
+    bool has_backend;
+    if (!reader.Read(has_backend)) {
+        return false;
+    }
+    if (!has_backend) {
+        return true;
+    }
+    Reconfigure();
+    return backend && backend->LoadState(reader);
+}
+
 } // namespace Pica
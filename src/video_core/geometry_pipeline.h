@@ -7,6 +7,11 @@
 #include <memory>
 #include "video_core/shader/shader.h"
 
+namespace Core {
+class StateReader;
+class StateWriter;
+} // namespace Core
+
 namespace Pica {
 
 struct State;
@@ -40,6 +45,15 @@ public:
     /// Submits vertex attributes output from vertex shader
     void SubmitVertex(const Shader::AttributeBuffer& input);
 
+    /// Saves the vertices buffered for the next geometry shader invocation
+    void SaveState(Core::StateWriter& writer) const;
+
+    /**
+     * Restores the state saved by SaveState, reconfiguring the pipeline from the registers, which
+     * must have been loaded first. Setup must be called again before submitting vertices.
+     */
+    bool LoadState(Core::StateReader& reader);
+
 private:
     Shader::VertexHandler vertex_handler;
     Shader::ShaderEngine* shader_engine;
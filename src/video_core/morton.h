@@ -0,0 +1,185 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstring>
+#include "common/common_types.h"
+#include "video_core/utils.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
+namespace VideoCore {
+
+namespace MortonDetail {
+
+/// Moves the stencil of a D24S8 pixel from the top byte, as stored by the PICA, to the bottom byte,
+/// as expected by GL_UNSIGNED_INT_24_8, or back.
+template <bool morton_to_linear>
+inline u32 RotateStencil(u32 value) {
+    return morton_to_linear ? (value << 8) | (value >> 24) : (value >> 8) | (value << 24);
+}
+
+#ifdef ARCHITECTURE_x86_64
+template <bool morton_to_linear>
+inline __m128i RotateStencil(__m128i value) {
+    return morton_to_linear
+               ? _mm_or_si128(_mm_slli_epi32(value, 8), _mm_srli_epi32(value, 24))
+               : _mm_or_si128(_mm_srli_epi32(value, 8), _mm_slli_epi32(value, 24));
+}
+
+inline __m128i Load(const u8* ptr) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+
+inline void Store(u8* ptr, __m128i value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), value);
+}
+
+/**
+ * Copies two rows of a tile with 32-bit pixels. Each 2x2 block of the tile is 16 bytes holding two
+ * pixels of the lower row followed by two pixels of the upper row, so the rows are gathered from
+ * the 64-bit halves of the four blocks.
+ */
+template <bool morton_to_linear, bool rotate_stencil>
+inline void CopyRowPair32(u8* tile, u8* row0, u8* row1) {
+    u8* const block0 = tile + MortonInterleave(0, 0) * 4;
+    u8* const block1 = tile + MortonInterleave(2, 0) * 4;
+    u8* const block2 = tile + MortonInterleave(4, 0) * 4;
+    u8* const block3 = tile + MortonInterleave(6, 0) * 4;
+
+    const auto convert = [](__m128i value) {
+        return rotate_stencil ? RotateStencil<morton_to_linear>(value) : value;
+    };
+
+    if (morton_to_linear) {
+        const __m128i b0 = convert(Load(block0));
+        const __m128i b1 = convert(Load(block1));
+        const __m128i b2 = convert(Load(block2));
+        const __m128i b3 = convert(Load(block3));
+        Store(row0, _mm_unpacklo_epi64(b0, b1));
+        Store(row0 + 16, _mm_unpacklo_epi64(b2, b3));
+        Store(row1, _mm_unpackhi_epi64(b0, b1));
+        Store(row1 + 16, _mm_unpackhi_epi64(b2, b3));
+    } else {
+        const __m128i r0a = convert(Load(row0));
+        const __m128i r0b = convert(Load(row0 + 16));
+        const __m128i r1a = convert(Load(row1));
+        const __m128i r1b = convert(Load(row1 + 16));
+        Store(block0, _mm_unpacklo_epi64(r0a, r1a));
+        Store(block1, _mm_unpackhi_epi64(r0a, r1a));
+        Store(block2, _mm_unpacklo_epi64(r0b, r1b));
+        Store(block3, _mm_unpackhi_epi64(r0b, r1b));
+    }
+}
+
+/**
+ * Copies two rows of a tile with 16-bit pixels. Two neighbouring 2x2 blocks are 16 bytes, whose
+ * 32-bit lanes alternate between the lower and the upper row.
+ */
+template <bool morton_to_linear>
+inline void CopyRowPair16(u8* tile, u8* row0, u8* row1) {
+    u8* const blocks_left = tile + MortonInterleave(0, 0) * 2;
+    u8* const blocks_right = tile + MortonInterleave(4, 0) * 2;
+
+    if (morton_to_linear) {
+        const __m128i left = _mm_shuffle_epi32(Load(blocks_left), _MM_SHUFFLE(3, 1, 2, 0));
+        const __m128i right = _mm_shuffle_epi32(Load(blocks_right), _MM_SHUFFLE(3, 1, 2, 0));
+        Store(row0, _mm_unpacklo_epi64(left, right));
+        Store(row1, _mm_unpackhi_epi64(left, right));
+    } else {
+        const __m128i r0 = Load(row0);
+        const __m128i r1 = Load(row1);
+        Store(blocks_left, _mm_unpacklo_epi32(r0, r1));
+        Store(blocks_right, _mm_unpackhi_epi32(r0, r1));
+    }
+}
+#endif
+
+template <bool morton_to_linear, u32 bytes_per_pixel, u32 linear_bytes_per_pixel,
+          bool rotate_stencil>
+inline void CopyPixel(u8* tile_ptr, u8* linear_ptr) {
+    if (rotate_stencil) {
+        u32 value;
+        std::memcpy(&value, morton_to_linear ? tile_ptr : linear_ptr, sizeof(u32));
+        value = RotateStencil<morton_to_linear>(value);
+        std::memcpy(morton_to_linear ? linear_ptr : tile_ptr, &value, sizeof(u32));
+    } else if (morton_to_linear) {
+        std::memcpy(linear_ptr, tile_ptr, bytes_per_pixel);
+    } else {
+        std::memcpy(tile_ptr, linear_ptr, bytes_per_pixel);
+    }
+}
+
+} // namespace MortonDetail
+
+/**
+ * Copies an 8x8 tile between the Morton order used by the PICA and a linear buffer with rows stride
+ * pixels apart. As OpenGL stores images from the bottom up, the rows of the tile are stored in
+ * reverse order, starting with its last row at linear_buffer. If linear_bytes_per_pixel is larger
+ * than bytes_per_pixel, only the first bytes_per_pixel bytes of each linear pixel are accessed.
+ * With rotate_stencil, 32-bit D24S8 pixels are converted from and to the layout of
+ * GL_UNSIGNED_INT_24_8.
+ */
+template <bool morton_to_linear, u32 bytes_per_pixel, u32 linear_bytes_per_pixel = bytes_per_pixel,
+          bool rotate_stencil = false>
+inline void MortonCopyTile(u32 stride, u8* tile_buffer, u8* linear_buffer) {
+    static_assert(linear_bytes_per_pixel >= bytes_per_pixel, "");
+    static_assert(!rotate_stencil || (bytes_per_pixel == 4 && linear_bytes_per_pixel == 4), "");
+
+    const std::size_t row_bytes = stride * linear_bytes_per_pixel;
+
+    // The tile is made of 2x2 blocks, each holding two pixels of a row followed by the two pixels
+    // above them, so rows are copied in pairs
+#ifdef ARCHITECTURE_x86_64
+    if constexpr (linear_bytes_per_pixel == 4 && bytes_per_pixel == 4) {
+        for (u32 y = 0; y < 8; y += 2) {
+            u8* const row0 = linear_buffer + (7 - y) * row_bytes;
+            MortonDetail::CopyRowPair32<morton_to_linear, rotate_stencil>(
+                tile_buffer + MortonInterleave(0, y) * 4, row0, row0 - row_bytes);
+        }
+        return;
+    } else if constexpr (linear_bytes_per_pixel == 2 && bytes_per_pixel == 2) {
+        for (u32 y = 0; y < 8; y += 2) {
+            u8* const row0 = linear_buffer + (7 - y) * row_bytes;
+            MortonDetail::CopyRowPair16<morton_to_linear>(
+                tile_buffer + MortonInterleave(0, y) * 2, row0, row0 - row_bytes);
+        }
+        return;
+    }
+#endif
+
+    for (u32 y = 0; y < 8; y += 2) {
+        for (u32 x = 0; x < 8; x += 2) {
+            u8* const block = tile_buffer + MortonInterleave(x, y) * bytes_per_pixel;
+            u8* const row0 = linear_buffer + ((7 - y) * stride + x) * linear_bytes_per_pixel;
+            u8* const row1 = row0 - row_bytes;
+
+            if constexpr (linear_bytes_per_pixel == bytes_per_pixel && !rotate_stencil) {
+                // Both pixels of a block row are contiguous on both sides
+                if (morton_to_linear) {
+                    std::memcpy(row0, block, 2 * bytes_per_pixel);
+                    std::memcpy(row1, block + 2 * bytes_per_pixel, 2 * bytes_per_pixel);
+                } else {
+                    std::memcpy(block, row0, 2 * bytes_per_pixel);
+                    std::memcpy(block + 2 * bytes_per_pixel, row1, 2 * bytes_per_pixel);
+                }
+            } else {
+                using MortonDetail::CopyPixel;
+                constexpr u32 bpp = bytes_per_pixel;
+                constexpr u32 linear_bpp = linear_bytes_per_pixel;
+                CopyPixel<morton_to_linear, bpp, linear_bpp, rotate_stencil>(block, row0);
+                CopyPixel<morton_to_linear, bpp, linear_bpp, rotate_stencil>(block + bpp,
+                                                                             row0 + linear_bpp);
+                CopyPixel<morton_to_linear, bpp, linear_bpp, rotate_stencil>(block + 2 * bpp, row1);
+                CopyPixel<morton_to_linear, bpp, linear_bpp, rotate_stencil>(block + 3 * bpp,
+                                                                             row1 + linear_bpp);
+            }
+        }
+    }
+}
+
+} // namespace VideoCore
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include "core/savestate.h"
 #include "video_core/geometry_pipeline.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
@@ -50,5 +51,81 @@ void State::Reset() {
     Zero(cmd_list);
     Zero(immediate);
     primitive_assembler.Reconfigure(PipelineRegs::TriangleTopology::List);
+    dirty_groups = DirtyState::All;
+    dirty_lighting_luts = ~0U;
+}
+
+void State::SaveState(Core::StateWriter& writer) const {
+    writer.WriteBytes(&regs, sizeof(regs));
+    for (const Shader::ShaderSetup* setup : {&vs, &gs}) {
+        writer.WriteBytes(&setup->uniforms, sizeof(setup->uniforms));
+        writer.WriteBytes(&setup->program_code, sizeof(setup->program_code));
+        writer.WriteBytes(&setup->swizzle_data, sizeof(setup->swizzle_data));
+        writer.Write(setup->engine_data.entry_point);
+    }
+    writer.WriteBytes(&input_default_attributes, sizeof(input_default_attributes));
+    writer.WriteBytes(&proctex, sizeof(proctex));
+    writer.WriteBytes(&lighting, sizeof(lighting));
+    writer.WriteBytes(&fog, sizeof(fog));
+    writer.WriteBytes(&immediate.input_vertex, sizeof(immediate.input_vertex));
+    writer.Write(immediate.current_attribute);
+    writer.Write(immediate.reset_geometry_pipeline);
+
+    // Geometry shaders rely on their registers being preserved across invocations, and immediate
+    // mode draws can be interrupted in the middle of a primitive
+    geometry_pipeline.SaveState(writer);
+    writer.WriteBytes(&gs_unit.registers, sizeof(gs_unit.registers));
+    writer.WriteBytes(&gs_unit.conditional_code, sizeof(gs_unit.conditional_code));
+    writer.WriteBytes(&gs_unit.address_registers, sizeof(gs_unit.address_registers));
+    const Shader::GSEmitter& emitter = gs_unit.emitter;
+    writer.WriteBytes(&emitter.buffer, sizeof(emitter.buffer));
+    writer.Write(emitter.vertex_id);
+    writer.Write(emitter.prim_emit);
+    writer.Write(emitter.winding);
+    writer.Write(emitter.output_mask);
+    primitive_assembler.SaveState(writer);
+}
+
+bool State::LoadState(Core::StateReader& reader) {
+    if (!reader.ReadBytes(&regs, sizeof(regs))) {
+        return false;
+    }
+    for (Shader::ShaderSetup* setup : {&vs, &gs}) {
+        if (!reader.ReadBytes(&setup->uniforms, sizeof(setup->uniforms)) ||
+            !reader.ReadBytes(&setup->program_code, sizeof(setup->program_code)) ||
+            !reader.ReadBytes(&setup->swizzle_data, sizeof(setup->swizzle_data)) ||
+            !reader.Read(setup->engine_data.entry_point)) {
+            return false;
+        }
+        setup->MarkProgramCodeDirty();
+        setup->MarkSwizzleDataDirty();
+        setup->engine_data.cached_shader = nullptr;
+    }
+    if (!reader.ReadBytes(&input_default_attributes, sizeof(input_default_attributes)) ||
+        !reader.ReadBytes(&proctex, sizeof(proctex)) ||
+        !reader.ReadBytes(&lighting, sizeof(lighting)) || !reader.ReadBytes(&fog, sizeof(fog)) ||
+        !reader.ReadBytes(&immediate.input_vertex, sizeof(immediate.input_vertex)) ||
+        !reader.Read(immediate.current_attribute) ||
+        !reader.Read(immediate.reset_geometry_pipeline)) {
+        return false;
+    }
+
+    Shader::GSEmitter& emitter = gs_unit.emitter;
+    if (!geometry_pipeline.LoadState(reader) ||
+        !reader.ReadBytes(&gs_unit.registers, sizeof(gs_unit.registers)) ||
+        !reader.ReadBytes(&gs_unit.conditional_code, sizeof(gs_unit.conditional_code)) ||
+        !reader.ReadBytes(&gs_unit.address_registers, sizeof(gs_unit.address_registers)) ||
+        !reader.ReadBytes(&emitter.buffer, sizeof(emitter.buffer)) ||
+        !reader.Read(emitter.vertex_id) || emitter.vertex_id >= emitter.buffer.size() ||
+        !reader.Read(emitter.prim_emit) || !reader.Read(emitter.winding) ||
+        !reader.Read(emitter.output_mask) || !primitive_assembler.LoadState(reader)) {
+        return false;
+    }
+
+    Zero(cmd_list);
+    // Makes the rasterizer resync its state, uniforms and lookup tables
+    dirty_groups = DirtyState::All;
+    dirty_lighting_luts = ~0U;
+    return true;
 }
 } // namespace Pica
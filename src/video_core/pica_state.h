@@ -13,13 +13,60 @@
 #include "video_core/regs.h"
 #include "video_core/shader/shader.h"
 
+namespace Core {
+class StateReader;
+class StateWriter;
+} // namespace Core
+
 namespace Pica {
 
+/**
+ * Groups of PICA state that renderers sync together. Register writes mark the groups they affect in
+ * State::dirty_groups, and the rasterizer syncs and clears the marked groups before drawing.
+ */
+namespace DirtyState {
+enum : u64 {
+    ClipEnabled = 1ULL << 0,
+    ClipCoef = 1ULL << 1,
+    CullMode = 1ULL << 2,
+    DepthScale = 1ULL << 3,
+    DepthOffset = 1ULL << 4,
+    BlendEnabled = 1ULL << 5,
+    BlendFuncs = 1ULL << 6,
+    BlendColor = 1ULL << 7,
+    FogColor = 1ULL << 8,
+    ProcTexNoise = 1ULL << 9,
+    ProcTexBias = 1ULL << 10,
+    AlphaTest = 1ULL << 11,
+    LogicOp = 1ULL << 12,
+    StencilTest = 1ULL << 13,
+    DepthTest = 1ULL << 14,
+    ColorWriteMask = 1ULL << 15,
+    StencilWriteMask = 1ULL << 16,
+    DepthWriteMask = 1ULL << 17,
+    CombinerColor = 1ULL << 18,
+    GlobalAmbient = 1ULL << 19,
+    ShadowBias = 1ULL << 20,
+    TevConstColor = 1ULL << 21, ///< One bit per TEV stage
+    Light = 1ULL << 27,         ///< One bit per light source
+    ShaderConfig = 1ULL << 35,  ///< Registers the fragment shader is generated from
+    FogLut = 1ULL << 36,
+    ProcTexLut = 1ULL << 37, ///< One bit per TexturingRegs::ProcTexLutTable
+    All = ~0ULL,
+};
+} // namespace DirtyState
+
 /// Struct used to describe current Pica state
 struct State {
     State();
     void Reset();
 
+    /// Saves the registers, the shader setups, the lookup tables and the primitives in progress
+    void SaveState(Core::StateWriter& writer) const;
+
+    /// Restores the state saved by SaveState and resyncs the rasterizer with the new registers
+    bool LoadState(Core::StateReader& reader);
+
     /// Pica registers
     Regs regs;
 
@@ -126,6 +173,11 @@ struct State {
         std::array<LutEntry, 128> lut;
     } fog;
 
+    /// State groups changed since the rasterizer last synced them, see DirtyState
+    u64 dirty_groups = DirtyState::All;
+    /// Lighting LUTs changed since the rasterizer last uploaded them, one bit per LUT
+    u32 dirty_lighting_luts = ~0U;
+
     /// Current Pica command list
     struct {
         const u32* head_ptr;
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include "common/logging/log.h"
+#include "core/savestate.h"
 #include "video_core/primitive_assembly.h"
 #include "video_core/regs_pipeline.h"
 #include "video_core/shader/shader.h"
@@ -81,6 +82,22 @@ PipelineRegs::TriangleTopology PrimitiveAssembler<VertexType>::GetTopology() con
     return topology;
 }
 
+template <typename VertexType>
+void PrimitiveAssembler<VertexType>::SaveState(Core::StateWriter& writer) const {
+    writer.Write(topology);
+    writer.Write(buffer_index);
+    writer.WriteBytes(&buffer, sizeof(buffer));
+    writer.Write(strip_ready);
+    writer.Write(winding);
+}
+
+template <typename VertexType>
+bool PrimitiveAssembler<VertexType>::LoadState(Core::StateReader& reader) {
+    return reader.Read(topology) && reader.Read(buffer_index) && buffer_index >= 0 &&
+           buffer_index <= 2 && reader.ReadBytes(&buffer, sizeof(buffer)) &&
+           reader.Read(strip_ready) && reader.Read(winding);
+}
+
 // explicitly instantiate use cases
 template struct PrimitiveAssembler<Shader::OutputVertex>;
 
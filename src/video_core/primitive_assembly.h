@@ -7,6 +7,11 @@
 #include <functional>
 #include "video_core/regs_pipeline.h"
 
+namespace Core {
+class StateReader;
+class StateWriter;
+} // namespace Core
+
 namespace Pica {
 
 /*
@@ -55,6 +60,12 @@ struct PrimitiveAssembler {
      */
     PipelineRegs::TriangleTopology GetTopology() const;
 
+    /// Saves the topology and the vertices of the triangle being assembled
+    void SaveState(Core::StateWriter& writer) const;
+
+    /// Restores the state saved by SaveState
+    bool LoadState(Core::StateReader& reader);
+
 private:
     PipelineRegs::TriangleTopology topology;
 
@@ -31,9 +31,6 @@ public:
     /// Draw the current batch of triangles
     virtual void DrawTriangles() = 0;
 
-    /// Notify rasterizer that the specified PICA register has been changed
-    virtual void NotifyPicaRegisterChanged(u32 id) = 0;
-
     /// Notify rasterizer that all caches should be flushed to 3DS memory
     virtual void FlushAll() = 0;
 
@@ -73,5 +70,11 @@ public:
     virtual bool AccelerateDrawBatch(bool is_indexed) {
         return false;
     }
+
+    /// Load the persistent caches of the given title, e.g. its shader disk cache
+    virtual void LoadDiskResources(u64 title_id) {}
+
+    /// Notify the rasterizer that a frame has been presented
+    virtual void EndFrame() {}
 };
 } // namespace VideoCore
@@ -0,0 +1,86 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include <glad/glad.h>
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/renderer_opengl/gl_async_shader_compiler.h"
+
+namespace OpenGL {
+
+AsyncShaderCompiler::AsyncShaderCompiler(std::unique_ptr<GraphicsContext> context, bool separable)
+    : context(std::move(context)), separable(separable) {
+    thread = std::thread(&AsyncShaderCompiler::Run, this);
+}
+
+AsyncShaderCompiler::~AsyncShaderCompiler() {
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+    }
+    job_available.notify_one();
+    thread.join();
+}
+
+void AsyncShaderCompiler::Queue(const PicaFSConfig& config, std::string code) {
+    {
+        std::lock_guard lock(mutex);
+        jobs.push_back({config, std::move(code)});
+    }
+    job_available.notify_one();
+}
+
+std::vector<AsyncShaderCompiler::Result> AsyncShaderCompiler::TakeCompleted() {
+    std::lock_guard lock(mutex);
+    return std::exchange(completed, {});
+}
+
+void AsyncShaderCompiler::Run() {
+    Common::SetCurrentThreadName("ShaderCompiler");
+    MicroProfileOnThreadCreate("ShaderCompiler");
+    context->MakeCurrent();
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock(mutex);
+            job_available.wait(lock, [this] { return stop || !jobs.empty(); });
+            if (stop)
+                break;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        Result result;
+        result.config = job.config;
+        result.code = std::move(job.code);
+        result.shader.Create(result.code.c_str(), GL_FRAGMENT_SHADER);
+        GLint status = GL_FALSE;
+        glGetShaderiv(result.shader.handle, GL_COMPILE_STATUS, &status);
+        if (status == GL_TRUE && separable) {
+            // The program handle stays 0 if linking failed
+            result.program.Create(true, {result.shader.handle});
+            result.shader.Release();
+            status = result.program.handle != 0 ? GL_TRUE : GL_FALSE;
+        }
+        result.success = status == GL_TRUE;
+        if (!result.success)
+            result.shader.Release();
+        // Objects are only guaranteed to be usable from another context once they are complete
+        glFinish();
+
+        std::lock_guard lock(mutex);
+        completed.push_back(std::move(result));
+    }
+
+    context->DoneCurrent();
+    context.reset();
+#if MICROPROFILE_ENABLED
+    MicroProfileOnThreadExit();
+#endif
+}
+
+} // namespace OpenGL
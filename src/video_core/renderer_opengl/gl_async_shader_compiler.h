@@ -0,0 +1,69 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_shader_gen.h"
+
+class GraphicsContext;
+
+namespace OpenGL {
+
+/**
+ * Compiles fragment shaders on a thread owning a GL context shared with the render thread. The
+ * uniform block and sampler bindings are left to the render thread, since setting them goes through
+ * the OpenGLState of that thread.
+ */
+class AsyncShaderCompiler {
+public:
+    struct Result {
+        PicaFSConfig config;
+        std::string code;
+        /// Compiled shader object, only kept when programs are not separable
+        OGLShader shader;
+        /// Separable program linked from the shader, only created when programs are separable
+        OGLProgram program;
+        /// False if compiling or linking failed, in which case neither object is kept
+        bool success = false;
+    };
+
+    AsyncShaderCompiler(std::unique_ptr<GraphicsContext> context, bool separable);
+    ~AsyncShaderCompiler();
+
+    /// Queues the code generated for a config to be compiled.
+    void Queue(const PicaFSConfig& config, std::string code);
+
+    /// Returns the shaders that finished compiling since the previous call.
+    std::vector<Result> TakeCompleted();
+
+private:
+    struct Job {
+        PicaFSConfig config;
+        std::string code;
+    };
+
+    void Run();
+
+    /// Made current on the compiler thread, which also destroys it when it exits
+    std::unique_ptr<GraphicsContext> context;
+    bool separable;
+
+    std::mutex mutex;
+    std::condition_variable job_available;
+    std::deque<Job> jobs;
+    std::vector<Result> completed;
+    bool stop = false;
+
+    std::thread thread;
+};
+
+} // namespace OpenGL
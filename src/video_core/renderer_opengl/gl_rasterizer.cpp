@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -10,12 +11,17 @@
 #include <glad/glad.h>
 #include "common/alignment.h"
 #include "common/assert.h"
+#include "common/bit_set.h"
+#include "common/cityhash.h"
+#include "common/counters.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
 #include "common/vector_math.h"
+#include "core/frontend/emu_window.h"
 #include "core/hw/gpu.h"
+#include "core/settings.h"
 #include "video_core/pica_state.h"
 #include "video_core/regs_framebuffer.h"
 #include "video_core/regs_rasterizer.h"
@@ -38,6 +44,16 @@ MICROPROFILE_DEFINE(OpenGL_Drawing, "OpenGL", "Drawing", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_Blits, "OpenGL", "Blits", MP_RGB(100, 100, 255));
 MICROPROFILE_DEFINE(OpenGL_CacheManagement, "OpenGL", "Cache Mgmt", MP_RGB(100, 255, 100));
 
+static const Common::Counters::Counter state_groups_synced = Common::Counters::Register(
+    "citra_gpu_state_groups_synced_total", "State groups synced before a draw");
+static const Common::Counters::Counter lut_bytes_uploaded = Common::Counters::Register(
+    "citra_gpu_lut_upload_bytes_total", "Bytes of converted LUTs written to the LUT buffer");
+static const Common::Counters::Counter lut_bytes_saved = Common::Counters::Register(
+    "citra_gpu_lut_saved_bytes_total",
+    "Bytes of LUTs that were found in the LUT buffer instead of being uploaded again");
+
+namespace DirtyState = Pica::DirtyState;
+
 static bool IsVendorAmd() {
     std::string gpu_vendor{reinterpret_cast<char const*>(glGetString(GL_VENDOR))};
     return gpu_vendor == "ATI Technologies Inc." || gpu_vendor == "Advanced Micro Devices, Inc.";
@@ -45,10 +61,10 @@ static bool IsVendorAmd() {
 
 RasterizerOpenGL::RasterizerOpenGL(EmuWindow& window)
     : is_amd(IsVendorAmd()), shader_dirty(true),
-      vertex_buffer(GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE, is_amd),
-      uniform_buffer(GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE, false),
-      index_buffer(GL_ELEMENT_ARRAY_BUFFER, INDEX_BUFFER_SIZE, false),
-      texture_buffer(GL_TEXTURE_BUFFER, TEXTURE_BUFFER_SIZE, false), emu_window{window} {
+      vertex_buffer("vertex", GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE, is_amd, true),
+      uniform_buffer("uniform", GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE, false, true),
+      index_buffer("index", GL_ELEMENT_ARRAY_BUFFER, INDEX_BUFFER_SIZE, false, true),
+      emu_window{window} {
 
     allow_shadow = GLAD_GL_ARB_shader_image_load_store && GLAD_GL_ARB_shader_image_size &&
                    GLAD_GL_ARB_framebuffer_no_attachments;
@@ -99,6 +115,8 @@ RasterizerOpenGL::RasterizerOpenGL(EmuWindow& window)
         Common::AlignUp<std::size_t>(sizeof(GSUniformData), uniform_buffer_alignment);
     uniform_size_aligned_fs =
         Common::AlignUp<std::size_t>(sizeof(UniformData), uniform_buffer_alignment);
+    uniform_size_aligned_fs_config =
+        Common::AlignUp<std::size_t>(sizeof(FSConfigUniformData), uniform_buffer_alignment);
 
     // Set vertex attributes for software shader path
     state.draw.vertex_array = sw_vao.handle;
@@ -138,24 +156,37 @@ RasterizerOpenGL::RasterizerOpenGL(EmuWindow& window)
     // Create render framebuffer
     framebuffer.Create();
 
-    // Allocate and bind texture buffer lut textures
+    // Allocate the LUT buffer and bind texture buffer lut textures to it
+    lut_buffer.Create();
+    glBindBuffer(GL_TEXTURE_BUFFER, lut_buffer.handle);
+    glBufferData(GL_TEXTURE_BUFFER, NUM_LUT_SLOTS * LUT_SLOT_SIZE, nullptr, GL_DYNAMIC_DRAW);
+    lut_binding_slots.fill(NUM_LUT_SLOTS);
+
     texture_buffer_lut_rg.Create();
     texture_buffer_lut_rgba.Create();
     state.texture_buffer_lut_rg.texture_buffer = texture_buffer_lut_rg.handle;
     state.texture_buffer_lut_rgba.texture_buffer = texture_buffer_lut_rgba.handle;
     state.Apply();
     glActiveTexture(TextureUnits::TextureBufferLUT_RG.Enum());
-    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, texture_buffer.GetHandle());
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, lut_buffer.handle);
     glActiveTexture(TextureUnits::TextureBufferLUT_RGBA.Enum());
-    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, texture_buffer.GetHandle());
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lut_buffer.handle);
 
     // Bind index buffer for hardware shader path
     state.draw.vertex_array = hw_vao.handle;
     state.Apply();
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer.GetHandle());
 
-    shader_program_manager =
-        std::make_unique<ShaderProgramManager>(GLAD_GL_ARB_separate_shader_objects, is_amd);
+    std::unique_ptr<GraphicsContext> shader_context;
+    if (Settings::values.use_async_shader_compilation) {
+        shader_context = emu_window.CreateSharedContext();
+        if (!shader_context) {
+            LOG_WARNING(Render_OpenGL, "Shared contexts are not supported by the frontend, "
+                                       "shaders will be compiled synchronously");
+        }
+    }
+    shader_program_manager = std::make_unique<ShaderProgramManager>(
+        GLAD_GL_ARB_separate_shader_objects, is_amd, std::move(shader_context));
 
     glEnable(GL_BLEND);
 
@@ -205,6 +236,111 @@ void RasterizerOpenGL::SyncEntireState() {
     SyncShadowBias();
 }
 
+void RasterizerOpenGL::SyncDirtyState() {
+    auto& pica_state = Pica::g_state;
+    if (pica_state.dirty_lighting_luts != 0) {
+        for (std::size_t index = 0; index < uniform_block_data.lighting_lut_dirty.size(); ++index) {
+            if (pica_state.dirty_lighting_luts & (1U << index))
+                uniform_block_data.lighting_lut_dirty[index] = true;
+        }
+        uniform_block_data.lighting_lut_dirty_any = true;
+        pica_state.dirty_lighting_luts = 0;
+    }
+
+    if (pica_state.dirty_groups == 0)
+        return;
+
+    const u64 dirty = pica_state.dirty_groups;
+    pica_state.dirty_groups = 0;
+    state_groups_synced.Add(Common::CountSetBits(dirty));
+
+    if (dirty & DirtyState::ShaderConfig)
+        shader_dirty = true;
+
+    // Lookup tables are uploaded with the uniforms
+    if (dirty & DirtyState::FogLut)
+        uniform_block_data.fog_lut_dirty = true;
+    using Pica::TexturingRegs;
+    const auto proctex_lut_dirty = [dirty](TexturingRegs::ProcTexLutTable table) {
+        return (dirty & (DirtyState::ProcTexLut << static_cast<u32>(table))) != 0;
+    };
+    if (proctex_lut_dirty(TexturingRegs::ProcTexLutTable::Noise))
+        uniform_block_data.proctex_noise_lut_dirty = true;
+    if (proctex_lut_dirty(TexturingRegs::ProcTexLutTable::ColorMap))
+        uniform_block_data.proctex_color_map_dirty = true;
+    if (proctex_lut_dirty(TexturingRegs::ProcTexLutTable::AlphaMap))
+        uniform_block_data.proctex_alpha_map_dirty = true;
+    if (proctex_lut_dirty(TexturingRegs::ProcTexLutTable::Color))
+        uniform_block_data.proctex_lut_dirty = true;
+    if (proctex_lut_dirty(TexturingRegs::ProcTexLutTable::ColorDiff))
+        uniform_block_data.proctex_diff_lut_dirty = true;
+
+    // Sync fixed function OpenGL state
+    if (dirty & DirtyState::ClipEnabled)
+        SyncClipEnabled();
+    if (dirty & DirtyState::CullMode)
+        SyncCullMode();
+    if (dirty & DirtyState::BlendEnabled)
+        SyncBlendEnabled();
+    if (dirty & DirtyState::BlendFuncs)
+        SyncBlendFuncs();
+    if (dirty & DirtyState::BlendColor)
+        SyncBlendColor();
+    if (dirty & DirtyState::LogicOp)
+        SyncLogicOp();
+    if (dirty & DirtyState::StencilTest)
+        SyncStencilTest();
+    if (dirty & DirtyState::DepthTest)
+        SyncDepthTest();
+    if (dirty & DirtyState::ColorWriteMask)
+        SyncColorWriteMask();
+    if (dirty & DirtyState::StencilWriteMask)
+        SyncStencilWriteMask();
+    if (dirty & DirtyState::DepthWriteMask)
+        SyncDepthWriteMask();
+
+    // Sync uniforms
+    if (dirty & DirtyState::ClipCoef)
+        SyncClipCoef();
+    if (dirty & DirtyState::DepthScale)
+        SyncDepthScale();
+    if (dirty & DirtyState::DepthOffset)
+        SyncDepthOffset();
+    if (dirty & DirtyState::AlphaTest)
+        SyncAlphaTest();
+    if (dirty & DirtyState::CombinerColor)
+        SyncCombinerColor();
+    if (dirty & DirtyState::FogColor)
+        SyncFogColor();
+    if (dirty & DirtyState::ProcTexNoise)
+        SyncProcTexNoise();
+    if (dirty & DirtyState::ProcTexBias)
+        SyncProcTexBias();
+    if (dirty & DirtyState::ShadowBias)
+        SyncShadowBias();
+    if (dirty & DirtyState::GlobalAmbient)
+        SyncGlobalAmbient();
+
+    const auto& tev_stages = Pica::g_state.regs.texturing.GetTevStages();
+    for (std::size_t index = 0; index < tev_stages.size(); ++index) {
+        if (dirty & (DirtyState::TevConstColor << index))
+            SyncTevConstColor(index, tev_stages[index]);
+    }
+
+    for (unsigned light_index = 0; light_index < 8; light_index++) {
+        if (!(dirty & (DirtyState::Light << light_index)))
+            continue;
+        SyncLightSpecular0(light_index);
+        SyncLightSpecular1(light_index);
+        SyncLightDiffuse(light_index);
+        SyncLightAmbient(light_index);
+        SyncLightPosition(light_index);
+        SyncLightSpotDirection(light_index);
+        SyncLightDistanceAttenuationBias(light_index);
+        SyncLightDistanceAttenuationScale(light_index);
+    }
+}
+
 /**
  * This is a helper function to resolve an issue when interpolating opposite quaternions. See below
  * for a detailed description of this issue (yuriks):
@@ -499,6 +635,8 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     MICROPROFILE_SCOPE(OpenGL_Drawing);
     const auto& regs = Pica::g_state.regs;
 
+    SyncDirtyState();
+
     bool shadow_rendering = regs.framebuffer.output_merger.fragment_operation_mode ==
                             Pica::FramebufferRegs::FragmentOperationMode::Shadow;
 
@@ -761,10 +899,14 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
         }
     }
 
+    // Select the shader again once the one the uber shader stands in for finished compiling
+    if (fragment_shader_pending && shader_program_manager->InstallCompiledShaders()) {
+        shader_dirty = true;
+    }
+
     // Sync and bind the shader
     if (shader_dirty) {
         SetShader();
-        shader_dirty = false;
     }
 
     // Sync the LUTs within the texture buffer
@@ -858,489 +1000,13 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     return succeeded;
 }
 
-void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
-    const auto& regs = Pica::g_state.regs;
-
-    switch (id) {
-    // Culling
-    case PICA_REG_INDEX(rasterizer.cull_mode):
-        SyncCullMode();
-        break;
-
-    // Clipping plane
-    case PICA_REG_INDEX(rasterizer.clip_enable):
-        SyncClipEnabled();
-        break;
-
-    case PICA_REG_INDEX_WORKAROUND(rasterizer.clip_coef[0], 0x48):
-    case PICA_REG_INDEX_WORKAROUND(rasterizer.clip_coef[1], 0x49):
-    case PICA_REG_INDEX_WORKAROUND(rasterizer.clip_coef[2], 0x4a):
-    case PICA_REG_INDEX_WORKAROUND(rasterizer.clip_coef[3], 0x4b):
-        SyncClipCoef();
-        break;
-
-    // Depth modifiers
-    case PICA_REG_INDEX(rasterizer.viewport_depth_range):
-        SyncDepthScale();
-        break;
-    case PICA_REG_INDEX(rasterizer.viewport_depth_near_plane):
-        SyncDepthOffset();
-        break;
-
-    // Depth buffering
-    case PICA_REG_INDEX(rasterizer.depthmap_enable):
-        shader_dirty = true;
-        break;
-
-    // Blending
-    case PICA_REG_INDEX(framebuffer.output_merger.alphablend_enable):
-        SyncBlendEnabled();
-        break;
-    case PICA_REG_INDEX(framebuffer.output_merger.alpha_blending):
-        SyncBlendFuncs();
-        break;
-    case PICA_REG_INDEX(framebuffer.output_merger.blend_const):
-        SyncBlendColor();
-        break;
-
-    // Fog state
-    case PICA_REG_INDEX(texturing.fog_color):
-        SyncFogColor();
-        break;
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[0], 0xe8):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[1], 0xe9):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[2], 0xea):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[3], 0xeb):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[4], 0xec):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[5], 0xed):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[6], 0xee):
-    case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[7], 0xef):
-        uniform_block_data.fog_lut_dirty = true;
-        break;
-
-    // ProcTex state
-    case PICA_REG_INDEX(texturing.proctex):
-    case PICA_REG_INDEX(texturing.proctex_lut):
-    case PICA_REG_INDEX(texturing.proctex_lut_offset):
-        SyncProcTexBias();
-        shader_dirty = true;
-        break;
-
-    case PICA_REG_INDEX(texturing.proctex_noise_u):
-    case PICA_REG_INDEX(texturing.proctex_noise_v):
-    case PICA_REG_INDEX(texturing.proctex_noise_frequency):
-        SyncProcTexNoise();
-        break;
-
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[0], 0xb0):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[1], 0xb1):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[2], 0xb2):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[3], 0xb3):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[4], 0xb4):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[5], 0xb5):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[6], 0xb6):
-    case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[7], 0xb7):
-        using Pica::TexturingRegs;
-        switch (regs.texturing.proctex_lut_config.ref_table.Value()) {
-        case TexturingRegs::ProcTexLutTable::Noise:
-            uniform_block_data.proctex_noise_lut_dirty = true;
-            break;
-        case TexturingRegs::ProcTexLutTable::ColorMap:
-            uniform_block_data.proctex_color_map_dirty = true;
-            break;
-        case TexturingRegs::ProcTexLutTable::AlphaMap:
-            uniform_block_data.proctex_alpha_map_dirty = true;
-            break;
-        case TexturingRegs::ProcTexLutTable::Color:
-            uniform_block_data.proctex_lut_dirty = true;
-            break;
-        case TexturingRegs::ProcTexLutTable::ColorDiff:
-            uniform_block_data.proctex_diff_lut_dirty = true;
-            break;
-        }
-        break;
-
-    // Alpha test
-    case PICA_REG_INDEX(framebuffer.output_merger.alpha_test):
-        SyncAlphaTest();
-        shader_dirty = true;
-        break;
-
-    // Sync GL stencil test + stencil write mask
-    // (Pica stencil test function register also contains a stencil write mask)
-    case PICA_REG_INDEX(framebuffer.output_merger.stencil_test.raw_func):
-        SyncStencilTest();
-        SyncStencilWriteMask();
-        break;
-    case PICA_REG_INDEX(framebuffer.output_merger.stencil_test.raw_op):
-    case PICA_REG_INDEX(framebuffer.framebuffer.depth_format):
-        SyncStencilTest();
-        break;
-
-    // Sync GL depth test + depth and color write mask
-    // (Pica depth test function register also contains a depth and color write mask)
-    case PICA_REG_INDEX(framebuffer.output_merger.depth_test_enable):
-        SyncDepthTest();
-        SyncDepthWriteMask();
-        SyncColorWriteMask();
-        break;
-
-    // Sync GL depth and stencil write mask
-    // (This is a dedicated combined depth / stencil write-enable register)
-    case PICA_REG_INDEX(framebuffer.framebuffer.allow_depth_stencil_write):
-        SyncDepthWriteMask();
-        SyncStencilWriteMask();
-        break;
-
-    // Sync GL color write mask
-    // (This is a dedicated color write-enable register)
-    case PICA_REG_INDEX(framebuffer.framebuffer.allow_color_write):
-        SyncColorWriteMask();
-        break;
-
-    case PICA_REG_INDEX(framebuffer.shadow):
-        SyncShadowBias();
-        break;
-
-    // Scissor test
-    case PICA_REG_INDEX(rasterizer.scissor_test.mode):
-        shader_dirty = true;
-        break;
-
-    // Logic op
-    case PICA_REG_INDEX(framebuffer.output_merger.logic_op):
-        SyncLogicOp();
-        break;
-
-    case PICA_REG_INDEX(texturing.main_config):
-        shader_dirty = true;
-        break;
-
-    // Texture 0 type
-    case PICA_REG_INDEX(texturing.texture0.type):
-        shader_dirty = true;
-        break;
-
-    // TEV stages
-    // (This also syncs fog_mode and fog_flip which are part of tev_combiner_buffer_input)
-    case PICA_REG_INDEX(texturing.tev_stage0.color_source1):
-    case PICA_REG_INDEX(texturing.tev_stage0.color_modifier1):
-    case PICA_REG_INDEX(texturing.tev_stage0.color_op):
-    case PICA_REG_INDEX(texturing.tev_stage0.color_scale):
-    case PICA_REG_INDEX(texturing.tev_stage1.color_source1):
-    case PICA_REG_INDEX(texturing.tev_stage1.color_modifier1):
-    case PICA_REG_INDEX(texturing.tev_stage1.color_op):
-    case PICA_REG_INDEX(texturing.tev_stage1.color_scale):
-    case PICA_REG_INDEX(texturing.tev_stage2.color_source1):
-    case PICA_REG_INDEX(texturing.tev_stage2.color_modifier1):
-    case PICA_REG_INDEX(texturing.tev_stage2.color_op):
-    case PICA_REG_INDEX(texturing.tev_stage2.color_scale):
-    case PICA_REG_INDEX(texturing.tev_stage3.color_source1):
-    case PICA_REG_INDEX(texturing.tev_stage3.color_modifier1):
-    case PICA_REG_INDEX(texturing.tev_stage3.color_op):
-    case PICA_REG_INDEX(texturing.tev_stage3.color_scale):
-    case PICA_REG_INDEX(texturing.tev_stage4.color_source1):
-    case PICA_REG_INDEX(texturing.tev_stage4.color_modifier1):
-    case PICA_REG_INDEX(texturing.tev_stage4.color_op):
-    case PICA_REG_INDEX(texturing.tev_stage4.color_scale):
-    case PICA_REG_INDEX(texturing.tev_stage5.color_source1):
-    case PICA_REG_INDEX(texturing.tev_stage5.color_modifier1):
-    case PICA_REG_INDEX(texturing.tev_stage5.color_op):
-    case PICA_REG_INDEX(texturing.tev_stage5.color_scale):
-    case PICA_REG_INDEX(texturing.tev_combiner_buffer_input):
-        shader_dirty = true;
-        break;
-    case PICA_REG_INDEX(texturing.tev_stage0.const_r):
-        SyncTevConstColor(0, regs.texturing.tev_stage0);
-        break;
-    case PICA_REG_INDEX(texturing.tev_stage1.const_r):
-        SyncTevConstColor(1, regs.texturing.tev_stage1);
-        break;
-    case PICA_REG_INDEX(texturing.tev_stage2.const_r):
-        SyncTevConstColor(2, regs.texturing.tev_stage2);
-        break;
-    case PICA_REG_INDEX(texturing.tev_stage3.const_r):
-        SyncTevConstColor(3, regs.texturing.tev_stage3);
-        break;
-    case PICA_REG_INDEX(texturing.tev_stage4.const_r):
-        SyncTevConstColor(4, regs.texturing.tev_stage4);
-        break;
-    case PICA_REG_INDEX(texturing.tev_stage5.const_r):
-        SyncTevConstColor(5, regs.texturing.tev_stage5);
-        break;
-
-    // TEV combiner buffer color
-    case PICA_REG_INDEX(texturing.tev_combiner_buffer_color):
-        SyncCombinerColor();
-        break;
-
-    // Fragment lighting switches
-    case PICA_REG_INDEX(lighting.disable):
-    case PICA_REG_INDEX(lighting.max_light_index):
-    case PICA_REG_INDEX(lighting.config0):
-    case PICA_REG_INDEX(lighting.config1):
-    case PICA_REG_INDEX(lighting.abs_lut_input):
-    case PICA_REG_INDEX(lighting.lut_input):
-    case PICA_REG_INDEX(lighting.lut_scale):
-    case PICA_REG_INDEX(lighting.light_enable):
-        break;
-
-    // Fragment lighting specular 0 color
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[0].specular_0, 0x140 + 0 * 0x10):
-        SyncLightSpecular0(0);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[1].specular_0, 0x140 + 1 * 0x10):
-        SyncLightSpecular0(1);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[2].specular_0, 0x140 + 2 * 0x10):
-        SyncLightSpecular0(2);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[3].specular_0, 0x140 + 3 * 0x10):
-        SyncLightSpecular0(3);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[4].specular_0, 0x140 + 4 * 0x10):
-        SyncLightSpecular0(4);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[5].specular_0, 0x140 + 5 * 0x10):
-        SyncLightSpecular0(5);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[6].specular_0, 0x140 + 6 * 0x10):
-        SyncLightSpecular0(6);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[7].specular_0, 0x140 + 7 * 0x10):
-        SyncLightSpecular0(7);
-        break;
-
-    // Fragment lighting specular 1 color
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[0].specular_1, 0x141 + 0 * 0x10):
-        SyncLightSpecular1(0);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[1].specular_1, 0x141 + 1 * 0x10):
-        SyncLightSpecular1(1);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[2].specular_1, 0x141 + 2 * 0x10):
-        SyncLightSpecular1(2);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[3].specular_1, 0x141 + 3 * 0x10):
-        SyncLightSpecular1(3);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[4].specular_1, 0x141 + 4 * 0x10):
-        SyncLightSpecular1(4);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[5].specular_1, 0x141 + 5 * 0x10):
-        SyncLightSpecular1(5);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[6].specular_1, 0x141 + 6 * 0x10):
-        SyncLightSpecular1(6);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[7].specular_1, 0x141 + 7 * 0x10):
-        SyncLightSpecular1(7);
-        break;
-
-    // Fragment lighting diffuse color
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[0].diffuse, 0x142 + 0 * 0x10):
-        SyncLightDiffuse(0);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[1].diffuse, 0x142 + 1 * 0x10):
-        SyncLightDiffuse(1);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[2].diffuse, 0x142 + 2 * 0x10):
-        SyncLightDiffuse(2);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[3].diffuse, 0x142 + 3 * 0x10):
-        SyncLightDiffuse(3);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[4].diffuse, 0x142 + 4 * 0x10):
-        SyncLightDiffuse(4);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[5].diffuse, 0x142 + 5 * 0x10):
-        SyncLightDiffuse(5);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[6].diffuse, 0x142 + 6 * 0x10):
-        SyncLightDiffuse(6);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[7].diffuse, 0x142 + 7 * 0x10):
-        SyncLightDiffuse(7);
-        break;
-
-    // Fragment lighting ambient color
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[0].ambient, 0x143 + 0 * 0x10):
-        SyncLightAmbient(0);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[1].ambient, 0x143 + 1 * 0x10):
-        SyncLightAmbient(1);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[2].ambient, 0x143 + 2 * 0x10):
-        SyncLightAmbient(2);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[3].ambient, 0x143 + 3 * 0x10):
-        SyncLightAmbient(3);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[4].ambient, 0x143 + 4 * 0x10):
-        SyncLightAmbient(4);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[5].ambient, 0x143 + 5 * 0x10):
-        SyncLightAmbient(5);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[6].ambient, 0x143 + 6 * 0x10):
-        SyncLightAmbient(6);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[7].ambient, 0x143 + 7 * 0x10):
-        SyncLightAmbient(7);
-        break;
-
-    // Fragment lighting position
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[0].x, 0x144 + 0 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[0].z, 0x145 + 0 * 0x10):
-        SyncLightPosition(0);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[1].x, 0x144 + 1 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[1].z, 0x145 + 1 * 0x10):
-        SyncLightPosition(1);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[2].x, 0x144 + 2 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[2].z, 0x145 + 2 * 0x10):
-        SyncLightPosition(2);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[3].x, 0x144 + 3 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[3].z, 0x145 + 3 * 0x10):
-        SyncLightPosition(3);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[4].x, 0x144 + 4 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[4].z, 0x145 + 4 * 0x10):
-        SyncLightPosition(4);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[5].x, 0x144 + 5 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[5].z, 0x145 + 5 * 0x10):
-        SyncLightPosition(5);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[6].x, 0x144 + 6 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[6].z, 0x145 + 6 * 0x10):
-        SyncLightPosition(6);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[7].x, 0x144 + 7 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[7].z, 0x145 + 7 * 0x10):
-        SyncLightPosition(7);
-        break;
-
-    // Fragment spot lighting direction
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[0].spot_x, 0x146 + 0 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[0].spot_z, 0x147 + 0 * 0x10):
-        SyncLightSpotDirection(0);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[1].spot_x, 0x146 + 1 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[1].spot_z, 0x147 + 1 * 0x10):
-        SyncLightSpotDirection(1);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[2].spot_x, 0x146 + 2 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[2].spot_z, 0x147 + 2 * 0x10):
-        SyncLightSpotDirection(2);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[3].spot_x, 0x146 + 3 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[3].spot_z, 0x147 + 3 * 0x10):
-        SyncLightSpotDirection(3);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[4].spot_x, 0x146 + 4 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[4].spot_z, 0x147 + 4 * 0x10):
-        SyncLightSpotDirection(4);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[5].spot_x, 0x146 + 5 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[5].spot_z, 0x147 + 5 * 0x10):
-        SyncLightSpotDirection(5);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[6].spot_x, 0x146 + 6 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[6].spot_z, 0x147 + 6 * 0x10):
-        SyncLightSpotDirection(6);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[7].spot_x, 0x146 + 7 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[7].spot_z, 0x147 + 7 * 0x10):
-        SyncLightSpotDirection(7);
-        break;
-
-    // Fragment lighting light source config
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[0].config, 0x149 + 0 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[1].config, 0x149 + 1 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[2].config, 0x149 + 2 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[3].config, 0x149 + 3 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[4].config, 0x149 + 4 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[5].config, 0x149 + 5 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[6].config, 0x149 + 6 * 0x10):
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[7].config, 0x149 + 7 * 0x10):
-        shader_dirty = true;
-        break;
-
-    // Fragment lighting distance attenuation bias
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[0].dist_atten_bias, 0x014A + 0 * 0x10):
-        SyncLightDistanceAttenuationBias(0);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[1].dist_atten_bias, 0x014A + 1 * 0x10):
-        SyncLightDistanceAttenuationBias(1);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[2].dist_atten_bias, 0x014A + 2 * 0x10):
-        SyncLightDistanceAttenuationBias(2);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[3].dist_atten_bias, 0x014A + 3 * 0x10):
-        SyncLightDistanceAttenuationBias(3);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[4].dist_atten_bias, 0x014A + 4 * 0x10):
-        SyncLightDistanceAttenuationBias(4);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[5].dist_atten_bias, 0x014A + 5 * 0x10):
-        SyncLightDistanceAttenuationBias(5);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[6].dist_atten_bias, 0x014A + 6 * 0x10):
-        SyncLightDistanceAttenuationBias(6);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[7].dist_atten_bias, 0x014A + 7 * 0x10):
-        SyncLightDistanceAttenuationBias(7);
-        break;
-
-    // Fragment lighting distance attenuation scale
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[0].dist_atten_scale, 0x014B + 0 * 0x10):
-        SyncLightDistanceAttenuationScale(0);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[1].dist_atten_scale, 0x014B + 1 * 0x10):
-        SyncLightDistanceAttenuationScale(1);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[2].dist_atten_scale, 0x014B + 2 * 0x10):
-        SyncLightDistanceAttenuationScale(2);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[3].dist_atten_scale, 0x014B + 3 * 0x10):
-        SyncLightDistanceAttenuationScale(3);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[4].dist_atten_scale, 0x014B + 4 * 0x10):
-        SyncLightDistanceAttenuationScale(4);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[5].dist_atten_scale, 0x014B + 5 * 0x10):
-        SyncLightDistanceAttenuationScale(5);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[6].dist_atten_scale, 0x014B + 6 * 0x10):
-        SyncLightDistanceAttenuationScale(6);
-        break;
-    case PICA_REG_INDEX_WORKAROUND(lighting.light[7].dist_atten_scale, 0x014B + 7 * 0x10):
-        SyncLightDistanceAttenuationScale(7);
-        break;
-
-    // Fragment lighting global ambient color (emission + ambient * ambient)
-    case PICA_REG_INDEX_WORKAROUND(lighting.global_ambient, 0x1c0):
-        SyncGlobalAmbient();
-        break;
+void RasterizerOpenGL::LoadDiskResources(u64 title_id) {
+    if (Settings::values.use_disk_shader_cache)
+        shader_program_manager->LoadDiskCache(title_id);
+}
 
-    // Fragment lighting lookup tables
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[0], 0x1c8):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[1], 0x1c9):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[2], 0x1ca):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[3], 0x1cb):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[4], 0x1cc):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[5], 0x1cd):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[6], 0x1ce):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[7], 0x1cf): {
-        auto& lut_config = regs.lighting.lut_config;
-        uniform_block_data.lighting_lut_dirty[lut_config.type] = true;
-        uniform_block_data.lighting_lut_dirty_any = true;
-        break;
-    }
-    }
+void RasterizerOpenGL::EndFrame() {
+    res_cache.EndFrame();
 }
 
 void RasterizerOpenGL::FlushAll() {
@@ -1591,8 +1257,12 @@ void RasterizerOpenGL::SamplerInfo::SyncWithConfig(
 }
 
 void RasterizerOpenGL::SetShader() {
+    using Selection = ShaderProgramManager::FragmentShaderSelection;
     auto config = PicaFSConfig::BuildFromRegs(Pica::g_state.regs);
-    shader_program_manager->UseFragmentShader(config);
+    const Selection selection = shader_program_manager->UseFragmentShader(config);
+    shader_dirty = false;
+    fragment_shader_pending = selection == Selection::UberPending;
+    uber_shader_block.Use(selection != Selection::Generated ? &config : nullptr);
 }
 
 void RasterizerOpenGL::SyncClipEnabled() {
@@ -1684,12 +1354,15 @@ void RasterizerOpenGL::SyncBlendColor() {
 
 void RasterizerOpenGL::SyncFogColor() {
     const auto& regs = Pica::g_state.regs;
-    uniform_block_data.data.fog_color = {
+    const GLvec3 fog_color = {
         regs.texturing.fog_color.r.Value() / 255.0f,
         regs.texturing.fog_color.g.Value() / 255.0f,
         regs.texturing.fog_color.b.Value() / 255.0f,
     };
-    uniform_block_data.dirty = true;
+    if (fog_color != uniform_block_data.data.fog_color) {
+        uniform_block_data.data.fog_color = fog_color;
+        uniform_block_data.dirty = true;
+    }
 }
 
 void RasterizerOpenGL::SyncProcTexNoise() {
@@ -1712,11 +1385,13 @@ void RasterizerOpenGL::SyncProcTexNoise() {
 
 void RasterizerOpenGL::SyncProcTexBias() {
     const auto& regs = Pica::g_state.regs.texturing;
-    uniform_block_data.data.proctex_bias =
+    const GLfloat proctex_bias =
         Pica::float16::FromRaw(regs.proctex.bias_low | (regs.proctex_lut.bias_high << 8))
             .ToFloat32();
-
-    uniform_block_data.dirty = true;
+    if (proctex_bias != uniform_block_data.data.proctex_bias) {
+        uniform_block_data.data.proctex_bias = proctex_bias;
+        uniform_block_data.dirty = true;
+    }
 }
 
 void RasterizerOpenGL::SyncAlphaTest() {
@@ -1906,13 +1581,71 @@ void RasterizerOpenGL::SyncShadowBias() {
     }
 }
 
-void RasterizerOpenGL::SyncAndUploadLUTs() {
-    constexpr std::size_t max_size = sizeof(GLvec2) * 256 * Pica::LightingRegs::NumLightingSampler +
-                                     sizeof(GLvec2) * 128 +     // fog
-                                     sizeof(GLvec2) * 128 * 3 + // proctex: noise + color + alpha
-                                     sizeof(GLvec4) * 256 +     // proctex
-                                     sizeof(GLvec4) * 256;      // proctex diff
+template <typename Entry, std::size_t N, typename Convert>
+GLintptr RasterizerOpenGL::SyncLUT(std::size_t binding, LUTType type,
+                                   const std::array<Entry, N>& table, Convert&& convert) {
+    using GLEntry = decltype(convert(table[0]));
+    constexpr std::size_t size = sizeof(GLEntry) * N;
+    static_assert(size <= LUT_SLOT_SIZE, "LUT does not fit into a slot");
+
+    const u64 hash = Common::CityHash64WithSeed(reinterpret_cast<const char*>(table.data()),
+                                                sizeof(table), static_cast<u64>(type));
+
+    const auto matches = [&](const LUTSlot& lut_slot) {
+        return lut_slot.type == type && lut_slot.table.size() == sizeof(table) &&
+               std::memcmp(lut_slot.table.data(), table.data(), sizeof(table)) == 0;
+    };
+
+    std::size_t slot;
+    const auto it = lut_slot_map.find(hash);
+    if (it != lut_slot_map.end() && matches(lut_slots[it->second])) {
+        slot = it->second;
+        lut_bytes_saved.Add(size);
+    } else {
+        // Replace the least recently used slot that no binding references. There are many more
+        // slots than bindings, so one is always available.
+        slot = NUM_LUT_SLOTS;
+        for (std::size_t i = 0; i < NUM_LUT_SLOTS; ++i) {
+            if (lut_slots[i].bindings == 0 &&
+                (slot == NUM_LUT_SLOTS || lut_slots[i].last_used < lut_slots[slot].last_used)) {
+                slot = i;
+            }
+        }
+        ASSERT(slot != NUM_LUT_SLOTS);
+        if (lut_slots[slot].last_used != 0) {
+            // After a hash collision, the hash may map to another slot already
+            const auto evicted = lut_slot_map.find(lut_slots[slot].hash);
+            if (evicted != lut_slot_map.end() && evicted->second == slot) {
+                lut_slot_map.erase(evicted);
+            }
+        }
+        lut_slots[slot].hash = hash;
+        lut_slots[slot].type = type;
+        lut_slots[slot].table.assign(reinterpret_cast<const u8*>(table.data()),
+                                     reinterpret_cast<const u8*>(table.data()) + sizeof(table));
+        lut_slot_map[hash] = slot;
+
+        std::array<GLEntry, N> new_data;
+        std::transform(table.begin(), table.end(), new_data.begin(), convert);
+        glBufferSubData(GL_TEXTURE_BUFFER, static_cast<GLintptr>(slot * LUT_SLOT_SIZE), size,
+                        new_data.data());
+        lut_bytes_uploaded.Add(size);
+    }
+    lut_slots[slot].last_used = ++lut_use_count;
+
+    std::size_t& bound_slot = lut_binding_slots[binding];
+    if (bound_slot != slot) {
+        if (bound_slot != NUM_LUT_SLOTS) {
+            --lut_slots[bound_slot].bindings;
+        }
+        ++lut_slots[slot].bindings;
+        bound_slot = slot;
+        uniform_block_data.dirty = true;
+    }
+    return static_cast<GLintptr>(slot * LUT_SLOT_SIZE);
+}
 
+void RasterizerOpenGL::SyncAndUploadLUTs() {
     if (!uniform_block_data.lighting_lut_dirty_any && !uniform_block_data.fog_lut_dirty &&
         !uniform_block_data.proctex_noise_lut_dirty &&
         !uniform_block_data.proctex_color_map_dirty &&
@@ -1921,141 +1654,79 @@ void RasterizerOpenGL::SyncAndUploadLUTs() {
         return;
     }
 
-    u8* buffer;
-    GLintptr offset;
-    bool invalidate;
-    std::size_t bytes_used = 0;
-    glBindBuffer(GL_TEXTURE_BUFFER, texture_buffer.GetHandle());
-    std::tie(buffer, offset, invalidate) = texture_buffer.Map(max_size, sizeof(GLvec4));
+    glBindBuffer(GL_TEXTURE_BUFFER, lut_buffer.handle);
+
+    const auto convert_value = [](const auto& entry) {
+        return GLvec2{entry.ToFloat(), entry.DiffToFloat()};
+    };
+    const auto convert_color = [](const auto& entry) {
+        auto rgba = entry.ToVector() / 255.0f;
+        return GLvec4{rgba.r(), rgba.g(), rgba.b(), rgba.a()};
+    };
 
     // Sync the lighting luts
-    if (uniform_block_data.lighting_lut_dirty_any || invalidate) {
+    if (uniform_block_data.lighting_lut_dirty_any) {
         for (unsigned index = 0; index < uniform_block_data.lighting_lut_dirty.size(); index++) {
-            if (uniform_block_data.lighting_lut_dirty[index] || invalidate) {
-                std::array<GLvec2, 256> new_data;
-                const auto& source_lut = Pica::g_state.lighting.luts[index];
-                std::transform(source_lut.begin(), source_lut.end(), new_data.begin(),
-                               [](const auto& entry) {
-                                   return GLvec2{entry.ToFloat(), entry.DiffToFloat()};
-                               });
-
-                if (new_data != lighting_lut_data[index] || invalidate) {
-                    lighting_lut_data[index] = new_data;
-                    std::memcpy(buffer + bytes_used, new_data.data(),
-                                new_data.size() * sizeof(GLvec2));
-                    uniform_block_data.data.lighting_lut_offset[index / 4][index % 4] =
-                        (offset + bytes_used) / sizeof(GLvec2);
-                    uniform_block_data.dirty = true;
-                    bytes_used += new_data.size() * sizeof(GLvec2);
-                }
+            if (uniform_block_data.lighting_lut_dirty[index]) {
+                const GLintptr offset = SyncLUT(index, LUTType::Lighting,
+                                                Pica::g_state.lighting.luts[index], convert_value);
+                uniform_block_data.data.lighting_lut_offset[index / 4][index % 4] =
+                    offset / sizeof(GLvec2);
                 uniform_block_data.lighting_lut_dirty[index] = false;
             }
         }
     }
     uniform_block_data.lighting_lut_dirty_any = false;
 
+    constexpr std::size_t fog_binding = Pica::LightingRegs::NumLightingSampler;
+
     // Sync the fog lut
-    if (uniform_block_data.fog_lut_dirty || invalidate) {
-        std::array<GLvec2, 128> new_data;
-
-        std::transform(Pica::g_state.fog.lut.begin(), Pica::g_state.fog.lut.end(), new_data.begin(),
-                       [](const auto& entry) {
-                           return GLvec2{entry.ToFloat(), entry.DiffToFloat()};
-                       });
-
-        if (new_data != fog_lut_data || invalidate) {
-            fog_lut_data = new_data;
-            std::memcpy(buffer + bytes_used, new_data.data(), new_data.size() * sizeof(GLvec2));
-            uniform_block_data.data.fog_lut_offset = (offset + bytes_used) / sizeof(GLvec2);
-            uniform_block_data.dirty = true;
-            bytes_used += new_data.size() * sizeof(GLvec2);
-        }
+    if (uniform_block_data.fog_lut_dirty) {
+        const GLintptr offset =
+            SyncLUT(fog_binding, LUTType::Fog, Pica::g_state.fog.lut, convert_value);
+        uniform_block_data.data.fog_lut_offset = offset / sizeof(GLvec2);
         uniform_block_data.fog_lut_dirty = false;
     }
 
-    // helper function for SyncProcTexNoiseLUT/ColorMap/AlphaMap
-    auto SyncProcTexValueLUT = [this, buffer, offset, invalidate, &bytes_used](
-                                   const std::array<Pica::State::ProcTex::ValueEntry, 128>& lut,
-                                   std::array<GLvec2, 128>& lut_data, GLint& lut_offset) {
-        std::array<GLvec2, 128> new_data;
-        std::transform(lut.begin(), lut.end(), new_data.begin(), [](const auto& entry) {
-            return GLvec2{entry.ToFloat(), entry.DiffToFloat()};
-        });
-
-        if (new_data != lut_data || invalidate) {
-            lut_data = new_data;
-            std::memcpy(buffer + bytes_used, new_data.data(), new_data.size() * sizeof(GLvec2));
-            lut_offset = (offset + bytes_used) / sizeof(GLvec2);
-            uniform_block_data.dirty = true;
-            bytes_used += new_data.size() * sizeof(GLvec2);
-        }
-    };
-
     // Sync the proctex noise lut
-    if (uniform_block_data.proctex_noise_lut_dirty || invalidate) {
-        SyncProcTexValueLUT(Pica::g_state.proctex.noise_table, proctex_noise_lut_data,
-                            uniform_block_data.data.proctex_noise_lut_offset);
+    if (uniform_block_data.proctex_noise_lut_dirty) {
+        const GLintptr offset = SyncLUT(fog_binding + 1, LUTType::ProcTexValue,
+                                        Pica::g_state.proctex.noise_table, convert_value);
+        uniform_block_data.data.proctex_noise_lut_offset = offset / sizeof(GLvec2);
         uniform_block_data.proctex_noise_lut_dirty = false;
     }
 
     // Sync the proctex color map
-    if (uniform_block_data.proctex_color_map_dirty || invalidate) {
-        SyncProcTexValueLUT(Pica::g_state.proctex.color_map_table, proctex_color_map_data,
-                            uniform_block_data.data.proctex_color_map_offset);
+    if (uniform_block_data.proctex_color_map_dirty) {
+        const GLintptr offset = SyncLUT(fog_binding + 2, LUTType::ProcTexValue,
+                                        Pica::g_state.proctex.color_map_table, convert_value);
+        uniform_block_data.data.proctex_color_map_offset = offset / sizeof(GLvec2);
         uniform_block_data.proctex_color_map_dirty = false;
     }
 
     // Sync the proctex alpha map
-    if (uniform_block_data.proctex_alpha_map_dirty || invalidate) {
-        SyncProcTexValueLUT(Pica::g_state.proctex.alpha_map_table, proctex_alpha_map_data,
-                            uniform_block_data.data.proctex_alpha_map_offset);
+    if (uniform_block_data.proctex_alpha_map_dirty) {
+        const GLintptr offset = SyncLUT(fog_binding + 3, LUTType::ProcTexValue,
+                                        Pica::g_state.proctex.alpha_map_table, convert_value);
+        uniform_block_data.data.proctex_alpha_map_offset = offset / sizeof(GLvec2);
         uniform_block_data.proctex_alpha_map_dirty = false;
     }
 
     // Sync the proctex lut
-    if (uniform_block_data.proctex_lut_dirty || invalidate) {
-        std::array<GLvec4, 256> new_data;
-
-        std::transform(Pica::g_state.proctex.color_table.begin(),
-                       Pica::g_state.proctex.color_table.end(), new_data.begin(),
-                       [](const auto& entry) {
-                           auto rgba = entry.ToVector() / 255.0f;
-                           return GLvec4{rgba.r(), rgba.g(), rgba.b(), rgba.a()};
-                       });
-
-        if (new_data != proctex_lut_data || invalidate) {
-            proctex_lut_data = new_data;
-            std::memcpy(buffer + bytes_used, new_data.data(), new_data.size() * sizeof(GLvec4));
-            uniform_block_data.data.proctex_lut_offset = (offset + bytes_used) / sizeof(GLvec4);
-            uniform_block_data.dirty = true;
-            bytes_used += new_data.size() * sizeof(GLvec4);
-        }
+    if (uniform_block_data.proctex_lut_dirty) {
+        const GLintptr offset = SyncLUT(fog_binding + 4, LUTType::ProcTexColor,
+                                        Pica::g_state.proctex.color_table, convert_color);
+        uniform_block_data.data.proctex_lut_offset = offset / sizeof(GLvec4);
         uniform_block_data.proctex_lut_dirty = false;
     }
 
     // Sync the proctex difference lut
-    if (uniform_block_data.proctex_diff_lut_dirty || invalidate) {
-        std::array<GLvec4, 256> new_data;
-
-        std::transform(Pica::g_state.proctex.color_diff_table.begin(),
-                       Pica::g_state.proctex.color_diff_table.end(), new_data.begin(),
-                       [](const auto& entry) {
-                           auto rgba = entry.ToVector() / 255.0f;
-                           return GLvec4{rgba.r(), rgba.g(), rgba.b(), rgba.a()};
-                       });
-
-        if (new_data != proctex_diff_lut_data || invalidate) {
-            proctex_diff_lut_data = new_data;
-            std::memcpy(buffer + bytes_used, new_data.data(), new_data.size() * sizeof(GLvec4));
-            uniform_block_data.data.proctex_diff_lut_offset =
-                (offset + bytes_used) / sizeof(GLvec4);
-            uniform_block_data.dirty = true;
-            bytes_used += new_data.size() * sizeof(GLvec4);
-        }
+    if (uniform_block_data.proctex_diff_lut_dirty) {
+        const GLintptr offset = SyncLUT(fog_binding + 5, LUTType::ProcTexColorDifference,
+                                        Pica::g_state.proctex.color_diff_table, convert_color);
+        uniform_block_data.data.proctex_diff_lut_offset = offset / sizeof(GLvec4);
         uniform_block_data.proctex_diff_lut_dirty = false;
     }
-
-    texture_buffer.Unmap(bytes_used);
 }
 
 void RasterizerOpenGL::UploadUniforms(bool accelerate_draw, bool use_gs) {
@@ -2067,12 +1738,13 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw, bool use_gs) {
     bool sync_vs = accelerate_draw;
     bool sync_gs = accelerate_draw && use_gs;
     bool sync_fs = uniform_block_data.dirty;
+    bool sync_fs_config = uber_shader_block.NeedsUpload(false);
 
-    if (!sync_vs && !sync_gs && !sync_fs)
+    if (!sync_vs && !sync_gs && !sync_fs && !sync_fs_config)
         return;
 
-    std::size_t uniform_size =
-        uniform_size_aligned_vs + uniform_size_aligned_gs + uniform_size_aligned_fs;
+    std::size_t uniform_size = uniform_size_aligned_vs + uniform_size_aligned_gs +
+                               uniform_size_aligned_fs + uniform_size_aligned_fs_config;
     std::size_t used_bytes = 0;
     u8* uniforms;
     GLintptr offset;
@@ -2106,6 +1778,16 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw, bool use_gs) {
         used_bytes += uniform_size_aligned_fs;
     }
 
+    if (uber_shader_block.NeedsUpload(invalidate)) {
+        std::memcpy(uniforms + used_bytes, &uber_shader_block.GetData(),
+                    sizeof(FSConfigUniformData));
+        glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBindings::FSConfig),
+                          uniform_buffer.GetHandle(), offset + used_bytes,
+                          sizeof(FSConfigUniformData));
+        uber_shader_block.MarkUploaded();
+        used_bytes += uniform_size_aligned_fs_config;
+    }
+
     uniform_buffer.Unmap(used_bytes);
 }
 
@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <cstring>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <glad/glad.h>
 #include "common/bit_field.h"
@@ -42,7 +43,6 @@ public:
     void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
                      const Pica::Shader::OutputVertex& v2) override;
     void DrawTriangles() override;
-    void NotifyPicaRegisterChanged(u32 id) override;
     void FlushAll() override;
     void FlushRegion(PAddr addr, u32 size) override;
     void InvalidateRegion(PAddr addr, u32 size) override;
@@ -53,6 +53,8 @@ public:
     bool AccelerateDisplay(const GPU::Regs::FramebufferConfig& config, PAddr framebuffer_addr,
                            u32 pixel_stride, ScreenInfo& screen_info) override;
     bool AccelerateDrawBatch(bool is_indexed) override;
+    void LoadDiskResources(u64 title_id) override;
+    void EndFrame() override;
 
 private:
     struct SamplerInfo {
@@ -121,13 +123,20 @@ private:
     /// Syncs entire status to match PICA registers
     void SyncEntireState();
 
+    /// Syncs the state groups that register writes marked dirty in Pica::g_state since the previous
+    /// draw
+    void SyncDirtyState();
+
     /// Syncs the clip enabled status to match the PICA register
     void SyncClipEnabled();
 
     /// Syncs the clip coefficients to match the PICA register
     void SyncClipCoef();
 
-    /// Sets the OpenGL shader in accordance with the current PICA register state
+    /**
+     * Sets the OpenGL shader in accordance with the current PICA register state. Leaves the shader
+     * dirty while the uber shader stands in for a fragment shader being compiled.
+     */
     void SetShader();
 
     /// Syncs the cull mode to match the PICA register
@@ -217,6 +226,24 @@ private:
     /// Syncs and uploads the lighting, fog and proctex LUTs
     void SyncAndUploadLUTs();
 
+    /// Tables that are converted differently into LUTs, and therefore hashed separately
+    enum class LUTType : u64 {
+        Lighting,
+        Fog,
+        ProcTexValue,
+        ProcTexColor,
+        ProcTexColorDifference,
+    };
+
+    /**
+     * Makes a LUT binding reference the LUT converted from a PICA table, which is only converted
+     * and uploaded if no slot of the LUT buffer holds it yet
+     * @returns Offset of the LUT in the LUT buffer in bytes
+     */
+    template <typename Entry, std::size_t N, typename Convert>
+    GLintptr SyncLUT(std::size_t binding, LUTType type, const std::array<Entry, N>& table,
+                     Convert&& convert);
+
     /// Upload the uniform blocks to the uniform buffer object
     void UploadUniforms(bool accelerate_draw, bool use_gs);
 
@@ -256,6 +283,8 @@ private:
     std::vector<HardwareVertex> vertex_batch;
 
     bool shader_dirty;
+    /// Whether the uber shader is used until the generated fragment shader finished compiling
+    bool fragment_shader_pending = false;
 
     struct {
         UniformData data;
@@ -270,13 +299,21 @@ private:
         bool dirty;
     } uniform_block_data = {};
 
+    /// Config of the uber shader, which stands in for shaders being compiled
+    UberShaderBlock uber_shader_block;
+
     std::unique_ptr<ShaderProgramManager> shader_program_manager;
 
     // They shall be big enough for about one frame.
     static constexpr std::size_t VERTEX_BUFFER_SIZE = 32 * 1024 * 1024;
     static constexpr std::size_t INDEX_BUFFER_SIZE = 1 * 1024 * 1024;
     static constexpr std::size_t UNIFORM_BUFFER_SIZE = 2 * 1024 * 1024;
-    static constexpr std::size_t TEXTURE_BUFFER_SIZE = 1 * 1024 * 1024;
+
+    /// Size of a slot of the LUT buffer, which fits the largest LUT
+    static constexpr std::size_t LUT_SLOT_SIZE = sizeof(GLvec4) * 256;
+    static constexpr std::size_t NUM_LUT_SLOTS = 256;
+    /// The lighting LUTs followed by the fog LUT and the five proctex LUTs
+    static constexpr std::size_t NUM_LUT_BINDINGS = Pica::LightingRegs::NumLightingSampler + 6;
 
     OGLVertexArray sw_vao; // VAO for software shader draw
     OGLVertexArray hw_vao; // VAO for hardware shader / accelerate draw
@@ -286,25 +323,38 @@ private:
     OGLStreamBuffer vertex_buffer;
     OGLStreamBuffer uniform_buffer;
     OGLStreamBuffer index_buffer;
-    OGLStreamBuffer texture_buffer;
     OGLFramebuffer framebuffer;
     GLint uniform_buffer_alignment;
     std::size_t uniform_size_aligned_vs;
     std::size_t uniform_size_aligned_gs;
     std::size_t uniform_size_aligned_fs;
+    std::size_t uniform_size_aligned_fs_config;
 
     SamplerInfo texture_cube_sampler;
 
     OGLTexture texture_buffer_lut_rg;
     OGLTexture texture_buffer_lut_rgba;
 
-    std::array<std::array<GLvec2, 256>, Pica::LightingRegs::NumLightingSampler> lighting_lut_data{};
-    std::array<GLvec2, 128> fog_lut_data{};
-    std::array<GLvec2, 128> proctex_noise_lut_data{};
-    std::array<GLvec2, 128> proctex_color_map_data{};
-    std::array<GLvec2, 128> proctex_alpha_map_data{};
-    std::array<GLvec4, 256> proctex_lut_data{};
-    std::array<GLvec4, 256> proctex_diff_lut_data{};
+    struct LUTSlot {
+        /// Hash of the PICA table the LUT was converted from
+        u64 hash = 0;
+        /// Type and raw contents of that table, compared on a hash match to rule out collisions
+        LUTType type{};
+        std::vector<u8> table;
+        /// Value of lut_use_count when the slot was last referenced, 0 if it is empty
+        u64 last_used = 0;
+        /// Number of bindings referencing the slot, which can only be replaced if there are none
+        u32 bindings = 0;
+    };
+
+    /// Buffer read through the LUT texture buffers, holding converted LUTs in fixed-size slots
+    OGLBuffer lut_buffer;
+    std::array<LUTSlot, NUM_LUT_SLOTS> lut_slots{};
+    /// Slot holding the LUT converted from the table with the given hash
+    std::unordered_map<u64, std::size_t> lut_slot_map;
+    /// Slot referenced by each binding, NUM_LUT_SLOTS if none
+    std::array<std::size_t, NUM_LUT_BINDINGS> lut_binding_slots;
+    u64 lut_use_count = 0;
 
     bool allow_shadow;
 };
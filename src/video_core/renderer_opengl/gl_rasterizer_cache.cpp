@@ -6,9 +6,11 @@
 #include <array>
 #include <atomic>
 #include <cstring>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <optional>
+#include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -17,13 +19,17 @@
 #include "common/alignment.h"
 #include "common/bit_field.h"
 #include "common/color.h"
+#include "common/counters.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
+#include "common/thread.h"
 #include "common/vector_math.h"
 #include "core/frontend/emu_window.h"
 #include "core/memory.h"
+#include "core/settings.h"
+#include "video_core/morton.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
@@ -36,12 +42,6 @@ namespace OpenGL {
 using SurfaceType = SurfaceParams::SurfaceType;
 using PixelFormat = SurfaceParams::PixelFormat;
 
-struct FormatTuple {
-    GLint internal_format;
-    GLenum format;
-    GLenum type;
-};
-
 static constexpr std::array<FormatTuple, 5> fb_format_tuples = {{
     {GL_RGBA8, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8},     // RGBA8
     {GL_RGB8, GL_BGR, GL_UNSIGNED_BYTE},              // RGB8
@@ -77,31 +77,80 @@ constexpr auto RangeFromInterval(Map& map, const Interval& interval) {
     return boost::make_iterator_range(map.equal_range(interval));
 }
 
+/// Large copies, such as framebuffers read back for the CPU, are split into bands of tiles that
+/// are copied in parallel
+constexpr u32 MinBandSize = 128 * 1024;
+constexpr u32 MaxBands = 4;
+
+/// Threads that copy all bands but the first, kept alive for the lifetime of the process so that
+/// copies don't pay for spawning threads. Only used from the thread that owns the surface cache.
+class BandWorkers {
+public:
+    BandWorkers() {
+        const u32 count = std::clamp(std::thread::hardware_concurrency(), 1u, MaxBands) - 1;
+        workers = std::vector<Worker>(count);
+        for (Worker& worker : workers) {
+            worker.thread = std::thread([&worker] {
+                Common::SetCurrentThreadName("MortonCopy");
+                while (true) {
+                    worker.start.Wait();
+                    if (!worker.job) {
+                        return;
+                    }
+                    worker.job();
+                    worker.done.Set();
+                }
+            });
+        }
+    }
+
+    ~BandWorkers() {
+        for (Worker& worker : workers) {
+            worker.job = nullptr;
+            worker.start.Set();
+            worker.thread.join();
+        }
+    }
+
+    /// Number of bands a copy can be split into, including the one copied by the caller
+    u32 MaxBandCount() const {
+        return static_cast<u32>(workers.size()) + 1;
+    }
+
+    /// Starts copying the band with the given index (starting at 1) on its worker
+    void Start(u32 band, std::function<void()> job) {
+        Worker& worker = workers[band - 1];
+        worker.job = std::move(job);
+        worker.start.Set();
+    }
+
+    /// Waits for the band with the given index to be copied
+    void Wait(u32 band) {
+        workers[band - 1].done.Wait();
+    }
+
+private:
+    struct Worker {
+        std::thread thread;
+        std::function<void()> job;
+        Common::Event start;
+        Common::Event done;
+    };
+
+    std::vector<Worker> workers;
+};
+
+static BandWorkers& GetBandWorkers() {
+    static BandWorkers band_workers;
+    return band_workers;
+}
+
 template <bool morton_to_gl, PixelFormat format>
 static void MortonCopyTile(u32 stride, u8* tile_buffer, u8* gl_buffer) {
     constexpr u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / 8;
     constexpr u32 gl_bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(format);
-    for (u32 y = 0; y < 8; ++y) {
-        for (u32 x = 0; x < 8; ++x) {
-            u8* tile_ptr = tile_buffer + VideoCore::MortonInterleave(x, y) * bytes_per_pixel;
-            u8* gl_ptr = gl_buffer + ((7 - y) * stride + x) * gl_bytes_per_pixel;
-            if (morton_to_gl) {
-                if (format == PixelFormat::D24S8) {
-                    gl_ptr[0] = tile_ptr[3];
-                    std::memcpy(gl_ptr + 1, tile_ptr, 3);
-                } else {
-                    std::memcpy(gl_ptr, tile_ptr, bytes_per_pixel);
-                }
-            } else {
-                if (format == PixelFormat::D24S8) {
-                    std::memcpy(tile_ptr, gl_ptr + 1, 3);
-                    tile_ptr[3] = gl_ptr[0];
-                } else {
-                    std::memcpy(tile_ptr, gl_ptr, bytes_per_pixel);
-                }
-            }
-        }
-    }
+    VideoCore::MortonCopyTile<morton_to_gl, bytes_per_pixel, gl_bytes_per_pixel,
+                              format == PixelFormat::D24S8>(stride, tile_buffer, gl_buffer);
 }
 
 template <bool morton_to_gl, PixelFormat format>
@@ -119,53 +168,85 @@ static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr
 
     ASSERT(!morton_to_gl || (aligned_start == start && aligned_end == end));
 
-    const u32 begin_pixel_index = (aligned_down_start - base) / bytes_per_pixel;
-    u32 x = (begin_pixel_index % (stride * 8)) / 8;
-    u32 y = (begin_pixel_index / (stride * 8)) * 8;
-
-    gl_buffer += ((height - 8 - y) * stride + x) * gl_bytes_per_pixel;
-
-    auto glbuf_next_tile = [&] {
-        x = (x + 8) % stride;
-        gl_buffer += 8 * gl_bytes_per_pixel;
-        if (!x) {
-            y += 8;
-            gl_buffer -= stride * 9 * gl_bytes_per_pixel;
-        }
+    const auto gl_tile_ptr = [&](PAddr tile_addr) {
+        const u32 pixel_index = (tile_addr - base) / bytes_per_pixel;
+        const u32 x = (pixel_index % (stride * 8)) / 8;
+        const u32 y = (pixel_index / (stride * 8)) * 8;
+        return gl_buffer + ((height - 8 - y) * stride + x) * gl_bytes_per_pixel;
     };
 
-    u8* tile_buffer = VideoCore::g_memory->GetPhysicalPointer(start);
+    u8* const start_buffer = VideoCore::g_memory->GetPhysicalPointer(start);
+    u8* const tile_buffer = start_buffer + (aligned_start - start);
 
     if (start < aligned_start && !morton_to_gl) {
         std::array<u8, tile_size> tmp_buf;
-        MortonCopyTile<morton_to_gl, format>(stride, &tmp_buf[0], gl_buffer);
-        std::memcpy(tile_buffer, &tmp_buf[start - aligned_down_start],
+        MortonCopyTile<morton_to_gl, format>(stride, &tmp_buf[0], gl_tile_ptr(aligned_down_start));
+        std::memcpy(start_buffer, &tmp_buf[start - aligned_down_start],
                     std::min(aligned_start, end) - start);
-
-        tile_buffer += aligned_start - start;
-        glbuf_next_tile();
     }
 
-    const u8* const buffer_end = tile_buffer + aligned_end - aligned_start;
-    PAddr current_paddr = aligned_start;
-    while (tile_buffer < buffer_end) {
+    u32 num_tiles = aligned_end > aligned_start ? (aligned_end - aligned_start) / tile_size : 0;
+    const u32 full_tiles = num_tiles;
+    const u8* const tiles_end =
+        VideoCore::g_memory->GetPhysicalPointer(aligned_start + num_tiles * tile_size);
+    if (num_tiles > 0 &&
+        (tiles_end == nullptr ||
+         tiles_end - tile_buffer != static_cast<std::ptrdiff_t>(num_tiles * tile_size))) {
         // Pokemon Super Mystery Dungeon will try to use textures that go beyond
         // the end address of VRAM. Stop reading if reaches invalid address
-        if (!VideoCore::g_memory->IsValidPhysicalAddress(current_paddr) ||
-            !VideoCore::g_memory->IsValidPhysicalAddress(current_paddr + tile_size)) {
-            LOG_ERROR(Render_OpenGL, "Out of bound texture");
-            break;
+        for (u32 tile = 0; tile < num_tiles; ++tile) {
+            const PAddr tile_addr = aligned_start + tile * tile_size;
+            if (!VideoCore::g_memory->IsValidPhysicalAddress(tile_addr) ||
+                !VideoCore::g_memory->IsValidPhysicalAddress(tile_addr + tile_size)) {
+                LOG_ERROR(Render_OpenGL, "Out of bound texture");
+                num_tiles = tile;
+                break;
+            }
         }
-        MortonCopyTile<morton_to_gl, format>(stride, tile_buffer, gl_buffer);
-        tile_buffer += tile_size;
-        current_paddr += tile_size;
-        glbuf_next_tile();
     }
 
-    if (end > std::max(aligned_start, aligned_end) && !morton_to_gl) {
+    const auto copy_tiles = [&](u32 first_tile, u32 count) {
+        const PAddr first_tile_addr = aligned_start + first_tile * tile_size;
+        u32 x = ((first_tile_addr - base) / bytes_per_pixel % (stride * 8)) / 8;
+        u8* gl_ptr = gl_tile_ptr(first_tile_addr);
+        u8* tile_ptr = tile_buffer + first_tile * tile_size;
+        for (u32 tile = 0; tile < count; ++tile) {
+            MortonCopyTile<morton_to_gl, format>(stride, tile_ptr, gl_ptr);
+            tile_ptr += tile_size;
+            x += 8;
+            gl_ptr += 8 * gl_bytes_per_pixel;
+            if (x == stride) {
+                x = 0;
+                gl_ptr -= stride * 9 * gl_bytes_per_pixel;
+            }
+        }
+    };
+
+    const u32 num_bands = std::clamp(num_tiles * tile_size / MinBandSize, 1u,
+                                     GetBandWorkers().MaxBandCount());
+    if (num_bands > 1) {
+        BandWorkers& band_workers = GetBandWorkers();
+        const u32 tiles_per_band = (num_tiles + num_bands - 1) / num_bands;
+        for (u32 band = 1; band < num_bands; ++band) {
+            const u32 first_tile = band * tiles_per_band;
+            const u32 count = std::min(tiles_per_band, num_tiles - first_tile);
+            band_workers.Start(band, [&copy_tiles, first_tile, count] {
+                copy_tiles(first_tile, count);
+            });
+        }
+        copy_tiles(0, tiles_per_band);
+        for (u32 band = 1; band < num_bands; ++band) {
+            band_workers.Wait(band);
+        }
+    } else {
+        copy_tiles(0, num_tiles);
+    }
+
+    if (end > std::max(aligned_start, aligned_end) && !morton_to_gl && num_tiles == full_tiles) {
+        const PAddr tail_start = std::max(aligned_start, aligned_end);
         std::array<u8, tile_size> tmp_buf;
-        MortonCopyTile<morton_to_gl, format>(stride, &tmp_buf[0], gl_buffer);
-        std::memcpy(tile_buffer, &tmp_buf[0], end - aligned_end);
+        MortonCopyTile<morton_to_gl, format>(stride, &tmp_buf[0], gl_tile_ptr(tail_start));
+        std::memcpy(start_buffer + (tail_start - start), &tmp_buf[0], end - tail_start);
     }
 }
 
@@ -514,6 +595,13 @@ bool SurfaceParams::CanTexCopy(const SurfaceParams& texcopy_params) const {
     return FromInterval(texcopy_params.GetInterval()).GetInterval() == texcopy_params.GetInterval();
 }
 
+CachedSurface::~CachedSurface() {
+    if (texture.handle != 0) {
+        owner.RecycleTexture(GetFormatTuple(pixel_format), GetScaledWidth(), GetScaledHeight(),
+                             std::move(texture));
+    }
+}
+
 bool CachedSurface::CanFill(const SurfaceParams& dest_surface,
                             SurfaceInterval fill_interval) const {
     if (type == SurfaceType::Fill && IsRegionValid(fill_interval) &&
@@ -688,6 +776,10 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
 }
 
 MICROPROFILE_DEFINE(OpenGL_SurfaceFlush, "OpenGL", "Surface Flush", MP_RGB(128, 192, 64));
+static const Common::Counters::Counter surface_flushes = Common::Counters::Register(
+    "citra_surface_flushes_total", "Surface regions written back to emulated memory");
+static const Common::Counters::Counter surface_flush_bytes = Common::Counters::Register(
+    "citra_surface_flush_bytes_total", "Bytes of surfaces written back to emulated memory");
 void CachedSurface::FlushGLBuffer(PAddr flush_start, PAddr flush_end) {
     u8* const dst_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
     if (dst_buffer == nullptr)
@@ -704,6 +796,8 @@ void CachedSurface::FlushGLBuffer(PAddr flush_start, PAddr flush_end) {
         flush_start = Memory::VRAM_VADDR;
 
     MICROPROFILE_SCOPE(OpenGL_SurfaceFlush);
+    surface_flushes.Add();
+    surface_flush_bytes.Add(flush_end - flush_start);
 
     ASSERT(flush_start >= addr && flush_end <= end);
     const u32 start_offset = flush_start - addr;
@@ -733,12 +827,18 @@ void CachedSurface::FlushGLBuffer(PAddr flush_start, PAddr flush_end) {
 }
 
 MICROPROFILE_DEFINE(OpenGL_TextureUL, "OpenGL", "Texture Upload", MP_RGB(128, 192, 64));
+static const Common::Counters::Counter surface_uploads = Common::Counters::Register(
+    "citra_surface_uploads_total", "Surface regions uploaded to the host GPU");
+static const Common::Counters::Counter surface_upload_bytes = Common::Counters::Register(
+    "citra_surface_upload_bytes_total", "Bytes of surfaces uploaded to the host GPU");
 void CachedSurface::UploadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint read_fb_handle,
                                     GLuint draw_fb_handle) {
     if (type == SurfaceType::Fill)
         return;
 
     MICROPROFILE_SCOPE(OpenGL_TextureUL);
+    surface_uploads.Add();
+    surface_upload_bytes.Add(rect.GetWidth() * rect.GetHeight() * GetGLBytesPerPixel(pixel_format));
 
     ASSERT(gl_buffer_size == width * height * GetGLBytesPerPixel(pixel_format));
 
@@ -757,8 +857,7 @@ void CachedSurface::UploadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint
         x0 = 0;
         y0 = 0;
 
-        unscaled_tex.Create();
-        AllocateSurfaceTexture(unscaled_tex.handle, tuple, rect.GetWidth(), rect.GetHeight());
+        unscaled_tex = owner.AllocateTexture(tuple, rect.GetWidth(), rect.GetHeight());
         target_tex = unscaled_tex.handle;
     }
 
@@ -791,6 +890,7 @@ void CachedSurface::UploadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint
 
         BlitTextures(unscaled_tex.handle, {0, rect.GetHeight(), rect.GetWidth(), 0}, texture.handle,
                      scaled_rect, type, read_fb_handle, draw_fb_handle);
+        owner.RecycleTexture(tuple, rect.GetWidth(), rect.GetHeight(), std::move(unscaled_tex));
     }
 
     InvalidateAllWatcher();
@@ -829,11 +929,9 @@ void CachedSurface::DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLui
         scaled_rect.right *= res_scale;
         scaled_rect.bottom *= res_scale;
 
-        OGLTexture unscaled_tex;
-        unscaled_tex.Create();
+        OGLTexture unscaled_tex = owner.AllocateTexture(tuple, rect.GetWidth(), rect.GetHeight());
 
         MathUtil::Rectangle<u32> unscaled_tex_rect{0, rect.GetHeight(), rect.GetWidth(), 0};
-        AllocateSurfaceTexture(unscaled_tex.handle, tuple, rect.GetWidth(), rect.GetHeight());
         BlitTextures(texture.handle, scaled_rect, unscaled_tex.handle, unscaled_tex_rect, type,
                      read_fb_handle, draw_fb_handle);
 
@@ -842,6 +940,7 @@ void CachedSurface::DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLui
 
         glActiveTexture(GL_TEXTURE0);
         glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, &gl_buffer[buffer_offset]);
+        owner.RecycleTexture(tuple, rect.GetWidth(), rect.GetHeight(), std::move(unscaled_tex));
     } else {
         state.ResetTexture(texture.handle);
         state.draw.read_framebuffer = read_fb_handle;
@@ -884,95 +983,118 @@ constexpr MatchFlags operator|(MatchFlags lhs, MatchFlags rhs) {
     return static_cast<MatchFlags>(static_cast<int>(lhs) | static_cast<int>(rhs));
 }
 
-/// Get the best surface match (and its match type) for the given flags
-template <MatchFlags find_flags>
-Surface FindMatch(const SurfaceCache& surface_cache, const SurfaceParams& params,
-                  ScaleMatch match_scale_type,
-                  std::optional<SurfaceInterval> validate_interval = {}) {
+/**
+ * Get the best surface match (and its match type) for the given flags among the surfaces that
+ * for_each_candidate passes to the callback it is given
+ */
+template <MatchFlags find_flags, typename ForEachCandidate>
+Surface FindMatchIn(ForEachCandidate&& for_each_candidate, const SurfaceParams& params,
+                    ScaleMatch match_scale_type,
+                    std::optional<SurfaceInterval> validate_interval = {}) {
     Surface match_surface = nullptr;
     bool match_valid = false;
     u32 match_scale = 0;
     SurfaceInterval match_interval{};
 
-    for (auto& pair : RangeFromInterval(surface_cache, params.GetInterval())) {
-        for (auto& surface : pair.second) {
-            bool res_scale_matched = match_scale_type == ScaleMatch::Exact
-                                         ? (params.res_scale == surface->res_scale)
-                                         : (params.res_scale <= surface->res_scale);
-            // validity will be checked in GetCopyableInterval
-            bool is_valid =
-                find_flags & MatchFlags::Copy
-                    ? true
-                    : surface->IsRegionValid(validate_interval.value_or(params.GetInterval()));
-
-            if (!(find_flags & MatchFlags::Invalid) && !is_valid)
-                continue;
+    for_each_candidate([&](const Surface& surface) {
+        bool res_scale_matched = match_scale_type == ScaleMatch::Exact
+                                     ? (params.res_scale == surface->res_scale)
+                                     : (params.res_scale <= surface->res_scale);
+        // validity will be checked in GetCopyableInterval
+        bool is_valid =
+            find_flags & MatchFlags::Copy
+                ? true
+                : surface->IsRegionValid(validate_interval.value_or(params.GetInterval()));
+
+        if (!(find_flags & MatchFlags::Invalid) && !is_valid)
+            return;
+
+        auto IsMatch_Helper = [&](auto check_type, auto match_fn) {
+            if (!(find_flags & check_type))
+                return;
+
+            bool matched;
+            SurfaceInterval surface_interval;
+            std::tie(matched, surface_interval) = match_fn();
+            if (!matched)
+                return;
+
+            if (!res_scale_matched && match_scale_type != ScaleMatch::Ignore &&
+                surface->type != SurfaceType::Fill)
+                return;
+
+            // Found a match, update only if this is better than the previous one
+            auto UpdateMatch = [&] {
+                match_surface = surface;
+                match_valid = is_valid;
+                match_scale = surface->res_scale;
+                match_interval = surface_interval;
+            };
 
-            auto IsMatch_Helper = [&](auto check_type, auto match_fn) {
-                if (!(find_flags & check_type))
-                    return;
-
-                bool matched;
-                SurfaceInterval surface_interval;
-                std::tie(matched, surface_interval) = match_fn();
-                if (!matched)
-                    return;
-
-                if (!res_scale_matched && match_scale_type != ScaleMatch::Ignore &&
-                    surface->type != SurfaceType::Fill)
-                    return;
-
-                // Found a match, update only if this is better than the previous one
-                auto UpdateMatch = [&] {
-                    match_surface = surface;
-                    match_valid = is_valid;
-                    match_scale = surface->res_scale;
-                    match_interval = surface_interval;
-                };
-
-                if (surface->res_scale > match_scale) {
-                    UpdateMatch();
-                    return;
-                } else if (surface->res_scale < match_scale) {
-                    return;
-                }
+            if (surface->res_scale > match_scale) {
+                UpdateMatch();
+                return;
+            } else if (surface->res_scale < match_scale) {
+                return;
+            }
 
-                if (is_valid && !match_valid) {
-                    UpdateMatch();
-                    return;
-                } else if (is_valid != match_valid) {
-                    return;
-                }
+            if (is_valid && !match_valid) {
+                UpdateMatch();
+                return;
+            } else if (is_valid != match_valid) {
+                return;
+            }
 
-                if (boost::icl::length(surface_interval) > boost::icl::length(match_interval)) {
-                    UpdateMatch();
-                }
-            };
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Exact>{}, [&] {
-                return std::make_pair(surface->ExactMatch(params), surface->GetInterval());
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::SubRect>{}, [&] {
-                return std::make_pair(surface->CanSubRect(params), surface->GetInterval());
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Copy>{}, [&] {
-                ASSERT(validate_interval);
-                auto copy_interval =
-                    params.FromInterval(*validate_interval).GetCopyableInterval(surface);
-                bool matched = boost::icl::length(copy_interval & *validate_interval) != 0 &&
-                               surface->CanCopy(params, copy_interval);
-                return std::make_pair(matched, copy_interval);
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Expand>{}, [&] {
-                return std::make_pair(surface->CanExpand(params), surface->GetInterval());
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::TexCopy>{}, [&] {
-                return std::make_pair(surface->CanTexCopy(params), surface->GetInterval());
-            });
-        }
-    }
+            if (boost::icl::length(surface_interval) > boost::icl::length(match_interval)) {
+                UpdateMatch();
+            }
+        };
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Exact>{}, [&] {
+            return std::make_pair(surface->ExactMatch(params), surface->GetInterval());
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::SubRect>{}, [&] {
+            return std::make_pair(surface->CanSubRect(params), surface->GetInterval());
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Copy>{}, [&] {
+            ASSERT(validate_interval);
+            auto copy_interval =
+                params.FromInterval(*validate_interval).GetCopyableInterval(surface);
+            bool matched = boost::icl::length(copy_interval & *validate_interval) != 0 &&
+                           surface->CanCopy(params, copy_interval);
+            return std::make_pair(matched, copy_interval);
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Expand>{}, [&] {
+            return std::make_pair(surface->CanExpand(params), surface->GetInterval());
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::TexCopy>{}, [&] {
+            return std::make_pair(surface->CanTexCopy(params), surface->GetInterval());
+        });
+    });
     return match_surface;
 }
 
+/// Get the best surface match (and its match type) for the given flags
+template <MatchFlags find_flags>
+Surface FindMatch(const SurfaceCache& surface_cache, const SurfaceParams& params,
+                  ScaleMatch match_scale_type,
+                  std::optional<SurfaceInterval> validate_interval = {}) {
+    const SurfaceInterval interval = params.GetInterval();
+    const auto for_each_overlapping = [&](const auto& consider) {
+        for (auto& pair : RangeFromInterval(surface_cache, interval)) {
+            for (auto& surface : pair.second) {
+                // A surface is part of every segment it overlaps, so it was already considered
+                // with the previous segment unless that one is outside of the interval
+                if (std::max(surface->addr, boost::icl::first(interval)) <
+                    boost::icl::first(pair.first))
+                    continue;
+                consider(surface);
+            }
+        }
+    };
+    return FindMatchIn<find_flags>(for_each_overlapping, params, match_scale_type,
+                                   validate_interval);
+}
+
 RasterizerCacheOpenGL::RasterizerCacheOpenGL() {
     read_framebuffer.Create();
     draw_framebuffer.Create();
@@ -1115,9 +1237,14 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, ScaleMatc
 
     ASSERT(!params.is_tiled || (params.width % 8 == 0 && params.height % 8 == 0));
 
-    // Check for an exact match in existing surfaces
-    Surface surface =
-        FindMatch<MatchFlags::Exact | MatchFlags::Invalid>(surface_cache, params, match_res_scale);
+    // Check for an exact match in existing surfaces, which can only start at the same address
+    const auto same_addr = surfaces_by_addr.equal_range(params.addr);
+    const auto for_each_same_addr = [&](const auto& consider) {
+        for (const auto& pair : boost::make_iterator_range(same_addr))
+            consider(pair.second);
+    };
+    Surface surface = FindMatchIn<MatchFlags::Exact | MatchFlags::Invalid>(
+        for_each_same_addr, params, match_res_scale);
 
     if (surface == nullptr) {
         u16 target_res_scale = params.res_scale;
@@ -1150,6 +1277,7 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, ScaleMatc
         ValidateSurface(surface, params.addr, params.size);
     }
 
+    TouchSurface(surface);
     return surface;
 }
 
@@ -1229,6 +1357,7 @@ SurfaceRect_Tuple RasterizerCacheOpenGL::GetSurfaceSubRect(const SurfaceParams&
         ValidateSurface(surface, aligned_params.addr, aligned_params.size);
     }
 
+    TouchSurface(surface);
     return std::make_tuple(surface, surface->GetScaledSubRect(params));
 }
 
@@ -1448,7 +1577,7 @@ SurfaceSurfaceRect_Tuple RasterizerCacheOpenGL::GetFramebufferSurfaces(
 }
 
 Surface RasterizerCacheOpenGL::GetFillSurface(const GPU::Regs::MemoryFillConfig& config) {
-    Surface new_surface = std::make_shared<CachedSurface>();
+    Surface new_surface = std::make_shared<CachedSurface>(*this);
 
     new_surface->addr = config.GetStartAddress();
     new_surface->end = config.GetEndAddress();
@@ -1466,6 +1595,7 @@ Surface RasterizerCacheOpenGL::GetFillSurface(const GPU::Regs::MemoryFillConfig&
     }
 
     RegisterSurface(new_surface);
+    TouchSurface(new_surface);
     return new_surface;
 }
 
@@ -1491,6 +1621,7 @@ SurfaceRect_Tuple RasterizerCacheOpenGL::GetTexCopySurface(const SurfaceParams&
         }
 
         rect = match_surface->GetScaledSubRect(match_subrect);
+        TouchSurface(match_surface);
     }
 
     return std::make_tuple(match_surface, rect);
@@ -1568,13 +1699,32 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
             }
         }
 
-        // Load data from 3DS memory
+        // Load data from 3DS memory. An interval that only partially covers a row of tiles is
+        // split at the row boundary, so that only the touched tiles of that row are reloaded
+        // instead of the whole rows spanned by the interval.
+        const u32 row_bytes = surface->BytesInPixels(surface->stride * (surface->is_tiled ? 8 : 1));
+        const u32 start_offset = boost::icl::first(interval) - surface->addr;
+        const u32 end_offset = boost::icl::last_next(interval) - surface->addr;
+        u32 load_end_offset = end_offset;
+        if (start_offset % row_bytes != 0) {
+            load_end_offset = std::min(end_offset, Common::AlignUp(start_offset + 1, row_bytes));
+        } else if (Common::AlignDown(end_offset, row_bytes) > start_offset) {
+            load_end_offset = Common::AlignDown(end_offset, row_bytes);
+        }
+        params = surface->FromInterval(
+            SurfaceInterval(surface->addr + start_offset, surface->addr + load_end_offset));
+
         FlushRegion(params.addr, params.size);
         surface->LoadGLBuffer(params.addr, params.end);
         surface->UploadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
                                  draw_framebuffer.handle);
         surface->invalid_regions.erase(params.GetInterval());
+        frame_upload_bytes +=
+            params.width * params.height * CachedSurface::GetGLBytesPerPixel(params.pixel_format);
     }
+
+    if (!surface->unwatched_pages.empty())
+        WatchValidPages(surface);
 }
 
 void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, Surface flush_surface) {
@@ -1625,6 +1775,9 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
         // Surfaces can't have a gap
         ASSERT(region_owner->width == region_owner->stride);
         region_owner->invalid_regions.erase(invalid_interval);
+        // CPU accesses to the rendered region have to trap again so that it gets flushed
+        if (!region_owner->unwatched_pages.empty())
+            WatchPages(region_owner, invalid_interval);
     }
 
     for (auto& pair : RangeFromInterval(surface_cache, invalid_interval)) {
@@ -1635,6 +1788,17 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
             // If cpu is invalidating this region we want to remove it
             // to (likely) mark the memory pages as uncached
             if (region_owner == nullptr && size <= 8) {
+                // Textures are never written by the GPU, and color surfaces without dirty regions
+                // are not holding any rendering that is missing from memory. Only the written
+                // pages of those have to be reloaded, they are left unwatched until then so that
+                // further writes don't trap.
+                if (cached_surface->type == SurfaceType::Texture ||
+                    (cached_surface->type == SurfaceType::Color &&
+                     !HasDirtyRegions(cached_surface))) {
+                    UnwatchPages(cached_surface, cached_surface->GetInterval() & invalid_interval);
+                    continue;
+                }
+
                 FlushRegion(cached_surface->addr, cached_surface->size, cached_surface);
                 remove_surfaces.emplace(cached_surface);
                 continue;
@@ -1675,15 +1839,13 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
 }
 
 Surface RasterizerCacheOpenGL::CreateSurface(const SurfaceParams& params) {
-    Surface surface = std::make_shared<CachedSurface>();
+    Surface surface = std::make_shared<CachedSurface>(*this);
     static_cast<SurfaceParams&>(*surface) = params;
 
-    surface->texture.Create();
-
     surface->gl_buffer_size = 0;
     surface->invalid_regions.insert(surface->GetInterval());
-    AllocateSurfaceTexture(surface->texture.handle, GetFormatTuple(surface->pixel_format),
-                           surface->GetScaledWidth(), surface->GetScaledHeight());
+    surface->texture = AllocateTexture(GetFormatTuple(surface->pixel_format),
+                                       surface->GetScaledWidth(), surface->GetScaledHeight());
 
     return surface;
 }
@@ -1694,6 +1856,8 @@ void RasterizerCacheOpenGL::RegisterSurface(const Surface& surface) {
     }
     surface->registered = true;
     surface_cache.add({surface->GetInterval(), SurfaceSet{surface}});
+    surfaces_by_addr.emplace(surface->addr, surface);
+    cache_memory += surface->GetMemoryUsage();
     UpdatePagesCachedCount(surface->addr, surface->size, 1);
 }
 
@@ -1702,8 +1866,18 @@ void RasterizerCacheOpenGL::UnregisterSurface(const Surface& surface) {
         return;
     }
     surface->registered = false;
-    UpdatePagesCachedCount(surface->addr, surface->size, -1);
+    for (const auto& interval : SurfaceRegions(surface->GetInterval()) - surface->unwatched_pages) {
+        UpdatePagesCachedCount(boost::icl::first(interval), boost::icl::length(interval), -1);
+    }
+    surface->unwatched_pages.clear();
     surface_cache.subtract({surface->GetInterval(), SurfaceSet{surface}});
+
+    const auto same_addr = surfaces_by_addr.equal_range(surface->addr);
+    const auto it = std::find_if(same_addr.first, same_addr.second,
+                                 [&surface](const auto& pair) { return pair.second == surface; });
+    ASSERT(it != same_addr.second);
+    surfaces_by_addr.erase(it);
+    cache_memory -= surface->GetMemoryUsage();
 }
 
 void RasterizerCacheOpenGL::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
@@ -1740,4 +1914,139 @@ void RasterizerCacheOpenGL::UpdatePagesCachedCount(PAddr addr, u32 size, int del
         cached_pages.add({pages_interval, delta});
 }
 
+bool RasterizerCacheOpenGL::HasDirtyRegions(const Surface& surface) const {
+    for (const auto& pair : RangeFromInterval(dirty_regions, surface->GetInterval())) {
+        if (pair.second == surface)
+            return true;
+    }
+    return false;
+}
+
+void RasterizerCacheOpenGL::UnwatchPages(const Surface& surface, SurfaceInterval interval) {
+    for (PAddr page_start = Common::AlignDown(boost::icl::first(interval), Memory::PAGE_SIZE);
+         page_start < boost::icl::last_next(interval); page_start += Memory::PAGE_SIZE) {
+        const SurfaceInterval page_interval(page_start, page_start + Memory::PAGE_SIZE);
+        if (boost::icl::contains(surface->unwatched_pages, page_interval))
+            continue;
+
+        surface->invalid_regions.insert(page_interval & surface->GetInterval());
+        surface->unwatched_pages.insert(page_interval);
+        UpdatePagesCachedCount(page_start, Memory::PAGE_SIZE, -1);
+    }
+}
+
+void RasterizerCacheOpenGL::WatchPages(const Surface& surface, SurfaceInterval interval) {
+    const SurfaceRegions unwatched_pages = surface->unwatched_pages;
+    for (const auto& unwatched : unwatched_pages) {
+        for (PAddr page_start = boost::icl::first(unwatched);
+             page_start < boost::icl::last_next(unwatched); page_start += Memory::PAGE_SIZE) {
+            const SurfaceInterval page_interval(page_start, page_start + Memory::PAGE_SIZE);
+            if (boost::icl::is_empty(page_interval & interval))
+                continue;
+
+            surface->unwatched_pages.erase(page_interval);
+            UpdatePagesCachedCount(page_start, Memory::PAGE_SIZE, 1);
+        }
+    }
+}
+
+void RasterizerCacheOpenGL::WatchValidPages(const Surface& surface) {
+    const SurfaceRegions unwatched_pages = surface->unwatched_pages;
+    for (const auto& interval : unwatched_pages) {
+        for (PAddr page_start = boost::icl::first(interval);
+             page_start < boost::icl::last_next(interval); page_start += Memory::PAGE_SIZE) {
+            const SurfaceInterval page_interval(page_start, page_start + Memory::PAGE_SIZE);
+            if (!surface->IsRegionValid(page_interval & surface->GetInterval()))
+                continue;
+
+            surface->unwatched_pages.erase(page_interval);
+            UpdatePagesCachedCount(page_start, Memory::PAGE_SIZE, 1);
+        }
+    }
+}
+
+/// Number of frames a released texture is kept for reuse before it is deleted
+constexpr u64 TextureRecycleFrames = 60;
+
+OGLTexture RasterizerCacheOpenGL::AllocateTexture(const FormatTuple& format_tuple, u32 width,
+                                                  u32 height) {
+    const auto it = host_texture_recycler.find({format_tuple, width, height});
+    if (it != host_texture_recycler.end()) {
+        OGLTexture texture = std::move(it->second.texture);
+        host_texture_recycler.erase(it);
+        return texture;
+    }
+
+    OGLTexture texture;
+    texture.Create();
+    AllocateSurfaceTexture(texture.handle, format_tuple, width, height);
+    return texture;
+}
+
+void RasterizerCacheOpenGL::RecycleTexture(const FormatTuple& format_tuple, u32 width, u32 height,
+                                           OGLTexture&& texture) {
+    host_texture_recycler.emplace(HostTextureTag{format_tuple, width, height},
+                                  RecycledTexture{std::move(texture), current_frame});
+}
+
+void RasterizerCacheOpenGL::TouchSurface(const Surface& surface) {
+    surface->last_used_frame = current_frame;
+}
+
+MICROPROFILE_DEFINE(OpenGL_EvictSurfaces, "OpenGL", "Surface Eviction", MP_RGB(192, 64, 64));
+void RasterizerCacheOpenGL::EvictSurfaces(std::size_t budget) {
+    MICROPROFILE_SCOPE(OpenGL_EvictSurfaces);
+
+    std::vector<Surface> candidates;
+    for (const auto& pair : surfaces_by_addr) {
+        const Surface& surface = pair.second;
+        if (surface->last_used_frame < current_frame && surface->GetMemoryUsage() != 0)
+            candidates.push_back(surface);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Surface& a, const Surface& b) {
+        return a->last_used_frame < b->last_used_frame;
+    });
+
+    const std::size_t memory_before = cache_memory;
+    std::size_t evicted = 0;
+    for (const auto& surface : candidates) {
+        if (cache_memory <= budget)
+            break;
+        // Write back anything only this surface holds before dropping it
+        FlushRegion(surface->addr, surface->size, surface);
+        UnregisterSurface(surface);
+        ++evicted;
+    }
+
+    LOG_DEBUG(Render_OpenGL, "Evicted {} surfaces, cache size {} -> {} bytes", evicted,
+              memory_before, cache_memory);
+}
+
+void RasterizerCacheOpenGL::EndFrame() {
+    if (frame_upload_bytes != 0) {
+        LOG_TRACE(Render_OpenGL, "Uploaded {} bytes of texture data from 3DS memory",
+                  frame_upload_bytes);
+    }
+    frame_upload_bytes = 0;
+
+    // Evict down to a bit below the budget so that this doesn't happen on every frame
+    const std::size_t budget =
+        static_cast<std::size_t>(Settings::values.surface_cache_budget) * 1024 * 1024;
+    if (budget != 0 && cache_memory > budget) {
+        EvictSurfaces(budget - budget / 8);
+    }
+
+    // Free the textures that have not been picked up again for a while, so that the pool doesn't
+    // keep the memory of evicted surfaces
+    for (auto it = host_texture_recycler.begin(); it != host_texture_recycler.end();) {
+        if (current_frame - it->second.frame >= TextureRecycleFrames) {
+            it = host_texture_recycler.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    ++current_frame;
+}
+
 } // namespace OpenGL
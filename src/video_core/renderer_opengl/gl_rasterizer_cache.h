@@ -6,6 +6,7 @@
 
 #include <array>
 #include <list>
+#include <map>
 #include <memory>
 #include <set>
 #include <tuple>
@@ -53,6 +54,26 @@ struct TextureCubeConfig {
     }
 };
 
+struct FormatTuple {
+    GLint internal_format;
+    GLenum format;
+    GLenum type;
+};
+
+/// Describes the storage of a surface texture, textures with the same tag are interchangeable
+struct HostTextureTag {
+    FormatTuple format_tuple;
+    u32 width;
+    u32 height;
+
+    bool operator==(const HostTextureTag& rhs) const {
+        return std::tie(format_tuple.internal_format, format_tuple.format, format_tuple.type, width,
+                        height) == std::tie(rhs.format_tuple.internal_format,
+                                            rhs.format_tuple.format, rhs.format_tuple.type,
+                                            rhs.width, rhs.height);
+    }
+};
+
 } // namespace OpenGL
 
 namespace std {
@@ -71,6 +92,19 @@ struct hash<OpenGL::TextureCubeConfig> {
         return hash;
     }
 };
+
+template <>
+struct hash<OpenGL::HostTextureTag> {
+    std::size_t operator()(const OpenGL::HostTextureTag& tag) const {
+        std::size_t hash = 0;
+        boost::hash_combine(hash, tag.format_tuple.internal_format);
+        boost::hash_combine(hash, tag.format_tuple.format);
+        boost::hash_combine(hash, tag.format_tuple.type);
+        boost::hash_combine(hash, tag.width);
+        boost::hash_combine(hash, tag.height);
+        return hash;
+    }
+};
 } // namespace std
 
 namespace OpenGL {
@@ -335,7 +369,12 @@ private:
     bool valid = false;
 };
 
+class RasterizerCacheOpenGL;
+
 struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface> {
+    explicit CachedSurface(RasterizerCacheOpenGL& owner) : owner{owner} {}
+    ~CachedSurface();
+
     bool CanFill(const SurfaceParams& dest_surface, SurfaceInterval fill_interval) const;
     bool CanCopy(const SurfaceParams& dest_surface, SurfaceInterval copy_interval) const;
 
@@ -347,8 +386,20 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
         return (invalid_regions & GetInterval()) == SurfaceRegions(GetInterval());
     }
 
+    /// Host memory held by the surface's texture and staging buffer, used for the cache budget
+    std::size_t GetMemoryUsage() const {
+        const std::size_t bpp = GetGLBytesPerPixel(pixel_format);
+        return (static_cast<std::size_t>(GetScaledWidth()) * GetScaledHeight() + width * height) *
+               bpp;
+    }
+
     bool registered = false;
+    /// Frame in which the surface was last returned by the cache, used to evict unused surfaces
+    u64 last_used_frame = 0;
     SurfaceRegions invalid_regions;
+    /// Pages written by the CPU that are left invalid until the surface is used again. Writes to
+    /// them are not tracked in the meantime.
+    SurfaceRegions unwatched_pages;
 
     u32 fill_size = 0; /// Number of bytes to read from fill_data
     std::array<u8, 4> fill_data;
@@ -392,6 +443,7 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
     }
 
 private:
+    RasterizerCacheOpenGL& owner;
     std::list<std::weak_ptr<SurfaceWatcher>> watchers;
 };
 
@@ -457,6 +509,18 @@ public:
     /// Flush all cached resources tracked by this cache manager
     void FlushAll();
 
+    /// Get an uninitialized texture of the given format and size, reusing a released one if
+    /// possible
+    OGLTexture AllocateTexture(const FormatTuple& format_tuple, u32 width, u32 height);
+
+    /// Keep a texture that is no longer needed around for AllocateTexture to reuse
+    void RecycleTexture(const FormatTuple& format_tuple, u32 width, u32 height,
+                        OGLTexture&& texture);
+
+    /// Report the amount of texture data uploaded from 3DS memory since the previous frame and
+    /// evict the least recently used surfaces if the cache is over its memory budget
+    void EndFrame();
+
 private:
     void DuplicateSurface(const Surface& src_surface, const Surface& dest_surface);
 
@@ -475,11 +539,49 @@ private:
     /// Increase/decrease the number of surface in pages touching the specified region
     void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
 
+    /// Whether the surface owns regions with rendering that wasn't flushed to memory yet
+    bool HasDirtyRegions(const Surface& surface) const;
+
+    /// Invalidate the pages of a surface touching the interval and stop tracking writes to them
+    void UnwatchPages(const Surface& surface, SurfaceInterval interval);
+
+    /// Track writes again to the unwatched pages of the surface touching the interval
+    void WatchPages(const Surface& surface, SurfaceInterval interval);
+
+    /// Track writes again to the unwatched pages of the surface that are valid again
+    void WatchValidPages(const Surface& surface);
+
+    /// Mark the surface as used during the current frame
+    void TouchSurface(const Surface& surface);
+
+    /// Flush and remove surfaces unused during the current frame, oldest first, until the cache
+    /// fits into budget bytes
+    void EvictSurfaces(std::size_t budget);
+
+    struct RecycledTexture {
+        OGLTexture texture;
+        /// Frame in which the texture was released
+        u64 frame;
+    };
+    /// Number of frames ended so far
+    u64 current_frame = 0;
+    /// Textures of destroyed surfaces. This and current_frame are declared first so that they
+    /// outlive every surface held by the members below, which return their texture here when
+    /// destroyed.
+    std::unordered_multimap<HostTextureTag, RecycledTexture> host_texture_recycler;
+
     SurfaceCache surface_cache;
+    /// Registered surfaces by start address, for lookups that need an exact address match
+    std::multimap<PAddr, Surface> surfaces_by_addr;
     PageMap cached_pages;
     SurfaceMap dirty_regions;
     SurfaceSet remove_surfaces;
 
+    /// Bytes of texture data decoded and uploaded from 3DS memory during the current frame
+    std::size_t frame_upload_bytes = 0;
+    /// Host memory used by the registered surfaces
+    std::size_t cache_memory = 0;
+
     OGLFramebuffer read_framebuffer;
     OGLFramebuffer draw_framebuffer;
 
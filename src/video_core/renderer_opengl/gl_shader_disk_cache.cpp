@@ -0,0 +1,219 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <map>
+#include <utility>
+#include <fmt/format.h>
+#include "common/assert.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+
+namespace OpenGL {
+
+namespace {
+// Bump this whenever the generated code or the layout of an entry changes
+constexpr u32 ShaderDiskCacheVersion = 2;
+
+void WriteBytes(std::vector<u8>& out, const void* data, std::size_t size) {
+    const u8* bytes = static_cast<const u8*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+template <typename T>
+void WriteValue(std::vector<u8>& out, const T& value) {
+    WriteBytes(out, &value, sizeof(T));
+}
+
+class EntryReader {
+public:
+    EntryReader(const u8* data, std::size_t size) : data(data), size(size) {}
+
+    bool ReadBytes(void* out, std::size_t length) {
+        if (length > size - offset)
+            return false;
+        std::memcpy(out, data + offset, length);
+        offset += length;
+        return true;
+    }
+
+    template <typename T>
+    bool ReadValue(T& value) {
+        return ReadBytes(&value, sizeof(T));
+    }
+
+    template <typename Container>
+    bool ReadArray(Container& container) {
+        u32 length;
+        if (!ReadValue(length) || length > size - offset)
+            return false;
+        container.resize(length);
+        return ReadBytes(container.data(), length);
+    }
+
+    bool AtEnd() const {
+        return offset == size;
+    }
+
+private:
+    const u8* data;
+    std::size_t size;
+    std::size_t offset = 0;
+};
+
+ShaderDiskCacheKey MakeKey(const ShaderDiskCacheEntry& entry, bool separable) {
+    ShaderDiskCacheKey key{};
+    key.version = ShaderDiskCacheVersion;
+    key.type = entry.type;
+    key.config_hash = Common::ComputeHash64(entry.config.data(), entry.config.size());
+    key.separable = separable ? 1 : 0;
+    return key;
+}
+
+class ShaderDiskCacheReader : public LinearDiskCacheReader<ShaderDiskCacheKey, u8> {
+public:
+    explicit ShaderDiskCacheReader(bool separable) : separable(separable) {}
+
+    void Read(const ShaderDiskCacheKey& key, const u8* value, u32 value_size) override {
+        ++num_read;
+        if (key.version != ShaderDiskCacheVersion)
+            return;
+
+        // Code generated for the other program mode doesn't link with the shaders of this one. It
+        // is kept as is, for when the mode is switched back.
+        if (key.separable != (separable ? 1 : 0)) {
+            auto [itr, inserted] = other_mode_index.emplace(
+                std::make_pair(key.type, key.config_hash), other_mode_entries.size());
+            if (inserted) {
+                other_mode_entries.emplace_back(key, std::vector<u8>(value, value + value_size));
+            } else {
+                other_mode_entries[itr->second].second.assign(value, value + value_size);
+            }
+            return;
+        }
+
+        ShaderDiskCacheEntry entry;
+        entry.type = key.type;
+        EntryReader reader(value, value_size);
+        if (!reader.ReadArray(entry.config) || !reader.ReadArray(entry.code) ||
+            !reader.ReadValue(entry.driver_hash) || !reader.ReadValue(entry.binary_format) ||
+            !reader.ReadArray(entry.binary) || !reader.AtEnd()) {
+            LOG_WARNING(Render_OpenGL, "Skipping malformed shader disk cache entry");
+            return;
+        }
+
+        // Entries are appended, so a later entry with the same key is the more recent one
+        auto [itr, inserted] =
+            index.emplace(std::make_pair(key.type, key.config_hash), entries.size());
+        if (inserted) {
+            entries.push_back(std::move(entry));
+        } else {
+            entries[itr->second] = std::move(entry);
+        }
+    }
+
+    std::size_t num_read = 0;
+    std::vector<ShaderDiskCacheEntry> entries;
+    std::vector<std::pair<ShaderDiskCacheKey, std::vector<u8>>> other_mode_entries;
+
+private:
+    bool separable;
+    std::map<std::pair<ShaderDiskCacheType, u64>, std::size_t> index;
+    std::map<std::pair<ShaderDiskCacheType, u64>, std::size_t> other_mode_index;
+};
+
+class NullReader : public LinearDiskCacheReader<ShaderDiskCacheKey, u8> {
+public:
+    void Read(const ShaderDiskCacheKey&, const u8*, u32) override {}
+};
+} // Anonymous namespace
+
+ShaderDiskCache::ShaderDiskCache(u64 title_id, bool separable)
+    : path(FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "shaders" DIR_SEP +
+           fmt::format("{:016X}.bin", title_id)),
+      separable(separable) {}
+
+ShaderDiskCache::~ShaderDiskCache() {
+    if (load_future.valid())
+        load_future.wait();
+    file.Close();
+}
+
+void ShaderDiskCache::LoadAsync() {
+    load_future = std::async(std::launch::async, [this] { return Load(); });
+}
+
+std::vector<ShaderDiskCacheEntry> ShaderDiskCache::Load() {
+    const std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+    if (!FileUtil::CreateFullPath(directory)) {
+        LOG_ERROR(Render_OpenGL, "Failed to create shader cache directory {}", directory);
+        return {};
+    }
+
+    ShaderDiskCacheReader reader(separable);
+    file.OpenAndRead(path.c_str(), reader);
+    // Only superseded, outdated and malformed entries are worth rewriting the file for
+    needs_compaction =
+        reader.num_read != reader.entries.size() + reader.other_mode_entries.size();
+    other_mode_entries = std::move(reader.other_mode_entries);
+    LOG_INFO(Render_OpenGL, "Read {} shaders from the disk cache {}", reader.entries.size(),
+             path);
+    return std::move(reader.entries);
+}
+
+std::vector<ShaderDiskCacheEntry> ShaderDiskCache::TakeEntries() {
+    if (!load_future.valid())
+        return {};
+
+    std::vector<ShaderDiskCacheEntry> entries = load_future.get();
+
+    // The strings identifying the driver can only be queried from the thread owning the context
+    std::string driver;
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const GLubyte* value = glGetString(name);
+        if (value != nullptr)
+            driver += reinterpret_cast<const char*>(value);
+        driver += '\n';
+    }
+    driver_hash = Common::ComputeHash64(driver.data(), driver.size());
+
+    if (needs_compaction) {
+        // Rewrite the file without the superseded and outdated entries
+        NullReader reader;
+        file.Close();
+        FileUtil::Delete(path);
+        file.OpenAndRead(path.c_str(), reader);
+        for (const auto& [key, value] : other_mode_entries)
+            file.Append(key, value.data(), static_cast<u32>(value.size()));
+        for (const auto& entry : entries)
+            Save(entry);
+        needs_compaction = false;
+    }
+    other_mode_entries.clear();
+    other_mode_entries.shrink_to_fit();
+    return entries;
+}
+
+void ShaderDiskCache::Save(const ShaderDiskCacheEntry& entry) {
+    ASSERT_MSG(!load_future.valid(), "Shader disk cache saved before it was loaded");
+
+    std::vector<u8> value;
+    value.reserve(entry.config.size() + entry.code.size() + entry.binary.size() + 32);
+    WriteValue(value, static_cast<u32>(entry.config.size()));
+    WriteBytes(value, entry.config.data(), entry.config.size());
+    WriteValue(value, static_cast<u32>(entry.code.size()));
+    WriteBytes(value, entry.code.data(), entry.code.size());
+    WriteValue(value, entry.driver_hash);
+    WriteValue(value, entry.binary_format);
+    WriteValue(value, static_cast<u32>(entry.binary.size()));
+    WriteBytes(value, entry.binary.data(), entry.binary.size());
+
+    file.Append(MakeKey(entry, separable), value.data(), static_cast<u32>(value.size()));
+    file.Sync();
+}
+
+} // namespace OpenGL
@@ -0,0 +1,93 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <future>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/linear_disk_cache.h"
+
+namespace OpenGL {
+
+enum class ShaderDiskCacheType : u32 {
+    ProgrammableVertex,
+    ProgrammableGeometry,
+    FixedGeometry,
+    Fragment,
+};
+
+/// Key of an entry in the disk cache. Newer entries replace older ones with the same key.
+struct ShaderDiskCacheKey {
+    u32 version;
+    ShaderDiskCacheType type;
+    u64 config_hash;
+    /// Whether the code was generated for separable programs, which changes the stage interfaces
+    u32 separable;
+    INSERT_PADDING_WORDS(1);
+};
+static_assert(std::is_trivially_copyable_v<ShaderDiskCacheKey> &&
+                  sizeof(ShaderDiskCacheKey) == 24,
+              "ShaderDiskCacheKey must be a POD without padding");
+
+/// A shader stage stored in the disk cache, holding everything needed to rebuild it at boot.
+struct ShaderDiskCacheEntry {
+    ShaderDiskCacheType type;
+    /// Raw bytes of the config state the shader was generated from
+    std::vector<u8> config;
+    /// Generated GLSL code, used when there is no usable program binary
+    std::string code;
+    /// Hash of the driver that produced the binary, binaries of other drivers are ignored
+    u64 driver_hash = 0;
+    GLenum binary_format = 0;
+    std::vector<u8> binary;
+};
+
+/**
+ * Persistent cache of the shaders generated for a title, stored in the cache directory. The file
+ * is read on a loader thread, while the GL objects are created by the caller on the render thread.
+ */
+class ShaderDiskCache {
+public:
+    /**
+     * @param title_id Title whose shaders are cached
+     * @param separable Whether separable programs are used, entries of the other mode are ignored
+     */
+    ShaderDiskCache(u64 title_id, bool separable);
+    ~ShaderDiskCache();
+
+    /// Starts reading the cache file on a loader thread.
+    void LoadAsync();
+
+    /// Waits for the loader thread and returns the entries that were read.
+    std::vector<ShaderDiskCacheEntry> TakeEntries();
+
+    /// Appends a new entry to the cache file.
+    void Save(const ShaderDiskCacheEntry& entry);
+
+    /// Returns the hash identifying the current driver, only valid once the entries were taken.
+    u64 GetDriverHash() const {
+        return driver_hash;
+    }
+
+private:
+    std::vector<ShaderDiskCacheEntry> Load();
+
+    std::string path;
+    bool separable;
+    u64 driver_hash = 0;
+    LinearDiskCache<ShaderDiskCacheKey, u8> file;
+    std::future<std::vector<ShaderDiskCacheEntry>> load_future;
+    /// Whether superseded entries were found, in which case the file is rewritten once loaded
+    bool needs_compaction = false;
+    /// Raw entries of the other separable mode, kept when the file is rewritten
+    std::vector<std::pair<ShaderDiskCacheKey, std::vector<u8>>> other_mode_entries;
+};
+
+} // namespace OpenGL
@@ -245,6 +245,22 @@ PicaFSConfig PicaFSConfig::BuildFromRegs(const Pica::Regs& regs) {
     return res;
 }
 
+bool PicaFSConfig::IsSupportedByUberShader() const {
+    // Procedural textures, shadow textures and shadow rendering are only handled by the generated
+    // shaders, as interpreting them would make the uber shader too heavy
+    switch (state.texture0_type) {
+    case TexturingRegs::TextureConfig::Texture2D:
+    case TexturingRegs::TextureConfig::Projection2D:
+    case TexturingRegs::TextureConfig::TextureCube:
+    case TexturingRegs::TextureConfig::Disabled:
+        break;
+    default:
+        return false;
+    }
+    return !state.proctex.enable && !state.shadow_rendering &&
+           state.fog_mode != TexturingRegs::FogMode::Gas;
+}
+
 void PicaShaderConfigCommon::Init(const Pica::ShaderRegs& regs, Pica::Shader::ShaderSetup& setup) {
     program_hash = setup.GetProgramCodeHash();
     swizzle_hash = setup.GetSwizzleDataHash();
@@ -1246,9 +1262,8 @@ float ProcTexNoiseCoef(vec2 x) {
     }
 }
 
-std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader) {
-    const auto& state = config.state;
-
+/// Writes the declarations and helper functions shared by all the fragment shaders
+static std::string GetFragmentShaderCommon(bool separable_shader) {
     std::string out = R"(
 #version 330 core
 #extension GL_ARB_shader_image_load_store : enable
@@ -1326,7 +1341,17 @@ vec3 byteround(vec3 x) {
 vec4 byteround(vec4 x) {
     return round(x * 255.0) * (1.0 / 255.0);
 }
+)";
+
+    return out;
+}
+
+std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader) {
+    const auto& state = config.state;
 
+    std::string out = GetFragmentShaderCommon(separable_shader);
+
+    out += R"(
 #if ALLOW_SHADOW
 
 uvec2 DecodeShadow(uint pixel) {
@@ -1590,6 +1615,408 @@ do {
     return out;
 }
 
+std::string GenerateFragmentUberShader(bool separable_shader) {
+    std::string out = GetFragmentShaderCommon(separable_shader);
+
+    out += R"(
+#define LIGHT_DIRECTIONAL 1
+#define LIGHT_TWO_SIDED_DIFFUSE 2
+#define LIGHT_DIST_ATTEN 4
+#define LIGHT_SPOT_ATTEN 8
+#define LIGHT_GEOMETRIC_FACTOR_0 16
+#define LIGHT_GEOMETRIC_FACTOR_1 32
+#define LIGHT_SHADOW 64
+
+#define LUT_D0 0
+#define LUT_D1 1
+#define LUT_SP 2
+#define LUT_FR 3
+#define LUT_RR 4
+#define LUT_RG 5
+#define LUT_RB 6
+
+layout (std140) uniform fs_config {
+    int alpha_test_func;
+    int scissor_test_mode;
+    int texture0_type;
+    int texture2_use_coord1;
+    int combiner_buffer_input;
+    int w_buffering;
+    int fog_enable;
+    int fog_flip;
+    int lighting_enable;
+    int lighting_src_num;
+    int lighting_bump_mode;
+    int lighting_bump_selector;
+    int lighting_bump_renorm;
+    int lighting_clamp_highlights;
+    int lighting_config;
+    int lighting_primary_alpha;
+    int lighting_secondary_alpha;
+    int lighting_shadow_enable;
+    int lighting_shadow_primary;
+    int lighting_shadow_secondary;
+    int lighting_shadow_invert;
+    int lighting_shadow_alpha;
+    int lighting_shadow_selector;
+    uvec4 tev_stages[NUM_TEV_STAGES]; // sources, modifiers, ops, scales
+    ivec4 light_config[NUM_LIGHTS];   // light number, LIGHT_* flags
+    ivec4 lut_config[7];              // enabled, absolute input, input
+    vec4 lut_scale[2];
+};
+
+vec4 rounded_primary_color;
+vec4 primary_fragment_color = vec4(0.0);
+vec4 secondary_fragment_color = vec4(0.0);
+vec4 combiner_buffer = vec4(0.0);
+vec4 next_combiner_buffer;
+vec4 last_tex_env_out = vec4(0.0);
+vec4 texture_color[4];
+
+vec3 normal;
+vec3 tangent;
+vec3 light_vector;
+vec3 spot_dir;
+vec3 half_vector;
+
+void SampleTextures() {
+    if (texture0_type == 0) {
+        texture_color[0] = texture(tex0, texcoord0);
+    } else if (texture0_type == 3) {
+        texture_color[0] = textureProj(tex0, vec3(texcoord0, texcoord0_w));
+    } else if (texture0_type == 1) {
+        texture_color[0] = texture(tex_cube, vec3(texcoord0, texcoord0_w));
+    } else {
+        texture_color[0] = vec4(0.0);
+    }
+    texture_color[1] = texture(tex1, texcoord1);
+    texture_color[2] = texture(tex2, texture2_use_coord1 != 0 ? texcoord1 : texcoord2);
+    texture_color[3] = vec4(0.0);
+}
+
+float LookupLightingLUTInput(int lut, int sampler_index, bool two_sided) {
+    float index;
+    switch (lut_config[lut].z) {
+    case 0: // NH
+        index = dot(normal, normalize(half_vector));
+        break;
+    case 1: // VH
+        index = dot(normalize(view), normalize(half_vector));
+        break;
+    case 2: // NV
+        index = dot(normal, normalize(view));
+        break;
+    case 3: // LN
+        index = dot(light_vector, normal);
+        break;
+    case 4: // SP
+        index = dot(light_vector, spot_dir);
+        break;
+    case 5: // CP, only available with configuration 7
+        if (lighting_config == 8) {
+            vec3 half_angle_proj = normalize(half_vector) - normal * dot(normal, normalize(half_vector));
+            index = dot(half_angle_proj, tangent);
+        } else {
+            index = 0.0;
+        }
+        break;
+    default:
+        index = 0.0;
+        break;
+    }
+
+    float value;
+    if (lut_config[lut].y != 0) {
+        value = LookupLightingLUTUnsigned(sampler_index, two_sided ? abs(index) : max(index, 0.0));
+    } else {
+        value = LookupLightingLUTSigned(sampler_index, index);
+    }
+    return lut_scale[lut >> 2][lut & 3] * value;
+}
+
+void ComputeLighting() {
+    vec4 diffuse_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec4 specular_sum = vec4(0.0, 0.0, 0.0, 1.0);
+
+    vec3 surface_normal = vec3(0.0, 0.0, 1.0);
+    vec3 surface_tangent = vec3(1.0, 0.0, 0.0);
+    if (lighting_bump_mode == 1) {
+        surface_normal = 2.0 * texture_color[lighting_bump_selector].rgb - 1.0;
+        if (lighting_bump_renorm != 0) {
+            float len = 1.0 - (surface_normal.x * surface_normal.x + surface_normal.y * surface_normal.y);
+            surface_normal.z = sqrt(max(len, 0.0));
+        }
+    } else if (lighting_bump_mode == 2) {
+        surface_tangent = 2.0 * texture_color[lighting_bump_selector].rgb - 1.0;
+    }
+
+    vec4 normalized_normquat = normalize(normquat);
+    normal = quaternion_rotate(normalized_normquat, surface_normal);
+    tangent = quaternion_rotate(normalized_normquat, surface_tangent);
+
+    vec4 shadow = vec4(1.0);
+    if (lighting_shadow_enable != 0) {
+        shadow = texture_color[lighting_shadow_selector];
+        if (lighting_shadow_invert != 0)
+            shadow = vec4(1.0) - shadow;
+    }
+
+    for (int i = 0; i < lighting_src_num; ++i) {
+        int num = light_config[i].x;
+        int flags = light_config[i].y;
+        // The LUTs take the two-sided flag of the slot matching the light number
+        bool lut_two_sided = (light_config[num].y & LIGHT_TWO_SIDED_DIFFUSE) != 0;
+
+        if ((flags & LIGHT_DIRECTIONAL) != 0)
+            light_vector = normalize(light_src[num].position);
+        else
+            light_vector = normalize(light_src[num].position + view);
+        spot_dir = light_src[num].spot_direction;
+        half_vector = normalize(view) + light_vector;
+
+        float dot_product = (flags & LIGHT_TWO_SIDED_DIFFUSE) != 0
+                                ? abs(dot(light_vector, normal))
+                                : max(dot(light_vector, normal), 0.0);
+        float clamp_highlights = lighting_clamp_highlights != 0 ? sign(dot_product) : 1.0;
+
+        float spot_atten = 1.0;
+        if ((flags & LIGHT_SPOT_ATTEN) != 0 && lut_config[LUT_SP].x != 0)
+            spot_atten = LookupLightingLUTInput(LUT_SP, 8 + num, lut_two_sided);
+
+        float dist_atten = 1.0;
+        if ((flags & LIGHT_DIST_ATTEN) != 0) {
+            float index = clamp(light_src[num].dist_atten_scale * length(-view - light_src[num].position) +
+                                light_src[num].dist_atten_bias, 0.0, 1.0);
+            dist_atten = LookupLightingLUTUnsigned(16 + num, index);
+        }
+
+        float geo_factor = 1.0;
+        if ((flags & (LIGHT_GEOMETRIC_FACTOR_0 | LIGHT_GEOMETRIC_FACTOR_1)) != 0) {
+            geo_factor = dot(half_vector, half_vector);
+            geo_factor = geo_factor == 0.0 ? 0.0 : min(dot_product / geo_factor, 1.0);
+        }
+
+        float d0_lut_value = lut_config[LUT_D0].x != 0 ? LookupLightingLUTInput(LUT_D0, 0, lut_two_sided) : 1.0;
+        vec3 specular_0 = d0_lut_value * light_src[num].specular_0;
+        if ((flags & LIGHT_GEOMETRIC_FACTOR_0) != 0)
+            specular_0 *= geo_factor;
+
+        vec3 refl_value;
+        refl_value.r = lut_config[LUT_RR].x != 0 ? LookupLightingLUTInput(LUT_RR, 6, lut_two_sided) : 1.0;
+        refl_value.g = lut_config[LUT_RG].x != 0 ? LookupLightingLUTInput(LUT_RG, 5, lut_two_sided) : refl_value.r;
+        refl_value.b = lut_config[LUT_RB].x != 0 ? LookupLightingLUTInput(LUT_RB, 4, lut_two_sided) : refl_value.r;
+
+        float d1_lut_value = lut_config[LUT_D1].x != 0 ? LookupLightingLUTInput(LUT_D1, 1, lut_two_sided) : 1.0;
+        vec3 specular_1 = d1_lut_value * refl_value * light_src[num].specular_1;
+        if ((flags & LIGHT_GEOMETRIC_FACTOR_1) != 0)
+            specular_1 *= geo_factor;
+
+        // Only the last entry in the light slots applies the Fresnel factor
+        if (i == lighting_src_num - 1 && lut_config[LUT_FR].x != 0) {
+            float value = LookupLightingLUTInput(LUT_FR, 3, lut_two_sided);
+            if (lighting_primary_alpha != 0)
+                diffuse_sum.a = value;
+            if (lighting_secondary_alpha != 0)
+                specular_sum.a = value;
+        }
+
+        bool light_shadow = (flags & LIGHT_SHADOW) != 0;
+        vec3 shadow_primary = light_shadow && lighting_shadow_primary != 0 ? shadow.rgb : vec3(1.0);
+        vec3 shadow_secondary = light_shadow && lighting_shadow_secondary != 0 ? shadow.rgb : vec3(1.0);
+
+        diffuse_sum.rgb += ((light_src[num].diffuse * dot_product) + light_src[num].ambient) *
+                           dist_atten * spot_atten * shadow_primary;
+        specular_sum.rgb += (specular_0 + specular_1) * clamp_highlights * dist_atten *
+                            spot_atten * shadow_secondary;
+    }
+
+    if (lighting_shadow_alpha != 0) {
+        if (lighting_primary_alpha != 0)
+            diffuse_sum.a *= shadow.a;
+        if (lighting_secondary_alpha != 0)
+            specular_sum.a *= shadow.a;
+    }
+
+    diffuse_sum.rgb += lighting_global_ambient;
+    primary_fragment_color = clamp(diffuse_sum, vec4(0.0), vec4(1.0));
+    secondary_fragment_color = clamp(specular_sum, vec4(0.0), vec4(1.0));
+}
+
+vec4 TevSource(uint source, int stage) {
+    switch (source) {
+    case 0u: return rounded_primary_color;
+    case 1u: return primary_fragment_color;
+    case 2u: return secondary_fragment_color;
+    case 3u: return texture_color[0];
+    case 4u: return texture_color[1];
+    case 5u: return texture_color[2];
+    case 6u: return texture_color[3];
+    case 13u: return combiner_buffer;
+    case 14u: return const_color[stage];
+    case 15u: return last_tex_env_out;
+    default: return vec4(0.0);
+    }
+}
+
+vec3 TevColorModifier(uint modifier, vec4 value) {
+    vec3 result;
+    switch (modifier >> 1) {
+    case 0u: result = value.rgb; break;
+    case 1u: result = value.aaa; break;
+    case 2u: result = value.rrr; break;
+    case 4u: result = value.ggg; break;
+    case 6u: result = value.bbb; break;
+    default: return vec3(0.0);
+    }
+    return (modifier & 1u) != 0u ? vec3(1.0) - result : result;
+}
+
+float TevAlphaModifier(uint modifier, vec4 value) {
+    float result;
+    switch (modifier >> 1) {
+    case 0u: result = value.a; break;
+    case 1u: result = value.r; break;
+    case 2u: result = value.g; break;
+    default: result = value.b; break;
+    }
+    return (modifier & 1u) != 0u ? 1.0 - result : result;
+}
+
+vec3 TevColorCombiner(uint op, vec3 a, vec3 b, vec3 c) {
+    vec3 result;
+    switch (op) {
+    case 0u: result = a; break;
+    case 1u: result = a * b; break;
+    case 2u: result = a + b; break;
+    case 3u: result = a + b - vec3(0.5); break;
+    case 4u: result = a * c + b * (vec3(1.0) - c); break;
+    case 5u: result = a - b; break;
+    case 6u:
+    case 7u: result = vec3(dot(a - vec3(0.5), b - vec3(0.5)) * 4.0); break;
+    case 8u: result = a * b + c; break;
+    case 9u: result = min(a + b, vec3(1.0)) * c; break;
+    default: result = vec3(0.0); break;
+    }
+    return clamp(result, vec3(0.0), vec3(1.0));
+}
+
+float TevAlphaCombiner(uint op, float a, float b, float c) {
+    float result;
+    switch (op) {
+    case 0u: result = a; break;
+    case 1u: result = a * b; break;
+    case 2u: result = a + b; break;
+    case 3u: result = a + b - 0.5; break;
+    case 4u: result = a * c + b * (1.0 - c); break;
+    case 5u: result = a - b; break;
+    case 8u: result = a * b + c; break;
+    case 9u: result = min(a + b, 1.0) * c; break;
+    default: result = 0.0; break;
+    }
+    return clamp(result, 0.0, 1.0);
+}
+
+void RunTevStage(int index) {
+    uint sources = tev_stages[index].x;
+    uint modifiers = tev_stages[index].y;
+    uint ops = tev_stages[index].z;
+    uint scales = tev_stages[index].w;
+
+    // Round the output of each TEV stage to maintain the PICA's 8 bits of precision
+    vec3 color_output = byteround(TevColorCombiner(ops & 0xFu,
+        TevColorModifier(modifiers & 0xFu, TevSource(sources & 0xFu, index)),
+        TevColorModifier((modifiers >> 4) & 0xFu, TevSource((sources >> 4) & 0xFu, index)),
+        TevColorModifier((modifiers >> 8) & 0xFu, TevSource((sources >> 8) & 0xFu, index))));
+
+    float alpha_output;
+    if ((ops & 0xFu) == 7u) {
+        // Result of Dot3_RGBA operation is also placed to the alpha component
+        alpha_output = color_output[0];
+    } else {
+        alpha_output = byteround(TevAlphaCombiner((ops >> 16) & 0xFu,
+            TevAlphaModifier((modifiers >> 12) & 0x7u, TevSource((sources >> 16) & 0xFu, index)),
+            TevAlphaModifier((modifiers >> 16) & 0x7u, TevSource((sources >> 20) & 0xFu, index)),
+            TevAlphaModifier((modifiers >> 20) & 0x7u, TevSource((sources >> 24) & 0xFu, index))));
+    }
+
+    uint color_scale = scales & 3u;
+    uint alpha_scale = (scales >> 16) & 3u;
+    float color_multiplier = color_scale < 3u ? float(1u << color_scale) : 1.0;
+    float alpha_multiplier = alpha_scale < 3u ? float(1u << alpha_scale) : 1.0;
+    last_tex_env_out = vec4(clamp(color_output * color_multiplier, vec3(0.0), vec3(1.0)),
+                            clamp(alpha_output * alpha_multiplier, 0.0, 1.0));
+
+    combiner_buffer = next_combiner_buffer;
+    if (index < 4 && (combiner_buffer_input & (1 << index)) != 0)
+        next_combiner_buffer.rgb = last_tex_env_out.rgb;
+    if (index < 4 && (combiner_buffer_input & (16 << index)) != 0)
+        next_combiner_buffer.a = last_tex_env_out.a;
+}
+
+bool AlphaTestFails(float alpha) {
+    int value = int(alpha * 255.0);
+    switch (alpha_test_func) {
+    case 0: return true;
+    case 2: return value != alphatest_ref;
+    case 3: return value == alphatest_ref;
+    case 4: return value >= alphatest_ref;
+    case 5: return value > alphatest_ref;
+    case 6: return value <= alphatest_ref;
+    case 7: return value < alphatest_ref;
+    default: return false;
+    }
+}
+
+void main() {
+    // We round the interpolated primary color to the nearest 1/255th
+    // This maintains the PICA's 8 bits of precision
+    rounded_primary_color = byteround(primary_color);
+
+    if (alpha_test_func == 0)
+        discard;
+
+    if (scissor_test_mode != 0) {
+        bool inside = gl_FragCoord.x >= scissor_x1 && gl_FragCoord.y >= scissor_y1 &&
+                      gl_FragCoord.x < scissor_x2 && gl_FragCoord.y < scissor_y2;
+        // Mode 3 keeps only the pixels inside the scissor box, the others only those outside
+        if (scissor_test_mode == 3 ? !inside : inside)
+            discard;
+    }
+
+    float z_over_w = 2.0 * gl_FragCoord.z - 1.0;
+    float depth = z_over_w * depth_scale + depth_offset;
+    if (w_buffering != 0)
+        depth /= gl_FragCoord.w;
+
+    SampleTextures();
+    if (lighting_enable != 0)
+        ComputeLighting();
+
+    next_combiner_buffer = tev_combiner_buffer_color;
+    for (int i = 0; i < NUM_TEV_STAGES; ++i)
+        RunTevStage(i);
+
+    if (AlphaTestFails(last_tex_env_out.a))
+        discard;
+
+    if (fog_enable != 0) {
+        float fog_index = (fog_flip != 0 ? 1.0 - depth : depth) * 128.0;
+        float fog_i = clamp(floor(fog_index), 0.0, 127.0);
+        float fog_f = fog_index - fog_i;
+        vec2 fog_lut_entry = texelFetch(texture_buffer_lut_rg, int(fog_i) + fog_lut_offset).rg;
+        float fog_factor = clamp(fog_lut_entry.r + fog_lut_entry.g * fog_f, 0.0, 1.0);
+        last_tex_env_out.rgb = mix(fog_color.rgb, last_tex_env_out.rgb, fog_factor);
+    }
+
+    gl_FragDepth = depth;
+    // Round the final fragment color to maintain the PICA's 8 bits of precision
+    color = byteround(last_tex_env_out);
+}
+)";
+
+    return out;
+}
+
 std::string GenerateTrivialVertexShader(bool separable_shader) {
     std::string out = "#version 330 core\n";
     if (separable_shader) {
@@ -134,6 +134,9 @@ struct PicaFSConfig : Common::HashableStruct<PicaFSConfigState> {
     /// Construct a PicaFSConfig with the given Pica register configuration.
     static PicaFSConfig BuildFromRegs(const Pica::Regs& regs);
 
+    /// Whether the uber shader can emulate this configuration while its own shader is compiled.
+    bool IsSupportedByUberShader() const;
+
     bool TevStageUpdatesCombinerBufferColor(unsigned stage_index) const {
         return (stage_index < 4) && (state.combiner_buffer_input & (1 << stage_index));
     }
@@ -166,6 +169,7 @@ struct PicaShaderConfigCommon {
  * shader.
  */
 struct PicaVSConfig : Common::HashableStruct<PicaShaderConfigCommon> {
+    PicaVSConfig() = default;
     explicit PicaVSConfig(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) {
         state.Init(regs.vs, setup);
     }
@@ -191,6 +195,7 @@ struct PicaGSConfigCommonRaw {
  * shader pipeline
  */
 struct PicaFixedGSConfig : Common::HashableStruct<PicaGSConfigCommonRaw> {
+    PicaFixedGSConfig() = default;
     explicit PicaFixedGSConfig(const Pica::Regs& regs) {
         state.Init(regs);
     }
@@ -211,6 +216,7 @@ struct PicaGSConfigRaw : PicaShaderConfigCommon, PicaGSConfigCommonRaw {
  * shader.
  */
 struct PicaGSConfig : Common::HashableStruct<PicaGSConfigRaw> {
+    PicaGSConfig() = default;
     explicit PicaGSConfig(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setups) {
         state.Init(regs, setups);
     }
@@ -255,6 +261,15 @@ std::optional<std::string> GenerateGeometryShader(const Pica::Shader::ShaderSetu
  */
 std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader);
 
+/**
+ * Generates the GLSL uber fragment shader, which interprets the configuration read from the
+ * fs_config uniform block instead of being generated for it. It supports every configuration for
+ * which PicaFSConfig::IsSupportedByUberShader returns true.
+ * @param separable_shader generates shader that can be used for separate shader object
+ * @returns String of the shader source code
+ */
+std::string GenerateFragmentUberShader(bool separable_shader);
+
 } // namespace OpenGL
 
 namespace std {
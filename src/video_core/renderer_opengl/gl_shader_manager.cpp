@@ -3,9 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <unordered_map>
+#include <unordered_set>
 #include <boost/functional/hash.hpp>
 #include <boost/variant.hpp>
+#include "common/logging/log.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/renderer_opengl/gl_async_shader_compiler.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 
 namespace OpenGL {
@@ -28,6 +35,8 @@ static void SetShaderUniformBlockBindings(GLuint shader) {
                                  sizeof(UniformData));
     SetShaderUniformBlockBinding(shader, "vs_config", UniformBindings::VS, sizeof(VSUniformData));
     SetShaderUniformBlockBinding(shader, "gs_config", UniformBindings::GS, sizeof(GSUniformData));
+    SetShaderUniformBlockBinding(shader, "fs_config", UniformBindings::FSConfig,
+                                 sizeof(FSConfigUniformData));
 }
 
 static void SetShaderSamplerBinding(GLuint shader, const char* name,
@@ -87,6 +96,90 @@ void PicaUniformsData::SetFromRegs(const Pica::ShaderRegs& regs,
                    });
 }
 
+void FSConfigUniformData::SetFromConfig(const PicaFSConfig& config) {
+    const auto& state = config.state;
+    const auto& lighting = state.lighting;
+
+    alpha_test_func = static_cast<GLint>(state.alpha_test_func);
+    scissor_test_mode = static_cast<GLint>(state.scissor_test_mode);
+    texture0_type = static_cast<GLint>(state.texture0_type);
+    texture2_use_coord1 = state.texture2_use_coord1;
+    combiner_buffer_input = state.combiner_buffer_input;
+    w_buffering = state.depthmap_enable == Pica::RasterizerRegs::DepthBuffering::WBuffering;
+    fog_enable = state.fog_mode == Pica::TexturingRegs::FogMode::Fog;
+    fog_flip = state.fog_flip;
+
+    for (std::size_t i = 0; i < tev_stages.size(); ++i) {
+        const auto& stage = state.tev_stages[i];
+        tev_stages[i] = {stage.sources_raw, stage.modifiers_raw, stage.ops_raw, stage.scales_raw};
+    }
+
+    lighting_enable = lighting.enable;
+    if (!lighting.enable)
+        return;
+
+    lighting_src_num = lighting.src_num;
+    lighting_bump_mode = static_cast<GLint>(lighting.bump_mode);
+    lighting_bump_selector = lighting.bump_selector;
+    lighting_bump_renorm = lighting.bump_renorm;
+    lighting_clamp_highlights = lighting.clamp_highlights;
+    lighting_config = static_cast<GLint>(lighting.config);
+    lighting_primary_alpha = lighting.enable_primary_alpha;
+    lighting_secondary_alpha = lighting.enable_secondary_alpha;
+    lighting_shadow_enable = lighting.enable_shadow;
+    lighting_shadow_primary = lighting.shadow_primary;
+    lighting_shadow_secondary = lighting.shadow_secondary;
+    lighting_shadow_invert = lighting.shadow_invert;
+    lighting_shadow_alpha = lighting.shadow_alpha;
+    lighting_shadow_selector = lighting.shadow_selector;
+
+    // Flags matching the LIGHT_* definitions of the uber shader
+    for (std::size_t i = 0; i < light_config.size(); ++i) {
+        const auto& light = lighting.light[i];
+        const GLint flags = (light.directional ? 1 : 0) | (light.two_sided_diffuse ? 2 : 0) |
+                            (light.dist_atten_enable ? 4 : 0) | (light.spot_atten_enable ? 8 : 0) |
+                            (light.geometric_factor_0 ? 16 : 0) |
+                            (light.geometric_factor_1 ? 32 : 0) | (light.shadow_enable ? 64 : 0);
+        light_config[i] = {static_cast<GLint>(light.num), flags, 0, 0};
+    }
+
+    // The LUTs in the order of the LUT_* definitions of the uber shader. The spotlight LUT has no
+    // enable bit, it only depends on the lighting configuration.
+    using Sampler = Pica::LightingRegs::LightingSampler;
+    const auto set_lut = [&](std::size_t index, const auto& lut, Sampler sampler, bool enable) {
+        const bool supported =
+            Pica::LightingRegs::IsLightingSamplerSupported(lighting.config, sampler);
+        lut_config[index] = {enable && supported, lut.abs_input, static_cast<GLint>(lut.type), 0};
+        lut_scale[index / 4][index % 4] = lut.scale;
+    };
+    set_lut(0, lighting.lut_d0, Sampler::Distribution0, lighting.lut_d0.enable);
+    set_lut(1, lighting.lut_d1, Sampler::Distribution1, lighting.lut_d1.enable);
+    set_lut(2, lighting.lut_sp, Sampler::SpotlightAttenuation, true);
+    set_lut(3, lighting.lut_fr, Sampler::Fresnel, lighting.lut_fr.enable);
+    set_lut(4, lighting.lut_rr, Sampler::ReflectRed, lighting.lut_rr.enable);
+    set_lut(5, lighting.lut_rg, Sampler::ReflectGreen, lighting.lut_rg.enable);
+    set_lut(6, lighting.lut_rb, Sampler::ReflectBlue, lighting.lut_rb.enable);
+}
+
+void UberShaderBlock::Use(const PicaFSConfig* new_config) {
+    const bool was_in_use = in_use;
+    in_use = new_config != nullptr;
+    if (!in_use)
+        return;
+
+    // The stream buffer may have wrapped around while the generated shaders were used, so the
+    // last upload can't be trusted once the uber shader comes back, even for the same config
+    if (!was_in_use || config != *new_config) {
+        config = *new_config;
+        data.SetFromConfig(config);
+        dirty = true;
+    }
+}
+
+bool UberShaderBlock::NeedsUpload(bool invalidate) const {
+    return dirty || (invalidate && in_use);
+}
+
 /**
  * An object representing a shader program staging. It can be either a shader object or a program
  * object, depending on whether separable program is used.
@@ -114,6 +207,60 @@ public:
         }
     }
 
+    /**
+     * Creates the program from a binary retrieved with GetBinary. Only separable programs can be
+     * created this way.
+     * @returns false if the driver rejected the binary, in which case nothing was created
+     */
+    bool CreateFromBinary(GLenum format, const std::vector<u8>& binary) {
+        if (shader_or_program.which() == 0 || binary.empty() || !GLAD_GL_ARB_get_program_binary)
+            return false;
+
+        OGLProgram& program = boost::get<OGLProgram>(shader_or_program);
+        program.handle = glCreateProgram();
+        glProgramParameteri(program.handle, GL_PROGRAM_SEPARABLE, GL_TRUE);
+        glProgramBinary(program.handle, format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+        GLint link_status = GL_FALSE;
+        glGetProgramiv(program.handle, GL_LINK_STATUS, &link_status);
+        if (link_status != GL_TRUE) {
+            program.Release();
+            return false;
+        }
+
+        // Loading a binary resets the uniforms, including the block and sampler bindings
+        SetShaderUniformBlockBindings(program.handle);
+        SetShaderSamplerBindings(program.handle);
+        return true;
+    }
+
+    /// Takes over a shader or a separable program compiled by the AsyncShaderCompiler.
+    void Adopt(OGLShader&& shader, OGLProgram&& program) {
+        if (shader_or_program.which() == 0) {
+            shader_or_program = std::move(shader);
+        } else {
+            shader_or_program = std::move(program);
+            // The bindings are set here as they go through the state of the render thread
+            const GLuint handle = boost::get<OGLProgram>(shader_or_program).handle;
+            SetShaderUniformBlockBindings(handle);
+            SetShaderSamplerBindings(handle);
+        }
+    }
+
+    /// Retrieves the binary of a separable program, returns an empty vector for shader objects.
+    std::vector<u8> GetBinary(GLenum& format) const {
+        if (shader_or_program.which() == 0 || !GLAD_GL_ARB_get_program_binary)
+            return {};
+
+        const GLuint handle = boost::get<OGLProgram>(shader_or_program).handle;
+        GLint length = 0;
+        glGetProgramiv(handle, GL_PROGRAM_BINARY_LENGTH, &length);
+        std::vector<u8> binary(length);
+        if (length > 0)
+            glGetProgramBinary(handle, length, nullptr, &format, binary.data());
+        return binary;
+    }
+
     GLuint GetHandle() const {
         if (shader_or_program.which() == 0) {
             return boost::get<OGLShader>(shader_or_program).handle;
@@ -126,6 +273,45 @@ private:
     boost::variant<OGLShader, OGLProgram> shader_or_program;
 };
 
+enum class DiskCacheResult { Binary, Compiled, Skipped };
+
+/// Appends a shader stage to the disk cache, along with its program binary if requested
+template <typename KeyConfigType>
+static void SaveToDiskCache(ShaderDiskCache& disk_cache, ShaderDiskCacheType type,
+                            const KeyConfigType& config, const std::string& code,
+                            const OGLShaderStage& stage, bool with_binary) {
+    ShaderDiskCacheEntry entry;
+    entry.type = type;
+    entry.config.resize(sizeof(config.state));
+    std::memcpy(entry.config.data(), &config.state, sizeof(config.state));
+    entry.code = code;
+    if (with_binary) {
+        entry.binary = stage.GetBinary(entry.binary_format);
+        entry.driver_hash = disk_cache.GetDriverHash();
+    }
+    disk_cache.Save(entry);
+}
+
+/// Restores the config a disk cache entry was created from, fails if the layout has changed
+template <typename KeyConfigType>
+static bool LoadDiskCacheConfig(const ShaderDiskCacheEntry& entry, KeyConfigType& config) {
+    if (entry.config.size() != sizeof(config.state))
+        return false;
+    std::memcpy(&config.state, entry.config.data(), sizeof(config.state));
+    return true;
+}
+
+/// Builds a shader stage from a disk cache entry, preferring its program binary over the GLSL code
+static DiskCacheResult BuildFromDiskCache(OGLShaderStage& stage, const ShaderDiskCacheEntry& entry,
+                                          u64 driver_hash, GLenum shader_type) {
+    if (entry.driver_hash == driver_hash &&
+        stage.CreateFromBinary(entry.binary_format, entry.binary)) {
+        return DiskCacheResult::Binary;
+    }
+    stage.Create(entry.code.c_str(), shader_type);
+    return DiskCacheResult::Compiled;
+}
+
 class TrivialVertexShader {
 public:
     explicit TrivialVertexShader(bool separable) : program(separable) {
@@ -140,7 +326,7 @@ private:
 };
 
 template <typename KeyConfigType, std::string (*CodeGenerator)(const KeyConfigType&, bool),
-          GLenum ShaderType>
+          GLenum ShaderType, ShaderDiskCacheType DiskCacheType>
 class ShaderCache {
 public:
     explicit ShaderCache(bool separable) : separable(separable) {}
@@ -148,13 +334,50 @@ public:
         auto [iter, new_shader] = shaders.emplace(config, OGLShaderStage{separable});
         OGLShaderStage& cached_shader = iter->second;
         if (new_shader) {
-            cached_shader.Create(CodeGenerator(config, separable).c_str(), ShaderType);
+            const std::string code = CodeGenerator(config, separable);
+            cached_shader.Create(code.c_str(), ShaderType);
+            if (disk_cache)
+                SaveToDiskCache(*disk_cache, DiskCacheType, config, code, cached_shader, true);
         }
         return cached_shader.GetHandle();
     }
 
+    /// Returns the shader of the config if it was already built, 0 otherwise
+    GLuint Find(const KeyConfigType& config) const {
+        auto iter = shaders.find(config);
+        return iter != shaders.end() ? iter->second.GetHandle() : 0;
+    }
+
+    /// Adds a shader built outside of the cache, e.g. by the AsyncShaderCompiler
+    void Insert(const KeyConfigType& config, const std::string& code, OGLShaderStage&& stage) {
+        auto [iter, new_shader] = shaders.emplace(config, std::move(stage));
+        if (new_shader && disk_cache)
+            SaveToDiskCache(*disk_cache, DiskCacheType, config, code, iter->second, true);
+    }
+
+    DiskCacheResult Install(const ShaderDiskCacheEntry& entry, u64 driver_hash) {
+        KeyConfigType config;
+        if (!LoadDiskCacheConfig(entry, config))
+            return DiskCacheResult::Skipped;
+
+        auto [iter, new_shader] = shaders.emplace(config, OGLShaderStage{separable});
+        if (!new_shader)
+            return DiskCacheResult::Skipped;
+
+        const auto result = BuildFromDiskCache(iter->second, entry, driver_hash, ShaderType);
+        // Store the binary of this driver so that the next boot doesn't compile again
+        if (result == DiskCacheResult::Compiled && separable && disk_cache)
+            SaveToDiskCache(*disk_cache, DiskCacheType, config, entry.code, iter->second, true);
+        return result;
+    }
+
+    void SetDiskCache(ShaderDiskCache* cache) {
+        disk_cache = cache;
+    }
+
 private:
     bool separable;
+    ShaderDiskCache* disk_cache = nullptr;
     std::unordered_map<KeyConfigType, OGLShaderStage> shaders;
 };
 
@@ -166,7 +389,7 @@ private:
 template <typename KeyConfigType,
           std::optional<std::string> (*CodeGenerator)(const Pica::Shader::ShaderSetup&,
                                                       const KeyConfigType&, bool),
-          GLenum ShaderType>
+          GLenum ShaderType, ShaderDiskCacheType DiskCacheType>
 class ShaderDoubleCache {
 public:
     explicit ShaderDoubleCache(bool separable) : separable(separable) {}
@@ -186,6 +409,10 @@ public:
                 cached_shader.Create(program.c_str(), ShaderType);
             }
             shader_map[key] = &cached_shader;
+            // The binary is only stored along with the first config that generated this code
+            if (disk_cache)
+                SaveToDiskCache(*disk_cache, DiskCacheType, key, program, cached_shader,
+                                new_shader);
             return cached_shader.GetHandle();
         }
 
@@ -196,31 +423,64 @@ public:
         return map_it->second->GetHandle();
     }
 
+    DiskCacheResult Install(const ShaderDiskCacheEntry& entry, u64 driver_hash) {
+        KeyConfigType key;
+        if (!LoadDiskCacheConfig(entry, key) || shader_map.count(key) != 0)
+            return DiskCacheResult::Skipped;
+
+        auto [iter, new_shader] = shader_cache.emplace(entry.code, OGLShaderStage{separable});
+        shader_map[key] = &iter->second;
+        if (!new_shader)
+            return DiskCacheResult::Skipped;
+
+        const auto result = BuildFromDiskCache(iter->second, entry, driver_hash, ShaderType);
+        // Store the binary of this driver so that the next boot doesn't compile again
+        if (result == DiskCacheResult::Compiled && separable && disk_cache)
+            SaveToDiskCache(*disk_cache, DiskCacheType, key, entry.code, iter->second, true);
+        return result;
+    }
+
+    void SetDiskCache(ShaderDiskCache* cache) {
+        disk_cache = cache;
+    }
+
 private:
     bool separable;
+    ShaderDiskCache* disk_cache = nullptr;
     std::unordered_map<KeyConfigType, OGLShaderStage*> shader_map;
     std::unordered_map<std::string, OGLShaderStage> shader_cache;
 };
 
 using ProgrammableVertexShaders =
-    ShaderDoubleCache<PicaVSConfig, &GenerateVertexShader, GL_VERTEX_SHADER>;
+    ShaderDoubleCache<PicaVSConfig, &GenerateVertexShader, GL_VERTEX_SHADER,
+                      ShaderDiskCacheType::ProgrammableVertex>;
 
 using ProgrammableGeometryShaders =
-    ShaderDoubleCache<PicaGSConfig, &GenerateGeometryShader, GL_GEOMETRY_SHADER>;
+    ShaderDoubleCache<PicaGSConfig, &GenerateGeometryShader, GL_GEOMETRY_SHADER,
+                      ShaderDiskCacheType::ProgrammableGeometry>;
 
 using FixedGeometryShaders =
-    ShaderCache<PicaFixedGSConfig, &GenerateFixedGeometryShader, GL_GEOMETRY_SHADER>;
+    ShaderCache<PicaFixedGSConfig, &GenerateFixedGeometryShader, GL_GEOMETRY_SHADER,
+                ShaderDiskCacheType::FixedGeometry>;
 
-using FragmentShaders = ShaderCache<PicaFSConfig, &GenerateFragmentShader, GL_FRAGMENT_SHADER>;
+using FragmentShaders = ShaderCache<PicaFSConfig, &GenerateFragmentShader, GL_FRAGMENT_SHADER,
+                                    ShaderDiskCacheType::Fragment>;
 
 class ShaderProgramManager::Impl {
 public:
-    explicit Impl(bool separable, bool is_amd)
+    Impl(bool separable, bool is_amd, std::unique_ptr<GraphicsContext> shader_context)
         : is_amd(is_amd), separable(separable), programmable_vertex_shaders(separable),
           trivial_vertex_shader(separable), programmable_geometry_shaders(separable),
-          fixed_geometry_shaders(separable), fragment_shaders(separable) {
+          fixed_geometry_shaders(separable), fragment_shaders(separable),
+          uber_fragment_shader(separable) {
         if (separable)
             pipeline.Create();
+        if (shader_context) {
+            uber_fragment_shader.Create(GenerateFragmentUberShader(separable).c_str(),
+                                        GL_FRAGMENT_SHADER);
+            shader_compiler =
+                std::make_unique<AsyncShaderCompiler>(std::move(shader_context), separable);
+        }
     }
 
     struct ShaderTuple {
@@ -247,6 +507,68 @@ public:
         };
     };
 
+    /// Builds the shaders read from the disk cache, once the loader thread is done with it
+    void InstallDiskCache() {
+        if (!disk_cache_pending)
+            return;
+        disk_cache_pending = false;
+
+        const auto start = std::chrono::steady_clock::now();
+        const std::vector<ShaderDiskCacheEntry> entries = disk_cache->TakeEntries();
+        const u64 driver_hash = disk_cache->GetDriverHash();
+
+        programmable_vertex_shaders.SetDiskCache(disk_cache.get());
+        programmable_geometry_shaders.SetDiskCache(disk_cache.get());
+        fixed_geometry_shaders.SetDiskCache(disk_cache.get());
+        fragment_shaders.SetDiskCache(disk_cache.get());
+
+        std::size_t num_binaries = 0;
+        std::size_t num_compiled = 0;
+        for (const auto& entry : entries) {
+            DiskCacheResult result = DiskCacheResult::Skipped;
+            switch (entry.type) {
+            case ShaderDiskCacheType::ProgrammableVertex:
+                result = programmable_vertex_shaders.Install(entry, driver_hash);
+                break;
+            case ShaderDiskCacheType::ProgrammableGeometry:
+                result = programmable_geometry_shaders.Install(entry, driver_hash);
+                break;
+            case ShaderDiskCacheType::FixedGeometry:
+                result = fixed_geometry_shaders.Install(entry, driver_hash);
+                break;
+            case ShaderDiskCacheType::Fragment:
+                result = fragment_shaders.Install(entry, driver_hash);
+                break;
+            }
+            num_binaries += result == DiskCacheResult::Binary ? 1 : 0;
+            num_compiled += result == DiskCacheResult::Compiled ? 1 : 0;
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        LOG_INFO(Render_OpenGL,
+                 "Built {} shaders from the disk cache in {} ms ({} binaries, {} from GLSL)",
+                 num_binaries + num_compiled, elapsed.count(), num_binaries, num_compiled);
+    }
+
+    /// Moves the shaders finished by the compiler thread to the fragment shader cache. Returns
+    /// whether any compilation finished.
+    bool InstallCompiledShaders() {
+        auto results = shader_compiler->TakeCompleted();
+        for (auto& result : results) {
+            pending_fragment_shaders.erase(result.config);
+            if (!result.success) {
+                // Queueing the config again would fail the same way on every draw
+                failed_fragment_shaders.insert(result.config);
+                continue;
+            }
+            OGLShaderStage stage{separable};
+            stage.Adopt(std::move(result.shader), std::move(result.program));
+            fragment_shaders.Insert(result.config, result.code, std::move(stage));
+        }
+        return !results.empty();
+    }
+
     bool is_amd;
 
     ShaderTuple current;
@@ -258,19 +580,37 @@ public:
     FixedGeometryShaders fixed_geometry_shaders;
 
     FragmentShaders fragment_shaders;
+    OGLShaderStage uber_fragment_shader;
 
     bool separable;
     std::unordered_map<ShaderTuple, OGLProgram, ShaderTuple::Hash> program_cache;
     OGLPipeline pipeline;
+
+    std::unique_ptr<ShaderDiskCache> disk_cache;
+    bool disk_cache_pending = false;
+
+    std::unique_ptr<AsyncShaderCompiler> shader_compiler;
+    /// Configs queued to the compiler thread that haven't been installed yet
+    std::unordered_set<PicaFSConfig> pending_fragment_shaders;
+    /// Configs the compiler thread failed to build, which keep using the uber shader
+    std::unordered_set<PicaFSConfig> failed_fragment_shaders;
 };
 
-ShaderProgramManager::ShaderProgramManager(bool separable, bool is_amd)
-    : impl(std::make_unique<Impl>(separable, is_amd)) {}
+ShaderProgramManager::ShaderProgramManager(bool separable, bool is_amd,
+                                           std::unique_ptr<GraphicsContext> shader_context)
+    : impl(std::make_unique<Impl>(separable, is_amd, std::move(shader_context))) {}
 
 ShaderProgramManager::~ShaderProgramManager() = default;
 
+void ShaderProgramManager::LoadDiskCache(u64 title_id) {
+    impl->disk_cache = std::make_unique<ShaderDiskCache>(title_id, impl->separable);
+    impl->disk_cache->LoadAsync();
+    impl->disk_cache_pending = true;
+}
+
 bool ShaderProgramManager::UseProgrammableVertexShader(const PicaVSConfig& config,
                                                        const Pica::Shader::ShaderSetup setup) {
+    impl->InstallDiskCache();
     GLuint handle = impl->programmable_vertex_shaders.Get(config, setup);
     if (handle == 0)
         return false;
@@ -284,6 +624,7 @@ void ShaderProgramManager::UseTrivialVertexShader() {
 
 bool ShaderProgramManager::UseProgrammableGeometryShader(const PicaGSConfig& config,
                                                          const Pica::Shader::ShaderSetup setup) {
+    impl->InstallDiskCache();
     GLuint handle = impl->programmable_geometry_shaders.Get(config, setup);
     if (handle == 0)
         return false;
@@ -292,6 +633,7 @@ bool ShaderProgramManager::UseProgrammableGeometryShader(const PicaGSConfig& con
 }
 
 void ShaderProgramManager::UseFixedGeometryShader(const PicaFixedGSConfig& config) {
+    impl->InstallDiskCache();
     impl->current.gs = impl->fixed_geometry_shaders.Get(config);
 }
 
@@ -299,8 +641,28 @@ void ShaderProgramManager::UseTrivialGeometryShader() {
     impl->current.gs = 0;
 }
 
-void ShaderProgramManager::UseFragmentShader(const PicaFSConfig& config) {
+ShaderProgramManager::FragmentShaderSelection ShaderProgramManager::UseFragmentShader(
+    const PicaFSConfig& config) {
+    impl->InstallDiskCache();
+    if (impl->shader_compiler) {
+        impl->InstallCompiledShaders();
+        if (impl->fragment_shaders.Find(config) == 0 && config.IsSupportedByUberShader()) {
+            impl->current.fs = impl->uber_fragment_shader.GetHandle();
+            if (impl->failed_fragment_shaders.count(config) != 0)
+                return FragmentShaderSelection::UberFailed;
+            if (impl->pending_fragment_shaders.insert(config).second) {
+                impl->shader_compiler->Queue(config,
+                                             GenerateFragmentShader(config, impl->separable));
+            }
+            return FragmentShaderSelection::UberPending;
+        }
+    }
     impl->current.fs = impl->fragment_shaders.Get(config);
+    return FragmentShaderSelection::Generated;
+}
+
+bool ShaderProgramManager::InstallCompiledShaders() {
+    return impl->shader_compiler && impl->InstallCompiledShaders();
 }
 
 void ShaderProgramManager::ApplyTo(OpenGLState& state) {
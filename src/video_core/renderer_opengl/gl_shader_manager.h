@@ -12,9 +12,11 @@
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
 
+class GraphicsContext;
+
 namespace OpenGL {
 
-enum class UniformBindings : GLuint { Common, VS, GS };
+enum class UniformBindings : GLuint { Common, VS, GS, FSConfig };
 
 struct LightSrc {
     alignas(16) GLvec3 specular_0;
@@ -99,12 +101,94 @@ static_assert(
 static_assert(sizeof(GSUniformData) < 16384,
               "GSUniformData structure must be less than 16kb as per the OpenGL spec");
 
+/// Uniform struct for the Uniform Buffer Object holding the PicaFSConfig interpreted by the uber
+/// fragment shader.
+// NOTE: the same rule from UniformData also applies here.
+struct FSConfigUniformData {
+    void SetFromConfig(const PicaFSConfig& config);
+
+    GLint alpha_test_func;
+    GLint scissor_test_mode;
+    GLint texture0_type;
+    GLint texture2_use_coord1;
+    GLint combiner_buffer_input;
+    GLint w_buffering;
+    GLint fog_enable;
+    GLint fog_flip;
+    GLint lighting_enable;
+    GLint lighting_src_num;
+    GLint lighting_bump_mode;
+    GLint lighting_bump_selector;
+    GLint lighting_bump_renorm;
+    GLint lighting_clamp_highlights;
+    GLint lighting_config;
+    GLint lighting_primary_alpha;
+    GLint lighting_secondary_alpha;
+    GLint lighting_shadow_enable;
+    GLint lighting_shadow_primary;
+    GLint lighting_shadow_secondary;
+    GLint lighting_shadow_invert;
+    GLint lighting_shadow_alpha;
+    GLint lighting_shadow_selector;
+    alignas(16) std::array<GLuvec4, 6> tev_stages;
+    alignas(16) std::array<GLivec4, 8> light_config;
+    alignas(16) std::array<GLivec4, 7> lut_config;
+    alignas(16) std::array<GLvec4, 2> lut_scale;
+};
+static_assert(sizeof(FSConfigUniformData) == 0x1D0,
+              "The size of the FSConfigUniformData structure has changed, update the structure in "
+              "the shader");
+static_assert(sizeof(FSConfigUniformData) < 16384,
+              "FSConfigUniformData structure must be less than 16kb as per the OpenGL spec");
+
+/// FSConfig uniform block of the uber shader, tracking when it has to be uploaded again.
+class UberShaderBlock {
+public:
+    /**
+     * Selects the fragment shader of the next draw.
+     * @param config Config interpreted by the uber shader, or nullptr if the generated shader is
+     *        used
+     */
+    void Use(const PicaFSConfig* config);
+
+    /**
+     * Whether the block has to be uploaded before the next draw.
+     * @param invalidate Whether the stream buffer holding the last upload has been invalidated
+     */
+    bool NeedsUpload(bool invalidate) const;
+
+    void MarkUploaded() {
+        dirty = false;
+    }
+
+    const FSConfigUniformData& GetData() const {
+        return data;
+    }
+
+private:
+    PicaFSConfig config;
+    FSConfigUniformData data{};
+    bool in_use = false;
+    bool dirty = false;
+};
+
 /// A class that manage different shader stages and configures them with given config data.
 class ShaderProgramManager {
 public:
-    ShaderProgramManager(bool separable, bool is_amd);
+    /**
+     * @param shader_context Context shared with the render thread, used to compile fragment shaders
+     *                       asynchronously. Shaders are compiled on the render thread if null.
+     */
+    ShaderProgramManager(bool separable, bool is_amd,
+                         std::unique_ptr<GraphicsContext> shader_context);
     ~ShaderProgramManager();
 
+    /**
+     * Starts loading the shader disk cache of the given title. The cached shaders are built the
+     * next time a shader is requested, and new shaders are stored in the cache from then on.
+     */
+    void LoadDiskCache(u64 title_id);
+
     bool UseProgrammableVertexShader(const PicaVSConfig& config,
                                      const Pica::Shader::ShaderSetup setup);
 
@@ -117,7 +201,25 @@ public:
 
     void UseTrivialGeometryShader();
 
-    void UseFragmentShader(const PicaFSConfig& config);
+    /// Fragment shader picked by UseFragmentShader
+    enum class FragmentShaderSelection {
+        Generated,   ///< The shader generated for the config
+        UberPending, ///< The uber shader, until the generated shader finished compiling
+        UberFailed,  ///< The uber shader, as the generated shader failed to compile
+    };
+
+    /**
+     * Selects the fragment shader generated for the given config. With asynchronous compilation, a
+     * shader that isn't ready yet or failed to compile is replaced by the uber shader, which must
+     * then be given the config through the fs_config uniform block.
+     */
+    FragmentShaderSelection UseFragmentShader(const PicaFSConfig& config);
+
+    /**
+     * Moves the shaders finished by the asynchronous compiler to the cache.
+     * @returns true if any compilation finished, after which pending selections may change
+     */
+    bool InstallCompiledShaders();
 
     void ApplyTo(OpenGLState& state);
 
@@ -64,6 +64,9 @@ GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders) {
 
     if (separable_program) {
         glProgramParameteri(program_id, GL_PROGRAM_SEPARABLE, GL_TRUE);
+        // Separable programs can be stored in the shader disk cache
+        if (GLAD_GL_ARB_get_program_binary)
+            glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     }
 
     glLinkProgram(program_id);
@@ -84,14 +87,18 @@ GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders) {
         }
     }
 
-    ASSERT_MSG(result == GL_TRUE, "Shader not linked");
-
     for (GLuint shader : shaders) {
         if (shader != 0) {
             glDetachShader(program_id, shader);
         }
     }
 
+    // This also runs on the shader compiler thread, which handles the failure on its own
+    if (result != GL_TRUE) {
+        glDeleteProgram(program_id);
+        return 0;
+    }
+
     return program_id;
 }
 
@@ -20,7 +20,7 @@ GLuint LoadShader(const char* source, GLenum type);
  * Utility function to create and link an OpenGL GLSL shader program
  * @param separable_program whether to create a separable program
  * @param shaders ID of shaders to attach to the program
- * @returns Handle of the newly created OpenGL program object
+ * @returns Handle of the newly created OpenGL program object, or 0 if linking failed
  */
 GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders);
 
@@ -2,8 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <deque>
-#include <vector>
+#include <algorithm>
+#include <chrono>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/microprofile.h"
@@ -12,12 +12,23 @@
 
 MICROPROFILE_DEFINE(OpenGL_StreamBuffer, "OpenGL", "Stream Buffer Orphaning",
                     MP_RGB(128, 128, 192));
+MICROPROFILE_DEFINE(OpenGL_StreamBufferWait, "OpenGL", "Stream Buffer Wait", MP_RGB(192, 128, 128));
 
 namespace OpenGL {
 
-OGLStreamBuffer::OGLStreamBuffer(GLenum target, GLsizeiptr size, bool array_buffer_for_amd,
-                                 bool prefer_coherent)
-    : gl_target(target), buffer_size(size) {
+OGLStreamBuffer::OGLStreamBuffer(const char* name, GLenum target, GLsizeiptr size,
+                                 bool array_buffer_for_amd, bool prefer_coherent,
+                                 std::size_t num_segments)
+    : gl_target(target), buffer_size(size),
+      bytes_uploaded(Common::Counters::Register("citra_gpu_stream_buffer_upload_bytes_total",
+                                                "Bytes written into stream buffers",
+                                                {{"buffer", name}})),
+      stalls(Common::Counters::Register(
+          "citra_gpu_stream_buffer_stalls_total",
+          "Stream buffer maps that waited for the GPU to release a segment", {{"buffer", name}})),
+      stall_microseconds(Common::Counters::Register(
+          "citra_gpu_stream_buffer_stall_microseconds_total",
+          "Time stream buffer maps spent waiting for the GPU", {{"buffer", name}})) {
     gl_buffer.Create();
     glBindBuffer(gl_target, gl_buffer.handle);
 
@@ -39,6 +50,10 @@ OGLStreamBuffer::OGLStreamBuffer(GLenum target, GLsizeiptr size, bool array_buff
         glBufferStorage(gl_target, allocate_size, nullptr, flags);
         mapped_ptr = static_cast<u8*>(glMapBufferRange(
             gl_target, 0, buffer_size, flags | (coherent ? 0 : GL_MAP_FLUSH_EXPLICIT_BIT)));
+
+        ASSERT(num_segments > 0);
+        segment_size = (buffer_size + num_segments - 1) / num_segments;
+        fences.resize(num_segments);
     } else {
         glBufferData(gl_target, allocate_size, nullptr, GL_STREAM_DRAW);
     }
@@ -71,25 +86,39 @@ std::tuple<u8*, GLintptr, bool> OGLStreamBuffer::Map(GLsizeiptr size, GLintptr a
 
     bool invalidate = false;
     if (buffer_pos + size > buffer_size) {
+        if (persistent) {
+            FenceSegments(acquired_segments);
+            fenced_segments = 0;
+            acquired_segments = 0;
+        }
         buffer_pos = 0;
         invalidate = true;
+    }
 
-        if (persistent) {
-            glUnmapBuffer(gl_target);
+    if (persistent) {
+        const std::size_t first_segment = static_cast<std::size_t>(buffer_pos / segment_size);
+        const std::size_t end_segment = std::clamp(
+            static_cast<std::size_t>((buffer_pos + size + segment_size - 1) / segment_size),
+            first_segment + 1, fences.size());
+
+        // Once the write position leaves a segment, nothing issued later may read from it, so its
+        // fence covers every command using it
+        if (first_segment > fenced_segments) {
+            FenceSegments(first_segment);
+            invalidate = true;
         }
+        AcquireSegments(end_segment);
+        return std::make_tuple(mapped_ptr + buffer_pos, buffer_pos, invalidate);
     }
 
-    if (invalidate || !persistent) {
-        MICROPROFILE_SCOPE(OpenGL_StreamBuffer);
-        GLbitfield flags = GL_MAP_WRITE_BIT | (persistent ? GL_MAP_PERSISTENT_BIT : 0) |
-                           (coherent ? GL_MAP_COHERENT_BIT : GL_MAP_FLUSH_EXPLICIT_BIT) |
-                           (invalidate ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_UNSYNCHRONIZED_BIT);
-        mapped_ptr = static_cast<u8*>(
-            glMapBufferRange(gl_target, buffer_pos, buffer_size - buffer_pos, flags));
-        mapped_offset = buffer_pos;
-    }
+    MICROPROFILE_SCOPE(OpenGL_StreamBuffer);
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT |
+                       (invalidate ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_UNSYNCHRONIZED_BIT);
+    mapped_ptr = static_cast<u8*>(
+        glMapBufferRange(gl_target, buffer_pos, buffer_size - buffer_pos, flags));
+    mapped_offset = buffer_pos;
 
-    return std::make_tuple(mapped_ptr + buffer_pos - mapped_offset, buffer_pos, invalidate);
+    return std::make_tuple(mapped_ptr, buffer_pos, invalidate);
 }
 
 void OGLStreamBuffer::Unmap(GLsizeiptr size) {
@@ -104,6 +133,37 @@ void OGLStreamBuffer::Unmap(GLsizeiptr size) {
     }
 
     buffer_pos += size;
+    bytes_uploaded.Add(size);
+}
+
+void OGLStreamBuffer::FenceSegments(std::size_t end) {
+    for (std::size_t segment = fenced_segments; segment < end; ++segment) {
+        fences[segment].Create();
+    }
+    fenced_segments = std::max(fenced_segments, end);
+}
+
+void OGLStreamBuffer::AcquireSegments(std::size_t end) {
+    for (std::size_t segment = acquired_segments; segment < end; ++segment) {
+        OGLSync& fence = fences[segment];
+        if (fence.handle == nullptr)
+            continue;
+
+        if (glClientWaitSync(fence.handle, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            MICROPROFILE_SCOPE(OpenGL_StreamBufferWait);
+            const auto start = std::chrono::steady_clock::now();
+            GLenum result;
+            do {
+                result = glClientWaitSync(fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            } while (result == GL_TIMEOUT_EXPIRED);
+            const auto stall_time = std::chrono::steady_clock::now() - start;
+            stall_microseconds.Add(
+                std::chrono::duration_cast<std::chrono::microseconds>(stall_time).count());
+            stalls.Add();
+        }
+        fence.Release();
+    }
+    acquired_segments = std::max(acquired_segments, end);
 }
 
 } // namespace OpenGL
@@ -5,16 +5,25 @@
 #pragma once
 
 #include <tuple>
+#include <vector>
 #include <glad/glad.h>
 #include "common/common_types.h"
+#include "common/counters.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 
 namespace OpenGL {
 
 class OGLStreamBuffer : private NonCopyable {
 public:
-    explicit OGLStreamBuffer(GLenum target, GLsizeiptr size, bool array_buffer_for_amd,
-                             bool prefer_coherent = false);
+    /**
+     * When persistent mapping is available, the buffer is used as a ring split into num_segments
+     * segments. A fence is inserted when the write position leaves a segment and waited on before
+     * the segment is written again, so the buffer never has to be remapped.
+     * @param name Label of the buffer in the upload and stall counters
+     */
+    explicit OGLStreamBuffer(const char* name, GLenum target, GLsizeiptr size,
+                             bool array_buffer_for_amd, bool prefer_coherent = false,
+                             std::size_t num_segments = 16);
     ~OGLStreamBuffer();
 
     GLuint GetHandle() const;
@@ -23,9 +32,10 @@ public:
     /*
      * Allocates a linear chunk of memory in the GPU buffer with at least "size" bytes
      * and the optional alignment requirement.
-     * If the buffer is full, the whole buffer is reallocated which invalidates old chunks.
      * The return values are the pointer to the new chunk, the offset within the buffer,
-     * and the invalidation flag for previous chunks.
+     * and the invalidation flag for previous chunks. Previous chunks are invalidated when the
+     * buffer wraps around, or when the new chunk starts in another segment of a persistent buffer,
+     * and must not be referenced by commands issued afterwards.
      * The actual used size must be specified on unmapping the chunk.
      */
     std::tuple<u8*, GLintptr, bool> Map(GLsizeiptr size, GLintptr alignment = 0);
@@ -33,6 +43,12 @@ public:
     void Unmap(GLsizeiptr size);
 
 private:
+    /// Fences the segments in [fenced_segments, end) that the write position has moved past
+    void FenceSegments(std::size_t end);
+
+    /// Waits until the GPU no longer reads the segments in [acquired_segments, end)
+    void AcquireSegments(std::size_t end);
+
     OGLBuffer gl_buffer;
     GLenum gl_target;
 
@@ -44,6 +60,20 @@ private:
     GLintptr mapped_offset = 0;
     GLsizeiptr mapped_size = 0;
     u8* mapped_ptr = nullptr;
+
+    GLsizeiptr segment_size = 0;
+    std::vector<OGLSync> fences;
+    /// Segments of the current pass over the ring that have been fenced
+    std::size_t fenced_segments = 0;
+    /// Segments of the current pass over the ring that are safe to write
+    std::size_t acquired_segments = 0;
+
+    /// Bytes written into the buffer
+    Common::Counters::Counter bytes_uploaded;
+    /// Maps that had to wait for the GPU to release a segment
+    Common::Counters::Counter stalls;
+    /// Time spent waiting for the GPU to release segments
+    Common::Counters::Counter stall_microseconds;
 };
 
 } // namespace OpenGL
@@ -184,6 +184,7 @@ void RendererOpenGL::SwapBuffers() {
         Core::System::GetInstance().CoreTiming().GetGlobalTimeUs());
     Core::System::GetInstance().perf_stats.BeginSystemFrame();
 
+    rasterizer->EndFrame();
     prev_state.Apply();
     RefreshRasterizerSetting();
 